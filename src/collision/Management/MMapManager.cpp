@@ -26,6 +26,84 @@
 
 namespace MMAP
 {
+    // ######################## NavMeshQueryPool ########################
+    // dtNavMeshQuery is not thread safe, so every thread gets its own query per map.
+    // Entries are re-initialised lazily when the map's navmesh was reloaded in between.
+    // The pool also remembers the MMapData of the map, so a thread only looks it up
+    // under MMapManager::mapDataLock once instead of on every query.
+    class NavMeshQueryPool
+    {
+        public:
+            ~NavMeshQueryPool()
+            {
+                for (QueryMap::iterator i = queries.begin(); i != queries.end(); ++i)
+                    dtFreeNavMeshQuery(i->second.query);
+            }
+
+            MMapData* getMapData(const MMapManager* manager, uint32 mapId) const
+            {
+                QueryMap::const_iterator itr = queries.find(mapId);
+                if (itr == queries.end() || itr->second.manager != manager)
+                    return nullptr;
+
+                return itr->second.mapData;
+            }
+
+            void setMapData(const MMapManager* manager, uint32 mapId, MMapData* mmap)
+            {
+                QueryEntry& entry = queries[mapId];
+                if (entry.manager != manager)
+                {
+                    // the query was initialised with a navmesh of a destroyed manager
+                    entry.manager = manager;
+                    entry.generation = 0;
+                }
+
+                entry.mapData = mmap;
+            }
+
+            // the caller holds mmap->navMeshLock
+            dtNavMeshQuery* get(uint32 mapId, const MMapData* mmap)
+            {
+                QueryEntry& entry = queries[mapId];
+                if (entry.query != nullptr && entry.generation == mmap->generation)
+                    return entry.query;
+
+                if (entry.query == nullptr)
+                    entry.query = dtAllocNavMeshQuery();
+
+                ASSERT(entry.query);
+                if (dtStatusFailed(entry.query->init(mmap->navMesh, MMAP_MAX_QUERY_NODES)))
+                {
+                    dtFreeNavMeshQuery(entry.query);
+                    entry.query = nullptr;
+
+                    LOG_ERROR("Failed to initialize dtNavMeshQuery for mapId %03u", mapId);
+                    return nullptr;
+                }
+
+                LogDebugFlag(LF_MMAP, "MMAP:GetNavMeshReader: created dtNavMeshQuery for mapId %03u", mapId);
+                entry.generation = mmap->generation;
+                return entry.query;
+            }
+
+        private:
+            struct QueryEntry
+            {
+                QueryEntry() : manager(nullptr), mapData(nullptr), query(nullptr), generation(0) { }
+
+                const MMapManager* manager;
+                MMapData* mapData;
+                dtNavMeshQuery* query;
+                uint32 generation;
+            };
+
+            typedef std::unordered_map<uint32, QueryEntry> QueryMap;
+            QueryMap queries;
+    };
+
+    static thread_local NavMeshQueryPool t_navMeshQueryPool;
+
     // ######################## MMapManager ########################
     MMapManager::~MMapManager()
     {
@@ -40,34 +118,32 @@ namespace MMAP
     {
         // the caller must pass the list of all mapIds that will be used in the VMapManager2 lifetime
         for (const uint32& mapId : mapIds)
-            loadedMMaps.insert(MMapDataSet::value_type(mapId, nullptr));
+            loadedMMaps.insert(MMapDataSet::value_type(mapId, new MMapData()));
 
         thread_safe_environment = false;
     }
 
-    MMapDataSet::const_iterator MMapManager::GetMMapData(uint32 mapId) const
+    MMapData* MMapManager::GetMMapData(uint32 mapId) const
     {
-        // return the iterator if found or end() if not found/NULL
+        std::lock_guard<std::mutex> guard(mapDataLock);
+
+        // return the data if found or nullptr if not found/NULL
         MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
-        if (itr != loadedMMaps.cend() && !itr->second)
-            itr = loadedMMaps.cend();
+        if (itr == loadedMMaps.cend())
+            return nullptr;
 
-        return itr;
+        return itr->second;
     }
 
     bool MMapManager::loadMapData(uint32 mapId)
     {
-        // we already have this map loaded?
+        std::lock_guard<std::mutex> guard(mapDataLock);
+
         MMapDataSet::iterator itr = loadedMMaps.find(mapId);
-        if (itr != loadedMMaps.end())
-        {
-            if (itr->second)
-                return true;
-        }
-        else
+        if (itr == loadedMMaps.end())
         {
             if (thread_safe_environment)
-                itr = loadedMMaps.insert(MMapDataSet::value_type(mapId, nullptr)).first;
+                itr = loadedMMaps.insert(MMapDataSet::value_type(mapId, new MMapData())).first;
             else
             {
                 LOG_ERROR("Invalid mapId %u passed to MMapManager after startup in thread unsafe environment", mapId);
@@ -75,6 +151,11 @@ namespace MMAP
             }
         }
 
+        // we already have this map loaded?
+        MMapData* mmap_data = itr->second;
+        if (mmap_data->navMesh)
+            return true;
+
         // load and init dtNavMesh - read parameters from file
         std::string dataDir = worldConfig.server.dataDir + "mmaps";
         uint32 pathLen = dataDir.length() + strlen("%03i.mmap") + 1;
@@ -113,11 +194,11 @@ namespace MMAP
 
         LogDebugFlag(LF_MMAP, "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
-        // store inside our map list
-        MMapData* mmap_data = new MMapData(mesh);
-        mmap_data->mmapLoadedTiles.clear();
-
-        itr->second = mmap_data;
+        // publish the mesh, navMesh is only written while all three locks are held
+        std::lock_guard<std::mutex> tileGuard(mmap_data->tileLock);
+        std::unique_lock<std::shared_timed_mutex> meshGuard(mmap_data->navMeshLock);
+        mmap_data->navMesh = mesh;
+        mmap_data->generation = ++nextGeneration;
         return true;
     }
 
@@ -133,14 +214,25 @@ namespace MMAP
             return false;
 
         // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
-        ASSERT(mmap->navMesh);
+        MMapData* mmap = GetMMapData(mapId);
+        if (mmap == nullptr)
+            return false;
 
-        // check if we already have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+        std::lock_guard<std::mutex> guard(mmap->tileLock);
+
+        // the whole map was unloaded in between
+        if (mmap->navMesh == nullptr)
             return false;
 
+        // another cell (or instance) already loaded this tile, just hold another reference
+        uint32 packedGridPos = packTileID(x, y);
+        MMapTileSet::iterator tile = mmap->mmapLoadedTiles.find(packedGridPos);
+        if (tile != mmap->mmapLoadedTiles.end())
+        {
+            ++tile->second.refCount;
+            return true;
+        }
+
         // load this tile :: /MMMXXYY.mmtile
         uint32 pathLen = basePath.length() + strlen("/%03i%02i%02i.mmtile") + 1;
         char *fileName = new char[pathLen];
@@ -180,6 +272,7 @@ namespace MMAP
         if (!result)
         {
             LOG_ERROR("Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(data);
             fclose(file);
             return false;
         }
@@ -189,10 +282,13 @@ namespace MMAP
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
+        // no query may run on the navmesh while its tiles change
+        std::unique_lock<std::shared_timed_mutex> meshGuard(mmap->navMeshLock);
+
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
         if (dtStatusSucceed(mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef)))
         {
-            mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+            mmap->mmapLoadedTiles.insert(MMapTileSet::value_type(packedGridPos, MMapTile(tileRef)));
             ++loadedTiles;
             LogDebugFlag(LF_MMAP, "MMAP:loadMap: Loaded mmtile %03i[%02i, %02i] into %03i[%02i, %02i]", mapId, x, y, mapId, header->x, header->y);
             return true;
@@ -208,29 +304,35 @@ namespace MMAP
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
         // check if we have this map loaded
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
+        MMapData* mmap = GetMMapData(mapId);
+        if (mmap == nullptr)
         {
             // file may not exist, therefore not loaded
             LogDebugFlag(LF_MMAP, "MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
             return false;
         }
 
-        MMapData* mmap = itr->second;
+        std::lock_guard<std::mutex> guard(mmap->tileLock);
 
         // check if we have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) == mmap->mmapLoadedTiles.end())
+        MMapTileSet::iterator tile = mmap->mmapLoadedTiles.find(packedGridPos);
+        if (tile == mmap->mmapLoadedTiles.end())
         {
             // file may not exist, therefore not loaded
             LogDebugFlag(LF_MMAP, "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
             return false;
         }
 
-        dtTileRef tileRef = mmap->mmapLoadedTiles[packedGridPos];
+        // still used by other cells
+        if (--tile->second.refCount > 0)
+            return true;
+
+        // no query may run on the navmesh while its tiles change
+        std::unique_lock<std::shared_timed_mutex> meshGuard(mmap->navMeshLock);
 
         // unload, and mark as non loaded
-        if (dtStatusFailed(mmap->navMesh->removeTile(tileRef, NULL, NULL)))
+        if (dtStatusFailed(mmap->navMesh->removeTile(tile->second.ref, NULL, NULL)))
         {
             // this is technically a memory leak
             // if the grid is later reloaded, dtNavMesh::addTile will return error but no extra memory is used
@@ -239,7 +341,7 @@ namespace MMAP
         }
         else
         {
-            mmap->mmapLoadedTiles.erase(packedGridPos);
+            mmap->mmapLoadedTiles.erase(tile);
             --loadedTiles;
             LogDebugFlag(LF_MMAP, "MMAP:unloadMap: Unloaded mmtile %03i[%02i, %02i] from %03i", mapId, x, y, mapId);
             return true;
@@ -250,21 +352,27 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId)
     {
+        std::lock_guard<std::mutex> guard(mapDataLock);
+
         MMapDataSet::iterator itr = loadedMMaps.find(mapId);
-        if (itr == loadedMMaps.end() || !itr->second)
+        if (itr == loadedMMaps.end() || !itr->second->navMesh)
         {
             // file may not exist, therefore not loaded
             LogDebugFlag(LF_MMAP, "MMAP:unloadMap: Asked to unload not loaded navmesh map %03u", mapId);
             return false;
         }
 
-        // unload all tiles from given map
+        // the MMapData itself stays, threads keep a pointer to it
         MMapData* mmap = itr->second;
+        std::lock_guard<std::mutex> tileGuard(mmap->tileLock);
+        std::unique_lock<std::shared_timed_mutex> meshGuard(mmap->navMeshLock);
+
+        // unload all tiles from given map
         for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
         {
             uint32 x = (i->first >> 16);
             uint32 y = (i->first & 0x0000FFFF);
-            if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
+            if (dtStatusFailed(mmap->navMesh->removeTile(i->second.ref, NULL, NULL)))
                 LOG_ERROR("Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
             else
             {
@@ -273,72 +381,48 @@ namespace MMAP
             }
         }
 
-        delete mmap;
-        itr->second = nullptr;
+        mmap->mmapLoadedTiles.clear();
+        dtFreeNavMesh(mmap->navMesh);
+        mmap->navMesh = nullptr;
         LogDebugFlag(LF_MMAP, "MMAP:unloadMap: Unloaded %03i.mmap", mapId);
 
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
+    NavMeshReader MMapManager::GetNavMeshReader(uint32 mapId)
     {
-        // check if we have this map loaded
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
+        NavMeshReader reader;
+
+        MMapData* mmap = t_navMeshQueryPool.getMapData(this, mapId);
+        if (mmap == nullptr)
         {
-            // file may not exist, therefore not loaded
-            LogDebugFlag(LF_MMAP, "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
+            mmap = GetMMapData(mapId);
+            if (mmap == nullptr)
+                return reader;
+
+            t_navMeshQueryPool.setMapData(this, mapId, mmap);
         }
 
-        MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        reader.lock = std::shared_lock<std::shared_timed_mutex>(mmap->navMeshLock);
+        if (mmap->navMesh == nullptr)
         {
-            LogDebugFlag(LF_MMAP, "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
+            reader.lock.unlock();
+            return reader;
         }
 
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        LogDebugFlag(LF_MMAP, "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
-
-        return true;
-    }
-
-    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
-    {
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
-            return NULL;
+        reader.query = t_navMeshQueryPool.get(mapId, mmap);
+        if (reader.query == nullptr)
+        {
+            reader.lock.unlock();
+            return reader;
+        }
 
-        return itr->second->navMesh;
+        reader.navMesh = mmap->navMesh;
+        return reader;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    bool MMapManager::HasNavMesh(uint32 mapId)
     {
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
-            return NULL;
-
-        MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
-            ASSERT(query);
-            if (dtStatusFailed(query->init(mmap->navMesh, 1024)))
-            {
-                dtFreeNavMeshQuery(query);
-                LOG_ERROR("Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-                return NULL;
-            }
-
-            LogDebugFlag(LF_MMAP, "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
-        }
-
-        return mmap->navMeshQueries[instanceId];
+        return static_cast<bool>(GetNavMeshReader(mapId));
     }
 }
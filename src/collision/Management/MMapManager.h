@@ -24,6 +24,9 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -31,29 +34,66 @@
 //  move map related classes
 namespace MMAP
 {
-    typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
-    typedef std::unordered_map<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+    // node budget of every dtNavMeshQuery handed out by MMapManager
+    const int MMAP_MAX_QUERY_NODES = 1024;
+
+    // loaded tile and the number of active cells (of all instances) using it
+    struct MMapTile
+    {
+        MMapTile(dtTileRef tileRef) : ref(tileRef), refCount(1) { }
+
+        dtTileRef ref;
+        uint32 refCount;
+    };
+
+    typedef std::unordered_map<uint32, MMapTile> MMapTileSet;
 
     // dummy struct to hold map's mmap data
+    // the navmesh and its tiles are shared by all instances of the map
+    // MMapData lives until the MMapManager is destroyed, unloading the map only frees its navmesh
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) { }
+        MMapData() : navMesh(nullptr), generation(0) { }
         ~MMapData()
         {
-            for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
-                dtFreeNavMeshQuery(i->second);
-
             if (navMesh)
                 dtFreeNavMesh(navMesh);
         }
 
         dtNavMesh* navMesh;
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // unique for every dtNavMesh ever created, lets the per thread queries detect a reloaded mesh
+        uint32 generation;
+
+        // shared by queries, exclusive while navMesh, generation or the tiles of navMesh change
+        // lock order is MMapManager::mapDataLock, tileLock, navMeshLock
+        std::shared_timed_mutex navMeshLock;
+
+        std::mutex tileLock;                // guards mmapLoadedTiles
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
     };
 
+    // read access to the navmesh of one map, no tile is added or removed while it is held
+    // the query belongs to the calling thread and must not be handed over to another thread
+    // a thread must not hold two readers at once or load/unload tiles while holding one
+    class NavMeshReader
+    {
+        friend class MMapManager;
+
+        public:
+            NavMeshReader() : navMesh(nullptr), query(nullptr) {}
+
+            explicit operator bool() const { return query != nullptr; }
+
+            dtNavMesh const* getNavMesh() const { return navMesh; }
+            dtNavMeshQuery const* getQuery() const { return query; }
+
+        private:
+            std::shared_lock<std::shared_timed_mutex> lock;
+            dtNavMesh const* navMesh;
+            dtNavMeshQuery const* query;
+    };
+
 
     typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
 
@@ -62,18 +102,19 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0), thread_safe_environment(true) {}
+            MMapManager() : loadedTiles(0), thread_safe_environment(true), nextGeneration(0) {}
             ~MMapManager();
 
             void InitializeThreadUnsafe(const std::vector<uint32>& mapIds);
+
+            // tiles are reference counted, every loadMap call needs a matching unloadMap call
             bool loadMap(const std::string& basePath, uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
-            dtNavMesh const* GetNavMesh(uint32 mapId);
+            // locks the navmesh of the map for reading, empty if the map has no navmesh
+            NavMeshReader GetNavMeshReader(uint32 mapId);
+            bool HasNavMesh(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return uint32(loadedMMaps.size()); }
@@ -81,10 +122,12 @@ namespace MMAP
             bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y);
 
-            MMapDataSet::const_iterator GetMMapData(uint32 mapId) const;
+            MMapData* GetMMapData(uint32 mapId) const;
             MMapDataSet loadedMMaps;
-            uint32 loadedTiles;
+            mutable std::mutex mapDataLock;             // guards loadedMMaps, queries only take it once per thread and map
+            std::atomic<uint32> loadedTiles;
             bool thread_safe_environment;
+            std::atomic<uint32> nextGeneration;
     };
 }
 
@@ -22,9 +22,13 @@
 #include "BoundingIntervalHierarchy.h"
 #include "VMapDefinitions.h"
 
-#include <set>
+#include <atomic>
+#include <functional>
 #include <iomanip>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 
 using G3D::Vector3;
 using G3D::AABox;
@@ -54,7 +58,7 @@ namespace VMAP
     //=================================================================
 
     TileAssembler::TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName)
-        : iDestDir(pDestDirName), iSrcDir(pSrcDirName), iFilterMethod(NULL), iCurrentUniqueNameId(0)
+        : iDestDir(pDestDirName), iSrcDir(pSrcDirName), iFilterMethod(NULL), iCurrentUniqueNameId(0), iVerifyOnly(false)
     {
         //mkdir(iDestDir);
         //init();
@@ -65,145 +69,362 @@ namespace VMAP
         //delete iCoordModelMapping;
     }
 
-    bool TileAssembler::convertWorld2()
+    // calls task(0) ... task(count - 1) on the given number of threads, no task is started
+    // after one failed. One thread runs the tasks in order on the calling thread
+    static bool runTasks(size_t count, uint32 threads, const std::function<bool(size_t)>& task)
+    {
+        std::atomic<size_t> nextTask(0);
+        std::atomic<bool> success(true);
+
+        auto worker = [&]()
+        {
+            for (size_t i = nextTask++; i < count && success; i = nextTask++)
+            {
+                if (!task(i))
+                    success = false;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (uint32 i = 1; i < threads && i < count; ++i)
+            workers.push_back(std::thread(worker));
+
+        worker();
+
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+
+        return success;
+    }
+
+    // the dir_bin record without the node index, readFromFile keeps the bound of the
+    // previous spawn if there is none
+    static void addSpawnToHash(BuildHash& hash, const ModelSpawn& spawn)
+    {
+        hash.add(spawn.flags);
+        hash.add(spawn.adtId);
+        hash.add(spawn.ID);
+        hash.addBytes(&spawn.iPos, sizeof(float) * 3);
+        hash.addBytes(&spawn.iRot, sizeof(float) * 3);
+        hash.add(spawn.iScale);
+        if (spawn.flags & MOD_HAS_BOUND)
+        {
+            hash.addBytes(&spawn.iBound.low(), sizeof(float) * 3);
+            hash.addBytes(&spawn.iBound.high(), sizeof(float) * 3);
+        }
+        hash.addString(spawn.name);
+    }
+
+    bool TileAssembler::convertWorld2(uint32 threads)
     {
         bool success = readMapSpawns();
         if (!success)
             return false;
 
-        // export Map data
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end() && success; ++map_iter)
+        BuildManifest manifest(iDestDir);
+        manifest.load();
+        std::atomic<uint32> outdatedMaps(0), outdatedModels(0);
+
+        // export Map data, every map writes its own files and collects its model files
+        std::vector<MapData::iterator> maps;
+        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+            maps.push_back(map_iter);
+
+        std::vector<std::set<std::string> > mapModelFiles(maps.size());
+        success = runTasks(maps.size(), threads, [this, &maps, &mapModelFiles, &manifest, &outdatedMaps](size_t i)
+        {
+            return updateMap(maps[i]->first, *maps[i]->second, mapModelFiles[i], manifest, outdatedMaps);
+        });
+
+        for (size_t i = 0; i < mapModelFiles.size(); ++i)
+            spawnedModelFiles.insert(mapModelFiles[i].begin(), mapModelFiles[i].end());
+
+        // add an object models, listed in temp_gameobject_models file
+        exportGameobjectModels();
+        // export objects
+        std::cout << "\nConverting Model Files" << std::endl;
+        std::vector<std::string> modelFiles(spawnedModelFiles.begin(), spawnedModelFiles.end());
+        std::mutex outputLock;
+        bool modelsConverted = runTasks(modelFiles.size(), threads, [this, &modelFiles, &outputLock, &manifest, &outdatedModels](size_t i)
         {
-            // build global map tree
-            std::vector<ModelSpawn*> mapSpawns;
-            UniqueEntryMap::iterator entry;
-            printf("Calculating model bounds for map %u...\n", map_iter->first);
-            for (entry = map_iter->second->UniqueEntries.begin(); entry != map_iter->second->UniqueEntries.end(); ++entry)
+            const std::string output = modelFiles[i] + ".vmo";
+
+            BuildHash hash;
+            hash.addString(VMAP_MAGIC);
+            hash.addFile(iSrcDir.empty() ? modelFiles[i] : iSrcDir + "/" + modelFiles[i]);
+
+            BuildState state = manifest.check(output, hash.get());
+            if (state == BUILD_STATE_UP_TO_DATE)
+                return true;
+
+            ++outdatedModels;
+            if (iVerifyOnly)
             {
-                // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
-                if (entry->second.flags & MOD_M2)
-                {
-                    if (!calculateTransformedBound(entry->second))
-                        break;
-                }
-                else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
-                {
-                    /// @todo remove extractor hack and uncomment below line:
-                    //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                    entry->second.iBound = entry->second.iBound + Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                }
-                mapSpawns.push_back(&(entry->second));
-                spawnedModelFiles.insert(entry->second.name);
+                std::lock_guard<std::mutex> guard(outputLock);
+                std::cout << "Outdated " << output << " (" << BuildManifest::getStateName(state) << ")" << std::endl;
+                return true;
             }
 
-            printf("Creating map tree for map %u...\n", map_iter->first);
-            BIH pTree;
-
-            try
             {
-                pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
+                std::lock_guard<std::mutex> guard(outputLock);
+                std::cout << "Converting " << modelFiles[i] << std::endl;
             }
-            catch (std::exception& e)
+
+            if (!convertRawFile(modelFiles[i]))
             {
-                printf("Exception ""%s"" when calling pTree.build", e.what());
+                manifest.erase(output);
+
+                std::lock_guard<std::mutex> guard(outputLock);
+                std::cout << "error converting " << modelFiles[i] << std::endl;
                 return false;
             }
 
-            // ===> possibly move this code to StaticMapTree class
-            std::map<uint32, uint32> modelNodeIdx;
-            for (uint32 i=0; i<mapSpawns.size(); ++i)
-                modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+            manifest.set(output, hash.get());
+            return true;
+        });
 
-            // write map tree file
-            std::stringstream mapfilename;
-            mapfilename << iDestDir << '/' << std::setfill('0') << std::setw(3) << map_iter->first << ".vmtree";
-            FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
-            if (!mapfile)
-            {
+        if (!modelsConverted)
+            success = false;
+
+        if (iVerifyOnly)
+        {
+            std::cout << "\n" << outdatedMaps << " of " << maps.size() << " maps and " << outdatedModels << " of " << modelFiles.size() << " models are outdated" << std::endl;
+            if (outdatedMaps || outdatedModels)
+                success = false;
+        }
+        else
+        {
+            std::cout << "\n" << outdatedMaps << " of " << maps.size() << " maps and " << outdatedModels << " of " << modelFiles.size() << " models converted, the others were up to date" << std::endl;
+            if (!manifest.save())
                 success = false;
-                printf("Cannot open %s\n", mapfilename.str().c_str());
+        }
+
+        //cleanup:
+        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        {
+            delete map_iter->second;
+        }
+        return success;
+    }
+
+    uint64 TileAssembler::getMapInputHash(const MapSpawns& spawns) const
+    {
+        BuildHash hash = spawns.RecordHash;
+        hash.addString(VMAP_MAGIC);
+
+        // M2 bounds are calculated from the raw model
+        std::set<std::string> m2Files;
+        for (UniqueEntryMap::const_iterator entry = spawns.UniqueEntries.begin(); entry != spawns.UniqueEntries.end(); ++entry)
+        {
+            if (entry->second.flags & MOD_M2)
+                m2Files.insert(entry->second.name);
+        }
+
+        for (std::set<std::string>::const_iterator itr = m2Files.begin(); itr != m2Files.end(); ++itr)
+        {
+            hash.addString(*itr);
+            hash.addFile(iSrcDir + "/" + *itr);
+        }
+
+        return hash.get();
+    }
+
+    std::set<std::string> TileAssembler::getMapFiles(uint32 mapId, const MapSpawns& spawns) const
+    {
+        std::set<std::string> files;
+
+        std::stringstream mapfilename;
+        mapfilename << std::setfill('0') << std::setw(3) << mapId << ".vmtree";
+        files.insert(mapfilename.str());
+
+        for (TileMap::const_iterator tile = spawns.TileEntries.begin(); tile != spawns.TileEntries.end(); ++tile)
+        {
+            UniqueEntryMap::const_iterator spawn = spawns.UniqueEntries.find(tile->second);
+            if (spawn->second.flags & MOD_WORLDSPAWN)
+                continue;
+
+            uint32 x, y;
+            StaticMapTree::unpackTileID(tile->first, x, y);
+
+            std::stringstream tilefilename;
+            tilefilename.fill('0');
+            tilefilename << std::setw(3) << mapId << '_' << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
+            files.insert(tilefilename.str());
+        }
+
+        return files;
+    }
+
+    bool TileAssembler::updateMap(uint32 mapId, MapSpawns& spawns, std::set<std::string>& modelFiles, BuildManifest& manifest, std::atomic<uint32>& outdated)
+    {
+        // the tiles reference the nodes of the map tree, so a map is always converted as a whole
+        const uint64 hash = getMapInputHash(spawns);
+        const std::set<std::string> files = getMapFiles(mapId, spawns);
+
+        bool upToDate = true;
+        for (std::set<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+        {
+            BuildState state = manifest.check(*itr, hash);
+            if (state == BUILD_STATE_UP_TO_DATE)
+                continue;
+
+            upToDate = false;
+            if (!iVerifyOnly)
                 break;
-            }
 
-            //general info
-            if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
-            uint32 globalTileID = StaticMapTree::packTileID(65, 65);
-            pair<TileMap::iterator, TileMap::iterator> globalRange = map_iter->second->TileEntries.equal_range(globalTileID);
-            char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
-            if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
-            // Nodes
-            if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
-            if (success) success = pTree.writeToFile(mapfile);
-            // global map spawns (WDT), if any (most instances)
-            if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
-
-            for (TileMap::iterator glob=globalRange.first; glob != globalRange.second && success; ++glob)
-            {
-                success = ModelSpawn::writeToFile(mapfile, map_iter->second->UniqueEntries[glob->second]);
-            }
+            printf("Outdated %s (%s)\n", itr->c_str(), BuildManifest::getStateName(state));
+        }
 
-            fclose(mapfile);
+        if (upToDate || iVerifyOnly)
+        {
+            for (UniqueEntryMap::const_iterator entry = spawns.UniqueEntries.begin(); entry != spawns.UniqueEntries.end(); ++entry)
+                modelFiles.insert(entry->second.name);
+
+            if (!upToDate)
+                ++outdated;
+
+            return true;
+        }
 
-            // <====
+        ++outdated;
 
-            // write map tile files, similar to ADT files, only with extra BSP tree node info
-            TileMap &tileEntries = map_iter->second->TileEntries;
-            TileMap::iterator tile;
-            for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+        // tiles which lost all their spawns would still be loaded
+        std::stringstream tilePrefix;
+        tilePrefix << std::setfill('0') << std::setw(3) << mapId << '_';
+        const std::vector<std::string> oldFiles = manifest.getFiles(tilePrefix.str());
+        for (std::vector<std::string>::const_iterator itr = oldFiles.begin(); itr != oldFiles.end(); ++itr)
+        {
+            if (files.count(*itr) == 0)
             {
-                const ModelSpawn &spawn = map_iter->second->UniqueEntries[tile->second];
-                if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
-                    continue;
-                uint32 nSpawns = tileEntries.count(tile->first);
-                std::stringstream tilefilename;
-                tilefilename.fill('0');
-                tilefilename << iDestDir << '/' << std::setw(3) << map_iter->first << '_';
-                uint32 x, y;
-                StaticMapTree::unpackTileID(tile->first, x, y);
-                tilefilename << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
-                if (FILE* tilefile = fopen(tilefilename.str().c_str(), "wb"))
-                {
-                    // file header
-                    if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
-                    // write number of tile spawns
-                    if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
-                    // write tile spawns
-                    for (uint32 s=0; s<nSpawns; ++s)
-                    {
-                        if (s)
-                            ++tile;
-                        const ModelSpawn &spawn2 = map_iter->second->UniqueEntries[tile->second];
-                        success = success && ModelSpawn::writeToFile(tilefile, spawn2);
-                        // MapTree nodes to update when loading tile:
-                        std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
-                        if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
-                    }
-                    fclose(tilefile);
-                }
+                remove((iDestDir + "/" + *itr).c_str());
+                manifest.erase(*itr);
             }
-            // break; //test, extract only first map; TODO: remvoe this line
         }
 
-        // add an object models, listed in temp_gameobject_models file
-        exportGameobjectModels();
-        // export objects
-        std::cout << "\nConverting Model Files" << std::endl;
-        for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
+        if (!convertMap(mapId, spawns, modelFiles))
+        {
+            for (std::set<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+                manifest.erase(*itr);
+
+            return false;
+        }
+
+        for (std::set<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+            manifest.set(*itr, hash);
+
+        return true;
+    }
+
+    bool TileAssembler::convertMap(uint32 mapId, MapSpawns& spawns, std::set<std::string>& modelFiles)
+    {
+        // build global map tree
+        bool success = true;
+        std::vector<ModelSpawn*> mapSpawns;
+        UniqueEntryMap::iterator entry;
+        printf("Calculating model bounds for map %u...\n", mapId);
+        for (entry = spawns.UniqueEntries.begin(); entry != spawns.UniqueEntries.end(); ++entry)
         {
-            std::cout << "Converting " << *mfile << std::endl;
-            if (!convertRawFile(*mfile))
+            // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
+            if (entry->second.flags & MOD_M2)
             {
-                std::cout << "error converting " << *mfile << std::endl;
-                success = false;
-                break;
+                if (!calculateTransformedBound(entry->second))
+                    break;
             }
+            else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
+            {
+                /// @todo remove extractor hack and uncomment below line:
+                //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
+                entry->second.iBound = entry->second.iBound + Vector3(533.33333f*32, 533.33333f*32, 0.f);
+            }
+            mapSpawns.push_back(&(entry->second));
+            modelFiles.insert(entry->second.name);
         }
 
-        //cleanup:
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        printf("Creating map tree for map %u...\n", mapId);
+        BIH pTree;
+
+        try
         {
-            delete map_iter->second;
+            pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
+        }
+        catch (std::exception& e)
+        {
+            printf("Exception ""%s"" when calling pTree.build", e.what());
+            return false;
         }
+
+        // ===> possibly move this code to StaticMapTree class
+        std::map<uint32, uint32> modelNodeIdx;
+        for (uint32 i=0; i<mapSpawns.size(); ++i)
+            modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+
+        // write map tree file
+        std::stringstream mapfilename;
+        mapfilename << iDestDir << '/' << std::setfill('0') << std::setw(3) << mapId << ".vmtree";
+        FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
+        if (!mapfile)
+        {
+            printf("Cannot open %s\n", mapfilename.str().c_str());
+            return false;
+        }
+
+        //general info
+        if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
+        uint32 globalTileID = StaticMapTree::packTileID(65, 65);
+        pair<TileMap::iterator, TileMap::iterator> globalRange = spawns.TileEntries.equal_range(globalTileID);
+        char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
+        if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
+        // Nodes
+        if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
+        if (success) success = pTree.writeToFile(mapfile);
+        // global map spawns (WDT), if any (most instances)
+        if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
+
+        for (TileMap::iterator glob=globalRange.first; glob != globalRange.second && success; ++glob)
+        {
+            success = ModelSpawn::writeToFile(mapfile, spawns.UniqueEntries[glob->second]);
+        }
+
+        fclose(mapfile);
+
+        // <====
+
+        // write map tile files, similar to ADT files, only with extra BSP tree node info
+        TileMap &tileEntries = spawns.TileEntries;
+        TileMap::iterator tile;
+        for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+        {
+            const ModelSpawn &spawn = spawns.UniqueEntries[tile->second];
+            if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
+                continue;
+            uint32 nSpawns = tileEntries.count(tile->first);
+            std::stringstream tilefilename;
+            tilefilename.fill('0');
+            tilefilename << iDestDir << '/' << std::setw(3) << mapId << '_';
+            uint32 x, y;
+            StaticMapTree::unpackTileID(tile->first, x, y);
+            tilefilename << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
+            if (FILE* tilefile = fopen(tilefilename.str().c_str(), "wb"))
+            {
+                // file header
+                if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
+                // write number of tile spawns
+                if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
+                // write tile spawns
+                for (uint32 s=0; s<nSpawns; ++s)
+                {
+                    if (s)
+                        ++tile;
+                    const ModelSpawn &spawn2 = spawns.UniqueEntries[tile->second];
+                    success = success && ModelSpawn::writeToFile(tilefile, spawn2);
+                    // MapTree nodes to update when loading tile:
+                    std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
+                    if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
+                }
+                fclose(tilefile);
+            }
+        }
+
         return success;
     }
 
@@ -240,6 +461,9 @@ namespace VMAP
                 mapData[mapID] = current = new MapSpawns();
             }
             else current = (*map_iter).second;
+            current->RecordHash.add(tileX);
+            current->RecordHash.add(tileY);
+            addSpawnToHash(current->RecordHash, spawn);
             current->UniqueEntries.insert(pair<uint32, ModelSpawn>(spawn.ID, spawn));
             current->TileEntries.insert(pair<uint32, uint32>(StaticMapTree::packTileID(tileX, tileY), spawn.ID));
         }
@@ -347,11 +571,16 @@ namespace VMAP
         if (!model_list)
             return;
 
-        FILE* model_list_copy = fopen((iDestDir + "/" + GAMEOBJECT_MODELS).c_str(), "wb");
-        if (!model_list_copy)
+        // verifying only needs the model names
+        FILE* model_list_copy = NULL;
+        if (!iVerifyOnly)
         {
-            fclose(model_list);
-            return;
+            model_list_copy = fopen((iDestDir + "/" + GAMEOBJECT_MODELS).c_str(), "wb");
+            if (!model_list_copy)
+            {
+                fclose(model_list);
+                return;
+            }
         }
 
         uint32 name_length, displayId;
@@ -374,6 +603,9 @@ namespace VMAP
                 continue;
 
             spawnedModelFiles.insert(model_name);
+            if (!model_list_copy)
+                continue;
+
             AABox bounds;
             bool boundEmpty = true;
             for (uint32 g = 0; g < raw_model.groupsArray.size(); ++g)
@@ -411,7 +643,8 @@ namespace VMAP
         }
 
         fclose(model_list);
-        fclose(model_list_copy);
+        if (model_list_copy)
+            fclose(model_list_copy);
     }
         // temporary use defines to simplify read/check code (close file and return at fail)
         #define READ_OR_RETURN(V, S) if (fread((V), (S), 1, rf) != 1) { \
@@ -22,11 +22,14 @@
 
 #include <G3D/Vector3.h>
 #include <G3D/Matrix3.h>
+#include <atomic>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "ModelInstance.h"
 #include "WorldModel.h"
+#include "BuildManifest.hpp"
 
 namespace VMAP
 {
@@ -60,6 +63,7 @@ namespace VMAP
     {
         UniqueEntryMap UniqueEntries;
         TileMap TileEntries;
+        BuildHash RecordHash;   // dir_bin records of the map in file order
     };
 
     typedef std::map<uint32, MapSpawns*> MapData;
@@ -101,18 +105,29 @@ namespace VMAP
             unsigned int iCurrentUniqueNameId;
             MapData mapData;
             std::set<std::string> spawnedModelFiles;
+            bool iVerifyOnly;
+
+            uint64 getMapInputHash(const MapSpawns& spawns) const;
+            std::set<std::string> getMapFiles(uint32 mapId, const MapSpawns& spawns) const;
+            bool updateMap(uint32 mapId, MapSpawns& spawns, std::set<std::string>& modelFiles, BuildManifest& manifest, std::atomic<uint32>& outdated);
 
         public:
             TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
             virtual ~TileAssembler();
 
-            bool convertWorld2();
+            // converts the maps and afterwards the model files on the given number of threads,
+            // the output does not depend on the number of threads. Only maps and models whose
+            // raw files changed since the last run are converted, see manifest.txt in the dest dir
+            bool convertWorld2(uint32 threads = 1);
             bool readMapSpawns();
+            bool convertMap(uint32 mapId, MapSpawns& spawns, std::set<std::string>& modelFiles);
             bool calculateTransformedBound(ModelSpawn &spawn);
             void exportGameobjectModels();
 
             bool convertRawFile(const std::string& pModelFilename);
             void setModelNameFilterMethod(bool (*pFilterMethod)(char *pName)) { iFilterMethod = pFilterMethod; }
+            // convertWorld2 only lists the outdated files and fails if there are any
+            void setVerifyOnly(bool verifyOnly) { iVerifyOnly = verifyOnly; }
             std::string getDirEntryNameFromModName(unsigned int pMapId, const std::string& pModPosName);
     };
 
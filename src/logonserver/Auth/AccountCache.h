@@ -237,6 +237,22 @@ class InformationCore : public Singleton<InformationCore>
 
         void TimeoutSockets();
         void CheckServers();
+
+        inline size_t GetRealmCount()
+        {
+            realmLock.Acquire();
+            size_t count = m_realms.size();
+            realmLock.Release();
+            return count;
+        }
+
+        inline size_t GetServerSocketCount()
+        {
+            serverSocketLock.Acquire();
+            size_t count = m_serverSockets.size();
+            serverSocketLock.Release();
+            return count;
+        }
 };
 
 #define sIPBanner IPBanner::getSingleton()
@@ -115,6 +115,7 @@ void AuthSocket::HandleChallenge()
     LOG_DEBUG("[AuthChallenge] got a complete packet.");
 
     readBuffer.Read(&m_challenge, full_size + 4);
+    s_challenges.add();
 
     // Check client build.
     uint16 client_build = m_challenge.build;
@@ -442,6 +443,7 @@ void AuthSocket::HandleProof()
 
     // we're authenticated now :)
     m_authenticated = true;
+    s_logons.add();
 
     // Don't update when IP banned, but update anyway if it's an account ban
     sLogonSQL->Execute("UPDATE accounts SET lastlogin=NOW(), lastip='%s' WHERE acct=%u;", GetRemoteIP().c_str(), m_account->AccountId);
@@ -458,6 +460,8 @@ void AuthSocket::SendChallengeError(uint8 Error)
 
 void AuthSocket::SendProofError(uint8 Error, uint8* M2)
 {
+    s_failedLogons.add();
+
     uint8 buffer[32];
     memset(buffer, 0, 32);
 
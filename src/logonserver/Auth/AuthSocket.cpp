@@ -7,6 +7,10 @@ This file is released under the MIT license. See README-MIT for more information
 #include "AuthSocket.h"
 #include <openssl/md5.h>
 
+MetricCounter AuthSocket::s_challenges;
+MetricCounter AuthSocket::s_logons;
+MetricCounter AuthSocket::s_failedLogons;
+
 void AuthSocket::sendAuthProof(Sha1Hash sha)
 {
     LOG_DEBUG(" called.");
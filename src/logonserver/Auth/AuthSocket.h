@@ -62,6 +62,11 @@ class AuthSocket : public Socket
         bool removedFromSet;
         inline uint32 GetAccountID() { return m_account ? m_account->AccountId : 0; }
 
+        // Metrics
+        static MetricCounter s_challenges;
+        static MetricCounter s_logons;
+        static MetricCounter s_failedLogons;
+
     protected:
 
         sAuthLogonChallenge_C m_challenge;
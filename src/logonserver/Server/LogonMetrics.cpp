@@ -0,0 +1,40 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "LogonStdAfx.h"
+
+#include "LogonMetrics.hpp"
+#include "Metrics/MetricsExporter.hpp"
+
+namespace
+{
+    void writeLogonMetrics(MetricsWriter& writer)
+    {
+        writer.family("ascemu_logon_accounts", "gauge", "Accounts in the account cache.");
+        writer.sample("ascemu_logon_accounts", "", static_cast<double>(sAccountMgr.GetCount()));
+
+        writer.family("ascemu_logon_realms", "gauge", "Registered realms.");
+        writer.sample("ascemu_logon_realms", "", static_cast<double>(sInfoCore.GetRealmCount()));
+
+        writer.family("ascemu_logon_server_sockets", "gauge", "Connected realm server sockets.");
+        writer.sample("ascemu_logon_server_sockets", "", static_cast<double>(sInfoCore.GetServerSocketCount()));
+
+        writer.family("ascemu_logon_challenges_total", "counter", "Logon challenges received from clients.");
+        writer.sample("ascemu_logon_challenges_total", "", static_cast<double>(AuthSocket::s_challenges.get()));
+
+        writer.family("ascemu_logon_successful_total", "counter", "Clients which proved their password.");
+        writer.sample("ascemu_logon_successful_total", "", static_cast<double>(AuthSocket::s_logons.get()));
+
+        writer.family("ascemu_logon_failed_total", "counter", "Logon proofs answered with an error.");
+        writer.sample("ascemu_logon_failed_total", "", static_cast<double>(AuthSocket::s_failedLogons.get()));
+    }
+}
+
+void registerLogonMetrics()
+{
+    sMetricsExporter.addDatabase("logon", sLogonSQL);
+
+    sMetricsExporter.addCollector(&writeLogonMetrics);
+}
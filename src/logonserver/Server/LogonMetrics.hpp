@@ -0,0 +1,10 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+/// adds the collectors of the logon server (accounts, realms, logons) and its database
+/// to sMetricsExporter
+void registerLogonMetrics();
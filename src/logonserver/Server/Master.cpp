@@ -17,6 +17,8 @@
 */
 
 #include "LogonStdAfx.h"
+#include "Server/LogonMetrics.hpp"
+#include "Metrics/MetricsExporter.hpp"
 
 // Database impl
 Database* sLogonSQL;
@@ -163,6 +165,10 @@ void LogonServer::Run(int argc, char** argv)
 
     sSocketMgr.SpawnWorkerThreads();
 
+    new MetricsExporter;
+    registerLogonMetrics();
+    sMetricsExporter.startup(Config.MainConfig, "Metrics");
+
     // Spawn auth listener
     // Spawn interserver listener
     bool isAuthsockCreated = realmlistSocket->IsOpen();
@@ -212,6 +218,7 @@ void LogonServer::Run(int argc, char** argv)
 
     periodicReloadAccounts->kill();
 
+    sMetricsExporter.shutdown();
     realmlistSocket->Close();
     logonServerSocket->Close();
     sSocketMgr.CloseAll();
@@ -235,6 +242,7 @@ void LogonServer::Run(int argc, char** argv)
     else
         LOG_DEBUG("File logonserver.pid successfully deleted");
 
+    delete MetricsExporter::getSingletonPtr();
     delete AccountMgr::getSingletonPtr();
     delete InformationCore::getSingletonPtr();
     delete PatchMgr::getSingletonPtr();
@@ -148,6 +148,23 @@ public:
 
     /* updates sessions */
     void Update();
+
+    /* session and player counts for the metrics */
+    _inline size_t GetSessionCount()
+    {
+        m_lock.AcquireReadLock();
+        size_t count = m_sessions.size();
+        m_lock.ReleaseReadLock();
+        return count;
+    }
+
+    _inline size_t GetPlayerCount()
+    {
+        m_lock.AcquireReadLock();
+        size_t count = m_clients.size();
+        m_lock.ReleaseReadLock();
+        return count;
+    }
 };
 
 #define sClientMgr ClientMgr::getSingleton()
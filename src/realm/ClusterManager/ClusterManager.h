@@ -50,6 +50,17 @@ public:
     /* loop */
     void Update();
 
+    /* calls func for every connected worker server */
+    template <typename Func>
+    void VisitWorkerServers(Func func)
+    {
+        Slave_Lock.Acquire();
+        for (uint32 i = 1; i <= m_maxWorkerServer; ++i)
+            if (WorkerServers[i])
+                func(WorkerServers[i]);
+        Slave_Lock.Release();
+    }
+
 };
 
 
@@ -4,6 +4,8 @@ This file is released under the MIT license. See README-MIT for more information
 */
 
 #include "RealmStdAfx.h"
+#include "Server/RealmMetrics.hpp"
+#include "Metrics/MetricsExporter.hpp"
 
 // Database impl
 Database* sCharSQL;
@@ -202,6 +204,10 @@ bool Master::Run(int argc, char ** argv)
 
     sSocketMgr.SpawnWorkerThreads();
 
+    new MetricsExporter;
+    registerRealmMetrics();
+    sMetricsExporter.startup(Conf.MainConfig, "RealmMetrics");
+
     LoadingTime = getMSTime() - LoadingTime;
     LogNotice("Server : Ready for connections. Startup time: %ums \n", LoadingTime);
 
@@ -239,6 +245,8 @@ bool Master::Run(int argc, char ** argv)
     LogNotice("Shutdown : Initiated at %s", Util::GetCurrentDateTimeString());
     bServerShutdown = true;
 
+    sMetricsExporter.shutdown();
+
     // send a query to wake it up if its inactive
     LogNotice("Database : Clearing all pending queries...");
 
@@ -264,6 +272,7 @@ bool Master::Run(int argc, char ** argv)
     ThreadPool.Shutdown();
 
     delete LogonCommHandler::getSingletonPtr();
+    delete MetricsExporter::getSingletonPtr();
 }
 
 #ifdef WIN32
@@ -0,0 +1,45 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "RealmStdAfx.h"
+
+#include "RealmMetrics.hpp"
+#include "Metrics/MetricsExporter.hpp"
+
+namespace
+{
+    void writeSessionMetrics(MetricsWriter& writer)
+    {
+        writer.family("ascemu_realm_sessions", "gauge", "Client sessions of the realm server.");
+        writer.sample("ascemu_realm_sessions", "", static_cast<double>(sClientMgr.GetSessionCount()));
+
+        writer.family("ascemu_realm_players", "gauge", "Player infos known to the realm server.");
+        writer.sample("ascemu_realm_players", "", static_cast<double>(sClientMgr.GetPlayerCount()));
+    }
+
+    void writeWorkerServerMetrics(MetricsWriter& writer)
+    {
+        uint32 workerServerCount = 0;
+        sClusterMgr.VisitWorkerServers([&workerServerCount](WorkerServer*) { ++workerServerCount; });
+
+        writer.family("ascemu_realm_worker_servers", "gauge", "Connected worker (world) servers.");
+        writer.sample("ascemu_realm_worker_servers", "", workerServerCount);
+
+        writer.family("ascemu_realm_worker_latency_seconds", "histogram", "Round trip of the pings between realm and worker server.");
+        sClusterMgr.VisitWorkerServers([&writer](WorkerServer* workerServer)
+        {
+            writer.histogram("ascemu_realm_worker_latency_seconds", MetricsWriter::label("worker", workerServer->GetID()), workerServer->latencyHistogram, 1000.0);
+        });
+    }
+}
+
+void registerRealmMetrics()
+{
+    sMetricsExporter.addDatabase("character", sCharSQL);
+    sMetricsExporter.addDatabase("world", sWorldSQL);
+
+    sMetricsExporter.addCollector(&writeSessionMetrics);
+    sMetricsExporter.addCollector(&writeWorkerServerMetrics);
+}
@@ -0,0 +1,10 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+/// adds the collectors of the realm server (sessions, worker servers and their relay
+/// latency) and its databases to sMetricsExporter
+void registerRealmMetrics();
@@ -24,7 +24,8 @@ void WorkerServer::InitHandlers()
     PHandlers[ICMSG_WORLD_PONG_STATUS] = &WorkerServer::Pong;
 }
 
-WorkerServer::WorkerServer(uint32 id, WorkerServerSocket * s) : m_id(id), m_socket(s)
+WorkerServer::WorkerServer(uint32 id, WorkerServerSocket * s) : m_id(id), m_socket(s), last_ping(0), last_pong(uint32(UNIXTIME)), pingtime(0),
+    latency(0), latencyHistogram({ 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500 })
 {
 
 }
@@ -317,23 +318,21 @@ void WorkerServer::Update()
     // no pong for 60 seconds -> remove the socket
     printf("Remove the Socket time out \n");
 
-    }
-
-    if ((t - last_ping) > 15)
-    {
-    // send a ping packet.
-    SendPing();
     }*/
 
+    // the pongs measure the relay latency for the metrics
+    if ((uint32)UNIXTIME - last_ping >= 15)
+        SendPing();
 }
 
 void WorkerServer::SendPing()
 {
-    /*pingtime = getMSTime();
+    pingtime = getMSTime();
     WorldPacket data(ICMSG_REALM_PING_STATUS, 4);
+    data << pingtime;
     SendPacket(&data);
 
-    last_ping = (uint32)UNIXTIME;*/
+    last_ping = (uint32)UNIXTIME;
 }
 
 void WorkerServer::HandleError(WorldPacket & pck)
@@ -41,6 +41,9 @@ public:
     uint32 pingtime;
     uint32 latency;
 
+    /* round trip of the pings in ms, observed by the socket thread */
+    MetricHistogram latencyHistogram;
+
     void SendPing();
 
 protected:
@@ -99,6 +99,10 @@ void WorkerServerSocket::OnRead()
             }
             else
             {
+                // timed here, the worker server handles its queue only once per second
+                if (pck->GetOpcode() == ICMSG_WORLD_PONG_STATUS && pck->size() >= 4)
+                    workerServer->latencyHistogram.observe(getMSTime() - pck->read<uint32>(0));
+
                 workerServer->QueuePacket(pck);
             }
         }
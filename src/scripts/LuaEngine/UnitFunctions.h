@@ -1857,7 +1857,7 @@ class LuaUnit
         if (!ptr)
             lua_pushinteger(L, 0);
         else
-            lua_pushinteger(L, ptr->GetUInt32Value(UNIT_FIELD_MAXHEALTH));
+            lua_pushinteger(L, ptr->GetMaxHealth());
 
         return 1;
     }
@@ -1867,8 +1867,8 @@ class LuaUnit
         uint32 val = static_cast<uint32>(luaL_checkinteger(L, 1));
         if (ptr != nullptr && val > 0)
         {
-            if (val > ptr->GetUInt32Value(UNIT_FIELD_MAXHEALTH))
-                ptr->SetHealth(ptr->GetUInt32Value(UNIT_FIELD_MAXHEALTH));
+            if (val > ptr->GetMaxHealth())
+                ptr->SetHealth(ptr->GetMaxHealth());
             else
                 ptr->SetHealth(val);
         }
@@ -0,0 +1,434 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "AsyncLogWriter.hpp"
+#include "Log.hpp"
+#include "Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    const size_t logRingCapacity = 256 * 1024;
+    const size_t logRecordAlignment = 8;
+    const uint32_t logFlushIntervalMs = 50;
+
+    size_t alignRecordSize(size_t size)
+    {
+        return (size + logRecordAlignment - 1) & ~(logRecordAlignment - 1);
+    }
+
+    int64_t getLogTimestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    thread_local std::shared_ptr<LogRingBuffer> t_logRing;
+    thread_local AsyncLogWriter* t_logRingOwner = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// LogRingBuffer
+LogRingBuffer::LogRingBuffer(size_t capacity) : m_data(new char[capacity]), m_capacity(capacity), m_head(0), m_tail(0), m_dropped(0)
+{
+}
+
+LogRingBuffer::~LogRingBuffer()
+{
+    delete[] m_data;
+}
+
+bool LogRingBuffer::push(FILE* file, int64_t timestamp, const char* source, const char* text)
+{
+    const size_t sourceLength = source != nullptr ? strlen(source) + 2 : 0;
+    const size_t textLength = std::min(sourceLength + strlen(text), getMaxTextLength());
+    const size_t recordSize = alignRecordSize(sizeof(LogRecordHeader) + textLength);
+
+    size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+
+    size_t offset = head & (m_capacity - 1);
+    const size_t contiguous = m_capacity - offset;
+
+    // records never wrap, the rest of the buffer is skipped instead
+    const size_t needed = contiguous < recordSize ? recordSize + contiguous : recordSize;
+    if (m_capacity - (head - tail) < needed)
+        return false;
+
+    if (contiguous < recordSize)
+    {
+        // the reader skips gaps smaller than a header on its own
+        if (contiguous >= sizeof(LogRecordHeader))
+        {
+            LogRecordHeader* filler = reinterpret_cast<LogRecordHeader*>(m_data + offset);
+            filler->size = static_cast<uint32_t>(contiguous);
+            filler->textLength = 0;
+            filler->file = nullptr;
+        }
+
+        head += contiguous;
+        offset = 0;
+    }
+
+    LogRecordHeader* header = reinterpret_cast<LogRecordHeader*>(m_data + offset);
+    header->size = static_cast<uint32_t>(recordSize);
+    header->textLength = static_cast<uint32_t>(textLength);
+    header->file = file;
+    header->timestamp = timestamp;
+
+    char* out = m_data + offset + sizeof(LogRecordHeader);
+    size_t copied = 0;
+    if (source != nullptr)
+    {
+        const size_t length = std::min(sourceLength - 2, textLength);
+        memcpy(out, source, length);
+        copied = length;
+
+        for (const char* separator = ": "; *separator != '\0' && copied < textLength; ++separator)
+            out[copied++] = *separator;
+    }
+
+    memcpy(out + copied, text, textLength - copied);
+
+    m_head.store(head + recordSize, std::memory_order_release);
+    return true;
+}
+
+size_t LogRingBuffer::peek(std::vector<const LogRecordHeader*>& records) const
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+
+    while (tail != head)
+    {
+        const size_t offset = tail & (m_capacity - 1);
+        const size_t contiguous = m_capacity - offset;
+        if (contiguous < sizeof(LogRecordHeader))
+        {
+            tail += contiguous;
+            continue;
+        }
+
+        const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(m_data + offset);
+        if (header->file != nullptr)
+            records.push_back(header);
+
+        tail += header->size;
+    }
+
+    return tail;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// AsyncLogWriter
+AsyncLogWriter::AsyncLogWriter() : m_running(false), m_stopping(false), m_activeWriters(0), m_policy(LOG_OVERFLOW_BLOCK), m_rotateSize(0),
+    m_draining(false), m_cachedSecond(-1), m_droppedTotal(0), m_writtenBytes(0)
+{
+    m_cachedTime[0] = '\0';
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    stop();
+}
+
+void AsyncLogWriter::start(LogOverflowPolicy policy, uint64_t rotateSize)
+{
+    if (m_running)
+        return;
+
+    m_policy = policy;
+    m_rotateSize = rotateSize;
+    m_stopping = false;
+
+    m_thread = std::thread(&AsyncLogWriter::_run, this);
+    m_running.store(true, std::memory_order_release);
+}
+
+void AsyncLogWriter::stop()
+{
+    if (!m_running.load())
+        return;
+
+    // new messages wait until everything queued is written, then they go to the file directly
+    {
+        std::lock_guard<std::mutex> guard(m_wakeLock);
+        m_draining = true;
+    }
+
+    m_running.store(false);
+
+    // writers which saw m_running before finish their push, the writer thread still frees space for them
+    while (m_activeWriters.load() != 0)
+        std::this_thread::yield();
+
+    {
+        std::lock_guard<std::mutex> guard(m_wakeLock);
+        m_stopping = true;
+    }
+
+    m_wakeCond.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    // nothing can be queued anymore, write what the thread left behind
+    while (_flush())
+    {
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_wakeLock);
+        m_draining = false;
+    }
+
+    m_drainCond.notify_all();
+}
+
+void AsyncLogWriter::registerFile(FILE* file, const std::string& fileName)
+{
+    if (file == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_flushLock);
+
+    FileTarget target;
+    target.file = file;
+    target.fileName = fileName;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    target.size = size > 0 ? static_cast<uint64_t>(size) : 0;
+
+    m_targets.push_back(target);
+}
+
+LogRingBuffer* AsyncLogWriter::_getThreadRing()
+{
+    if (t_logRingOwner != this)
+    {
+        t_logRing = std::make_shared<LogRingBuffer>(logRingCapacity);
+        t_logRingOwner = this;
+
+        std::lock_guard<std::mutex> guard(m_ringLock);
+        m_rings.push_back(t_logRing);
+    }
+
+    return t_logRing.get();
+}
+
+bool AsyncLogWriter::write(FILE* file, const char* source, const char* text)
+{
+    // pairs with stop, which clears m_running before it waits for m_activeWriters
+    m_activeWriters.fetch_add(1);
+    if (!m_running.load())
+    {
+        m_activeWriters.fetch_sub(1);
+
+        // the records queued before must not end up behind this message, stop sets
+        // m_draining before it clears m_running
+        if (m_draining.load())
+        {
+            std::unique_lock<std::mutex> guard(m_wakeLock);
+            m_drainCond.wait(guard, [this] { return !m_draining.load(); });
+        }
+
+        return false;
+    }
+
+    LogRingBuffer* ring = _getThreadRing();
+    const int64_t timestamp = getLogTimestamp();
+
+    while (!ring->push(file, timestamp, source, text))
+    {
+        if (m_policy == LOG_OVERFLOW_DROP)
+        {
+            ring->addDropped();
+            break;
+        }
+
+        m_wakeCond.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    m_activeWriters.fetch_sub(1);
+    return true;
+}
+
+void AsyncLogWriter::_run()
+{
+    SetThreadName("AsyncLogWriter");
+
+    std::unique_lock<std::mutex> guard(m_wakeLock);
+    while (!m_stopping)
+    {
+        m_wakeCond.wait_for(guard, std::chrono::milliseconds(logFlushIntervalMs));
+
+        guard.unlock();
+        while (_flush())
+        {
+            // keep going while the producers fill the rings faster than one interval
+        }
+        guard.lock();
+    }
+}
+
+bool AsyncLogWriter::_flush()
+{
+    std::lock_guard<std::mutex> flushGuard(m_flushLock);
+
+    std::vector<std::shared_ptr<LogRingBuffer>> rings;
+    {
+        std::lock_guard<std::mutex> guard(m_ringLock);
+
+        // drop rings of finished threads once everything they queued was written
+        for (std::vector<std::shared_ptr<LogRingBuffer>>::iterator itr = m_rings.begin(); itr != m_rings.end();)
+        {
+            if (itr->use_count() == 1 && (*itr)->isEmpty())
+                itr = m_rings.erase(itr);
+            else
+                ++itr;
+        }
+
+        rings = m_rings;
+    }
+
+    m_records.clear();
+
+    std::vector<size_t> positions(rings.size());
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        positions[i] = rings[i]->peek(m_records);
+        dropped += rings[i]->takeDropped();
+    }
+
+    if (m_records.empty() && dropped == 0)
+        return false;
+
+    // stable, so records of one thread with the same timestamp keep their order
+    std::stable_sort(m_records.begin(), m_records.end(), [](const LogRecordHeader* a, const LogRecordHeader* b)
+    {
+        return a->timestamp < b->timestamp;
+    });
+
+    for (std::vector<const LogRecordHeader*>::const_iterator itr = m_records.begin(); itr != m_records.end(); ++itr)
+    {
+        const LogRecordHeader* record = *itr;
+
+        FileTarget* target = _getTarget(record->file);
+        _appendTimestamp(target->buffer, record->timestamp);
+        target->buffer.append(record->getText(), record->textLength);
+        target->buffer.push_back('\n');
+    }
+
+    const size_t recordCount = m_records.size();
+
+    // the records point into the rings, free them only after they were copied
+    for (size_t i = 0; i < rings.size(); ++i)
+        rings[i]->release(positions[i]);
+
+    if (dropped != 0 && !m_targets.empty())
+    {
+        m_droppedTotal.fetch_add(dropped, std::memory_order_relaxed);
+
+        char message[64];
+        snprintf(message, sizeof(message), "AsyncLogWriter : %llu messages dropped", static_cast<unsigned long long>(dropped));
+
+        _appendTimestamp(m_targets.front().buffer, getLogTimestamp());
+        m_targets.front().buffer.append(message).push_back('\n');
+    }
+
+    for (std::vector<FileTarget>::iterator itr = m_targets.begin(); itr != m_targets.end(); ++itr)
+    {
+        if (itr->buffer.empty())
+            continue;
+
+        fwrite(itr->buffer.data(), 1, itr->buffer.size(), itr->file);
+        fflush(itr->file);
+
+        itr->size += itr->buffer.size();
+        m_writtenBytes.fetch_add(itr->buffer.size(), std::memory_order_relaxed);
+        itr->buffer.clear();
+
+        if (m_rotateSize != 0 && itr->size >= m_rotateSize && !itr->fileName.empty())
+            _rotate(*itr);
+    }
+
+    // a full batch means there is probably more waiting
+    return recordCount >= 1024;
+}
+
+void AsyncLogWriter::_appendTimestamp(std::string& buffer, int64_t timestamp)
+{
+    // same format as the synchronous AscEmuLog::WriteFile, formatted once per second
+    const int64_t second = timestamp / 1000000;
+    if (second != m_cachedSecond)
+    {
+        const time_t seconds = static_cast<time_t>(second);
+        tm localTime;
+#ifdef _WIN32
+        localtime_s(&localTime, &seconds);
+#else
+        localtime_r(&seconds, &localTime);
+#endif
+        strftime(m_cachedTime, sizeof(m_cachedTime), "%H:%M:%S", &localTime);
+        m_cachedSecond = second;
+    }
+
+    buffer.push_back('[');
+    buffer.append(m_cachedTime);
+    buffer.append("]  ");
+}
+
+void AsyncLogWriter::_rotate(FileTarget& target)
+{
+    // keep the FILE pointer, AscEmuLog and the queued records still refer to it
+    std::string baseName = target.fileName;
+    const std::string::size_type extension = baseName.rfind(".log");
+    if (extension != std::string::npos)
+        baseName.erase(extension);
+
+    // several rotations within one second must not overwrite each other
+    std::string archiveName = AELog::GetFormattedFileName("", baseName, true);
+    for (uint32_t i = 1; FILE* existing = fopen(archiveName.c_str(), "r"); ++i)
+    {
+        fclose(existing);
+        archiveName = AELog::GetFormattedFileName("", baseName + "." + std::to_string(i), true);
+    }
+
+    fflush(target.file);
+    if (rename(target.fileName.c_str(), archiveName.c_str()) != 0)
+    {
+        // try again once the file grew by another rotation size
+        target.size = 0;
+        return;
+    }
+
+    if (freopen(target.fileName.c_str(), "a", target.file) == nullptr)
+        return;
+
+    target.size = 0;
+}
+
+AsyncLogWriter::FileTarget* AsyncLogWriter::_getTarget(FILE* file)
+{
+    for (std::vector<FileTarget>::iterator itr = m_targets.begin(); itr != m_targets.end(); ++itr)
+    {
+        if (itr->file == file)
+            return &*itr;
+    }
+
+    // files which were not registered are written without rotation
+    FileTarget target;
+    target.file = file;
+    target.size = 0;
+    m_targets.push_back(target);
+
+    return &m_targets.back();
+}
@@ -0,0 +1,156 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+#include "LogDefines.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Record stored in a LogRingBuffer, the message text follows the header directly.
+/// A header without file is a filler covering the end of the buffer before a wrap.
+//////////////////////////////////////////////////////////////////////////////////////////
+struct LogRecordHeader
+{
+    uint32_t size;          // header + text, aligned to 8 bytes
+    uint32_t textLength;
+    FILE* file;
+    int64_t timestamp;      // microseconds since epoch, taken by the producer
+
+    const char* getText() const { return reinterpret_cast<const char*>(this + 1); }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Single producer / single consumer byte ring of log records.
+/// The owning thread writes records, the log writer thread reads them. Neither side locks.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL LogRingBuffer
+{
+    public:
+
+        /// capacity has to be a power of two
+        explicit LogRingBuffer(size_t capacity);
+        ~LogRingBuffer();
+
+        /// copies "source: text" into the ring, returns false when the ring is full
+        bool push(FILE* file, int64_t timestamp, const char* source, const char* text);
+
+        /// appends all complete records to records and returns the read position after them
+        size_t peek(std::vector<const LogRecordHeader*>& records) const;
+
+        /// frees everything before position, which has to come from peek
+        void release(size_t position) { m_tail.store(position, std::memory_order_release); }
+
+        bool isEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed); }
+
+        uint64_t takeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+        void addDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+
+        /// longest text a single record can hold, longer messages are truncated
+        size_t getMaxTextLength() const { return m_capacity / 4 - sizeof(LogRecordHeader); }
+
+    private:
+
+        LogRingBuffer(const LogRingBuffer&) = delete;
+        LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+        char* m_data;
+        size_t m_capacity;
+
+        // producer and consumer positions only grow, the offset is position & (capacity - 1)
+        alignas(64) std::atomic<size_t> m_head;
+        alignas(64) std::atomic<size_t> m_tail;
+        std::atomic<uint64_t> m_dropped;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Background file writer for AscEmuLog.
+///
+/// Every logging thread gets its own LogRingBuffer on first use. One writer thread wakes
+/// up periodically, collects the records of all rings, orders them by time, formats the
+/// timestamps and writes one large block per file. Files are rotated by size.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL AsyncLogWriter
+{
+    public:
+
+        AsyncLogWriter();
+        ~AsyncLogWriter();
+
+        /// rotateSize in bytes, 0 disables rotation
+        void start(LogOverflowPolicy policy, uint64_t rotateSize);
+
+        /// stops the writer thread after writing everything still queued, messages logged
+        /// meanwhile wait for that and are written synchronously afterwards
+        void stop();
+
+        bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+        /// file has to stay open until the writer is stopped, fileName is used for rotation
+        void registerFile(FILE* file, const std::string& fileName);
+
+        /// called by the logging thread, returns false when the writer is not running and
+        /// the caller has to write the message itself (dropped messages are only counted)
+        bool write(FILE* file, const char* source, const char* text);
+
+        uint64_t getDroppedCount() const { return m_droppedTotal.load(std::memory_order_relaxed); }
+        uint64_t getWrittenBytes() const { return m_writtenBytes.load(std::memory_order_relaxed); }
+
+    private:
+
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        struct FileTarget
+        {
+            FILE* file;
+            std::string fileName;
+            uint64_t size;
+            std::string buffer;
+        };
+
+        LogRingBuffer* _getThreadRing();
+        void _run();
+        bool _flush();
+        void _appendTimestamp(std::string& buffer, int64_t timestamp);
+        void _rotate(FileTarget& target);
+        FileTarget* _getTarget(FILE* file);
+
+        std::atomic<bool> m_running;
+        std::atomic<bool> m_stopping;
+        std::atomic<uint32_t> m_activeWriters;     // write calls which saw m_running and did not finish their push yet
+        LogOverflowPolicy m_policy;
+        uint64_t m_rotateSize;
+
+        std::thread m_thread;
+        std::mutex m_wakeLock;
+        std::condition_variable m_wakeCond;
+        std::condition_variable m_drainCond;
+        std::atomic<bool> m_draining;               // stop is writing the queued records, changed under m_wakeLock
+
+        // rings of all threads which ever logged, a ring is released when its thread ended and it is empty
+        std::mutex m_ringLock;
+        std::vector<std::shared_ptr<LogRingBuffer>> m_rings;
+
+        // used by the writer thread, stop and registerFile
+        std::mutex m_flushLock;
+        std::vector<FileTarget> m_targets;
+        std::vector<const LogRecordHeader*> m_records;
+        int64_t m_cachedSecond;
+        char m_cachedTime[16];
+
+        std::atomic<uint64_t> m_droppedTotal;
+        std::atomic<uint64_t> m_writtenBytes;
+};
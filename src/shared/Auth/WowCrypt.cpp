@@ -34,21 +34,34 @@ bool WowCrypt::isInitialized()
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // WotLK
+namespace
+{
+    const uint8_t wotlkServerSeed[WowCrypt::seedLenght] = { 0xC2, 0xB3, 0x72, 0x3C, 0xC6, 0xAE, 0xD9, 0xB5, 0x34, 0x3C, 0x53, 0xEE, 0x2F, 0x43, 0x67, 0xCE };
+    const uint8_t wotlkClientSeed[WowCrypt::seedLenght] = { 0xCC, 0x98, 0xAE, 0x04, 0xE8, 0x97, 0xEA, 0xCA, 0x12, 0xDD, 0xC0, 0x93, 0x42, 0x91, 0x53, 0x57 };
+}
+
 void WowCrypt::initWotlkCrypt(uint8_t* key)
 {
-    static const uint8_t send[seedLenght] = { 0xC2, 0xB3, 0x72, 0x3C, 0xC6, 0xAE, 0xD9, 0xB5, 0x34, 0x3C, 0x53, 0xEE, 0x2F, 0x43, 0x67, 0xCE };
-    static const uint8_t recv[seedLenght] = { 0xCC, 0x98, 0xAE, 0x04, 0xE8, 0x97, 0xEA, 0xCA, 0x12, 0xDD, 0xC0, 0x93, 0x42, 0x91, 0x53, 0x57 };
+    _initWotlkCrypt(key, wotlkServerSeed, wotlkClientSeed);
+}
+
+void WowCrypt::initWotlkClientCrypt(uint8_t* key)
+{
+    _initWotlkCrypt(key, wotlkClientSeed, wotlkServerSeed);
+}
 
+void WowCrypt::_initWotlkCrypt(uint8_t* key, const uint8_t* decryptSeed, const uint8_t* encryptSeed)
+{
     uint8_t encryptHash[SHA_DIGEST_LENGTH];
     uint8_t decryptHash[SHA_DIGEST_LENGTH];
 
     uint8_t pass[1024];
     uint32_t mdLength;
 
-    HMAC(EVP_sha1(), send, seedLenght, key, 40, decryptHash, &mdLength);
+    HMAC(EVP_sha1(), decryptSeed, seedLenght, key, 40, decryptHash, &mdLength);
     assert(mdLength == SHA_DIGEST_LENGTH);
 
-    HMAC(EVP_sha1(), recv, seedLenght, key, 40, encryptHash, &mdLength);
+    HMAC(EVP_sha1(), encryptSeed, seedLenght, key, 40, encryptHash, &mdLength);
     assert(mdLength == SHA_DIGEST_LENGTH);
 
     RC4_set_key(&m_clientWotlkDecryptKey, SHA_DIGEST_LENGTH, decryptHash);
@@ -35,7 +35,12 @@ class WowCrypt
         void decryptWotlkReceive(uint8_t* data, size_t length);
         void encryptWotlkSend(uint8_t* data, size_t length);
 
+        /// the client side of initWotlkCrypt, decrypts what the server encrypts and the other way round
+        void initWotlkClientCrypt(uint8_t* key);
+
     private:
+        void _initWotlkCrypt(uint8_t* key, const uint8_t* decryptSeed, const uint8_t* encryptSeed);
+
         RC4_KEY m_clientWotlkDecryptKey;
         RC4_KEY m_serverWotlkEncryptKey;
 
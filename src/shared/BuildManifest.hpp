@@ -0,0 +1,273 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// 64 bit FNV-1a hash of everything a generated file is built from. It is not meant to
+/// resist collisions on purpose, it only has to notice changed inputs.
+//////////////////////////////////////////////////////////////////////////////////////////
+class BuildHash
+{
+    public:
+
+        BuildHash() : m_value(offsetBasis) {}
+
+        void addBytes(const void* data, size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; ++i)
+                m_value = (m_value ^ bytes[i]) * prime;
+        }
+
+        /// numbers and enums, e.g. generator settings
+        template <typename T>
+        void add(T value)
+        {
+            static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "use addBytes or addString");
+            addBytes(&value, sizeof(T));
+        }
+
+        void addString(const std::string& text)
+        {
+            add(static_cast<uint64_t>(text.size()));
+            addBytes(text.data(), text.size());
+        }
+
+        /// adds the size and content of the file, a missing file is hashed as missing
+        bool addFile(const std::string& fileName)
+        {
+            FILE* file = fopen(fileName.c_str(), "rb");
+            if (file == nullptr)
+            {
+                add(UINT64_MAX);
+                return false;
+            }
+
+            uint8_t buffer[64 * 1024];
+            uint64_t size = 0;
+            size_t count;
+            while ((count = fread(buffer, 1, sizeof(buffer), file)) != 0)
+            {
+                addBytes(buffer, count);
+                size += count;
+            }
+
+            fclose(file);
+            add(size);
+            return true;
+        }
+
+        void addHash(const BuildHash& hash) { add(hash.get()); }
+
+        uint64_t get() const { return m_value; }
+
+    private:
+
+        static const uint64_t offsetBasis = 14695981039346656037ULL;
+        static const uint64_t prime = 1099511628211ULL;
+
+        uint64_t m_value;
+};
+
+enum BuildState
+{
+    BUILD_STATE_UP_TO_DATE,
+    BUILD_STATE_NOT_BUILT,      // no entry, e.g. the first incremental run
+    BUILD_STATE_CHANGED,        // built from other inputs
+    BUILD_STATE_MISSING         // same inputs but the file is gone
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Remembers the input hash of every file a generator wrote into its output directory, so
+/// a rerun only rebuilds files whose inputs changed. Stored as manifest.txt in the output
+/// directory, one "<hash> <+|-> <file>" line per output. '-' marks inputs which produced
+/// no file (e.g. a tile without polygons), those are not built again either.
+///
+/// All methods lock, generators with several threads share one manifest.
+//////////////////////////////////////////////////////////////////////////////////////////
+class BuildManifest
+{
+    public:
+
+        explicit BuildManifest(const std::string& directory) : m_directory(directory), m_fileName(directory + "/manifest.txt") {}
+
+        /// false if there is no manifest yet, everything is built then
+        bool load()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_entries.clear();
+
+            FILE* file = fopen(m_fileName.c_str(), "r");
+            if (file == nullptr)
+                return false;
+
+            char line[1024];
+            if (fgets(line, sizeof(line), file) == nullptr || strncmp(line, getHeader(), strlen(getHeader())) != 0)
+            {
+                // unknown format, rebuild everything
+                printf("Ignoring %s, it was written by another version\n", m_fileName.c_str());
+                fclose(file);
+                return false;
+            }
+
+            while (fgets(line, sizeof(line), file) != nullptr)
+            {
+                line[strcspn(line, "\r\n")] = '\0';
+
+                uint64_t hash;
+                char written;
+                int nameStart = 0;
+                if (sscanf(line, "%" SCNx64 " %c %n", &hash, &written, &nameStart) != 2 || nameStart == 0 || line[nameStart] == '\0')
+                    continue;
+
+                m_entries[line + nameStart] = Entry(hash, written == '+');
+            }
+
+            fclose(file);
+            return true;
+        }
+
+        bool save()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            // a generator killed while saving keeps the previous manifest
+            const std::string tempName = m_fileName + ".tmp";
+            FILE* file = fopen(tempName.c_str(), "w");
+            if (file == nullptr)
+            {
+                printf("Could not open %s for writing\n", tempName.c_str());
+                return false;
+            }
+
+            bool written = fprintf(file, "%s\n", getHeader()) > 0;
+            for (std::map<std::string, Entry>::const_iterator itr = m_entries.begin(); itr != m_entries.end() && written; ++itr)
+                written = fprintf(file, "%016" PRIx64 " %c %s\n", itr->second.hash, itr->second.written ? '+' : '-', itr->first.c_str()) > 0;
+
+            if (fclose(file) != 0 || !written)
+            {
+                printf("Could not write %s\n", tempName.c_str());
+                return false;
+            }
+
+#ifdef _WIN32
+            remove(m_fileName.c_str());
+#endif
+            if (rename(tempName.c_str(), m_fileName.c_str()) != 0)
+            {
+                printf("Could not replace %s\n", m_fileName.c_str());
+                return false;
+            }
+
+            return true;
+        }
+
+        /// output is relative to the output directory
+        BuildState check(const std::string& output, uint64_t hash) const
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+
+            std::map<std::string, Entry>::const_iterator itr = m_entries.find(output);
+            if (itr == m_entries.end())
+                return BUILD_STATE_NOT_BUILT;
+
+            if (itr->second.hash != hash)
+                return BUILD_STATE_CHANGED;
+
+            const bool written = itr->second.written;
+            guard.unlock();
+
+            if (written)
+            {
+                FILE* file = fopen((m_directory + "/" + output).c_str(), "rb");
+                if (file == nullptr)
+                    return BUILD_STATE_MISSING;
+
+                fclose(file);
+            }
+
+            return BUILD_STATE_UP_TO_DATE;
+        }
+
+        bool isUpToDate(const std::string& output, uint64_t hash) const { return check(output, hash) == BUILD_STATE_UP_TO_DATE; }
+
+        /// call after the output was written, written is false if the inputs give no file
+        void set(const std::string& output, uint64_t hash, bool written = true)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_entries[output] = Entry(hash, written);
+        }
+
+        /// call when building the output failed
+        void erase(const std::string& output)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_entries.erase(output);
+        }
+
+        /// the outputs whose name starts with prefix, e.g. to remove files a rebuild no longer writes
+        std::vector<std::string> getFiles(const std::string& prefix) const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            std::vector<std::string> files;
+            for (std::map<std::string, Entry>::const_iterator itr = m_entries.lower_bound(prefix); itr != m_entries.end(); ++itr)
+            {
+                if (itr->first.compare(0, prefix.size(), prefix) != 0)
+                    break;
+
+                files.push_back(itr->first);
+            }
+
+            return files;
+        }
+
+        static const char* getStateName(BuildState state)
+        {
+            switch (state)
+            {
+                case BUILD_STATE_UP_TO_DATE:
+                    return "up to date";
+                case BUILD_STATE_NOT_BUILT:
+                    return "not in manifest";
+                case BUILD_STATE_CHANGED:
+                    return "inputs changed";
+                case BUILD_STATE_MISSING:
+                    return "file missing";
+            }
+
+            return "unknown";
+        }
+
+    private:
+
+        struct Entry
+        {
+            Entry() : hash(0), written(false) {}
+            Entry(uint64_t _hash, bool _written) : hash(_hash), written(_written) {}
+
+            uint64_t hash;
+            bool written;
+        };
+
+        static const char* getHeader() { return "# AscEmu build manifest 1"; }
+
+        const std::string m_directory;
+        const std::string m_fileName;
+
+        mutable std::mutex m_lock;
+        std::map<std::string, Entry> m_entries;
+};
@@ -35,7 +35,7 @@ SQLCallbackBase::~SQLCallbackBase()
 
 }
 
-Database::Database() : CThread()
+Database::Database() : CThread(), mSyncQueryProfile(1)
 {
     _counter = 0;
     Connections = NULL;
@@ -77,6 +77,8 @@ DatabaseConnection* Database::GetFreeConnection()
 // Use this when we request data that can return a value (not async)
 QueryResult* Database::Query(const char* QueryString, ...)
 {
+    ProfileScope profile("Database::Query", PROFILE_CATEGORY_DATABASE, 0, _GetSyncQueryCounter());
+
     char sql[16384];
     va_list vlist;
     va_start(vlist, QueryString);
@@ -96,6 +98,8 @@ QueryResult* Database::Query(const char* QueryString, ...)
 
 QueryResult* Database::Query(bool *success, const char* QueryString, ...)
 {
+    ProfileScope profile("Database::Query", PROFILE_CATEGORY_DATABASE, 0, _GetSyncQueryCounter());
+
     char sql[16384];
     va_list vlist;
     va_start(vlist, QueryString);
@@ -122,6 +126,8 @@ QueryResult* Database::Query(bool *success, const char* QueryString, ...)
 
 QueryResult* Database::QueryNA(const char* QueryString)
 {
+    ProfileScope profile("Database::QueryNA", PROFILE_CATEGORY_DATABASE, 0, _GetSyncQueryCounter());
+
     // Send the query
     QueryResult* qResult = NULL;
     DatabaseConnection* con = GetFreeConnection();
@@ -241,6 +247,8 @@ bool Database::ExecuteNA(const char* QueryString)
 // Wait till the other queries are done, then execute
 bool Database::WaitExecute(const char* QueryString, ...)
 {
+    ProfileScope profile("Database::WaitExecute", PROFILE_CATEGORY_DATABASE, 0, _GetSyncQueryCounter());
+
     char sql[16384];
     va_list vlist;
     va_start(vlist, QueryString);
@@ -255,6 +263,8 @@ bool Database::WaitExecute(const char* QueryString, ...)
 
 bool Database::WaitExecuteNA(const char* QueryString)
 {
+    ProfileScope profile("Database::WaitExecuteNA", PROFILE_CATEGORY_DATABASE, 0, _GetSyncQueryCounter());
+
     DatabaseConnection* con = GetFreeConnection();
     bool Result = _SendQuery(con, QueryString, false);
     con->Busy.Release();
@@ -24,6 +24,7 @@
 #include "Field.h"
 #include "../Threading/Queue.h"
 #include "../CallBack.h"
+#include "../TickProfiler.hpp"
 #include <string>
 
 class QueryResult;
@@ -111,6 +112,10 @@ class SERVER_DECL Database : public CThread
         inline const std::string & GetDatabaseName() { return mDatabaseName; }
         inline const uint32 GetQueueSize() { return queries_queue.get_size(); }
 
+        // time the callers spent in Query/QueryNA/WaitExecute while the profiler was enabled
+        inline ProfileCounter GetSyncQueryProfile() const { return mSyncQueryProfile.getSum(0); }
+        inline void ResetSyncQueryProfile() { mSyncQueryProfile.reset(); }
+
         virtual std::string EscapeString(std::string Escape) = 0;
         virtual void EscapeLongString(const char* str, uint32 len, std::stringstream & out) = 0;
         virtual std::string EscapeString(const char* esc, DatabaseConnection* con) = 0;
@@ -144,6 +149,9 @@ class SERVER_DECL Database : public CThread
         virtual bool _SendQuery(DatabaseConnection* con, const char* Sql, bool Self) = 0;
         virtual QueryResult* _StoreQueryResult(DatabaseConnection* con) = 0;
 
+        // counter of the calling thread, only looked up while profiling
+        ProfileCounter* _GetSyncQueryCounter() { return TickProfiler::isEnabled() ? &mSyncQueryProfile.get(0) : nullptr; }
+
         //////////////////////////////////////////////////////////////////////////////////////////
         FQueue<QueryBuffer*> query_buffer;
 
@@ -164,6 +172,8 @@ class SERVER_DECL Database : public CThread
         uint32 mPort;
 
         QueryThread* qt;
+
+        ProfileCounterTable mSyncQueryProfile;
 };
 
 class SERVER_DECL QueryResult
@@ -4,6 +4,7 @@ This file is released under the MIT license. See README-MIT for more information
 */
 
 #include "Log.hpp"
+#include "AsyncLogWriter.hpp"
 #include "Util.hpp"
 
 #include <iostream>
@@ -108,10 +109,19 @@ void AscEmuLog::InitalizeLogFiles(std::string file_prefix)
         std::cerr << __FUNCTION__ << " : Error opening file " << normal_filename << std::endl;
     else
         ConsoleLogError(true, "=================[%s]=================", current_date_time.c_str());
+
+    if (async_writer == nullptr)
+        async_writer = new AsyncLogWriter;
+
+    async_writer->registerFile(normal_log_file, normal_filename);
+    async_writer->registerFile(error_log_file, error_filename);
 }
 
 void AscEmuLog::WriteFile(FILE* file, char* msg, const char* source)
 {
+    if (async_writer != nullptr && async_writer->write(file, source, msg))
+        return;
+
     std::string current_time = "[" + Util::GetCurrentTimeString() + "] ";
     if (source != NULL)
         fprintf(file, "%s %s: %s\n", current_time.c_str(), source, msg);
@@ -119,6 +129,26 @@ void AscEmuLog::WriteFile(FILE* file, char* msg, const char* source)
         fprintf(file, "%s %s\n", current_time.c_str(), msg);
 }
 
+void AscEmuLog::StartAsyncFileWriter(LogOverflowPolicy policy, uint64_t rotate_size)
+{
+    if (async_writer == nullptr)
+        async_writer = new AsyncLogWriter;
+
+    async_writer->start(policy, rotate_size);
+}
+
+void AscEmuLog::StopAsyncFileWriter()
+{
+    if (async_writer == nullptr)
+        return;
+
+    // writes everything still queued before the files get closed
+    async_writer->stop();
+
+    delete async_writer;
+    async_writer = nullptr;
+}
+
 #ifndef _WIN32
 void AscEmuLog::SetConsoleColor(const char* color)
 {
@@ -8,6 +8,8 @@ This file is released under the MIT license. See README-MIT for more information
 
 #include "Log.Legacy.h"
 
+class AsyncLogWriter;
+
 namespace AELog
 {
     /*! \brief Returns formatted file name based on input */
@@ -29,15 +31,20 @@ class SERVER_DECL AscEmuLog : public Singleton<AscEmuLog>
     uint32_t aelog_file_log_level;
     uint32_t aelog_debug_flags;
 
+    // created with the log files, kept as pointer because ~AscEmuLog is called by hand before the static instance is destroyed
+    AsyncLogWriter* async_writer;
+
 #ifdef _WIN32
     HANDLE handle_stdout;
 #endif
 
     public:
 
-        AscEmuLog() : normal_log_file(nullptr), error_log_file(nullptr), aelog_file_log_level(0), aelog_debug_flags(0) {}
+        AscEmuLog() : normal_log_file(nullptr), error_log_file(nullptr), aelog_file_log_level(0), aelog_debug_flags(0), async_writer(nullptr) {}
         ~AscEmuLog()
         {
+            StopAsyncFileWriter();
+
             if (normal_log_file != nullptr)
             {
                 fflush(normal_log_file);
@@ -57,6 +64,11 @@ class SERVER_DECL AscEmuLog : public Singleton<AscEmuLog>
 
         void WriteFile(FILE* file, char* msg, const char* source = NULL);
 
+        /*! \brief Moves all file writes to a background thread, rotate_size in bytes (0 = never rotate) */
+        void StartAsyncFileWriter(LogOverflowPolicy policy, uint64_t rotate_size);
+        void StopAsyncFileWriter();
+        AsyncLogWriter* GetAsyncFileWriter() const { return async_writer; }
+
 #ifndef _WIN32
         void SetConsoleColor(const char* color);
 #else
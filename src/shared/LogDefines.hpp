@@ -53,4 +53,10 @@ enum LogLevel
     LL_DEBUG     = 2
 };
 
+enum LogOverflowPolicy
+{
+    LOG_OVERFLOW_DROP   = 0,        // count and discard messages while the log buffer of a thread is full
+    LOG_OVERFLOW_BLOCK  = 1         // wait for the log writer thread to make room
+};
+
 #endif  // LOG_DEFINES_HPP
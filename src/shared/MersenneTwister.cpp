@@ -52,6 +52,19 @@ void InitRandomNumberGenerators()
     }
 }
 
+void SeedRandomNumberGenerators(uint32 seed)
+{
+    srand(seed);
+    for(uint32 i = 0; i < NUMBER_OF_GENERATORS; ++i)
+    {
+        m_locks[i]->Acquire();
+        m_generators[i]->RandomInit(seed + i);
+        m_locks[i]->Release();
+    }
+
+    counter.SetVal(0);
+}
+
 void CleanupRandomNumberGenerators()
 {
     srand(getMSTime());
@@ -25,6 +25,8 @@
 
 SERVER_DECL void InitRandomNumberGenerators();
 SERVER_DECL void ReseedRandomNumberGenerators();
+/// Seeds all generators from one value, the same seed gives the same sequences (as long as a single thread draws)
+SERVER_DECL void SeedRandomNumberGenerators(uint32 seed);
 SERVER_DECL void CleanupRandomNumberGenerators();
 SERVER_DECL double RandomDouble();
 SERVER_DECL double RandomDouble(double n);
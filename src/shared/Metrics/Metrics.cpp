@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Metrics.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MetricHistogram
+MetricHistogram::MetricHistogram(std::initializer_list<uint64_t> bounds) : m_boundCount(0), m_count(0), m_sum(0)
+{
+    for (std::initializer_list<uint64_t>::const_iterator itr = bounds.begin(); itr != bounds.end() && m_boundCount < maxBounds; ++itr)
+        m_bounds[m_boundCount++] = *itr;
+
+    for (size_t i = 0; i <= maxBounds; ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void MetricHistogram::observe(uint64_t value)
+{
+    size_t bucket = 0;
+    while (bucket < m_boundCount && value > m_bounds[bucket])
+        ++bucket;
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MetricsWriter
+void MetricsWriter::family(const char* name, const char* type, const char* help)
+{
+    m_text.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    m_text.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void MetricsWriter::sample(const char* name, const std::string& labels, double value)
+{
+    m_text.append(name);
+    if (!labels.empty())
+        m_text.append("{").append(labels).append("}");
+
+    m_text.append(" ");
+    _appendValue(value);
+    m_text.append("\n");
+}
+
+void MetricsWriter::histogram(const char* name, const std::string& labels, size_t boundCount, const uint64_t* bounds, const uint64_t* buckets,
+    uint64_t sum, double scale)
+{
+    const std::string separator = labels.empty() ? "" : ",";
+    const std::string bucketName = std::string(name) + "_bucket";
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= boundCount; ++i)
+    {
+        cumulative += buckets[i];
+
+        std::string bound = "+Inf";
+        if (i < boundCount)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "%g", bounds[i] / scale);
+            bound = text;
+        }
+
+        sample(bucketName.c_str(), labels + separator + "le=\"" + bound + "\"", static_cast<double>(cumulative));
+    }
+
+    sample((std::string(name) + "_sum").c_str(), labels, sum / scale);
+    sample((std::string(name) + "_count").c_str(), labels, static_cast<double>(cumulative));
+}
+
+void MetricsWriter::histogram(const char* name, const std::string& labels, const MetricHistogram& histogram, double scale)
+{
+    uint64_t buckets[MetricHistogram::maxBounds + 1];
+    for (size_t i = 0; i <= histogram.getBoundCount(); ++i)
+        buckets[i] = histogram.getBucket(i);
+
+    this->histogram(name, labels, histogram.getBoundCount(), histogram.getBounds(), buckets, histogram.getSum(), scale);
+}
+
+std::string MetricsWriter::label(const char* name, const std::string& value)
+{
+    std::string text = std::string(name) + "=\"";
+    for (std::string::const_iterator itr = value.begin(); itr != value.end(); ++itr)
+    {
+        if (*itr == '\\' || *itr == '"')
+            text += '\\';
+
+        if (*itr == '\n')
+            text += "\\n";
+        else
+            text += *itr;
+    }
+
+    return text + "\"";
+}
+
+std::string MetricsWriter::label(const char* name, uint32_t value)
+{
+    return std::string(name) + "=\"" + std::to_string(value) + "\"";
+}
+
+void MetricsWriter::_appendValue(double value)
+{
+    char text[32];
+
+    // counters and gauges are mostly integers, keep them exact up to 2^53
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0)
+        snprintf(text, sizeof(text), "%.0f", value);
+    else
+        snprintf(text, sizeof(text), "%.9g", value);
+
+    m_text.append(text);
+}
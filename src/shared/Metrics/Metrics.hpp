@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Monotonic counter, e.g. bytes sent. Written by any thread without locking.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MetricCounter
+{
+    public:
+
+        MetricCounter() : m_value(0) {}
+        MetricCounter& operator=(const MetricCounter& other) { m_value.store(other.get(), std::memory_order_relaxed); return *this; }
+
+        void add(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+        uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<uint64_t> m_value;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Value which goes up and down, e.g. open connections. Written by any thread without
+/// locking.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MetricGauge
+{
+    public:
+
+        MetricGauge() : m_value(0) {}
+        MetricGauge& operator=(const MetricGauge& other) { m_value.store(other.get(), std::memory_order_relaxed); return *this; }
+
+        void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(int64_t value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+        int64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<int64_t> m_value;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Histogram with fixed upper bounds, values above the last bound are only counted in the
+/// +Inf bucket. Written by any thread without locking.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MetricHistogram
+{
+    public:
+
+        static const size_t maxBounds = 16;
+
+        /// ascending upper bounds, at most maxBounds
+        MetricHistogram(std::initializer_list<uint64_t> bounds);
+
+        void observe(uint64_t value);
+
+        size_t getBoundCount() const { return m_boundCount; }
+        const uint64_t* getBounds() const { return m_bounds; }
+
+        /// not cumulative, bucket getBoundCount() holds the values above the last bound
+        uint64_t getBucket(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+        uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        uint64_t getSum() const { return m_sum.load(std::memory_order_relaxed); }
+
+    private:
+
+        uint64_t m_bounds[maxBounds];
+        size_t m_boundCount;
+
+        std::atomic<uint64_t> m_buckets[maxBounds + 1];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Builds the Prometheus text exposition format (version 0.0.4).
+///
+/// Labels are passed preformatted without braces, e.g. label("map", 0) + "," +
+/// label("instance", 1), an empty string writes the sample without labels.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MetricsWriter
+{
+    public:
+
+        /// HELP and TYPE lines, write them once before the samples of the metric
+        void family(const char* name, const char* type, const char* help);
+
+        void sample(const char* name, const std::string& labels, double value);
+
+        /// the _bucket, _sum and _count samples of a histogram. buckets has one more entry
+        /// than bounds for the values above the last bound, bounds and sum are divided by
+        /// scale (e.g. 1000000 for microsecond values of a seconds histogram)
+        void histogram(const char* name, const std::string& labels, size_t boundCount, const uint64_t* bounds, const uint64_t* buckets,
+            uint64_t sum, double scale);
+        void histogram(const char* name, const std::string& labels, const MetricHistogram& histogram, double scale);
+
+        static std::string label(const char* name, const std::string& value);
+        static std::string label(const char* name, uint32_t value);
+
+        const std::string& getText() const { return m_text; }
+
+    private:
+
+        void _appendValue(double value);
+
+        std::string m_text;
+};
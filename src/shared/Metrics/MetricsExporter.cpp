@@ -0,0 +1,335 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "MetricsExporter.hpp"
+
+#include "Config/Config.h"
+#include "Database/DatabaseEnv.h"
+#include "Network/Network.h"
+#include "Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+initialiseSingleton(MetricsExporter);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Answers GET /metrics with the rendered metrics, the client closes the connection
+//////////////////////////////////////////////////////////////////////////////////////////
+class MetricsSocket : public Socket
+{
+    public:
+
+        // larger answers are sent in chunks of the send buffer, see OnWriteSpace
+        MetricsSocket(SOCKET fd) : Socket(fd, sendBufferSize, 4096), m_responseOffset(0) {}
+
+        void OnRead() override
+        {
+            const size_t length = readBuffer.GetSize();
+            if (m_request.size() + length > maxRequestSize)
+            {
+                Disconnect();
+                return;
+            }
+
+            std::string data(length, '\0');
+            readBuffer.Read(&data[0], length);
+            m_request += data;
+
+            size_t end;
+            while ((end = m_request.find("\r\n\r\n")) != std::string::npos)
+            {
+                const std::string requestLine = m_request.substr(0, m_request.find("\r\n"));
+                m_request.erase(0, end + 4);
+
+                _handleRequest(requestLine);
+            }
+        }
+
+        bool OnWriteSpace() override
+        {
+            // the rest of the buffer may not raise another writable event by itself
+            return _queueResponse() || writeBuffer.GetSize() > 0;
+        }
+
+    private:
+
+        static const uint32 sendBufferSize = 64 * 1024;
+        static const size_t maxRequestSize = 8192;
+
+        void _handleRequest(const std::string& requestLine)
+        {
+            // GET /metrics HTTP/1.1
+            const size_t pathStart = requestLine.find(' ');
+            const size_t pathEnd = requestLine.find(' ', pathStart + 1);
+            const std::string method = requestLine.substr(0, pathStart);
+            const std::string path = pathStart != std::string::npos ? requestLine.substr(pathStart + 1, pathEnd - pathStart - 1) : "";
+
+            if (method != "GET" && method != "HEAD")
+            {
+                _sendResponse("405 Method Not Allowed", "text/plain", "only GET is supported\n", true);
+                return;
+            }
+
+            if (path != "/metrics" && path != "/")
+            {
+                _sendResponse("404 Not Found", "text/plain", "metrics are served at /metrics\n", method == "GET");
+                return;
+            }
+
+            _sendResponse("200 OK", "text/plain; version=0.0.4", sMetricsExporter.render(), method == "GET");
+        }
+
+        void _sendResponse(const char* status, const char* contentType, const std::string& body, bool withBody)
+        {
+            char header[256];
+            const int headerLength = snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+                status, contentType, static_cast<uint32>(body.size()));
+
+            BurstBegin();
+            m_response.append(header, headerLength);
+            if (withBody)
+                m_response += body;
+
+            if (_queueResponse())
+                BurstPush();
+            BurstEnd();
+        }
+
+        /// moves as much of the unsent response into the send buffer as fits, needs the send
+        /// mutex, returns false if nothing was added
+        bool _queueResponse()
+        {
+            const size_t length = std::min(m_response.size() - m_responseOffset, writeBuffer.GetSpace());
+            if (length == 0)
+                return false;
+
+            BurstSend(reinterpret_cast<const uint8*>(m_response.data() + m_responseOffset), static_cast<uint32>(length));
+            m_responseOffset += length;
+
+            if (m_responseOffset == m_response.size())
+            {
+                std::string().swap(m_response);
+                m_responseOffset = 0;
+            }
+
+            return true;
+        }
+
+        std::string m_response;
+        size_t m_responseOffset;
+        std::string m_request;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Writes the metrics file every FileInterval seconds
+//////////////////////////////////////////////////////////////////////////////////////////
+class MetricsFileWriter : public ThreadBase
+{
+    public:
+
+        MetricsFileWriter(MetricsExporter* exporter) : m_exporter(exporter) {}
+
+        bool run() override
+        {
+            SetThreadName("Metrics file writer");
+            m_exporter->_runFileWriter();
+            return true;
+        }
+
+        void OnShutdown() override
+        {
+            m_exporter->_stopFileWriter();
+        }
+
+    private:
+
+        MetricsExporter* m_exporter;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MetricsExporter
+MetricsExporter::MetricsExporter() : m_startTime(time(nullptr)), m_listenSocket(nullptr), m_fileInterval(15), m_fileWriterRunning(false),
+    m_fileWriterStopping(false)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    shutdown();
+}
+
+void MetricsExporter::addCollector(const Collector& collector)
+{
+    std::lock_guard<std::mutex> guard(m_collectorLock);
+    m_collectors.push_back(collector);
+}
+
+void MetricsExporter::addDatabase(const std::string& name, Database* database)
+{
+    std::lock_guard<std::mutex> guard(m_collectorLock);
+    m_databases.push_back(std::make_pair(name, database));
+}
+
+bool MetricsExporter::startup(ConfigFile& config, const char* section)
+{
+    const std::string host = config.getStringDefault(section, "Host", "127.0.0.1");
+    const uint32 port = config.getIntDefault(section, "Port", 0);
+    const std::string fileName = config.getStringDefault(section, "File", "");
+    const uint32 fileInterval = config.getIntDefault(section, "FileInterval", 15);
+
+    bool started = true;
+
+    if (port != 0)
+    {
+        m_listenSocket = new ListenSocket<MetricsSocket>(host.c_str(), port);
+        if (m_listenSocket->IsOpen())
+        {
+#ifdef WIN32
+            ThreadPool.ExecuteTask(m_listenSocket);
+#endif
+            LogNotice("MetricsExporter : Serving metrics at http://%s:%u/metrics", host.c_str(), port);
+        }
+        else
+        {
+            LogError("MetricsExporter : Could not listen on %s:%u", host.c_str(), port);
+            m_listenSocket->Close();
+            delete m_listenSocket;
+            m_listenSocket = nullptr;
+            started = false;
+        }
+    }
+
+    if (!fileName.empty())
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_fileLock);
+            m_fileName = fileName;
+            m_fileInterval = std::max<uint32>(1, fileInterval);
+            m_fileWriterRunning = true;
+            m_fileWriterStopping = false;
+        }
+
+        ThreadPool.ExecuteTask(new MetricsFileWriter(this));
+        LogNotice("MetricsExporter : Writing metrics to %s every %u seconds", fileName.c_str(), m_fileInterval);
+    }
+
+    return started;
+}
+
+void MetricsExporter::shutdown()
+{
+    if (m_listenSocket != nullptr)
+    {
+        // the socket manager may still know the listen socket, it is closed but not deleted
+        m_listenSocket->Close();
+        m_listenSocket = nullptr;
+    }
+
+    _stopFileWriter();
+
+    std::unique_lock<std::mutex> guard(m_fileLock);
+    while (m_fileWriterRunning)
+        m_fileCond.wait(guard);
+}
+
+std::string MetricsExporter::render()
+{
+    MetricsWriter writer;
+
+    std::lock_guard<std::mutex> guard(m_collectorLock);
+
+    _writeDefaultMetrics(writer);
+
+    for (std::vector<Collector>::iterator itr = m_collectors.begin(); itr != m_collectors.end(); ++itr)
+        (*itr)(writer);
+
+    return writer.getText();
+}
+
+void MetricsExporter::_writeDefaultMetrics(MetricsWriter& writer)
+{
+    writer.family("ascemu_uptime_seconds", "gauge", "Seconds since the server started.");
+    writer.sample("ascemu_uptime_seconds", "", static_cast<double>(time(nullptr) - m_startTime));
+
+    writer.family("ascemu_sockets", "gauge", "Open sockets of the socket manager.");
+    writer.sample("ascemu_sockets", "", SocketMgr::getSingletonPtr() != nullptr ? sSocketMgr.GetSocketCount() : 0);
+
+    writer.family("ascemu_socket_sent_bytes_total", "counter", "Bytes sent by all sockets.");
+    writer.sample("ascemu_socket_sent_bytes_total", "", static_cast<double>(Socket::s_allBytesSent.get()));
+
+    writer.family("ascemu_socket_received_bytes_total", "counter", "Bytes received by all sockets.");
+    writer.sample("ascemu_socket_received_bytes_total", "", static_cast<double>(Socket::s_allBytesRecieved.get()));
+
+    if (m_databases.empty())
+        return;
+
+    writer.family("ascemu_database_queue_size", "gauge", "Asynchronous queries waiting for a database connection.");
+    for (std::vector<std::pair<std::string, Database*>>::iterator itr = m_databases.begin(); itr != m_databases.end(); ++itr)
+        writer.sample("ascemu_database_queue_size", MetricsWriter::label("database", itr->first), itr->second->GetQueueSize());
+
+    // only counted while the TickProfiler is enabled
+    writer.family("ascemu_database_waited_queries_total", "counter", "Blocking queries (Query, WaitExecute) timed by the profiler.");
+    for (std::vector<std::pair<std::string, Database*>>::iterator itr = m_databases.begin(); itr != m_databases.end(); ++itr)
+        writer.sample("ascemu_database_waited_queries_total", MetricsWriter::label("database", itr->first), static_cast<double>(itr->second->GetSyncQueryProfile().getCount()));
+
+    writer.family("ascemu_database_waited_seconds_total", "counter", "Seconds the callers waited for blocking queries timed by the profiler.");
+    for (std::vector<std::pair<std::string, Database*>>::iterator itr = m_databases.begin(); itr != m_databases.end(); ++itr)
+        writer.sample("ascemu_database_waited_seconds_total", MetricsWriter::label("database", itr->first), itr->second->GetSyncQueryProfile().getTotal() / 1e9);
+}
+
+void MetricsExporter::_runFileWriter()
+{
+    std::unique_lock<std::mutex> guard(m_fileLock);
+
+    while (!m_fileWriterStopping)
+    {
+        guard.unlock();
+        _writeFile();
+        guard.lock();
+
+        m_fileCond.wait_for(guard, std::chrono::seconds(m_fileInterval), [this]() { return m_fileWriterStopping; });
+    }
+
+    m_fileWriterRunning = false;
+    m_fileCond.notify_all();
+}
+
+void MetricsExporter::_stopFileWriter()
+{
+    std::lock_guard<std::mutex> guard(m_fileLock);
+    m_fileWriterStopping = true;
+    m_fileCond.notify_all();
+}
+
+void MetricsExporter::_writeFile()
+{
+    const std::string text = render();
+
+    // readers never see a half written file
+    const std::string tempName = m_fileName + ".tmp";
+    FILE* file = fopen(tempName.c_str(), "w");
+    if (file == nullptr)
+    {
+        LogError("MetricsExporter : Could not open %s", tempName.c_str());
+        return;
+    }
+
+    const bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    fclose(file);
+
+    if (!written)
+    {
+        LogError("MetricsExporter : Could not write %s", tempName.c_str());
+        return;
+    }
+
+#ifdef WIN32
+    remove(m_fileName.c_str());
+#endif
+    if (rename(tempName.c_str(), m_fileName.c_str()) != 0)
+        LogError("MetricsExporter : Could not replace %s", m_fileName.c_str());
+}
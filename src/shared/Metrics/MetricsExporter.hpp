@@ -0,0 +1,80 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "Metrics.hpp"
+#include "Singleton.h"
+
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ConfigFile;
+class Database;
+class MetricsSocket;
+template <class T> class ListenSocket;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Serves the metrics of the server in the Prometheus text format, over http on a local
+/// port (curl http://127.0.0.1:<port>/metrics) and/or written to a file periodically.
+///
+/// The socket, database and uptime metrics are always written, the servers add their own
+/// metrics with collectors. A scrape calls all collectors on the socket thread (or the
+/// file writer thread), so collectors only read counters or take short locks.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MetricsExporter : public Singleton<MetricsExporter>
+{
+    friend class MetricsFileWriter;
+
+    public:
+
+        typedef std::function<void(MetricsWriter&)> Collector;
+
+        MetricsExporter();
+        ~MetricsExporter();
+
+        void addCollector(const Collector& collector);
+
+        /// queue size and waited queries of the database, labeled with the name
+        void addDatabase(const std::string& name, Database* database);
+
+        /// reads Host, Port, File and FileInterval of the config section, port 0 and an
+        /// empty file disable the endpoint and the file. Needs the SocketMgr for the port
+        bool startup(ConfigFile& config, const char* section);
+        void shutdown();
+
+        /// the metrics of all collectors in the text format
+        std::string render();
+
+    private:
+
+        void _writeDefaultMetrics(MetricsWriter& writer);
+
+        void _runFileWriter();
+        void _stopFileWriter();
+        void _writeFile();
+
+        std::mutex m_collectorLock;
+        std::vector<Collector> m_collectors;
+        std::vector<std::pair<std::string, Database*>> m_databases;
+        time_t m_startTime;
+
+        ListenSocket<MetricsSocket>* m_listenSocket;
+
+        // file writer thread
+        std::mutex m_fileLock;
+        std::condition_variable m_fileCond;
+        std::string m_fileName;
+        uint32_t m_fileInterval;
+        bool m_fileWriterRunning;
+        bool m_fileWriterStopping;
+};
+
+#define sMetricsExporter MetricsExporter::getSingleton()
@@ -10,6 +10,9 @@
 
 initialiseSingleton(SocketGarbageCollector);
 
+MetricCounter Socket::s_allBytesSent;
+MetricCounter Socket::s_allBytesRecieved;
+
 Socket::Socket(SOCKET fd, uint32 sendbuffersize, uint32 recvbuffersize) : m_fd(fd), m_connected(false),    m_deleted(false), m_writeLock(0)
 {
     // Allocate Buffers
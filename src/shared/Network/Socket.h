@@ -14,6 +14,7 @@
 #include "CircularBuffer.h"
 #include "Singleton.h"
 #include "Log.hpp"
+#include "Metrics/Metrics.hpp"
 #include <string>
 #include <mutex>
 #include <atomic>
@@ -49,6 +50,11 @@ class SERVER_DECL Socket
         // Called when the socket is disconnected from the client (either forcibly or by the connection dropping)
         virtual void OnDisconnect() {}
 
+        // Called with the send mutex held after a write freed space in the send buffer, e.g. to
+        // add the next part of an answer larger than the buffer. Returns true if the socket has
+        // to be written again.
+        virtual bool OnWriteSpace() { return false; }
+
         /* Sending Operations */
 
         // Locks sending mutex, adds bytes, unlocks mutex.
@@ -120,6 +126,10 @@ class SERVER_DECL Socket
 
     public:
 
+        // bytes of all sockets since the start for the metrics, PollTraffic resets the values of one socket
+        static MetricCounter s_allBytesSent;
+        static MetricCounter s_allBytesRecieved;
+
         // Atomic wrapper functions for increasing read/write locks
         inline void IncSendLock() { ++m_writeLock; }
         inline void DecSendLock() { --m_writeLock; }
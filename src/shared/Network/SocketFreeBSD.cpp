@@ -48,6 +48,7 @@ void Socket::ReadCallback(uint32 len)
         OnRead();
     }
     m_BytesRecieved += bytes;
+    s_allBytesRecieved.add(bytes);
 
     m_readMutex.Release();
 }
@@ -67,6 +68,7 @@ void Socket::WriteCallback()
     }
 
     m_BytesSent += bytes_written;
+    s_allBytesSent.add(bytes_written);
 
     //RemoveWriteBufferBytes(bytes_written, false);
     writeBuffer.Remove(bytes_written);
@@ -136,6 +136,7 @@ bool SocketWorkerThread::run()
             {
                 ptr->BurstBegin();          // Lock receive mutex
                 ptr->WriteCallback();       // Perform actual send()
+                ptr->OnWriteSpace();
                 if(ptr->writeBuffer.GetSize() > 0)
                     ptr->PostEvent(EVFILT_WRITE, true);   // Still remaining data.
                 else
@@ -163,6 +163,8 @@ bool SocketWorkerThread::run()
             {
                 ptr->BurstBegin();          // Lock receive mutex
                 ptr->WriteCallback();       // Perform actual send()
+                if(ptr->OnWriteSpace())
+                    ptr->PostEvent(EPOLLOUT);   // data added to a writable socket raises no new edge
                 if(ptr->writeBuffer.GetSize() > 0)
                 {
                     /* we don't have to do anything here. no more oneshots :) */
@@ -97,6 +97,7 @@ void HandleWriteComplete(Socket* s, uint32 len)
         s->m_writeEvent.Unmark();
         s->BurstBegin();                    // Lock
         s->writeBuffer.Remove(len);
+        s->OnWriteSpace();
         if(s->writeBuffer.GetContiguiousBytes() > 0)
             s->WriteCallback();
         else
@@ -56,6 +56,7 @@ void Socket::WriteCallback()
             }
         }
         m_BytesSent += w_length;
+        s_allBytesSent.add(w_length);
     }
     else
     {
@@ -97,6 +98,7 @@ void Socket::SetupReadEvent()
         }
     }
     m_BytesRecieved += r_length;
+    s_allBytesRecieved.add(r_length);
     //m_readEvent = ov;
     m_readMutex.Release();
 }
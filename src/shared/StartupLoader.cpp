@@ -0,0 +1,237 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StartupLoader.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+StartupLoader::StartupLoader() : m_running(0), m_failed(false), m_threadCount(0)
+{
+}
+
+void StartupLoader::addTask(const std::string& name, const std::vector<std::string>& dependencies, std::function<void()> func)
+{
+    addCheckedTask(name, dependencies, [func]()
+    {
+        func();
+        return true;
+    });
+}
+
+void StartupLoader::addCheckedTask(const std::string& name, const std::vector<std::string>& dependencies, std::function<bool()> func)
+{
+    StartupTask task;
+    task.name = name;
+    task.dependencyNames = dependencies;
+    task.func = func;
+    task.pendingDependencies = 0;
+    task.finished = false;
+
+    m_tasks.push_back(task);
+}
+
+bool StartupLoader::_resolveDependencies()
+{
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        StartupTask& task = m_tasks[i];
+        for (std::vector<std::string>::const_iterator name = task.dependencyNames.begin(); name != task.dependencyNames.end(); ++name)
+        {
+            size_t dependency = 0;
+            while (dependency < m_tasks.size() && m_tasks[dependency].name != *name)
+                ++dependency;
+
+            if (dependency == m_tasks.size())
+            {
+                LOG_ERROR("StartupLoader : %s depends on unknown task %s.", task.name.c_str(), name->c_str());
+                return false;
+            }
+
+            task.dependencies.push_back(dependency);
+            m_tasks[dependency].dependents.push_back(i);
+            ++task.pendingDependencies;
+        }
+    }
+
+    return true;
+}
+
+bool StartupLoader::run(uint32_t threadCount)
+{
+    if (!_resolveDependencies())
+        return false;
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    m_threadCount = std::min(threadCount, std::max(1u, static_cast<uint32_t>(m_tasks.size())));
+
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        if (m_tasks[i].pendingDependencies == 0)
+            m_ready.push_back(i);
+    }
+
+    LogNotice("StartupLoader : Running %u startup tasks with %u threads...", static_cast<uint32_t>(m_tasks.size()), m_threadCount);
+
+    m_startTime = Clock::now();
+
+    // the calling thread is one of the workers
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < m_threadCount; ++i)
+        workers.push_back(std::thread(&StartupLoader::_runWorker, this));
+
+    _runWorker();
+
+    for (std::vector<std::thread>::iterator itr = workers.begin(); itr != workers.end(); ++itr)
+        itr->join();
+
+    m_finishTime = Clock::now();
+
+    if (!m_failed && m_finishOrder.size() == m_tasks.size())
+        return true;
+
+    for (std::vector<StartupTask>::const_iterator itr = m_tasks.begin(); itr != m_tasks.end(); ++itr)
+    {
+        if (!itr->finished)
+            LOG_ERROR("StartupLoader : %s was not run%s.", itr->name.c_str(), m_failed ? "" : ", its dependencies form a cycle");
+    }
+
+    return false;
+}
+
+bool StartupLoader::_isStopped() const
+{
+    return m_failed || (m_ready.empty() && m_running == 0);
+}
+
+void StartupLoader::_runWorker()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    while (true)
+    {
+        m_cond.wait(guard, [this] { return !m_ready.empty() || _isStopped(); });
+        if (_isStopped())
+            return;
+
+        StartupTask& task = m_tasks[m_ready.front()];
+        m_ready.pop_front();
+        ++m_running;
+
+        guard.unlock();
+
+        task.startTime = Clock::now();
+        const bool succeeded = _runTask(task);
+        task.finishTime = Clock::now();
+
+        guard.lock();
+
+        --m_running;
+        task.finished = true;
+        m_finishOrder.push_back(&task - &m_tasks[0]);
+
+        if (succeeded)
+        {
+            for (std::vector<size_t>::const_iterator itr = task.dependents.begin(); itr != task.dependents.end(); ++itr)
+            {
+                if (--m_tasks[*itr].pendingDependencies == 0)
+                    m_ready.push_back(*itr);
+            }
+        }
+        else
+        {
+            LOG_ERROR("StartupLoader : %s failed, startup is stopped.", task.name.c_str());
+            m_failed = true;
+        }
+
+        m_cond.notify_all();
+    }
+}
+
+bool StartupLoader::_runTask(StartupTask& task)
+{
+    // an exception must not leave the worker thread, it is a failed task like any other
+    try
+    {
+        return task.func();
+    }
+    catch (std::exception& e)
+    {
+        LOG_ERROR("StartupLoader : %s threw an exception: %s", task.name.c_str(), e.what());
+    }
+    catch (...)
+    {
+        LOG_ERROR("StartupLoader : %s threw an unknown exception.", task.name.c_str());
+    }
+
+    return false;
+}
+
+uint32_t StartupLoader::_getMilliseconds(Clock::time_point time) const
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - m_startTime).count());
+}
+
+uint32_t StartupLoader::_getDuration(const StartupTask& task) const
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(task.finishTime - task.startTime).count());
+}
+
+void StartupLoader::logReport() const
+{
+    if (m_finishOrder.empty())
+        return;
+
+    // tasks finish after their dependencies, the finish order is a topological order
+    std::vector<uint32_t> pathTime(m_tasks.size(), 0);
+    std::vector<size_t> pathPrevious(m_tasks.size(), m_tasks.size());
+    uint64_t totalTime = 0;
+
+    for (std::vector<size_t>::const_iterator itr = m_finishOrder.begin(); itr != m_finishOrder.end(); ++itr)
+    {
+        const StartupTask& task = m_tasks[*itr];
+        for (std::vector<size_t>::const_iterator dependency = task.dependencies.begin(); dependency != task.dependencies.end(); ++dependency)
+        {
+            if (pathPrevious[*itr] == m_tasks.size() || pathTime[*dependency] > pathTime[pathPrevious[*itr]])
+                pathPrevious[*itr] = *dependency;
+        }
+
+        pathTime[*itr] = _getDuration(task) + (pathPrevious[*itr] != m_tasks.size() ? pathTime[pathPrevious[*itr]] : 0);
+        totalTime += _getDuration(task);
+    }
+
+    size_t last = m_finishOrder.front();
+    for (std::vector<size_t>::const_iterator itr = m_finishOrder.begin(); itr != m_finishOrder.end(); ++itr)
+    {
+        if (pathTime[*itr] > pathTime[last])
+            last = *itr;
+    }
+
+    std::vector<size_t> criticalPath;
+    for (size_t task = last; task != m_tasks.size(); task = pathPrevious[task])
+        criticalPath.push_back(task);
+
+    LogNotice("StartupLoader : Ran %u tasks with %u threads in %u ms, %u ms of loading in total.", static_cast<uint32_t>(m_finishOrder.size()), m_threadCount,
+        _getMilliseconds(m_finishTime), static_cast<uint32_t>(totalTime));
+
+    LogNotice("StartupLoader : Critical path of %u ms:", pathTime[last]);
+    for (std::vector<size_t>::const_reverse_iterator itr = criticalPath.rbegin(); itr != criticalPath.rend(); ++itr)
+    {
+        const StartupTask& task = m_tasks[*itr];
+        LogNotice("StartupLoader :     %-40s %6u ms (started at %u ms)", task.name.c_str(), _getDuration(task), _getMilliseconds(task.startTime));
+    }
+
+    std::vector<size_t> slowest(m_finishOrder);
+    std::sort(slowest.begin(), slowest.end(), [this](size_t a, size_t b) { return _getDuration(m_tasks[a]) > _getDuration(m_tasks[b]); });
+    slowest.resize(std::min<size_t>(slowest.size(), 5));
+
+    LogDetail("StartupLoader : Slowest tasks:");
+    for (std::vector<size_t>::const_iterator itr = slowest.begin(); itr != slowest.end(); ++itr)
+        LogDetail("StartupLoader :     %-40s %6u ms", m_tasks[*itr].name.c_str(), _getDuration(m_tasks[*itr]));
+}
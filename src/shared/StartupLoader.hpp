@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Runs the startup loaders of the world server as a dependency graph.
+///
+/// Every loader is added with a name and the names of the loaders it needs. Loaders
+/// without pending dependencies run right away on a pool of worker threads, so DBC files
+/// are read while independent tables are queried. After the run the timings are logged,
+/// together with the critical path, which is the chain of dependent loaders that bounds
+/// the startup time no matter how many threads are used.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL StartupLoader
+{
+    public:
+
+        StartupLoader();
+
+        /// dependencies are resolved by run(), they can be added in any order
+        void addTask(const std::string& name, const std::vector<std::string>& dependencies, std::function<void()> func);
+
+        /// a task returning false or throwing stops the startup, tasks depending on it are not run
+        void addCheckedTask(const std::string& name, const std::vector<std::string>& dependencies, std::function<bool()> func);
+
+        /// runs all tasks and waits for them, 0 threads uses one per cpu core.
+        /// Returns false on a failed task, an unknown dependency or a dependency cycle
+        bool run(uint32_t threadCount);
+
+        /// logs wall time, summed task time, the critical path and the slowest tasks
+        void logReport() const;
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct StartupTask
+        {
+            std::string name;
+            std::vector<std::string> dependencyNames;
+            std::function<bool()> func;
+
+            std::vector<size_t> dependencies;
+            std::vector<size_t> dependents;
+            size_t pendingDependencies;
+
+            bool finished;
+            Clock::time_point startTime;
+            Clock::time_point finishTime;
+        };
+
+        bool _resolveDependencies();
+        void _runWorker();
+        bool _runTask(StartupTask& task);
+        bool _isStopped() const;
+
+        uint32_t _getMilliseconds(Clock::time_point time) const;
+        uint32_t _getDuration(const StartupTask& task) const;
+
+        std::vector<StartupTask> m_tasks;
+
+        // guards everything below
+        std::mutex m_lock;
+        std::condition_variable m_cond;
+        std::deque<size_t> m_ready;
+        std::vector<size_t> m_finishOrder;
+        size_t m_running;
+        bool m_failed;
+
+        uint32_t m_threadCount;
+        Clock::time_point m_startTime;
+        Clock::time_point m_finishTime;
+};
@@ -0,0 +1,359 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "TickProfiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+#include <chrono>
+#else
+#include <time.h>
+#endif
+
+#if defined(TICK_PROFILER_TSC) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+std::atomic<bool> TickProfiler::s_enabled(false);
+std::atomic<bool> TickProfiler::s_tracing(false);
+TickProfiler::EventNamer TickProfiler::s_eventNamer = nullptr;
+
+#ifdef TICK_PROFILER_TSC
+std::atomic<uint64_t> TickProfiler::s_tscMultiplier(0);
+uint64_t TickProfiler::s_tscBase = 0;
+uint64_t TickProfiler::s_clockBase = 0;
+#endif
+
+namespace
+{
+    struct ProfileRing
+    {
+        uint32_t threadId;
+        uint64_t position;
+        ProfileEvent events[TickProfiler::ringSize];
+    };
+
+    std::atomic<uint32_t> nextThreadId(1);
+    thread_local std::unique_ptr<ProfileRing> t_ring;
+
+    std::mutex threadSlotLock;
+    bool threadSlotUsed[ProfileCounterTable::maxThreads];
+    size_t nextSharedThreadSlot = 0;
+
+    // the row of the calling thread in every ProfileCounterTable, free again when the thread ends
+    struct ThreadSlot
+    {
+        ThreadSlot() : index(0), shared(false)
+        {
+            std::lock_guard<std::mutex> guard(threadSlotLock);
+            while (index < ProfileCounterTable::maxThreads && threadSlotUsed[index])
+                ++index;
+
+            if (index < ProfileCounterTable::maxThreads)
+            {
+                threadSlotUsed[index] = true;
+            }
+            else
+            {
+                index = nextSharedThreadSlot++ % ProfileCounterTable::maxThreads;
+                shared = true;
+            }
+        }
+
+        ~ThreadSlot()
+        {
+            std::lock_guard<std::mutex> guard(threadSlotLock);
+            if (!shared)
+                threadSlotUsed[index] = false;
+        }
+
+        size_t index;
+        bool shared;
+    };
+
+    thread_local ThreadSlot t_threadSlot;
+
+    ProfileRing& getRing()
+    {
+        if (!t_ring)
+        {
+            t_ring.reset(new ProfileRing);
+            t_ring->threadId = nextThreadId.fetch_add(1);
+            t_ring->position = 0;
+        }
+
+        return *t_ring;
+    }
+
+    void writeJsonString(FILE* file, const std::string& text)
+    {
+        fputc('"', file);
+        for (std::string::const_iterator itr = text.begin(); itr != text.end(); ++itr)
+        {
+            if (*itr == '"' || *itr == '\\')
+                fputc('\\', file);
+
+            if (static_cast<unsigned char>(*itr) >= 0x20)
+                fputc(*itr, file);
+        }
+        fputc('"', file);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// ProfileCounterTable
+ProfileCounterTable::ProfileCounterTable(size_t size) : m_size(size)
+{
+    for (size_t i = 0; i < maxThreads; ++i)
+        m_rows[i].store(nullptr, std::memory_order_relaxed);
+}
+
+ProfileCounterTable::~ProfileCounterTable()
+{
+    for (size_t i = 0; i < maxThreads; ++i)
+        delete[] m_rows[i].load();
+}
+
+ProfileCounterTable& ProfileCounterTable::operator=(const ProfileCounterTable& other)
+{
+    if (this == &other)
+        return *this;
+
+    reset();
+    if (!other.isUsed())
+        return *this;
+
+    for (size_t i = 0; i < std::min(m_size, other.m_size); ++i)
+        get(i) = other.getSum(i);
+
+    return *this;
+}
+
+ProfileCounter& ProfileCounterTable::get(size_t index)
+{
+    std::atomic<ProfileCounter*>& row = m_rows[t_threadSlot.index];
+
+    ProfileCounter* counters = row.load(std::memory_order_acquire);
+    if (counters == nullptr)
+    {
+        // threads beyond maxThreads share their row
+        ProfileCounter* allocated = new ProfileCounter[m_size];
+        if (row.compare_exchange_strong(counters, allocated, std::memory_order_acq_rel))
+            counters = allocated;
+        else
+            delete[] allocated;
+    }
+
+    return counters[index];
+}
+
+ProfileCounter ProfileCounterTable::getSum(size_t index) const
+{
+    ProfileCounter sum;
+    for (size_t i = 0; i < maxThreads; ++i)
+    {
+        const ProfileCounter* counters = m_rows[i].load(std::memory_order_acquire);
+        if (counters != nullptr)
+            sum.merge(counters[index]);
+    }
+
+    return sum;
+}
+
+bool ProfileCounterTable::isUsed() const
+{
+    for (size_t i = 0; i < maxThreads; ++i)
+    {
+        if (m_rows[i].load(std::memory_order_relaxed) != nullptr)
+            return true;
+    }
+
+    return false;
+}
+
+void ProfileCounterTable::reset()
+{
+    for (size_t i = 0; i < maxThreads; ++i)
+    {
+        ProfileCounter* counters = m_rows[i].load(std::memory_order_acquire);
+        if (counters == nullptr)
+            continue;
+
+        for (size_t j = 0; j < m_size; ++j)
+            counters[j].reset();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// TickProfiler
+void TickProfiler::setEnabled(bool enabled)
+{
+#ifdef TICK_PROFILER_TSC
+    static std::once_flag calibrated;
+    if (enabled)
+        std::call_once(calibrated, &TickProfiler::_calibrateTsc);
+#endif
+
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t TickProfiler::getClockTime()
+{
+#ifdef _WIN32
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+bool TickProfiler::isUsingTsc()
+{
+#ifdef TICK_PROFILER_TSC
+    return s_tscMultiplier.load(std::memory_order_relaxed) != 0;
+#else
+    return false;
+#endif
+}
+
+#ifdef TICK_PROFILER_TSC
+void TickProfiler::_calibrateTsc()
+{
+    // the TSC of older cpus runs with the cpu clock, only an invariant one (cpuid 0x80000007
+    // edx bit 8) counts time
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (static_cast<uint32_t>(info[0]) < 0x80000007)
+        return;
+
+    __cpuid(info, 0x80000007);
+    const uint32_t edx = static_cast<uint32_t>(info[3]);
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return;
+#endif
+
+    if ((edx & (1 << 8)) == 0)
+        return;
+
+    // 20 ms of both clocks, the rate is exact to a few ppm
+    const uint64_t clockStart = getClockTime();
+    const uint64_t tscStart = __rdtsc();
+
+    uint64_t clockEnd;
+    do
+    {
+        clockEnd = getClockTime();
+    } while (clockEnd - clockStart < 20000000);
+
+    const uint64_t tscEnd = __rdtsc();
+    if (tscEnd <= tscStart)
+        return;
+
+    s_tscBase = tscStart;
+    s_clockBase = clockStart;
+    s_tscMultiplier.store(((clockEnd - clockStart) << 32) / (tscEnd - tscStart), std::memory_order_release);
+}
+#endif
+
+void TickProfiler::record(const char* name, ProfileCategory category, uint32_t arg, uint64_t start, uint64_t end)
+{
+    ProfileRing& ring = getRing();
+
+    ProfileEvent& event = ring.events[ring.position % ringSize];
+    event.name = name;
+    event.arg = arg;
+    event.category = category;
+    event.start = start;
+    event.end = end;
+
+    ++ring.position;
+}
+
+uint64_t TickProfiler::getRingPosition()
+{
+    return getRing().position;
+}
+
+uint64_t TickProfiler::copyEvents(uint64_t position, std::vector<ProfileEvent>& events)
+{
+    const ProfileRing& ring = getRing();
+
+    uint64_t overwritten = 0;
+    if (ring.position - position > ringSize)
+    {
+        overwritten = ring.position - position - ringSize;
+        position = ring.position - ringSize;
+    }
+
+    events.reserve(events.size() + static_cast<size_t>(ring.position - position));
+    for (; position < ring.position; ++position)
+        events.push_back(ring.events[position % ringSize]);
+
+    return overwritten;
+}
+
+bool TickProfiler::writeChromeTrace(const std::string& fileName, const std::vector<ProfileEvent>& events)
+{
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (file == nullptr)
+        return false;
+
+    uint64_t begin = events.empty() ? 0 : events.front().start;
+    for (std::vector<ProfileEvent>::const_iterator itr = events.begin(); itr != events.end(); ++itr)
+        begin = std::min(begin, itr->start);
+
+    const uint32_t threadId = getRing().threadId;
+
+    fprintf(file, "{\"traceEvents\":[");
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const ProfileEvent& event = events[i];
+
+        std::string name;
+        if (event.name != nullptr)
+            name = event.name;
+        else if (s_eventNamer != nullptr)
+            name = s_eventNamer(event.category, event.arg);
+        else
+            name = std::to_string(event.arg);
+
+        fprintf(file, "%s\n{\"name\":", i != 0 ? "," : "");
+        writeJsonString(file, name);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+            getCategoryName(ProfileCategory(event.category)), (event.start - begin) / 1000.0, (event.end - event.start) / 1000.0, threadId, event.arg);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    const bool written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
+
+const char* TickProfiler::getCategoryName(ProfileCategory category)
+{
+    switch (category)
+    {
+        case PROFILE_CATEGORY_TICK:
+            return "tick";
+        case PROFILE_CATEGORY_PHASE:
+            return "phase";
+        case PROFILE_CATEGORY_OPCODE:
+            return "opcode";
+        case PROFILE_CATEGORY_DATABASE:
+            return "database";
+        case PROFILE_CATEGORY_HOOK:
+            return "hook";
+        default:
+            return "unknown";
+    }
+}
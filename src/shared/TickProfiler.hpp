@@ -0,0 +1,279 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define TICK_PROFILER_TSC
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+enum ProfileCategory
+{
+    PROFILE_CATEGORY_TICK,
+    PROFILE_CATEGORY_PHASE,
+    PROFILE_CATEGORY_OPCODE,
+    PROFILE_CATEGORY_DATABASE,
+    PROFILE_CATEGORY_HOOK,
+    PROFILE_CATEGORY_COUNT
+};
+
+struct ProfileEvent
+{
+    /// static string, nullptr names the event through the event namer (e.g. opcodes)
+    const char* name;
+    uint32_t arg;
+    uint32_t category;
+    /// nanoseconds of TickProfiler::getTime
+    uint64_t start;
+    uint64_t end;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Calls, total and max nanoseconds of one profiled zone. Written by one thread at a time
+/// (ProfileCounterTable gives every thread its own counters), read by the console without
+/// locking.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL ProfileCounter
+{
+    public:
+
+        ProfileCounter() { reset(); }
+        ProfileCounter(const ProfileCounter& other) { *this = other; }
+
+        ProfileCounter& operator=(const ProfileCounter& other)
+        {
+            m_count.store(other.getCount(), std::memory_order_relaxed);
+            m_total.store(other.getTotal(), std::memory_order_relaxed);
+            m_max.store(other.getMax(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        /// only the writing thread changes the values, so no locked add or compare exchange
+        void add(uint64_t nanoseconds)
+        {
+            m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            m_total.store(m_total.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+
+            if (nanoseconds > m_max.load(std::memory_order_relaxed))
+                m_max.store(nanoseconds, std::memory_order_relaxed);
+        }
+
+        /// adds the values of the counter of another thread
+        void merge(const ProfileCounter& other)
+        {
+            m_count.store(getCount() + other.getCount(), std::memory_order_relaxed);
+            m_total.store(getTotal() + other.getTotal(), std::memory_order_relaxed);
+            m_max.store(std::max(getMax(), other.getMax()), std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            m_count.store(0, std::memory_order_relaxed);
+            m_total.store(0, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+        uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        uint64_t getTotal() const { return m_total.load(std::memory_order_relaxed); }
+        uint64_t getMax() const { return m_max.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_total;
+        std::atomic<uint64_t> m_max;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Fixed number of counters, e.g. one per opcode, with a row of counters per thread. A
+/// thread allocates its row with its first get(), so tables which were never written while
+/// the profiler was enabled cost nothing and a map ticked by two workers has two rows.
+///
+/// Threads beyond maxThreads running at the same time share rows and may lose counts.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL ProfileCounterTable
+{
+    public:
+
+        static const size_t maxThreads = 32;
+
+        explicit ProfileCounterTable(size_t size);
+        ~ProfileCounterTable();
+
+        /// copies the counter values into the row of the calling thread, the tables keep
+        /// their own counters
+        ProfileCounterTable& operator=(const ProfileCounterTable& other);
+
+        /// the counter of the calling thread
+        ProfileCounter& get(size_t index);
+
+        /// the counters of all threads added up
+        ProfileCounter getSum(size_t index) const;
+
+        /// false while no thread wrote to the table
+        bool isUsed() const;
+
+        size_t size() const { return m_size; }
+
+        /// a reset while a thread writes its counter may keep that write
+        void reset();
+
+    private:
+
+        ProfileCounterTable(const ProfileCounterTable&) = delete;
+
+        const size_t m_size;
+        std::atomic<ProfileCounter*> m_rows[maxThreads];
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Low overhead profiler of the server threads.
+///
+/// While a slow tick trace is armed (setTracing), every thread records the finished
+/// ProfileScope into its own ring of the last ringSize events without any locking. A thread
+/// can copy its events since a ring position, e.g. to write a Chrome trace (chrome://tracing)
+/// of a tick which took too long. Nothing is recorded and the clock is not read while the
+/// profiler is disabled.
+///
+/// On x86-64 cpus with an invariant TSC the time is read with rdtsc and converted to
+/// nanoseconds with the rate measured against the system clock by the first setEnabled(true).
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL TickProfiler
+{
+    public:
+
+        static const size_t ringSize = 8192;
+
+        /// names events recorded without a name from their category and arg
+        typedef std::string(*EventNamer)(uint32_t category, uint32_t arg);
+
+        static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+        static void setEnabled(bool enabled);
+
+        /// the events only go to the rings while a trace of them may be written
+        static bool isTracing() { return s_tracing.load(std::memory_order_relaxed); }
+        static void setTracing(bool tracing) { s_tracing.store(tracing, std::memory_order_relaxed); }
+
+        static void setEventNamer(EventNamer namer) { s_eventNamer = namer; }
+
+        /// monotonic nanoseconds
+        static uint64_t getTime()
+        {
+#ifdef TICK_PROFILER_TSC
+            const uint64_t multiplier = s_tscMultiplier.load(std::memory_order_acquire);
+            if (multiplier != 0)
+                return s_clockBase + _mulShift32(__rdtsc() - s_tscBase, multiplier);
+#endif
+            return getClockTime();
+        }
+
+        /// monotonic nanoseconds of the system clock, clock_gettime on unix
+        static uint64_t getClockTime();
+
+        /// true if getTime reads the TSC
+        static bool isUsingTsc();
+
+        /// adds an event to the ring of the calling thread
+        static void record(const char* name, ProfileCategory category, uint32_t arg, uint64_t start, uint64_t end);
+
+        /// number of events the calling thread recorded so far
+        static uint64_t getRingPosition();
+
+        /// copies the events of the calling thread since the given position, returns the
+        /// number of events which were already overwritten
+        static uint64_t copyEvents(uint64_t position, std::vector<ProfileEvent>& events);
+
+        /// writes the events as Chrome trace json, the events are shown as one thread
+        static bool writeChromeTrace(const std::string& fileName, const std::vector<ProfileEvent>& events);
+
+        static const char* getCategoryName(ProfileCategory category);
+
+    private:
+
+#ifdef TICK_PROFILER_TSC
+        /// (value * multiplier) >> 32 without overflow
+        static uint64_t _mulShift32(uint64_t value, uint64_t multiplier)
+        {
+#ifdef _MSC_VER
+            uint64_t high;
+            const uint64_t low = _umul128(value, multiplier, &high);
+            return (high << 32) | (low >> 32);
+#else
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(value) * multiplier) >> 32);
+#endif
+        }
+
+        static void _calibrateTsc();
+
+        /// nanoseconds per TSC tick << 32, 0 while getTime reads the system clock
+        static std::atomic<uint64_t> s_tscMultiplier;
+        static uint64_t s_tscBase;
+        static uint64_t s_clockBase;
+#endif
+
+        static std::atomic<bool> s_enabled;
+        static std::atomic<bool> s_tracing;
+        static EventNamer s_eventNamer;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Adds the lifetime of the scope to the counter and records it as profiler event while
+/// tracing, if the profiler was enabled when the scope started.
+//////////////////////////////////////////////////////////////////////////////////////////
+class ProfileScope
+{
+    public:
+
+        ProfileScope(const char* name, ProfileCategory category, uint32_t arg = 0, ProfileCounter* counter = nullptr)
+            : m_name(name), m_category(category), m_arg(arg), m_counter(counter), m_active(TickProfiler::isEnabled()), m_start(0)
+        {
+            if (m_active)
+                m_start = TickProfiler::getTime();
+        }
+
+        ~ProfileScope()
+        {
+            if (!m_active)
+                return;
+
+            const uint64_t end = TickProfiler::getTime();
+            if (TickProfiler::isTracing())
+                TickProfiler::record(m_name, m_category, m_arg, m_start, end);
+
+            if (m_counter != nullptr)
+                m_counter->add(end - m_start);
+        }
+
+        bool isActive() const { return m_active; }
+
+        /// for counters which should only be looked up while profiling
+        void setCounter(ProfileCounter* counter) { m_counter = counter; }
+
+    private:
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+        const char* m_name;
+        ProfileCategory m_category;
+        uint32_t m_arg;
+        ProfileCounter* m_counter;
+        bool m_active;
+        uint64_t m_start;
+};
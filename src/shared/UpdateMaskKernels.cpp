@@ -0,0 +1,254 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "UpdateMaskKernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define UPDATEMASK_KERNELS_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define UPDATEMASK_TARGET_AVX2
+    #else
+        #define UPDATEMASK_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace
+{
+    inline uint32_t popCount(uint32_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcount(word);
+#else
+        // __popcnt needs a cpu with POPCNT, this works everywhere
+        word = word - ((word >> 1) & 0x55555555);
+        word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+        return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+    }
+
+    inline uint32_t lowestBit(uint32_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(word);
+#else
+        unsigned long index;
+        _BitScanForward(&index, word);
+        return index;
+#endif
+    }
+
+    inline void setNonZeroTail(const uint32_t* values, uint32_t first, uint32_t count, const uint32_t* filter, uint32_t* mask)
+    {
+        for (uint32_t i = first; i < count; ++i)
+        {
+            if (values[i] != 0 && (filter == nullptr || (filter[i >> 5] & (1u << (i & 31)))))
+                mask[i >> 5] |= 1u << (i & 31);
+        }
+    }
+
+    void setNonZeroBitsScalar(const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask)
+    {
+        const uint32_t words = count >> 5;
+        for (uint32_t word = 0; word < words; ++word)
+        {
+            const uint32_t* block = values + (word << 5);
+
+            uint32_t bits = 0;
+            for (uint32_t i = 0; i < 32; ++i)
+                bits |= uint32_t(block[i] != 0) << i;
+
+            mask[word] |= filter != nullptr ? bits & filter[word] : bits;
+        }
+
+        setNonZeroTail(values, words << 5, count, filter, mask);
+    }
+
+#ifdef UPDATEMASK_KERNELS_X86
+    void setNonZeroBitsSSE2(const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        const uint32_t words = count >> 5;
+        for (uint32_t word = 0; word < words; ++word)
+        {
+            const uint32_t* block = values + (word << 5);
+
+            // movemask gives one bit per lane that is zero, 4 lanes per compare
+            uint32_t zeroBits = 0;
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                const __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 4));
+                zeroBits |= uint32_t(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lanes, zero)))) << (i * 4);
+            }
+
+            mask[word] |= filter != nullptr ? ~zeroBits & filter[word] : ~zeroBits;
+        }
+
+        setNonZeroTail(values, words << 5, count, filter, mask);
+    }
+
+    UPDATEMASK_TARGET_AVX2 void setNonZeroBitsAVX2(const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+
+        const uint32_t words = count >> 5;
+        for (uint32_t word = 0; word < words; ++word)
+        {
+            const uint32_t* block = values + (word << 5);
+
+            uint32_t zeroBits = 0;
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 8));
+                zeroBits |= uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, zero)))) << (i * 8);
+            }
+
+            mask[word] |= filter != nullptr ? ~zeroBits & filter[word] : ~zeroBits;
+        }
+
+        setNonZeroTail(values, words << 5, count, filter, mask);
+    }
+
+    bool hasAVX2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // the os has to save the ymm registers as well
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+
+    typedef void (*SetNonZeroBitsFunc)(const uint32_t*, uint32_t, const uint32_t*, uint32_t*);
+
+    struct Kernels
+    {
+        UpdateMaskKernels::KernelSet kernelSet;
+        SetNonZeroBitsFunc setNonZeroBits;
+    };
+
+    SetNonZeroBitsFunc getSetNonZeroBits(UpdateMaskKernels::KernelSet kernelSet)
+    {
+        switch (kernelSet)
+        {
+#ifdef UPDATEMASK_KERNELS_X86
+            case UpdateMaskKernels::KERNELS_AVX2:
+                return &setNonZeroBitsAVX2;
+            case UpdateMaskKernels::KERNELS_SSE2:
+                return &setNonZeroBitsSSE2;
+#endif
+            default:
+                return &setNonZeroBitsScalar;
+        }
+    }
+
+    Kernels selectKernels()
+    {
+        Kernels kernels;
+        kernels.kernelSet = UpdateMaskKernels::KERNELS_SCALAR;
+        if (UpdateMaskKernels::isKernelSetSupported(UpdateMaskKernels::KERNELS_AVX2))
+            kernels.kernelSet = UpdateMaskKernels::KERNELS_AVX2;
+        else if (UpdateMaskKernels::isKernelSetSupported(UpdateMaskKernels::KERNELS_SSE2))
+            kernels.kernelSet = UpdateMaskKernels::KERNELS_SSE2;
+
+        kernels.setNonZeroBits = getSetNonZeroBits(kernels.kernelSet);
+        return kernels;
+    }
+
+    const Kernels& getKernels()
+    {
+        static const Kernels kernels = selectKernels();
+        return kernels;
+    }
+}
+
+UpdateMaskKernels::KernelSet UpdateMaskKernels::getKernelSet()
+{
+    return getKernels().kernelSet;
+}
+
+bool UpdateMaskKernels::isKernelSetSupported(KernelSet kernelSet)
+{
+    switch (kernelSet)
+    {
+#ifdef UPDATEMASK_KERNELS_X86
+        case KERNELS_AVX2:
+            return hasAVX2();
+        case KERNELS_SSE2:
+            return true;
+#endif
+        case KERNELS_SCALAR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* UpdateMaskKernels::getKernelSetName()
+{
+    return getKernelSetName(getKernelSet());
+}
+
+const char* UpdateMaskKernels::getKernelSetName(KernelSet kernelSet)
+{
+    switch (kernelSet)
+    {
+        case KERNELS_AVX2:
+            return "AVX2";
+        case KERNELS_SSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+    }
+}
+
+void UpdateMaskKernels::setNonZeroBits(const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask)
+{
+    getKernels().setNonZeroBits(values, count, filter, mask);
+}
+
+void UpdateMaskKernels::setNonZeroBits(KernelSet kernelSet, const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask)
+{
+    getSetNonZeroBits(isKernelSetSupported(kernelSet) ? kernelSet : KERNELS_SCALAR)(values, count, filter, mask);
+}
+
+uint32_t UpdateMaskKernels::gatherValues(const uint32_t* mask, uint32_t blocks, const uint32_t* values, uint32_t* out)
+{
+    // x86 has no compress instruction below AVX-512, walking the set bits is faster than any shuffle
+    uint32_t* next = out;
+    for (uint32_t word = 0; word < blocks; ++word)
+    {
+        const uint32_t* block = values + (word << 5);
+        for (uint32_t bits = mask[word]; bits != 0; bits &= bits - 1)
+            *next++ = block[lowestBit(bits)];
+    }
+
+    return static_cast<uint32_t>(next - out);
+}
+
+uint32_t UpdateMaskKernels::countBits(const uint32_t* mask, uint32_t blocks)
+{
+    uint32_t count = 0;
+    for (uint32_t word = 0; word < blocks; ++word)
+        count += popCount(mask[word]);
+
+    return count;
+}
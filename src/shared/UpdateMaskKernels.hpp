@@ -0,0 +1,47 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <cstdint>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Word at a time kernels for update masks and value arrays.
+///
+/// The mask has one bit per uint32 field, bit i of word i / 32 belongs to field i. The
+/// compares are done with SSE2 or AVX2, whichever the cpu supports, picked once on first
+/// use. Other cpus use plain C++ loops with the same results.
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace UpdateMaskKernels
+{
+    enum KernelSet
+    {
+        KERNELS_SCALAR,
+        KERNELS_SSE2,
+        KERNELS_AVX2
+    };
+
+    /// the kernel set picked for this cpu
+    KernelSet getKernelSet();
+    bool isKernelSetSupported(KernelSet kernelSet);
+
+    const char* getKernelSetName();
+    const char* getKernelSetName(KernelSet kernelSet);
+
+    /// sets the bit of every non zero value, limited to the bits set in filter unless it is nullptr.
+    /// Other bits of mask are left as they are
+    void setNonZeroBits(const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask);
+
+    /// same with the kernels of kernelSet, for benchmarks and tests. Unsupported sets run the scalar loop
+    void setNonZeroBits(KernelSet kernelSet, const uint32_t* values, uint32_t count, const uint32_t* filter, uint32_t* mask);
+
+    /// copies the values of the set bits of the first blocks mask words to out, in field order.
+    /// Returns the number of copied values
+    uint32_t gatherValues(const uint32_t* mask, uint32_t blocks, const uint32_t* values, uint32_t* out);
+
+    uint32_t countBits(const uint32_t* mask, uint32_t blocks);
+}
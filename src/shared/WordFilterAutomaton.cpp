@@ -0,0 +1,198 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "WordFilterAutomaton.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// WordFilterAutomaton
+WordFilterAutomaton::WordFilterAutomaton() : m_patternCount(0)
+{
+    m_nodes.push_back(Node());
+    for (uint32_t i = 0; i < 256; ++i)
+        m_rootEdges[i] = 0;
+}
+
+uint32_t WordFilterAutomaton::_getEdge(uint32_t node, uint8_t c) const
+{
+    const std::vector<std::pair<uint8_t, uint32_t>>& edges = m_nodes[node].edges;
+    std::vector<std::pair<uint8_t, uint32_t>>::const_iterator itr = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, uint32_t(0)));
+    if (itr != edges.end() && itr->first == c)
+        return itr->second;
+
+    return 0;
+}
+
+uint32_t WordFilterAutomaton::_next(uint32_t state, uint8_t c) const
+{
+    while (state != 0)
+    {
+        if (const uint32_t next = _getEdge(state, c))
+            return next;
+
+        state = m_nodes[state].fail;
+    }
+
+    return m_rootEdges[c];
+}
+
+void WordFilterAutomaton::addPattern(const std::string& pattern, uint32_t id)
+{
+    uint32_t node = 0;
+    for (std::string::const_iterator itr = pattern.begin(); itr != pattern.end(); ++itr)
+    {
+        const uint8_t c = static_cast<uint8_t>(*itr);
+
+        uint32_t next = node == 0 ? m_rootEdges[c] : _getEdge(node, c);
+        if (next == 0)
+        {
+            next = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(Node());
+
+            if (node == 0)
+            {
+                m_rootEdges[c] = next;
+            }
+            else
+            {
+                std::vector<std::pair<uint8_t, uint32_t>>& edges = m_nodes[node].edges;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, uint32_t(0))), std::make_pair(c, next));
+            }
+        }
+
+        node = next;
+    }
+
+    m_nodes[node].outputs.push_back(id);
+    m_nodes[node].hasOutput = true;
+    ++m_patternCount;
+}
+
+void WordFilterAutomaton::build()
+{
+    // breadth first, the fail link of a node always points to a shallower one
+    std::vector<uint32_t> queue;
+    for (uint32_t c = 0; c < 256; ++c)
+    {
+        if (m_rootEdges[c] != 0)
+            queue.push_back(m_rootEdges[c]);
+    }
+
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        const uint32_t node = queue[i];
+        for (std::vector<std::pair<uint8_t, uint32_t>>::const_iterator itr = m_nodes[node].edges.begin(); itr != m_nodes[node].edges.end(); ++itr)
+        {
+            const uint32_t child = itr->second;
+            const uint32_t fail = _next(m_nodes[node].fail, itr->first);
+
+            m_nodes[child].fail = fail;
+            m_nodes[child].outputLink = m_nodes[fail].hasOutput ? fail : m_nodes[fail].outputLink;
+            queue.push_back(child);
+        }
+    }
+}
+
+bool WordFilterAutomaton::isLiteralExpression(const std::string& sExpression)
+{
+    return sExpression.find_first_of("\\^$.[]|()?*+{}") == std::string::npos;
+}
+
+std::string WordFilterAutomaton::getRequiredLiteral(const std::string& sExpression)
+{
+    if (sExpression.find_first_of("|(") != std::string::npos)
+        return "";
+
+    std::string sBest;
+    std::string sRun;
+    for (size_t i = 0; i < sExpression.length(); ++i)
+    {
+        const char c = sExpression[i];
+        switch (c)
+        {
+            case '\\':
+                if (i + 1 >= sExpression.length())
+                    return "";
+
+                // the arguments of \x41, \x{263a}, \0nn, \1, \cX, \o{..}, \p{L}, \g{1} and \k<name>
+                // and the text quoted by \Q..\E are no runs of their own
+                if (isdigit(static_cast<uint8_t>(sExpression[i + 1])) || strchr("xcopPgkQE", sExpression[i + 1]) != nullptr)
+                    return "";
+
+                // \d, \w, \b and the like are no literals, escaped punctuation is
+                if (isalnum(static_cast<uint8_t>(sExpression[++i])))
+                {
+                    if (sRun.length() > sBest.length())
+                        sBest = sRun;
+                    sRun.clear();
+                }
+                else
+                {
+                    sRun += sExpression[i];
+                }
+                break;
+            case '[':
+            {
+                // a ']' right after '[' or '[^' belongs to the class
+                size_t iEnd = i + 1;
+                if (iEnd < sExpression.length() && sExpression[iEnd] == '^')
+                    ++iEnd;
+                if (iEnd < sExpression.length() && sExpression[iEnd] == ']')
+                    ++iEnd;
+
+                iEnd = sExpression.find(']', iEnd);
+                if (iEnd == std::string::npos)
+                    return "";
+
+                if (sRun.length() > sBest.length())
+                    sBest = sRun;
+                sRun.clear();
+                i = iEnd;
+                break;
+            }
+            case '?':
+            case '*':
+            case '{':
+                // the previous character is optional
+                if (!sRun.empty())
+                    sRun.erase(sRun.length() - 1);
+                if (sRun.length() > sBest.length())
+                    sBest = sRun;
+                sRun.clear();
+
+                if (c == '{')
+                {
+                    i = sExpression.find('}', i);
+                    if (i == std::string::npos)
+                        return "";
+                }
+                break;
+            case '+':
+                // the previous character is required, but may repeat
+                if (sRun.length() > sBest.length())
+                    sBest = sRun;
+                sRun.clear();
+                break;
+            case '.':
+            case '^':
+            case '$':
+                if (sRun.length() > sBest.length())
+                    sBest = sRun;
+                sRun.clear();
+                break;
+            default:
+                sRun += c;
+                break;
+        }
+    }
+
+    if (sRun.length() > sBest.length())
+        sBest = sRun;
+
+    return sBest;
+}
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Aho-Corasick automaton finding all literal filters of the WordFilter in one pass over a
+/// message, and the literals regex filters are prefiltered with.
+//////////////////////////////////////////////////////////////////////////////////////////
+class WordFilterAutomaton
+{
+    public:
+
+        WordFilterAutomaton();
+
+        void addPattern(const std::string& pattern, uint32_t id);
+
+        /// builds the failure links, has to be called once after the last addPattern
+        void build();
+
+        bool isEmpty() const { return m_patternCount == 0; }
+
+        /// true if the expression has no regex syntax, so it can be matched by the automaton
+        static bool isLiteralExpression(const std::string& expression);
+
+        /// longest run of characters every match of the expression contains, empty if there is
+        /// none or the expression uses alternations, groups or escapes with arguments, which
+        /// are not looked into
+        static std::string getRequiredLiteral(const std::string& expression);
+
+        /// calls func(id, end) for every occurrence, end is the offset behind the match.
+        /// Stops early when func returns false.
+        template <typename Func>
+        void search(const char* text, size_t length, Func func) const
+        {
+            uint32_t state = 0;
+            for (size_t i = 0; i < length; ++i)
+            {
+                state = _next(state, static_cast<uint8_t>(text[i]));
+
+                for (uint32_t node = m_nodes[state].hasOutput ? state : m_nodes[state].outputLink; node != 0; node = m_nodes[node].outputLink)
+                {
+                    for (std::vector<uint32_t>::const_iterator itr = m_nodes[node].outputs.begin(); itr != m_nodes[node].outputs.end(); ++itr)
+                    {
+                        if (!func(*itr, i + 1))
+                            return;
+                    }
+                }
+            }
+        }
+
+    private:
+
+        struct Node
+        {
+            Node() : fail(0), outputLink(0), hasOutput(false) {}
+
+            std::vector<std::pair<uint8_t, uint32_t>> edges;    // sorted by character
+            std::vector<uint32_t> outputs;
+            uint32_t fail;
+            uint32_t outputLink;                                // next node on the fail chain with outputs
+            bool hasOutput;
+        };
+
+        uint32_t _getEdge(uint32_t node, uint8_t c) const;
+        uint32_t _next(uint32_t state, uint8_t c) const;
+
+        std::vector<Node> m_nodes;
+        uint32_t m_rootEdges[256];                              // dense, the root is entered on most characters
+        uint32_t m_patternCount;
+};
@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "AsyncLogWriter.hpp"
+#include "Util.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const char* source = "AsyncLogWriterTest";
+
+    int formatLine(char* text, size_t size, uint32_t i)
+    {
+        return snprintf(text, size, "Spell %u of unit %u hit %u targets for %u damage", 10000 + i % 5000, i % 80, i % 10, i * 7 % 3000);
+    }
+
+    long getFileSize(FILE* file)
+    {
+        fflush(file);
+        fseek(file, 0, SEEK_END);
+        return ftell(file);
+    }
+
+    uint32_t countLines(FILE* file)
+    {
+        uint32_t lines = 0;
+        rewind(file);
+        for (int c = fgetc(file); c != EOF; c = fgetc(file))
+        {
+            if (c == '\n')
+                ++lines;
+        }
+
+        return lines;
+    }
+
+    // cost of a log line for the logging thread: the fprintf AscEmuLog::WriteFile did on the
+    // logging thread against handing the line to the writer, stop has to write every queued
+    // line before it returns, so both files end up with the same size
+    void benchmarkWrite()
+    {
+        const uint32_t iterations = 200000;
+
+        FILE* referenceFile = tmpfile();
+        FILE* currentFile = tmpfile();
+        TEST_CHECK(referenceFile != nullptr && currentFile != nullptr);
+        if (referenceFile == nullptr || currentFile == nullptr)
+            return;
+
+        AsyncLogWriter writer;
+        writer.registerFile(currentFile, "");
+        writer.start(LOG_OVERFLOW_BLOCK, 0);
+
+        typedef std::chrono::steady_clock Clock;
+        char text[96];
+
+        const Clock::time_point referenceStart = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            formatLine(text, sizeof(text), i);
+
+            std::string current_time = "[" + Util::GetCurrentTimeString() + "] ";
+            fprintf(referenceFile, "%s %s: %s\n", current_time.c_str(), source, text);
+        }
+        const double referenceTime = std::chrono::duration<double, std::nano>(Clock::now() - referenceStart).count();
+
+        const Clock::time_point currentStart = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            formatLine(text, sizeof(text), i);
+            TEST_CHECK(writer.write(currentFile, source, text));
+        }
+        const double currentTime = std::chrono::duration<double, std::nano>(Clock::now() - currentStart).count();
+
+        const Clock::time_point drainStart = Clock::now();
+        writer.stop();
+        const double drainTime = std::chrono::duration<double, std::milli>(Clock::now() - drainStart).count();
+
+        const long referenceSize = getFileSize(referenceFile);
+        const long currentSize = getFileSize(currentFile);
+        TEST_CHECK(referenceSize == currentSize);
+        TEST_CHECK(writer.getDroppedCount() == 0);
+
+        std::printf("AsyncLogWriterTest : %u lines: fprintf %.1f ns/line, writer %.1f ns/line, stop drained in %.1f ms, %ld and %ld bytes\n",
+            iterations, referenceTime / iterations, currentTime / iterations, drainTime, referenceSize, currentSize);
+
+        fclose(referenceFile);
+        fclose(currentFile);
+    }
+
+    // every thread gets its own ring, none of their lines may get lost when blocking
+    void testThreads()
+    {
+        const uint32_t threadCount = 4;
+        const uint32_t linesPerThread = 50000;
+
+        FILE* file = tmpfile();
+        TEST_CHECK(file != nullptr);
+        if (file == nullptr)
+            return;
+
+        AsyncLogWriter writer;
+        writer.registerFile(file, "");
+        writer.start(LOG_OVERFLOW_BLOCK, 0);
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; ++t)
+        {
+            threads.push_back(std::thread([&writer, file, t]()
+            {
+                char text[96];
+                for (uint32_t i = 0; i < linesPerThread; ++i)
+                {
+                    formatLine(text, sizeof(text), t * linesPerThread + i);
+                    writer.write(file, source, text);
+                }
+            }));
+        }
+
+        for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+            itr->join();
+
+        writer.stop();
+
+        TEST_CHECK(countLines(file) == threadCount * linesPerThread);
+        TEST_CHECK(writer.getDroppedCount() == 0);
+
+        // the writer is stopped, a write has to be done by the caller again
+        TEST_CHECK(!writer.write(file, source, "after stop"));
+
+        fclose(file);
+    }
+}
+
+int main()
+{
+    benchmarkWrite();
+    testThreads();
+
+    std::printf("AsyncLogWriterTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
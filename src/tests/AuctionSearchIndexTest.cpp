@@ -0,0 +1,366 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Management/AuctionSearchIndex.h"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const char* nameWords[] =
+    {
+        "sword", "axe", "mace", "dagger", "staff", "bow", "shield", "helm", "gauntlets", "boots", "belt", "cloak",
+        "ring", "amulet", "robe", "leggings", "of", "the", "bear", "eagle", "monkey", "tiger", "whale", "owl",
+        "falcon", "wolf", "ancient", "runed", "blessed", "cursed", "fiery", "frozen", "bloodsoaked", "shadowcraft",
+        "mithril", "thorium", "felsteel", "adamantite", "titanium", "saronite"
+    };
+    const uint32_t nameWordCount = sizeof(nameWords) / sizeof(nameWords[0]);
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    /// Item reduced to what the index asks
+    struct ModelItem
+    {
+        ItemProperties const* proto;
+
+        ItemProperties const* GetItemProperties() const { return proto; }
+    };
+
+    struct ModelAuction
+    {
+        uint32_t Id;
+        bool Deleted;
+        ModelItem* pItem;
+    };
+
+    typedef BasicAuctionSearchIndex<ModelAuction> ModelSearchIndex;
+    typedef std::unordered_map<uint32_t, ModelAuction*> AuctionMap;
+
+    std::vector<ItemProperties> createItemProperties(uint32_t& state, uint32_t count)
+    {
+        std::vector<ItemProperties> protos(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ItemProperties& proto = protos[i];
+            proto.ItemId = 1000 + i;
+            proto.Class = nextRandom(state) % 16;
+            proto.SubClass = nextRandom(state) % 12;
+            proto.InventoryType = nextRandom(state) % 29;
+            proto.Quality = nextRandom(state) % 7;
+            proto.RequiredLevel = nextRandom(state) % 81;
+
+            const uint32_t words = 2 + nextRandom(state) % 3;
+            for (uint32_t w = 0; w < words; ++w)
+            {
+                if (w != 0)
+                    proto.lowercase_name += ' ';
+
+                proto.lowercase_name += nameWords[nextRandom(state) % nameWordCount];
+            }
+        }
+
+        return protos;
+    }
+
+    // SendAuctionList before the index: every auction of the house checked one by one
+    template <typename Func>
+    void scanAuctions(const AuctionMap& auctions, const AuctionSearchQuery& query, Func func)
+    {
+        std::string name = query.name;
+
+        for (AuctionMap::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
+        {
+            if (itr->second->Deleted)
+                continue;
+
+            ItemProperties const* proto = itr->second->pItem->GetItemProperties();
+            if (query.inventoryType != -1 && query.inventoryType != int32_t(proto->InventoryType))
+                continue;
+            if (query.itemClass != -1 && query.itemClass != int32_t(proto->Class))
+                continue;
+            if (query.itemSubClass != -1 && query.itemSubClass != int32_t(proto->SubClass))
+                continue;
+
+            std::string proto_lower = proto->lowercase_name;
+            if (name.length() > 0 && proto_lower.find(name) == std::string::npos)
+                continue;
+
+            if (query.quality != -1 && query.quality > int32_t(proto->Quality))
+                continue;
+            if (query.levelMin && proto->RequiredLevel < query.levelMin)
+                continue;
+            if (query.levelMax && proto->RequiredLevel > query.levelMax)
+                continue;
+
+            func(itr->second);
+        }
+    }
+
+    AuctionSearchQuery randomQuery(uint32_t& state, const std::vector<ItemProperties>& protos)
+    {
+        AuctionSearchQuery query;
+
+        const uint32_t nameChoice = nextRandom(state) % 6;
+        if (nameChoice == 1)
+            query.name = nameWords[nextRandom(state) % nameWordCount];
+        else if (nameChoice == 2)
+            query.name = protos[nextRandom(state) % protos.size()].lowercase_name;
+        else if (nameChoice == 3)
+        {
+            // parts of a name, across word borders and shorter than a trigram
+            const std::string& name = protos[nextRandom(state) % protos.size()].lowercase_name;
+            const size_t start = nextRandom(state) % name.length();
+            query.name = name.substr(start, 1 + nextRandom(state) % 6);
+        }
+
+        if (nextRandom(state) % 3 == 0)
+            query.itemClass = nextRandom(state) % 17;
+        if (query.itemClass != -1 && nextRandom(state) % 2 == 0)
+            query.itemSubClass = nextRandom(state) % 13;
+        if (nextRandom(state) % 4 == 0)
+            query.inventoryType = nextRandom(state) % 30;
+        if (nextRandom(state) % 4 == 0)
+            query.quality = nextRandom(state) % 7;
+        if (nextRandom(state) % 4 == 0)
+            query.levelMin = nextRandom(state) % 81;
+        if (nextRandom(state) % 4 == 0)
+            query.levelMax = query.levelMin + nextRandom(state) % 30;
+
+        return query;
+    }
+
+    // auctions come, go and get deleted while searching, the index finds what the scan finds
+    // in id order, and a page continued after an id holds the rest of the matches
+    void testAgainstScan(uint32_t& state)
+    {
+        const std::vector<ItemProperties> protos = createItemProperties(state, 300);
+
+        AuctionMap auctions;
+        ModelSearchIndex index;
+        std::vector<ModelItem*> items;
+        uint32_t nextId = 1;
+
+        for (uint32_t step = 0; step < 20000; ++step)
+        {
+            const uint32_t action = nextRandom(state) % 10;
+            if (action < 4 || auctions.empty())
+            {
+                ModelItem* item = new ModelItem;
+                item->proto = &protos[nextRandom(state) % protos.size()];
+                items.push_back(item);
+
+                ModelAuction* auction = new ModelAuction;
+                auction->Id = nextId++;
+                auction->Deleted = false;
+                auction->pItem = item;
+
+                auctions[auction->Id] = auction;
+                index.addAuction(auction);
+            }
+            else if (action < 6)
+            {
+                AuctionMap::iterator itr = auctions.find(1 + nextRandom(state) % (nextId - 1));
+                if (itr == auctions.end())
+                    continue;
+
+                // a deleted auction waits for the next update of the house before it is removed
+                if (action == 4)
+                {
+                    itr->second->Deleted = true;
+                    continue;
+                }
+
+                const uint32_t version = index.getVersion();
+                index.removeAuction(itr->second);
+                TEST_CHECK(index.getVersion() != version);
+
+                delete itr->second;
+                auctions.erase(itr);
+            }
+            else
+            {
+                const AuctionSearchQuery query = randomQuery(state, protos);
+
+                std::vector<uint32_t> expected;
+                scanAuctions(auctions, query, [&expected](ModelAuction* auction) { expected.push_back(auction->Id); });
+                std::sort(expected.begin(), expected.end());
+
+                std::vector<uint32_t> found;
+                index.search(query, 0, [&found](ModelAuction* auction)
+                {
+                    found.push_back(auction->Id);
+                    return true;
+                });
+
+                TEST_CHECK(found == expected);
+
+                if (!expected.empty())
+                {
+                    const size_t split = nextRandom(state) % expected.size();
+
+                    std::vector<uint32_t> rest;
+                    index.search(query, expected[split], [&rest](ModelAuction* auction)
+                    {
+                        rest.push_back(auction->Id);
+                        return true;
+                    });
+
+                    TEST_CHECK(rest == std::vector<uint32_t>(expected.begin() + split + 1, expected.end()));
+                }
+            }
+
+            TEST_CHECK(index.getSize() == auctions.size());
+        }
+
+        for (AuctionMap::iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
+            delete itr->second;
+        for (std::vector<ModelItem*>::iterator itr = items.begin(); itr != items.end(); ++itr)
+            delete *itr;
+    }
+
+    struct AuctionSearchMix
+    {
+        const char* name;
+        AuctionSearchQuery query;
+        bool nextPage;
+    };
+
+    // auction list searches on a house with 20000 auctions of 5000 item entries: the first
+    // page counts every match, a following page of the same search continues after the last
+    // id, as AuctionHouse::SearchAuctions does. The usable check needs a player and is left out.
+    void benchmarkSearch(uint32_t& state)
+    {
+        const uint32_t auctionCount = 20000;
+        const uint32_t entryCount = 5000;
+        const uint32_t pageSize = 50;
+        const uint32_t iterations = 200;
+
+        const std::vector<ItemProperties> protos = createItemProperties(state, entryCount);
+
+        std::vector<ModelItem> items(auctionCount);
+        std::vector<ModelAuction> auctionStore(auctionCount);
+        AuctionMap auctions;
+        ModelSearchIndex index;
+        for (uint32_t i = 0; i < auctionCount; ++i)
+        {
+            items[i].proto = &protos[nextRandom(state) % entryCount];
+
+            ModelAuction* auction = &auctionStore[i];
+            auction->Id = i + 1;
+            auction->Deleted = false;
+            auction->pItem = &items[i];
+
+            auctions[auction->Id] = auction;
+            index.addAuction(auction);
+        }
+
+        std::vector<AuctionSearchMix> mixes(7);
+        mixes[0].name = "name, common word";
+        mixes[0].query.name = "of the";
+        mixes[1].name = "name, one item";
+        mixes[1].query.name = protos[entryCount / 3].lowercase_name;
+        mixes[2].name = "name, two letters";
+        mixes[2].query.name = "ax";
+        mixes[3].name = "weapons";
+        mixes[3].query.itemClass = ITEM_CLASS_WEAPON;
+        mixes[4].name = "plate, rare, level 60-70";
+        mixes[4].query.itemClass = ITEM_CLASS_ARMOR;
+        mixes[4].query.itemSubClass = ITEM_SUBCLASS_ARMOR_PLATE_MAIL;
+        mixes[4].query.quality = ITEM_QUALITY_RARE_BLUE;
+        mixes[4].query.levelMin = 60;
+        mixes[4].query.levelMax = 70;
+        mixes[5].name = "everything, first page";
+        mixes[6].name = "everything, second page";
+        for (size_t i = 0; i < mixes.size(); ++i)
+            mixes[i].nextPage = i == 6;
+
+        typedef std::chrono::steady_clock Clock;
+
+        for (std::vector<AuctionSearchMix>::const_iterator mix = mixes.begin(); mix != mixes.end(); ++mix)
+        {
+            const AuctionSearchQuery& query = mix->query;
+
+            // the cursor SearchAuctions keeps after the first page of a search
+            uint32_t afterId = 0;
+            uint32_t knownTotal = 0;
+            if (mix->nextPage)
+            {
+                index.search(query, 0, [&](ModelAuction* auction)
+                {
+                    if (++knownTotal == pageSize)
+                        afterId = auction->Id;
+                    return true;
+                });
+            }
+
+            // the old page was every match after skipping the previous pages, in map order
+            const uint32_t skip = mix->nextPage ? pageSize : 0;
+
+            const Clock::time_point scanStart = Clock::now();
+            uint64_t scanChecksum = 0;
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                uint32_t total = 0;
+                std::vector<uint32_t> page;
+                scanAuctions(auctions, query, [&](ModelAuction* auction)
+                {
+                    if (++total > skip && page.size() < pageSize)
+                        page.push_back(auction->Id);
+                });
+
+                // the pages differ in their order, compare how many auctions were listed
+                scanChecksum += (uint64_t(total) << 32) + page.size();
+            }
+            const double scanTime = std::chrono::duration<double, std::micro>(Clock::now() - scanStart).count();
+
+            const Clock::time_point indexStart = Clock::now();
+            uint64_t indexChecksum = 0;
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                uint32_t total = 0;
+                std::vector<uint32_t> page;
+                index.search(query, afterId, [&](ModelAuction* auction)
+                {
+                    ++total;
+                    if (page.size() < pageSize)
+                        page.push_back(auction->Id);
+
+                    return !mix->nextPage || page.size() < pageSize;
+                });
+
+                indexChecksum += (uint64_t(mix->nextPage ? knownTotal : total) << 32) + page.size();
+            }
+            const double indexTime = std::chrono::duration<double, std::micro>(Clock::now() - indexStart).count();
+
+            TEST_CHECK(indexChecksum == scanChecksum);
+
+            std::printf("AuctionSearchIndexTest : %s: scan %.1f us, index %.1f us\n", mix->name, scanTime / iterations, indexTime / iterations);
+        }
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x1B873593;
+
+    testAgainstScan(state);
+    benchmarkSearch(state);
+
+    std::printf("AuctionSearchIndexTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
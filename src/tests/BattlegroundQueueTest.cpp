@@ -0,0 +1,801 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Management/Battleground/BattlegroundQueue.h"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace
+{
+    enum SimType
+    {
+        TYPE_ALTERAC_VALLEY,
+        TYPE_WARSONG_GULCH,
+        TYPE_ARATHI_BASIN,
+        TYPE_RANDOM,            // starts and fills the three others
+        TYPE_COUNT
+    };
+
+    const uint32_t levelGroupCount = 6;
+    const uint32_t playerCount = 4000;
+    const uint32_t minPlayers[TYPE_COUNT] = { 10, 5, 8, 0 };
+    const uint32_t maxPlayers[TYPE_COUNT] = { 40, 10, 15, 0 };
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    struct SimPlayer
+    {
+        uint32_t team;
+        uint32_t levelGroup;
+        bool deserter;
+        bool queued;
+        uint32_t queueType;
+        uint32_t queueLevelGroup;
+        uint32_t queueInstanceId;
+        uint32_t instanceType;
+        uint32_t instanceId;    // 0 while not in an instance
+    };
+
+    struct SimInstance
+    {
+        uint32_t type;
+        uint32_t levelGroup;
+        uint32_t size[2];       // players and pending players per team
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The players and instances the CBattlegroundManager sees. queueChanged is set where
+    /// the manager sets m_queueChanged, only the bucketed matcher reads it.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class SimWorld
+    {
+        public:
+
+            explicit SimWorld(uint32_t seed) : nextInstanceId(1), randomState(0x6C078965)
+            {
+                players.resize(playerCount);
+                for (uint32_t guid = 0; guid < playerCount; ++guid)
+                {
+                    SimPlayer& player = players[guid];
+                    player.team = nextRandom(seed) % 2;
+                    player.levelGroup = nextRandom(seed) % levelGroupCount;
+                    player.deserter = false;
+                    player.queued = false;
+                    player.queueType = 0;
+                    player.queueLevelGroup = 0;
+                    player.queueInstanceId = 0;
+                    player.instanceType = 0;
+                    player.instanceId = 0;
+                }
+
+                for (uint32_t i = 0; i < TYPE_COUNT; ++i)
+                {
+                    for (uint32_t j = 0; j < levelGroupCount; ++j)
+                        queueChanged[i][j] = false;
+                }
+            }
+
+            // CBattleground::HasFreeSlots, the teams stay even
+            bool hasFreeSlots(const SimInstance& instance, uint32_t team) const
+            {
+                return instance.size[team] < maxPlayers[instance.type] && static_cast<int>(instance.size[team]) - static_cast<int>(instance.size[1 - team]) <= 0;
+            }
+
+            bool isFull(const SimInstance& instance) const
+            {
+                return !(hasFreeSlots(instance, 0) || hasFreeSlots(instance, 1));
+            }
+
+            // CBattleground::CanPlayerJoin
+            bool canPlayerJoin(const SimInstance& instance, const SimPlayer& player) const
+            {
+                return hasFreeSlots(instance, player.team) && player.levelGroup == instance.levelGroup && !player.deserter;
+            }
+
+            // CBattleground::AddPlayer, the player is pending and out of the queue
+            void addPlayer(uint32_t type, uint32_t instanceId, uint32_t guid, uint32_t team)
+            {
+                SimInstance& instance = instances[type][instanceId];
+                ++instance.size[team];
+
+                players[guid].queued = false;
+                players[guid].instanceType = type;
+                players[guid].instanceId = instanceId;
+
+                onInstanceSlotsChanged(type, instance.levelGroup);
+            }
+
+            // CBattleground::RemovePlayer and RemovePendingPlayer
+            void removePlayer(uint32_t guid)
+            {
+                SimPlayer& player = players[guid];
+                SimInstance& instance = instances[player.instanceType][player.instanceId];
+                --instance.size[player.team];
+                player.instanceId = 0;
+
+                onInstanceSlotsChanged(instance.type, instance.levelGroup);
+            }
+
+            uint32_t createInstance(uint32_t type, uint32_t levelGroup)
+            {
+                SimInstance instance;
+                instance.type = type;
+                instance.levelGroup = levelGroup;
+                instance.size[0] = 0;
+                instance.size[1] = 0;
+
+                const uint32_t instanceId = nextInstanceId++;
+                instances[type].insert(std::make_pair(instanceId, instance));
+
+                onInstanceSlotsChanged(type, levelGroup);
+                return instanceId;
+            }
+
+            void onInstanceSlotsChanged(uint32_t type, uint32_t levelGroup)
+            {
+                queueChanged[type][levelGroup] = true;
+                queueChanged[TYPE_RANDOM][levelGroup] = true;
+            }
+
+            std::vector<SimPlayer> players;
+            std::map<uint32_t, SimInstance> instances[TYPE_COUNT];
+            bool queueChanged[TYPE_COUNT][levelGroupCount];
+            uint32_t nextInstanceId;
+            uint32_t randomState;   // RandomUInt of the random battleground
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The part of CBattlegroundManager::UpdateQueue after the queue walk: the players of
+    /// both factions fill the running instances, then a new one is started if there are
+    /// enough of them. remove(guid) takes a matched player out of the queue.
+    //////////////////////////////////////////////////////////////////////////////////////
+    template <typename RemoveFunc>
+    void fillAndStart(SimWorld& world, uint32_t i, uint32_t j, std::deque<uint32_t>* tempPlayerVec, RemoveFunc remove)
+    {
+        // AddPlayerToBgTeam
+        auto addPlayerToBgTeam = [&](uint32_t type, uint32_t instanceId, uint32_t team)
+        {
+            if (world.hasFreeSlots(world.instances[type][instanceId], team))
+            {
+                const uint32_t guid = tempPlayerVec[team].front();
+                tempPlayerVec[team].pop_front();
+
+                world.addPlayer(type, instanceId, guid, team);
+                remove(guid);
+            }
+        };
+
+        std::vector<uint32_t> tryJoinVec;
+        if (i == TYPE_RANDOM)
+        {
+            tryJoinVec.push_back(TYPE_ALTERAC_VALLEY);
+            tryJoinVec.push_back(TYPE_WARSONG_GULCH);
+            tryJoinVec.push_back(TYPE_ARATHI_BASIN);
+        }
+        else
+        {
+            tryJoinVec.push_back(i);
+        }
+
+        for (std::vector<uint32_t>::const_iterator type = tryJoinVec.begin(); type != tryJoinVec.end(); ++type)
+        {
+            for (std::map<uint32_t, SimInstance>::iterator itr = world.instances[*type].begin(); itr != world.instances[*type].end(); ++itr)
+            {
+                if (itr->second.levelGroup != j)
+                    continue;
+
+                const size_t size = std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
+                for (size_t counter = 0; counter < size && !world.isFull(itr->second); ++counter)
+                {
+                    addPlayerToBgTeam(*type, itr->first, 0);
+                    addPlayerToBgTeam(*type, itr->first, 1);
+                }
+
+                while (!tempPlayerVec[0].empty() && world.hasFreeSlots(itr->second, 0))
+                    addPlayerToBgTeam(*type, itr->first, 0);
+                while (!tempPlayerVec[1].empty() && world.hasFreeSlots(itr->second, 1))
+                    addPlayerToBgTeam(*type, itr->first, 1);
+            }
+        }
+
+        uint32_t bgToStart = i;
+        if (i == TYPE_RANDOM)
+        {
+            std::vector<uint32_t> bgPossible;
+            for (std::vector<uint32_t>::const_iterator type = tryJoinVec.begin(); type != tryJoinVec.end(); ++type)
+            {
+                if (tempPlayerVec[0].size() >= minPlayers[*type] && tempPlayerVec[1].size() >= minPlayers[*type])
+                    bgPossible.push_back(*type);
+            }
+
+            if (!bgPossible.empty())
+                bgToStart = bgPossible[nextRandom(world.randomState) % bgPossible.size()];
+        }
+
+        if (bgToStart == TYPE_RANDOM || tempPlayerVec[0].size() < minPlayers[bgToStart] || tempPlayerVec[1].size() < minPlayers[bgToStart])
+            return;
+
+        const uint32_t instanceId = world.createInstance(bgToStart, j);
+
+        const size_t size = std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
+        for (size_t counter = 0; counter < size && !world.isFull(world.instances[bgToStart][instanceId]); ++counter)
+        {
+            addPlayerToBgTeam(bgToStart, instanceId, 0);
+            addPlayerToBgTeam(bgToStart, instanceId, 1);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The queue before BattlegroundQueue: one list per type and level group, walked on
+    /// every queue update, leaving it walks the list.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class FullScanMatcher
+    {
+        public:
+
+            void join(const SimWorld& world, uint32_t guid)
+            {
+                const SimPlayer& player = world.players[guid];
+                m_queuedPlayers[player.queueType][player.queueLevelGroup].push_back(guid);
+            }
+
+            void leave(const SimWorld& world, uint32_t guid)
+            {
+                const SimPlayer& player = world.players[guid];
+                erasePlayerFromList(guid, m_queuedPlayers[player.queueType][player.queueLevelGroup]);
+            }
+
+            void update(SimWorld& world)
+            {
+                for (uint32_t i = 0; i < TYPE_COUNT; ++i)
+                {
+                    for (uint32_t j = 0; j < levelGroupCount; ++j)
+                    {
+                        if (!m_queuedPlayers[i][j].empty())
+                            updateQueue(world, i, j);
+                    }
+                }
+            }
+
+        private:
+
+            static void erasePlayerFromList(uint32_t guid, std::list<uint32_t>& list)
+            {
+                for (std::list<uint32_t>::iterator itr = list.begin(); itr != list.end(); ++itr)
+                {
+                    if (*itr == guid)
+                    {
+                        list.erase(itr);
+                        return;
+                    }
+                }
+            }
+
+            void updateQueue(SimWorld& world, uint32_t i, uint32_t j)
+            {
+                std::list<uint32_t>& list = m_queuedPlayers[i][j];
+                std::deque<uint32_t> tempPlayerVec[2];
+
+                for (std::list<uint32_t>::iterator itr = list.begin(); itr != list.end();)
+                {
+                    const std::list<uint32_t>::iterator current = itr++;
+                    const SimPlayer& player = world.players[*current];
+
+                    if (player.levelGroup != j)
+                    {
+                        list.erase(current);
+                        continue;
+                    }
+
+                    if (player.queueInstanceId != 0)
+                    {
+                        // DeleteBattleground took the players of closed instances out of the queue
+                        const SimInstance& instance = world.instances[i].find(player.queueInstanceId)->second;
+                        if (world.canPlayerJoin(instance, player))
+                        {
+                            world.addPlayer(i, player.queueInstanceId, *current, player.team);
+                            list.erase(current);
+                        }
+                    }
+                    else if (!player.deserter)
+                    {
+                        tempPlayerVec[player.team].push_back(*current);
+                    }
+                }
+
+                fillAndStart(world, i, j, tempPlayerVec, [&list](uint32_t guid) { erasePlayerFromList(guid, list); });
+            }
+
+            std::list<uint32_t> m_queuedPlayers[TYPE_COUNT][levelGroupCount];
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// BattlegroundQueue, only the queues flagged since the last update are matched.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class BucketMatcher
+    {
+        public:
+
+            void join(const SimWorld& world, uint32_t guid)
+            {
+                const SimPlayer& player = world.players[guid];
+                m_queue.addPlayer(guid, player.queueType, player.queueLevelGroup, player.team, player.queueInstanceId);
+            }
+
+            void leave(const SimWorld& /*world*/, uint32_t guid)
+            {
+                m_queue.removePlayer(guid);
+            }
+
+            void update(SimWorld& world)
+            {
+                for (uint32_t i = 0; i < TYPE_COUNT; ++i)
+                {
+                    for (uint32_t j = 0; j < levelGroupCount; ++j)
+                    {
+                        if (!world.queueChanged[i][j])
+                            continue;
+
+                        world.queueChanged[i][j] = false;
+                        updateQueue(world, i, j);
+                    }
+                }
+            }
+
+        private:
+
+            void updateQueue(SimWorld& world, uint32_t i, uint32_t j)
+            {
+                std::deque<uint32_t> tempPlayerVec[2];
+
+                const BattlegroundQueue::GuidList requested = m_queue.getInstancePlayers(i, j);
+                for (BattlegroundQueue::GuidList::const_iterator itr = requested.begin(); itr != requested.end(); ++itr)
+                {
+                    const SimPlayer& player = world.players[*itr];
+                    if (player.levelGroup != j)
+                    {
+                        m_queue.removePlayer(*itr);
+                        continue;
+                    }
+
+                    const SimInstance& instance = world.instances[i].find(player.queueInstanceId)->second;
+                    if (world.canPlayerJoin(instance, player))
+                    {
+                        world.addPlayer(i, player.queueInstanceId, *itr, player.team);
+                        m_queue.removePlayer(*itr);
+                    }
+                }
+
+                for (uint32_t k = 0; k < 2; ++k)
+                {
+                    const BattlegroundQueue::GuidList waiting = m_queue.getPlayers(i, j, k);
+                    for (BattlegroundQueue::GuidList::const_iterator itr = waiting.begin(); itr != waiting.end(); ++itr)
+                    {
+                        const SimPlayer& player = world.players[*itr];
+                        if (player.levelGroup != j)
+                        {
+                            m_queue.removePlayer(*itr);
+                            continue;
+                        }
+
+                        if (!player.deserter)
+                            tempPlayerVec[k].push_back(*itr);
+                    }
+                }
+
+                fillAndStart(world, i, j, tempPlayerVec, [this](uint32_t guid) { m_queue.removePlayer(guid); });
+            }
+
+            BattlegroundQueue m_queue;
+    };
+
+    template <class Matcher>
+    struct Simulation
+    {
+        explicit Simulation(uint32_t seed) : world(seed), updateTime(0) {}
+
+        void join(uint32_t guid, uint32_t type, uint32_t instanceId)
+        {
+            SimPlayer& player = world.players[guid];
+            player.queued = true;
+            player.queueType = type;
+            player.queueLevelGroup = player.levelGroup;
+            player.queueInstanceId = instanceId;
+
+            matcher.join(world, guid);
+            world.queueChanged[type][player.levelGroup] = true;
+        }
+
+        void leaveQueue(uint32_t guid)
+        {
+            matcher.leave(world, guid);
+            world.players[guid].queued = false;
+        }
+
+        void leaveInstance(uint32_t guid, bool deserter)
+        {
+            world.removePlayer(guid);
+            world.players[guid].deserter = deserter;
+        }
+
+        // Aura::Remove of BG_DESERTER, OnQueuedPlayerChanged
+        void deserterExpired(uint32_t guid)
+        {
+            SimPlayer& player = world.players[guid];
+            player.deserter = false;
+            if (player.queued)
+                world.queueChanged[player.queueType][player.levelGroup] = true;
+        }
+
+        // the players leave and DeleteBattleground takes the players queued for it out of the queue
+        void closeInstance(uint32_t type, uint32_t instanceId)
+        {
+            for (uint32_t guid = 0; guid < playerCount; ++guid)
+            {
+                SimPlayer& player = world.players[guid];
+                if (player.instanceId == instanceId)
+                    world.removePlayer(guid);
+
+                if (player.queued && player.queueInstanceId == instanceId)
+                    leaveQueue(guid);
+            }
+
+            world.instances[type].erase(instanceId);
+        }
+
+        void update()
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            matcher.update(world);
+            updateTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        SimWorld world;
+        Matcher matcher;
+        double updateTime;
+    };
+
+    bool sameWorld(const SimWorld& oldWorld, const SimWorld& newWorld)
+    {
+        for (uint32_t guid = 0; guid < playerCount; ++guid)
+        {
+            const SimPlayer& oldPlayer = oldWorld.players[guid];
+            const SimPlayer& newPlayer = newWorld.players[guid];
+            if (oldPlayer.queued != newPlayer.queued || oldPlayer.instanceId != newPlayer.instanceId)
+                return false;
+        }
+
+        for (uint32_t type = 0; type < TYPE_COUNT; ++type)
+        {
+            if (oldWorld.instances[type].size() != newWorld.instances[type].size())
+                return false;
+
+            for (std::map<uint32_t, SimInstance>::const_iterator itr = oldWorld.instances[type].begin(); itr != oldWorld.instances[type].end(); ++itr)
+            {
+                std::map<uint32_t, SimInstance>::const_iterator other = newWorld.instances[type].find(itr->first);
+                if (other == newWorld.instances[type].end() || other->second.size[0] != itr->second.size[0] || other->second.size[1] != itr->second.size[1])
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // 10k joins with players leaving queues and instances, deserters and instances closing,
+    // one queue update after every few events. The flagged buckets have to place every
+    // player in the same instance at the same update as the walk over every queue.
+    void testAgainstFullScan(uint32_t& state)
+    {
+        Simulation<FullScanMatcher> oldSim(0x1234567);
+        Simulation<BucketMatcher> newSim(0x1234567);
+
+        uint32_t joins = 0;
+        uint32_t requestedJoins = 0;
+        uint32_t updates = 0;
+        uint32_t placed = 0;
+        bool same = true;
+
+        while (joins < 10000 && same)
+        {
+            const uint32_t events = nextRandom(state) % 2;
+            for (uint32_t e = 0; e < events; ++e)
+            {
+                const uint32_t guid = nextRandom(state) % playerCount;
+                const SimPlayer& player = oldSim.world.players[guid];
+                const uint32_t roll = nextRandom(state) % 100;
+
+                if (roll < 45)
+                {
+                    if (player.queued || player.instanceId != 0 || joins == 10000)
+                        continue;
+
+                    const uint32_t type = nextRandom(state) % TYPE_COUNT;
+                    uint32_t instanceId = 0;
+
+                    // 5% ask for an instance of the battleground list
+                    const std::map<uint32_t, SimInstance>& instances = oldSim.world.instances[type];
+                    if (nextRandom(state) % 20 == 0 && !instances.empty())
+                    {
+                        std::map<uint32_t, SimInstance>::const_iterator itr = instances.begin();
+                        std::advance(itr, nextRandom(state) % instances.size());
+                        instanceId = itr->first;
+                        ++requestedJoins;
+                    }
+
+                    oldSim.join(guid, type, instanceId);
+                    newSim.join(guid, type, instanceId);
+                    ++joins;
+                }
+                else if (roll < 55)
+                {
+                    if (!player.queued)
+                        continue;
+
+                    oldSim.leaveQueue(guid);
+                    newSim.leaveQueue(guid);
+                }
+                else if (roll < 85)
+                {
+                    if (player.instanceId == 0)
+                        continue;
+
+                    const bool deserter = nextRandom(state) % 2 == 0;
+                    oldSim.leaveInstance(guid, deserter);
+                    newSim.leaveInstance(guid, deserter);
+                }
+                else if (roll < 93)
+                {
+                    if (!player.deserter)
+                        continue;
+
+                    oldSim.deserterExpired(guid);
+                    newSim.deserterExpired(guid);
+                }
+                else if (roll < 96)
+                {
+                    // levelling doesn't flag the queue, the player is dropped when it is matched
+                    if (player.levelGroup + 1 >= levelGroupCount)
+                        continue;
+
+                    ++oldSim.world.players[guid].levelGroup;
+                    ++newSim.world.players[guid].levelGroup;
+                }
+                else
+                {
+                    const uint32_t type = nextRandom(state) % TYPE_RANDOM;
+                    const std::map<uint32_t, SimInstance>& instances = oldSim.world.instances[type];
+                    if (instances.empty())
+                        continue;
+
+                    std::map<uint32_t, SimInstance>::const_iterator itr = instances.begin();
+                    std::advance(itr, nextRandom(state) % instances.size());
+                    const uint32_t instanceId = itr->first;
+
+                    oldSim.closeInstance(type, instanceId);
+                    newSim.closeInstance(type, instanceId);
+                }
+            }
+
+            oldSim.update();
+            newSim.update();
+            ++updates;
+
+            same = sameWorld(oldSim.world, newSim.world);
+            TEST_CHECK(same);
+        }
+
+        for (uint32_t guid = 0; guid < playerCount; ++guid)
+        {
+            if (oldSim.world.players[guid].instanceId != 0)
+                ++placed;
+        }
+
+        TEST_CHECK(joins == 10000);
+        TEST_CHECK(requestedJoins > 0);
+        TEST_CHECK(oldSim.world.nextInstanceId > 100);
+
+        std::printf("BattlegroundQueueTest : %u joins (%u for an instance), %u updates, %u instances started, %u players in instances\n",
+            joins, requestedJoins, updates, oldSim.world.nextInstanceId - 1, placed);
+        std::printf("BattlegroundQueueTest : queue updates took %.0f us with the full scan, %.0f us with the flagged buckets\n",
+            oldSim.updateTime, newSim.updateTime);
+    }
+
+    // the first count players of team in levelGroup who are neither queued nor in an instance
+    std::vector<uint32_t> getIdlePlayers(const SimWorld& world, uint32_t team, uint32_t levelGroup, uint32_t count)
+    {
+        std::vector<uint32_t> guids;
+        for (uint32_t guid = 0; guid < playerCount && guids.size() < count; ++guid)
+        {
+            const SimPlayer& player = world.players[guid];
+            if (player.team == team && player.levelGroup == levelGroup && !player.queued && player.instanceId == 0)
+                guids.push_back(guid);
+        }
+
+        return guids;
+    }
+
+    // a horde player queued for an instance with one horde player more waits for the alliance
+    // player queued after it, and joins on the next update
+    void testRequestedJoinOrder()
+    {
+        Simulation<FullScanMatcher> oldSim(0x7654321);
+        Simulation<BucketMatcher> newSim(0x7654321);
+
+        const std::vector<uint32_t> alliance = getIdlePlayers(oldSim.world, 0, 0, 6);
+        const std::vector<uint32_t> horde = getIdlePlayers(oldSim.world, 1, 0, 7);
+        TEST_CHECK(alliance.size() == 6 && horde.size() == 7);
+        if (alliance.size() != 6 || horde.size() != 7)
+            return;
+
+        auto both = [&](auto func)
+        {
+            func(oldSim);
+            func(newSim);
+        };
+
+        uint32_t instanceId = 0;
+        both([&](auto& sim)
+        {
+            instanceId = sim.world.createInstance(TYPE_ARATHI_BASIN, 0);
+            for (uint32_t k = 0; k < 5; ++k)
+                sim.world.addPlayer(TYPE_ARATHI_BASIN, instanceId, alliance[k], 0);
+            for (uint32_t k = 0; k < 6; ++k)
+                sim.world.addPlayer(TYPE_ARATHI_BASIN, instanceId, horde[k], 1);
+            sim.update();
+        });
+
+        both([&](auto& sim)
+        {
+            sim.join(horde[6], TYPE_ARATHI_BASIN, instanceId);
+            sim.join(alliance[5], TYPE_ARATHI_BASIN, instanceId);
+            sim.update();
+        });
+
+        TEST_CHECK(sameWorld(oldSim.world, newSim.world));
+        TEST_CHECK(newSim.world.players[alliance[5]].instanceId == instanceId);
+        TEST_CHECK(newSim.world.players[horde[6]].queued);
+
+        both([](auto& sim) { sim.update(); });
+
+        TEST_CHECK(sameWorld(oldSim.world, newSim.world));
+        TEST_CHECK(newSim.world.players[horde[6]].instanceId == instanceId);
+    }
+
+    // a queue one player short because of a deserter starts when the debuff expires
+    void testDeserterExpired()
+    {
+        Simulation<FullScanMatcher> oldSim(0x7654321);
+        Simulation<BucketMatcher> newSim(0x7654321);
+
+        const uint32_t count = minPlayers[TYPE_WARSONG_GULCH];
+        const std::vector<uint32_t> alliance = getIdlePlayers(oldSim.world, 0, 0, count);
+        const std::vector<uint32_t> horde = getIdlePlayers(oldSim.world, 1, 0, count);
+        TEST_CHECK(alliance.size() == count && horde.size() == count);
+        if (alliance.size() != count || horde.size() != count)
+            return;
+
+        auto both = [&](auto func)
+        {
+            func(oldSim);
+            func(newSim);
+        };
+
+        both([&](auto& sim)
+        {
+            sim.world.players[alliance[0]].deserter = true;
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                sim.join(alliance[k], TYPE_WARSONG_GULCH, 0);
+                sim.join(horde[k], TYPE_WARSONG_GULCH, 0);
+            }
+
+            sim.update();
+            sim.update();
+        });
+
+        TEST_CHECK(sameWorld(oldSim.world, newSim.world));
+        TEST_CHECK(newSim.world.instances[TYPE_WARSONG_GULCH].empty());
+
+        both([&](auto& sim)
+        {
+            sim.deserterExpired(alliance[0]);
+            sim.update();
+        });
+
+        TEST_CHECK(sameWorld(oldSim.world, newSim.world));
+        TEST_CHECK(newSim.world.players[alliance[0]].instanceId != 0);
+    }
+
+    // the opponent is the closest rated group of another arena team, like a search over every group
+    void testRatedOpponent(uint32_t& state)
+    {
+        BattlegroundQueue queue;
+        std::vector<BattlegroundQueue::RatedGroup> groups;
+
+        for (uint32_t groupId = 1; groupId <= 500; ++groupId)
+        {
+            BattlegroundQueue::RatedGroup group;
+            group.groupId = groupId;
+            group.type = 0;
+            group.arenaTeamId = nextRandom(state) % 200;
+            group.rating = 1200 + nextRandom(state) % 600;
+            group.joinTime = 0;
+
+            queue.addRatedGroup(group);
+            groups.push_back(group);
+        }
+
+        for (uint32_t round = 0; round < 2000; ++round)
+        {
+            const BattlegroundQueue::RatedGroup& group = groups[nextRandom(state) % groups.size()];
+            if (queue.getRatedGroup(group.groupId) == nullptr)
+                continue;
+
+            const uint32_t maxDiff = nextRandom(state) % 50;
+
+            uint32_t bestDiff = maxDiff + 1;
+            for (std::vector<BattlegroundQueue::RatedGroup>::const_iterator itr = groups.begin(); itr != groups.end(); ++itr)
+            {
+                if (queue.getRatedGroup(itr->groupId) == nullptr || itr->arenaTeamId == group.arenaTeamId)
+                    continue;
+
+                const uint32_t diff = itr->rating > group.rating ? itr->rating - group.rating : group.rating - itr->rating;
+                bestDiff = std::min(bestDiff, diff);
+            }
+
+            const uint32_t opponentId = queue.findRatedOpponent(group.groupId, maxDiff);
+            if (bestDiff > maxDiff)
+            {
+                TEST_CHECK(opponentId == 0);
+                continue;
+            }
+
+            TEST_CHECK(opponentId != 0);
+            const BattlegroundQueue::RatedGroup* opponent = queue.getRatedGroup(opponentId);
+            TEST_CHECK(opponent != nullptr);
+            if (opponent == nullptr)
+                continue;
+
+            TEST_CHECK(opponent->arenaTeamId != group.arenaTeamId);
+            TEST_CHECK((opponent->rating > group.rating ? opponent->rating - group.rating : group.rating - opponent->rating) == bestDiff);
+
+            // matched groups leave the queue
+            if (round % 3 == 0)
+            {
+                queue.removeRatedGroup(group.groupId);
+                queue.removeRatedGroup(opponentId);
+            }
+        }
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x2545F491;
+
+    testAgainstFullScan(state);
+    testRequestedJoinOrder();
+    testDeserterExpired();
+    testRatedOpponent(state);
+
+    std::printf("BattlegroundQueueTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
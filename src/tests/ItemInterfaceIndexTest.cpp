@@ -0,0 +1,416 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Management/ItemInterfaceIndex.h"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    const uint32_t entryCount = 12;
+    const uint32_t bagSize = 16;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    /// Item reduced to what the index reads
+    class ModelItem
+    {
+        public:
+
+            ModelItem(uint32_t entry, ItemProperties const* proto) : wrapped_item_id(0), m_entry(entry), m_stackCount(1), m_proto(proto) {}
+            virtual ~ModelItem() {}
+
+            uint32_t GetEntry() const { return m_entry; }
+            uint32_t GetStackCount() const { return m_stackCount; }
+            void SetStackCount(uint32_t count) { m_stackCount = count; }
+            ItemProperties const* GetItemProperties() const { return m_proto; }
+            virtual bool IsContainer() const { return false; }
+
+            uint32_t wrapped_item_id;
+
+        private:
+
+            uint32_t m_entry;
+            uint32_t m_stackCount;
+            ItemProperties const* m_proto;
+    };
+
+    class ModelContainer : public ModelItem
+    {
+        public:
+
+            ModelContainer(uint32_t entry, ItemProperties const* proto) : ModelItem(entry, proto), m_items(proto->ContainerSlots, nullptr) {}
+
+            bool IsContainer() const override { return true; }
+
+            ModelItem* GetItem(int16_t slot) const { return m_items[slot]; }
+            void SetItem(int16_t slot, ModelItem* item) { m_items[slot] = item; }
+
+        private:
+
+            std::vector<ModelItem*> m_items;
+    };
+
+    class ModelInventory;
+    typedef BasicItemInterfaceIndex<ModelInventory, ModelItem, ModelContainer> ModelItemIndex;
+
+    /// ItemInterface reduced to its slots and the upkeep of the index
+    class ModelInventory
+    {
+        public:
+
+            explicit ModelInventory(bool updateIndex) : m_updateIndex(updateIndex)
+            {
+                for (int16_t slot = 0; slot < MAX_INVENTORY_SLOT; ++slot)
+                    m_slots[slot] = nullptr;
+            }
+
+            ModelItem* GetInventoryItem(int16_t slot) const { return slot >= 0 && slot < MAX_INVENTORY_SLOT ? m_slots[slot] : nullptr; }
+
+            bool IsBagSlot(int16_t slot) const
+            {
+                return (slot >= INVENTORY_SLOT_BAG_START && slot < INVENTORY_SLOT_BAG_END) || (slot >= BANK_SLOT_BAG_START && slot < BANK_SLOT_BAG_END);
+            }
+
+            ModelItem* getItem(int8_t containerSlot, int16_t slot) const
+            {
+                if (containerSlot == ITEM_NO_SLOT_AVAILABLE)
+                    return m_slots[slot];
+
+                return static_cast<ModelContainer*>(m_slots[containerSlot])->GetItem(slot);
+            }
+
+            /// SafeAddItem and SafeRemoveAndRetreiveItemFromSlot
+            void setItem(int8_t containerSlot, int16_t slot, ModelItem* item)
+            {
+                if (containerSlot == ITEM_NO_SLOT_AVAILABLE)
+                    m_slots[slot] = item;
+                else
+                    static_cast<ModelContainer*>(m_slots[containerSlot])->SetItem(slot, item);
+
+                if (m_updateIndex)
+                    m_index.updateSlot(this, containerSlot, slot);
+                else
+                    m_index.invalidate();
+            }
+
+            /// Item::SetStackCount
+            void setStackCount(ModelItem* item, uint32_t count)
+            {
+                item->SetStackCount(count);
+
+                if (m_updateIndex)
+                    m_index.updateStackCount(item);
+                else
+                    m_index.invalidate();
+            }
+
+            /// gift wrapping changes the entry, the index is thrown away
+            void wrap(ModelItem* item)
+            {
+                item->wrapped_item_id = 1;
+                m_index.invalidate();
+            }
+
+            /// ItemInterface::_getItemIndex
+            const ModelItemIndex& getIndex()
+            {
+                if (!m_index.isValid())
+                    m_index.rebuild(this);
+
+                return m_index;
+            }
+
+            /// FindItemLessMax
+            ModelItem* findItemLessMax(uint32_t entry, uint32_t maxStack)
+            {
+                const ModelItemIndex::ItemList* items = getIndex().getItems(entry);
+                if (items == nullptr)
+                    return nullptr;
+
+                for (ModelItemIndex::ItemList::const_iterator itr = items->begin(); itr != items->end(); ++itr)
+                {
+                    if (!itr->inBank && itr->item->wrapped_item_id == 0 && itr->item->GetStackCount() < maxStack)
+                        return itr->item;
+                }
+
+                return nullptr;
+            }
+
+        private:
+
+            ModelItem* m_slots[MAX_INVENTORY_SLOT];
+            ModelItemIndex m_index;
+            bool m_updateIndex;
+    };
+
+    // GetItemCount before the index: every slot of the inventory and the bank walked
+    uint32_t countByWalk(const ModelInventory& inventory, uint32_t entry, bool includeBank)
+    {
+        uint32_t count = 0;
+        auto add = [&count, entry](ModelItem* item)
+        {
+            if (item != nullptr && item->GetEntry() == entry && item->wrapped_item_id == 0)
+                count += item->GetStackCount() ? item->GetStackCount() : 1;
+        };
+
+        auto addSlots = [&](int16_t start, int16_t end)
+        {
+            for (int16_t slot = start; slot < end; ++slot)
+                add(inventory.GetInventoryItem(slot));
+        };
+
+        auto addBags = [&](int16_t start, int16_t end)
+        {
+            for (int16_t bagSlot = start; bagSlot < end; ++bagSlot)
+            {
+                ModelItem* bag = inventory.GetInventoryItem(bagSlot);
+                if (bag == nullptr || !bag->IsContainer())
+                    continue;
+
+                for (uint32_t slot = 0; slot < bag->GetItemProperties()->ContainerSlots; ++slot)
+                    add(static_cast<ModelContainer*>(bag)->GetItem(static_cast<int16_t>(slot)));
+            }
+        };
+
+        addSlots(EQUIPMENT_SLOT_START, INVENTORY_SLOT_ITEM_END);
+        addBags(INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END);
+        addSlots(INVENTORY_KEYRING_START, INVENTORY_KEYRING_END);
+        addSlots(CURRENCYTOKEN_SLOT_START, CURRENCYTOKEN_SLOT_END);
+
+        if (includeBank)
+        {
+            addSlots(BANK_SLOT_ITEM_START, BANK_SLOT_BAG_END);
+            addBags(BANK_SLOT_BAG_START, BANK_SLOT_BAG_END);
+        }
+
+        return count;
+    }
+
+    int16_t findFreeBackpackSlotByWalk(const ModelInventory& inventory)
+    {
+        for (int16_t slot = INVENTORY_SLOT_ITEM_START; slot < INVENTORY_SLOT_ITEM_END; ++slot)
+        {
+            if (inventory.GetInventoryItem(slot) == nullptr)
+                return slot;
+        }
+
+        return ITEM_NO_SLOT_AVAILABLE;
+    }
+
+    struct SlotRange
+    {
+        int16_t start;
+        int16_t end;
+    };
+
+    // player slots which hold items, the bag slots are handled separately
+    const SlotRange itemRanges[] =
+    {
+        { EQUIPMENT_SLOT_START, EQUIPMENT_SLOT_END },
+        { INVENTORY_SLOT_ITEM_START, INVENTORY_SLOT_ITEM_END },
+        { INVENTORY_KEYRING_START, INVENTORY_KEYRING_END },
+        { CURRENCYTOKEN_SLOT_START, CURRENCYTOKEN_SLOT_END },
+        { BANK_SLOT_ITEM_START, BANK_SLOT_ITEM_END }
+    };
+    const uint32_t itemRangeCount = sizeof(itemRanges) / sizeof(itemRanges[0]);
+
+    // items are looted, moved, stacked, split, wrapped and put into bags which come and go,
+    // the updated index stays the same as one built from scratch and counts what the walk counts
+    void testAgainstRebuild(uint32_t& state)
+    {
+        ItemProperties itemProto = ItemProperties();
+        ItemProperties bagProto = ItemProperties();
+        bagProto.ContainerSlots = bagSize;
+
+        std::vector<ModelItem*> owned;
+        ModelInventory inventory(true);
+        ModelItemIndex reference;
+
+        for (uint32_t step = 0; step < 20000; ++step)
+        {
+            const uint32_t action = nextRandom(state) % 10;
+
+            // a slot of the player or of one of the bags
+            int8_t containerSlot = ITEM_NO_SLOT_AVAILABLE;
+            int16_t slot;
+            if (nextRandom(state) % 2 == 0)
+            {
+                const SlotRange& range = itemRanges[nextRandom(state) % itemRangeCount];
+                slot = static_cast<int16_t>(range.start + nextRandom(state) % (range.end - range.start));
+            }
+            else
+            {
+                const bool bank = nextRandom(state) % 3 == 0;
+                containerSlot = static_cast<int8_t>(bank ? BANK_SLOT_BAG_START + nextRandom(state) % (BANK_SLOT_BAG_END - BANK_SLOT_BAG_START)
+                    : INVENTORY_SLOT_BAG_START + nextRandom(state) % (INVENTORY_SLOT_BAG_END - INVENTORY_SLOT_BAG_START));
+                slot = static_cast<int16_t>(nextRandom(state) % bagSize);
+
+                ModelItem* bag = inventory.GetInventoryItem(containerSlot);
+                if (bag == nullptr)
+                {
+                    // equip an empty bag or take the one there away with everything in it
+                    if (action < 5)
+                    {
+                        owned.push_back(new ModelContainer(100, &bagProto));
+                        inventory.setItem(ITEM_NO_SLOT_AVAILABLE, containerSlot, owned.back());
+                    }
+
+                    continue;
+                }
+
+                if (action == 9)
+                {
+                    inventory.setItem(ITEM_NO_SLOT_AVAILABLE, containerSlot, nullptr);
+                    continue;
+                }
+            }
+
+            ModelItem* item = inventory.getItem(containerSlot, slot);
+            if (item == nullptr)
+            {
+                if (action < 6)
+                {
+                    owned.push_back(new ModelItem(1 + nextRandom(state) % entryCount, &itemProto));
+                    owned.back()->SetStackCount(nextRandom(state) % 20);
+                    inventory.setItem(containerSlot, slot, owned.back());
+                }
+            }
+            else if (action < 4)
+            {
+                inventory.setItem(containerSlot, slot, nullptr);
+            }
+            else if (action < 8)
+            {
+                inventory.setStackCount(item, 1 + nextRandom(state) % 20);
+            }
+            else if (action == 8 && nextRandom(state) % 10 == 0)
+            {
+                inventory.wrap(item);
+            }
+
+            const ModelItemIndex& index = inventory.getIndex();
+            reference.rebuild(&inventory);
+            TEST_CHECK(index.isSameAs(reference));
+
+            const uint32_t entry = 1 + nextRandom(state) % entryCount;
+            TEST_CHECK(index.getItemCount(entry, false) == countByWalk(inventory, entry, false));
+            TEST_CHECK(index.getItemCount(entry, true) == countByWalk(inventory, entry, true));
+            TEST_CHECK(index.getFreeBackpackSlot() == findFreeBackpackSlotByWalk(inventory));
+        }
+
+        for (std::vector<ModelItem*>::iterator itr = owned.begin(); itr != owned.end(); ++itr)
+            delete *itr;
+    }
+
+    // a looted item taken out and put into the first free slot, a stack merged into and split
+    // from again, each followed by the item count of a quest objective. The reference throws
+    // the index away on every change like before it was updated in place.
+    void benchmarkLootAndStack()
+    {
+        const uint32_t clothEntry = 2589;
+        const uint32_t lootEntry = 2592;
+        const uint32_t stackCount = 10;
+        const uint32_t iterations = 20000;
+
+        ItemProperties itemProto = ItemProperties();
+        ItemProperties bagProto = ItemProperties();
+        bagProto.ContainerSlots = bagSize;
+
+        typedef std::chrono::steady_clock Clock;
+
+        double times[2];
+        uint64_t checksums[2];
+        for (uint32_t run = 0; run < 2; ++run)
+        {
+            ModelInventory inventory(run == 1);
+            std::vector<ModelItem*> owned;
+
+            // an equipped player with full bags and bank, the cloth in the backpack
+            for (int16_t slot = EQUIPMENT_SLOT_START; slot < EQUIPMENT_SLOT_END; ++slot)
+            {
+                owned.push_back(new ModelItem(30000 + slot, &itemProto));
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, slot, owned.back());
+            }
+
+            const int16_t bagSlots[] = { INVENTORY_SLOT_BAG_1, INVENTORY_SLOT_BAG_2, INVENTORY_SLOT_BAG_3, INVENTORY_SLOT_BAG_4,
+                BANK_SLOT_BAG_START, BANK_SLOT_BAG_START + 1, BANK_SLOT_BAG_START + 2 };
+            for (int16_t bagSlot : bagSlots)
+            {
+                owned.push_back(new ModelContainer(100, &bagProto));
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, bagSlot, owned.back());
+
+                for (int16_t slot = 0; slot < static_cast<int16_t>(bagSize); ++slot)
+                {
+                    owned.push_back(new ModelItem(20000 + bagSlot * bagSize + slot, &itemProto));
+                    inventory.setItem(static_cast<int8_t>(bagSlot), slot, owned.back());
+                }
+            }
+
+            for (int16_t slot = BANK_SLOT_ITEM_START; slot < BANK_SLOT_ITEM_END; ++slot)
+            {
+                owned.push_back(new ModelItem(40000 + slot, &itemProto));
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, slot, owned.back());
+            }
+
+            for (uint32_t i = 0; i <= stackCount; ++i)
+            {
+                owned.push_back(new ModelItem(i < stackCount ? clothEntry : lootEntry, &itemProto));
+                owned.back()->SetStackCount(i < stackCount ? 10 : 1);
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, static_cast<int16_t>(INVENTORY_SLOT_ITEM_START + i), owned.back());
+            }
+
+            int16_t lootSlot = static_cast<int16_t>(INVENTORY_SLOT_ITEM_START + stackCount);
+            checksums[run] = 0;
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                ModelItem* loot = inventory.GetInventoryItem(lootSlot);
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, lootSlot, nullptr);
+
+                lootSlot = inventory.getIndex().getFreeBackpackSlot();
+                inventory.setItem(ITEM_NO_SLOT_AVAILABLE, lootSlot, loot);
+                checksums[run] += inventory.getIndex().getItemCount(lootEntry, false);
+
+                ModelItem* stack = inventory.findItemLessMax(clothEntry, 20);
+                inventory.setStackCount(stack, stack->GetStackCount() + 1);
+                checksums[run] += inventory.getIndex().getItemCount(clothEntry, false);
+
+                inventory.setStackCount(stack, stack->GetStackCount() - 1);
+                checksums[run] += inventory.getIndex().getItemCount(clothEntry, false) + lootSlot;
+            }
+            times[run] = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+
+            for (std::vector<ModelItem*>::iterator itr = owned.begin(); itr != owned.end(); ++itr)
+                delete *itr;
+        }
+
+        TEST_CHECK(checksums[0] == checksums[1]);
+
+        std::printf("ItemInterfaceIndexTest : loot, stack and count: rebuilt index %.1f ns, updated index %.1f ns\n", times[0], times[1]);
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x85EBCA6B;
+
+    testAgainstRebuild(state);
+    benchmarkLootAndStack();
+
+    std::printf("ItemInterfaceIndexTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
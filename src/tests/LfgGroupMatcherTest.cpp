@@ -0,0 +1,640 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Management/LFG/LFGGroupMatcher.h"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const uint64_t firstGuid = 0xFF000000;
+    const uint32_t firstDungeon = 0xFFFF00;
+    const uint32_t dungeonCount = 8;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    std::string concatenateGuids(const LfgGuidList& guids)
+    {
+        if (guids.empty())
+            return "";
+
+        std::ostringstream o;
+        LfgGuidList::const_iterator it = guids.begin();
+        o << (*it);
+        for (++it; it != guids.end(); ++it)
+            o << '|' << (*it);
+        return o.str();
+    }
+
+    // the role check of the recursive search, exact for up to five players
+    bool checkGroupRoles(LfgRolesMap& groles, bool removeLeaderFlag = true)
+    {
+        if (groles.empty())
+            return false;
+
+        uint8_t damage = 0;
+        uint8_t tank = 0;
+        uint8_t healer = 0;
+
+        if (removeLeaderFlag)
+            for (LfgRolesMap::iterator it = groles.begin(); it != groles.end(); ++it)
+                it->second &= ~ROLE_LEADER;
+
+        for (LfgRolesMap::iterator it = groles.begin(); it != groles.end(); ++it)
+        {
+            if (it->second == ROLE_NONE)
+                return false;
+
+            if (it->second & ROLE_TANK)
+            {
+                if (it->second != ROLE_TANK)
+                {
+                    it->second -= ROLE_TANK;
+                    if (checkGroupRoles(groles, false))
+                        return true;
+                    it->second += ROLE_TANK;
+                }
+                else if (tank == LFG_TANKS_NEEDED)
+                    return false;
+                else
+                    tank++;
+            }
+
+            if (it->second & ROLE_HEALER)
+            {
+                if (it->second != ROLE_HEALER)
+                {
+                    it->second -= ROLE_HEALER;
+                    if (checkGroupRoles(groles, false))
+                        return true;
+                    it->second += ROLE_HEALER;
+                }
+                else if (healer == LFG_HEALERS_NEEDED)
+                    return false;
+                else
+                    healer++;
+            }
+
+            if (it->second & ROLE_DAMAGE)
+            {
+                if (it->second != ROLE_DAMAGE)
+                {
+                    it->second -= ROLE_DAMAGE;
+                    if (checkGroupRoles(groles, false))
+                        return true;
+                    it->second += ROLE_DAMAGE;
+                }
+                else if (damage == LFG_DPS_NEEDED)
+                    return false;
+                else
+                    damage++;
+            }
+        }
+        return (tank + healer + damage) == uint8_t(groles.size());
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The group search LfgMgr did before the role state masks, without the proposal: a
+    /// recursive FindNewGroups with its compatibility cache keyed by the joined guid strings.
+    /// The lfg states are replaced by the set of queued guids.
+    ///
+    /// With queued groups the all-but-new check of six players can set matched for its five,
+    /// the search then returns a group of less than five. It is compared on players only.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class ReferenceSearch
+    {
+        public:
+
+            ReferenceSearch(const LfgQueueInfoMap& queueInfos, const std::set<uint64_t>& queued) : m_queueInfos(queueInfos), m_queued(queued)
+            {
+            }
+
+            bool findNewGroups(LfgGuidList& check, LfgGuidList& all, bool& matched)
+            {
+                if (check.empty() || check.size() > 5 || !checkCompatibility(check, matched))
+                    return false;
+
+                // Try to match with queued groups
+                while (!matched && !all.empty())
+                {
+                    check.push_back(all.front());
+                    all.pop_front();
+                    if (findNewGroups(check, all, matched))
+                        return true;
+                    check.pop_back();
+                }
+                return matched;
+            }
+
+            void removeFromCompatibles(uint64_t guid)
+            {
+                std::stringstream out;
+                out << guid;
+                std::string strGuid = out.str();
+
+                for (std::map<std::string, LfgAnswer>::iterator itNext = m_compatibles.begin(); itNext != m_compatibles.end();)
+                {
+                    std::map<std::string, LfgAnswer>::iterator it = itNext++;
+                    if (it->first.find(strGuid) != std::string::npos)  // Found, remove it
+                        m_compatibles.erase(it);
+                }
+            }
+
+        private:
+
+            bool checkCompatibility(LfgGuidList check, bool& matched)
+            {
+                if (matched)
+                    return false;
+
+                std::string strGuids = concatenateGuids(check);
+
+                if (check.size() > 5 || check.empty())
+                    return false;
+
+                // Player joining dungeon... compatible
+                if (check.size() == 1)
+                {
+                    LfgQueueInfoMap::const_iterator itQueue = m_queueInfos.find(check.front());
+                    if (itQueue != m_queueInfos.end() && itQueue->second->roles.size() == 1)
+                        return true;
+                }
+
+                // Previously cached?
+                std::map<std::string, LfgAnswer>::const_iterator itCached = m_compatibles.find(strGuids);
+                if (itCached != m_compatibles.end())
+                    return itCached->second == LFG_ANSWER_AGREE;
+
+                // Check all but new compatiblitity
+                if (check.size() > 2)
+                {
+                    uint64_t frontGuid = check.front();
+                    check.pop_front();
+
+                    // Check all-but-new compatibilities (New, A, B, C, D) --> check(A, B, C, D)
+                    if (!checkCompatibility(check, matched))
+                    {
+                        m_compatibles[strGuids] = LFG_ANSWER_DENY;
+                        return false;
+                    }
+                    check.push_front(frontGuid);
+                }
+
+                uint8_t numPlayers = 0;
+                LfgQueueInfoMap pqInfoMap;
+                for (LfgGuidList::const_iterator it = check.begin(); it != check.end() && numPlayers <= 5; ++it)
+                {
+                    LfgQueueInfoMap::const_iterator itQueue = m_queueInfos.find(*it);
+                    if (itQueue == m_queueInfos.end() || m_queued.find(*it) == m_queued.end())
+                        return false;
+
+                    pqInfoMap[*it] = itQueue->second;
+                    numPlayers += static_cast<uint8_t>(itQueue->second->roles.size());
+                }
+
+                if (numPlayers > 5)
+                {
+                    m_compatibles[strGuids] = LFG_ANSWER_DENY;
+                    return false;
+                }
+
+                LfgRolesMap rolesMap;
+                for (LfgQueueInfoMap::const_iterator it = pqInfoMap.begin(); it != pqInfoMap.end(); ++it)
+                    for (LfgRolesMap::const_iterator itRoles = it->second->roles.begin(); itRoles != it->second->roles.end(); ++itRoles)
+                        rolesMap[itRoles->first] = itRoles->second;
+
+                if (rolesMap.size() != numPlayers)                     // Player in multiples queues!
+                    return false;
+
+                if (!checkGroupRoles(rolesMap))
+                {
+                    m_compatibles[strGuids] = LFG_ANSWER_DENY;
+                    return false;
+                }
+
+                // Check if there are any compatible dungeon from the selected dungeons
+                LfgDungeonSet compatibleDungeons;
+                LfgQueueInfoMap::const_iterator itFirst = pqInfoMap.begin();
+                for (LfgDungeonSet::const_iterator itDungeon = itFirst->second->dungeons.begin(); itDungeon != itFirst->second->dungeons.end(); ++itDungeon)
+                {
+                    LfgQueueInfoMap::const_iterator itOther = itFirst;
+                    ++itOther;
+                    while (itOther != pqInfoMap.end() && itOther->second->dungeons.find(*itDungeon) != itOther->second->dungeons.end())
+                        ++itOther;
+
+                    if (itOther == pqInfoMap.end())
+                        compatibleDungeons.insert(*itDungeon);
+                }
+
+                if (compatibleDungeons.empty())
+                {
+                    m_compatibles[strGuids] = LFG_ANSWER_DENY;
+                    return false;
+                }
+                m_compatibles[strGuids] = LFG_ANSWER_AGREE;
+
+                if (numPlayers != 5)
+                    return true;
+
+                matched = true;
+                return true;
+            }
+
+            const LfgQueueInfoMap& m_queueInfos;
+            const std::set<uint64_t>& m_queued;
+            std::map<std::string, LfgAnswer> m_compatibles;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The queue of the LfgMgr: the queue infos, the queued guids oldest first and the
+    /// matcher. The lock checks of PrepareQueueInfo need players, every dungeon is available.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class ModelQueue
+    {
+        public:
+
+            ~ModelQueue()
+            {
+                for (LfgQueueInfoMap::iterator itr = queueInfos.begin(); itr != queueInfos.end(); ++itr)
+                    delete itr->second;
+            }
+
+            // LfgMgr::PrepareQueueInfo
+            LfgQueueInfo* add(uint64_t guid, const LfgRolesMap& roles, const LfgDungeonSet& dungeons)
+            {
+                LfgQueueInfo* queue = new LfgQueueInfo;
+                queue->roles = roles;
+                queue->dungeons = dungeons;
+                queue->availableDungeons = dungeons;
+                queue->roleStates = LfgGroupMatcher::getRoleStates(roles);
+
+                queueInfos[guid] = queue;
+                queued.insert(guid);
+                matcher.addRoleCounts(queue);
+                return queue;
+            }
+
+            // LfgMgr::RemoveFromQueue
+            void remove(uint64_t guid)
+            {
+                LfgQueueInfoMap::iterator it = queueInfos.find(guid);
+                matcher.removeFromCompatibles(guid);
+                matcher.removeRoleCounts(it->second);
+                delete it->second;
+                queueInfos.erase(it);
+                queued.erase(guid);
+            }
+
+            LfgQueueInfoMap queueInfos;
+            std::set<uint64_t> queued;
+            LfgGroupMatcher matcher;
+    };
+
+    uint8_t randomRoles(uint32_t& state)
+    {
+        uint8_t roles = 0;
+        while (roles == 0)
+            roles = static_cast<uint8_t>(nextRandom(state) % 16) & (ROLE_TANK | ROLE_HEALER | ROLE_DAMAGE);
+
+        return roles | (nextRandom(state) % 4 == 0 ? ROLE_LEADER : 0);
+    }
+
+    LfgDungeonSet randomDungeons(uint32_t& state)
+    {
+        LfgDungeonSet dungeons;
+
+        // most queue for the random dungeon, the others for some of its dungeons
+        if (nextRandom(state) % 5)
+        {
+            for (uint32_t i = 0; i < dungeonCount; ++i)
+                dungeons.insert(firstDungeon + i);
+        }
+        else
+        {
+            const uint32_t count = 1 + nextRandom(state) % 3;
+            for (uint32_t i = 0; i < count; ++i)
+                dungeons.insert(firstDungeon + nextRandom(state) % dungeonCount);
+        }
+
+        return dungeons;
+    }
+
+    // the roles of a player or a group of up to maxPlayers players, the players get their own guids
+    LfgRolesMap randomEntryRoles(uint32_t& state, uint64_t& nextPlayer, uint32_t maxPlayers)
+    {
+        const uint32_t players = maxPlayers == 1 || nextRandom(state) % 4 ? 1 : 2 + nextRandom(state) % (maxPlayers - 1);
+
+        LfgRolesMap roles;
+        for (uint32_t i = 0; i < players; ++i)
+            roles[nextPlayer++] = randomRoles(state);
+
+        return roles;
+    }
+
+    // the groups both searches find for joining players, in the same queue, with players leaving
+    // and dropping out of the queue state in between
+    void testAgainstReference(uint32_t& state)
+    {
+        uint32_t groups = 0;
+        for (uint32_t round = 0; round < 100; ++round)
+        {
+            ModelQueue queue;
+            ReferenceSearch reference(queue.queueInfos, queue.queued);
+            LfgGuidList all;
+
+            uint64_t nextGuid = firstGuid;
+            uint64_t nextPlayer = firstGuid << 8;
+
+            const uint32_t initial = nextRandom(state) % 60;
+            for (uint32_t i = 0; i < initial; ++i)
+            {
+                queue.add(nextGuid, randomEntryRoles(state, nextPlayer, 1), randomDungeons(state));
+                all.push_back(nextGuid++);
+            }
+
+            for (uint32_t step = 0; step < 100; ++step)
+            {
+                // an entry leaves the queue, or an entry still in the list left the queue state
+                if (!all.empty() && nextRandom(state) % 4 == 0)
+                {
+                    LfgGuidList::iterator it = all.begin();
+                    std::advance(it, nextRandom(state) % all.size());
+                    if (nextRandom(state) % 2)
+                    {
+                        queue.remove(*it);
+                        reference.removeFromCompatibles(*it);
+                        all.erase(it);
+                    }
+                    else
+                    {
+                        queue.queued.erase(*it);
+                    }
+                }
+
+                const uint64_t guid = nextGuid++;
+                queue.add(guid, randomEntryRoles(state, nextPlayer, 1), randomDungeons(state));
+
+                LfgGuidList referenceCheck;
+                referenceCheck.push_back(guid);
+                LfgGuidList referenceAll = all;
+                bool matched = false;
+                const bool referenceFound = reference.findNewGroups(referenceCheck, referenceAll, matched);
+
+                LfgGuidList check;
+                LfgDungeonSet dungeons;
+                LfgGuidList notQueued;
+                const bool found = queue.matcher.findGroupCandidates(queue.queueInfos, guid, all,
+                    [&queue](uint64_t queuedGuid) { return queue.queued.find(queuedGuid) != queue.queued.end(); }, check, dungeons, notQueued);
+
+                TEST_CHECK(found == referenceFound);
+                if (found && referenceFound)
+                {
+                    TEST_CHECK(check == referenceCheck);
+                    TEST_CHECK(!dungeons.empty());
+
+                    // the dungeons are the ones all entries queued for
+                    for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+                    {
+                        const LfgDungeonSet& entryDungeons = queue.queueInfos[*it]->dungeons;
+                        for (LfgDungeonSet::const_iterator itDungeon = dungeons.begin(); itDungeon != dungeons.end(); ++itDungeon)
+                            TEST_CHECK(entryDungeons.find(*itDungeon) != entryDungeons.end());
+                    }
+
+                    // the group leaves the queue
+                    ++groups;
+                    for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+                    {
+                        queue.remove(*it);
+                        reference.removeFromCompatibles(*it);
+                        all.remove(*it);
+                    }
+                }
+                else
+                {
+                    all.push_back(guid);
+                }
+
+                // guids out of the queue state are the ones the LfgMgr drops from the list
+                for (LfgGuidList::const_iterator it = notQueued.begin(); it != notQueued.end(); ++it)
+                    TEST_CHECK(queue.queued.find(*it) == queue.queued.end());
+            }
+        }
+
+        TEST_CHECK(groups > 0);
+    }
+
+    // with queued groups and lfg groups every group found has five players who can take the
+    // roles, a common dungeon and at most one lfg group
+    void testQueuedGroups(uint32_t& state)
+    {
+        uint32_t groups = 0;
+        for (uint32_t round = 0; round < 100; ++round)
+        {
+            ModelQueue queue;
+            LfgGuidList all;
+
+            uint64_t nextGuid = firstGuid;
+            uint64_t nextPlayer = firstGuid << 8;
+
+            for (uint32_t step = 0; step < 150; ++step)
+            {
+                const uint64_t guid = nextGuid++;
+                LfgQueueInfo* newQueue = queue.add(guid, randomEntryRoles(state, nextPlayer, 4), randomDungeons(state));
+                newQueue->lfgGroup = newQueue->roles.size() > 1 && nextRandom(state) % 2;
+
+                LfgGuidList check;
+                LfgDungeonSet dungeons;
+                LfgGuidList notQueued;
+                if (!queue.matcher.findGroupCandidates(queue.queueInfos, guid, all, [](uint64_t) { return true; }, check, dungeons, notQueued))
+                {
+                    all.push_back(guid);
+                    continue;
+                }
+
+                TEST_CHECK(check.front() == guid);
+                TEST_CHECK(!dungeons.empty());
+
+                LfgRolesMap roles;
+                uint32_t players = 0;
+                uint32_t lfgGroups = 0;
+                for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+                {
+                    const LfgQueueInfo* queueInfo = queue.queueInfos[*it];
+                    roles.insert(queueInfo->roles.begin(), queueInfo->roles.end());
+                    players += static_cast<uint32_t>(queueInfo->roles.size());
+                    lfgGroups += queueInfo->lfgGroup ? 1 : 0;
+
+                    for (LfgDungeonSet::const_iterator itDungeon = dungeons.begin(); itDungeon != dungeons.end(); ++itDungeon)
+                        TEST_CHECK(queueInfo->dungeons.find(*itDungeon) != queueInfo->dungeons.end());
+                }
+
+                TEST_CHECK(players == 5);
+                TEST_CHECK(lfgGroups <= 1);
+                TEST_CHECK(checkGroupRoles(roles));
+
+                ++groups;
+                for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+                {
+                    queue.remove(*it);
+                    all.remove(*it);
+                }
+            }
+        }
+
+        TEST_CHECK(groups > 0);
+    }
+
+    // the role counts are an upper bound: a dungeon can't be filled if one role is missing
+    void testRoleCounts()
+    {
+        ModelQueue queue;
+        uint64_t nextPlayer = firstGuid << 8;
+
+        LfgDungeonSet dungeon;
+        dungeon.insert(firstDungeon);
+
+        LfgRolesMap roles;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            roles.clear();
+            roles[nextPlayer++] = ROLE_DAMAGE | (i == 0 ? ROLE_TANK : 0);
+            queue.add(firstGuid + i, roles, dungeon);
+        }
+
+        TEST_CHECK(!queue.matcher.canFillDungeons(dungeon));
+
+        roles.clear();
+        roles[nextPlayer++] = ROLE_HEALER;
+        LfgQueueInfo* healer = queue.add(firstGuid + 4, roles, dungeon);
+        TEST_CHECK(queue.matcher.canFillDungeons(dungeon));
+
+        // counted once, however often the queue info is prepared
+        queue.matcher.addRoleCounts(healer);
+        queue.matcher.removeRoleCounts(healer);
+        TEST_CHECK(!queue.matcher.canFillDungeons(dungeon));
+
+        queue.matcher.addRoleCounts(healer);
+        queue.remove(firstGuid);
+        TEST_CHECK(!queue.matcher.canFillDungeons(dungeon));
+
+        // a tank and healer fills both roles for the counts, not for the group
+        roles.clear();
+        roles[nextPlayer++] = ROLE_TANK | ROLE_HEALER;
+        queue.add(firstGuid + 5, roles, dungeon);
+        TEST_CHECK(queue.matcher.canFillDungeons(dungeon));
+        TEST_CHECK(LfgGroupMatcher::getRoleStates(roles) != 0);
+
+        roles[nextPlayer++] = ROLE_TANK;
+        roles[nextPlayer++] = ROLE_TANK;
+        TEST_CHECK(LfgGroupMatcher::getRoleStates(roles) == 0);
+
+        uint8_t tanks, healers, dps;
+        LfgGroupMatcher::getNeededRoles(LfgGroupMatcher::getRoleStates(queue.queueInfos[firstGuid + 1]->roles), tanks, healers, dps);
+        TEST_CHECK(tanks == 1 && healers == 1 && dps == 2);
+    }
+
+    // A player joining while 1000 (and 100) players are queued: dps, a fifth of them can tank,
+    // none can heal, so only the joining healers complete a group. Every iteration queues a
+    // new player, searches a group for it and removes it again.
+    void benchmarkJoin(uint32_t queued)
+    {
+        const uint32_t iterations = 200;
+
+        ModelQueue queue;
+        ReferenceSearch reference(queue.queueInfos, queue.queued);
+        LfgGuidList all;
+
+        uint32_t state = 0x1B873593;
+        for (uint32_t i = 0; i < queued; ++i)
+        {
+            LfgRolesMap roles;
+            roles[firstGuid + i] = nextRandom(state) % 5 ? ROLE_DAMAGE : ROLE_TANK | ROLE_DAMAGE;
+            queue.add(firstGuid + i, roles, randomDungeons(state));
+            all.push_back(firstGuid + i);
+        }
+
+        // every second player joining can heal and completes a group
+        std::vector<LfgRolesMap> joinRoles(iterations);
+        std::vector<LfgDungeonSet> joinDungeons(iterations);
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            joinRoles[i][firstGuid + queued + i] = i % 2 ? ROLE_DAMAGE : ROLE_HEALER | ROLE_DAMAGE;
+            joinDungeons[i] = randomDungeons(state);
+        }
+
+        typedef std::chrono::steady_clock Clock;
+
+        std::vector<LfgGuidList> referenceGroups(iterations);
+        const Clock::time_point referenceStart = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            const uint64_t guid = firstGuid + queued + i;
+            queue.add(guid, joinRoles[i], joinDungeons[i]);
+
+            LfgGuidList check;
+            check.push_back(guid);
+            LfgGuidList candidates = all;
+            bool matched = false;
+            if (reference.findNewGroups(check, candidates, matched))
+                referenceGroups[i] = check;
+
+            reference.removeFromCompatibles(guid);
+            queue.remove(guid);
+        }
+        const double referenceTime = std::chrono::duration<double, std::micro>(Clock::now() - referenceStart).count();
+
+        std::vector<LfgGuidList> groups(iterations);
+        const Clock::time_point matcherStart = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            const uint64_t guid = firstGuid + queued + i;
+            queue.add(guid, joinRoles[i], joinDungeons[i]);
+
+            LfgGuidList check;
+            LfgDungeonSet dungeons;
+            LfgGuidList notQueued;
+            if (queue.matcher.findGroupCandidates(queue.queueInfos, guid, all, [](uint64_t) { return true; }, check, dungeons, notQueued))
+                groups[i] = check;
+
+            queue.remove(guid);
+        }
+        const double matcherTime = std::chrono::duration<double, std::micro>(Clock::now() - matcherStart).count();
+
+        TEST_CHECK(groups == referenceGroups);
+
+        std::printf("LfgGroupMatcherTest : join, %u queued: recursive search %.2f us/join, group matcher %.2f us/join\n",
+            queued, referenceTime / iterations, matcherTime / iterations);
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x85EBCA6B;
+
+    testAgainstReference(state);
+    testQueuedGroups(state);
+    testRoleCounts();
+    benchmarkJoin(100);
+    benchmarkJoin(1000);
+
+    std::printf("LfgGroupMatcherTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
@@ -0,0 +1,420 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "CommonTypes.hpp"
+#include "GameWotLK/UpdateFields.h"
+#include "Objects/ObjectCreateValues.hpp"
+#include "TestCheck.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+
+// ARCEMU_ASSERT of UpdateMask, the world executable has it in WUtil.cpp
+void Arcemu::Util::ArcemuAssert(bool condition)
+{
+    TEST_CHECK(condition);
+}
+
+namespace
+{
+    // UnitDefines.hpp, the dynamic flags the observer dependent creature values use
+    const uint32_t dynFlagLootable = 0x01;
+    const uint32_t dynFlagTaggedByOther = 0x04;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    struct ModelObserver
+    {
+        ModelObserver(uint64_t observerGuid) : guid(observerGuid), hasLoot(false) {}
+
+        uint64_t guid;
+        std::set<uint32_t> quests;      // the quests in the quest log
+        bool hasLoot;                   // Creature::HasLootForPlayer
+    };
+
+    enum ModelType
+    {
+        MODEL_CREATURE,
+        MODEL_GAMEOBJECT,
+        MODEL_PLAYER
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// An object reduced to what its create blocks depend on: the fields, the field
+    /// generation, the tag and loot state of a creature, the quest a gameobject starts and
+    /// the visibility mask of players. The observer dependent values are the ones of
+    /// Object::_GetObserverDynamicValue, the builds the ones of Object::_BuildValuesUpdate
+    /// with the observer as target and Object::_BuildCachedCreateValues.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class ModelObject
+    {
+        public:
+
+            explicit ModelObject(ModelType type) : m_type(type), m_generation(0), taggerGuid(0), hasLoot(false), questId(0)
+            {
+                const uint32_t counts[] = { UNIT_END, GAMEOBJECT_END, PLAYER_END };
+                m_values.assign(counts[type], 0);
+
+                // Player::InitVisibleUpdateBits, reduced to a few unit fields and the visible items
+                if (m_type == MODEL_PLAYER)
+                {
+                    m_visibleMask.SetCount(PLAYER_END);
+                    for (uint32_t i = 0; i < OBJECT_END; ++i)
+                        m_visibleMask.SetBit(i);
+
+                    m_visibleMask.SetBit(UNIT_FIELD_HEALTH);
+                    m_visibleMask.SetBit(UNIT_FIELD_MAXHEALTH);
+                    m_visibleMask.SetBit(UNIT_FIELD_LEVEL);
+                    m_visibleMask.SetBit(UNIT_FIELD_FACTIONTEMPLATE);
+                    m_visibleMask.SetBit(UNIT_DYNAMIC_FLAGS);
+                    for (uint32_t i = PLAYER_VISIBLE_ITEM_1_ENTRYID; i <= PLAYER_VISIBLE_ITEM_19_ENCHANTMENT; ++i)
+                        m_visibleMask.SetBit(i);
+                }
+            }
+
+            uint32_t getValuesCount() const { return static_cast<uint32_t>(m_values.size()); }
+            uint32_t getValue(uint32_t index) const { return m_values[index]; }
+
+            // the field setters of Object
+            void setValue(uint32_t index, uint32_t value)
+            {
+                m_values[index] = value;
+                ++m_generation;
+            }
+
+            uint32_t getCreateDynamicIndex() const
+            {
+                if (m_type == MODEL_CREATURE)
+                    return UNIT_DYNAMIC_FLAGS;
+
+                if (m_type == MODEL_GAMEOBJECT)
+                    return GAMEOBJECT_DYNAMIC;
+
+                return 0;
+            }
+
+            bool getObserverDynamicValue(const ModelObserver& target, uint32_t& value) const
+            {
+                if (m_type == MODEL_CREATURE && taggerGuid != 0 && hasLoot)
+                {
+                    uint32_t flags = m_values[UNIT_DYNAMIC_FLAGS];
+                    if (taggerGuid == target.guid)
+                    {
+                        flags &= ~dynFlagTaggedByOther;
+                        if (target.hasLoot)
+                            flags |= dynFlagLootable;
+                    }
+                    else
+                    {
+                        flags |= dynFlagTaggedByOther;
+                        flags &= ~dynFlagLootable;
+                    }
+
+                    value = flags;
+                    return true;
+                }
+
+                if (m_type == MODEL_GAMEOBJECT && questId != 0 && target.quests.find(questId) == target.quests.end())
+                {
+                    value = 1 | 8;
+                    return true;
+                }
+
+                return false;
+            }
+
+            void setCreateBits(UpdateMask* updateMask) const
+            {
+                if (m_type == MODEL_PLAYER)
+                    updateMask->SetNonZeroBits(&m_values[0], m_visibleMask);
+                else
+                    updateMask->SetNonZeroBits(&m_values[0]);
+            }
+
+            // Object::_BuildValuesUpdate of a create block for target, returns true if the dynamic field was sent
+            bool buildValuesUpdate(ByteBuffer* data, const ModelObserver& target)
+            {
+                UpdateMask updateMask;
+                updateMask.SetCount(getValuesCount());
+                setCreateBits(&updateMask);
+
+                uint32_t dynamicIndex = 0;
+                uint32_t dynamicValue = 0;
+                if (getObserverDynamicValue(target, dynamicValue))
+                {
+                    dynamicIndex = getCreateDynamicIndex();
+                    updateMask.SetBit(dynamicIndex);
+                }
+
+                ObjectCreateValues::writeValues(data, &updateMask, &m_values[0], getValuesCount(), dynamicIndex, dynamicValue);
+                return getCreateDynamicIndex() != 0 && updateMask.GetBit(getCreateDynamicIndex());
+            }
+
+            // Object::_BuildCachedCreateValues, returns true for a cached block
+            bool buildCachedCreateValues(ByteBuffer* data, const ModelObserver& target)
+            {
+                const uint32_t dynamicIndex = getCreateDynamicIndex();
+                const size_t start = data->wpos();
+
+                const bool cached = m_createValues.appendCreateValues(data, &m_values[0], getValuesCount(), m_generation, dynamicIndex,
+                    [this](UpdateMask* updateMask) { setCreateBits(updateMask); });
+
+                uint32_t value;
+                if (dynamicIndex != 0 && getObserverDynamicValue(target, value))
+                    m_createValues.patchDynamicValue(data, start, value);
+
+                return cached;
+            }
+
+            // Object::RemoveFromWorld
+            void removeFromWorld() { m_createValues.clear(); }
+
+        private:
+
+            ModelType m_type;
+            std::vector<uint32_t> m_values;
+            uint32_t m_generation;
+            UpdateMask m_visibleMask;
+            ObjectCreateValues m_createValues;
+
+        public:
+
+            uint64_t taggerGuid;        // Creature::GetTaggerGUID, 0 if not tagged
+            bool hasLoot;               // the loot of the creature has gold or items
+            uint32_t questId;           // the quest a questgiver gameobject starts
+    };
+
+    /// the fields a client has after applying the values block at start, false if the block is malformed
+    bool decodeValues(const ByteBuffer& data, size_t start, uint32_t valuesCount, std::vector<uint32_t>& values)
+    {
+        const uint8_t* block = data.contents() + start;
+        const size_t size = data.size() - start;
+
+        values.assign(valuesCount, 0);
+        if (size < 1 || size < 1 + block[0] * 4u)
+            return false;
+
+        const uint32_t blockCount = block[0];
+        const uint8_t* mask = block + 1;
+        size_t offset = 1 + blockCount * 4;
+        for (uint32_t i = 0; i < blockCount * 32; ++i)
+        {
+            if (!(mask[i >> 3] & (1 << (i & 7))))
+                continue;
+
+            if (i >= valuesCount || offset + 4 > size)
+                return false;
+
+            values[i] = data.read<uint32_t>(start + offset);
+            offset += 4;
+        }
+
+        return offset == size;
+    }
+
+    /// compares the cached block for observer with the block built for it, returns true for a cache hit
+    bool checkCreateValues(ModelObject& object, const ModelObserver& observer, uint32_t& state)
+    {
+        // the movement part before the values differs in length
+        const size_t movementSize = nextRandom(state) % 60;
+
+        ByteBuffer reference;
+        for (size_t i = 0; i < movementSize; ++i)
+            reference << uint8_t(i);
+        const bool dynamicSent = object.buildValuesUpdate(&reference, observer);
+
+        ByteBuffer current;
+        for (size_t i = 0; i < movementSize; ++i)
+            current << uint8_t(i);
+        const bool cached = object.buildCachedCreateValues(&current, observer);
+
+        std::vector<uint32_t> referenceValues;
+        std::vector<uint32_t> currentValues;
+        TEST_CHECK(decodeValues(reference, movementSize, object.getValuesCount(), referenceValues));
+        TEST_CHECK(decodeValues(current, movementSize, object.getValuesCount(), currentValues));
+        TEST_CHECK(currentValues == referenceValues);
+
+        // the cached block always holds the dynamic field, a zero one is only sent per observer if it has a value
+        if (dynamicSent || object.getCreateDynamicIndex() == 0)
+        {
+            TEST_CHECK(current.size() == reference.size());
+            TEST_CHECK(current.size() == reference.size() && memcmp(current.contents(), reference.contents(), current.size()) == 0);
+        }
+
+        return cached;
+    }
+
+    void spawn(ModelObject& object, uint32_t& state)
+    {
+        for (uint32_t i = 0; i < object.getValuesCount(); ++i)
+        {
+            if (nextRandom(state) % 3 == 0)
+                object.setValue(i, nextRandom(state));
+        }
+
+        object.setValue(OBJECT_FIELD_GUID, 1 + nextRandom(state) % 1000);
+    }
+
+    // a creature tagged by the first observer, seen by the tagger with and without loot for it
+    // and by the others, before and after its loot and dynamic flags change
+    void testTaggedCreature(uint32_t& state)
+    {
+        ModelObject creature(MODEL_CREATURE);
+        spawn(creature, state);
+        creature.setValue(UNIT_DYNAMIC_FLAGS, 0);
+
+        std::vector<ModelObserver> observers;
+        for (uint64_t guid = 1; guid <= 4; ++guid)
+            observers.push_back(ModelObserver(guid));
+
+        observers[0].hasLoot = true;
+        creature.taggerGuid = observers[0].guid;
+        creature.hasLoot = true;
+
+        uint32_t hits = 0;
+        for (uint32_t round = 0; round < 3; ++round)
+        {
+            for (std::vector<ModelObserver>::const_iterator itr = observers.begin(); itr != observers.end(); ++itr)
+                hits += checkCreateValues(creature, *itr, state) ? 1 : 0;
+
+            // the tagger looted its items, then the creature is lootable for everybody
+            observers[0].hasLoot = round == 0;
+            if (round == 1)
+                creature.setValue(UNIT_DYNAMIC_FLAGS, dynFlagLootable);
+        }
+
+        // nobody tagged it, every observer sees the stored flags
+        creature.taggerGuid = 0;
+        for (std::vector<ModelObserver>::const_iterator itr = observers.begin(); itr != observers.end(); ++itr)
+            hits += checkCreateValues(creature, *itr, state) ? 1 : 0;
+
+        // the first build of each generation is a miss
+        TEST_CHECK(hits == 16 - 2);
+    }
+
+    // a questgiver gameobject sparkles for the observers without its quest
+    void testQuestGameObject(uint32_t& state)
+    {
+        ModelObject gameObject(MODEL_GAMEOBJECT);
+        spawn(gameObject, state);
+        gameObject.questId = 42;
+
+        std::vector<ModelObserver> observers;
+        for (uint64_t guid = 1; guid <= 4; ++guid)
+        {
+            observers.push_back(ModelObserver(guid));
+            if (guid % 2)
+                observers.back().quests.insert(gameObject.questId);
+        }
+
+        for (uint32_t round = 0; round < 2; ++round)
+        {
+            gameObject.setValue(GAMEOBJECT_DYNAMIC, round == 0 ? 0 : 1);
+            for (std::vector<ModelObserver>::const_iterator itr = observers.begin(); itr != observers.end(); ++itr)
+                checkCreateValues(gameObject, *itr, state);
+        }
+
+        // accepting the quest changes no field, the patch still follows the observer
+        observers[1].quests.insert(gameObject.questId);
+        TEST_CHECK(checkCreateValues(gameObject, observers[1], state));
+    }
+
+    // a player seen by other players gets the fields of the visibility mask only
+    void testPlayerSeenByPlayer(uint32_t& state)
+    {
+        ModelObject player(MODEL_PLAYER);
+        spawn(player, state);
+
+        ModelObserver first(1);
+        ModelObserver second(2);
+        TEST_CHECK(!checkCreateValues(player, first, state));
+        TEST_CHECK(checkCreateValues(player, second, state));
+
+        // a private field changes the generation, the values stay the same for the others
+        player.setValue(PLAYER_FIELD_COINAGE, player.getValue(PLAYER_FIELD_COINAGE) + 1);
+        TEST_CHECK(!checkCreateValues(player, first, state));
+
+        // the cache is dropped when the player leaves the world
+        player.removeFromWorld();
+        TEST_CHECK(!checkCreateValues(player, second, state));
+    }
+
+    // field changes, tag, loot and quest changes and observers entering the range in random order
+    void testRandomChanges(uint32_t& state)
+    {
+        uint64_t builds = 0;
+        uint64_t hits = 0;
+        for (uint32_t round = 0; round < 300; ++round)
+        {
+            ModelObject object(static_cast<ModelType>(round % 3));
+            spawn(object, state);
+            object.questId = nextRandom(state) % 2 ? 7 : 0;
+
+            std::vector<ModelObserver> observers;
+            for (uint64_t guid = 1; guid <= 10; ++guid)
+                observers.push_back(ModelObserver(guid));
+
+            for (uint32_t step = 0; step < 200; ++step)
+            {
+                ModelObserver& observer = observers[nextRandom(state) % observers.size()];
+                switch (nextRandom(state) % 8)
+                {
+                    case 0:
+                    {
+                        const uint32_t index = nextRandom(state) % object.getValuesCount();
+                        object.setValue(index, nextRandom(state) % 2 ? nextRandom(state) : 0);
+                        break;
+                    }
+                    case 1:
+                        if (object.getCreateDynamicIndex() != 0)
+                            object.setValue(object.getCreateDynamicIndex(), nextRandom(state) % 16);
+                        break;
+                    case 2:
+                        object.taggerGuid = nextRandom(state) % 2 ? observer.guid : 0;
+                        object.hasLoot = nextRandom(state) % 4 != 0;
+                        break;
+                    case 3:
+                        observer.hasLoot = !observer.hasLoot;
+                        if (observer.quests.empty())
+                            observer.quests.insert(7);
+                        else
+                            observer.quests.clear();
+                        break;
+                    default:
+                        ++builds;
+                        hits += checkCreateValues(object, observer, state) ? 1 : 0;
+                        break;
+                }
+            }
+        }
+
+        TEST_CHECK(hits > 0 && hits < builds);
+        std::printf("ObjectCreateValuesTest : %llu create blocks, %.1f%% from the cache\n",
+            static_cast<unsigned long long>(builds), 100.0 * hits / builds);
+    }
+}
+
+int main()
+{
+    uint32_t state = 0xC2B2AE35;
+
+    testTaggedCreature(state);
+    testQuestGameObject(state);
+    testPlayerSeenByPlayer(state);
+    testRandomChanges(state);
+
+    std::printf("ObjectCreateValuesTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
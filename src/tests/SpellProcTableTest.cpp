@@ -0,0 +1,220 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Spell/SpellProcTable.h"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <vector>
+
+namespace
+{
+    // the procFlags of Spell.h used below
+    enum ModelProcFlags
+    {
+        PROC_ON_ANY_HOSTILE_ACTION      = 0x1,
+        PROC_ON_MELEE_ATTACK            = 0x4,
+        PROC_ON_CRIT_HIT_VICTIM         = 0x8,
+        PROC_ON_CAST_SPELL              = 0x10,
+        PROC_ON_PHYSICAL_ATTACK_VICTIM  = 0x20,
+        PROC_ON_PHYSICAL_ATTACK         = 0x100,
+        PROC_ON_MELEE_ATTACK_VICTIM     = 0x200,
+        PROC_ON_SPELL_HIT               = 0x400,
+        PROC_ON_CRIT_ATTACK             = 0x1000,
+        PROC_ON_CAST_SPECIFIC_SPELL     = 0x10000,
+        PROC_ON_SPELL_HIT_VICTIM        = 0x20000,
+        PROC_ON_TARGET_DIE              = 0x80000,
+        PROC_ON_ANY_DAMAGE_VICTIM       = 0x100000,
+        PROC_ON_DODGE_VICTIM            = 0x2000000,
+        PROC_ON_SPELL_CRIT_HIT          = 0x40000000
+    };
+
+    // flags HandleProc is called with by melee swings, spell casts and kills
+    const uint32_t events[] =
+    {
+        PROC_ON_MELEE_ATTACK | PROC_ON_PHYSICAL_ATTACK | PROC_ON_ANY_HOSTILE_ACTION,
+        PROC_ON_MELEE_ATTACK_VICTIM | PROC_ON_PHYSICAL_ATTACK_VICTIM | PROC_ON_ANY_DAMAGE_VICTIM | PROC_ON_ANY_HOSTILE_ACTION,
+        PROC_ON_CRIT_ATTACK | PROC_ON_MELEE_ATTACK | PROC_ON_PHYSICAL_ATTACK | PROC_ON_ANY_HOSTILE_ACTION,
+        PROC_ON_CAST_SPECIFIC_SPELL | PROC_ON_CAST_SPELL,
+        PROC_ON_SPELL_HIT_VICTIM | PROC_ON_ANY_DAMAGE_VICTIM | PROC_ON_ANY_HOSTILE_ACTION,
+        PROC_ON_SPELL_CRIT_HIT,
+        PROC_ON_TARGET_DIE
+    };
+    const uint32_t eventCount = sizeof(events) / sizeof(events[0]);
+
+    // what the procs of buffs, talents and item enchants listen to
+    const uint32_t procFlagChoices[] =
+    {
+        PROC_ON_MELEE_ATTACK, PROC_ON_CRIT_ATTACK, PROC_ON_CAST_SPELL, PROC_ON_SPELL_HIT, PROC_ON_SPELL_CRIT_HIT,
+        PROC_ON_MELEE_ATTACK_VICTIM, PROC_ON_CRIT_HIT_VICTIM, PROC_ON_SPELL_HIT_VICTIM, PROC_ON_ANY_DAMAGE_VICTIM,
+        PROC_ON_DODGE_VICTIM, PROC_ON_TARGET_DIE, PROC_ON_PHYSICAL_ATTACK
+    };
+    const uint32_t procFlagChoiceCount = sizeof(procFlagChoices) / sizeof(procFlagChoices[0]);
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    /// SpellProc reduced to what HandleProc asks before calling the proc
+    struct ModelProc
+    {
+        uint32_t mSpellId;
+        uint32_t mProcFlags;
+        bool mDeleted;
+
+        bool CheckProcFlags(uint32_t flag) const { return (mProcFlags & flag) != 0; }
+    };
+
+    ModelProc* createProc(uint32_t& state, uint32_t spellId)
+    {
+        ModelProc* proc = new ModelProc;
+        proc->mSpellId = spellId;
+        proc->mProcFlags = 0;
+        proc->mDeleted = false;
+
+        const uint32_t flags = 1 + nextRandom(state) % 3;
+        for (uint32_t i = 0; i < flags; ++i)
+            proc->mProcFlags |= procFlagChoices[nextRandom(state) % procFlagChoiceCount];
+
+        return proc;
+    }
+
+    // HandleProc before the table: the std::list every proc was kept in, asked one by one
+    uint64_t selectFromList(const std::list<ModelProc*>& procs, uint32_t flag)
+    {
+        uint64_t checksum = 0;
+        for (std::list<ModelProc*>::const_iterator itr = procs.begin(); itr != procs.end(); ++itr)
+        {
+            if (!(*itr)->mDeleted && (*itr)->CheckProcFlags(flag))
+                checksum = checksum * 31 + (*itr)->mSpellId;
+        }
+
+        return checksum;
+    }
+
+    uint64_t selectFromTable(const BasicSpellProcTable<ModelProc>& table, uint32_t flag, std::vector<ModelProc*>& candidates)
+    {
+        uint64_t checksum = 0;
+        table.getCandidates(flag, candidates);
+        for (std::vector<ModelProc*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        {
+            if (!(*itr)->mDeleted && (*itr)->CheckProcFlags(flag))
+                checksum = checksum * 31 + (*itr)->mSpellId;
+        }
+
+        return checksum;
+    }
+
+    // procs come and go with auras while events are handled, the candidates keep the list order
+    void testAgainstList(uint32_t& state)
+    {
+        std::list<ModelProc*> procList;
+        BasicSpellProcTable<ModelProc> procTable;
+        std::vector<ModelProc*> candidates;
+
+        for (uint32_t step = 0; step < 50000; ++step)
+        {
+            const uint32_t action = nextRandom(state) % 10;
+            if (action < 3 || procList.empty())
+            {
+                ModelProc* proc = createProc(state, step);
+                procList.push_back(proc);
+                procTable.add(proc);
+            }
+            else if (action < 5)
+            {
+                std::list<ModelProc*>::iterator itr = procList.begin();
+                std::advance(itr, nextRandom(state) % procList.size());
+
+                ModelProc* proc = *itr;
+                procList.erase(itr);
+                procTable.remove(proc);
+                delete proc;
+            }
+            else if (action == 5)
+            {
+                // a proc marked deleted stays until the next cleanup
+                std::list<ModelProc*>::iterator itr = procList.begin();
+                std::advance(itr, nextRandom(state) % procList.size());
+                (*itr)->mDeleted = true;
+            }
+            else
+            {
+                uint32_t flag = events[nextRandom(state) % eventCount];
+                if (action == 9)
+                    flag = nextRandom(state);
+
+                TEST_CHECK(selectFromTable(procTable, flag, candidates) == selectFromList(procList, flag));
+            }
+
+            TEST_CHECK(procTable.size() == procList.size());
+        }
+
+        for (std::list<ModelProc*>::iterator itr = procList.begin(); itr != procList.end(); ++itr)
+            delete *itr;
+
+        procTable.clear();
+        TEST_CHECK(procTable.empty());
+        TEST_CHECK(selectFromTable(procTable, ~0u, candidates) == 0 && candidates.empty());
+    }
+
+    // proc selection of HandleProc for a raid buffed player with 50 procs
+    void benchmarkSelection(uint32_t& state)
+    {
+        const uint32_t procCount = 50;
+        const uint32_t iterations = 200000;
+
+        std::list<ModelProc*> procList;
+        BasicSpellProcTable<ModelProc> procTable;
+        for (uint32_t i = 0; i < procCount; ++i)
+        {
+            ModelProc* proc = createProc(state, 10000 + i);
+            procList.push_back(proc);
+            procTable.add(proc);
+        }
+
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point listStart = Clock::now();
+        uint64_t listChecksum = 0;
+        for (uint32_t i = 0; i < iterations; ++i)
+            listChecksum += selectFromList(procList, events[i % eventCount]);
+        const double listTime = std::chrono::duration<double, std::nano>(Clock::now() - listStart).count();
+
+        std::vector<ModelProc*> candidates;
+        const Clock::time_point tableStart = Clock::now();
+        uint64_t tableChecksum = 0;
+        for (uint32_t i = 0; i < iterations; ++i)
+            tableChecksum += selectFromTable(procTable, events[i % eventCount], candidates);
+        const double tableTime = std::chrono::duration<double, std::nano>(Clock::now() - tableStart).count();
+
+        TEST_CHECK(tableChecksum == listChecksum);
+
+        std::printf("SpellProcTableTest : %u procs: list walk %.1f ns/event, table %.1f ns/event\n",
+            procCount, listTime / iterations, tableTime / iterations);
+
+        for (std::list<ModelProc*>::iterator itr = procList.begin(); itr != procList.end(); ++itr)
+            delete *itr;
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x6C8E9CF5;
+
+    testAgainstList(state);
+    benchmarkSelection(state);
+
+    std::printf("SpellProcTableTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
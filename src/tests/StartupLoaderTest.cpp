@@ -0,0 +1,178 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StartupLoader.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // names of the finished tasks in finish order
+    class TaskLog
+    {
+        public:
+
+            std::function<void()> task(const std::string& name)
+            {
+                return [this, name]() { finish(name); };
+            }
+
+            void finish(const std::string& name)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_finished.push_back(name);
+            }
+
+            bool hasRun(const std::string& name) const
+            {
+                return position(name) != m_finished.size();
+            }
+
+            bool ranBefore(const std::string& first, const std::string& second) const
+            {
+                return hasRun(first) && hasRun(second) && position(first) < position(second);
+            }
+
+            size_t count() const { return m_finished.size(); }
+
+        private:
+
+            size_t position(const std::string& name) const
+            {
+                return std::find(m_finished.begin(), m_finished.end(), name) - m_finished.begin();
+            }
+
+            std::mutex m_lock;
+            std::vector<std::string> m_finished;
+    };
+
+    // dbc -> (items, spells) -> vendors, like the world startup
+    void addDiamond(StartupLoader& loader, TaskLog& log)
+    {
+        loader.addTask("vendors", { "items", "spells" }, log.task("vendors"));
+        loader.addTask("items", { "dbc" }, log.task("items"));
+        loader.addTask("spells", { "dbc" }, log.task("spells"));
+        loader.addTask("dbc", {}, log.task("dbc"));
+    }
+
+    void testDependencyOrder(uint32_t threadCount)
+    {
+        StartupLoader loader;
+        TaskLog log;
+        addDiamond(loader, log);
+        loader.addTask("independent", {}, log.task("independent"));
+
+        TEST_CHECK(loader.run(threadCount));
+        TEST_CHECK(log.count() == 5);
+        TEST_CHECK(log.ranBefore("dbc", "items"));
+        TEST_CHECK(log.ranBefore("dbc", "spells"));
+        TEST_CHECK(log.ranBefore("items", "vendors"));
+        TEST_CHECK(log.ranBefore("spells", "vendors"));
+        TEST_CHECK(log.hasRun("independent"));
+    }
+
+    void testIndependentTasksOverlap()
+    {
+        std::mutex lock;
+        std::condition_variable cond;
+        uint32_t started = 0;
+        uint32_t sawBoth = 0;
+
+        // each task waits for the other one, which only ends early when both run at once
+        auto task = [&]()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ++started;
+            cond.notify_all();
+            if (cond.wait_for(guard, std::chrono::seconds(5), [&] { return started == 2; }))
+                ++sawBoth;
+        };
+
+        StartupLoader loader;
+        loader.addTask("characters", {}, task);
+        loader.addTask("creatures", {}, task);
+
+        TEST_CHECK(loader.run(2));
+        TEST_CHECK(sawBoth == 2);
+    }
+
+    void testFailedTask()
+    {
+        StartupLoader loader;
+        TaskLog log;
+        loader.addCheckedTask("dbc", {}, [&log]() { log.finish("dbc"); return false; });
+        loader.addTask("items", { "dbc" }, log.task("items"));
+
+        TEST_CHECK(!loader.run(2));
+        TEST_CHECK(log.hasRun("dbc"));
+        TEST_CHECK(!log.hasRun("items"));
+    }
+
+    void testThrowingTask()
+    {
+        StartupLoader loader;
+        TaskLog log;
+        loader.addTask("dbc", {}, log.task("dbc"));
+        loader.addTask("items", { "dbc" }, []() { throw std::runtime_error("item table is missing"); });
+        loader.addTask("vendors", { "items" }, log.task("vendors"));
+
+        TEST_CHECK(!loader.run(4));
+        TEST_CHECK(log.hasRun("dbc"));
+        TEST_CHECK(!log.hasRun("vendors"));
+
+        StartupLoader unknownException;
+        unknownException.addCheckedTask("dbc", {}, []() -> bool { throw 1; });
+
+        TEST_CHECK(!unknownException.run(1));
+    }
+
+    void testUnknownDependency()
+    {
+        StartupLoader loader;
+        TaskLog log;
+        loader.addTask("items", {}, log.task("items"));
+        loader.addTask("vendors", { "items", "item_extendedcost" }, log.task("vendors"));
+
+        TEST_CHECK(!loader.run(2));
+        TEST_CHECK(log.count() == 0);
+    }
+
+    void testCycle()
+    {
+        StartupLoader loader;
+        TaskLog log;
+        loader.addTask("dbc", {}, log.task("dbc"));
+        loader.addTask("a", { "dbc", "c" }, log.task("a"));
+        loader.addTask("b", { "a" }, log.task("b"));
+        loader.addTask("c", { "b" }, log.task("c"));
+
+        TEST_CHECK(!loader.run(2));
+        TEST_CHECK(log.hasRun("dbc"));
+        TEST_CHECK(log.count() == 1);
+    }
+}
+
+int main()
+{
+    testDependencyOrder(1);
+    testDependencyOrder(4);
+    testIndependentTasksOverlap();
+    testFailedTask();
+    testThrowingTask();
+    testUnknownDependency();
+    testCycle();
+
+    if (testFailures() == 0)
+        std::printf("StartupLoaderTest : all checks passed\n");
+
+    return testFailures();
+}
@@ -0,0 +1,28 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cstdio>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Checks of the test executables. A failed check is printed and counted, main returns
+/// testFailures() so ctest sees the failure.
+//////////////////////////////////////////////////////////////////////////////////////////
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define TEST_CHECK(expression) \
+    do \
+    { \
+        if (!(expression)) \
+        { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expression); \
+            ++testFailures(); \
+        } \
+    } while (false)
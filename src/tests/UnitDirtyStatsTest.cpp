@@ -0,0 +1,345 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "Units/UnitDirtyStats.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    const uint32_t schoolCount = 7;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// A player reduced to the dependencies of its stat calculations: UpdateStats sets the
+    /// attack speed, attack power and max health, clamps the health, refreshes the armor
+    /// through a mark (like the aura modifiers it refreshes) and ends with UpdateChances and
+    /// CalcDamage. CalcDamage reads the attack power. Each calculation only reads inputs whose
+    /// handlers run it, so the eager calculations never leave a stale stat behind.
+    ///
+    /// Without UnitDirtyStats every change runs the calculations the aura and item handlers
+    /// called before the deferred recalculation, with it the changes only mark the flags.
+    //////////////////////////////////////////////////////////////////////////////////////
+    class ModelPlayer
+    {
+        public:
+
+            explicit ModelPlayer(UnitDirtyStats* dirtyStats) : m_dirtyStats(nullptr), updateStatsCalls(0)
+            {
+                stamina = 50;
+                strength = 40;
+                agility = 30;
+                haste = 0;
+                critRating = 0;
+                weaponDamage = 100;
+                std::fill(resistanceMods, resistanceMods + schoolCount, 0);
+
+                maxHealth = 0;
+                health = 0;
+                attackPower = 0;
+                attackTime = 0;
+                dodge = 0;
+                crit = 0;
+                damage = 0;
+                std::fill(resistances, resistances + schoolCount, 0);
+
+                updateStats();
+                for (uint32_t school = 0; school < schoolCount; ++school)
+                    calcResistance(school);
+
+                health = maxHealth;
+
+                // the player enters the map with calculated stats
+                m_dirtyStats = dirtyStats;
+            }
+
+            // Unit::markStatsDirty of a unit in a map
+            void markStatsDirty(uint32_t dirty_flags)
+            {
+                if (m_dirtyStats->isRecalculating())
+                    m_dirtyStats->recalculate(*this, dirty_flags);
+                else
+                    m_dirtyStats->mark(dirty_flags);
+            }
+
+            // the getters of derived stats during the tick of the player's map
+            void flushDirtyStats()
+            {
+                if (m_dirtyStats != nullptr)
+                    m_dirtyStats->flush(*this);
+            }
+
+            bool hasPlayerStats() const { return true; }
+
+            void calcResistance(uint32_t school)
+            {
+                resistances[school] = resistanceMods[school] + (school == 0 ? agility * 2 : 0);
+            }
+
+            void updateAttackSpeed()
+            {
+                attackTime = 2000 * 100 / (100 + haste);
+            }
+
+            void updateStats()
+            {
+                ++updateStatsCalls;
+
+                updateAttackSpeed();
+                attackPower = strength * 2 + agility;
+                maxHealth = 100 + stamina * 10;
+                health = std::min(health, maxHealth);
+
+                if (m_dirtyStats != nullptr)
+                    markStatsDirty(UNIT_STAT_DIRTY_RESISTANCE_NORMAL);
+                else
+                    calcResistance(0);
+
+                updateChances();
+                calcDamage();
+            }
+
+            void updateChances()
+            {
+                dodge = agility / 20 + 5;
+                crit = critRating / 14 + agility / 25;
+            }
+
+            void calcDamage()
+            {
+                damage = weaponDamage + attackPower / 14;
+            }
+
+            // inputs
+            uint32_t stamina;
+            uint32_t strength;
+            uint32_t agility;
+            uint32_t haste;
+            uint32_t critRating;
+            uint32_t weaponDamage;
+            uint32_t resistanceMods[schoolCount];
+
+            // derived stats
+            uint32_t maxHealth;
+            uint32_t health;
+            uint32_t attackPower;
+            uint32_t attackTime;
+            uint32_t dodge;
+            uint32_t crit;
+            uint32_t damage;
+            uint32_t resistances[schoolCount];
+
+        private:
+
+            UnitDirtyStats* m_dirtyStats;
+
+        public:
+
+            uint32_t updateStatsCalls;
+    };
+
+    enum ChangeType
+    {
+        CHANGE_STAMINA,         // SpellAuraModStat: UpdateStats
+        CHANGE_STRENGTH,        // SpellAuraModStat: UpdateStats
+        CHANGE_AGILITY,         // SpellAuraModTotalStatPerc: UpdateStats and UpdateChances
+        CHANGE_HASTE,           // SpellAuraModHaste: UpdateAttackSpeed
+        CHANGE_CRIT_RATING,     // SpellAuraModCritPerc: UpdateChances
+        CHANGE_WEAPON_DAMAGE,   // SpellAuraModDamageDone: CalcDamage
+        CHANGE_RESISTANCE,      // SpellAuraModResistance: CalcResistance of the school
+        CHANGE_READ,            // a spell reads the max health
+        CHANGE_DAMAGE_TAKEN,    // reads the health
+        CHANGE_HEAL,            // reads health and max health
+        CHANGE_COUNT
+    };
+
+    /// applies change to the eager and the deferred player, returns false if a read differed
+    bool applyChange(ModelPlayer& eager, ModelPlayer& deferred, uint32_t change, uint32_t value)
+    {
+        // the inputs go up and down like buffs being applied and removed
+        const bool remove = (value & 1) != 0;
+        const uint32_t amount = value % 40;
+
+        auto modify = [remove, amount](uint32_t& input)
+        {
+            input = remove ? input - std::min(input, amount) : input + amount;
+        };
+
+        switch (change)
+        {
+            case CHANGE_STAMINA:
+                modify(eager.stamina);
+                modify(deferred.stamina);
+                eager.updateStats();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_STATS);
+                break;
+            case CHANGE_STRENGTH:
+                modify(eager.strength);
+                modify(deferred.strength);
+                eager.updateStats();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_STATS);
+                break;
+            case CHANGE_AGILITY:
+                modify(eager.agility);
+                modify(deferred.agility);
+                eager.updateStats();
+                eager.updateChances();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
+                break;
+            case CHANGE_HASTE:
+                modify(eager.haste);
+                modify(deferred.haste);
+                eager.updateAttackSpeed();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_ATTACK_SPEED);
+                break;
+            case CHANGE_CRIT_RATING:
+                modify(eager.critRating);
+                modify(deferred.critRating);
+                eager.updateChances();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
+                break;
+            case CHANGE_WEAPON_DAMAGE:
+                modify(eager.weaponDamage);
+                modify(deferred.weaponDamage);
+                eager.calcDamage();
+                deferred.markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
+                break;
+            case CHANGE_RESISTANCE:
+            {
+                const uint32_t school = value % schoolCount;
+                modify(eager.resistanceMods[school]);
+                modify(deferred.resistanceMods[school]);
+                eager.calcResistance(school);
+                deferred.markStatsDirty(UnitDirtyStats::getResistanceFlag(school));
+                break;
+            }
+            case CHANGE_READ:
+                deferred.flushDirtyStats();
+                return eager.maxHealth == deferred.maxHealth;
+            case CHANGE_DAMAGE_TAKEN:
+                deferred.flushDirtyStats();
+                eager.health -= std::min(eager.health, amount * 10);
+                deferred.health -= std::min(deferred.health, amount * 10);
+                break;
+            case CHANGE_HEAL:
+                deferred.flushDirtyStats();
+                eager.health = std::min(eager.health + amount * 10, eager.maxHealth);
+                deferred.health = std::min(deferred.health + amount * 10, deferred.maxHealth);
+                break;
+            default:
+                break;
+        }
+
+        return true;
+    }
+
+    /// the derived stats besides the health
+    bool sameDerivedStats(const ModelPlayer& eager, const ModelPlayer& deferred)
+    {
+        return eager.maxHealth == deferred.maxHealth && eager.attackPower == deferred.attackPower && eager.attackTime == deferred.attackTime &&
+            eager.dodge == deferred.dodge && eager.crit == deferred.crit && eager.damage == deferred.damage &&
+            std::equal(eager.resistances, eager.resistances + schoolCount, deferred.resistances);
+    }
+
+    // ticks of up to 30 changes, e.g. a raid buff round or a gear swap, against the eager
+    // calculations after every change
+    void testRandomTicks(uint32_t& state)
+    {
+        UnitDirtyStats dirtyStats;
+        ModelPlayer eager(nullptr);
+        ModelPlayer deferred(&dirtyStats);
+
+        for (uint32_t tick = 0; tick < 20000; ++tick)
+        {
+            const uint32_t changes = nextRandom(state) % 31;
+            for (uint32_t i = 0; i < changes; ++i)
+            {
+                const uint32_t change = nextRandom(state) % CHANGE_COUNT;
+                TEST_CHECK(applyChange(eager, deferred, change, nextRandom(state)));
+
+                // a read in the tick sees the derived stats of the eager calculations
+                if (change == CHANGE_READ || change == CHANGE_HEAL || change == CHANGE_DAMAGE_TAKEN)
+                    TEST_CHECK(sameDerivedStats(eager, deferred));
+            }
+
+            // MapMgr::_UpdateDirtyStats
+            deferred.flushDirtyStats();
+
+            TEST_CHECK(!dirtyStats.isDirty());
+            TEST_CHECK(sameDerivedStats(eager, deferred));
+
+            // the eager calculations clamp the health to every max health in between, the
+            // deferred one only to the max health at the end of the tick, e.g. a stamina buff
+            // replaced by a bigger one costs no health anymore
+            TEST_CHECK(deferred.health <= deferred.maxHealth);
+            TEST_CHECK(eager.health <= deferred.health);
+
+            eager.health = deferred.health;
+        }
+
+        TEST_CHECK(deferred.updateStatsCalls < eager.updateStatsCalls);
+        std::printf("UnitDirtyStatsTest : UpdateStats called %u times eager, %u times deferred\n", eager.updateStatsCalls, deferred.updateStatsCalls);
+    }
+
+    // a mark raised by a calculation is applied right away and leaves no flags behind
+    void testMarkWhileRecalculating()
+    {
+        UnitDirtyStats dirtyStats;
+        ModelPlayer deferred(&dirtyStats);
+
+        deferred.agility += 100;
+        deferred.markStatsDirty(UNIT_STAT_DIRTY_STATS);
+        TEST_CHECK(dirtyStats.getFlags() == UNIT_STAT_DIRTY_STATS);
+
+        deferred.flushDirtyStats();
+        TEST_CHECK(!dirtyStats.isDirty());
+        TEST_CHECK(deferred.resistances[0] == deferred.agility * 2);
+    }
+
+    // every flag runs its calculation once, however often it was marked
+    void testCoalescing()
+    {
+        UnitDirtyStats dirtyStats;
+        ModelPlayer deferred(&dirtyStats);
+        const uint32_t calls = deferred.updateStatsCalls;
+
+        TEST_CHECK(dirtyStats.mark(UNIT_STAT_DIRTY_STATS));
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            ++deferred.stamina;
+            TEST_CHECK(!dirtyStats.mark(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES));
+        }
+
+        deferred.flushDirtyStats();
+        TEST_CHECK(deferred.updateStatsCalls == calls + 1);
+        TEST_CHECK(deferred.maxHealth == 100 + deferred.stamina * 10);
+
+        // nothing marked, nothing calculated
+        deferred.flushDirtyStats();
+        TEST_CHECK(deferred.updateStatsCalls == calls + 1);
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x2545F491;
+
+    testRandomTicks(state);
+    testMarkWhileRecalculating();
+    testCoalescing();
+
+    std::printf("UnitDirtyStatsTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
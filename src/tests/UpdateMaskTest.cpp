@@ -0,0 +1,226 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "CommonTypes.hpp"
+#include "UpdateMask.h"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+// ARCEMU_ASSERT of UpdateMask, the world executable has it in WUtil.cpp
+void Arcemu::Util::ArcemuAssert(bool condition)
+{
+    TEST_CHECK(condition);
+}
+
+namespace
+{
+    // lengths around the 4 and 8 lane widths and the 32 bit mask words, and the WotLK
+    // gameobject, unit and player field counts
+    const uint32_t counts[] = { 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 36, 40, 63, 64, 65, 95, 97, 127, 129, 18, 148, 1326 };
+
+    const UpdateMaskKernels::KernelSet kernelSets[] = { UpdateMaskKernels::KERNELS_SCALAR, UpdateMaskKernels::KERNELS_SSE2, UpdateMaskKernels::KERNELS_AVX2 };
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // about every third value is set, like the fields of a spawned object
+    std::vector<uint32_t> createValues(uint32_t count, uint32_t& state)
+    {
+        std::vector<uint32_t> values(count);
+        for (uint32_t i = 0; i < count; ++i)
+            values[i] = nextRandom(state) % 3 == 0 ? nextRandom(state) | 1 : 0;
+
+        return values;
+    }
+
+    uint32_t getBlocks(uint32_t count)
+    {
+        return (count + 31) >> 5;
+    }
+
+    // one field at a time, like Object did before the kernels
+    std::vector<uint32_t> setNonZeroBitsReference(const std::vector<uint32_t>& values, const uint32_t* filter, std::vector<uint32_t> mask)
+    {
+        for (uint32_t i = 0; i < values.size(); ++i)
+        {
+            if (values[i] != 0 && (filter == nullptr || (filter[i >> 5] >> (i & 31)) & 1))
+                mask[i >> 5] |= 1u << (i & 31);
+        }
+
+        return mask;
+    }
+
+    void testKernels(uint32_t count, uint32_t& state)
+    {
+        const std::vector<uint32_t> values = createValues(count, state);
+
+        // bits above count must stay as they are, so are the bits already set
+        std::vector<uint32_t> initial(getBlocks(count));
+        std::vector<uint32_t> filter(getBlocks(count));
+        for (uint32_t word = 0; word < initial.size(); ++word)
+        {
+            initial[word] = nextRandom(state) & nextRandom(state);
+            filter[word] = nextRandom(state);
+        }
+
+        const std::vector<uint32_t> expected = setNonZeroBitsReference(values, nullptr, initial);
+        const std::vector<uint32_t> expectedFiltered = setNonZeroBitsReference(values, filter.data(), initial);
+
+        for (UpdateMaskKernels::KernelSet kernelSet : kernelSets)
+        {
+            if (!UpdateMaskKernels::isKernelSetSupported(kernelSet))
+                continue;
+
+            std::vector<uint32_t> mask(initial);
+            UpdateMaskKernels::setNonZeroBits(kernelSet, values.data(), count, nullptr, mask.data());
+            TEST_CHECK(mask == expected);
+
+            std::vector<uint32_t> filtered(initial);
+            UpdateMaskKernels::setNonZeroBits(kernelSet, values.data(), count, filter.data(), filtered.data());
+            TEST_CHECK(filtered == expectedFiltered);
+        }
+    }
+
+    void testUpdateMask(uint32_t count, uint32_t& state)
+    {
+        const std::vector<uint32_t> values = createValues(count, state);
+
+        UpdateMask filter;
+        filter.SetCount(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (nextRandom(state) & 1)
+                filter.SetBit(i);
+        }
+
+        UpdateMask mask;
+        mask.SetCount(count);
+        mask.SetNonZeroBits(values.data());
+
+        UpdateMask filtered;
+        filtered.SetCount(count);
+        filtered.SetNonZeroBits(values.data(), filter);
+
+        uint32_t below = 0;
+        uint32_t filteredBelow = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            TEST_CHECK(mask.GetSetBitCountBelow(i) == below);
+            TEST_CHECK(filtered.GetSetBitCountBelow(i) == filteredBelow);
+
+            TEST_CHECK(mask.GetBit(i) == (values[i] != 0));
+            TEST_CHECK(filtered.GetBit(i) == (values[i] != 0 && filter.GetBit(i)));
+
+            below += mask.GetBit(i) ? 1 : 0;
+            filteredBelow += filtered.GetBit(i) ? 1 : 0;
+        }
+
+        TEST_CHECK(mask.GetSetBitCount(mask.GetBlockCount()) == below);
+        TEST_CHECK(filtered.GetSetBitCount(filtered.GetBlockCount()) == filteredBelow);
+
+        // the padding bits of the last word are never set
+        if (count & 31)
+            TEST_CHECK((mask.GetBlocks()[mask.GetBlockCount() - 1] >> (count & 31)) == 0);
+    }
+
+    // the create mask of a player, unit and gameobject sized value array, the player also
+    // filtered by a visible field mask like Player::_SetCreateBits does for other players,
+    // scalar kernel against every vector kernel set the cpu supports
+    void benchmarkKernels(uint32_t& state)
+    {
+        const uint32_t iterations = 200000;
+
+        struct ObjectSize
+        {
+            const char* name;
+            uint32_t count;
+            bool filtered;
+        };
+
+        const ObjectSize sizes[] =
+        {
+            { "player", 1326, false },
+            { "player, visible fields", 1326, true },
+            { "unit", 148, false },
+            { "gameobject", 18, false }
+        };
+
+        typedef std::chrono::steady_clock Clock;
+
+        for (const ObjectSize& size : sizes)
+        {
+            const uint32_t blocks = getBlocks(size.count);
+            const std::vector<uint32_t> values = createValues(size.count, state);
+
+            std::vector<uint32_t> filter(blocks);
+            for (uint32_t word = 0; word < blocks; ++word)
+                filter[word] = nextRandom(state);
+
+            const uint32_t* filterBlocks = size.filtered ? filter.data() : nullptr;
+            std::vector<uint32_t> mask(blocks);
+
+            auto run = [&](UpdateMaskKernels::KernelSet kernelSet, uint64_t& checksum) -> double
+            {
+                checksum = 0;
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < iterations; ++i)
+                {
+                    memset(mask.data(), 0, blocks * sizeof(uint32_t));
+                    UpdateMaskKernels::setNonZeroBits(kernelSet, values.data(), size.count, filterBlocks, mask.data());
+                    checksum += mask[i % blocks];
+                }
+
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+            };
+
+            uint64_t scalarChecksum;
+            const double scalarTime = run(UpdateMaskKernels::KERNELS_SCALAR, scalarChecksum);
+
+            for (UpdateMaskKernels::KernelSet kernelSet : kernelSets)
+            {
+                if (kernelSet == UpdateMaskKernels::KERNELS_SCALAR || !UpdateMaskKernels::isKernelSetSupported(kernelSet))
+                    continue;
+
+                uint64_t checksum;
+                const double time = run(kernelSet, checksum);
+                TEST_CHECK(checksum == scalarChecksum);
+
+                std::printf("UpdateMaskTest : %s (%u fields): scalar %.1f ns, %s %.1f ns\n", size.name, size.count, scalarTime,
+                    UpdateMaskKernels::getKernelSetName(kernelSet), time);
+            }
+        }
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x2545F491;
+
+    for (uint32_t count : counts)
+    {
+        // a few value patterns per length
+        for (uint32_t round = 0; round < 8; ++round)
+        {
+            testKernels(count, state);
+            testUpdateMask(count, state);
+        }
+    }
+
+    benchmarkKernels(state);
+
+    std::printf("UpdateMaskTest : %s kernels selected, %s\n", UpdateMaskKernels::getKernelSetName(),
+        testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
@@ -0,0 +1,198 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "WordFilterAutomaton.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // lower case words over a small alphabet, so patterns overlap and share prefixes
+    std::string randomWord(uint32_t& state, uint32_t minLength, uint32_t maxLength)
+    {
+        const uint32_t length = minLength + nextRandom(state) % (maxLength - minLength + 1);
+
+        std::string word;
+        for (uint32_t i = 0; i < length; ++i)
+            word += static_cast<char>('a' + nextRandom(state) % 12);
+
+        return word;
+    }
+
+    std::vector<std::string> randomMessages(uint32_t& state, uint32_t count)
+    {
+        std::vector<std::string> messages;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::string message;
+            const uint32_t words = 1 + nextRandom(state) % 12;
+            for (uint32_t w = 0; w < words; ++w)
+                message += randomWord(state, 1, 8) + ' ';
+
+            messages.push_back(message);
+        }
+
+        return messages;
+    }
+
+    // the filters before the automaton: every literal searched on its own
+    uint64_t countNaive(const std::vector<std::string>& patterns, const std::string& message)
+    {
+        uint64_t count = 0;
+        for (std::vector<std::string>::const_iterator itr = patterns.begin(); itr != patterns.end(); ++itr)
+        {
+            for (size_t pos = message.find(*itr); pos != std::string::npos; pos = message.find(*itr, pos + 1))
+                ++count;
+        }
+
+        return count;
+    }
+
+    uint64_t countAutomaton(const WordFilterAutomaton& automaton, const std::string& message)
+    {
+        uint64_t count = 0;
+        automaton.search(message.c_str(), message.length(), [&count](uint32_t, size_t)
+        {
+            ++count;
+            return true;
+        });
+
+        return count;
+    }
+
+    void testRequiredLiteral()
+    {
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("badword") == "badword");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("colou?r") == "colo");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("[abc]defg") == "defg");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("x{2,3}yyy") == "yyy");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("gold\\d+sellers") == "sellers");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("www\\.gold") == "www.gold");
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("a|b").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("(ab)+").empty());
+
+        // the arguments of escapes are no characters of the message
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\x41ccount").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\x{263a}smile").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\0123abc").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("(a)\\1bcd").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\cAbcde").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\p{Lu}pper").empty());
+        TEST_CHECK(WordFilterAutomaton::getRequiredLiteral("\\Q.*\\Ebad").empty());
+
+        TEST_CHECK(WordFilterAutomaton::isLiteralExpression("badword"));
+        TEST_CHECK(!WordFilterAutomaton::isLiteralExpression("bad\\x41"));
+        TEST_CHECK(!WordFilterAutomaton::isLiteralExpression("colou?r"));
+    }
+
+    // every occurrence of every pattern, overlapping and duplicate ones included
+    void testAgainstNaive(uint32_t& state)
+    {
+        for (uint32_t round = 0; round < 200; ++round)
+        {
+            std::vector<std::string> patterns;
+            WordFilterAutomaton automaton;
+
+            const uint32_t patternCount = 1 + nextRandom(state) % 40;
+            for (uint32_t i = 0; i < patternCount; ++i)
+            {
+                patterns.push_back(randomWord(state, 1, 6));
+                automaton.addPattern(patterns.back(), i);
+            }
+
+            automaton.build();
+
+            const std::vector<std::string> messages = randomMessages(state, 20);
+            for (std::vector<std::string>::const_iterator itr = messages.begin(); itr != messages.end(); ++itr)
+            {
+                uint64_t naiveCount = 0;
+                std::vector<uint32_t> naiveHits(patternCount, 0);
+                for (uint32_t i = 0; i < patternCount; ++i)
+                {
+                    for (size_t pos = itr->find(patterns[i]); pos != std::string::npos; pos = itr->find(patterns[i], pos + 1))
+                    {
+                        ++naiveHits[i];
+                        ++naiveCount;
+                    }
+                }
+
+                std::vector<uint32_t> hits(patternCount, 0);
+                bool endsMatch = true;
+                automaton.search(itr->c_str(), itr->length(), [&](uint32_t id, size_t end)
+                {
+                    ++hits[id];
+                    endsMatch = endsMatch && end >= patterns[id].length() && itr->compare(end - patterns[id].length(), patterns[id].length(), patterns[id]) == 0;
+                    return true;
+                });
+
+                TEST_CHECK(hits == naiveHits);
+                TEST_CHECK(endsMatch);
+                TEST_CHECK(countAutomaton(automaton, *itr) == naiveCount);
+            }
+        }
+    }
+
+    // one pass over a message against a find per pattern, with the filter sizes of big realms
+    void benchmarkThroughput(uint32_t& state, uint32_t patternCount)
+    {
+        std::vector<std::string> patterns;
+        WordFilterAutomaton automaton;
+        for (uint32_t i = 0; i < patternCount; ++i)
+        {
+            patterns.push_back(randomWord(state, 5, 10));
+            automaton.addPattern(patterns.back(), i);
+        }
+
+        automaton.build();
+
+        const std::vector<std::string> messages = randomMessages(state, 2000);
+
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point naiveStart = Clock::now();
+        uint64_t naiveCount = 0;
+        for (std::vector<std::string>::const_iterator itr = messages.begin(); itr != messages.end(); ++itr)
+            naiveCount += countNaive(patterns, *itr);
+        const double naiveTime = std::chrono::duration<double, std::micro>(Clock::now() - naiveStart).count();
+
+        const Clock::time_point automatonStart = Clock::now();
+        uint64_t automatonCount = 0;
+        for (std::vector<std::string>::const_iterator itr = messages.begin(); itr != messages.end(); ++itr)
+            automatonCount += countAutomaton(automaton, *itr);
+        const double automatonTime = std::chrono::duration<double, std::micro>(Clock::now() - automatonStart).count();
+
+        TEST_CHECK(automatonCount == naiveCount);
+
+        std::printf("WordFilterTest : %u patterns, %u messages, %llu matches: find per pattern %.2f us/message, automaton %.2f us/message\n",
+            patternCount, static_cast<uint32_t>(messages.size()), static_cast<unsigned long long>(automatonCount),
+            naiveTime / messages.size(), automatonTime / messages.size());
+    }
+}
+
+int main()
+{
+    uint32_t state = 0x9E3779B9;
+
+    testRequiredLiteral();
+    testAgainstNaive(state);
+    benchmarkThroughput(state, 1000);
+    benchmarkThroughput(state, 10000);
+
+    std::printf("WordFilterTest : %s\n", testFailures() == 0 ? "all checks passed" : "checks failed");
+
+    return testFailures();
+}
@@ -38,6 +38,7 @@
 
 #include "adt.h"
 #include "wdt.h"
+#include "BuildManifest.hpp"
 #include <fcntl.h>
 
 #if defined( __GNUC__ )
@@ -71,6 +72,7 @@ uint16 *LiqType;
 char output_path[128] = ".";
 char input_path[128] = ".";
 uint32 maxAreaId = 0;
+uint32 maxLiquidTypeId = 0;
 
 // **************************************************
 // Extractor options
@@ -95,6 +97,9 @@ float CONF_float_to_int16_limit = 2048.0f;   // Max accuracy = val/65536
 float CONF_flat_height_delta_limit = 0.005f; // If max - min less this value - surface is flat
 float CONF_flat_liquid_delta_limit = 0.001f; // If max - min less this value - liquid surface is flat
 
+// Only report the map files whose adt or settings changed since they were extracted
+bool  CONF_verify = false;
+
 uint32 CONF_TargetBuild = 15595;              // 4.3.4.15595
 
                                               // List MPQ for extract maps from
@@ -175,6 +180,8 @@ void Usage(char const* prg)
         "-e extract only MAP(1)/DBC(2) - standard: both(3)\n"\
         "-f height stored as int (less map size but lost some accuracy) 1 by default\n"\
         "-b target build (default %u)\n"\
+        "--verify list the map files which are outdated, nothing is extracted\n"\
+        "Only changed map files are extracted again, delete maps/manifest.txt to extract all of them\n"\
         "Example: %s -f 0 -i \"c:\\games\\game\"", prg, CONF_TargetBuild, prg);
     exit(1);
 }
@@ -189,6 +196,13 @@ void HandleArgs(int argc, char* arg[])
         // f - use float to int conversion
         // h - limit minimum height
         // b - target client build
+        // --verify - list outdated map files
+        if (strcmp(arg[c], "--verify") == 0)
+        {
+            CONF_verify = true;
+            continue;
+        }
+
         if (arg[c][0] != '-')
             Usage(arg[0]);
 
@@ -364,6 +378,8 @@ void ReadLiquidTypeTableDBC()
     for (uint32 x = 0; x < liqTypeCount; ++x)
         LiqType[dbc.getRecord(x).getUInt(0)] = dbc.getRecord(x).getUInt(3);
 
+    maxLiquidTypeId = dbc.getMaxId();
+
     SFileCloseFile(dbcFile);
     printf("Done! (%u LiqTypes loaded)\n", (uint32)liqTypeCount);
 }
@@ -464,13 +480,8 @@ uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
 bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
 float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
 
-bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
+bool ConvertADT(ADT_file& adt, char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
 {
-    ADT_file adt;
-
-    if (!adt.loadFile(WorldMpq, filename))
-        return false;
-
     memset(liquid_show, 0, sizeof(liquid_show));
     memset(liquid_flags, 0, sizeof(liquid_flags));
     memset(liquid_entry, 0, sizeof(liquid_entry));
@@ -1014,11 +1025,38 @@ bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/,
     return true;
 }
 
-void ExtractMapsFromMpq(uint32 build)
+// Everything besides the adt which changes the converted map files
+BuildHash GetMapSettingsHash(uint32 build)
+{
+    BuildHash hash;
+    hash.addString(MAP_MAGIC);
+    hash.addString(MAP_VERSION_MAGIC);
+    hash.add(build);
+
+    hash.add(CONF_allow_height_limit);
+    hash.add(CONF_use_minHeight);
+    hash.add(CONF_allow_float_to_int);
+    hash.add(CONF_float_to_int8_limit);
+    hash.add(CONF_float_to_int16_limit);
+    hash.add(CONF_flat_height_delta_limit);
+    hash.add(CONF_flat_liquid_delta_limit);
+
+    // area flags and liquid types are copied from the dbc files
+    hash.add(maxAreaId);
+    hash.addBytes(areas, (maxAreaId + 1) * sizeof(uint16));
+    hash.add(maxLiquidTypeId);
+    hash.addBytes(LiqType, (maxLiquidTypeId + 1) * sizeof(uint16));
+
+    return hash;
+}
+
+// Returns false if CONF_verify found outdated map files
+bool ExtractMapsFromMpq(uint32 build)
 {
     char mpq_filename[1024];
     char output_filename[1024];
     char mpq_map_name[1024];
+    char tile_name[32];
 
     printf("Extracting maps...\n");
 
@@ -1031,7 +1069,14 @@ void ExtractMapsFromMpq(uint32 build)
     path += "/maps/";
     CreateDir(path);
 
-    printf("Convert map files\n");
+    // map files are only converted again if their adt or the settings changed
+    BuildManifest manifest(std::string(output_path) + "/maps");
+    manifest.load();
+
+    BuildHash const settingsHash = GetMapSettingsHash(build);
+    uint32 converted = 0, upToDate = 0, outdated = 0;
+
+    printf(CONF_verify ? "Verify map files\n" : "Convert map files\n");
     for (uint32 z = 0; z < map_count; ++z)
     {
         printf("Extract %s (%d/%u)                  \n", map_ids[z].name, z + 1, map_count);
@@ -1049,18 +1094,59 @@ void ExtractMapsFromMpq(uint32 build)
                     continue;
 
                 sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map_ids[z].name, map_ids[z].name, x, y);
-                sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map_ids[z].id, y, x);
-                ConvertADT(mpq_filename, output_filename, y, x, build);
+                sprintf(tile_name, "%03u%02u%02u.map", map_ids[z].id, y, x);
+                sprintf(output_filename, "%s/maps/%s", output_path, tile_name);
+
+                ADT_file adt;
+                if (!adt.loadFile(WorldMpq, mpq_filename))
+                    continue;
+
+                BuildHash hash = settingsHash;
+                hash.addBytes(adt.GetData(), adt.GetDataSize());
+
+                BuildState state = manifest.check(tile_name, hash.get());
+                if (state == BUILD_STATE_UP_TO_DATE)
+                {
+                    ++upToDate;
+                    continue;
+                }
+
+                if (CONF_verify)
+                {
+                    printf("Outdated %s (%s)\n", tile_name, BuildManifest::getStateName(state));
+                    ++outdated;
+                    continue;
+                }
+
+                if (ConvertADT(adt, mpq_filename, output_filename, y, x, build))
+                {
+                    manifest.set(tile_name, hash.get());
+                    ++converted;
+                }
+                else
+                    manifest.erase(tile_name);
             }
 
             // draw progress bar
             printf("Processing........................%d%%\r", (100 * (y + 1)) / WDT_MAP_SIZE);
         }
+
+        // keep the progress if the extractor is stopped
+        if (!CONF_verify)
+            manifest.save();
     }
 
     printf("\n");
+
+    if (CONF_verify)
+        printf("%u map files are outdated, %u are up to date\n", outdated, upToDate);
+    else
+        printf("%u map files converted, %u were up to date\n", converted, upToDate);
+
     delete[] areas;
     delete[] map_ids;
+
+    return outdated == 0;
 }
 
 bool ExtractFile(HANDLE fileInArchive, char const* filename)
@@ -1302,6 +1388,10 @@ int main(int argc, char * arg[])
 
     HandleArgs(argc, arg);
 
+    // only the map files are tracked in the manifest
+    if (CONF_verify)
+        CONF_extract = EXTRACT_MAP;
+
     int FirstLocale = -1;
     uint32 build = 0;
 
@@ -1361,6 +1451,7 @@ int main(int argc, char * arg[])
         return 0;
     }
 
+    bool upToDate = true;
     if (CONF_extract & EXTRACT_MAP)
     {
         printf("Using locale: %s\n", Locales[FirstLocale]);
@@ -1370,12 +1461,12 @@ int main(int argc, char * arg[])
         LoadCommonMPQFiles(build);
 
         // Extract maps
-        ExtractMapsFromMpq(build);
+        upToDate = ExtractMapsFromMpq(build);
 
         // Close MPQs
         SFileCloseArchive(WorldMpq);
         SFileCloseArchive(LocaleMpq);
     }
 
-    return 0;
+    return upToDate ? 0 : 1;
 }
@@ -74,7 +74,8 @@ bool handleArgs(int argc, char** argv,
                bool &bigBaseUnit,
                char* &offMeshInputPath,
                char* &file,
-               int& threads)
+               int& threads,
+               bool &verifyOnly)
 {
     char* param = NULL;
     for (int i = 1; i < argc; ++i)
@@ -197,6 +198,10 @@ bool handleArgs(int argc, char** argv,
         {
             silent = true;
         }
+        else if (strcmp(argv[i], "--verify") == 0)
+        {
+            verifyOnly = true;
+        }
         else if (strcmp(argv[i], "--bigBaseUnit") == 0)
         {
             param = argv[++i];
@@ -252,14 +257,15 @@ int main(int argc, char** argv)
          skipBattlegrounds = false,
          debugOutput = false,
          silent = false,
-         bigBaseUnit = false;
+         bigBaseUnit = false,
+         verifyOnly = false;
     char* offMeshInputPath = NULL;
     char* file = NULL;
 
     bool validParam = handleArgs(argc, argv, mapnum,
                                  tileX, tileY, maxAngle,
                                  skipLiquid, skipContinents, skipJunkMaps, skipBattlegrounds,
-                                 debugOutput, silent, bigBaseUnit, offMeshInputPath, file, threads);
+                                 debugOutput, silent, bigBaseUnit, offMeshInputPath, file, threads, verifyOnly);
 
     if (!validParam)
         return silent ? -1 : finish("You have specified invalid parameters", -1);
@@ -280,7 +286,19 @@ int main(int argc, char** argv)
         return silent ? -3 : finish("Press ENTER to close...", -3);
 
     MapBuilder builder(maxAngle, skipLiquid, skipContinents, skipJunkMaps,
-                       skipBattlegrounds, debugOutput, bigBaseUnit, offMeshInputPath);
+                       skipBattlegrounds, debugOutput, bigBaseUnit, offMeshInputPath, verifyOnly);
+
+    // lists the tiles whose inputs changed since they were built, nothing is written
+    if (verifyOnly)
+    {
+        if (mapnum >= 0)
+            builder.buildMap(uint32(mapnum));
+        else
+            builder.buildAllMaps(threads);
+
+        printf("%u tiles are outdated.\n", builder.getOutdatedTileCount());
+        return builder.getOutdatedTileCount() ? 1 : 0;
+    }
 
     uint32 start = getMSTime();
     if (file)
@@ -85,7 +85,7 @@ ADTFile::ADTFile(char* filename) : ADT(WorldMpq, filename, false)
     Adtfilename.append(filename);
 }
 
-bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
+bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY, DirFileRecords& dirfile)
 {
     if (ADT.isEof())
         return false;
@@ -107,15 +107,6 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
     //printf("xMap = %s\n", xMap.c_str());
     //printf("yMap = %s\n", yMap.c_str());
 
-    std::string dirname = std::string(szWorkDirWmo) + "/dir_bin";
-    FILE *dirfile;
-    dirfile = fopen(dirname.c_str(), "ab");
-    if (!dirfile)
-    {
-        printf("Can't open dirfile!'%s'\n", dirname.c_str());
-        return false;
-    }
-
     while (!ADT.isEof())
     {
         char fourcc[5];
@@ -218,7 +209,6 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
     }
 
     ADT.close();
-    fclose(dirfile);
     return true;
 }
 
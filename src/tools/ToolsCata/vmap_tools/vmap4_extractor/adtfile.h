@@ -122,7 +122,7 @@ public:
     int nMDX;
     std::string* WmoInstanceNames;
     std::string* ModelInstanceNames;
-    bool init(uint32 map_num, uint32 tileX, uint32 tileY);
+    bool init(uint32 map_num, uint32 tileX, uint32 tileY, DirFileRecords& dirfile);
 };
 
 char const* GetPlainName(char const* FileName);
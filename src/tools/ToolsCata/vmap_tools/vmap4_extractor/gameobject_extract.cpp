@@ -23,8 +23,16 @@
 #include "vmapexport.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
 #include <stdio.h>
 
+// models which are extracted right now, many tiles use the same models
+static std::mutex extractingModelsLock;
+static std::condition_variable extractingModelsCond;
+static std::set<std::string> extractingModels;
+
 bool ExtractSingleModel(std::string& fname)
 {
     if (fname.substr(fname.length() - 4, 4) == ".mdx")
@@ -43,14 +51,29 @@ bool ExtractSingleModel(std::string& fname)
     output += "/";
     output += name;
 
-    if (FileExists(output.c_str()))
-        return true;
+    // only one thread extracts a model, the others wait until the file is complete
+    {
+        std::unique_lock<std::mutex> guard(extractingModelsLock);
+        extractingModelsCond.wait(guard, [&output]() { return extractingModels.find(output) == extractingModels.end(); });
+
+        if (FileExists(output.c_str()))
+            return true;
+
+        extractingModels.insert(output);
+    }
 
+    bool result = false;
     Model mdl(originalName);
-    if (!mdl.open())
-        return false;
+    if (mdl.open())
+        result = mdl.ConvertToVMAPModel(output.c_str());
+
+    {
+        std::lock_guard<std::mutex> guard(extractingModelsLock);
+        extractingModels.erase(output);
+    }
+    extractingModelsCond.notify_all();
 
-    return mdl.ConvertToVMAPModel(output.c_str());
+    return result;
 }
 
 extern HANDLE LocaleMpq;
@@ -20,14 +20,20 @@
 #include "mpqfile.h"
 #include <deque>
 #include <cstdio>
+#include <mutex>
 #include "StormLib.h"
 
+// the archive handles are shared, the vmap extractor reads files from several threads
+static std::mutex gArchiveLock;
+
 MPQFile::MPQFile(HANDLE mpq, const char* filename, bool warnNoExist /*= true*/) :
     eof(false),
     buffer(0),
     pointer(0),
     size(0)
 {
+    std::lock_guard<std::mutex> guard(gArchiveLock);
+
     HANDLE file;
     if (!SFileOpenFileEx(mpq, filename, SFILE_OPEN_PATCHED_FILE, &file))
     {
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <mutex>
 #include <errno.h>
 
 #ifdef WIN32
@@ -116,6 +117,7 @@ uint32 map_count;
 char output_path[128]=".";
 char input_path[1024]=".";
 bool preciseVectorData = false;
+int threadCount = std::max<int>(1, std::thread::hardware_concurrency());
 
 // Constants
 
@@ -281,26 +283,55 @@ void ReadLiquidTypeTableDBC()
     printf("Done! (%u LiqTypes loaded)\n", (unsigned int)LiqType_count);
 }
 
-bool ExtractWmo()
+void GetLocalWmoFile(char const* fname, char* szLocalFile)
 {
-    bool success = false;
+    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, GetPlainName(fname));
+    FixNameCase(szLocalFile, strlen(szLocalFile));
+}
 
+bool ExtractWmo()
+{
     //const char* ParsArchiveNames[] = {"patch-2.MPQ", "patch.MPQ", "common.MPQ", "expansion.MPQ"};
 
+    // the wmo files grouped by the file they are extracted to, in archive order. Every
+    // group is extracted by one thread and its first file which opens wins, like it did
+    // when all files were extracted one after another
+    std::vector<std::vector<std::string> > wmoFiles;
+    std::map<std::string, size_t> localFileGroups;
+
     SFILE_FIND_DATA data;
     HANDLE find = SFileFindFirstFile(WorldMpq, "*.wmo", &data, NULL);
     if (find != NULL)
     {
         do
         {
-            std::string str = data.cFileName;
-            //printf("Extracting wmo %s\n", str.c_str());
-            success |= ExtractSingleWmo(str);
+            char szLocalFile[1024];
+            GetLocalWmoFile(data.cFileName, szLocalFile);
+
+            std::map<std::string, size_t>::iterator group = localFileGroups.find(szLocalFile);
+            if (group == localFileGroups.end())
+            {
+                group = localFileGroups.insert(std::make_pair(std::string(szLocalFile), wmoFiles.size())).first;
+                wmoFiles.push_back(std::vector<std::string>());
+            }
+
+            wmoFiles[group->second].push_back(data.cFileName);
         }
         while (SFileFindNextFile(find, &data));
     }
     SFileFindClose(find);
 
+    std::atomic<bool> success(false);
+    ParallelFor(wmoFiles.size(), [&wmoFiles, &success](size_t group)
+    {
+        for (size_t i = 0; i < wmoFiles[group].size(); ++i)
+        {
+            //printf("Extracting wmo %s\n", wmoFiles[group][i].c_str());
+            if (ExtractSingleWmo(wmoFiles[group][i]))
+                success = true;
+        }
+    });
+
     if (success)
         printf("\nExtract wmo complete (No (fatal) errors)\n");
 
@@ -313,8 +344,7 @@ bool ExtractSingleWmo(std::string& fname)
 
     char szLocalFile[1024];
     const char * plain_name = GetPlainName(fname.c_str());
-    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, plain_name);
-    FixNameCase(szLocalFile,strlen(szLocalFile));
+    GetLocalWmoFile(fname.c_str(), szLocalFile);
 
     if (FileExists(szLocalFile))
         return true;
@@ -388,36 +418,67 @@ bool ExtractSingleWmo(std::string& fname)
     return true;
 }
 
-void ParsMapFiles()
+bool ParsMapFiles()
 {
+    std::string dirname = std::string(szWorkDirWmo) + "/dir_bin";
+    FILE* dirfile = fopen(dirname.c_str(), "ab");
+    if (!dirfile)
+    {
+        printf("Can't open dirfile!'%s'\n", dirname.c_str());
+        return false;
+    }
+
+    bool success = true;
     char fn[512];
     //char id_filename[64];
     char id[10];
-    for (unsigned int i=0; i<map_count; ++i)
+    for (unsigned int i=0; i<map_count && success; ++i)
     {
         sprintf(id,"%03u",map_ids[i].id);
         sprintf(fn,"World\\Maps\\%s\\%s.wdt", map_ids[i].name, map_ids[i].name);
         WDTFile WDT(fn,map_ids[i].name);
-        if(WDT.init(id, map_ids[i].id))
+        DirFileRecords wdtRecords;
+        if(WDT.init(id, map_ids[i].id, wdtRecords))
         {
             printf("Processing Map %u\n[", map_ids[i].id);
-            for (int x=0; x<64; ++x)
+
+            // the tiles are parsed in parallel, one # for every 64 parsed tiles
+            std::vector<DirFileRecords> tileRecords(64 * 64);
+            std::mutex progressLock;
+            uint32 parsedTiles = 0;
+
+            ParallelFor(tileRecords.size(), [&](size_t tile)
             {
-                for (int y=0; y<64; ++y)
+                int x = int(tile / 64);
+                int y = int(tile % 64);
+                if (ADTFile *ADT = WDT.GetMap(x,y))
                 {
-                    if (ADTFile *ADT = WDT.GetMap(x,y))
-                    {
-                        //sprintf(id_filename,"%02u %02u %03u",x,y,map_ids[i].id);//!!!!!!!!!
-                        ADT->init(map_ids[i].id, x, y);
-                        delete ADT;
-                    }
+                    //sprintf(id_filename,"%02u %02u %03u",x,y,map_ids[i].id);//!!!!!!!!!
+                    ADT->init(map_ids[i].id, x, y, tileRecords[tile]);
+                    delete ADT;
                 }
-                printf("#");
-                fflush(stdout);
-            }
+
+                std::lock_guard<std::mutex> guard(progressLock);
+                if (++parsedTiles % 64 == 0)
+                {
+                    printf("#");
+                    fflush(stdout);
+                }
+            });
             printf("]\n");
+
+            success = wdtRecords.appendTo(dirfile);
+            for (size_t tile = 0; tile < tileRecords.size() && success; ++tile)
+                success = tileRecords[tile].appendTo(dirfile);
         }
     }
+
+    fclose(dirfile);
+
+    if (!success)
+        printf("Can't write dirfile!'%s'\n", dirname.c_str());
+
+    return success;
 }
 
 void getGamePath()
@@ -464,6 +525,18 @@ bool processArgv(int argc, char ** argv, const char *versionString)
         {
             preciseVectorData = true;
         }
+        else if(strcmp("-t",argv[i]) == 0)
+        {
+            if((i+1)<argc && atoi(argv[i + 1]) > 0)
+            {
+                threadCount = atoi(argv[i + 1]);
+                ++i;
+            }
+            else
+            {
+                result = false;
+            }
+        }
         else if(strcmp("-b",argv[i]) == 0)
         {
             if (i + 1 < argc)                            // all ok
@@ -479,10 +552,11 @@ bool processArgv(int argc, char ** argv, const char *versionString)
     if(!result)
     {
         printf("Extract %s.\n",versionString);
-        printf("%s [-?][-s][-l][-d <path>]\n", argv[0]);
+        printf("%s [-?][-s][-l][-d <path>][-t <threads>]\n", argv[0]);
         printf("   -s : (default) small size (data size optimization), ~500MB less vmap data.\n");
         printf("   -l : large size, ~500MB more vmap data. (might contain more details)\n");
         printf("   -d <path>: Path to the vector data source folder.\n");
+        printf("   -t <threads>: Number of threads, default is the number of cores. The output is the same for any number.\n");
         printf("   -b : target build (default %u)\n", CONF_TargetBuild);
         printf("   -? : This message.\n");
     }
@@ -527,7 +601,8 @@ int main(int argc, char ** argv)
         }
     }
 
-    printf("Extract %s. Beginning work ....\n\n",versionString);
+    printf("Extract %s. Beginning work ....\n",versionString);
+    printf("Using %d threads\n\n", threadCount);
     //xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
     // Create the working directory
     if (mkdir(szWorkDirWmo
@@ -581,11 +656,12 @@ int main(int argc, char ** argv)
 
 
         delete dbc;
-        ParsMapFiles();
+        success = ParsMapFiles();
         delete [] map_ids;
         //nError = ERROR_SUCCESS;
         // Extract models, listed in GameObjectDisplayInfo.dbc
-        ExtractGameobjectModels();
+        if (success)
+            ExtractGameobjectModels();
     }
 
     SFileCloseArchive(LocaleMpq);
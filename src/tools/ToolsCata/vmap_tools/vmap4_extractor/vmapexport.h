@@ -20,7 +20,12 @@
 #ifndef VMAPEXPORT_H
 #define VMAPEXPORT_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <string>
+#include <thread>
+#include <vector>
 
 enum ModelFlags
 {
@@ -31,6 +36,7 @@ enum ModelFlags
 
 extern const char * szWorkDirWmo;
 extern const char * szRawVMAPMagic;                         // vmap magic string for extracted raw vmap data
+extern int threadCount;                                     // -t, 1 extracts everything on the main thread
 
 bool FileExists(const char * file);
 void strToLower(char* str);
@@ -40,4 +46,55 @@ bool ExtractSingleModel(std::string& fname);
 
 void ExtractGameobjectModels();
 
+// dir_bin records of one WDT or ADT file. The tiles are parsed by several threads, their
+// records are appended to dir_bin in map and tile order afterwards, so dir_bin does not
+// depend on the number of threads.
+class DirFileRecords
+{
+public:
+    void write(const void* data, size_t size, size_t count)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        records.insert(records.end(), bytes, bytes + size * count);
+    }
+
+    bool appendTo(FILE* dirfile) const
+    {
+        return records.empty() || fwrite(&records[0], 1, records.size(), dirfile) == records.size();
+    }
+
+private:
+    std::vector<char> records;
+};
+
+// calls task(0) ... task(count - 1) on threadCount threads and returns after all calls
+// finished, the calls are not ordered
+template<typename Task>
+void ParallelFor(size_t count, Task task)
+{
+    const size_t workerCount = std::min<size_t>(std::max(threadCount, 1), count);
+    if (workerCount <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            task(i);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; ++i)
+        workers.push_back(std::thread(worker));
+
+    worker();
+
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
 #endif  //VMAPEXPORT_H
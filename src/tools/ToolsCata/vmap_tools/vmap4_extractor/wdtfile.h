@@ -35,7 +35,7 @@ private:
 public:
     WDTFile(char* file_name, char* file_name1);
     ~WDTFile(void);
-    bool init(char* map_id, unsigned int mapID);
+    bool init(char* map_id, unsigned int mapID, DirFileRecords& dirfile);
 
     string* gWmoInstansName;
     int gnWMO;
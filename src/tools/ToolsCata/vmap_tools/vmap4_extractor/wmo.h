@@ -39,6 +39,7 @@
 class WMOInstance;
 class WMOManager;
 class MPQFile;
+class DirFileRecords;
 
 /* for whatever reason a certain company just can't stick to one coordinate system... */
 static inline Vec3D fixCoords(const Vec3D &v) {
@@ -133,7 +134,7 @@ public:
     Vec3D pos2, pos3, rot;
     uint32 indx, id, d2, d3;
 
-    WMOInstance(MPQFile&f, char const* WmoInstName, uint32 mapID, uint32 tileX, uint32 tileY, FILE* pDirfile);
+    WMOInstance(MPQFile&f, char const* WmoInstName, uint32 mapID, uint32 tileX, uint32 tileY, DirFileRecords& dirfile);
 
     static void reset();
 };
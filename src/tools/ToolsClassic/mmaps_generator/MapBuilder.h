@@ -21,6 +21,8 @@
 #define _MAP_BUILDER_H
 
 #include "TerrainBuilder.h"
+#include "ModelInstance.h"
+#include "BuildManifest.hpp"
 
 #include "Recast.h"
 #include "DetourNavMesh.h"
@@ -28,6 +30,8 @@
 #include <vector>
 #include <set>
 #include <list>
+#include <map>
+#include <string>
 #include <atomic>
 #include <thread>
 #include <condition_variable>
@@ -171,7 +175,8 @@ namespace MMAP
                 bool skipBattlegrounds   = false,
                 bool debugOutput         = false,
                 bool bigBaseUnit         = false,
-                const char* offMeshFilePath = NULL);
+                const char* offMeshFilePath = NULL,
+                bool verifyOnly          = false);
 
             ~MapBuilder();
 
@@ -185,6 +190,10 @@ namespace MMAP
             // builds list of maps, then builds all of mmap tiles (based on the skip settings)
             void buildAllMaps(int threads);
 
+            // buildMap and buildAllMaps only build the tiles whose inputs changed since the
+            // last run (see mmaps/manifest.txt), in verify mode they only count them
+            uint32 getOutdatedTileCount() const { return m_outdatedTiles; }
+
             void WorkerThread();
 
         private:
@@ -196,6 +205,19 @@ namespace MMAP
 
             void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
 
+            // removes the old tile first, the new inputs may give no tile at all
+            void rebuildTile(uint32 mapID, uint32 tileX, uint32 tileY, uint64 inputHash, dtNavMesh* navMesh);
+
+            void getTileConfig(rcConfig& config) const;
+            void getNavMeshParams(uint32 mapID, dtNavMeshParams& navMeshParams);
+
+            // hash of everything buildTile reads for the tile
+            uint64 getTileInputHash(uint32 mapID, uint32 tileX, uint32 tileY, const dtNavMeshParams& navMeshParams);
+            void addVMapInputs(uint32 mapID, uint32 tileX, uint32 tileY, BuildHash& hash);
+            void addModelInputs(const ModelSpawn& spawn, BuildHash& hash);
+            uint64 getFileHash(const std::string& fileName);
+            static std::string getTileFileName(uint32 mapID, uint32 tileX, uint32 tileY);
+
             // move map building
             void buildMoveMapTile(uint32 mapID,
                 uint32 tileX,
@@ -212,7 +234,6 @@ namespace MMAP
 
             bool shouldSkipMap(uint32 mapID);
             bool isTransportMap(uint32 mapID);
-            bool shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY);
 
             TerrainBuilder* m_terrainBuilder;
             TileList m_tiles;
@@ -230,6 +251,15 @@ namespace MMAP
             // build performance - not really used for now
             rcContext* m_rcContext;
 
+            BuildManifest m_manifest;
+            BuildHash m_settingsHash;
+            bool m_verifyOnly;
+            std::atomic<uint32> m_outdatedTiles;
+
+            // models and the off mesh file are shared by many tiles
+            std::mutex m_fileHashLock;
+            std::map<std::string, uint64> m_fileHashes;
+
             std::vector<std::thread> _workerThreads;
             ProducerConsumerQueue<uint32> _queue;
             std::atomic<bool> _cancelationToken;
@@ -18,28 +18,53 @@
  */
 
 #include <string>
+#include <cstring>
 #include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <vector>
 
 #include "TileAssembler.h"
 
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    bool verifyOnly = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
     {
-        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir>" << std::endl;
+        if (strcmp(argv[i], "--verify") == 0)
+            verifyOnly = true;
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() != 2 && args.size() != 3)
+    {
+        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir> [threads] [--verify]" << std::endl;
+        std::cout << "threads defaults to the number of cores, the output is the same for any number" << std::endl;
+        std::cout << "only maps and models whose raw files changed are converted again, delete manifest.txt" << std::endl;
+        std::cout << "in the dest dir to convert everything. --verify lists the outdated files instead" << std::endl;
         return 1;
     }
 
-    std::string src = argv[1];
-    std::string dest = argv[2];
+    std::string src = args[0];
+    std::string dest = args[1];
+
+    int threads = args.size() == 3 ? atoi(args[2].c_str()) : int(std::thread::hardware_concurrency());
+    if (threads < 1)
+        threads = 1;
 
-    std::cout << "using " << src << " as source directory and writing output to " << dest << std::endl;
+    if (verifyOnly)
+        std::cout << "verifying " << dest << " against the source directory " << src << std::endl;
+    else
+        std::cout << "using " << src << " as source directory and writing output to " << dest << " with " << threads << " threads" << std::endl;
 
     VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
+    ta->setVerifyOnly(verifyOnly);
 
-    if (!ta->convertWorld2())
+    if (!ta->convertWorld2(threads))
     {
-        std::cout << "exit with errors" << std::endl;
+        std::cout << (verifyOnly ? "vmaps are outdated" : "exit with errors") << std::endl;
         delete ta;
         return 1;
     }
@@ -26,6 +26,7 @@
 #include <vector>
 
 class MPQFile;
+class DirFileRecords;
 
 Vec3D fixCoordSystem(Vec3D v);
 
@@ -61,7 +62,7 @@ public:
     float sc;
 
     ModelInstance() : id(0), scale(0), flags(0), sc(0.0f) {}
-    ModelInstance(MPQFile& f, char const* ModelInstName, uint32 mapID, uint32 tileX, uint32 tileY, FILE* pDirfile);
+    ModelInstance(MPQFile& f, char const* ModelInstName, uint32 mapID, uint32 tileX, uint32 tileY, DirFileRecords& dirfile);
 
 };
 
@@ -20,6 +20,8 @@
 #include "PathCommon.h"
 #include "MapBuilder.h"
 #include "MapTree.h"
+#include "VMapManager2.h"
+#include "VMapDefinitions.h"
 
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMesh.h"
@@ -46,7 +48,7 @@ namespace MMAP
 {
     MapBuilder::MapBuilder(float maxWalkableAngle, bool skipLiquid,
         bool skipContinents, bool skipJunkMaps, bool skipBattlegrounds,
-        bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath) :
+        bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath, bool verifyOnly) :
         m_terrainBuilder     (NULL),
         m_debugOutput        (debugOutput),
         m_offMeshFilePath    (offMeshFilePath),
@@ -56,12 +58,26 @@ namespace MMAP
         m_maxWalkableAngle   (maxWalkableAngle),
         m_bigBaseUnit        (bigBaseUnit),
         m_rcContext          (NULL),
+        m_manifest           ("mmaps"),
+        m_verifyOnly         (verifyOnly),
+        m_outdatedTiles      (0),
         _cancelationToken    (false)
     {
         m_terrainBuilder = new TerrainBuilder(skipLiquid);
 
         m_rcContext = new rcContext(false);
 
+        // everything besides the tile inputs which changes the tiles
+        rcConfig config;
+        getTileConfig(config);
+        m_settingsHash.add(MMAP_MAGIC);
+        m_settingsHash.add(MMAP_VERSION);
+        m_settingsHash.add(DT_NAVMESH_VERSION);
+        m_settingsHash.addBytes(&config, sizeof(rcConfig));
+        m_settingsHash.add(m_terrainBuilder->usesLiquids());
+
+        m_manifest.load();
+
         discoverTiles();
     }
 
@@ -86,7 +102,7 @@ namespace MMAP
         char filter[12];
 
         printf("Discovering maps... ");
-        getDirContents(files, "maps");
+        getDirContents(files, "maps", "*.map");
         for (uint32 i = 0; i < files.size(); ++i)
         {
             mapID = uint32(atoi(files[i].substr(0,3).c_str()));
@@ -353,8 +369,13 @@ namespace MMAP
             return;
         }
 
-        buildTile(mapID, tileX, tileY, navMesh);
+        dtNavMeshParams navMeshParams;
+        getNavMeshParams(mapID, navMeshParams);
+
+        rebuildTile(mapID, tileX, tileY, getTileInputHash(mapID, tileX, tileY, navMeshParams), navMesh);
         dtFreeNavMesh(navMesh);
+
+        m_manifest.save();
     }
 
     /**************************************************************************/
@@ -381,6 +402,36 @@ namespace MMAP
 
         if (!tiles->empty())
         {
+            dtNavMeshParams navMeshParams;
+            getNavMeshParams(mapID, navMeshParams);
+
+            // find the outdated tiles first, an up to date map is not touched at all
+            std::vector<std::pair<uint32, uint64> > outdatedTiles;
+            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+            {
+                uint32 tileX, tileY;
+
+                // unpack tile coords
+                StaticMapTree::unpackTileID((*it), tileX, tileY);
+
+                uint64 inputHash = getTileInputHash(mapID, tileX, tileY, navMeshParams);
+                BuildState state = m_manifest.check(getTileFileName(mapID, tileX, tileY), inputHash);
+                if (state == BUILD_STATE_UP_TO_DATE)
+                    continue;
+
+                if (m_verifyOnly)
+                    printf("[Map %03i] Outdated tile [%02u,%02u] (%s)\n", mapID, tileX, tileY, BuildManifest::getStateName(state));
+
+                outdatedTiles.push_back(std::make_pair(*it, inputHash));
+            }
+
+            m_outdatedTiles += uint32(outdatedTiles.size());
+            if (m_verifyOnly || outdatedTiles.empty())
+            {
+                printf("[Map %03i] %u of %u tiles are outdated.\n", mapID, uint32(outdatedTiles.size()), uint32(tiles->size()));
+                return;
+            }
+
             // build navMesh
             dtNavMesh* navMesh = NULL;
             buildNavMesh(mapID, navMesh);
@@ -391,26 +442,45 @@ namespace MMAP
             }
 
             // now start building mmtiles for each tile
-            printf("[Map %03i] We have %u tiles.                          \n", mapID, (unsigned int)tiles->size());
-            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+            printf("[Map %03i] We have %u tiles, %u are outdated.             \n", mapID, (unsigned int)tiles->size(), (unsigned int)outdatedTiles.size());
+            for (std::vector<std::pair<uint32, uint64> >::iterator it = outdatedTiles.begin(); it != outdatedTiles.end(); ++it)
             {
                 uint32 tileX, tileY;
 
                 // unpack tile coords
-                StaticMapTree::unpackTileID((*it), tileX, tileY);
+                StaticMapTree::unpackTileID(it->first, tileX, tileY);
 
-                if (shouldSkipTile(mapID, tileX, tileY))
-                    continue;
-
-                buildTile(mapID, tileX, tileY, navMesh);
+                rebuildTile(mapID, tileX, tileY, it->second, navMesh);
             }
 
             dtFreeNavMesh(navMesh);
+
+            // keep the progress if the generator is stopped
+            m_manifest.save();
         }
 
         printf("[Map %03i] Complete!\n", mapID);
     }
 
+    /**************************************************************************/
+    void MapBuilder::rebuildTile(uint32 mapID, uint32 tileX, uint32 tileY, uint64 inputHash, dtNavMesh* navMesh)
+    {
+        const std::string fileName = getTileFileName(mapID, tileX, tileY);
+        const std::string path = "mmaps/" + fileName;
+        remove(path.c_str());
+
+        buildTile(mapID, tileX, tileY, navMesh);
+
+        bool written = false;
+        if (FILE* file = fopen(path.c_str(), "rb"))
+        {
+            written = true;
+            fclose(file);
+        }
+
+        m_manifest.set(fileName, inputHash, written);
+    }
+
     /**************************************************************************/
     void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
     {
@@ -451,7 +521,7 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildNavMesh(uint32 mapID, dtNavMesh* &navMesh)
+    void MapBuilder::getNavMeshParams(uint32 mapID, dtNavMeshParams& navMeshParams)
     {
         std::set<uint32>* tiles = getTileList(mapID);
 
@@ -488,16 +558,22 @@ namespace MMAP
         float bmin[3], bmax[3];
         getTileBounds(tileXMax, tileYMax, NULL, 0, bmin, bmax);
 
-        /***       now create the navmesh       ***/
-
         // navmesh creation params
-        dtNavMeshParams navMeshParams;
         memset(&navMeshParams, 0, sizeof(dtNavMeshParams));
         navMeshParams.tileWidth = GRID_SIZE;
         navMeshParams.tileHeight = GRID_SIZE;
         rcVcopy(navMeshParams.orig, bmin);
         navMeshParams.maxTiles = maxTiles;
         navMeshParams.maxPolys = maxPolysPerTile;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildNavMesh(uint32 mapID, dtNavMesh* &navMesh)
+    {
+        /***       now create the navmesh       ***/
+
+        dtNavMeshParams navMeshParams;
+        getNavMeshParams(mapID, navMeshParams);
 
         navMesh = dtAllocNavMesh();
         printf("[Map %03i] Creating navMesh...\n", mapID);
@@ -559,29 +635,11 @@ namespace MMAP
         const static int TILES_PER_MAP = VERTEX_PER_MAP/VERTEX_PER_TILE;
 
         rcConfig config;
-        memset(&config, 0, sizeof(rcConfig));
+        getTileConfig(config);
 
         rcVcopy(config.bmin, bmin);
         rcVcopy(config.bmax, bmax);
 
-        config.maxVertsPerPoly = DT_VERTS_PER_POLYGON;
-        config.cs = BASE_UNIT_DIM;
-        config.ch = BASE_UNIT_DIM;
-        config.walkableSlopeAngle = m_maxWalkableAngle;
-        config.tileSize = VERTEX_PER_TILE;
-        config.walkableRadius = m_bigBaseUnit ? 1 : 2;
-        config.borderSize = config.walkableRadius + 3;
-        config.maxEdgeLen = VERTEX_PER_TILE + 1;        // anything bigger than tileSize
-        config.walkableHeight = m_bigBaseUnit ? 3 : 6;
-        // a value >= 3|6 allows npcs to walk over some fences
-        // a value >= 4|8 allows npcs to walk over all fences
-        config.walkableClimb = m_bigBaseUnit ? 4 : 8;
-        config.minRegionArea = rcSqr(60);
-        config.mergeRegionArea = rcSqr(50);
-        config.maxSimplificationError = 1.8f;           // eliminates most jagged edges (tiny polygons)
-        config.detailSampleDist = config.cs * 64;
-        config.detailSampleMaxError = config.ch * 2;
-
         // this sets the dimensions of the heightfield - should maybe happen before border padding
         rcCalcGridSize(config.bmin, config.bmax, config.cs, &config.width, &config.height);
 
@@ -869,6 +927,153 @@ namespace MMAP
         }
     }
 
+    /**************************************************************************/
+    void MapBuilder::getTileConfig(rcConfig& config) const
+    {
+        // see buildMoveMapTile
+        const float baseUnitDim = m_bigBaseUnit ? 0.5333333f : 0.2666666f;
+        const int vertexPerTile = m_bigBaseUnit ? 40 : 80;
+
+        // the bounds and grid size are set per tile
+        memset(&config, 0, sizeof(rcConfig));
+
+        config.maxVertsPerPoly = DT_VERTS_PER_POLYGON;
+        config.cs = baseUnitDim;
+        config.ch = baseUnitDim;
+        config.walkableSlopeAngle = m_maxWalkableAngle;
+        config.tileSize = vertexPerTile;
+        config.walkableRadius = m_bigBaseUnit ? 1 : 2;
+        config.borderSize = config.walkableRadius + 3;
+        config.maxEdgeLen = vertexPerTile + 1;          // anything bigger than tileSize
+        config.walkableHeight = m_bigBaseUnit ? 3 : 6;
+        // a value >= 3|6 allows npcs to walk over some fences
+        // a value >= 4|8 allows npcs to walk over all fences
+        config.walkableClimb = m_bigBaseUnit ? 4 : 8;
+        config.minRegionArea = rcSqr(60);
+        config.mergeRegionArea = rcSqr(50);
+        config.maxSimplificationError = 1.8f;           // eliminates most jagged edges (tiny polygons)
+        config.detailSampleDist = config.cs * 64;
+        config.detailSampleMaxError = config.ch * 2;
+    }
+
+    /**************************************************************************/
+    uint64 MapBuilder::getTileInputHash(uint32 mapID, uint32 tileX, uint32 tileY, const dtNavMeshParams& navMeshParams)
+    {
+        BuildHash hash = m_settingsHash;
+
+        // the tile position is stored relative to the navmesh origin
+        hash.addBytes(navMeshParams.orig, sizeof(navMeshParams.orig));
+
+        // the tile and the borders of its neighbours, see TerrainBuilder::loadMap
+        const int neighbours[5][2] = { { 0, 0 }, { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        for (int i = 0; i < 5; ++i)
+        {
+            char fileName[255];
+            sprintf(fileName, "maps/%03u%02u%02u.map", mapID, tileY + neighbours[i][1], tileX + neighbours[i][0]);
+            hash.addFile(fileName);
+        }
+
+        addVMapInputs(mapID, tileX, tileY, hash);
+
+        if (m_offMeshFilePath)
+            hash.add(getFileHash(m_offMeshFilePath));
+
+        return hash.get();
+    }
+
+    /**************************************************************************/
+    void MapBuilder::addVMapInputs(uint32 mapID, uint32 tileX, uint32 tileY, BuildHash& hash)
+    {
+        // the models TerrainBuilder::loadVMap gets from the vmap tile, the map tree only
+        // matters for the global model of maps without terrain
+        FILE* treeFile = fopen(("vmaps/" + VMapManager2::getMapFileName(mapID)).c_str(), "rb");
+        if (!treeFile)
+        {
+            hash.add(false);
+            return;
+        }
+
+        char chunk[8];
+        char tiled = '\0';
+        bool valid = fread(chunk, sizeof(char), 8, treeFile) == 8 && memcmp(chunk, VMAP_MAGIC, 8) == 0 &&
+            fread(&tiled, sizeof(char), 1, treeFile) == 1;
+
+        hash.add(valid);
+        hash.add(tiled);
+
+        if (valid && !tiled)
+        {
+            BIH tree;
+            ModelSpawn spawn;
+            if (fread(chunk, sizeof(char), 4, treeFile) == 4 && tree.readFromFile(treeFile) &&
+                fread(chunk, sizeof(char), 4, treeFile) == 4 && ModelSpawn::readFromFile(treeFile, spawn))
+                addModelInputs(spawn, hash);
+        }
+
+        fclose(treeFile);
+
+        if (!valid || !tiled)
+            return;
+
+        // same arguments as loadVMap in buildTile
+        FILE* tileFile = fopen(("vmaps/" + StaticMapTree::getTileFileName(mapID, tileY, tileX)).c_str(), "rb");
+        if (!tileFile)
+            return;
+
+        uint32 spawnCount = 0;
+        if (fread(chunk, sizeof(char), 8, tileFile) == 8 && fread(&spawnCount, sizeof(uint32), 1, tileFile) == 1)
+        {
+            hash.add(spawnCount);
+            for (uint32 i = 0; i < spawnCount; ++i)
+            {
+                ModelSpawn spawn;
+                uint32 referencedNode;
+                if (!ModelSpawn::readFromFile(tileFile, spawn) || fread(&referencedNode, sizeof(uint32), 1, tileFile) != 1)
+                    break;
+
+                addModelInputs(spawn, hash);
+            }
+        }
+
+        fclose(tileFile);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::addModelInputs(const ModelSpawn& spawn, BuildHash& hash)
+    {
+        hash.addString(spawn.name);
+        hash.addBytes(&spawn.iPos, sizeof(float) * 3);
+        hash.addBytes(&spawn.iRot, sizeof(float) * 3);
+        hash.add(spawn.iScale);
+        hash.add(getFileHash("vmaps/" + spawn.name + ".vmo"));
+    }
+
+    /**************************************************************************/
+    uint64 MapBuilder::getFileHash(const std::string& fileName)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_fileHashLock);
+            std::map<std::string, uint64>::const_iterator itr = m_fileHashes.find(fileName);
+            if (itr != m_fileHashes.end())
+                return itr->second;
+        }
+
+        BuildHash hash;
+        hash.addFile(fileName);
+
+        std::lock_guard<std::mutex> guard(m_fileHashLock);
+        m_fileHashes[fileName] = hash.get();
+        return hash.get();
+    }
+
+    /**************************************************************************/
+    std::string MapBuilder::getTileFileName(uint32 mapID, uint32 tileX, uint32 tileY)
+    {
+        char fileName[255];
+        sprintf(fileName, "%03u%02i%02i.mmtile", mapID, tileY, tileX);
+        return fileName;
+    }
+
     /**************************************************************************/
     void MapBuilder::getTileBounds(uint32 tileX, uint32 tileY, float* verts, int vertCount, float* bmin, float* bmax)
     {
@@ -981,28 +1186,4 @@ namespace MMAP
         }
     }
 
-    /**************************************************************************/
-    bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY)
-    {
-        char fileName[255];
-        sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
-        FILE* file = fopen(fileName, "rb");
-        if (!file)
-            return false;
-
-        MmapTileHeader header;
-        int count = fread(&header, sizeof(MmapTileHeader), 1, file);
-        fclose(file);
-        if (count != 1)
-            return false;
-
-        if (header.mmapMagic != MMAP_MAGIC || header.dtVersion != uint32(DT_NAVMESH_VERSION))
-            return false;
-
-        if (header.mmapVersion != MMAP_VERSION)
-            return false;
-
-        return true;
-    }
-
 }
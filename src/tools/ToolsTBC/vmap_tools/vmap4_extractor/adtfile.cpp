@@ -80,7 +80,7 @@ ADTFile::ADTFile(char* filename): ADT(filename), nWMO(0), nMDX(0), WmoInstansNam
     Adtfilename.append(filename);
 }
 
-bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
+bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY, DirFileRecords& dirfile)
 {
     if(ADT.isEof ())
         return false;
@@ -97,15 +97,6 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
     yMap = TempMapNumber.substr(TempMapNumber.find_last_of("_")+1,(TempMapNumber.length()) - (TempMapNumber.find_last_of("_")));
     Adtfilename.erase((Adtfilename.length()-xMap.length()-yMap.length()-2), (xMap.length()+yMap.length()+2));
 
-    std::string dirname = std::string(szWorkDirWmo) + "/dir_bin";
-    FILE *dirfile;
-    dirfile = fopen(dirname.c_str(), "ab");
-    if(!dirfile)
-    {
-        printf("Can't open dirfile!'%s'\n", dirname.c_str());
-        return false;
-    }
-
     while (!ADT.isEof())
     {
         char fourcc[5];
@@ -202,7 +193,6 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
         ADT.seek(nextpos);
     }
     ADT.close();
-    fclose(dirfile);
     return true;
 }
 
@@ -482,7 +482,7 @@ WMOGroup::~WMOGroup()
     delete [] LiquBytes;
 }
 
-WMOInstance::WMOInstance(MPQFile& f, char const* WmoInstName, uint32 mapID, uint32 tileX, uint32 tileY, FILE* pDirfile)
+WMOInstance::WMOInstance(MPQFile& f, char const* WmoInstName, uint32 mapID, uint32 tileX, uint32 tileY, DirFileRecords& dirfile)
     : currx(0), curry(0), wmo(NULL), doodadset(0), pos(), indx(0), id(0), d2(0), d3(0)
 {
     float ff[3];
@@ -538,20 +538,20 @@ WMOInstance::WMOInstance(MPQFile& f, char const* WmoInstName, uint32 mapID, uint
     uint32 flags = MOD_HAS_BOUND;
     if(tileX == 65 && tileY == 65) flags |= MOD_WORLDSPAWN;
     //write mapID, tileX, tileY, Flags, ID, Pos, Rot, Scale, Bound_lo, Bound_hi, name
-    fwrite(&mapID, sizeof(uint32), 1, pDirfile);
-    fwrite(&tileX, sizeof(uint32), 1, pDirfile);
-    fwrite(&tileY, sizeof(uint32), 1, pDirfile);
-    fwrite(&flags, sizeof(uint32), 1, pDirfile);
-    fwrite(&adtId, sizeof(uint16), 1, pDirfile);
-    fwrite(&id, sizeof(uint32), 1, pDirfile);
-    fwrite(&pos, sizeof(float), 3, pDirfile);
-    fwrite(&rot, sizeof(float), 3, pDirfile);
-    fwrite(&scale, sizeof(float), 1, pDirfile);
-    fwrite(&pos2, sizeof(float), 3, pDirfile);
-    fwrite(&pos3, sizeof(float), 3, pDirfile);
+    dirfile.write(&mapID, sizeof(uint32), 1);
+    dirfile.write(&tileX, sizeof(uint32), 1);
+    dirfile.write(&tileY, sizeof(uint32), 1);
+    dirfile.write(&flags, sizeof(uint32), 1);
+    dirfile.write(&adtId, sizeof(uint16), 1);
+    dirfile.write(&id, sizeof(uint32), 1);
+    dirfile.write(&pos, sizeof(float), 3);
+    dirfile.write(&rot, sizeof(float), 3);
+    dirfile.write(&scale, sizeof(float), 1);
+    dirfile.write(&pos2, sizeof(float), 3);
+    dirfile.write(&pos3, sizeof(float), 3);
     uint32 nlen=strlen(WmoInstName);
-    fwrite(&nlen, sizeof(uint32), 1, pDirfile);
-    fwrite(WmoInstName, sizeof(char), nlen, pDirfile);
+    dirfile.write(&nlen, sizeof(uint32), 1);
+    dirfile.write(WmoInstName, sizeof(char), nlen);
 
     /* fprintf(pDirfile,"%s/%s %f,%f,%f_%f,%f,%f 1.0 %d %d %d,%d %d\n",
         MapName,
@@ -38,6 +38,7 @@
 
 #include "adt.h"
 #include "wdt.h"
+#include "BuildManifest.hpp"
 #include <fcntl.h>
 
 #if defined( __GNUC__ )
@@ -70,6 +71,7 @@ uint16 *LiqType;
 char output_path[MAX_PATH_LENGTH] = ".";
 char input_path[MAX_PATH_LENGTH] = ".";
 uint32 maxAreaId = 0;
+uint32 maxLiquidTypeId = 0;
 
 // **************************************************
 // Extractor options
@@ -93,6 +95,9 @@ float CONF_float_to_int16_limit = 2048.0f;   // Max accuracy = val/65536
 float CONF_flat_height_delta_limit = 0.005f; // If max - min less this value - surface is flat
 float CONF_flat_liquid_delta_limit = 0.001f; // If max - min less this value - liquid surface is flat
 
+// Only report the map files whose adt or settings changed since they were extracted
+bool  CONF_verify = false;
+
 // List MPQ for extract from / Version 12340
 const char* CONF_mpq_list[] = {
     "common.MPQ",
@@ -149,6 +154,8 @@ void Usage(char* prg)
         "-o set output path (max %d characters)\n"\
         "-e extract only MAP(1)/DBC(2) - standard: both(3)\n"\
         "-f height stored as int (less map size but lost some accuracy) 1 by default\n"\
+        "--verify list the map files which are outdated, nothing is extracted\n"\
+        "Only changed map files are extracted again, delete maps/manifest.txt to extract all of them\n"\
         "Example: %s -f 0 -i \"c:\\games\\game\"", prg, MAX_PATH_LENGTH - 1, MAX_PATH_LENGTH - 1, prg);
     exit(1);
 }
@@ -162,6 +169,13 @@ void HandleArgs(int argc, char * arg[])
         // e - extract only MAP(1)/DBC(2) - standard both(3)
         // f - use float to int conversion
         // h - limit minimum height
+        // --verify - list outdated map files
+        if (strcmp(arg[c], "--verify") == 0)
+        {
+            CONF_verify = true;
+            continue;
+        }
+
         if(arg[c][0] != '-')
             Usage(arg[0]);
 
@@ -316,6 +330,8 @@ void ReadLiquidTypeTableDBC()
     for(uint32 x = 0; x < liqTypeCount; ++x)
         LiqType[dbc.getRecord(x).getUInt(0)] = dbc.getRecord(x).getUInt(3);
 
+    maxLiquidTypeId = dbc.getMaxId();
+
     printf("Done! (%u LiqTypes loaded)\n", (uint32)liqTypeCount);
 }
 
@@ -415,13 +431,8 @@ uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
 bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
 float liquid_height[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
 
-bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
+bool ConvertADT(ADT_file& adt, char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
 {
-    ADT_file adt;
-
-    if (!adt.loadFile(filename))
-        return false;
-
     adt_MCIN *cells = adt.a_grid->getMCIN();
     if (!cells)
     {
@@ -965,11 +976,38 @@ bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/,
     return true;
 }
 
-void ExtractMapsFromMpq(uint32 build)
+// Everything besides the adt which changes the converted map files
+BuildHash GetMapSettingsHash(uint32 build)
+{
+    BuildHash hash;
+    hash.addString(MAP_MAGIC);
+    hash.addString(MAP_VERSION_MAGIC);
+    hash.add(build);
+
+    hash.add(CONF_allow_height_limit);
+    hash.add(CONF_use_minHeight);
+    hash.add(CONF_allow_float_to_int);
+    hash.add(CONF_float_to_int8_limit);
+    hash.add(CONF_float_to_int16_limit);
+    hash.add(CONF_flat_height_delta_limit);
+    hash.add(CONF_flat_liquid_delta_limit);
+
+    // area flags and liquid types are copied from the dbc files
+    hash.add(maxAreaId);
+    hash.addBytes(areas, (maxAreaId + 1) * sizeof(uint16));
+    hash.add(maxLiquidTypeId);
+    hash.addBytes(LiqType, (maxLiquidTypeId + 1) * sizeof(uint16));
+
+    return hash;
+}
+
+// Returns false if CONF_verify found outdated map files
+bool ExtractMapsFromMpq(uint32 build)
 {
     char mpq_filename[1024];
     char output_filename[1024];
     char mpq_map_name[1024];
+    char tile_name[32];
 
     printf("Extracting maps...\n");
 
@@ -982,7 +1020,14 @@ void ExtractMapsFromMpq(uint32 build)
     path += "/maps/";
     CreateDir(path);
 
-    printf("Convert map files\n");
+    // map files are only converted again if their adt or the settings changed
+    BuildManifest manifest(std::string(output_path) + "/maps");
+    manifest.load();
+
+    BuildHash const settingsHash = GetMapSettingsHash(build);
+    uint32 converted = 0, upToDate = 0, outdated = 0;
+
+    printf(CONF_verify ? "Verify map files\n" : "Convert map files\n");
     for(uint32 z = 0; z < map_count; ++z)
     {
         printf("Extract %s (%d/%u)                  \n", map_ids[z].name, z+1, map_count);
@@ -1002,16 +1047,57 @@ void ExtractMapsFromMpq(uint32 build)
                 if (!wdt.main->adt_list[y][x].exist)
                     continue;
                 sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map_ids[z].name, map_ids[z].name, x, y);
-                sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map_ids[z].id, y, x);
-                ConvertADT(mpq_filename, output_filename, y, x, build);
+                sprintf(tile_name, "%03u%02u%02u.map", map_ids[z].id, y, x);
+                sprintf(output_filename, "%s/maps/%s", output_path, tile_name);
+
+                ADT_file adt;
+                if (!adt.loadFile(mpq_filename))
+                    continue;
+
+                BuildHash hash = settingsHash;
+                hash.addBytes(adt.GetData(), adt.GetDataSize());
+
+                BuildState state = manifest.check(tile_name, hash.get());
+                if (state == BUILD_STATE_UP_TO_DATE)
+                {
+                    ++upToDate;
+                    continue;
+                }
+
+                if (CONF_verify)
+                {
+                    printf("Outdated %s (%s)\n", tile_name, BuildManifest::getStateName(state));
+                    ++outdated;
+                    continue;
+                }
+
+                if (ConvertADT(adt, mpq_filename, output_filename, y, x, build))
+                {
+                    manifest.set(tile_name, hash.get());
+                    ++converted;
+                }
+                else
+                    manifest.erase(tile_name);
             }
             // draw progress bar
             printf("Processing........................%d%%\r", (100 * (y+1)) / WDT_MAP_SIZE);
         }
+
+        // keep the progress if the extractor is stopped
+        if (!CONF_verify)
+            manifest.save();
     }
     printf("\n");
+
+    if (CONF_verify)
+        printf("%u map files are outdated, %u are up to date\n", outdated, upToDate);
+    else
+        printf("%u map files converted, %u were up to date\n", converted, upToDate);
+
     delete [] areas;
     delete [] map_ids;
+
+    return outdated == 0;
 }
 
 bool ExtractFile( char const* mpq_name, std::string const& filename )
@@ -1124,6 +1210,10 @@ int main(int argc, char * arg[])
 
     HandleArgs(argc, arg);
 
+    // only the map files are tracked in the manifest
+    if (CONF_verify)
+        CONF_extract = EXTRACT_MAP;
+
     int FirstLocale = -1;
     uint32 build = 0;
 
@@ -1168,6 +1258,7 @@ int main(int argc, char * arg[])
         return 0;
     }
 
+    bool upToDate = true;
     if (CONF_extract & EXTRACT_MAP)
     {
         printf("Using locale: %s\n", langs[FirstLocale]);
@@ -1177,11 +1268,11 @@ int main(int argc, char * arg[])
         LoadCommonMPQFiles();
 
         // Extract maps
-        ExtractMapsFromMpq(build);
+        upToDate = ExtractMapsFromMpq(build);
 
         // Close MPQs
         CloseMPQFiles();
     }
 
-    return 0;
+    return upToDate ? 0 : 1;
 }
@@ -120,7 +120,7 @@ public:
     int nMDX;
     std::string* WmoInstansName;
     std::string* ModelInstansName;
-    bool init(uint32 map_num, uint32 tileX, uint32 tileY);
+    bool init(uint32 map_num, uint32 tileX, uint32 tileY, DirFileRecords& dirfile);
 };
 
 const char* GetPlainName(const char* FileName);
@@ -143,7 +143,7 @@ Vec3D fixCoordSystem2(Vec3D v)
     return Vec3D(v.x, v.z, v.y);
 }
 
-ModelInstance::ModelInstance(MPQFile& f, char const* ModelInstName, uint32 mapID, uint32 tileX, uint32 tileY, FILE *pDirfile)
+ModelInstance::ModelInstance(MPQFile& f, char const* ModelInstName, uint32 mapID, uint32 tileX, uint32 tileY, DirFileRecords& dirfile)
     : id(0), scale(0), flags(0)
 {
     float ff[3];
@@ -181,16 +181,16 @@ ModelInstance::ModelInstance(MPQFile& f, char const* ModelInstName, uint32 mapID
         flags |= MOD_WORLDSPAWN;
 
     //write mapID, tileX, tileY, Flags, ID, Pos, Rot, Scale, name
-    fwrite(&mapID, sizeof(uint32), 1, pDirfile);
-    fwrite(&tileX, sizeof(uint32), 1, pDirfile);
-    fwrite(&tileY, sizeof(uint32), 1, pDirfile);
-    fwrite(&flags, sizeof(uint32), 1, pDirfile);
-    fwrite(&adtId, sizeof(uint16), 1, pDirfile);
-    fwrite(&id, sizeof(uint32), 1, pDirfile);
-    fwrite(&pos, sizeof(float), 3, pDirfile);
-    fwrite(&rot, sizeof(float), 3, pDirfile);
-    fwrite(&sc, sizeof(float), 1, pDirfile);
+    dirfile.write(&mapID, sizeof(uint32), 1);
+    dirfile.write(&tileX, sizeof(uint32), 1);
+    dirfile.write(&tileY, sizeof(uint32), 1);
+    dirfile.write(&flags, sizeof(uint32), 1);
+    dirfile.write(&adtId, sizeof(uint16), 1);
+    dirfile.write(&id, sizeof(uint32), 1);
+    dirfile.write(&pos, sizeof(float), 3);
+    dirfile.write(&rot, sizeof(float), 3);
+    dirfile.write(&sc, sizeof(float), 1);
     uint32 nlen = strlen(ModelInstName);
-    fwrite(&nlen, sizeof(uint32), 1, pDirfile);
-    fwrite(ModelInstName, sizeof(char), nlen, pDirfile);
+    dirfile.write(&nlen, sizeof(uint32), 1);
+    dirfile.write(ModelInstName, sizeof(char), nlen);
 }
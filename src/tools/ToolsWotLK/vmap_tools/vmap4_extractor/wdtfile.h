@@ -24,6 +24,7 @@
 #include <string>
 
 class ADTFile;
+class DirFileRecords;
 
 class WDTFile
 {
@@ -31,7 +32,7 @@ public:
     WDTFile(char* file_name, char* file_name1);
     ~WDTFile(void);
 
-    bool init(char* map_id, unsigned int mapID);
+    bool init(char* map_id, unsigned int mapID, DirFileRecords& dirfile);
     ADTFile* GetMap(int x, int z);
 
     std::string* gWmoInstansName;
@@ -0,0 +1,265 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "SwarmClient.h"
+#include "SwarmScenario.h"
+#include "SwarmStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+namespace
+{
+    std::atomic<bool> stopRequested(false);
+
+    void onSignal(int /*signal*/)
+    {
+        stopRequested = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    /// The clients of one thread, polled together
+    //////////////////////////////////////////////////////////////////////////////////////
+    struct SwarmThread
+    {
+        SwarmStats stats;
+        std::vector<std::unique_ptr<SwarmClient>> clients;
+        std::vector<uint64_t> startTimes;
+    };
+
+    void runThread(SwarmThread& thread, uint64_t endTime)
+    {
+        std::vector<pollfd> fds;
+        std::vector<SwarmClient*> polled;
+        size_t started = 0;
+
+        while (!stopRequested)
+        {
+            uint64_t now = SwarmClient::getTime();
+            if (now >= endTime)
+                break;
+
+            // clients are sorted by start time
+            for (; started < thread.clients.size() && thread.startTimes[started] <= now; ++started)
+                thread.clients[started]->start(now);
+
+            fds.clear();
+            polled.clear();
+            for (size_t i = 0; i < started; ++i)
+            {
+                SwarmClient* client = thread.clients[i].get();
+                if (client->getSocket() == -1)
+                    continue;
+
+                pollfd fd;
+                fd.fd = client->getSocket();
+                fd.events = client->getPollEvents();
+                fd.revents = 0;
+                fds.push_back(fd);
+                polled.push_back(client);
+            }
+
+            if (fds.empty())
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            else
+                poll(&fds[0], fds.size(), 10);
+
+            now = SwarmClient::getTime();
+            for (size_t i = 0; i < fds.size(); ++i)
+            {
+                if (fds[i].revents != 0)
+                    polled[i]->onSocketEvents(fds[i].revents, now);
+            }
+
+            for (size_t i = 0; i < started; ++i)
+                thread.clients[i]->update(now);
+        }
+
+        for (size_t i = 0; i < thread.clients.size(); ++i)
+            thread.clients[i]->stop();
+    }
+
+    bool parseHostPort(const char* text, std::string& host, uint16_t& port)
+    {
+        const char* colon = strrchr(text, ':');
+        if (colon == nullptr)
+        {
+            host = text;
+            return true;
+        }
+
+        host.assign(text, colon);
+        port = static_cast<uint16_t>(atoi(colon + 1));
+        return port != 0;
+    }
+
+    void printUsage()
+    {
+        printf("Usage: client_swarm <scenario> [options]\n");
+        printf("  --logon <host[:port]>    logon server, default 127.0.0.1:3724\n");
+        printf("  --realm <name>           realm to join, default the first realm of the realm list\n");
+        printf("  --realm-host <host>      connect to host instead of the host in the realm list\n");
+        printf("  --accounts <prefix>      client n logs on as <prefix><first + n>, default swarm\n");
+        printf("  --first <n>              number of the first account, default 1\n");
+        printf("  --password <password>    password of all accounts, default swarm\n");
+        printf("  --clients <n>            number of clients, overrides the scenario\n");
+        printf("  --threads <n>            client threads, default the number of cpus\n");
+        printf("  --server-info            the first client asks for the map tick times with .server info\n");
+        printf("                           every report, needs a gm account\n");
+        printf("The accounts have to exist, the clients create a character if an account has none.\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    SwarmOptions options;
+    options.logonHost = "127.0.0.1";
+    options.logonPort = 3724;
+    options.accountPrefix = "swarm";
+    options.firstAccount = 1;
+    options.password = "swarm";
+
+    SwarmScenario scenario;
+    if (!scenario.load(argv[1]))
+        return 1;
+
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    bool serverInfo = false;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (option == "--server-info")
+        {
+            serverInfo = true;
+            continue;
+        }
+
+        if (value == nullptr)
+        {
+            printUsage();
+            return 1;
+        }
+
+        ++i;
+        if (option == "--logon")
+        {
+            if (!parseHostPort(value, options.logonHost, options.logonPort))
+            {
+                printf("Invalid logon server %s.\n", value);
+                return 1;
+            }
+        }
+        else if (option == "--realm")
+            options.realmName = value;
+        else if (option == "--realm-host")
+            options.realmHost = value;
+        else if (option == "--accounts")
+            options.accountPrefix = value;
+        else if (option == "--first")
+            options.firstAccount = static_cast<uint32_t>(atoi(value));
+        else if (option == "--password")
+            options.password = value;
+        else if (option == "--clients")
+            scenario.setClientCount(static_cast<uint32_t>(atoi(value)));
+        else if (option == "--threads")
+            threadCount = std::max(1, atoi(value));
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (scenario.getClientCount() == 0)
+    {
+        printf("The swarm needs at least one client.\n");
+        return 1;
+    }
+
+    threadCount = std::min(threadCount, scenario.getClientCount());
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // client n starts n / rampup seconds after the first one
+    const uint64_t startTime = SwarmClient::getTime();
+    const uint64_t endTime = startTime + scenario.getDuration() * 1000000ull;
+
+    std::vector<std::unique_ptr<SwarmThread>> threads;
+    for (uint32_t i = 0; i < threadCount; ++i)
+        threads.push_back(std::unique_ptr<SwarmThread>(new SwarmThread));
+
+    for (uint32_t i = 0; i < scenario.getClientCount(); ++i)
+    {
+        SwarmThread& thread = *threads[i % threadCount];
+        thread.clients.push_back(std::unique_ptr<SwarmClient>(new SwarmClient(options, scenario, thread.stats, i)));
+        thread.startTimes.push_back(startTime + i * 1000000ull / scenario.getRampUp());
+        thread.stats.addClients(1);
+    }
+
+    printf("Starting %u clients on %u threads against %s:%u, %u clients per second for %u seconds.\n", scenario.getClientCount(), threadCount,
+        options.logonHost.c_str(), options.logonPort, scenario.getRampUp(), scenario.getDuration());
+    fflush(stdout);
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < threadCount; ++i)
+        workers.push_back(std::thread(runThread, std::ref(*threads[i]), endTime));
+
+    SwarmStats total;
+    uint64_t lastReport = startTime;
+
+    while (!stopRequested && SwarmClient::getTime() < endTime)
+    {
+        const uint64_t nextReport = std::min<uint64_t>(lastReport + scenario.getReportInterval() * 1000000ull, endTime);
+        while (!stopRequested && SwarmClient::getTime() < nextReport)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const uint64_t now = SwarmClient::getTime();
+
+        SwarmStats interval;
+        for (uint32_t i = 0; i < threadCount; ++i)
+            threads[i]->stats.drainInto(interval);
+
+        interval.print("last interval", (now - lastReport) / 1000000.0);
+        total.merge(interval);
+        lastReport = now;
+
+        if (serverInfo)
+            threads[0]->clients[0]->requestServerInfo();
+    }
+
+    stopRequested = true;
+    for (std::vector<std::thread>::iterator itr = workers.begin(); itr != workers.end(); ++itr)
+        itr->join();
+
+    SwarmStats last;
+    for (uint32_t i = 0; i < threadCount; ++i)
+        threads[i]->stats.drainInto(last);
+
+    total.merge(last);
+    total.print("total", (SwarmClient::getTime() - startTime) / 1000000.0);
+
+    return 0;
+}
@@ -0,0 +1,1079 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "SwarmClient.h"
+
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    const uint16_t clientBuild = 12340;
+
+    // logon server commands
+    const uint8_t CMD_AUTH_LOGON_CHALLENGE = 0x00;
+    const uint8_t CMD_AUTH_LOGON_PROOF = 0x01;
+    const uint8_t CMD_REALM_LIST = 0x10;
+
+    const size_t logonChallengeSize = 119;      // sAuthLogonChallenge_S
+    const size_t logonProofSize = 32;           // sAuthLogonProof_S
+
+    const uint8_t AUTH_OK = 0x0C;
+    const uint8_t AUTH_WAIT_QUEUE = 0x1B;
+    const uint8_t CHAR_CREATE_SUCCESS = 0x2F;
+
+    const uint32_t CHAT_MSG_SYSTEM = 0x00;
+    const uint32_t CHAT_MSG_SAY = 0x01;
+    const uint32_t LANG_ORCISH = 1;
+    const uint32_t LANG_COMMON = 7;
+
+    const uint32_t MOVEFLAG_MOVE_FORWARD = 0x01;
+
+    const float runSpeed = 7.0f;
+    const uint64_t heartbeatInterval = 500000;
+
+    std::string toUpper(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+        return text;
+    }
+
+    /// character names may only have letters
+    std::string getCharacterName(uint32_t index)
+    {
+        std::string suffix;
+        do
+        {
+            suffix.insert(suffix.begin(), static_cast<char>('a' + index % 26));
+            index /= 26;
+        } while (index != 0);
+
+        return "Swarm" + suffix;
+    }
+
+    bool isAllianceRace(uint8_t race)
+    {
+        return race == 1 || race == 3 || race == 4 || race == 7 || race == 11;
+    }
+
+    /// removes the |cAARRGGBB and |r colors of a chat message
+    std::string stripColors(const std::string& text)
+    {
+        std::string result;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '|' && i + 1 < text.size() && text[i + 1] == 'c')
+                i += 9;
+            else if (text[i] == '|' && i + 1 < text.size() && text[i + 1] == 'r')
+                i += 1;
+            else
+                result += text[i];
+        }
+
+        return result;
+    }
+
+    void copyPadded(uint8_t* destination, BigNumber& number, int length)
+    {
+        memset(destination, 0, length);
+        memcpy(destination, number.AsByteArray(), std::min(length, number.GetNumBytes()));
+    }
+}
+
+SwarmClient::SwarmClient(const SwarmOptions& options, const SwarmScenario& scenario, SwarmStats& stats, uint32_t index) :
+    m_options(options), m_scenario(scenario), m_stats(stats), m_index(index), m_random(index * 2654435761u + 1),
+    m_step(STEP_NONE), m_state(SWARM_STATE_WAITING), m_socket(-1), m_connecting(false), m_writeOffset(0),
+    m_realmPort(0), m_haveHeader(false), m_packetSize(0), m_packetOpcode(0),
+    m_guid(0), m_mapId(0), m_homeX(0.0f), m_homeY(0.0f), m_homeZ(0.0f), m_x(0.0f), m_y(0.0f), m_z(0.0f), m_o(0.0f),
+    m_moving(false), m_moveRadius(0.0f), m_lastMovement(0),
+    m_startTime(0), m_nextAction(0), m_pingTime(0), m_pingId(0), m_chatTime(0), m_chatId(0), m_teleportTime(0),
+    m_serverInfoRequested(false), m_serverInfoPending(false)
+{
+    char number[16];
+    snprintf(number, sizeof(number), "%u", options.firstAccount + index);
+    m_accountName = toUpper(options.accountPrefix + number);
+
+    memset(m_sessionKeyBytes, 0, sizeof(m_sessionKeyBytes));
+    memset(m_expectedProof, 0, sizeof(m_expectedProof));
+}
+
+SwarmClient::~SwarmClient()
+{
+    _closeSocket();
+}
+
+uint64_t SwarmClient::getTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t SwarmClient::_getClientTime() const
+{
+    return static_cast<uint32_t>(getTime() / 1000);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// State and connection
+void SwarmClient::_setStep(Step step)
+{
+    m_step = step;
+
+    SwarmClientState state;
+    switch (step)
+    {
+        case STEP_NONE:
+            state = SWARM_STATE_WAITING;
+            break;
+        case STEP_LOGON_CONNECT:
+        case STEP_LOGON_CHALLENGE:
+        case STEP_LOGON_PROOF:
+        case STEP_REALM_LIST:
+            state = SWARM_STATE_LOGON;
+            break;
+        case STEP_WORLD_CONNECT:
+        case STEP_WORLD_CHALLENGE:
+        case STEP_WORLD_AUTH:
+            state = SWARM_STATE_REALM;
+            break;
+        case STEP_CHAR_ENUM:
+        case STEP_CHAR_CREATE:
+        case STEP_PLAYER_LOGIN:
+            state = SWARM_STATE_CHARACTER;
+            break;
+        default:
+            state = SWARM_STATE_IN_WORLD;
+            break;
+    }
+
+    if (state != m_state)
+    {
+        m_stats.changeState(m_state, state);
+        m_state = state;
+    }
+}
+
+void SwarmClient::_fail(const char* format, ...)
+{
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    printf("%s: %s\n", m_accountName.c_str(), message);
+
+    _closeSocket();
+    m_stats.increment(SWARM_COUNTER_FAILURES);
+    m_stats.changeState(m_state, SWARM_STATE_FAILED);
+    m_state = SWARM_STATE_FAILED;
+    m_step = STEP_NONE;
+}
+
+void SwarmClient::_closeSocket()
+{
+    if (m_socket != -1)
+        close(m_socket);
+
+    m_socket = -1;
+    m_connecting = false;
+    m_readBuffer.clear();
+    m_writeBuffer.clear();
+    m_writeOffset = 0;
+    m_haveHeader = false;
+}
+
+bool SwarmClient::_connect(const std::string& host, uint16_t port)
+{
+    _closeSocket();
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+
+    addrinfo* address = nullptr;
+    if (getaddrinfo(host.c_str(), service, &hints, &address) != 0 || address == nullptr)
+    {
+        _fail("could not resolve %s", host.c_str());
+        return false;
+    }
+
+    m_socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (m_socket == -1)
+    {
+        freeaddrinfo(address);
+        _fail("could not create a socket: %s", strerror(errno));
+        return false;
+    }
+
+    fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+
+    const int noDelay = 1;
+    setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    const int result = connect(m_socket, address->ai_addr, address->ai_addrlen);
+    freeaddrinfo(address);
+
+    if (result == -1 && errno != EINPROGRESS)
+    {
+        _fail("could not connect to %s:%u: %s", host.c_str(), port, strerror(errno));
+        return false;
+    }
+
+    m_connecting = true;
+    return true;
+}
+
+short SwarmClient::getPollEvents() const
+{
+    if (m_connecting || m_writeOffset < m_writeBuffer.size())
+        return POLLIN | POLLOUT;
+
+    return POLLIN;
+}
+
+void SwarmClient::start(uint64_t now)
+{
+    m_startTime = now;
+    if (_connect(m_options.logonHost, m_options.logonPort))
+        _setStep(STEP_LOGON_CONNECT);
+}
+
+void SwarmClient::stop()
+{
+    _closeSocket();
+    if (m_state != SWARM_STATE_FAILED)
+    {
+        m_stats.changeState(m_state, SWARM_STATE_DONE);
+        m_state = SWARM_STATE_DONE;
+    }
+
+    m_step = STEP_NONE;
+}
+
+void SwarmClient::onSocketEvents(short events, uint64_t /*now*/)
+{
+    if (m_socket == -1)
+        return;
+
+    if (m_connecting)
+    {
+        if ((events & (POLLOUT | POLLERR | POLLHUP)) == 0)
+            return;
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0)
+        {
+            _fail("could not connect: %s", strerror(error));
+            return;
+        }
+
+        m_connecting = false;
+        _onConnected();
+        if (m_socket == -1)
+            return;
+    }
+
+    if (events & (POLLIN | POLLERR | POLLHUP))
+        _readSocket();
+
+    if (m_socket != -1 && (events & POLLOUT))
+        _writeSocket();
+}
+
+void SwarmClient::_onConnected()
+{
+    if (m_step == STEP_LOGON_CONNECT)
+    {
+        _sendLogonChallenge();
+        _setStep(STEP_LOGON_CHALLENGE);
+    }
+    else if (m_step == STEP_WORLD_CONNECT)
+    {
+        _setStep(STEP_WORLD_CHALLENGE);
+    }
+}
+
+void SwarmClient::_readSocket()
+{
+    uint8_t buffer[16384];
+    while (m_socket != -1)
+    {
+        const ssize_t received = recv(m_socket, buffer, sizeof(buffer), 0);
+        if (received == 0)
+        {
+            _fail("connection closed by the server");
+            return;
+        }
+
+        if (received < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            _fail("receive failed: %s", strerror(errno));
+            return;
+        }
+
+        m_readBuffer.insert(m_readBuffer.end(), buffer, buffer + received);
+        m_stats.increment(SWARM_COUNTER_BYTES_RECEIVED, static_cast<uint64_t>(received));
+    }
+
+    switch (m_step)
+    {
+        case STEP_LOGON_CHALLENGE:
+            _handleLogonChallenge();
+            break;
+        case STEP_LOGON_PROOF:
+            _handleLogonProof();
+            break;
+        case STEP_REALM_LIST:
+            _handleRealmList();
+            break;
+        default:
+        {
+            WorldPacket packet;
+            while (m_socket != -1 && _readWorldPacket(packet))
+                _handleWorldPacket(packet);
+        } break;
+    }
+}
+
+void SwarmClient::_writeSocket()
+{
+    while (m_writeOffset < m_writeBuffer.size())
+    {
+        const ssize_t sent = ::send(m_socket, &m_writeBuffer[m_writeOffset], m_writeBuffer.size() - m_writeOffset, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+
+            _fail("send failed: %s", strerror(errno));
+            return;
+        }
+
+        m_writeOffset += static_cast<size_t>(sent);
+        m_stats.increment(SWARM_COUNTER_BYTES_SENT, static_cast<uint64_t>(sent));
+    }
+
+    m_writeBuffer.clear();
+    m_writeOffset = 0;
+}
+
+void SwarmClient::_send(const uint8_t* data, size_t length)
+{
+    m_writeBuffer.insert(m_writeBuffer.end(), data, data + length);
+    if (!m_connecting)
+        _writeSocket();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Logon server
+void SwarmClient::_sendLogonChallenge()
+{
+    ByteBuffer data(64);
+    data << CMD_AUTH_LOGON_CHALLENGE;
+    data << uint8_t(3);
+    data << uint16_t(30 + m_accountName.size());
+    data.append("WoW", 4);
+    data << uint8_t(3) << uint8_t(3) << uint8_t(5);
+    data << clientBuild;
+    data.append("68x", 4);
+    data.append("niW", 4);
+    data.append("SUne", 4);
+    data << uint32_t(0);
+    data << uint32_t(htonl(INADDR_LOOPBACK));
+    data << uint8_t(m_accountName.size());
+    data.append(m_accountName.c_str(), m_accountName.size());
+
+    _send(data.contents(), data.size());
+}
+
+bool SwarmClient::_handleLogonChallenge()
+{
+    if (m_readBuffer.size() < 3)
+        return false;
+
+    if (m_readBuffer[0] != CMD_AUTH_LOGON_CHALLENGE || m_readBuffer[2] != 0)
+    {
+        _fail("logon challenge failed with error %u, does the account exist?", m_readBuffer[2]);
+        return false;
+    }
+
+    if (m_readBuffer.size() < logonChallengeSize)
+        return false;
+
+    // cmd, error, unk, B[32], g_len, g, N_len, N[32], s[32], unk3[16], unk4
+    const uint8_t* challenge = &m_readBuffer[0];
+
+    BigNumber B, g, N, s;
+    B.SetBinary(challenge + 3, 32);
+    g.SetBinary(challenge + 36, 1);
+    N.SetBinary(challenge + 38, 32);
+    s.SetBinary(challenge + 70, 32);
+
+    BigNumber a;
+    a.SetRand(19 * 8);
+    BigNumber A = g.ModExp(a, N);
+
+    // x = SHA1(s | SHA1(I | ":" | P)), the server keeps the inner hash in the account table
+    Sha1Hash sha;
+    sha.UpdateData(m_accountName + ":" + toUpper(m_options.password));
+    sha.Finalize();
+
+    uint8_t passwordHash[20];
+    memcpy(passwordHash, sha.GetDigest(), 20);
+
+    sha.Initialize();
+    sha.UpdateData(challenge + 70, 32);
+    sha.UpdateData(passwordHash, 20);
+    sha.Finalize();
+
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), 20);
+
+    // u = SHA1(A | B)
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &B, nullptr);
+    sha.Finalize();
+
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - k * g^x) ^ (a + u * x), k = 3. B and k * v mod N are below N, B + N - k * v is positive
+    BigNumber v = g.ModExp(x, N);
+    BigNumber kv = (v * BigNumber(3)) % N;
+    BigNumber base = (B + N - kv) % N;
+    BigNumber S = base.ModExp(a + u * x, N);
+
+    // K interleaves the hashes of the even and odd bytes of S
+    uint8_t t[32];
+    uint8_t half[16];
+    copyPadded(t, S, 32);
+
+    for (uint8_t i = 0; i < 16; ++i)
+        half[i] = t[i * 2];
+
+    sha.Initialize();
+    sha.UpdateData(half, 16);
+    sha.Finalize();
+    for (uint8_t i = 0; i < 20; ++i)
+        m_sessionKeyBytes[i * 2] = sha.GetDigest()[i];
+
+    for (uint8_t i = 0; i < 16; ++i)
+        half[i] = t[i * 2 + 1];
+
+    sha.Initialize();
+    sha.UpdateData(half, 16);
+    sha.Finalize();
+    for (uint8_t i = 0; i < 20; ++i)
+        m_sessionKeyBytes[i * 2 + 1] = sha.GetDigest()[i];
+
+    m_sessionKey.SetBinary(m_sessionKeyBytes, 40);
+
+    // M1 = SHA1(H(N) xor H(g), H(I), s, A, B, K), hashed like the logon server does
+    uint8_t hash[20];
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, nullptr);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, nullptr);
+    sha.Finalize();
+    for (uint8_t i = 0; i < 20; ++i)
+        hash[i] ^= sha.GetDigest()[i];
+
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(m_accountName);
+    sha.Finalize();
+
+    BigNumber t4;
+    t4.SetBinary(sha.GetDigest(), 20);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, &t4, &s, &A, &B, &m_sessionKey, nullptr);
+    sha.Finalize();
+
+    uint8_t M1[20];
+    memcpy(M1, sha.GetDigest(), 20);
+
+    BigNumber M;
+    M.SetBinary(M1, 20);
+
+    // M2 = SHA1(A, M1, K)
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &M, &m_sessionKey, nullptr);
+    sha.Finalize();
+    memcpy(m_expectedProof, sha.GetDigest(), 20);
+
+    m_readBuffer.erase(m_readBuffer.begin(), m_readBuffer.begin() + logonChallengeSize);
+
+    uint8_t proof[75];
+    memset(proof, 0, sizeof(proof));
+    proof[0] = CMD_AUTH_LOGON_PROOF;
+    copyPadded(proof + 1, A, 32);
+    memcpy(proof + 33, M1, 20);
+
+    _send(proof, sizeof(proof));
+    _setStep(STEP_LOGON_PROOF);
+    return true;
+}
+
+bool SwarmClient::_handleLogonProof()
+{
+    if (m_readBuffer.size() < 3)
+        return false;
+
+    // a wrong password is answered with a challenge error
+    if (m_readBuffer[0] != CMD_AUTH_LOGON_PROOF || m_readBuffer[1] != 0)
+    {
+        _fail("logon proof failed, wrong password?");
+        return false;
+    }
+
+    if (m_readBuffer.size() < logonProofSize)
+        return false;
+
+    if (memcmp(&m_readBuffer[2], m_expectedProof, 20) != 0)
+    {
+        _fail("the logon server sent a wrong proof");
+        return false;
+    }
+
+    m_readBuffer.erase(m_readBuffer.begin(), m_readBuffer.begin() + logonProofSize);
+
+    const uint8_t request[5] = { CMD_REALM_LIST, 0, 0, 0, 0 };
+    _send(request, sizeof(request));
+    _setStep(STEP_REALM_LIST);
+    return true;
+}
+
+bool SwarmClient::_handleRealmList()
+{
+    if (m_readBuffer.size() < 3)
+        return false;
+
+    const size_t size = m_readBuffer[1] | (m_readBuffer[2] << 8);
+    if (m_readBuffer.size() < size + 3)
+        return false;
+
+    ByteBuffer data(size);
+    data.append(&m_readBuffer[3], size);
+
+    uint32_t unk;
+    uint16_t count;
+    data >> unk >> count;
+
+    std::string address;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        uint8_t icon, lock, flags, characters, timezone, id;
+        std::string name, realmAddress;
+        float population;
+        data >> icon >> lock >> flags >> name >> realmAddress >> population >> characters >> timezone >> id;
+
+        if (address.empty() && !realmAddress.empty() && (m_options.realmName.empty() || m_options.realmName == name))
+            address = realmAddress;
+    }
+
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos)
+    {
+        _fail("no realm %s in the realm list", m_options.realmName.c_str());
+        return false;
+    }
+
+    m_realmHost = m_options.realmHost.empty() ? address.substr(0, colon) : m_options.realmHost;
+    m_realmPort = static_cast<uint16_t>(atoi(address.c_str() + colon + 1));
+
+    if (_connect(m_realmHost, m_realmPort))
+        _setStep(STEP_WORLD_CONNECT);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Realm server
+bool SwarmClient::_readWorldPacket(WorldPacket& packet)
+{
+    // server header: uint16 size (big endian, includes the opcode), uint16 opcode
+    if (!m_haveHeader)
+    {
+        if (m_readBuffer.size() < 4)
+            return false;
+
+        m_crypt.decryptWotlkReceive(&m_readBuffer[0], 4);
+        m_packetSize = static_cast<uint16_t>(((m_readBuffer[0] << 8) | m_readBuffer[1]) - 2);
+        m_packetOpcode = static_cast<uint16_t>(m_readBuffer[2] | (m_readBuffer[3] << 8));
+        m_readBuffer.erase(m_readBuffer.begin(), m_readBuffer.begin() + 4);
+        m_haveHeader = true;
+    }
+
+    if (m_readBuffer.size() < m_packetSize)
+        return false;
+
+    packet.Initialize(m_packetOpcode, m_packetSize);
+    if (m_packetSize > 0)
+        packet.append(&m_readBuffer[0], m_packetSize);
+
+    m_readBuffer.erase(m_readBuffer.begin(), m_readBuffer.begin() + m_packetSize);
+    m_haveHeader = false;
+
+    m_stats.increment(SWARM_COUNTER_PACKETS_RECEIVED);
+    return true;
+}
+
+void SwarmClient::_sendWorldPacket(WorldPacket& packet)
+{
+    // client header: uint16 size (big endian, includes the opcode), uint32 opcode
+    const uint16_t size = static_cast<uint16_t>(packet.size() + 4);
+
+    uint8_t header[6];
+    header[0] = static_cast<uint8_t>(size >> 8);
+    header[1] = static_cast<uint8_t>(size);
+    header[2] = static_cast<uint8_t>(packet.GetOpcode());
+    header[3] = static_cast<uint8_t>(packet.GetOpcode() >> 8);
+    header[4] = 0;
+    header[5] = 0;
+
+    m_crypt.encryptWotlkSend(header, sizeof(header));
+
+    m_writeBuffer.insert(m_writeBuffer.end(), header, header + sizeof(header));
+    if (packet.size() > 0)
+        m_writeBuffer.insert(m_writeBuffer.end(), packet.contents(), packet.contents() + packet.size());
+
+    if (!m_connecting)
+        _writeSocket();
+
+    m_stats.increment(SWARM_COUNTER_PACKETS_SENT);
+}
+
+void SwarmClient::_handleWorldPacket(WorldPacket& packet)
+{
+    switch (packet.GetOpcode())
+    {
+        case SMSG_AUTH_CHALLENGE:
+            _handleAuthChallenge(packet);
+            break;
+        case SMSG_AUTH_RESPONSE:
+            _handleAuthResponse(packet);
+            break;
+        case SMSG_CHAR_ENUM:
+            _handleCharEnum(packet);
+            break;
+        case SMSG_CHAR_CREATE:
+            _handleCharCreate(packet);
+            break;
+        case SMSG_CHARACTER_LOGIN_FAILED:
+            _fail("login failed with error %u", packet.read<uint8_t>());
+            break;
+        case SMSG_LOGIN_VERIFY_WORLD:
+            _handleLoginVerifyWorld(packet);
+            break;
+        case SMSG_MESSAGECHAT:
+            _handleMessageChat(packet);
+            break;
+        case SMSG_PONG:
+            _handlePong(packet);
+            break;
+        case SMSG_NEW_WORLD:
+            _handleNewWorld(packet);
+            break;
+        case MSG_MOVE_TELEPORT_ACK:
+            _handleTeleportAck(packet);
+            break;
+        case SMSG_TIME_SYNC_REQ:
+            _handleTimeSyncRequest(packet);
+            break;
+        default:
+            break;
+    }
+}
+
+void SwarmClient::_handleAuthChallenge(WorldPacket& packet)
+{
+    if (m_step != STEP_WORLD_CHALLENGE)
+        return;
+
+    uint32_t unk;
+    uint32_t serverSeed;
+    packet >> unk >> serverSeed;
+
+    const uint32_t clientSeed = m_random();
+    const uint32_t zero = 0;
+
+    Sha1Hash sha;
+    sha.UpdateData(m_accountName);
+    sha.UpdateData(reinterpret_cast<const uint8_t*>(&zero), 4);
+    sha.UpdateData(reinterpret_cast<const uint8_t*>(&clientSeed), 4);
+    sha.UpdateData(reinterpret_cast<const uint8_t*>(&serverSeed), 4);
+    sha.UpdateData(m_sessionKeyBytes, 40);
+    sha.Finalize();
+
+    WorldPacket data(CMSG_AUTH_SESSION, 80 + m_accountName.size());
+    data << uint32_t(clientBuild);
+    data << uint32_t(0);
+    data << m_accountName;
+    data << uint32_t(0);
+    data << clientSeed;
+    data << uint64_t(0);
+    data << uint32_t(0);
+    data << uint32_t(0);
+    data << uint32_t(0);
+    data.append(sha.GetDigest(), 20);
+    data << uint32_t(0);        // no addon data
+    _sendWorldPacket(data);
+
+    // the server encrypts everything after the auth session
+    m_crypt.initWotlkClientCrypt(m_sessionKeyBytes);
+    _setStep(STEP_WORLD_AUTH);
+}
+
+void SwarmClient::_handleAuthResponse(WorldPacket& packet)
+{
+    const uint8_t result = packet.read<uint8_t>();
+    if (result == AUTH_WAIT_QUEUE)
+        return;
+
+    if (result != AUTH_OK)
+    {
+        _fail("realm authentication failed with error %u", result);
+        return;
+    }
+
+    WorldPacket data(CMSG_CHAR_ENUM, 0);
+    _sendWorldPacket(data);
+    _setStep(STEP_CHAR_ENUM);
+}
+
+void SwarmClient::_handleCharEnum(WorldPacket& packet)
+{
+    if (packet.read<uint8_t>() != 0)
+    {
+        packet >> m_guid;
+
+        WorldPacket data(CMSG_PLAYER_LOGIN, 8);
+        data << m_guid;
+        _sendWorldPacket(data);
+        _setStep(STEP_PLAYER_LOGIN);
+        return;
+    }
+
+    if (m_step == STEP_CHAR_CREATE)
+    {
+        _fail("the created character is not in the character list");
+        return;
+    }
+
+    // name, race, class, gender, skin, face, hair style, hair color, facial hair, outfit
+    WorldPacket data(CMSG_CHAR_CREATE, 32);
+    data << getCharacterName(m_options.firstAccount + m_index);
+    data << m_scenario.getRace() << m_scenario.getClass();
+    data << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0);
+    _sendWorldPacket(data);
+    _setStep(STEP_CHAR_CREATE);
+}
+
+void SwarmClient::_handleCharCreate(WorldPacket& packet)
+{
+    const uint8_t result = packet.read<uint8_t>();
+    if (result != CHAR_CREATE_SUCCESS)
+    {
+        _fail("character %s could not be created, error %u", getCharacterName(m_options.firstAccount + m_index).c_str(), result);
+        return;
+    }
+
+    WorldPacket data(CMSG_CHAR_ENUM, 0);
+    _sendWorldPacket(data);
+}
+
+void SwarmClient::_handleLoginVerifyWorld(WorldPacket& packet)
+{
+    uint32_t mapId;
+    float x, y, z, o;
+    packet >> mapId >> x >> y >> z >> o;
+
+    _setPosition(mapId, x, y, z, o);
+    m_homeX = x;
+    m_homeY = y;
+    m_homeZ = z;
+
+    const uint64_t now = getTime();
+    if (m_step == STEP_PLAYER_LOGIN)
+    {
+        m_stats.addLatency(SWARM_LATENCY_LOGIN, now - m_startTime);
+
+        // spread the first actions of clients that logged in at the same time
+        m_nextAction = now + m_random() % (m_scenario.getInterval() * 1000ull);
+    }
+
+    _setStep(STEP_IN_WORLD);
+}
+
+void SwarmClient::_handleMessageChat(WorldPacket& packet)
+{
+    // type, language, sender, unk, target, length, text, tag
+    uint8_t type;
+    uint32_t language;
+    uint64_t sender;
+    uint32_t unk;
+    uint64_t target;
+    uint32_t length;
+    std::string text;
+    packet >> type >> language >> sender >> unk >> target >> length >> text;
+
+    if (type == CHAT_MSG_SAY && sender == m_guid && m_chatTime != 0)
+    {
+        char token[16];
+        snprintf(token, sizeof(token), " #%u", m_chatId);
+        if (text.size() >= strlen(token) && text.compare(text.size() - strlen(token), std::string::npos, token) == 0)
+        {
+            m_stats.addLatency(SWARM_LATENCY_CHAT, getTime() - m_chatTime);
+            m_chatTime = 0;
+        }
+    }
+    else if (type == CHAT_MSG_SYSTEM && m_serverInfoPending)
+    {
+        const std::string line = stripColors(text);
+        if (line.find("Map Ticks") != std::string::npos)
+        {
+            printf("server: %s\n", line.c_str());
+            fflush(stdout);
+            m_serverInfoPending = false;
+        }
+    }
+}
+
+void SwarmClient::_handlePong(WorldPacket& packet)
+{
+    if (m_pingTime != 0 && packet.read<uint32_t>() == m_pingId)
+    {
+        m_stats.addLatency(SWARM_LATENCY_PING, getTime() - m_pingTime);
+        m_pingTime = 0;
+    }
+}
+
+void SwarmClient::_handleNewWorld(WorldPacket& packet)
+{
+    uint32_t mapId;
+    float x, y, z, o;
+    packet >> mapId >> x >> y >> z >> o;
+
+    _setPosition(mapId, x, y, z, o);
+
+    WorldPacket data(MSG_MOVE_WORLDPORT_ACK, 0);
+    _sendWorldPacket(data);
+}
+
+void SwarmClient::_handleTeleportAck(WorldPacket& packet)
+{
+    WoWGuid guid;
+    uint32_t counter;
+    uint32_t flags;
+    uint16_t flags2;
+    uint32_t time;
+    float x, y, z, o;
+    packet >> guid >> counter >> flags >> flags2 >> time >> x >> y >> z >> o;
+
+    _setPosition(m_mapId, x, y, z, o);
+
+    WorldPacket data(MSG_MOVE_TELEPORT_ACK, 20);
+    data.appendPackGUID(m_guid);
+    data << counter;
+    data << _getClientTime();
+    _sendWorldPacket(data);
+}
+
+void SwarmClient::_handleTimeSyncRequest(WorldPacket& packet)
+{
+    WorldPacket data(CMSG_TIME_SYNC_RESP, 8);
+    data << packet.read<uint32_t>();
+    data << _getClientTime();
+    _sendWorldPacket(data);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// In world
+void SwarmClient::_setPosition(uint32_t mapId, float x, float y, float z, float o)
+{
+    if (m_teleportTime != 0)
+    {
+        m_stats.addLatency(SWARM_LATENCY_TELEPORT, getTime() - m_teleportTime);
+        m_teleportTime = 0;
+    }
+
+    m_mapId = mapId;
+    m_x = x;
+    m_y = y;
+    m_z = z;
+    m_o = o;
+    m_moving = false;
+}
+
+void SwarmClient::update(uint64_t now)
+{
+    if (m_step != STEP_IN_WORLD)
+        return;
+
+    if (m_moving && now - m_lastMovement >= heartbeatInterval)
+        _updateMovement();
+
+    if (now < m_nextAction)
+        return;
+
+    m_nextAction = now + m_scenario.getInterval() * 1000ull;
+
+    if (m_serverInfoRequested)
+    {
+        m_serverInfoRequested = false;
+        m_serverInfoPending = true;
+        _sendChat(".server info");
+        return;
+    }
+
+    const SwarmAction* action = m_scenario.pickAction(m_random());
+    if (action != nullptr)
+        _runAction(*action);
+}
+
+void SwarmClient::_runAction(const SwarmAction& action)
+{
+    m_stats.increment(SWARM_COUNTER_ACTIONS);
+
+    // every action ends the walk of the last move action
+    if (m_moving)
+    {
+        _updateMovement();
+        if (m_moving)
+        {
+            m_moving = false;
+            _sendMovement(MSG_MOVE_STOP, 0);
+        }
+    }
+
+    switch (action.type)
+    {
+        case SWARM_ACTION_MOVE:
+        {
+            // walk in a random direction, back towards the login position once outside of half the radius
+            const float dx = m_homeX - m_x;
+            const float dy = m_homeY - m_y;
+            const float jitter = (m_random() % 1000) / 1000.0f - 0.5f;
+            if (dx * dx + dy * dy > action.radius * action.radius / 4.0f)
+                m_o = atan2f(dy, dx) + jitter;
+            else
+                m_o = jitter * 4.0f * static_cast<float>(M_PI);
+
+            m_moveRadius = action.radius;
+            m_moving = true;
+            m_lastMovement = getTime();
+            _sendMovement(MSG_MOVE_START_FORWARD, MOVEFLAG_MOVE_FORWARD);
+        } break;
+        case SWARM_ACTION_SAY:
+        {
+            char token[16];
+            snprintf(token, sizeof(token), " #%u", ++m_chatId);
+            m_chatTime = getTime();
+            _sendChat(action.text + token);
+        } break;
+        case SWARM_ACTION_CAST:
+        {
+            // cast count, spell, cast flags, target mask 0 is the caster
+            WorldPacket data(CMSG_CAST_SPELL, 10);
+            data << uint8_t(0);
+            data << action.spellId;
+            data << uint8_t(0);
+            data << uint32_t(0);
+            _sendWorldPacket(data);
+        } break;
+        case SWARM_ACTION_COMMAND:
+        {
+            if (action.text.compare(0, 11, ".worldport ") == 0 || action.text.compare(0, 9, ".recall p") == 0 ||
+                action.text.compare(0, 7, ".appear") == 0 || action.text.compare(0, 6, ".goxyz") == 0)
+                m_teleportTime = getTime();
+
+            _sendChat(action.text);
+        } break;
+        case SWARM_ACTION_PING:
+        {
+            WorldPacket data(CMSG_PING, 8);
+            data << ++m_pingId;
+            data << uint32_t(m_pingTime != 0 ? 0 : 50);
+            m_pingTime = getTime();
+            _sendWorldPacket(data);
+        } break;
+    }
+}
+
+void SwarmClient::_updateMovement()
+{
+    const uint64_t now = getTime();
+    const float distance = runSpeed * (now - m_lastMovement) / 1000000.0f;
+    m_lastMovement = now;
+
+    m_x += cosf(m_o) * distance;
+    m_y += sinf(m_o) * distance;
+
+    const float dx = m_x - m_homeX;
+    const float dy = m_y - m_homeY;
+    if (dx * dx + dy * dy > m_moveRadius * m_moveRadius)
+    {
+        m_moving = false;
+        _sendMovement(MSG_MOVE_STOP, 0);
+        return;
+    }
+
+    _sendMovement(MSG_MOVE_HEARTBEAT, MOVEFLAG_MOVE_FORWARD);
+}
+
+void SwarmClient::_sendMovement(uint16_t opcode, uint32_t flags)
+{
+    // guid, flags, flags2, time, position, fall time
+    WorldPacket data(opcode, 40);
+    data.appendPackGUID(m_guid);
+    data << flags;
+    data << uint16_t(0);
+    data << _getClientTime();
+    data << m_x << m_y << m_z << m_o;
+    data << uint32_t(0);
+    _sendWorldPacket(data);
+}
+
+void SwarmClient::_sendChat(const std::string& text)
+{
+    WorldPacket data(CMSG_MESSAGECHAT, text.size() + 9);
+    data << CHAT_MSG_SAY;
+    data << (isAllianceRace(m_scenario.getRace()) ? LANG_COMMON : LANG_ORCISH);
+    data << text;
+    _sendWorldPacket(data);
+}
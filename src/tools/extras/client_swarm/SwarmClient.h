@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+// before ByteBuffer.h, its layout depends on the client version
+#include "../world/WorldConf.h"
+
+#include "SwarmScenario.h"
+#include "SwarmStats.h"
+
+#include "Auth/WowCrypt.h"
+#include "WorldPacket.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+struct SwarmOptions
+{
+    std::string logonHost;
+    uint16_t logonPort;
+
+    /// replaces the host of the realm list address if not empty, e.g. when the realm announces 0.0.0.0
+    std::string realmHost;
+    /// name of the realm to join, the first realm of the realm list if empty
+    std::string realmName;
+
+    /// account of client n is accountPrefix followed by firstAccount + n
+    std::string accountPrefix;
+    uint32_t firstAccount;
+    std::string password;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// One headless client: logs on with SRP6, joins the realm, creates a character if the
+/// account has none, enters the world and runs the actions of the scenario.
+///
+/// The client speaks the 3.3.5a (12340) protocol over a non blocking socket. It does not
+/// own a thread, the swarm thread polls the socket and calls onSocketEvents and update.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SwarmClient
+{
+    public:
+
+        SwarmClient(const SwarmOptions& options, const SwarmScenario& scenario, SwarmStats& stats, uint32_t index);
+        ~SwarmClient();
+
+        /// microseconds of a steady clock
+        static uint64_t getTime();
+
+        void start(uint64_t now);
+        void stop();
+
+        /// -1 while the client has no connection
+        int getSocket() const { return m_socket; }
+        short getPollEvents() const;
+
+        void onSocketEvents(short events, uint64_t now);
+        void update(uint64_t now);
+
+        SwarmClientState getState() const { return m_state; }
+
+        /// the next action of the client sends .server info, the map tick line of the answer is printed.
+        /// Needs a gm account, may be called from any thread
+        void requestServerInfo() { m_serverInfoRequested = true; }
+
+    private:
+
+        enum Step
+        {
+            STEP_NONE,
+            STEP_LOGON_CONNECT,
+            STEP_LOGON_CHALLENGE,
+            STEP_LOGON_PROOF,
+            STEP_REALM_LIST,
+            STEP_WORLD_CONNECT,
+            STEP_WORLD_CHALLENGE,
+            STEP_WORLD_AUTH,
+            STEP_CHAR_ENUM,
+            STEP_CHAR_CREATE,
+            STEP_PLAYER_LOGIN,
+            STEP_IN_WORLD
+        };
+
+        void _setStep(Step step);
+        void _fail(const char* format, ...);
+        void _closeSocket();
+        bool _connect(const std::string& host, uint16_t port);
+
+        void _onConnected();
+        void _readSocket();
+        void _writeSocket();
+        void _send(const uint8_t* data, size_t length);
+
+        // logon server
+        void _sendLogonChallenge();
+        bool _handleLogonChallenge();
+        bool _handleLogonProof();
+        bool _handleRealmList();
+
+        // realm server
+        bool _readWorldPacket(WorldPacket& packet);
+        void _sendWorldPacket(WorldPacket& packet);
+        void _handleWorldPacket(WorldPacket& packet);
+
+        void _handleAuthChallenge(WorldPacket& packet);
+        void _handleAuthResponse(WorldPacket& packet);
+        void _handleCharEnum(WorldPacket& packet);
+        void _handleCharCreate(WorldPacket& packet);
+        void _handleLoginVerifyWorld(WorldPacket& packet);
+        void _handleMessageChat(WorldPacket& packet);
+        void _handlePong(WorldPacket& packet);
+        void _handleNewWorld(WorldPacket& packet);
+        void _handleTeleportAck(WorldPacket& packet);
+        void _handleTimeSyncRequest(WorldPacket& packet);
+
+        // in world
+        void _runAction(const SwarmAction& action);
+        void _sendMovement(uint16_t opcode, uint32_t flags);
+        void _updateMovement();
+        void _sendChat(const std::string& text);
+        void _setPosition(uint32_t mapId, float x, float y, float z, float o);
+        uint32_t _getClientTime() const;
+
+        const SwarmOptions& m_options;
+        const SwarmScenario& m_scenario;
+        SwarmStats& m_stats;
+        uint32_t m_index;
+        std::string m_accountName;
+        std::mt19937 m_random;
+
+        Step m_step;
+        SwarmClientState m_state;
+
+        int m_socket;
+        bool m_connecting;
+        std::vector<uint8_t> m_readBuffer;
+        std::vector<uint8_t> m_writeBuffer;
+        size_t m_writeOffset;
+
+        // logon
+        BigNumber m_sessionKey;
+        uint8_t m_sessionKeyBytes[40];
+        uint8_t m_expectedProof[20];
+        std::string m_realmHost;
+        uint16_t m_realmPort;
+
+        // realm
+        WowCrypt m_crypt;
+        bool m_haveHeader;
+        uint16_t m_packetSize;
+        uint16_t m_packetOpcode;
+
+        // world
+        uint64_t m_guid;
+        uint32_t m_mapId;
+        float m_homeX, m_homeY, m_homeZ;
+        float m_x, m_y, m_z, m_o;
+        bool m_moving;
+        float m_moveRadius;
+        uint64_t m_lastMovement;
+
+        uint64_t m_startTime;
+        uint64_t m_nextAction;
+        uint64_t m_pingTime;
+        uint32_t m_pingId;
+        uint64_t m_chatTime;
+        uint32_t m_chatId;
+        uint64_t m_teleportTime;
+        std::atomic<bool> m_serverInfoRequested;
+        bool m_serverInfoPending;
+};
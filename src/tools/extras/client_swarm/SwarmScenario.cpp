@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "SwarmScenario.h"
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+SwarmScenario::SwarmScenario() : m_clientCount(10), m_rampUp(10), m_duration(60), m_interval(1000), m_reportInterval(10),
+    m_race(1), m_class(8), m_totalWeight(0)
+{
+}
+
+bool SwarmScenario::load(const std::string& fileName)
+{
+    std::ifstream file(fileName.c_str());
+    if (!file)
+    {
+        printf("Could not open scenario %s.\n", fileName.c_str());
+        return false;
+    }
+
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+    {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        if (!_parseLine(line))
+        {
+            printf("%s:%u: invalid setting: %s\n", fileName.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+
+    if (m_actions.empty() || m_totalWeight == 0)
+    {
+        printf("%s: the scenario has no actions.\n", fileName.c_str());
+        return false;
+    }
+
+    if (m_rampUp == 0 || m_interval == 0 || m_reportInterval == 0)
+    {
+        printf("%s: rampup, interval and report must not be 0.\n", fileName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool SwarmScenario::_parseLine(const std::string& line)
+{
+    std::istringstream stream(line);
+
+    std::string key;
+    if (!(stream >> key))
+        return true;
+
+    if (key == "clients")
+        return static_cast<bool>(stream >> m_clientCount);
+    if (key == "rampup")
+        return static_cast<bool>(stream >> m_rampUp);
+    if (key == "duration")
+        return static_cast<bool>(stream >> m_duration);
+    if (key == "interval")
+        return static_cast<bool>(stream >> m_interval);
+    if (key == "report")
+        return static_cast<bool>(stream >> m_reportInterval);
+
+    if (key == "character")
+    {
+        uint32_t race;
+        uint32_t class_;
+        if (!(stream >> race >> class_))
+            return false;
+
+        m_race = static_cast<uint8_t>(race);
+        m_class = static_cast<uint8_t>(class_);
+        return true;
+    }
+
+    SwarmAction action;
+    action.radius = 0.0f;
+    action.spellId = 0;
+
+    if (!(stream >> action.weight))
+        return false;
+
+    if (key == "move")
+    {
+        action.type = SWARM_ACTION_MOVE;
+        if (!(stream >> action.radius))
+            action.radius = 20.0f;
+    }
+    else if (key == "say" || key == "command")
+    {
+        action.type = key == "say" ? SWARM_ACTION_SAY : SWARM_ACTION_COMMAND;
+
+        std::getline(stream >> std::ws, action.text);
+        while (!action.text.empty() && isspace(static_cast<unsigned char>(action.text[action.text.size() - 1])))
+            action.text.erase(action.text.size() - 1);
+
+        if (action.text.empty() || (action.type == SWARM_ACTION_COMMAND && action.text[0] != '.'))
+            return false;
+    }
+    else if (key == "cast")
+    {
+        action.type = SWARM_ACTION_CAST;
+        if (!(stream >> action.spellId))
+            return false;
+    }
+    else if (key == "ping")
+    {
+        action.type = SWARM_ACTION_PING;
+    }
+    else
+    {
+        return false;
+    }
+
+    m_actions.push_back(action);
+    m_totalWeight += action.weight;
+    return true;
+}
+
+const SwarmAction* SwarmScenario::pickAction(uint32_t roll) const
+{
+    roll %= m_totalWeight;
+    for (std::vector<SwarmAction>::const_iterator itr = m_actions.begin(); itr != m_actions.end(); ++itr)
+    {
+        if (roll < itr->weight)
+            return &*itr;
+
+        roll -= itr->weight;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum SwarmActionType
+{
+    SWARM_ACTION_MOVE,
+    SWARM_ACTION_SAY,
+    SWARM_ACTION_CAST,
+    SWARM_ACTION_COMMAND,
+    SWARM_ACTION_PING
+};
+
+struct SwarmAction
+{
+    SwarmActionType type;
+    uint32_t weight;
+
+    float radius;           // move: clients walk around their login position within radius yards
+    uint32_t spellId;       // cast: cast on self
+    std::string text;       // say: chat text, command: chat command including the leading dot
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// What the clients of a swarm do once they are in the world.
+///
+/// A scenario file has one setting per line, # starts a comment:
+///     clients 200             number of clients
+///     rampup 20               clients started per second
+///     duration 300            seconds the swarm runs after the first client started
+///     interval 1000           milliseconds between two actions of a client
+///     report 10               seconds between two reports
+///     character 1 8           race and class of the characters created for the clients
+///     move 60 30              weight, radius
+///     say 20 hello            weight, text
+///     cast 10 168             weight, spell id
+///     command 5 .server info  weight, command
+///     ping 5                  weight
+/// Every interval each client picks one action, weighted by the weights of the actions.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SwarmScenario
+{
+    public:
+
+        SwarmScenario();
+
+        /// prints the line of the first error and returns false if the file could not be read
+        bool load(const std::string& fileName);
+
+        /// weighted pick, roll is any random number
+        const SwarmAction* pickAction(uint32_t roll) const;
+
+        uint32_t getClientCount() const { return m_clientCount; }
+        uint32_t getRampUp() const { return m_rampUp; }
+        uint32_t getDuration() const { return m_duration; }
+        uint32_t getInterval() const { return m_interval; }
+        uint32_t getReportInterval() const { return m_reportInterval; }
+        uint8_t getRace() const { return m_race; }
+        uint8_t getClass() const { return m_class; }
+
+        void setClientCount(uint32_t clientCount) { m_clientCount = clientCount; }
+
+    private:
+
+        bool _parseLine(const std::string& line);
+
+        uint32_t m_clientCount;
+        uint32_t m_rampUp;
+        uint32_t m_duration;
+        uint32_t m_interval;
+        uint32_t m_reportInterval;
+        uint8_t m_race;
+        uint8_t m_class;
+
+        std::vector<SwarmAction> m_actions;
+        uint32_t m_totalWeight;
+};
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "SwarmStats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const char* const latencyNames[SWARM_LATENCY_COUNT] = { "login", "ping", "chat echo", "teleport" };
+    const char* const stateNames[SWARM_STATE_COUNT] = { "waiting", "logon", "realm", "character", "in world", "failed", "done" };
+}
+
+SwarmStats::SwarmStats()
+{
+    memset(m_counters, 0, sizeof(m_counters));
+    memset(m_states, 0, sizeof(m_states));
+}
+
+void SwarmStats::addClients(uint32_t count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_states[SWARM_STATE_WAITING] += count;
+}
+
+void SwarmStats::addLatency(SwarmLatency latency, uint64_t microseconds)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_latencies[latency].push_back(static_cast<uint32_t>(std::min<uint64_t>(microseconds, UINT32_MAX)));
+}
+
+void SwarmStats::increment(SwarmCounter counter, uint64_t value)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_counters[counter] += value;
+}
+
+void SwarmStats::changeState(SwarmClientState from, SwarmClientState to)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    --m_states[from];
+    ++m_states[to];
+}
+
+void SwarmStats::drainInto(SwarmStats& target)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::lock_guard<std::mutex> targetGuard(target.m_lock);
+
+    for (uint8_t i = 0; i < SWARM_LATENCY_COUNT; ++i)
+    {
+        target.m_latencies[i].insert(target.m_latencies[i].end(), m_latencies[i].begin(), m_latencies[i].end());
+        m_latencies[i].clear();
+    }
+
+    for (uint8_t i = 0; i < SWARM_COUNTER_COUNT; ++i)
+    {
+        target.m_counters[i] += m_counters[i];
+        m_counters[i] = 0;
+    }
+
+    for (uint8_t i = 0; i < SWARM_STATE_COUNT; ++i)
+        target.m_states[i] += m_states[i];
+}
+
+void SwarmStats::merge(const SwarmStats& other)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::lock_guard<std::mutex> otherGuard(other.m_lock);
+
+    for (uint8_t i = 0; i < SWARM_LATENCY_COUNT; ++i)
+        m_latencies[i].insert(m_latencies[i].end(), other.m_latencies[i].begin(), other.m_latencies[i].end());
+
+    for (uint8_t i = 0; i < SWARM_COUNTER_COUNT; ++i)
+        m_counters[i] += other.m_counters[i];
+
+    memcpy(m_states, other.m_states, sizeof(m_states));
+}
+
+uint64_t SwarmStats::_getPercentile(const std::vector<uint32_t>& sorted, uint32_t percent)
+{
+    if (sorted.empty())
+        return 0;
+
+    return sorted[std::min<size_t>(sorted.size() - 1, sorted.size() * percent / 100)];
+}
+
+void SwarmStats::print(const char* title, double seconds) const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    printf("== %s (%.0fs)\n", title, seconds);
+
+    printf("clients:");
+    for (uint8_t i = 0; i < SWARM_STATE_COUNT; ++i)
+        printf(" %s %d%s", stateNames[i], m_states[i], i + 1 < SWARM_STATE_COUNT ? "," : "\n");
+
+    const double perSecond = seconds > 0.0 ? 1.0 / seconds : 0.0;
+    printf("traffic: %.0f packets/s (%.1f KB/s) sent, %.0f packets/s (%.1f KB/s) received, %.0f actions/s, %llu failures\n",
+        m_counters[SWARM_COUNTER_PACKETS_SENT] * perSecond, m_counters[SWARM_COUNTER_BYTES_SENT] * perSecond / 1024.0,
+        m_counters[SWARM_COUNTER_PACKETS_RECEIVED] * perSecond, m_counters[SWARM_COUNTER_BYTES_RECEIVED] * perSecond / 1024.0,
+        m_counters[SWARM_COUNTER_ACTIONS] * perSecond, static_cast<unsigned long long>(m_counters[SWARM_COUNTER_FAILURES]));
+
+    printf("  latency ms |   count |    p50 |    p90 |    p99 |    max\n");
+    for (uint8_t i = 0; i < SWARM_LATENCY_COUNT; ++i)
+    {
+        std::vector<uint32_t> sorted(m_latencies[i]);
+        std::sort(sorted.begin(), sorted.end());
+
+        printf("  %-10s | %7u | %6.1f | %6.1f | %6.1f | %6.1f\n", latencyNames[i], static_cast<uint32_t>(sorted.size()),
+            _getPercentile(sorted, 50) / 1000.0, _getPercentile(sorted, 90) / 1000.0, _getPercentile(sorted, 99) / 1000.0,
+            sorted.empty() ? 0.0 : sorted.back() / 1000.0);
+    }
+
+    fflush(stdout);
+}
@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum SwarmLatency
+{
+    SWARM_LATENCY_LOGIN,        // from the logon challenge to SMSG_LOGIN_VERIFY_WORLD
+    SWARM_LATENCY_PING,         // CMSG_PING to SMSG_PONG
+    SWARM_LATENCY_CHAT,         // CMSG_MESSAGECHAT to the echo of the own say
+    SWARM_LATENCY_TELEPORT,     // teleport command to the new position
+    SWARM_LATENCY_COUNT
+};
+
+enum SwarmCounter
+{
+    SWARM_COUNTER_PACKETS_SENT,
+    SWARM_COUNTER_PACKETS_RECEIVED,
+    SWARM_COUNTER_BYTES_SENT,
+    SWARM_COUNTER_BYTES_RECEIVED,
+    SWARM_COUNTER_ACTIONS,
+    SWARM_COUNTER_FAILURES,
+    SWARM_COUNTER_COUNT
+};
+
+enum SwarmClientState
+{
+    SWARM_STATE_WAITING,
+    SWARM_STATE_LOGON,
+    SWARM_STATE_REALM,
+    SWARM_STATE_CHARACTER,
+    SWARM_STATE_IN_WORLD,
+    SWARM_STATE_FAILED,
+    SWARM_STATE_DONE,
+    SWARM_STATE_COUNT
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Latencies and counters of the clients of one swarm thread.
+///
+/// Latencies are kept as single samples in microseconds, percentiles are exact. The
+/// client threads add to their own stats, the report thread drains them into the stats
+/// of the report interval.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SwarmStats
+{
+    public:
+
+        SwarmStats();
+
+        /// new clients start in SWARM_STATE_WAITING
+        void addClients(uint32_t count);
+
+        void addLatency(SwarmLatency latency, uint64_t microseconds);
+        void increment(SwarmCounter counter, uint64_t value = 1);
+        void changeState(SwarmClientState from, SwarmClientState to);
+
+        /// adds the samples and counters to target and clears them, client states are copied
+        void drainInto(SwarmStats& target);
+
+        /// adds the samples and counters of other, client states are replaced
+        void merge(const SwarmStats& other);
+
+        void print(const char* title, double seconds) const;
+
+    private:
+
+        static uint64_t _getPercentile(const std::vector<uint32_t>& sorted, uint32_t percent);
+
+        mutable std::mutex m_lock;
+
+        std::vector<uint32_t> m_latencies[SWARM_LATENCY_COUNT];
+        uint64_t m_counters[SWARM_COUNTER_COUNT];
+        int32_t m_states[SWARM_STATE_COUNT];
+};
@@ -379,6 +379,7 @@ class SERVER_DECL ChatHandler : public Singleton<ChatHandler>
         bool HandleReloadPointsOfInterestCommand(const char* /*args*/, WorldSession* m_session);
         bool HandleReloadQuestsCommand(const char* /*args*/, WorldSession* m_session);
         bool HandleReloadTeleportCoordsCommand(const char* /*args*/, WorldSession* m_session);
+        bool HandleReloadWordFilterCommand(const char* /*args*/, WorldSession* m_session);
         bool HandleReloadWorldbroadcastCommand(const char* /*args*/, WorldSession* m_session);
         bool HandleReloadWorldmapInfoCommand(const char* /*args*/, WorldSession* m_session);
         bool HandleReloadWorldstringTablesCommand(const char* /*args*/, WorldSession* m_session);
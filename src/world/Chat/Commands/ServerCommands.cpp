@@ -8,6 +8,7 @@ This file is released under the MIT license. See README-MIT for more information
 #include "Storage/MySQLDataStore.hpp"
 #include "Server/MainServerDefines.h"
 #include "Server/Master.h"
+#include "Map/MapTickScheduler.h"
 
 //.server info
 bool ChatHandler::HandleServerInfoCommand(const char* /*args*/, WorldSession* m_session)
@@ -55,6 +56,23 @@ bool ChatHandler::HandleServerInfoCommand(const char* /*args*/, WorldSession* m_
     GreenSystemMessage(m_session, "SQL Query Cache Size (Character): |r%u queries delayed", CharacterDatabase.GetQueueSize());
     GreenSystemMessage(m_session, "Socket Count: |r%u", sSocketMgr.GetSocketCount());
 
+    uint32 map_count = 0;
+    uint64 tick_count = 0;
+    uint64 tick_total = 0;
+    uint64 tick_p99 = 0;
+    uint64 tick_max = 0;
+    sMapTickScheduler.visitStats([&](const MapTickStats& stats)
+    {
+        ++map_count;
+        tick_count += stats.duration->getCount();
+        tick_total += stats.duration->getTotal();
+        tick_p99 = std::max(tick_p99, stats.duration->getPercentile(99));
+        tick_max = std::max(tick_max, stats.duration->getMax());
+    });
+
+    GreenSystemMessage(m_session, "Map Ticks: |r%u maps, avg %.1fms, worst p99 %.1fms, max %.1fms", map_count,
+        tick_count > 0 ? tick_total / 1000.0f / tick_count : 0.0f, tick_p99 / 1000.0f, tick_max / 1000.0f);
+
     return true;
 }
 
@@ -405,6 +423,24 @@ bool ChatHandler::HandleReloadTeleportCoordsCommand(const char* /*args*/, WorldS
     return true;
 }
 
+//.server reload wordfilter
+bool ChatHandler::HandleReloadWordFilterCommand(const char* /*args*/, WorldSession* m_session)
+{
+    uint32 start_time = getMSTime();
+    const bool names_loaded = g_characterNameFilter->Load("wordfilter_character_names");
+    const bool chat_loaded = g_chatFilter->Load("wordfilter_chat");
+
+    if (!names_loaded)
+        RedSystemMessage(m_session, "WorldDB 'wordfilter_character_names' table could not be reloaded, the previous filters stay active. See the error log.");
+    if (!chat_loaded)
+        RedSystemMessage(m_session, "WorldDB 'wordfilter_chat' table could not be reloaded, the previous filters stay active. See the error log.");
+
+    if (names_loaded && chat_loaded)
+        GreenSystemMessage(m_session, "WorldDB 'wordfilter_character_names' and 'wordfilter_chat' tables reloaded in %u ms", getMSTime() - start_time);
+
+    return true;
+}
+
 //.server reload worldbroadcast
 bool ChatHandler::HandleReloadWorldbroadcastCommand(const char* /*args*/, WorldSession* m_session)
 {
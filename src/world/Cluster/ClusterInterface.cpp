@@ -157,8 +157,15 @@ void ClusterInterface::HandleAuthRequest(WorldPacket & pck)
 
 void ClusterInterface::Ping(WorldPacket & pck)
 {
-    printf("Ping /n");
-    m_latency = getMSTime() - pingtime;
+    // echo the send time of the realm server, it measures the round trip
+    uint32 realmTime = 0;
+    if (pck.size() >= 4)
+        pck >> realmTime;
+
+    WorldPacket data(ICMSG_WORLD_PONG_STATUS, 4);
+    data << realmTime;
+    SendPacket(&data);
+
     last_pong = uint32(time(NULL));
 }
 
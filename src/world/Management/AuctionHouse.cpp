@@ -129,6 +129,7 @@ void AuctionHouse::AddAuction(Auction* auct)
     // add to the map
     auctionLock.AcquireWriteLock();
     auctions.insert(std::unordered_map<uint32, Auction*>::value_type(auct->Id, auct));
+    searchIndex.addAuction(auct);
     auctionLock.ReleaseWriteLock();
 
     LOG_DEBUG("%u: Add auction %u, expire@ %u.", dbc->id, auct->Id, auct->ExpiryTime);
@@ -222,6 +223,7 @@ void AuctionHouse::RemoveAuction(Auction* auct)
     // Remove the auction from the hashmap.
     auctionLock.AcquireWriteLock();
     auctions.erase(auct->Id);
+    searchIndex.removeAuction(auct);
     auctionLock.ReleaseWriteLock();
 
     // Destroy the item from memory (it still remains in the db)
@@ -672,8 +674,7 @@ void WorldSession::HandleAuctionListOwnerItems(WorldPacket& recv_data)
 
 void AuctionHouse::SendAuctionList(Player* plr, WorldPacket* packet)
 {
-    uint32 start_index, current_index = 0;
-    uint32 counted_items = 0;
+    uint32 start_index;
     std::string auctionString;
     uint8 levelRange1, levelRange2, usableCheck;
     int32 inventory_type, itemclass, itemsubclass, rarityCheck;
@@ -685,88 +686,31 @@ void AuctionHouse::SendAuctionList(Player* plr, WorldPacket* packet)
     *packet >> rarityCheck >> usableCheck;
 
     // convert auction string to lowercase for faster parsing.
-    if (auctionString.length() > 0)
-    {
-        for (uint32 j = 0; j < auctionString.length(); ++j)
-            auctionString[j] = static_cast<char>(tolower(auctionString[j]));
-    }
+    for (uint32 j = 0; j < auctionString.length(); ++j)
+        auctionString[j] = static_cast<char>(tolower(auctionString[j]));
+
+    AuctionSearchQuery query;
+    query.name = auctionString;
+    query.levelMin = levelRange1;
+    query.levelMax = levelRange2;
+    query.inventoryType = inventory_type;
+    query.itemClass = itemclass;
+    query.itemSubClass = itemsubclass;
+    query.quality = rarityCheck;
 
     WorldPacket data(SMSG_AUCTION_LIST_RESULT, 7000);
     data << uint32(0); // count of items
 
-    auctionLock.AcquireReadLock();
-    std::unordered_map<uint32, Auction*>::iterator itr = auctions.begin();
-    ItemProperties const* proto;
-    for (; itr != auctions.end(); ++itr)
-    {
-        if (itr->second->Deleted) continue;
-        proto = itr->second->pItem->GetItemProperties();
-
-        // Check the auction for parameters
-
-        // inventory type
-        if (inventory_type != -1 && inventory_type != (int32)proto->InventoryType)
-            continue;
-
-        // class
-        if (itemclass != -1 && itemclass != (int32)proto->Class)
-            continue;
-
-        // subclass
-        if (itemsubclass != -1 && itemsubclass != (int32)proto->SubClass)
-            continue;
-
-        // this is going to hurt. - name
-        std::string proto_lower = proto->lowercase_name;
-        if (auctionString.length() > 0 && !FindXinYString(auctionString, proto_lower))
-            continue;
-
-        // rarity
-        if (rarityCheck != -1 && rarityCheck > (int32)proto->Quality)
-            continue;
-
-        // level range check - lower boundary
-        if (levelRange1 && proto->RequiredLevel < levelRange1)
-            continue;
-
-        // level range check - high boundary
-        if (levelRange2 && proto->RequiredLevel > levelRange2)
-            continue;
-
-        // usable check - this will hurt too :(
-        if (usableCheck)
-        {
-            // allowed class
-            if (proto->AllowableClass && !(plr->getClassMask() & proto->AllowableClass))
-                continue;
-
-            if (proto->RequiredLevel && proto->RequiredLevel > plr->getLevel())
-                continue;
-
-            if (proto->AllowableRace && !(plr->getRaceMask() & proto->AllowableRace))
-                continue;
+    std::vector<Auction*> page;
 
-            if (proto->Class == 4 && proto->SubClass && !(plr->GetArmorProficiency() & (((uint32)(1)) << proto->SubClass)))
-                continue;
-
-            if (proto->Class == 2 && proto->SubClass && !(plr->GetWeaponProficiency() & (((uint32)(1)) << proto->SubClass)))
-                continue;
-
-            if (proto->RequiredSkill && (!plr->_HasSkillLine(proto->RequiredSkill) || proto->RequiredSkillRank > plr->_GetSkillLineCurrent(proto->RequiredSkill, true)))
-                continue;
-        }
+    auctionLock.AcquireReadLock();
+    const uint32 counted_items = SearchAuctions(plr, query, usableCheck != 0, start_index, 50, page);
 
-        // Page system.
-        ++counted_items;
-        if (counted_items >= start_index + 50)
-            continue;
-        current_index++;
-        if (start_index && current_index < start_index) continue;
+    // all checks passed -> add to packet.
+    for (std::vector<Auction*>::iterator itr = page.begin(); itr != page.end(); ++itr)
+        (*itr)->AddToPacket(data);
 
-        // all checks passed -> add to packet.
-        itr->second->AddToPacket(data);
-        (*(uint32*)&data.contents()[0])++;
-    }
+    data.put<uint32>(0, static_cast<uint32>(page.size()));
 
     // total count
     data << uint32(1 + counted_items);
@@ -856,6 +800,7 @@ void AuctionHouse::LoadAuctions()
         auct->Deleted = false;
 
         auctions.insert(std::unordered_map<uint32, Auction*>::value_type(auct->Id, auct));
+        searchIndex.addAuction(auct);
     }
     while (result->NextRow());
     delete result;
@@ -963,6 +908,7 @@ void AuctionHouse::AddAuction(Auction* auct)
     // add to the map
     auctionLock.AcquireWriteLock();
     auctions.insert(std::unordered_map<uint32, Auction*>::value_type(auct->Id, auct));
+    searchIndex.addAuction(auct);
     auctionLock.ReleaseWriteLock();
 
     LogDebug("AuctionHouse : %u: Add auction %u, expire@ %u.", dbc->id, auct->Id, auct->ExpiryTime);
@@ -1056,6 +1002,7 @@ void AuctionHouse::RemoveAuction(Auction* auct)
     // Remove the auction from the hashmap.
     auctionLock.AcquireWriteLock();
     auctions.erase(auct->Id);
+    searchIndex.removeAuction(auct);
     auctionLock.ReleaseWriteLock();
 
     // Destroy the item from memory (it still remains in the db)
@@ -1297,92 +1244,32 @@ void AuctionHouse::SendAuctionList(Player* plr, WorldPacket* packet)
     for (uint8 i = 0; i < 15; ++i)
         packet->read_skip<uint8>();
 
+    // convert auction string to lowercase for faster parsing.
+    for (uint32 j = 0; j < searchedname.length(); ++j)
+        searchedname[j] = static_cast<char>(tolower(searchedname[j]));
+
+    AuctionSearchQuery query;
+    query.name = searchedname;
+    query.levelMin = levelmin;
+    query.levelMax = levelmax;
+    query.inventoryType = static_cast<int32>(auctionSlotID);
+    query.itemClass = static_cast<int32>(auctionMainCategory);
+    query.itemSubClass = static_cast<int32>(auctionSubCategory);
+    query.quality = static_cast<int32>(quality);
+
     WorldPacket data(SMSG_AUCTION_LIST_RESULT, 7000);
-    uint32 count = 0;
-    uint32 totalcount = 0;
     data << uint32(0);
 
-    // convert auction string to lowercase for faster parsing.
-    if (searchedname.length() > 0)
-    {
-        for (uint32 j = 0; j < searchedname.length(); ++j)
-            searchedname[j] = static_cast<char>(tolower(searchedname[j]));
-    }
+    std::vector<Auction*> page;
 
     auctionLock.AcquireReadLock();
-    std::unordered_map<uint32, Auction*>::iterator itr = auctions.begin();
-    ItemProperties const* proto;
-    for (; itr != auctions.end(); ++itr)
-    {
-        if (itr->second->Deleted) continue;
-        proto = itr->second->pItem->GetItemProperties();
-
-        // Check the auction for parameters
-
-        // inventory type
-        if (auctionSlotID != -1 && auctionSlotID != (int32)proto->InventoryType)
-            continue;
-
-        // class
-        if (auctionMainCategory != 0xffffffff && auctionMainCategory != (int32)proto->Class)
-            continue;
-
-        // subclass
-        if (auctionSubCategory != 0xffffffff && auctionSubCategory != (int32)proto->SubClass)
-            continue;
-
-        // this is going to hurt. - name
-        std::string proto_lower = proto->lowercase_name;
-        if (searchedname.length() > 0 && !FindXinYString(searchedname, proto_lower))
-            continue;
-
-        // rarity
-        if (quality != 0xffffffff && quality > (int32)proto->Quality)
-            continue;
-
-        // level range check - lower boundary
-        if (levelmin && proto->RequiredLevel < levelmin)
-            continue;
-
-        // level range check - high boundary
-        if (levelmax && proto->RequiredLevel > levelmax)
-            continue;
-
-        // usable check - this will hurt too :(
-        if (quality)
-        {
-            // allowed class
-            if (proto->AllowableClass && !(plr->getClassMask() & proto->AllowableClass))
-                continue;
-
-            if (proto->RequiredLevel && proto->RequiredLevel > plr->getLevel())
-                continue;
-
-            if (proto->AllowableRace && !(plr->getRaceMask() & proto->AllowableRace))
-                continue;
+    const uint32 totalcount = SearchAuctions(plr, query, usable != 0, listfrom, 50, page);
 
-            if (proto->Class == 4 && proto->SubClass && !(plr->GetArmorProficiency() & (((uint32)(1)) << proto->SubClass)))
-                continue;
-
-            if (proto->Class == 2 && proto->SubClass && !(plr->GetWeaponProficiency() & (((uint32)(1)) << proto->SubClass)))
-                continue;
-
-            if (proto->RequiredSkill && (!plr->_HasSkillLine(proto->RequiredSkill) || proto->RequiredSkillRank > plr->_GetSkillLineCurrent(proto->RequiredSkill, true)))
-                continue;
-        }
-
-        // Add the item if no search term or if entered search term was found
-        if (count < 50 && totalcount >= listfrom)
-        {
-            ++count;
-            itr->second->BuildAuctionInfo(data);
-        }
-
-        ++totalcount;
-    }
+    for (std::vector<Auction*>::iterator itr = page.begin(); itr != page.end(); ++itr)
+        (*itr)->BuildAuctionInfo(data);
 
     // total count
-    data.put<uint32>(0, count);
+    data.put<uint32>(0, static_cast<uint32>(page.size()));
     data << uint32(totalcount);
     data << uint32(300);
 
@@ -1426,8 +1313,99 @@ void AuctionHouse::LoadAuctions()
         auct->Deleted = false;
 
         auctions.insert(std::unordered_map<uint32, Auction*>::value_type(auct->Id, auct));
+        searchIndex.addAuction(auct);
     }
     while (result->NextRow());
     delete result;
 }
 #endif
+
+namespace
+{
+    bool IsAuctionUsableBy(Player* plr, ItemProperties const* proto)
+    {
+        // allowed class
+        if (proto->AllowableClass && !(plr->getClassMask() & proto->AllowableClass))
+            return false;
+
+        if (proto->RequiredLevel && proto->RequiredLevel > plr->getLevel())
+            return false;
+
+        if (proto->AllowableRace && !(plr->getRaceMask() & proto->AllowableRace))
+            return false;
+
+        if (proto->Class == 4 && proto->SubClass && !(plr->GetArmorProficiency() & (((uint32)(1)) << proto->SubClass)))
+            return false;
+
+        if (proto->Class == 2 && proto->SubClass && !(plr->GetWeaponProficiency() & (((uint32)(1)) << proto->SubClass)))
+            return false;
+
+        if (proto->RequiredSkill && (!plr->_HasSkillLine(proto->RequiredSkill) || proto->RequiredSkillRank > plr->_GetSkillLineCurrent(proto->RequiredSkill, true)))
+            return false;
+
+        return true;
+    }
+}
+
+uint32 AuctionHouse::SearchAuctions(Player* plr, const AuctionSearchQuery& query, bool usable, uint32 startIndex, uint32 pageSize, std::vector<Auction*>& page)
+{
+    // the usable check depends on the player level, a level up starts a new search
+    std::stringstream key;
+    key << query.name << '|' << query.levelMin << '|' << query.levelMax << '|' << query.inventoryType << '|' << query.itemClass << '|'
+        << query.itemSubClass << '|' << query.quality << '|' << (usable ? plr->getLevel() : 0);
+
+    const uint32 playerGuid = plr->GetLowGUID();
+
+    // continue where the last page of the same search ended, its total is still valid
+    uint32 afterId = 0;
+    uint32 skip = startIndex;
+    bool knowTotal = false;
+    AuctionSearchCursor cursor;
+
+    searchCursorLock.Acquire();
+    std::unordered_map<uint32, AuctionSearchCursor>::iterator itr = searchCursors.find(playerGuid);
+    if (itr != searchCursors.end() && itr->second.queryKey == key.str() && itr->second.version == searchIndex.getVersion() && itr->second.nextIndex == startIndex)
+    {
+        cursor = itr->second;
+        afterId = cursor.lastAuctionId;
+        skip = 0;
+        knowTotal = true;
+    }
+    searchCursorLock.Release();
+
+    uint32 matched = 0;
+    uint32 lastAuctionId = afterId;
+    searchIndex.search(query, afterId, [&](Auction* auction)
+    {
+        if (usable && !IsAuctionUsableBy(plr, auction->pItem->GetItemProperties()))
+            return true;
+
+        if (++matched > skip && page.size() < pageSize)
+        {
+            page.push_back(auction);
+            lastAuctionId = auction->Id;
+        }
+
+        // the total has to be counted unless the cursor knows it
+        return !knowTotal || page.size() < pageSize;
+    });
+
+    const uint32 totalCount = knowTotal ? cursor.totalCount : matched;
+
+    cursor.queryKey = key.str();
+    cursor.version = searchIndex.getVersion();
+    cursor.nextIndex = startIndex + static_cast<uint32>(page.size());
+    cursor.lastAuctionId = lastAuctionId;
+    cursor.totalCount = totalCount;
+
+    searchCursorLock.Acquire();
+
+    // players browse a few pages and leave, no need to track each of them
+    if (searchCursors.size() >= 1024)
+        searchCursors.clear();
+
+    searchCursors[playerGuid] = cursor;
+    searchCursorLock.Release();
+
+    return totalCount;
+}
@@ -24,6 +24,7 @@
 #include "Storage/DBC/DBCStructures.hpp"
 #include "WorldConf.h"
 #include "Item.h"
+#include "AuctionSearchIndex.h"
 
 enum AuctionRemoveType
 {
@@ -139,8 +140,17 @@ class AuctionHouse
 
     private:
 
+        /// Fills page with up to pageSize auctions matching query, starting at the startIndex'th match.
+        /// Returns the number of all matches. Has to be called with auctionLock held.
+        uint32 SearchAuctions(Player* plr, const AuctionSearchQuery& query, bool usable, uint32 startIndex, uint32 pageSize, std::vector<Auction*>& page);
+
         RWLock auctionLock;
         std::unordered_map<uint32, Auction*> auctions;
+        AuctionSearchIndex searchIndex;
+
+        // last search page per player (low guid)
+        Mutex searchCursorLock;
+        std::unordered_map<uint32, AuctionSearchCursor> searchCursors;
 
         Mutex removalLock;
         std::list<Auction*> removalList;
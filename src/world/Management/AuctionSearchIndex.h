@@ -0,0 +1,339 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "Management/ItemPrototype.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Auction;
+
+struct AuctionSearchQuery
+{
+    AuctionSearchQuery() : levelMin(0), levelMax(0), inventoryType(-1), itemClass(-1), itemSubClass(-1), quality(-1) {}
+
+    std::string name;           // lowercase, empty matches every name
+    uint32_t levelMin;          // 0 = no limit
+    uint32_t levelMax;          // 0 = no limit
+    int32_t inventoryType;      // -1 = any
+    int32_t itemClass;          // -1 = any
+    int32_t itemSubClass;       // -1 = any
+    int32_t quality;            // minimum quality, -1 = any
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Posting lists of the auctions of one AuctionHouse.
+///
+/// Auctions are listed by class, class + subclass, inventory type and item entry, each
+/// list sorted by auction id. Item names are found through a trigram index over the item
+/// entries currently on sale. A search walks the shortest matching list and checks the
+/// remaining criteria per auction, so results always come in auction id order and a page
+/// can be continued from the last returned id. Guarded by the auctionLock of the house.
+///
+/// Header only and templated on the auction, which needs Id, Deleted and
+/// pItem->GetItemProperties(), so the tests can index auctions without items.
+//////////////////////////////////////////////////////////////////////////////////////////
+template <class AuctionT>
+class BasicAuctionSearchIndex
+{
+    public:
+
+        typedef std::map<uint32_t, AuctionT*> PostingList;
+
+        BasicAuctionSearchIndex() : m_version(0) {}
+
+        void addAuction(AuctionT* auction)
+        {
+            ItemProperties const* proto = auction->pItem->GetItemProperties();
+
+            IndexedAuction indexed;
+            indexed.entry = proto->ItemId;
+            indexed.itemClass = proto->Class;
+            indexed.itemSubClass = proto->SubClass;
+            indexed.inventoryType = proto->InventoryType;
+
+            if (!m_indexed.insert(std::make_pair(auction->Id, indexed)).second)
+                return;
+
+            m_all[auction->Id] = auction;
+            m_byClass[indexed.itemClass][auction->Id] = auction;
+            m_bySubClass[_getSubClassKey(indexed.itemClass, indexed.itemSubClass)][auction->Id] = auction;
+            m_byInventoryType[indexed.inventoryType][auction->Id] = auction;
+
+            IndexedEntry& entry = m_byEntry[indexed.entry];
+            if (entry.auctions.empty())
+            {
+                // first auction of this item, make its name searchable
+                _getTrigrams(proto->lowercase_name, entry.trigrams);
+                for (std::vector<uint32_t>::const_iterator itr = entry.trigrams.begin(); itr != entry.trigrams.end(); ++itr)
+                    m_entriesByTrigram[*itr].insert(indexed.entry);
+            }
+
+            entry.auctions[auction->Id] = auction;
+            ++m_version;
+        }
+
+        void removeAuction(AuctionT* auction)
+        {
+            typename std::unordered_map<uint32_t, IndexedAuction>::iterator indexed = m_indexed.find(auction->Id);
+            if (indexed == m_indexed.end())
+                return;
+
+            // keys are taken from the add, the item properties might have been reloaded since
+            const IndexedAuction& keys = indexed->second;
+
+            const auto removeFrom = [auction](PostingList& list)
+            {
+                list.erase(auction->Id);
+                return list.empty();
+            };
+
+            m_all.erase(auction->Id);
+
+            if (removeFrom(m_byClass[keys.itemClass]))
+                m_byClass.erase(keys.itemClass);
+
+            if (removeFrom(m_bySubClass[_getSubClassKey(keys.itemClass, keys.itemSubClass)]))
+                m_bySubClass.erase(_getSubClassKey(keys.itemClass, keys.itemSubClass));
+
+            if (removeFrom(m_byInventoryType[keys.inventoryType]))
+                m_byInventoryType.erase(keys.inventoryType);
+
+            typename std::unordered_map<uint32_t, IndexedEntry>::iterator entry = m_byEntry.find(keys.entry);
+            if (entry != m_byEntry.end() && removeFrom(entry->second.auctions))
+            {
+                for (std::vector<uint32_t>::const_iterator itr = entry->second.trigrams.begin(); itr != entry->second.trigrams.end(); ++itr)
+                {
+                    std::unordered_map<uint32_t, std::set<uint32_t>>::iterator entries = m_entriesByTrigram.find(*itr);
+                    if (entries == m_entriesByTrigram.end())
+                        continue;
+
+                    entries->second.erase(keys.entry);
+                    if (entries->second.empty())
+                        m_entriesByTrigram.erase(entries);
+                }
+
+                m_byEntry.erase(entry);
+            }
+
+            m_indexed.erase(indexed);
+            ++m_version;
+        }
+
+        /// increased by every add and remove, cached search positions are only valid for one version
+        uint32_t getVersion() const { return m_version; }
+        size_t getSize() const { return m_all.size(); }
+
+        /// calls func(auction) for every auction with an id above afterId matching query, in id order.
+        /// Deleted auctions are skipped. Stops early when func returns false.
+        template <typename Func>
+        void search(const AuctionSearchQuery& query, uint32_t afterId, Func func) const
+        {
+            if (!query.name.empty())
+            {
+                std::vector<AuctionT*> candidates;
+                _findByName(query.name, afterId, candidates);
+
+                for (typename std::vector<AuctionT*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+                {
+                    if (_matches(query, *itr) && !func(*itr))
+                        return;
+                }
+
+                return;
+            }
+
+            const PostingList* list = _getShortestList(query);
+            if (list == nullptr)
+                return;
+
+            for (typename PostingList::const_iterator itr = list->upper_bound(afterId); itr != list->end(); ++itr)
+            {
+                if (_matches(query, itr->second) && !func(itr->second))
+                    return;
+            }
+        }
+
+    private:
+
+        struct IndexedAuction
+        {
+            uint32_t entry;
+            uint32_t itemClass;
+            uint32_t itemSubClass;
+            uint32_t inventoryType;
+        };
+
+        struct IndexedEntry
+        {
+            PostingList auctions;
+            std::vector<uint32_t> trigrams;
+        };
+
+        static uint64_t _getSubClassKey(uint32_t itemClass, uint32_t itemSubClass) { return (uint64_t(itemClass) << 32) | itemSubClass; }
+        static void _getTrigrams(const std::string& name, std::vector<uint32_t>& trigrams)
+        {
+            trigrams.clear();
+            for (size_t i = 0; i + 3 <= name.length(); ++i)
+            {
+                trigrams.push_back((uint32_t(uint8_t(name[i])) << 16) | (uint32_t(uint8_t(name[i + 1])) << 8) | uint8_t(name[i + 2]));
+            }
+
+            std::sort(trigrams.begin(), trigrams.end());
+            trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        }
+
+        bool _matches(const AuctionSearchQuery& query, AuctionT* auction) const
+        {
+            if (auction->Deleted)
+                return false;
+
+            ItemProperties const* proto = auction->pItem->GetItemProperties();
+
+            if (query.inventoryType != -1 && query.inventoryType != int32_t(proto->InventoryType))
+                return false;
+
+            if (query.itemClass != -1 && query.itemClass != int32_t(proto->Class))
+                return false;
+
+            if (query.itemSubClass != -1 && query.itemSubClass != int32_t(proto->SubClass))
+                return false;
+
+            if (query.quality != -1 && query.quality > int32_t(proto->Quality))
+                return false;
+
+            if (query.levelMin && proto->RequiredLevel < query.levelMin)
+                return false;
+
+            if (query.levelMax && proto->RequiredLevel > query.levelMax)
+                return false;
+
+            return true;
+        }
+
+        const PostingList* _getShortestList(const AuctionSearchQuery& query) const
+        {
+            const PostingList* shortest = &m_all;
+
+            // an attribute without any auction means there can't be a result
+            if (query.itemClass != -1)
+            {
+                if (query.itemSubClass != -1)
+                {
+                    typename std::unordered_map<uint64_t, PostingList>::const_iterator itr = m_bySubClass.find(_getSubClassKey(query.itemClass, query.itemSubClass));
+                    if (itr == m_bySubClass.end())
+                        return nullptr;
+
+                    shortest = &itr->second;
+                }
+                else
+                {
+                    typename std::unordered_map<uint32_t, PostingList>::const_iterator itr = m_byClass.find(query.itemClass);
+                    if (itr == m_byClass.end())
+                        return nullptr;
+
+                    shortest = &itr->second;
+                }
+            }
+
+            if (query.inventoryType != -1)
+            {
+                typename std::unordered_map<uint32_t, PostingList>::const_iterator itr = m_byInventoryType.find(query.inventoryType);
+                if (itr == m_byInventoryType.end())
+                    return nullptr;
+
+                if (itr->second.size() < shortest->size())
+                    shortest = &itr->second;
+            }
+
+            return shortest;
+        }
+
+        void _findByName(const std::string& name, uint32_t afterId, std::vector<AuctionT*>& candidates) const
+        {
+            std::vector<uint32_t> entries;
+
+            std::vector<uint32_t> trigrams;
+            _getTrigrams(name, trigrams);
+
+            if (trigrams.empty())
+            {
+                // names shorter than a trigram, check every item on sale
+                for (typename std::unordered_map<uint32_t, IndexedEntry>::const_iterator itr = m_byEntry.begin(); itr != m_byEntry.end(); ++itr)
+                    entries.push_back(itr->first);
+            }
+            else
+            {
+                // intersect the entry sets, starting with the smallest one
+                std::vector<const std::set<uint32_t>*> sets;
+                for (std::vector<uint32_t>::const_iterator itr = trigrams.begin(); itr != trigrams.end(); ++itr)
+                {
+                    std::unordered_map<uint32_t, std::set<uint32_t>>::const_iterator entriesItr = m_entriesByTrigram.find(*itr);
+                    if (entriesItr == m_entriesByTrigram.end())
+                        return;
+
+                    sets.push_back(&entriesItr->second);
+                }
+
+                std::sort(sets.begin(), sets.end(), [](const std::set<uint32_t>* a, const std::set<uint32_t>* b) { return a->size() < b->size(); });
+
+                for (std::set<uint32_t>::const_iterator itr = sets.front()->begin(); itr != sets.front()->end(); ++itr)
+                {
+                    bool inAll = true;
+                    for (size_t i = 1; i < sets.size() && inAll; ++i)
+                        inAll = sets[i]->count(*itr) != 0;
+
+                    if (inAll)
+                        entries.push_back(*itr);
+                }
+            }
+
+            for (std::vector<uint32_t>::const_iterator itr = entries.begin(); itr != entries.end(); ++itr)
+            {
+                const PostingList& auctions = m_byEntry.find(*itr)->second.auctions;
+
+                // the trigrams only narrow it down, the name has to contain the whole search string
+                ItemProperties const* proto = auctions.begin()->second->pItem->GetItemProperties();
+                if (proto->lowercase_name.find(name) == std::string::npos)
+                    continue;
+
+                for (typename PostingList::const_iterator auction = auctions.upper_bound(afterId); auction != auctions.end(); ++auction)
+                    candidates.push_back(auction->second);
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const AuctionT* a, const AuctionT* b) { return a->Id < b->Id; });
+        }
+
+        PostingList m_all;
+        std::unordered_map<uint32_t, IndexedAuction> m_indexed;
+
+        std::unordered_map<uint32_t, PostingList> m_byClass;
+        std::unordered_map<uint64_t, PostingList> m_bySubClass;
+        std::unordered_map<uint32_t, PostingList> m_byInventoryType;
+
+        std::unordered_map<uint32_t, IndexedEntry> m_byEntry;
+        std::unordered_map<uint32_t, std::set<uint32_t>> m_entriesByTrigram;
+
+        uint32_t m_version;
+};
+
+typedef BasicAuctionSearchIndex<Auction> AuctionSearchIndex;
+
+/// Where the last auction list page of a player ended, lets the next page continue there
+struct AuctionSearchCursor
+{
+    std::string queryKey;
+    uint32_t version;
+    uint32_t nextIndex;
+    uint32_t lastAuctionId;
+    uint32_t totalCount;
+};
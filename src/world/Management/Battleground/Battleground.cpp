@@ -256,6 +256,9 @@ void CBattleground::AddPlayer(Player* plr, uint32 team)
     /* This is called when the player is added, not when they port. So, they're essentially still queued, but not inside the bg yet */
     m_pendPlayers[team].insert(plr->GetLowGUID());
 
+    // the other faction may have a free slot now, e.g. for a player who was queued for this instance
+    BattlegroundManager.OnInstanceSlotsChanged(m_type, m_levelGroup);
+
     /* Send a packet telling them that they can enter */
     plr->m_pendingBattleground = this;
     BattlegroundManager.SendBattlefieldStatus(plr, BGSTATUS_READY, m_type, m_id, 80000, m_mapMgr->GetMapId(), Rated());        // You will be removed from the queue in 2 minutes.
@@ -269,6 +272,7 @@ void CBattleground::RemovePendingPlayer(Player* plr)
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
     m_pendPlayers[plr->m_bgTeam].erase(plr->GetLowGUID());
+    BattlegroundManager.OnInstanceSlotsChanged(m_type, m_levelGroup);
 
     /* send a null bg update (so they don't join) */
     BattlegroundManager.SendBattlefieldStatus(plr, BGSTATUS_NOFLAGS, 0, 0, 0, 0, 0);
@@ -638,6 +642,7 @@ void CBattleground::RemovePlayer(Player* plr, bool logout)
     plr->FullHPMP();
     m_players[plr->m_bgTeam].erase(plr);
     memset(&plr->m_bgScore, 0, sizeof(BGScore));
+    BattlegroundManager.OnInstanceSlotsChanged(m_type, m_levelGroup);
 
     /* are we in the group? */
     if (plr->GetGroup() == m_groups[plr->m_bgTeam])
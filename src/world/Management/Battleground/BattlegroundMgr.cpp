@@ -36,12 +36,17 @@ CBattlegroundManager::CBattlegroundManager() : EventableObject()
     // Yes we will be running from WorldRunnable
     m_holder = sEventMgr.GetEventHolder(WORLD_INSTANCE);
 
-    sEventMgr.AddEvent(this, &CBattlegroundManager::EventQueueUpdate, EVENT_BATTLEGROUND_QUEUE_UPDATE, 15000, 0, 0);
+    // only queues that changed since the last update are matched, so this can run often
+    sEventMgr.AddEvent(this, &CBattlegroundManager::EventQueueUpdate, EVENT_BATTLEGROUND_QUEUE_UPDATE, 1000, 0, 0);
 
     for (uint8 i = 0; i < BATTLEGROUND_NUM_TYPES; i++)
     {
         m_instances[i].clear();
         m_maxBattlegroundId[i] = 0;
+        m_ratedQueueChanged[i] = false;
+
+        for (uint8 j = 0; j < MAX_LEVEL_GROUP; ++j)
+            m_queueChanged[i][j] = false;
     }
 
     // These battlegrounds will be available in Random Battleground queue
@@ -204,7 +209,8 @@ void CBattlegroundManager::HandleBattlegroundJoin(WorldSession* m_session, World
 
     // Queue him!
     m_queueLock.Acquire();
-    m_queuedPlayers[bgtype][lgroup].push_back(pguid);
+    m_queue.addPlayer(pguid, bgtype, lgroup, plr->GetTeam(), instance);
+    m_queueChanged[bgtype][lgroup] = true;
     LogNotice("BattlegroundManager : Player %u is now in battleground queue for instance %u", m_session->GetPlayer()->GetLowGUID(), (instance + 1));
 
     plr->m_bgIsQueued = true;
@@ -223,18 +229,6 @@ void CBattlegroundManager::HandleBattlegroundJoin(WorldSession* m_session, World
     m_queueLock.Release();
 }
 
-void ErasePlayerFromList(uint32 guid, std::list<uint32>* l)
-{
-    for (std::list<uint32>::iterator itr = l->begin(); itr != l->end(); ++itr)
-    {
-        if ((*itr) == guid)
-        {
-            l->erase(itr);
-            return;
-        }
-    }
-}
-
 uint8 GetBattlegroundCaption(BattleGroundTypes bgType)
 {
     switch (bgType)
@@ -264,9 +258,6 @@ void CBattlegroundManager::HandleGetBattlegroundQueueCommand(WorldSession* m_ses
 {
     std::stringstream ss;
 
-    Player* plr;
-    std::list<uint32>::iterator it3, it4;
-
     m_queueLock.Acquire();
 
     bool foundSomething = false;
@@ -275,7 +266,9 @@ void CBattlegroundManager::HandleGetBattlegroundQueueCommand(WorldSession* m_ses
     {
         for (uint8 j = 0; j < MAX_LEVEL_GROUP; ++j)
         {
-            if (!m_queuedPlayers[i][j].size())
+            const uint32 ally = static_cast<uint32>(m_queue.getPlayerCount(i, j, TEAM_ALLIANCE));
+            const uint32 horde = static_cast<uint32>(m_queue.getPlayerCount(i, j, TEAM_HORDE));
+            if (ally + horde == 0)
                 continue;
 
             foundSomething = true;
@@ -312,33 +305,10 @@ void CBattlegroundManager::HandleGetBattlegroundQueueCommand(WorldSession* m_ses
 
             ss << ": ";
 
-            ss << (uint32)m_queuedPlayers[i][j].size() << " players queued";
+            ss << (ally + horde) << " players queued";
 
             if (!IS_ARENA(i))
-            {
-                int ally = 0, horde = 0;
-
-                for (it3 = m_queuedPlayers[i][j].begin(); it3 != m_queuedPlayers[i][j].end();)
-                {
-                    it4 = it3++;
-                    plr = objmgr.GetPlayer(*it4);
-
-                    if (!plr || GetLevelGrouping(plr->getLevel()) != j)
-                    {
-                        continue;
-                    }
-
-                    if (plr->IsTeamAlliance())
-                        ally++;
-                    else
-                        horde++;
-                }
-
-                ss << " (Alliance: " << ally << " Horde: " << horde;
-                if ((int)m_queuedPlayers[i][j].size() > (ally + horde))
-                    ss << " Unknown: " << ((int)m_queuedPlayers[i][j].size() - ally - horde);
-                ss << ")";
-            }
+                ss << " (Alliance: " << ally << " Horde: " << horde << ")";
 
             m_session->SystemMessage(ss.str().c_str());
             ss.rdbuf()->str("");
@@ -346,12 +316,12 @@ void CBattlegroundManager::HandleGetBattlegroundQueueCommand(WorldSession* m_ses
 
         if (IS_ARENA(i))
         {
-            if (m_queuedGroups[i].size())
+            if (m_queue.getRatedGroupCount(i))
             {
                 foundSomething = true;
 
                 ss << m_session->LocalizedWorldSrv(GetBattlegroundCaption((BattleGroundTypes)i)) << " (rated): ";
-                ss << (uint32)m_queuedGroups[i].size() << " groups queued";
+                ss << (uint32)m_queue.getRatedGroupCount(i) << " groups queued";
 
                 m_session->SystemMessage(ss.str().c_str());
                 ss.rdbuf()->str("");
@@ -446,8 +416,6 @@ int CBattlegroundManager::CreateArenaType(int type, Group* group1, Group* group2
     if (ar == NULL)
     {
         LOG_ERROR("%s (%u): Couldn't create Arena Instance", __FILE__, __LINE__);
-        m_queueLock.Release();
-        m_instanceLock.Release();
         return -1;
     }
     ar->rated_match = true;
@@ -458,32 +426,7 @@ int CBattlegroundManager::CreateArenaType(int type, Group* group1, Group* group2
     return 0;
 }
 
-void CBattlegroundManager::AddPlayerToBg(CBattleground* bg, std::deque<uint32> *playerVec, uint32 i, uint32 j)
-{
-    uint32 plrguid = *playerVec->begin();
-    playerVec->pop_front();
-
-    Player* plr = objmgr.GetPlayer(plrguid);
-    if (plr)
-    {
-        if (bg->CanPlayerJoin(plr, bg->GetType()))
-        {
-            bg->AddPlayer(plr, plr->GetTeam());
-            ErasePlayerFromList(plr->GetLowGUID(), &m_queuedPlayers[i][j]);
-        }
-        else
-        {
-            // Put again the player in the queue
-            playerVec->push_back(plrguid);
-        }
-    }
-    else
-    {
-        ErasePlayerFromList(plrguid, &m_queuedPlayers[i][j]);
-    }
-}
-
-void CBattlegroundManager::AddPlayerToBgTeam(CBattleground* bg, std::deque<uint32> *playerVec, uint32 i, uint32 j, int Team)
+void CBattlegroundManager::AddPlayerToBgTeam(CBattleground* bg, std::deque<uint32> *playerVec, int Team)
 {
     if (bg->HasFreeSlots(Team, bg->GetType()))
     {
@@ -496,18 +439,90 @@ void CBattlegroundManager::AddPlayerToBgTeam(CBattleground* bg, std::deque<uint3
             plr->m_bgTeam = Team;
             bg->AddPlayer(plr, Team);
         }
-        ErasePlayerFromList(plrguid, &m_queuedPlayers[i][j]);
+        m_queue.removePlayer(plrguid);
     }
 }
 
+void CBattlegroundManager::OnInstanceSlotsChanged(uint32 type, uint32 levelGroup)
+{
+    if (type >= BATTLEGROUND_NUM_TYPES || levelGroup >= MAX_LEVEL_GROUP)
+        return;
+
+    m_queueChanged[type][levelGroup] = true;
+
+    // the random queue fills every battleground type it can start
+    if (std::find(avalibleInRandom.begin(), avalibleInRandom.end(), type) != avalibleInRandom.end())
+        m_queueChanged[BATTLEGROUND_RANDOM][levelGroup] = true;
+}
+
+void CBattlegroundManager::OnQueuedPlayerChanged(Player* plr)
+{
+    if (!plr->m_bgIsQueued || plr->m_bgQueueType >= BATTLEGROUND_NUM_TYPES)
+        return;
+
+    const uint32 levelGroup = GetLevelGrouping(plr->getLevel());
+    if (levelGroup < MAX_LEVEL_GROUP)
+        m_queueChanged[plr->m_bgQueueType][levelGroup] = true;
+}
+
+uint32 CBattlegroundManager::GetRatedQueueDiff(uint32 joinTime, uint32 now)
+{
+    uint32 diff = worldConfig.rate.arenaQueueDiff;
+    if (worldConfig.arena.queueDiffStep == 0)
+        return diff;
+
+    diff += (getMSTimeDiff(joinTime, now) / 60000) * worldConfig.arena.queueDiffStep;
+    return std::min(diff, std::max(worldConfig.arena.queueDiffMax, worldConfig.rate.arenaQueueDiff));
+}
+
 void CBattlegroundManager::EventQueueUpdate(bool forceStart)
+{
+    m_queueLock.Acquire();
+    m_instanceLock.Acquire();
+
+    for (uint8 i = 0; i < BATTLEGROUND_NUM_TYPES; ++i)
+    {
+        for (uint8 j = 0; j < MAX_LEVEL_GROUP; ++j)
+        {
+            // nothing joined and no slot got free since the last match
+            if (!m_queueChanged[i][j].exchange(false) && !forceStart)
+                continue;
+
+            if (!UpdateQueue(i, j, forceStart))
+            {
+                m_queueChanged[i][j] = true;
+                m_queueLock.Release();
+                m_instanceLock.Release();
+                return;
+            }
+        }
+    }
+
+    // Handle paired arena team joining
+    for (uint8 i = BATTLEGROUND_ARENA_2V2; i <= BATTLEGROUND_ARENA_5V5; ++i)
+    {
+        // without widening the rating range only a new group can lead to a match
+        if (!m_ratedQueueChanged[i].exchange(false) && !forceStart && worldConfig.arena.queueDiffStep == 0)
+            continue;
+
+        if (!UpdateRatedQueue(i, forceStart))
+        {
+            m_ratedQueueChanged[i] = true;
+            break;
+        }
+    }
+
+    m_queueLock.Release();
+    m_instanceLock.Release();
+}
+
+bool CBattlegroundManager::UpdateQueue(uint32 i, uint32 j, bool forceStart)
 {
     std::deque<uint32> tempPlayerVec[2];
 
     Player* plr;
     CBattleground* bg;
 
-    std::list<uint32>::iterator it3, it4;
     std::map<uint32, CBattleground*>::iterator iitr;
 
     Arena* arena;
@@ -519,375 +534,330 @@ void CBattlegroundManager::EventQueueUpdate(bool forceStart)
 
     std::queue<uint32> teams[MAX_PLAYER_TEAMS];
 
-    m_queueLock.Acquire();
-    m_instanceLock.Acquire();
+    // We try to add the players who queued for a specific Bg/Arena instance to
+    // the Bg/Arena where they queued to, both factions in join order, since one
+    // faction joining frees slots for the other
+    const BattlegroundQueue::GuidList requested = m_queue.getInstancePlayers(i, j);
+    for (BattlegroundQueue::GuidList::const_iterator itr = requested.begin(); itr != requested.end(); ++itr)
+    {
+        plr = objmgr.GetPlayer(*itr);
 
-    for (uint8 i = 0; i < BATTLEGROUND_NUM_TYPES; ++i)
+        // Player has left the game or switched level group since queuing (by leveling for example)
+        if (!plr || GetLevelGrouping(plr->getLevel()) != j)
+        {
+            m_queue.removePlayer(*itr);
+            continue;
+        }
+
+        iitr = m_instances[i].find(plr->m_bgQueueInstanceId);
+        if (iitr == m_instances[i].end())
+        {
+            // queue no longer valid, since instance has closed since queuing
+            plr->GetSession()->SystemMessage(plr->GetSession()->LocalizedWorldSrv(52), plr->m_bgQueueInstanceId);
+            plr->m_bgIsQueued = false;
+            plr->m_bgQueueType = 0;
+            plr->m_bgQueueInstanceId = 0;
+            m_queue.removePlayer(*itr);
+            continue;
+        }
+
+        // can we join the specified Bg instance?
+        bg = iitr->second;
+        if (bg->CanPlayerJoin(plr, bg->GetType()))
+        {
+            bg->AddPlayer(plr, plr->GetTeam());
+            m_queue.removePlayer(*itr);
+        }
+    }
+
+    for (uint8 k = 0; k < MAX_PLAYER_TEAMS; ++k)
     {
-        for (uint8 j = 0; j < MAX_LEVEL_GROUP; ++j)
+        // and the rest, oldest first, to the list of their faction
+        const BattlegroundQueue::GuidList waiting = m_queue.getPlayers(i, j, k);
+        for (BattlegroundQueue::GuidList::const_iterator itr = waiting.begin(); itr != waiting.end(); ++itr)
         {
-            if (!m_queuedPlayers[i][j].size())
+            plr = objmgr.GetPlayer(*itr);
+            if (!plr || GetLevelGrouping(plr->getLevel()) != j)
+            {
+                m_queue.removePlayer(*itr);
                 continue;
+            }
 
-            tempPlayerVec[0].clear();
-            tempPlayerVec[1].clear();
+            if (IS_ARENA(i))
+                tempPlayerVec[k].push_back(*itr);
+            else if (!plr->HasAura(BG_DESERTER))
+                tempPlayerVec[k].push_back(*itr);
+        }
+    }
 
-            // We try to add the players who queued for a specific Bg/Arena instance to
-            // the Bg/Arena where they queued to, and add the rest to another list
-            for (it3 = m_queuedPlayers[i][j].begin(); it3 != m_queuedPlayers[i][j].end();)
-            {
-                it4 = it3++;
-                plrguid = *it4;
-                plr = objmgr.GetPlayer(plrguid);
+    /// Now that we have a list of players who didn't queue for a specific instance
+    /// try to add them to a Bg/Arena that is already under way
+    std::vector<uint32> tryJoinVec;
+    if (i == BATTLEGROUND_RANDOM)
+    {
+        tryJoinVec = avalibleInRandom;
+    }
+    else
+    {
+        tryJoinVec.push_back(i);
+    }
 
-                // Player has left the game or switched level group since queuing (by leveling for example)
-                if (!plr || GetLevelGrouping(plr->getLevel()) != j)
-                {
-                    m_queuedPlayers[i][j].erase(it4);
+    for (uint32 bgIndex = 0; bgIndex < tryJoinVec.size(); bgIndex++)
+    {
+        uint32 tmpJoinBgType = tryJoinVec[bgIndex];
+
+        for (iitr = m_instances[tmpJoinBgType].begin(); iitr != m_instances[tmpJoinBgType].end(); ++iitr)
+        {
+            if (iitr->second->HasEnded() || iitr->second->GetLevelGroup() != j)
+                continue;
+
+            if (IS_ARENA(i))
+            {
+                arena = static_cast<Arena*>(iitr->second);
+                if (arena->Rated())
                     continue;
-                }
 
-                // queued to a specific instance id?
-                if (plr->m_bgQueueInstanceId != 0)
+                factionMap[0] = arena->GetTeamFaction(0);
+                factionMap[1] = arena->GetTeamFaction(1);
+
+                team = arena->GetFreeTeam();
+                while ((team >= 0) && (tempPlayerVec[factionMap[team]].size() > 0))
                 {
-                    iitr = m_instances[i].find(plr->m_bgQueueInstanceId);
-                    if (iitr == m_instances[i].end())
+                    plrguid = *tempPlayerVec[factionMap[team]].begin();
+                    tempPlayerVec[factionMap[team]].pop_front();
+                    plr = objmgr.GetPlayer(plrguid);
+                    if (plr)
                     {
-                        // queue no longer valid, since instance has closed since queuing
-                        plr->GetSession()->SystemMessage(plr->GetSession()->LocalizedWorldSrv(52), plr->m_bgQueueInstanceId);
-                        plr->m_bgIsQueued = false;
-                        plr->m_bgQueueType = 0;
-                        plr->m_bgQueueInstanceId = 0;
-                        m_queuedPlayers[i][j].erase(it4);
-                        continue;
+                        plr->m_bgTeam = team;
+                        arena->AddPlayer(plr, team);
+                        team = arena->GetFreeTeam();
                     }
+                    m_queue.removePlayer(plrguid);
+                }
+            }
+            else
+            {
+                bg = iitr->second;
+                int size = (int)std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
+                for (int counter = 0; (counter < size) && (bg->IsFull() == false); counter++)
+                {
+                    AddPlayerToBgTeam(bg, &tempPlayerVec[0], 0);
+                    AddPlayerToBgTeam(bg, &tempPlayerVec[1], 1);
+                }
 
-                    // can we join the specified Bg instance?
-                    bg = iitr->second;
-                    if (bg->CanPlayerJoin(plr, bg->GetType()))
-                    {
-                        bg->AddPlayer(plr, plr->GetTeam());
-                        m_queuedPlayers[i][j].erase(it4);
-                    }
+                while (tempPlayerVec[0].size() > 0 && bg->HasFreeSlots(0, bg->GetType()))
+                {
+                    AddPlayerToBgTeam(bg, &tempPlayerVec[0], 0);
                 }
-                else
+                while (tempPlayerVec[1].size() > 0 && bg->HasFreeSlots(1, bg->GetType()))
                 {
-                    if (IS_ARENA(i))
-                        tempPlayerVec[plr->GetTeam()].push_back(plrguid);
-                    else if (!plr->HasAura(BG_DESERTER))
-                        tempPlayerVec[plr->GetTeam()].push_back(plrguid);
+                    AddPlayerToBgTeam(bg, &tempPlayerVec[1], 1);
                 }
             }
+        }
+    }
 
+    // Now that that we added everyone we could to a running Bg/Arena
+    // We shall see if we can start a new one!
+    if (IS_ARENA(i))
+    {
+        // enough players to start a round?
+        uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(i);
+        if (!forceStart && ((tempPlayerVec[0].size() + tempPlayerVec[1].size()) < (minPlayers * 2)))
+            return true;
 
-            /// Now that we have a list of players who didn't queue for a specific instance
-            /// try to add them to a Bg/Arena that is already under way
-            std::vector<uint32> tryJoinVec;
-            if (i == BATTLEGROUND_RANDOM)
+        if (CanCreateInstance(i, j))
+        {
+            arena = static_cast<Arena*>(CreateInstance(i, j));
+            if (arena == NULL)
             {
-                tryJoinVec = avalibleInRandom;
-            }
-            else
+                LOG_ERROR("%s (%u): Couldn't create Arena Instance", __FILE__, __LINE__);
+                return false;
+            } // No alliance in the queue
+            if (tempPlayerVec[0].size() == 0)
             {
-                tryJoinVec.push_back(i);
+                count = GetMaximumPlayers(i) * 2;
+                while ((count > 0) && (tempPlayerVec[1].size() > 0))
+                {
+                    if (teams[0].size() > teams[1].size())
+                        teams[1].push(tempPlayerVec[1].front());
+                    else
+                        teams[0].push(tempPlayerVec[1].front());
+                    tempPlayerVec[1].pop_front();
+                    count--;
+                }
             }
-
-            for (uint32 bgIndex = 0; bgIndex < tryJoinVec.size(); bgIndex++)
-            {
-                uint32 tmpJoinBgType = tryJoinVec[bgIndex];
-
-                for (iitr = m_instances[tmpJoinBgType].begin(); iitr != m_instances[tmpJoinBgType].end(); ++iitr)
+            else // No horde in the queue
+                if (tempPlayerVec[1].size() == 0)
                 {
-                    if (iitr->second->HasEnded() || iitr->second->GetLevelGroup() != j)
-                        continue;
-
-                    if (IS_ARENA(i))
+                    count = GetMaximumPlayers(i) * 2;
+                    while ((count > 0) && (tempPlayerVec[0].size() > 0))
                     {
-                        arena = static_cast<Arena*>(iitr->second);
-                        if (arena->Rated())
-                            continue;
-
-                        factionMap[0] = arena->GetTeamFaction(0);
-                        factionMap[1] = arena->GetTeamFaction(1);
-
-                        team = arena->GetFreeTeam();
-                        while ((team >= 0) && (tempPlayerVec[factionMap[team]].size() > 0))
-                        {
-                            plrguid = *tempPlayerVec[factionMap[team]].begin();
-                            tempPlayerVec[factionMap[team]].pop_front();
-                            plr = objmgr.GetPlayer(plrguid);
-                            if (plr)
-                            {
-                                plr->m_bgTeam = team;
-                                arena->AddPlayer(plr, team);
-                                team = arena->GetFreeTeam();
-                            }
-                            ErasePlayerFromList(plrguid, &m_queuedPlayers[i][j]);
-                        }
+                        if (teams[0].size() > teams[1].size())
+                            teams[1].push(tempPlayerVec[0].front());
+                        else
+                            teams[0].push(tempPlayerVec[0].front());
+                        tempPlayerVec[0].pop_front();
+                        count--;
                     }
-                    else
+                }
+                else // There are both alliance and horde players in the queue
+                {
+                    count = GetMaximumPlayers(i);
+                    while ((count > 0) && (tempPlayerVec[0].size() > 0) && (tempPlayerVec[1].size() > 0))
                     {
-                        bg = iitr->second;
-                        int size = (int)std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
-                        for (int counter = 0; (counter < size) && (bg->IsFull() == false); counter++)
-                        {
-                            AddPlayerToBgTeam(bg, &tempPlayerVec[0], i, j, 0);
-                            AddPlayerToBgTeam(bg, &tempPlayerVec[1], i, j, 1);
-                        }
-
-                        while (tempPlayerVec[0].size() > 0 && bg->HasFreeSlots(0, bg->GetType()))
-                        {
-                            AddPlayerToBgTeam(bg, &tempPlayerVec[0], i, j, 0);
-                        }
-                        while (tempPlayerVec[1].size() > 0 && bg->HasFreeSlots(1, bg->GetType()))
-                        {
-                            AddPlayerToBgTeam(bg, &tempPlayerVec[1], i, j, 1);
-                        }
+                        teams[0].push(tempPlayerVec[0].front());
+                        teams[1].push(tempPlayerVec[1].front());
+                        tempPlayerVec[0].pop_front();
+                        tempPlayerVec[1].pop_front();
+                        count--;
                     }
                 }
-            }
 
-            // Now that that we added everyone we could to a running Bg/Arena
-            // We shall see if we can start a new one!
-            if (IS_ARENA(i))
+            // Now we just need to add the players to the Arena instance
+            while (teams[0].size() > 0)
             {
-                // enough players to start a round?
-                uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(i);
-                if (!forceStart && ((tempPlayerVec[0].size() + tempPlayerVec[1].size()) < (minPlayers * 2)))
-                    continue;
+                for (uint32 team = 0; team < 2; team++)
+                {
+                    // with an odd count the first team gets the last player
+                    if (teams[team].empty())
+                        continue;
 
-                if (CanCreateInstance(i, j))
+                    plrguid = teams[team].front();
+                    teams[team].pop();
+                    plr = objmgr.GetPlayer(plrguid);
+                    if (plr == NULL)
+                        continue;
+
+                    plr->m_bgTeam = team;
+                    arena->AddPlayer(plr, plr->m_bgTeam);
+                    m_queue.removePlayer(plr->GetLowGUID());
+                }
+            }
+        }
+    }
+    else
+    {
+        uint32 bgToStart = i;
+        if (i == BATTLEGROUND_RANDOM)
+        {
+            if (!forceStart)
+            {
+                std::vector<uint32> bgPossible;
+                for (uint32 bgIndex = 0; bgIndex < avalibleInRandom.size(); bgIndex++)
                 {
-                    arena = static_cast<Arena*>(CreateInstance(i, j));
-                    if (arena == NULL)
-                    {
-                        LOG_ERROR("%s (%u): Couldn't create Arena Instance", __FILE__, __LINE__);
-                        m_queueLock.Release();
-                        m_instanceLock.Release();
-                        return;
-                    } // No alliance in the queue
-                    if (tempPlayerVec[0].size() == 0)
-                    {
-                        count = GetMaximumPlayers(i) * 2;
-                        while ((count > 0) && (tempPlayerVec[1].size() > 0))
-                        {
-                            if (teams[0].size() > teams[1].size())
-                                teams[1].push(tempPlayerVec[1].front());
-                            else
-                                teams[0].push(tempPlayerVec[1].front());
-                            tempPlayerVec[1].pop_front();
-                            count--;
-                        }
-                    }
-                    else // No horde in the queue
-                        if (tempPlayerVec[1].size() == 0)
-                        {
-                            count = GetMaximumPlayers(i) * 2;
-                            while ((count > 0) && (tempPlayerVec[0].size() > 0))
-                            {
-                                if (teams[0].size() > teams[1].size())
-                                    teams[1].push(tempPlayerVec[0].front());
-                                else
-                                    teams[0].push(tempPlayerVec[0].front());
-                                tempPlayerVec[0].pop_front();
-                                count--;
-                            }
-                        }
-                        else // There are both alliance and horde players in the queue
-                        {
-                            count = GetMaximumPlayers(i);
-                            while ((count > 0) && (tempPlayerVec[0].size() > 0) && (tempPlayerVec[1].size() > 0))
-                            {
-                                teams[0].push(tempPlayerVec[0].front());
-                                teams[1].push(tempPlayerVec[1].front());
-                                tempPlayerVec[0].pop_front();
-                                tempPlayerVec[1].pop_front();
-                                count--;
-                            }
-                        }
+                    uint32 tmpJoinBgType = avalibleInRandom[bgIndex];
 
-                    // Now we just need to add the players to the Arena instance
-                    while (teams[0].size() > 0)
+                    uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(tmpJoinBgType);
+                    if ((tempPlayerVec[0].size() >= minPlayers && tempPlayerVec[1].size() >= minPlayers))
                     {
-                        for (uint32 team = 0; team < 2; team++)
-                        {
-                            plrguid = teams[team].front();
-                            teams[team].pop();
-                            plr = objmgr.GetPlayer(plrguid);
-                            if (plr == NULL)
-                                continue;
-
-                            plr->m_bgTeam = team;
-                            arena->AddPlayer(plr, plr->m_bgTeam);
-                            // remove from the main queue (painful!)
-                            ErasePlayerFromList(plr->GetLowGUID(), &m_queuedPlayers[i][j]);
-                        }
+                        bgPossible.push_back(tmpJoinBgType);
                     }
                 }
+
+                if (bgPossible.size() > 0)
+                {
+                    uint32 num = RandomUInt(0, static_cast<uint32>(bgPossible.size() - 1));
+                    bgToStart = bgPossible[num];
+                }
             }
             else
             {
-                uint32 bgToStart = i;
-                if (i == BATTLEGROUND_RANDOM)
-                {
-                    if (!forceStart)
-                    {
-                        std::vector<uint32> bgPossible;
-                        for (uint32 bgIndex = 0; bgIndex < avalibleInRandom.size(); bgIndex++)
-                        {
-                            uint32 tmpJoinBgType = avalibleInRandom[bgIndex];
+                uint32 num = RandomUInt(0, static_cast<uint32>(avalibleInRandom.size() - 1));
+                bgToStart = avalibleInRandom[num];
+            }
+        }
 
-                            uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(tmpJoinBgType);
-                            if ((tempPlayerVec[0].size() >= minPlayers && tempPlayerVec[1].size() >= minPlayers))
-                            {
-                                bgPossible.push_back(tmpJoinBgType);
-                            }
-                        }
 
-                        if (bgPossible.size() > 0)
+        uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(bgToStart);
+        if (forceStart || ((tempPlayerVec[0].size() >= minPlayers && tempPlayerVec[1].size() >= minPlayers) && bgToStart != BATTLEGROUND_RANDOM))
+        {
+            if (CanCreateInstance(bgToStart, j))
+            {
+                bg = CreateInstance(bgToStart, j);
+                if (bg == NULL)
+                    return false;
+
+                // push as many as possible in
+                if (forceStart)
+                {
+                    for (uint8 k = 0; k < 2; ++k)
+                    {
+                        while (tempPlayerVec[k].size() && bg->HasFreeSlots(k, bg->GetType()))
                         {
-                            uint32 num = RandomUInt(0, static_cast<uint32>(bgPossible.size() - 1));
-                            bgToStart = bgPossible[num];
+                            AddPlayerToBgTeam(bg, &tempPlayerVec[k], k);
                         }
                     }
-                    else
-                    {
-                        uint32 num = RandomUInt(0, static_cast<uint32>(avalibleInRandom.size() - 1));
-                        bgToStart = avalibleInRandom[num];
-                    }
                 }
-
-
-                uint32 minPlayers = BattlegroundManager.GetMinimumPlayers(bgToStart);
-                if (forceStart || ((tempPlayerVec[0].size() >= minPlayers && tempPlayerVec[1].size() >= minPlayers) && bgToStart != BATTLEGROUND_RANDOM))
+                else
                 {
-                    if (CanCreateInstance(bgToStart, j))
+                    int size = (int)std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
+                    for (int counter = 0; (counter < size) && (bg->IsFull() == false); counter++)
                     {
-                        bg = CreateInstance(bgToStart, j);
-                        if (bg == NULL)
-                        {
-                            m_queueLock.Release();
-                            m_instanceLock.Release();
-                            return;
-                        }
-
-                        // push as many as possible in
-                        if (forceStart)
-                        {
-                            for (uint8 k = 0; k < 2; ++k)
-                            {
-                                while (tempPlayerVec[k].size() && bg->HasFreeSlots(k, bg->GetType()))
-                                {
-                                    AddPlayerToBgTeam(bg, &tempPlayerVec[k], i, j, k);
-                                }
-                            }
-                        }
-                        else
-                        {
-                            int size = (int)std::min(tempPlayerVec[0].size(), tempPlayerVec[1].size());
-                            for (int counter = 0; (counter < size) && (bg->IsFull() == false); counter++)
-                            {
-                                AddPlayerToBgTeam(bg, &tempPlayerVec[0], i, j, 0);
-                                AddPlayerToBgTeam(bg, &tempPlayerVec[1], i, j, 1);
-                            }
-                        }
+                        AddPlayerToBgTeam(bg, &tempPlayerVec[0], 0);
+                        AddPlayerToBgTeam(bg, &tempPlayerVec[1], 1);
                     }
                 }
             }
         }
     }
 
-    // Handle paired arena team joining
-    Group* group1, *group2;
-    uint32 teamids[2] = { 0, 0 };
-    uint32 avgRating[2] = { 0, 0 };
-    uint32 n;
-    std::list<uint32>::iterator itz;
-    for (uint8 i = BATTLEGROUND_ARENA_2V2; i <= BATTLEGROUND_ARENA_5V5; ++i)
-    {
-        if (!forceStart && m_queuedGroups[i].size() < 2)      // got enough to have an arena battle ;P
-        {
-            continue;
-        }
+    return true;
+}
 
-        for (uint32 j = 0; j < (uint32)m_queuedGroups[i].size(); j++)
-        {
-            group1 = group2 = NULL;
-            n = RandomUInt((uint32)m_queuedGroups[i].size()) - 1;
-            for (itz = m_queuedGroups[i].begin(); itz != m_queuedGroups[i].end() && n > 0; ++itz)
-                --n;
+bool CBattlegroundManager::UpdateRatedQueue(uint32 type, bool forceStart)
+{
+    if (!forceStart && m_queue.getRatedGroupCount(type) < 2)      // got enough to have an arena battle ;P
+        return true;
 
-            if (itz == m_queuedGroups[i].end())
-                itz = m_queuedGroups[i].begin();
+    const uint32 now = getMSTime();
 
-            if (itz == m_queuedGroups[i].end())
-            {
-                LOG_ERROR("Internal error at %s:%u", __FILE__, __LINE__);
-                m_queueLock.Release();
-                m_instanceLock.Release();
-                return;
-            }
+    // the longest waiting groups have the widest rating range, they are matched first
+    std::vector<uint32> groupIds;
+    m_queue.getRatedGroups(type, groupIds);
 
-            group1 = objmgr.GetGroupById(*itz);
-            if (group1 == NULL)
-            {
-                continue;
-            }
+    for (std::vector<uint32>::const_iterator itr = groupIds.begin(); itr != groupIds.end(); ++itr)
+    {
+        // matched with an earlier group
+        const BattlegroundQueue::RatedGroup* queued = m_queue.getRatedGroup(*itr);
+        if (queued == nullptr)
+            continue;
 
-            if (forceStart && m_queuedGroups[i].size() == 1)
-            {
-                if (CreateArenaType(i, group1, NULL) == -1) return;
-                m_queuedGroups[i].remove(group1->GetID());
-                continue;
-            }
+        Group* group1 = objmgr.GetGroupById(*itr);
+        if (group1 == NULL)
+        {
+            m_queue.removeRatedGroup(*itr);
+            continue;
+        }
 
-            teamids[0] = GetArenaGroupQInfo(group1, i, &avgRating[0]);
+        if (forceStart && m_queue.getRatedGroupCount(type) == 1)
+        {
+            if (CreateArenaType(type, group1, NULL) == -1)
+                return false;
 
-            std::list<uint32> possibleGroups;
-            for (itz = m_queuedGroups[i].begin(); itz != m_queuedGroups[i].end(); ++itz)
-            {
-                group2 = objmgr.GetGroupById(*itz);
-                if (group2)
-                {
-                    teamids[1] = GetArenaGroupQInfo(group2, i, &avgRating[1]);
-                    uint32 delta = abs((int32)avgRating[0] - (int32)avgRating[1]);
-                    if (teamids[0] != teamids[1] && delta <= worldConfig.rate.arenaQueueDiff)
-                    {
-                        possibleGroups.push_back(group2->GetID());
-                    }
-                }
-            }
+            m_queue.removeRatedGroup(group1->GetID());
+            continue;
+        }
 
-            if (possibleGroups.size() > 0)
-            {
-                n = RandomUInt((uint32)possibleGroups.size()) - 1;
-                for (itz = possibleGroups.begin(); itz != possibleGroups.end() && n > 0; ++itz)
-                    --n;
+        const uint32 opponentId = m_queue.findRatedOpponent(*itr, GetRatedQueueDiff(queued->joinTime, now));
+        if (opponentId == 0)
+            continue;
 
-                if (itz == possibleGroups.end())
-                    itz = possibleGroups.begin();
+        Group* group2 = objmgr.GetGroupById(opponentId);
+        if (group2 == NULL)
+        {
+            m_queue.removeRatedGroup(opponentId);
+            continue;
+        }
 
-                if (itz == possibleGroups.end())
-                {
-                    LOG_ERROR("Internal error at %s:%u", __FILE__, __LINE__);
-                    m_queueLock.Release();
-                    m_instanceLock.Release();
-                    return;
-                }
+        if (CreateArenaType(type, group1, group2) == -1)
+            return false;
 
-                group2 = objmgr.GetGroupById(*itz);
-                if (group2)
-                {
-                    if (CreateArenaType(i, group1, group2) == -1) return;
-                    m_queuedGroups[i].remove(group1->GetID());
-                    m_queuedGroups[i].remove(group2->GetID());
-                }
-            }
-        }
+        m_queue.removeRatedGroup(group1->GetID());
+        m_queue.removeRatedGroup(group2->GetID());
     }
 
-    m_queueLock.Release();
-    m_instanceLock.Release();
+    return true;
 }
 
 void CBattlegroundManager::RemovePlayerFromQueues(Player* plr)
@@ -898,21 +868,8 @@ void CBattlegroundManager::RemovePlayerFromQueues(Player* plr)
 
     sEventMgr.RemoveEvents(plr, EVENT_BATTLEGROUND_QUEUE_UPDATE);
 
-    uint32 lgroup = GetLevelGrouping(plr->getLevel());
-    std::list<uint32>::iterator itr;
-
-    itr = m_queuedPlayers[plr->m_bgQueueType][lgroup].begin();
-    while (itr != m_queuedPlayers[plr->m_bgQueueType][lgroup].end())
-    {
-        if ((*itr) == plr->GetLowGUID())
-        {
-            LOG_DEBUG("Removing player %u from queue instance %u type %u", plr->GetLowGUID(), plr->m_bgQueueInstanceId, plr->m_bgQueueType);
-            m_queuedPlayers[plr->m_bgQueueType][lgroup].erase(itr);
-            break;
-        }
-
-        ++itr;
-    }
+    if (m_queue.removePlayer(plr->GetLowGUID()))
+        LOG_DEBUG("Removing player %u from queue instance %u type %u", plr->GetLowGUID(), plr->m_bgQueueInstanceId, plr->m_bgQueueType);
 
     plr->m_bgIsQueued = false;
     plr->m_bgTeam = plr->GetTeam();
@@ -932,16 +889,7 @@ void CBattlegroundManager::RemovePlayerFromQueues(Player* plr)
 void CBattlegroundManager::RemoveGroupFromQueues(Group* grp)
 {
     m_queueLock.Acquire();
-    for (uint32 i = BATTLEGROUND_ARENA_2V2; i < BATTLEGROUND_ARENA_5V5 + 1; ++i)
-    {
-        for (std::list<uint32>::iterator itr = m_queuedGroups[i].begin(); itr != m_queuedGroups[i].end();)
-        {
-            if ((*itr) == grp->GetID())
-                itr = m_queuedGroups[i].erase(itr);
-            else
-                ++itr;
-        }
-    }
+    m_queue.removeRatedGroup(grp->GetID());
 
     for (GroupMembersSet::iterator itr = grp->GetSubGroup(0)->GetGroupMembersBegin(); itr != grp->GetSubGroup(0)->GetGroupMembersEnd(); ++itr)
         if ((*itr)->m_loggedInPlayer)
@@ -1081,6 +1029,9 @@ CBattleground* CBattlegroundManager::CreateInstance(uint32 Type, uint32 LevelGro
         m_instanceLock.Acquire();
         m_instances[Type].insert(std::make_pair(iid, bg));
         m_instanceLock.Release();
+
+        // players queued for this type can fill the slots left by the queue which created it
+        OnInstanceSlotsChanged(Type, LevelGroup);
         return bg;
     }
 
@@ -1146,6 +1097,9 @@ CBattleground* CBattlegroundManager::CreateInstance(uint32 Type, uint32 LevelGro
     m_instances[Type].insert(std::make_pair(iid, bg));
     m_instanceLock.Release();
 
+    // e.g. an instance started by the random queue, its own queue can fill the free slots
+    OnInstanceSlotsChanged(Type, LevelGroup);
+
     return bg;
 }
 
@@ -1161,25 +1115,23 @@ void CBattlegroundManager::DeleteBattleground(CBattleground* bg)
         m_queueLock.Acquire();
         m_instances[i].erase(bg->GetId());
 
-        // erase any queued players
-        std::list<uint32>::iterator itr = m_queuedPlayers[i][j].begin();
-        std::list<uint32>::iterator it2;
-        for (; itr != m_queuedPlayers[i][j].end();)
+        // erase any players queued for this instance
+        const BattlegroundQueue::GuidList requested = m_queue.getInstancePlayers(i, j);
+        for (BattlegroundQueue::GuidList::const_iterator itr = requested.begin(); itr != requested.end(); ++itr)
         {
-            it2 = itr++;
-            plr = objmgr.GetPlayer(*it2);
+            plr = objmgr.GetPlayer(*itr);
             if (!plr)
             {
-                m_queuedPlayers[i][j].erase(it2);
+                m_queue.removePlayer(*itr);
                 continue;
             }
 
-            if (plr && plr->m_bgQueueInstanceId == bg->GetId())
+            if (plr->m_bgQueueInstanceId == bg->GetId())
             {
                 sChatHandler.SystemMessage(plr->GetSession(), plr->GetSession()->LocalizedWorldSrv(54), bg->GetId());
                 SendBattlefieldStatus(plr, BGSTATUS_NOFLAGS, 0, 0, 0, 0, 0);
                 plr->m_bgIsQueued = false;
-                m_queuedPlayers[i][j].erase(it2);
+                m_queue.removePlayer(*itr);
             }
         }
 
@@ -1392,8 +1344,16 @@ void CBattlegroundManager::HandleArenaJoin(WorldSession* m_session, uint32 Battl
 
             pGroup->Unlock();
 
+            BattlegroundQueue::RatedGroup queued;
+            queued.groupId = pGroup->GetID();
+            queued.type = BattlegroundType;
+            queued.rating = 0;
+            queued.arenaTeamId = GetArenaGroupQInfo(pGroup, BattlegroundType, &queued.rating);
+            queued.joinTime = getMSTime();
+
             m_queueLock.Acquire();
-            m_queuedGroups[BattlegroundType].push_back(pGroup->GetID());
+            m_queue.addRatedGroup(queued);
+            m_ratedQueueChanged[BattlegroundType] = true;
             m_queueLock.Release();
             LogNotice("BattlegroundMgr : Group %u is now in battleground queue for arena type %u", pGroup->GetID(), BattlegroundType);
 
@@ -1406,7 +1366,8 @@ void CBattlegroundManager::HandleArenaJoin(WorldSession* m_session, uint32 Battl
 
     // Queue him!
     m_queueLock.Acquire();
-    m_queuedPlayers[BattlegroundType][lgroup].push_back(pguid);
+    m_queue.addPlayer(pguid, BattlegroundType, lgroup, m_session->GetPlayer()->GetTeam(), 0);
+    m_queueChanged[BattlegroundType][lgroup] = true;
     LogNotice("BattlegroundMgr : Player %u is now in battleground queue for {Arena %u}", m_session->GetPlayer()->GetLowGUID(), BattlegroundType);
 
     // send the battleground status packet
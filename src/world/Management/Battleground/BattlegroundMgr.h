@@ -24,6 +24,9 @@
 
 #include "WorldPacket.h"
 #include "Server/EventableObject.h"
+#include "BattlegroundQueue.h"
+
+#include <atomic>
 
 #define ANTI_CHEAT
 
@@ -214,11 +217,13 @@ class SERVER_DECL CBattlegroundManager : public Singleton<CBattlegroundManager>,
     uint32 m_maxBattlegroundId[BATTLEGROUND_NUM_TYPES];
 
     /// Queue System
-    // Instance Id -> list<Player guid> [ BattlegroundType ] (instance 0 - first available)
-    std::list<uint32> m_queuedPlayers[BATTLEGROUND_NUM_TYPES][MAX_LEVEL_GROUP];
+    BattlegroundQueue m_queue;
+
+    /// Set when a player joins or an instance gets a free slot, only these queues are matched again
+    std::atomic<bool> m_queueChanged[BATTLEGROUND_NUM_TYPES][MAX_LEVEL_GROUP];
 
-    // Instance Id -> list<Group id> [BattlegroundType][LevelGroup]
-    std::list<uint32> m_queuedGroups[BATTLEGROUND_NUM_TYPES];
+    /// Set when a rated arena group joins
+    std::atomic<bool> m_ratedQueueChanged[BATTLEGROUND_NUM_TYPES];
 
     Mutex m_queueLock;
 
@@ -294,6 +299,34 @@ class SERVER_DECL CBattlegroundManager : public Singleton<CBattlegroundManager>,
         void EventQueueUpdate();
         void EventQueueUpdate(bool forceStart);
 
+        //////////////////////////////////////////////////////////////////////////////////////////
+        /// void OnInstanceSlotsChanged(uint32 type, uint32 levelGroup)
+        /// \note   Called when an instance is created or a player joins or leaves one, the queues
+        ///         that can fill the free slots are matched again on the next queue update. A
+        ///         joining player frees a slot of the other faction, which has to stay even.
+        ///         Doesn't lock, it is safe to call from the map thread of the instance.
+        ///
+        /// \param  uint32 type         -  The Battleground type of the instance
+        /// \param  uint32 levelGroup   -  The level group of the instance
+        ///
+        /// \return none
+        ///
+        //////////////////////////////////////////////////////////////////////////////////////////
+        void OnInstanceSlotsChanged(uint32 type, uint32 levelGroup);
+
+        //////////////////////////////////////////////////////////////////////////////////////////
+        /// void OnQueuedPlayerChanged(Player* plr)
+        /// \note   Called when something that kept a queued player out of the matching is gone,
+        ///         e.g. the deserter debuff expired. The queue of the player is matched again on
+        ///         the next queue update. Doesn't lock, it is safe to call from a map thread.
+        ///
+        /// \param  Player* plr  -  The player, may be queued or not
+        ///
+        /// \return none
+        ///
+        //////////////////////////////////////////////////////////////////////////////////////////
+        void OnQueuedPlayerChanged(Player* plr);
+
         void HandleGetBattlegroundQueueCommand(WorldSession* m_session);
 
         void HandleBattlegroundJoin(WorldSession* m_session, WorldPacket& pck);
@@ -313,15 +346,24 @@ class SERVER_DECL CBattlegroundManager : public Singleton<CBattlegroundManager>,
 
         int CreateArenaType(int type, Group* group1, Group* group2);
 
-        void AddPlayerToBgTeam(CBattleground* bg, std::deque<uint32> *playerVec, uint32 i, uint32 j, int Team);
-
-        void AddPlayerToBg(CBattleground* bg, std::deque<uint32> *playerVec, uint32 i, uint32 j);
+        void AddPlayerToBgTeam(CBattleground* bg, std::deque<uint32> *playerVec, int Team);
 
         void AddGroupToArena(CBattleground* bg, Group* group, int nteam);
 
         uint32 GetMinimumPlayers(uint32 dbcIndex);
 
         uint32 GetMaximumPlayers(uint32 dbcIndex);
+
+    private:
+
+        /// matches the players queued for type in levelGroup, returns false when an instance couldn't be created
+        bool UpdateQueue(uint32 type, uint32 levelGroup, bool forceStart);
+
+        /// matches the rated arena groups queued for type, returns false when an instance couldn't be created
+        bool UpdateRatedQueue(uint32 type, bool forceStart);
+
+        /// allowed rating difference of a rated arena group, grows with the time it waits
+        uint32 GetRatedQueueDiff(uint32 joinTime, uint32 now);
 };
 
 #define BattlegroundManager CBattlegroundManager::getSingleton()
@@ -0,0 +1,147 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "BattlegroundQueue.h"
+
+#include <iterator>
+
+const BattlegroundQueue::GuidList& BattlegroundQueue::_getList(const std::unordered_map<uint32_t, GuidList>& buckets, uint32_t key)
+{
+    static const GuidList emptyList;
+
+    std::unordered_map<uint32_t, GuidList>::const_iterator itr = buckets.find(key);
+    return itr != buckets.end() ? itr->second : emptyList;
+}
+
+void BattlegroundQueue::addPlayer(uint32_t guid, uint32_t type, uint32_t levelGroup, uint32_t team, uint32_t instanceId)
+{
+    removePlayer(guid);
+
+    QueuedPlayer queued;
+    queued.key = _getKey(type, levelGroup, team);
+    queued.byInstance = instanceId != 0;
+
+    GuidList& list = queued.byInstance ? m_instancePlayers[_getInstanceKey(queued.key)] : m_players[queued.key];
+    queued.position = list.insert(list.end(), guid);
+
+    if (queued.byInstance)
+        ++m_instancePlayerCount[queued.key];
+
+    m_playerIndex.insert(std::make_pair(guid, queued));
+}
+
+bool BattlegroundQueue::removePlayer(uint32_t guid)
+{
+    std::unordered_map<uint32_t, QueuedPlayer>::iterator itr = m_playerIndex.find(guid);
+    if (itr == m_playerIndex.end())
+        return false;
+
+    if (itr->second.byInstance)
+    {
+        m_instancePlayers[_getInstanceKey(itr->second.key)].erase(itr->second.position);
+        --m_instancePlayerCount[itr->second.key];
+    }
+    else
+        m_players[itr->second.key].erase(itr->second.position);
+
+    m_playerIndex.erase(itr);
+    return true;
+}
+
+const BattlegroundQueue::GuidList& BattlegroundQueue::getPlayers(uint32_t type, uint32_t levelGroup, uint32_t team) const
+{
+    return _getList(m_players, _getKey(type, levelGroup, team));
+}
+
+const BattlegroundQueue::GuidList& BattlegroundQueue::getInstancePlayers(uint32_t type, uint32_t levelGroup) const
+{
+    return _getList(m_instancePlayers, _getKey(type, levelGroup, 0));
+}
+
+size_t BattlegroundQueue::getPlayerCount(uint32_t type, uint32_t levelGroup, uint32_t team) const
+{
+    std::unordered_map<uint32_t, size_t>::const_iterator itr = m_instancePlayerCount.find(_getKey(type, levelGroup, team));
+    return getPlayers(type, levelGroup, team).size() + (itr != m_instancePlayerCount.end() ? itr->second : 0);
+}
+
+void BattlegroundQueue::addRatedGroup(const RatedGroup& group)
+{
+    removeRatedGroup(group.groupId);
+
+    RatedBucket& bucket = m_ratedGroups[group.type];
+
+    QueuedRatedGroup queued;
+    queued.group = group;
+    queued.position = bucket.groups.insert(bucket.groups.end(), group.groupId);
+    queued.ratingPosition = bucket.byRating.insert(std::make_pair(group.rating, group.groupId));
+
+    m_ratedGroupIndex.insert(std::make_pair(group.groupId, queued));
+}
+
+bool BattlegroundQueue::removeRatedGroup(uint32_t groupId)
+{
+    std::unordered_map<uint32_t, QueuedRatedGroup>::iterator itr = m_ratedGroupIndex.find(groupId);
+    if (itr == m_ratedGroupIndex.end())
+        return false;
+
+    RatedBucket& bucket = m_ratedGroups[itr->second.group.type];
+    bucket.groups.erase(itr->second.position);
+    bucket.byRating.erase(itr->second.ratingPosition);
+
+    m_ratedGroupIndex.erase(itr);
+    return true;
+}
+
+const BattlegroundQueue::RatedGroup* BattlegroundQueue::getRatedGroup(uint32_t groupId) const
+{
+    std::unordered_map<uint32_t, QueuedRatedGroup>::const_iterator itr = m_ratedGroupIndex.find(groupId);
+    return itr != m_ratedGroupIndex.end() ? &itr->second.group : nullptr;
+}
+
+size_t BattlegroundQueue::getRatedGroupCount(uint32_t type) const
+{
+    std::unordered_map<uint32_t, RatedBucket>::const_iterator itr = m_ratedGroups.find(type);
+    return itr != m_ratedGroups.end() ? itr->second.groups.size() : 0;
+}
+
+void BattlegroundQueue::getRatedGroups(uint32_t type, std::vector<uint32_t>& groupIds) const
+{
+    groupIds.clear();
+
+    std::unordered_map<uint32_t, RatedBucket>::const_iterator itr = m_ratedGroups.find(type);
+    if (itr != m_ratedGroups.end())
+        groupIds.assign(itr->second.groups.begin(), itr->second.groups.end());
+}
+
+uint32_t BattlegroundQueue::findRatedOpponent(uint32_t groupId, uint32_t maxDiff) const
+{
+    const RatedGroup* group = getRatedGroup(groupId);
+    if (group == nullptr)
+        return 0;
+
+    typedef std::multimap<uint32_t, uint32_t>::const_iterator RatingIterator;
+    const std::multimap<uint32_t, uint32_t>& byRating = m_ratedGroups.find(group->type)->second.byRating;
+
+    // walk outwards from the own rating, the first other arena team found is the closest one
+    RatingIterator above = byRating.lower_bound(group->rating);
+    RatingIterator below = above;
+
+    while (true)
+    {
+        const bool hasAbove = above != byRating.end() && above->first - group->rating <= maxDiff;
+        const bool hasBelow = below != byRating.begin() && group->rating - std::prev(below)->first <= maxDiff;
+        if (!hasAbove && !hasBelow)
+            return 0;
+
+        RatingIterator candidate;
+        if (hasAbove && (!hasBelow || above->first - group->rating <= group->rating - std::prev(below)->first))
+            candidate = above++;
+        else
+            candidate = --below;
+
+        if (candidate->second != groupId && getRatedGroup(candidate->second)->arenaTeamId != group->arenaTeamId)
+            return candidate->second;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Players and rated arena groups waiting for a battleground.
+///
+/// Players wait in FIFO buckets per battleground type, level group and faction. Players
+/// who asked for a specific instance wait in one bucket per type and level group, in join
+/// order like the single list the queue was before, so the matcher can handle them first.
+/// Every player is indexed by guid, leaving the queue doesn't walk any list.
+///
+/// Rated arena groups are kept in join order and sorted by rating. An opponent is looked
+/// up in the rating range around a group instead of being compared with every other
+/// queued group. Guarded by the queue lock of the BattlegroundManager.
+//////////////////////////////////////////////////////////////////////////////////////////
+class BattlegroundQueue
+{
+    public:
+
+        typedef std::list<uint32_t> GuidList;
+
+        struct RatedGroup
+        {
+            uint32_t groupId;
+            uint32_t type;
+            uint32_t arenaTeamId;
+            uint32_t rating;
+            uint32_t joinTime;
+        };
+
+        /// a player is only queued once, joining again moves the player to the end of the new bucket.
+        /// instanceId 0 means the first available instance
+        void addPlayer(uint32_t guid, uint32_t type, uint32_t levelGroup, uint32_t team, uint32_t instanceId);
+        bool removePlayer(uint32_t guid);
+
+        /// players waiting for the first available instance, oldest first
+        const GuidList& getPlayers(uint32_t type, uint32_t levelGroup, uint32_t team) const;
+        /// players of both factions waiting for a specific instance, oldest first
+        const GuidList& getInstancePlayers(uint32_t type, uint32_t levelGroup) const;
+
+        /// both kinds of players
+        size_t getPlayerCount(uint32_t type, uint32_t levelGroup, uint32_t team) const;
+
+        void addRatedGroup(const RatedGroup& group);
+        bool removeRatedGroup(uint32_t groupId);
+
+        const RatedGroup* getRatedGroup(uint32_t groupId) const;
+        size_t getRatedGroupCount(uint32_t type) const;
+
+        /// group ids queued for type, oldest first
+        void getRatedGroups(uint32_t type, std::vector<uint32_t>& groupIds) const;
+
+        /// the group of another arena team with the closest rating at most maxDiff away, 0 if there is none
+        uint32_t findRatedOpponent(uint32_t groupId, uint32_t maxDiff) const;
+
+    private:
+
+        struct QueuedPlayer
+        {
+            uint32_t key;
+            bool byInstance;
+            GuidList::iterator position;
+        };
+
+        struct QueuedRatedGroup
+        {
+            RatedGroup group;
+            GuidList::iterator position;
+            std::multimap<uint32_t, uint32_t>::iterator ratingPosition;
+        };
+
+        struct RatedBucket
+        {
+            GuidList groups;
+            std::multimap<uint32_t, uint32_t> byRating;
+        };
+
+        static uint32_t _getKey(uint32_t type, uint32_t levelGroup, uint32_t team) { return (type << 16) | (levelGroup << 8) | team; }
+        static uint32_t _getInstanceKey(uint32_t key) { return key & ~0xFFu; }
+        static const GuidList& _getList(const std::unordered_map<uint32_t, GuidList>& buckets, uint32_t key);
+
+        // buckets are never erased, references to them stay valid
+        std::unordered_map<uint32_t, GuidList> m_players;
+        std::unordered_map<uint32_t, GuidList> m_instancePlayers;
+        std::unordered_map<uint32_t, size_t> m_instancePlayerCount;     // per faction
+        std::unordered_map<uint32_t, QueuedPlayer> m_playerIndex;
+
+        std::unordered_map<uint32_t, RatedBucket> m_ratedGroups;
+        std::unordered_map<uint32_t, QueuedRatedGroup> m_ratedGroupIndex;
+};
@@ -133,6 +133,12 @@ bool Container::HasItems()
     return false;
 }
 
+void Container::UpdateOwnerItemIndex(int16 slot)
+{
+    if (m_owner != NULL && m_owner->GetItemInterface() != NULL)
+        m_owner->GetItemInterface()->updateItemIndex(this, slot);
+}
+
 bool Container::AddItem(int16 slot, Item* item)
 {
     if (slot < 0 || (uint32)slot >= GetItemProperties()->ContainerSlots)
@@ -149,6 +155,7 @@ bool Container::AddItem(int16 slot, Item* item)
         return false;
 
     m_Slot[slot] = item;
+    UpdateOwnerItemIndex(slot);
     item->m_isDirty = true;
 
 
@@ -220,6 +227,8 @@ void Container::SwapItems(int8 SrcSlot, int8 DstSlot)
     temp = m_Slot[SrcSlot];
     m_Slot[SrcSlot] = m_Slot[DstSlot];
     m_Slot[DstSlot] = temp;
+    UpdateOwnerItemIndex(SrcSlot);
+    UpdateOwnerItemIndex(DstSlot);
 
     if (m_Slot[DstSlot])
     {
@@ -253,6 +262,7 @@ Item* Container::SafeRemoveAndRetreiveItemFromSlot(int16 slot, bool destroy)
         return NULL;
 
     m_Slot[slot] = NULL;
+    UpdateOwnerItemIndex(slot);
 
     if (pItem->GetOwner() == m_owner)
     {
@@ -285,6 +295,7 @@ bool Container::SafeFullRemoveItemFromSlot(int16 slot)
 
     if (pItem == NULL || pItem == this) return false;
     m_Slot[slot] = NULL;
+    UpdateOwnerItemIndex(slot);
 
     SetSlot(slot, 0);
     pItem->SetContainerGUID(0);
@@ -307,6 +318,7 @@ bool Container::AddItemToFreeSlot(Item* pItem, uint32* r_slot)
         if (!m_Slot[slot])
         {
             m_Slot[slot] = pItem;
+            UpdateOwnerItemIndex(static_cast<int16>(slot));
             pItem->m_isDirty = true;
 
             pItem->SetContainerGUID(GetGUID());
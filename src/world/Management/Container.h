@@ -60,6 +60,9 @@ class SERVER_DECL Container : public Item
 
     protected:
 
+        /// the contents of a bag are part of the item index of its owner
+        void UpdateOwnerItemIndex(int16 slot);
+
         Item** m_Slot;
         uint32 __fields[CONTAINER_END];
 };
@@ -628,6 +628,22 @@ void Item::SetOwner(Player* owner)
     m_owner = owner;
 }
 
+void Item::SetStackCount(uint32 amt)
+{
+    SetUInt32Value(ITEM_FIELD_STACK_COUNT, amt);
+
+    if (m_owner != NULL && m_owner->GetItemInterface() != NULL)
+        m_owner->GetItemInterface()->updateItemIndexStackCount(this);
+}
+
+void Item::ModStackCount(int32 val)
+{
+    ModUnsigned32Value(ITEM_FIELD_STACK_COUNT, val);
+
+    if (m_owner != NULL && m_owner->GetItemInterface() != NULL)
+        m_owner->GetItemInterface()->updateItemIndexStackCount(this);
+}
+
 int32 Item::AddEnchantment(DBC::Structures::SpellItemEnchantmentEntry const* Enchantment, uint32 Duration, bool Perm /* = false */, bool apply /* = true */, bool RemoveAtLogout /* = false */, uint32 Slot_, uint32 RandomSuffix)
 {
     int32 Slot = Slot_;
@@ -787,7 +803,7 @@ void Item::ApplyEnchantmentBonus(uint32 Slot, bool Apply)
                         m_owner->ModPosDamageDoneMod(SCHOOL_NORMAL, val);
                     else
                         m_owner->ModPosDamageDoneMod(SCHOOL_NORMAL, -val);
-                    m_owner->CalcDamage();
+                    m_owner->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
                 }
                 break;
 
@@ -833,7 +849,7 @@ void Item::ApplyEnchantmentBonus(uint32 Slot, bool Apply)
                     {
                         m_owner->FlatResistanceModifierPos[Entry->spell[c]] -= val;
                     }
-                    m_owner->CalcResistance(Entry->spell[c]);
+                    m_owner->markStatsDirty(Unit::getResistanceDirtyFlag(Entry->spell[c]));
                 }
                 break;
 
@@ -846,7 +862,7 @@ void Item::ApplyEnchantmentBonus(uint32 Slot, bool Apply)
                         val = RANDOM_SUFFIX_MAGIC_CALCULATION(RandomSuffixAmount, GetItemRandomSuffixFactor());
 
                     m_owner->ModifyBonuses(Entry->spell[c], val, Apply);
-                    m_owner->UpdateStats();
+                    m_owner->markStatsDirty(UNIT_STAT_DIRTY_STATS);
                 }
                 break;
 
@@ -872,7 +888,7 @@ void Item::ApplyEnchantmentBonus(uint32 Slot, bool Apply)
                         int32 value = -(int32)(GetItemProperties()->Delay * val / 1000);
                         m_owner->ModPosDamageDoneMod(SCHOOL_NORMAL, value);
                     }
-                    m_owner->CalcDamage();
+                    m_owner->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
                 }
                 break;
 
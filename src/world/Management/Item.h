@@ -204,9 +204,10 @@ class SERVER_DECL Item : public Object
         uint64 GetCreatorGUID() { return GetUInt64Value(ITEM_FIELD_CREATOR); }
         uint64 GetGiftCreatorGUID() { return GetUInt64Value(ITEM_FIELD_GIFTCREATOR); }
 
-        void SetStackCount(uint32 amt) { SetUInt32Value(ITEM_FIELD_STACK_COUNT, amt); }
+        /// the setters keep the item counts of the inventory of the owner up to date
+        void SetStackCount(uint32 amt);
         uint32 GetStackCount() { return GetUInt32Value(ITEM_FIELD_STACK_COUNT); }
-        void ModStackCount(int32 val) { ModUnsigned32Value(ITEM_FIELD_STACK_COUNT, val); }
+        void ModStackCount(int32 val);
 
         void SetDuration(uint32 durationseconds) { SetUInt32Value(ITEM_FIELD_DURATION, durationseconds); }
         uint32 GetDuration() { return GetUInt32Value(ITEM_FIELD_DURATION); }
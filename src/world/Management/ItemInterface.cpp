@@ -47,6 +47,41 @@ ItemInterface::~ItemInterface()
     this->m_refundableitems.clear();
 }
 
+const ItemInterfaceIndex& ItemInterface::_getItemIndex()
+{
+#ifdef _DEBUG
+    if (m_itemIndex.isValid())
+    {
+        // a slot change without updateItemIndex() leaves the index out of date
+        ItemInterfaceIndex index;
+        index.rebuild(this);
+        if (!index.isSameAs(m_itemIndex))
+        {
+            LOG_ERROR("ItemInterface : item index of player %u is out of date.", m_pOwner->GetLowGUID());
+            m_itemIndex.invalidate();
+        }
+    }
+#endif
+
+    if (!m_itemIndex.isValid())
+        m_itemIndex.rebuild(this);
+
+    return m_itemIndex;
+}
+
+void ItemInterface::updateItemIndex(Container* bag, int16 slot)
+{
+    if (!m_itemIndex.isValid())
+        return;
+
+    // while SwapItemSlots moves a bag it is in two bag slots for a moment
+    for (int16 bagSlot = INVENTORY_SLOT_BAG_START; bagSlot < BANK_SLOT_BAG_END; ++bagSlot)
+    {
+        if (m_pItems[bagSlot] == bag && IsBagSlot(bagSlot))
+            m_itemIndex.updateSlot(this, static_cast<int8>(bagSlot), slot);
+    }
+}
+
 uint32 ItemInterface::m_CreateForPlayer(ByteBuffer* data)       // 100%
 {
     ARCEMU_ASSERT(m_pOwner != NULL);
@@ -227,6 +262,7 @@ AddItemResult ItemInterface::m_AddItem(Item* item, int8 ContainerSlot, int16 slo
             item->SetOwner(m_pOwner);
             item->SetContainerGUID(m_pOwner->GetGUID());
             m_pItems[(int)slot] = item;
+            updateItemIndex(INVENTORY_SLOT_NOT_SET, slot);
 
             if (item->GetItemProperties()->Bonding == ITEM_BIND_ON_PICKUP)
             {
@@ -391,6 +427,7 @@ Item* ItemInterface::SafeRemoveAndRetreiveItemFromSlot(int8 ContainerSlot, int16
         }
 
         m_pItems[(int)slot] = NULL;
+        updateItemIndex(INVENTORY_SLOT_NOT_SET, slot);
         if (pItem->GetOwner() == m_pOwner)
         {
             pItem->m_isDirty = true;
@@ -557,6 +594,7 @@ bool ItemInterface::SafeFullRemoveItemFromSlot(int8 ContainerSlot, int16 slot)
         }
 
         m_pItems[(int)slot] = NULL;
+        updateItemIndex(INVENTORY_SLOT_NOT_SET, slot);
         // hacky crashfix
         if (pItem->GetOwner() == m_pOwner)
         {
@@ -748,89 +786,31 @@ Container* ItemInterface::GetContainer(int8 containerSlot)
 /// Checks for stacks that didn't reached max capacity
 Item* ItemInterface::FindItemLessMax(uint32 itemid, uint32 cnt, bool IncBank)
 {
-    uint32 i;
-    for (i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-        if (item)
-        {
-            uint32 itemMaxStack = (item->GetOwner()->ItemStackCheat) ? 0x7fffffff : item->GetItemProperties()->MaxCount;
-            if ((item->GetEntry() == itemid && item->wrapped_item_id == 0) && (itemMaxStack >= (item->GetStackCount() + cnt)))
-            {
-                return item;
-            }
-        }
-    }
+    const ItemInterfaceIndex::ItemList* items = _getItemIndex().getItems(itemid);
+    if (items == nullptr)
+        return NULL;
 
-    for (i = INVENTORY_SLOT_BAG_START; i < INVENTORY_SLOT_BAG_END; ++i)
+    // backpack, bag contents, currency, then the bank, equipped items and bags are never stacked on
+    for (ItemInterfaceIndex::ItemList::const_iterator itr = items->begin(); itr != items->end(); ++itr)
     {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-        if (item && item->IsContainer())
-        {
-            for (uint32 j = 0; j < item->GetItemProperties()->ContainerSlots; ++j)
-            {
-                Item* item2 = static_cast<Container*>(item)->GetItem(static_cast<int16>(j));
-                if (item2)
-                {
-                    uint32 itemMaxStack = (item2->GetOwner()->ItemStackCheat) ? 0x7fffffff : item2->GetItemProperties()->MaxCount;
-                    if ((item2->GetItemProperties()->ItemId == itemid && item2->wrapped_item_id == 0) && (itemMaxStack >= (item2->GetStackCount() + cnt)))
-                    {
-                        return item2;
-                    }
-                }
-            }
-
-        }
-    }
+        if (itr->inBank && !IncBank)
+            continue;
 
-    for (i = CURRENCYTOKEN_SLOT_START; i < CURRENCYTOKEN_SLOT_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-        if (item)
+        if (itr->containerSlot == ITEM_NO_SLOT_AVAILABLE)
         {
-            uint32 itemMaxStack = (item->GetOwner()->ItemStackCheat) ? 0x7fffffff : item->GetItemProperties()->MaxCount;
-            if ((item->GetEntry() == itemid && item->wrapped_item_id == 0) && (itemMaxStack >= (item->GetStackCount() + cnt)))
-            {
-                return item;
-            }
-        }
-    }
+            const bool isStackSlot = (itr->slot >= INVENTORY_SLOT_ITEM_START && itr->slot < INVENTORY_SLOT_ITEM_END)
+                || (itr->slot >= CURRENCYTOKEN_SLOT_START && itr->slot < CURRENCYTOKEN_SLOT_END)
+                || (itr->slot >= BANK_SLOT_ITEM_START && itr->slot < BANK_SLOT_ITEM_END);
 
-    if (IncBank)
-    {
-        for (i = BANK_SLOT_ITEM_START; i < BANK_SLOT_ITEM_END; ++i)
-        {
-            Item* item = GetInventoryItem(static_cast<int16>(i));
-            if (item)
-            {
-                uint32 itemMaxStack = (item->GetOwner()->ItemStackCheat) ? 0x7fffffff : item->GetItemProperties()->MaxCount;
-                if ((item->GetEntry() == itemid && item->wrapped_item_id == 0) && (itemMaxStack >= (item->GetStackCount() + cnt)))
-                {
-                    return item;
-                }
-            }
+            if (!isStackSlot)
+                continue;
         }
 
-        for (i = BANK_SLOT_BAG_START; i < BANK_SLOT_BAG_END; ++i)
+        Item* item = itr->item;
+        uint32 itemMaxStack = (item->GetOwner()->ItemStackCheat) ? 0x7fffffff : item->GetItemProperties()->MaxCount;
+        if (item->wrapped_item_id == 0 && (itemMaxStack >= (item->GetStackCount() + cnt)))
         {
-            Item* item = GetInventoryItem(static_cast<int16>(i));
-            if (item && item->IsContainer())
-            {
-
-                for (uint32 j = 0; j < item->GetItemProperties()->ContainerSlots; ++j)
-                {
-                    Item* item2 = static_cast<Container*>(item)->GetItem(static_cast<int16>(j));
-                    if (item2)
-                    {
-                        uint32 itemMaxStack = (item2->GetOwner()->ItemStackCheat) ? 0x7fffffff : item2->GetItemProperties()->MaxCount;
-                        if ((item2->GetItemProperties()->ItemId == itemid && item2->wrapped_item_id == 0) && (itemMaxStack >= (item2->GetStackCount() + cnt)))
-                        {
-                            return item2;
-                        }
-                    }
-                }
-
-            }
+            return item;
         }
     }
 
@@ -840,104 +820,7 @@ Item* ItemInterface::FindItemLessMax(uint32 itemid, uint32 cnt, bool IncBank)
 /// Finds item ammount on inventory, banks not included
 uint32 ItemInterface::GetItemCount(uint32 itemid, bool IncBank)
 {
-    uint32 cnt = 0;
-    uint32 i;
-    for (i = EQUIPMENT_SLOT_START; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-
-        if (item)
-        {
-            if (item->GetEntry() == itemid && item->wrapped_item_id == 0)
-            {
-                cnt += item->GetStackCount() ? item->GetStackCount() : 1;
-            }
-        }
-    }
-
-    for (i = INVENTORY_SLOT_BAG_START; i < INVENTORY_SLOT_BAG_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-        if (item && item->IsContainer())
-        {
-            for (uint32 j = 0; j < item->GetItemProperties()->ContainerSlots; ++j)
-            {
-                Item* item2 = static_cast<Container*>(item)->GetItem(static_cast<int16>(j));
-                if (item2)
-                {
-                    if (item2->GetEntry() == itemid && item->wrapped_item_id == 0)
-                    {
-                        cnt += item2->GetStackCount() ? item2->GetStackCount() : 1;
-                    }
-                }
-            }
-
-        }
-    }
-
-    for (i = INVENTORY_KEYRING_START; i < INVENTORY_KEYRING_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-
-        if (item)
-        {
-            if (item->GetItemProperties()->ItemId == itemid && item->wrapped_item_id == 0)
-            {
-                cnt += item->GetStackCount() ? item->GetStackCount() : 1;
-            }
-        }
-    }
-
-    for (i = CURRENCYTOKEN_SLOT_START; i < CURRENCYTOKEN_SLOT_END; ++i)
-    {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-
-        if (item)
-        {
-            if (item->GetItemProperties()->ItemId == itemid && item->wrapped_item_id == 0)
-            {
-                cnt += item->GetStackCount() ? item->GetStackCount() : 1;
-            }
-        }
-    }
-
-    if (IncBank)
-    {
-        for (i = BANK_SLOT_ITEM_START; i < BANK_SLOT_BAG_END; ++i)
-        {
-            Item* item = GetInventoryItem(static_cast<int16>(i));
-            if (item)
-            {
-                if (item->GetItemProperties()->ItemId == itemid && item->wrapped_item_id == 0)
-                {
-                    cnt += item->GetStackCount() ? item->GetStackCount() : 1;
-                }
-            }
-        }
-
-        for (i = BANK_SLOT_BAG_START; i < BANK_SLOT_BAG_END; ++i)
-        {
-            Item* item = GetInventoryItem(static_cast<int16>(i));
-            if (item)
-            {
-                if (item->IsContainer())
-                {
-                    for (uint32 j = 0; j < item->GetItemProperties()->ContainerSlots; ++j)
-                    {
-                        Item* item2 = static_cast<Container*>(item)->GetItem(static_cast<int16>(j));
-                        if (item2)
-                        {
-                            if (item2->GetItemProperties()->ItemId == itemid && item->wrapped_item_id == 0)
-                            {
-                                cnt += item2->GetStackCount() ? item2->GetStackCount() : 1;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return cnt;
+    return _getItemIndex().getItemCount(itemid, IncBank);
 }
 
 /// Removes a ammount of items from inventory
@@ -1475,37 +1358,14 @@ void ItemInterface::RemoveAllConjured()
 /// Gets slot number by itemid, banks not included
 int16 ItemInterface::GetInventorySlotById(uint32 ID)
 {
-    for (uint16 i = 0; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        if (m_pItems[i])
-        {
-            if (m_pItems[i]->GetItemProperties()->ItemId == ID)
-            {
-                return i;
-            }
-        }
-    }
-
-    for (uint16 i = INVENTORY_KEYRING_START; i < INVENTORY_KEYRING_END; ++i)
-    {
-        if (m_pItems[i])
-        {
-            if (m_pItems[i]->GetItemProperties()->ItemId == ID)
-            {
-                return i;
-            }
-        }
-    }
+    const ItemInterfaceIndex::ItemList* items = _getItemIndex().getItems(ID);
+    if (items == nullptr)
+        return ITEM_NO_SLOT_AVAILABLE;
 
-    for (uint16 i = CURRENCYTOKEN_SLOT_START; i < CURRENCYTOKEN_SLOT_END; ++i)
+    for (ItemInterfaceIndex::ItemList::const_iterator itr = items->begin(); itr != items->end(); ++itr)
     {
-        if (m_pItems[i])
-        {
-            if (m_pItems[i]->GetItemProperties()->ItemId == ID)
-            {
-                return i;
-            }
-        }
+        if (itr->containerSlot == ITEM_NO_SLOT_AVAILABLE && !itr->inBank)
+            return itr->slot;
     }
     return ITEM_NO_SLOT_AVAILABLE;
 }
@@ -1800,8 +1660,7 @@ uint32 ItemInterface::CalculateFreeSlots(ItemProperties const* proto)
                     {
                         if (m_pItems[i]->GetItemProperties()->BagFamily & proto->BagFamily)
                         {
-                            int8 slot = static_cast<Container*>(m_pItems[i])->FindFreeSlot();
-                            if (slot != ITEM_NO_SLOT_AVAILABLE)
+                            if (_getItemIndex().getFreeBagSlot(static_cast<int16>(i)) != ITEM_NO_SLOT_AVAILABLE)
                             {
                                 count++;
                             }
@@ -1812,13 +1671,7 @@ uint32 ItemInterface::CalculateFreeSlots(ItemProperties const* proto)
         }
     }
 
-    for (i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        if (m_pItems[i] == NULL)
-        {
-            count++;
-        }
-    }
+    count += _getItemIndex().getFreeBackpackSlotCount();
 
     for (i = INVENTORY_SLOT_BAG_START; i < INVENTORY_SLOT_BAG_END; ++i)
     {
@@ -1826,15 +1679,7 @@ uint32 ItemInterface::CalculateFreeSlots(ItemProperties const* proto)
         {
             if (m_pItems[i]->IsContainer() && !m_pItems[i]->GetItemProperties()->BagFamily)
             {
-
-                for (uint32 j = 0; j < m_pItems[i]->GetItemProperties()->ContainerSlots; ++j)
-                {
-                    Item* item2 = (static_cast<Container*>(m_pItems[i]))->GetItem(static_cast<int16>(j));
-                    if (item2 == NULL)
-                    {
-                        count++;
-                    }
-                }
+                count += _getItemIndex().getFreeBagSlotCount(static_cast<int16>(i));
             }
         }
     }
@@ -1844,29 +1689,12 @@ uint32 ItemInterface::CalculateFreeSlots(ItemProperties const* proto)
 /// Finds a free slot on the backpack
 int8 ItemInterface::FindFreeBackPackSlot()
 {
-    //search for backpack slots
-    for (int8 i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        Item* item = GetInventoryItem(i);
-        if (!item)
-        {
-            return i;
-        }
-    }
-
-    return ITEM_NO_SLOT_AVAILABLE;      //no slots available
+    return static_cast<int8>(_getItemIndex().getFreeBackpackSlot());
 }
 
 uint8 ItemInterface::FindFreeBackPackSlotMax()
 {
-    //search for backpack slots
-    uint8 slotfree = 0;
-    for (int8 i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i)
-    {
-        Item* item = GetInventoryItem(i);
-        if (!item) slotfree++;
-    }
-    return slotfree;
+    return static_cast<uint8>(_getItemIndex().getFreeBackpackSlotCount());
 }
 
 /// Converts bank bags slot ids into player bank byte slots(0-5)
@@ -3025,6 +2853,7 @@ void ItemInterface::SwapItemSlots(int8 srcslot, int8 dstslot)
 
 
     m_pItems[(int)dstslot] = SrcItem;
+    updateItemIndex(INVENTORY_SLOT_NOT_SET, dstslot);
 
     // Moving a bag with items to a empty bagslot
     if (DstItem == NULL && SrcItem != NULL && SrcItem->IsContainer())
@@ -3050,6 +2879,7 @@ void ItemInterface::SwapItemSlots(int8 srcslot, int8 dstslot)
     }
 
     m_pItems[(int)srcslot] = DstItem;
+    updateItemIndex(INVENTORY_SLOT_NOT_SET, srcslot);
 
     // swapping 2 bags filled with items
     if (DstItem != NULL && SrcItem != NULL && SrcItem->IsContainer() && DstItem->IsContainer())
@@ -3295,7 +3125,7 @@ void ItemInterface::SwapItemSlots(int8 srcslot, int8 dstslot)
         if (m_pItems[(int)srcslot] != NULL)
             m_pOwner->ApplyItemMods(m_pItems[(int)srcslot], srcslot, true);
         else if (srcslot == EQUIPMENT_SLOT_MAINHAND || srcslot == EQUIPMENT_SLOT_OFFHAND)
-            m_pOwner->CalcDamage();
+            m_pOwner->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
     }
 
     //dst item is equipped now
@@ -3304,7 +3134,7 @@ void ItemInterface::SwapItemSlots(int8 srcslot, int8 dstslot)
         if (m_pItems[(int)dstslot] != NULL)
             m_pOwner->ApplyItemMods(m_pItems[(int)dstslot], dstslot, true);
         else if (dstslot == EQUIPMENT_SLOT_MAINHAND || dstslot == EQUIPMENT_SLOT_OFFHAND)
-            m_pOwner->CalcDamage();
+            m_pOwner->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
     }
 
     //Recalculate Expertise (for Weapon specs)
@@ -3510,7 +3340,7 @@ SlotResult ItemInterface::FindFreeInventorySlot(ItemProperties const* proto)
                     {
                         if (m_pItems[i]->GetItemProperties()->BagFamily & proto->BagFamily)
                         {
-                            int32 slot = static_cast<Container*>(m_pItems[i])->FindFreeSlot();
+                            int32 slot = _getItemIndex().getFreeBagSlot(static_cast<int16>(i));
                             if (slot != ITEM_NO_SLOT_AVAILABLE)
                             {
                                 result.ContainerSlot = static_cast<int8>(i);
@@ -3526,16 +3356,13 @@ SlotResult ItemInterface::FindFreeInventorySlot(ItemProperties const* proto)
     }
 
     //backpack
-    for (uint32 i = INVENTORY_SLOT_ITEM_START; i < INVENTORY_SLOT_ITEM_END; ++i)
+    const int16 backpackSlot = _getItemIndex().getFreeBackpackSlot();
+    if (backpackSlot != ITEM_NO_SLOT_AVAILABLE)
     {
-        Item* item = GetInventoryItem(static_cast<int16>(i));
-        if (item == NULL)
-        {
-            result.ContainerSlot = ITEM_NO_SLOT_AVAILABLE;
-            result.Slot = static_cast<int8>(i);
-            result.Result = true;
-            return result;
-        }
+        result.ContainerSlot = ITEM_NO_SLOT_AVAILABLE;
+        result.Slot = static_cast<int8>(backpackSlot);
+        result.Result = true;
+        return result;
     }
 
     //bags
@@ -3546,7 +3373,7 @@ SlotResult ItemInterface::FindFreeInventorySlot(ItemProperties const* proto)
         {
             if (item->IsContainer() && !item->GetItemProperties()->BagFamily)
             {
-                int32 slot = static_cast<Container*>(m_pItems[i])->FindFreeSlot();
+                int32 slot = _getItemIndex().getFreeBagSlot(static_cast<int16>(i));
                 if (slot != ITEM_NO_SLOT_AVAILABLE)
                 {
                     result.ContainerSlot = static_cast<int8>(i);
@@ -21,6 +21,7 @@
 
 #include "EquipmentSetMgr.h"
 #include "ItemPrototype.h"
+#include "ItemInterfaceIndex.h"
 #include "../Server/WUtil.h"
 
 class Creature;
@@ -73,8 +74,13 @@ class SERVER_DECL ItemInterface
 
         RefundableMap m_refundableitems;
 
+        // built on the first lookup, then updated with the slots
+        ItemInterfaceIndex m_itemIndex;
+
         AddItemResult m_AddItem(Item* item, int8 ContainerSlot, int16 slot);
 
+        const ItemInterfaceIndex& _getItemIndex();
+
     public:
 
         Arcemu::EquipmentSetMgr m_EquipmentSets;
@@ -83,6 +89,15 @@ class SERVER_DECL ItemInterface
         ~ItemInterface();
 
         Player* GetOwner() { return m_pOwner; }
+
+        /// has to be called whenever an item is put into or taken out of a slot of the inventory,
+        /// bank (containerSlot INVENTORY_SLOT_NOT_SET) or one of their bags
+        void updateItemIndex(int8 containerSlot, int16 slot) { m_itemIndex.updateSlot(this, containerSlot, slot); }
+        /// same for a slot of bag, in whichever bag slot it is
+        void updateItemIndex(Container* bag, int16 slot);
+        void updateItemIndexStackCount(Item* item) { m_itemIndex.updateStackCount(item); }
+        /// has to be called when an item of the inventory changes its entry
+        void invalidateItemIndex() { m_itemIndex.invalidate(); }
         bool IsBagSlot(int16 slot);
 
         uint32 m_CreateForPlayer(ByteBuffer* data);
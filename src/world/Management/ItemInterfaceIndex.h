@@ -0,0 +1,441 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "ItemPrototype.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+class Container;
+class Item;
+class ItemInterface;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Items of an inventory by entry, and the free slots of the backpack and bags.
+///
+/// Item counts, stack lookups and free slot searches used to walk every slot of the
+/// inventory and bank, for quest objectives and reagents often several times for the
+/// same entry. The index is built in a single walk on the first lookup and then kept up
+/// to date by the ItemInterface and Container: a slot which got or lost an item is read
+/// again with updateSlot, a stack count change is applied with updateStackCount. Only an
+/// item changing its entry (gift wrapping) throws the index away.
+///
+/// Header only and templated on the inventory, item and bag, so the tests can index a
+/// model of an inventory.
+//////////////////////////////////////////////////////////////////////////////////////////
+template <class ItemInterfaceT, class ItemT, class ContainerT>
+class BasicItemInterfaceIndex
+{
+    public:
+
+        struct IndexedItem
+        {
+            ItemT* item;
+            int8_t containerSlot;       // ITEM_NO_SLOT_AVAILABLE for the slots of the player
+            int16_t slot;
+            bool inBank;
+            uint32_t position;          // sort key in the search order below
+            uint32_t count;             // stack count, 0 for wrapped items
+        };
+
+        /// in the order the inventory used to be searched: equipment, bags, backpack,
+        /// bag contents, keyring, currency, bank items, bank bags, bank bag contents
+        typedef std::vector<IndexedItem> ItemList;
+
+        BasicItemInterfaceIndex() : m_freeBackpackSlots(0), m_valid(false)
+        {
+            memset(m_freeBagSlots, 0, sizeof(m_freeBagSlots));
+        }
+
+        bool isValid() const { return m_valid; }
+        void invalidate() { m_valid = false; }
+
+        void rebuild(ItemInterfaceT* items)
+        {
+            m_byEntry.clear();
+            m_entryByPosition.clear();
+            m_freeBackpackSlots = 0;
+            memset(m_freeBagSlots, 0, sizeof(m_freeBagSlots));
+
+            _addSlots(items, EQUIPMENT_SLOT_START, INVENTORY_SLOT_ITEM_END);
+            _addBagContents(items, INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END);
+            _addSlots(items, INVENTORY_KEYRING_START, INVENTORY_KEYRING_END);
+            _addSlots(items, CURRENCYTOKEN_SLOT_START, CURRENCYTOKEN_SLOT_END);
+
+            _addSlots(items, BANK_SLOT_ITEM_START, BANK_SLOT_BAG_END);
+            _addBagContents(items, BANK_SLOT_BAG_START, BANK_SLOT_BAG_END);
+
+            m_valid = true;
+        }
+
+        /// reads the slot of the player (containerSlot ITEM_NO_SLOT_AVAILABLE) or of the bag in
+        /// containerSlot again after an item was put into or taken out of it, for a bag slot of
+        /// the player also the contents of the bag, does nothing while the index is invalid
+        void updateSlot(ItemInterfaceT* items, int8_t containerSlot, int16_t slot)
+        {
+            if (!m_valid)
+                return;
+
+            const uint32_t position = _getPosition(containerSlot, slot);
+            if (position == 0)
+                return;
+
+            _removeItem(position);
+
+            ItemT* item = nullptr;
+            if (containerSlot == ITEM_NO_SLOT_AVAILABLE)
+            {
+                item = items->GetInventoryItem(slot);
+
+                // the bag in this slot changed, so did the items in it
+                if (items->IsBagSlot(slot))
+                {
+                    _removeBagContents(slot);
+                    _addBagContents(items, slot, static_cast<int16_t>(slot + 1));
+                }
+            }
+            else
+            {
+                // a slot of a missing bag or beyond the size of the bag is neither free nor indexed
+                ItemT* bag = items->GetInventoryItem(containerSlot);
+                if (bag == nullptr || !bag->IsContainer() || static_cast<uint32_t>(slot) >= bag->GetItemProperties()->ContainerSlots)
+                    return;
+
+                item = static_cast<ContainerT*>(bag)->GetItem(slot);
+            }
+
+            if (item != nullptr)
+                _addItem(item, containerSlot, slot, position);
+
+            _setSlotFree(containerSlot, slot, item == nullptr);
+        }
+
+        /// applies the new stack count of item, does nothing for items which are not indexed
+        void updateStackCount(ItemT* item)
+        {
+            if (!m_valid)
+                return;
+
+            typename std::unordered_map<uint32_t, EntryItems>::iterator entryItems = m_byEntry.find(item->GetEntry());
+            if (entryItems == m_byEntry.end())
+                return;
+
+            ItemList& items = entryItems->second.items;
+            for (typename ItemList::iterator itr = items.begin(); itr != items.end(); ++itr)
+            {
+                if (itr->item != item)
+                    continue;
+
+                uint32_t& count = itr->inBank ? entryItems->second.bankCount : entryItems->second.count;
+                count -= itr->count;
+                itr->count = _getCount(item);
+                count += itr->count;
+                return;
+            }
+        }
+
+        /// nullptr if there is no item of entry
+        const ItemList* getItems(uint32_t entry) const
+        {
+            typename std::unordered_map<uint32_t, EntryItems>::const_iterator itr = m_byEntry.find(entry);
+            return itr != m_byEntry.end() ? &itr->second.items : nullptr;
+        }
+
+        /// sum of the stack counts of the unwrapped items of entry
+        uint32_t getItemCount(uint32_t entry, bool includeBank) const
+        {
+            typename std::unordered_map<uint32_t, EntryItems>::const_iterator itr = m_byEntry.find(entry);
+            if (itr == m_byEntry.end())
+                return 0;
+
+            return includeBank ? itr->second.count + itr->second.bankCount : itr->second.count;
+        }
+
+        /// first free backpack slot or ITEM_NO_SLOT_AVAILABLE
+        int16_t getFreeBackpackSlot() const
+        {
+            const int16_t bit = _getLowestBit(m_freeBackpackSlots);
+            return bit != ITEM_NO_SLOT_AVAILABLE ? static_cast<int16_t>(INVENTORY_SLOT_ITEM_START + bit) : bit;
+        }
+
+        uint32_t getFreeBackpackSlotCount() const
+        {
+            return static_cast<uint32_t>(std::bitset<32>(m_freeBackpackSlots).count());
+        }
+
+        /// first free slot of the bag in bagSlot (INVENTORY_SLOT_BAG_START to INVENTORY_SLOT_BAG_END)
+        /// or ITEM_NO_SLOT_AVAILABLE, also if there is no bag
+        int16_t getFreeBagSlot(int16_t bagSlot) const
+        {
+            if (bagSlot < INVENTORY_SLOT_BAG_START || bagSlot >= INVENTORY_SLOT_BAG_END)
+                return ITEM_NO_SLOT_AVAILABLE;
+
+            return _getLowestBit(m_freeBagSlots[bagSlot - INVENTORY_SLOT_BAG_START]);
+        }
+
+        uint32_t getFreeBagSlotCount(int16_t bagSlot) const
+        {
+            if (bagSlot < INVENTORY_SLOT_BAG_START || bagSlot >= INVENTORY_SLOT_BAG_END)
+                return 0;
+
+            return static_cast<uint32_t>(std::bitset<64>(m_freeBagSlots[bagSlot - INVENTORY_SLOT_BAG_START]).count());
+        }
+
+        /// used by the debug check against a freshly built index
+        bool isSameAs(const BasicItemInterfaceIndex& other) const
+        {
+            if (m_freeBackpackSlots != other.m_freeBackpackSlots || memcmp(m_freeBagSlots, other.m_freeBagSlots, sizeof(m_freeBagSlots)) != 0)
+                return false;
+
+            if (m_byEntry.size() != other.m_byEntry.size() || m_entryByPosition != other.m_entryByPosition)
+                return false;
+
+            for (typename std::unordered_map<uint32_t, EntryItems>::const_iterator itr = m_byEntry.begin(); itr != m_byEntry.end(); ++itr)
+            {
+                typename std::unordered_map<uint32_t, EntryItems>::const_iterator otherItr = other.m_byEntry.find(itr->first);
+                if (otherItr == other.m_byEntry.end())
+                    return false;
+
+                const EntryItems& items = itr->second;
+                const EntryItems& otherItems = otherItr->second;
+                if (items.count != otherItems.count || items.bankCount != otherItems.bankCount || items.items.size() != otherItems.items.size())
+                    return false;
+
+                for (size_t i = 0; i < items.items.size(); ++i)
+                {
+                    const IndexedItem& a = items.items[i];
+                    const IndexedItem& b = otherItems.items[i];
+                    if (a.item != b.item || a.containerSlot != b.containerSlot || a.slot != b.slot || a.inBank != b.inBank || a.count != b.count)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+
+        struct EntryItems
+        {
+            ItemList items;
+            uint32_t count;
+            uint32_t bankCount;
+        };
+
+        // groups of the search order, the group is the highest part of a position
+        enum IndexGroup
+        {
+            INDEX_GROUP_INVENTORY = 1,      // equipment, bags, backpack
+            INDEX_GROUP_BAG_CONTENTS,
+            INDEX_GROUP_KEYRING,
+            INDEX_GROUP_CURRENCY,
+            INDEX_GROUP_BANK,               // bank items, bank bags
+            INDEX_GROUP_BANK_BAG_CONTENTS
+        };
+
+        static const int16_t maxBagSlots = 64;
+
+        void _addItem(ItemT* item, int8_t containerSlot, int16_t slot, uint32_t position)
+        {
+            IndexedItem indexed;
+            indexed.item = item;
+            indexed.containerSlot = containerSlot;
+            indexed.slot = slot;
+            indexed.inBank = _isBankPosition(position);
+            indexed.position = position;
+            indexed.count = _getCount(item);
+
+            EntryItems& entryItems = m_byEntry[item->GetEntry()];
+            if (indexed.inBank)
+                entryItems.bankCount += indexed.count;
+            else
+                entryItems.count += indexed.count;
+
+            // rebuild() walks the slots in position order and always appends
+            typename ItemList::iterator itr = entryItems.items.end();
+            while (itr != entryItems.items.begin() && (itr - 1)->position > position)
+                --itr;
+
+            entryItems.items.insert(itr, indexed);
+            m_entryByPosition[position] = item->GetEntry();
+        }
+
+        void _removeItem(uint32_t position)
+        {
+            std::unordered_map<uint32_t, uint32_t>::iterator entry = m_entryByPosition.find(position);
+            if (entry == m_entryByPosition.end())
+                return;
+
+            typename std::unordered_map<uint32_t, EntryItems>::iterator entryItems = m_byEntry.find(entry->second);
+            m_entryByPosition.erase(entry);
+            if (entryItems == m_byEntry.end())
+                return;
+
+            ItemList& items = entryItems->second.items;
+            for (typename ItemList::iterator itr = items.begin(); itr != items.end(); ++itr)
+            {
+                if (itr->position != position)
+                    continue;
+
+                if (itr->inBank)
+                    entryItems->second.bankCount -= itr->count;
+                else
+                    entryItems->second.count -= itr->count;
+
+                items.erase(itr);
+                break;
+            }
+
+            if (items.empty())
+                m_byEntry.erase(entryItems);
+        }
+
+        void _addSlots(ItemInterfaceT* items, int16_t start, int16_t end)
+        {
+            for (int16_t slot = start; slot < end; ++slot)
+            {
+                ItemT* item = items->GetInventoryItem(slot);
+                if (item != nullptr)
+                    _addItem(item, ITEM_NO_SLOT_AVAILABLE, slot, _getPosition(ITEM_NO_SLOT_AVAILABLE, slot));
+                else
+                    _setSlotFree(ITEM_NO_SLOT_AVAILABLE, slot, true);
+            }
+        }
+
+        void _addBagContents(ItemInterfaceT* items, int16_t start, int16_t end)
+        {
+            for (int16_t bagSlot = start; bagSlot < end; ++bagSlot)
+            {
+                ItemT* bag = items->GetInventoryItem(bagSlot);
+                if (bag == nullptr || !bag->IsContainer())
+                    continue;
+
+                const int8_t containerSlot = static_cast<int8_t>(bagSlot);
+                const int16_t slotCount = static_cast<int16_t>(std::min<uint32_t>(bag->GetItemProperties()->ContainerSlots, maxBagSlots));
+                for (int16_t slot = 0; slot < slotCount; ++slot)
+                {
+                    ItemT* item = static_cast<ContainerT*>(bag)->GetItem(slot);
+                    if (item != nullptr)
+                        _addItem(item, containerSlot, slot, _getPosition(containerSlot, slot));
+                    else
+                        _setSlotFree(containerSlot, slot, true);
+                }
+            }
+        }
+
+        void _removeBagContents(int16_t bagSlot)
+        {
+            const int8_t containerSlot = static_cast<int8_t>(bagSlot);
+            for (int16_t slot = 0; slot < maxBagSlots; ++slot)
+                _removeItem(_getPosition(containerSlot, slot));
+
+            if (bagSlot >= INVENTORY_SLOT_BAG_START && bagSlot < INVENTORY_SLOT_BAG_END)
+                m_freeBagSlots[bagSlot - INVENTORY_SLOT_BAG_START] = 0;
+        }
+
+        void _setSlotFree(int8_t containerSlot, int16_t slot, bool isFree)
+        {
+            if (containerSlot == ITEM_NO_SLOT_AVAILABLE)
+            {
+                if (slot < INVENTORY_SLOT_ITEM_START || slot >= INVENTORY_SLOT_ITEM_END)
+                    return;
+
+                if (isFree)
+                    m_freeBackpackSlots |= 1u << (slot - INVENTORY_SLOT_ITEM_START);
+                else
+                    m_freeBackpackSlots &= ~(1u << (slot - INVENTORY_SLOT_ITEM_START));
+
+                return;
+            }
+
+            if (containerSlot < INVENTORY_SLOT_BAG_START || containerSlot >= INVENTORY_SLOT_BAG_END)
+                return;
+
+            const uint64_t bit = uint64_t(1) << slot;
+            if (isFree)
+                m_freeBagSlots[containerSlot - INVENTORY_SLOT_BAG_START] |= bit;
+            else
+                m_freeBagSlots[containerSlot - INVENTORY_SLOT_BAG_START] &= ~bit;
+        }
+
+        /// position of the slot in the search order, 0 for slots which are not indexed
+        static uint32_t _getPosition(int8_t containerSlot, int16_t slot)
+        {
+            uint32_t group;
+            if (containerSlot == ITEM_NO_SLOT_AVAILABLE)
+            {
+                if (slot >= EQUIPMENT_SLOT_START && slot < INVENTORY_SLOT_ITEM_END)
+                    group = INDEX_GROUP_INVENTORY;
+                else if (slot >= INVENTORY_KEYRING_START && slot < INVENTORY_KEYRING_END)
+                    group = INDEX_GROUP_KEYRING;
+                else if (slot >= CURRENCYTOKEN_SLOT_START && slot < CURRENCYTOKEN_SLOT_END)
+                    group = INDEX_GROUP_CURRENCY;
+                else if (slot >= BANK_SLOT_ITEM_START && slot < BANK_SLOT_BAG_END)
+                    group = INDEX_GROUP_BANK;
+                else
+                    return 0;
+
+                return group << 16 | static_cast<uint32_t>(slot);
+            }
+
+            if (slot < 0 || slot >= maxBagSlots)
+                return 0;
+
+            if (containerSlot >= INVENTORY_SLOT_BAG_START && containerSlot < INVENTORY_SLOT_BAG_END)
+                group = INDEX_GROUP_BAG_CONTENTS;
+            else if (containerSlot >= BANK_SLOT_BAG_START && containerSlot < BANK_SLOT_BAG_END)
+                group = INDEX_GROUP_BANK_BAG_CONTENTS;
+            else
+                return 0;
+
+            return group << 16 | static_cast<uint32_t>(containerSlot) << 8 | static_cast<uint32_t>(slot);
+        }
+
+        static bool _isBankPosition(uint32_t position)
+        {
+            return (position >> 16) >= INDEX_GROUP_BANK;
+        }
+
+        static uint32_t _getCount(ItemT* item)
+        {
+            if (item->wrapped_item_id != 0)
+                return 0;
+
+            return item->GetStackCount() ? item->GetStackCount() : 1;
+        }
+
+        static int16_t _getLowestBit(uint64_t bits)
+        {
+            if (bits == 0)
+                return ITEM_NO_SLOT_AVAILABLE;
+
+            int16_t bit = 0;
+            while ((bits & 1) == 0)
+            {
+                bits >>= 1;
+                ++bit;
+            }
+
+            return bit;
+        }
+
+        std::unordered_map<uint32_t, EntryItems> m_byEntry;
+
+        // entry of the item at a position, to find it again when its slot changes
+        std::unordered_map<uint32_t, uint32_t> m_entryByPosition;
+
+        // one bit per free slot, bit 0 is INVENTORY_SLOT_ITEM_START or slot 0 of the bag
+        uint32_t m_freeBackpackSlots;
+        uint64_t m_freeBagSlots[INVENTORY_SLOT_BAG_END - INVENTORY_SLOT_BAG_START];
+        bool m_valid;
+};
+
+typedef BasicItemInterfaceIndex<ItemInterface, Item, Container> ItemInterfaceIndex;
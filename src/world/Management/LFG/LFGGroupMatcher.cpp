@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "LFGGroupMatcher.h"
+
+namespace
+{
+    // A role filling of a dungeon group is stored as tanks + 2 * healers + 4 * dps, so all
+    // fillings up to 1 tank, 1 healer and 3 dps fit into the 16 bits of a role state mask.
+    // Bit n is set when the players can fill the group as filling n.
+    static_assert(LFG_TANKS_NEEDED == 1 && LFG_HEALERS_NEEDED == 1 && LFG_DPS_NEEDED == 3, "role state mask needs 1 tank, 1 healer and 3 dps");
+
+    const uint16_t LFG_ROLE_STATE_EMPTY = 1;
+
+    uint16_t addPlayerRoleStates(uint16_t states, uint8_t roles)
+    {
+        uint16_t result = 0;
+        for (uint8_t state = 0; state < 16; ++state)
+        {
+            if (!(states & (1 << state)))
+                continue;
+
+            if ((roles & ROLE_TANK) && !(state & 1))
+                result |= 1 << (state + 1);
+            if ((roles & ROLE_HEALER) && !(state & 2))
+                result |= 1 << (state + 2);
+            if ((roles & ROLE_DAMAGE) && (state >> 2) < LFG_DPS_NEEDED)
+                result |= 1 << (state + 4);
+        }
+        return result;
+    }
+}
+
+uint16_t LfgGroupMatcher::getRoleStates(const LfgRolesMap& roles)
+{
+    uint16_t states = LFG_ROLE_STATE_EMPTY;
+    for (LfgRolesMap::const_iterator it = roles.begin(); it != roles.end(); ++it)
+        states = addPlayerRoleStates(states, it->second & ~ROLE_LEADER);
+
+    return states;
+}
+
+uint16_t LfgGroupMatcher::combineRoleStates(uint16_t states1, uint16_t states2)
+{
+    uint16_t result = 0;
+    for (uint8_t state1 = 0; state1 < 16; ++state1)
+    {
+        if (!(states1 & (1 << state1)))
+            continue;
+
+        for (uint8_t state2 = 0; state2 < 16; ++state2)
+        {
+            if (!(states2 & (1 << state2)) || (state1 & state2 & 3) || (state1 >> 2) + (state2 >> 2) > LFG_DPS_NEEDED)
+                continue;
+
+            result |= 1 << (state1 + state2);
+        }
+    }
+    return result;
+}
+
+void LfgGroupMatcher::getNeededRoles(uint16_t states, uint8_t& tanks, uint8_t& healers, uint8_t& dps)
+{
+    tanks = LFG_TANKS_NEEDED;
+    healers = LFG_HEALERS_NEEDED;
+    dps = LFG_DPS_NEEDED;
+
+    for (int8_t state = 15; state >= 0; --state)
+    {
+        if (states & (1 << state))
+        {
+            tanks -= state & 1;
+            healers -= (state >> 1) & 1;
+            dps -= state >> 2;
+            return;
+        }
+    }
+}
+
+void LfgGroupMatcher::addRoleCounts(LfgQueueInfo* queue)
+{
+    // Readded after a failed proposal, already counted
+    if (queue->counted)
+        return;
+
+    for (LfgDungeonSet::const_iterator itDungeon = queue->availableDungeons.begin(); itDungeon != queue->availableDungeons.end(); ++itDungeon)
+    {
+        LfgRoleCounts& counts = m_dungeonRoleCounts[*itDungeon];
+        for (LfgRolesMap::const_iterator it = queue->roles.begin(); it != queue->roles.end(); ++it)
+        {
+            ++counts.players;
+            if (it->second & ROLE_TANK)
+                ++counts.tanks;
+            if (it->second & ROLE_HEALER)
+                ++counts.healers;
+            if (it->second & ROLE_DAMAGE)
+                ++counts.dps;
+        }
+    }
+
+    queue->counted = true;
+}
+
+void LfgGroupMatcher::removeRoleCounts(LfgQueueInfo* queue)
+{
+    if (!queue->counted)
+        return;
+
+    for (LfgDungeonSet::const_iterator itDungeon = queue->availableDungeons.begin(); itDungeon != queue->availableDungeons.end(); ++itDungeon)
+    {
+        LfgRoleCountMap::iterator itCounts = m_dungeonRoleCounts.find(*itDungeon);
+        if (itCounts == m_dungeonRoleCounts.end())
+            continue;
+
+        LfgRoleCounts& counts = itCounts->second;
+        for (LfgRolesMap::const_iterator itRoles = queue->roles.begin(); itRoles != queue->roles.end(); ++itRoles)
+        {
+            --counts.players;
+            if (itRoles->second & ROLE_TANK)
+                --counts.tanks;
+            if (itRoles->second & ROLE_HEALER)
+                --counts.healers;
+            if (itRoles->second & ROLE_DAMAGE)
+                --counts.dps;
+        }
+
+        if (!counts.players)
+            m_dungeonRoleCounts.erase(itCounts);
+    }
+
+    queue->counted = false;
+}
+
+bool LfgGroupMatcher::canFillDungeons(const LfgDungeonSet& dungeons) const
+{
+    for (LfgDungeonSet::const_iterator it = dungeons.begin(); it != dungeons.end(); ++it)
+    {
+        LfgRoleCountMap::const_iterator itCounts = m_dungeonRoleCounts.find(*it);
+        if (itCounts == m_dungeonRoleCounts.end())
+            continue;
+
+        const LfgRoleCounts& counts = itCounts->second;
+        if (counts.players >= 5 && counts.tanks >= LFG_TANKS_NEEDED && counts.healers >= LFG_HEALERS_NEEDED && counts.dps >= LFG_DPS_NEEDED)
+            return true;
+    }
+
+    return false;
+}
+
+bool LfgGroupMatcher::checkCompatibility(const LfgQueueInfoMap& queues, uint64_t guid1, uint64_t guid2)
+{
+    // Previously cached?
+    LfgAnswer answer = _getCompatibles(guid1, guid2);
+    if (answer != LFG_ANSWER_PENDING)
+        return answer == LFG_ANSWER_AGREE;
+
+    LfgQueueInfoMap::const_iterator itQueue1 = queues.find(guid1);
+    LfgQueueInfoMap::const_iterator itQueue2 = queues.find(guid2);
+    if (itQueue1 == queues.end() || itQueue2 == queues.end())
+        return false;
+
+    const LfgQueueInfo* queue1 = itQueue1->second;
+    const LfgQueueInfo* queue2 = itQueue2->second;
+
+    bool compatible = true;
+
+    // Too much players, more than one Lfggroup or roles not compatible
+    if (queue1->roles.size() + queue2->roles.size() > 5 || (queue1->lfgGroup && queue2->lfgGroup) || !combineRoleStates(queue1->roleStates, queue2->roleStates))
+        compatible = false;
+    else
+    {
+        // Player in multiples queues!
+        for (LfgRolesMap::const_iterator it = queue1->roles.begin(); it != queue1->roles.end() && compatible; ++it)
+            compatible = queue2->roles.find(it->first) == queue2->roles.end();
+
+        // Check if there are any compatible dungeon from the selected dungeons
+        if (compatible)
+        {
+            LfgDungeonSet::const_iterator it1 = queue1->availableDungeons.begin();
+            LfgDungeonSet::const_iterator it2 = queue2->availableDungeons.begin();
+            while (it1 != queue1->availableDungeons.end() && it2 != queue2->availableDungeons.end() && *it1 != *it2)
+            {
+                if (*it1 < *it2)
+                    ++it1;
+                else
+                    ++it2;
+            }
+
+            compatible = it1 != queue1->availableDungeons.end() && it2 != queue2->availableDungeons.end();
+        }
+    }
+
+    _setCompatibles(guid1, guid2, compatible);
+    return compatible;
+}
+
+void LfgGroupMatcher::removeFromCompatibles(uint64_t guid)
+{
+    LfgCompatibleMap::iterator it = m_compatibleMap.find(guid);
+    if (it == m_compatibleMap.end())
+        return;
+
+    // Answers are stored for both guids
+    for (std::map<uint64_t, LfgAnswer>::const_iterator itOther = it->second.begin(); itOther != it->second.end(); ++itOther)
+    {
+        LfgCompatibleMap::iterator itOtherAnswers = m_compatibleMap.find(itOther->first);
+        if (itOtherAnswers == m_compatibleMap.end())
+            continue;
+
+        itOtherAnswers->second.erase(guid);
+        if (itOtherAnswers->second.empty())
+            m_compatibleMap.erase(itOtherAnswers);
+    }
+
+    m_compatibleMap.erase(guid);
+}
+
+void LfgGroupMatcher::_setCompatibles(uint64_t guid1, uint64_t guid2, bool compatibles)
+{
+    m_compatibleMap[guid1][guid2] = LfgAnswer(compatibles);
+    m_compatibleMap[guid2][guid1] = LfgAnswer(compatibles);
+}
+
+LfgAnswer LfgGroupMatcher::_getCompatibles(uint64_t guid1, uint64_t guid2) const
+{
+    LfgCompatibleMap::const_iterator it = m_compatibleMap.find(guid1);
+    if (it == m_compatibleMap.end())
+        return LFG_ANSWER_PENDING;
+
+    std::map<uint64_t, LfgAnswer>::const_iterator itAnswer = it->second.find(guid2);
+    return itAnswer != it->second.end() ? itAnswer->second : LFG_ANSWER_PENDING;
+}
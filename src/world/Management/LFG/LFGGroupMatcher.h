@@ -0,0 +1,194 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "LFG.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <list>
+#include <map>
+
+/// Players of a dungeon group by role
+enum LfgRolesNeeded
+{
+    LFG_TANKS_NEEDED                             = 1,
+    LFG_HEALERS_NEEDED                           = 1,
+    LFG_DPS_NEEDED                               = 3
+};
+
+/// Answer state (Also used to check compatibilites)
+enum LfgAnswer
+{
+    LFG_ANSWER_PENDING                           = -1,
+    LFG_ANSWER_DENY                              = 0,
+    LFG_ANSWER_AGREE                             = 1
+};
+
+struct LfgQueueInfo;
+struct LfgRoleCounts;
+
+typedef std::list<uint64_t> LfgGuidList;
+typedef std::map<uint64_t, uint8_t> LfgRolesMap;
+typedef std::map<uint64_t, LfgQueueInfo*> LfgQueueInfoMap;
+typedef std::map<uint64_t, std::map<uint64_t, LfgAnswer> > LfgCompatibleMap;
+typedef std::map<uint32_t, LfgRoleCounts> LfgRoleCountMap;
+
+/// Stores player or group queue info
+struct LfgQueueInfo
+{
+    LfgQueueInfo(): joinTime(0), tanks(LFG_TANKS_NEEDED), healers(LFG_HEALERS_NEEDED), dps(LFG_DPS_NEEDED), roleStates(0), lfgGroup(false), counted(false) {};
+    time_t joinTime;                                       ///< Player queue join time (to calculate wait times)
+    uint8_t tanks;                                         ///< Tanks needed
+    uint8_t healers;                                       ///< Healers needed
+    uint8_t dps;                                           ///< Dps needed
+    LfgDungeonSet dungeons;                                ///< Selected Player/Group Dungeon/s
+    LfgRolesMap roles;                                     ///< Selected Player Role/s
+    uint16_t roleStates;                                   ///< Tank/healer/dps fillings the players can take, one bit per filling
+    bool lfgGroup;                                         ///< Existing lfg group, can't be matched with another one
+    bool counted;                                          ///< Added to the dungeon role counts
+    LfgDungeonSet availableDungeons;                       ///< Selected dungeons none of the players is locked for
+};
+
+/// Queued players per dungeon able to take each role. Players with several roles count for each
+/// of them, so this is an upper bound: a dungeon with less can't be filled from the queue.
+struct LfgRoleCounts
+{
+    LfgRoleCounts(): tanks(0), healers(0), dps(0), players(0) {};
+    uint32_t tanks;
+    uint32_t healers;
+    uint32_t dps;
+    uint32_t players;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Group search of the LfgMgr over the queue infos of the queued players and groups.
+///
+/// A queue entry can fill a set of tank/healer/dps fillings, its role states. Entries are
+/// added to a new entry oldest first while their role states combine, they are pairwise
+/// compatible and share a dungeon, until five players are found. The pairwise answers are
+/// cached until one of the guids leaves the queue. The queued players per dungeon and role
+/// skip the search when a dungeon can't be filled from the queue at all.
+///
+/// Knows nothing about players or the lfg states, the LfgMgr passes which guids are queued.
+//////////////////////////////////////////////////////////////////////////////////////////
+class LfgGroupMatcher
+{
+    public:
+
+        /// role states of players with the given roles, 0 if they can't form one group
+        static uint16_t getRoleStates(const LfgRolesMap& roles);
+
+        /// fillings two entries can take together, 0 if they can't form one group
+        static uint16_t combineRoleStates(uint16_t states1, uint16_t states2);
+
+        /// roles still missing for the fullest filling of states
+        static void getNeededRoles(uint16_t states, uint8_t& tanks, uint8_t& healers, uint8_t& dps);
+
+        /// counts the players of queue for its available dungeons, once
+        void addRoleCounts(LfgQueueInfo* queue);
+        void removeRoleCounts(LfgQueueInfo* queue);
+
+        /// false if none of the dungeons has enough queued players of each role
+        bool canFillDungeons(const LfgDungeonSet& dungeons) const;
+
+        bool checkCompatibility(const LfgQueueInfoMap& queues, uint64_t guid1, uint64_t guid2);
+        void removeFromCompatibles(uint64_t guid);
+
+        /// Fills check with newGuid and the entries of all joining it, in queue order, and dungeons
+        /// with the dungeons they share. Returns true for a full group, otherwise sets the roles
+        /// still needed on the queue infos in check. Guids of all without queue info or for which
+        /// isQueued(guid) is false are skipped and added to notQueued.
+        template <typename IsQueued>
+        bool findGroupCandidates(const LfgQueueInfoMap& queues, uint64_t newGuid, const LfgGuidList& all, IsQueued isQueued,
+            LfgGuidList& check, LfgDungeonSet& dungeons, LfgGuidList& notQueued)
+        {
+            LfgQueueInfoMap::const_iterator itNew = queues.find(newGuid);
+            if (itNew == queues.end())
+                return false;
+
+            LfgQueueInfo* newQueue = itNew->second;
+            if (!newQueue->roleStates || newQueue->availableDungeons.empty())
+                return false;
+
+            // Not enough players queued for any of the dungeons, no need to look at them
+            if (!canFillDungeons(newQueue->availableDungeons))
+                return false;
+
+            check.push_back(newGuid);
+            uint8_t numPlayers = static_cast<uint8_t>(newQueue->roles.size());
+            uint16_t roleStates = newQueue->roleStates;
+            bool hasLfgGroup = newQueue->lfgGroup;
+            dungeons = newQueue->availableDungeons;
+
+            // Add every compatible player/group, oldest first, until the group is full
+            for (LfgGuidList::const_iterator it = all.begin(); it != all.end() && numPlayers < 5; ++it)
+            {
+                uint64_t guid = (*it);
+                if (guid == newGuid)
+                    continue;
+
+                LfgQueueInfoMap::const_iterator itQueue = queues.find(guid);
+                if (itQueue == queues.end() || !isQueued(guid))
+                {
+                    notQueued.push_back(guid);
+                    continue;
+                }
+
+                LfgQueueInfo* queue = itQueue->second;
+                if (numPlayers + queue->roles.size() > 5 || (hasLfgGroup && queue->lfgGroup))
+                    continue;
+
+                uint16_t combinedStates = combineRoleStates(roleStates, queue->roleStates);
+                if (!combinedStates)
+                    continue;
+
+                bool compatible = true;
+                for (LfgGuidList::const_iterator itCheck = check.begin(); itCheck != check.end() && compatible; ++itCheck)
+                    compatible = checkCompatibility(queues, *itCheck, guid);
+
+                if (!compatible)
+                    continue;
+
+                LfgDungeonSet commonDungeons;
+                std::set_intersection(dungeons.begin(), dungeons.end(), queue->availableDungeons.begin(), queue->availableDungeons.end(), std::inserter(commonDungeons, commonDungeons.begin()));
+                if (commonDungeons.empty())
+                    continue;
+
+                check.push_back(guid);
+                numPlayers += static_cast<uint8_t>(queue->roles.size());
+                roleStates = combinedStates;
+                hasLfgGroup |= queue->lfgGroup;
+                dungeons.swap(commonDungeons);
+            }
+
+            if (numPlayers == 5)
+                return true;
+
+            // Show the roles the best group found so far still needs
+            uint8_t tanksNeeded, healersNeeded, dpsNeeded;
+            getNeededRoles(roleStates, tanksNeeded, healersNeeded, dpsNeeded);
+            for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
+            {
+                LfgQueueInfo* queue = queues.find(*it)->second;
+                queue->tanks = tanksNeeded;
+                queue->healers = healersNeeded;
+                queue->dps = dpsNeeded;
+            }
+
+            return false;
+        }
+
+    private:
+
+        void _setCompatibles(uint64_t guid1, uint64_t guid2, bool compatibles);
+        LfgAnswer _getCompatibles(uint64_t guid1, uint64_t guid2) const;
+
+        LfgCompatibleMap m_compatibleMap;                  ///< Cached compatibility of two queued players/groups
+        LfgRoleCountMap m_dungeonRoleCounts;               ///< Queued players per dungeon and role
+};
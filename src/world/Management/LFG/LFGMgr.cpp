@@ -25,11 +25,13 @@
 #include "Management/ItemInterface.h"
 #include "Server/MainServerDefines.h"
 
+#include <algorithm>
+#include <iterator>
+
 uint32 LfgDungeonTypes[MAX_DUNGEONS];
 
 initialiseSingleton(LfgMgr);
 
-
 LfgMgr::LfgMgr() : m_update(true), m_QueueTimer(0), m_lfgProposalId(1),
 m_WaitTimeAvg(-1), m_WaitTimeTank(-1), m_WaitTimeHealer(-1), m_WaitTimeDps(-1),
 m_NumWaitTimeAvg(0), m_NumWaitTimeTank(0), m_NumWaitTimeHealer(0), m_NumWaitTimeDps(0)
@@ -205,16 +207,13 @@ void LfgMgr::Update(uint32 diff)
         uint8 queueId = it->first;
         LfgGuidList& newToQueue = it->second;
         LfgGuidList& currentQueue = m_currentQueue[queueId];
-        LfgGuidList firstNew;
         while (!newToQueue.empty())
         {
             uint64 frontguid = newToQueue.front();
             LOG_DEBUG("Update: QueueId %u: checking %u newToQueue(%u), currentQueue(%u)", queueId, frontguid, uint32(newToQueue.size()), uint32(currentQueue.size()));
-            firstNew.push_back(frontguid);
             newToQueue.pop_front();
 
-            LfgGuidList temporalList = currentQueue;
-            if (LfgProposal* pProposal = FindNewGroups(firstNew, temporalList)) // Group found!
+            if (LfgProposal* pProposal = FindNewGroups(frontguid, currentQueue)) // Group found!
             {
                 // Remove groups in the proposal from new and current queues (not from queue map)
                 for (LfgGuidList::const_iterator itQueue = pProposal->queues.begin(); itQueue != pProposal->queues.end(); ++itQueue)
@@ -250,7 +249,6 @@ void LfgMgr::Update(uint32 diff)
             else
                 if (std::find(currentQueue.begin(), currentQueue.end(), frontguid) == currentQueue.end()) //already in queue?
                     currentQueue.push_back(frontguid);         // Lfg group not found, add this group to the queue.
-            firstNew.clear();
         }
     }
 
@@ -308,6 +306,10 @@ void LfgMgr::AddToQueue(uint64 guid, uint8 queueId)
 {
     //queueId = 0; //allows horde and alli in same queque
 
+    LfgQueueInfoMap::iterator itQueue = m_QueueInfoMap.find(guid);
+    if (itQueue != m_QueueInfoMap.end())
+        PrepareQueueInfo(guid, itQueue->second);
+
     LfgGuidList& list = m_newToQueue[queueId];
     if (std::find(list.begin(), list.end(), guid) != list.end())
         LOG_DEBUG("%u already in new queue. ignoring", guid);
@@ -326,11 +328,13 @@ bool LfgMgr::RemoveFromQueue(uint64 guid)
     for (LfgGuidListMap::iterator it = m_newToQueue.begin(); it != m_newToQueue.end(); ++it)
         it->second.remove(guid);
 
-    RemoveFromCompatibles(guid);
+    m_GroupMatcher.removeFromCompatibles(guid);
 
     LfgQueueInfoMap::iterator it = m_QueueInfoMap.find(guid);
     if (it != m_QueueInfoMap.end())
     {
+        m_GroupMatcher.removeRoleCounts(it->second);
+
         delete it->second;
         m_QueueInfoMap.erase(it);
         LOG_DEBUG("%u removed", guid);
@@ -676,116 +680,56 @@ void LfgMgr::OfferContinue(Group* grp)
 
 }
 
-LfgProposal* LfgMgr::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
+bool LfgMgr::FindGroupCandidates(uint64 newGuid, const LfgGuidList& all, LfgGuidList& check, LfgDungeonSet& dungeons)
 {
-    LOG_DEBUG("(%s) - all(%s)", ConcatenateGuids(check).c_str(), ConcatenateGuids(all).c_str());
-
-    LfgProposal* pProposal = NULL;
-    if (check.empty() || check.size() > 5 || !CheckCompatibility(check, pProposal))
-        return NULL;
-
-    // Try to match with queued groups
-    while (!pProposal && !all.empty())
+    if (m_QueueInfoMap.find(newGuid) == m_QueueInfoMap.end() || GetState(newGuid) != LFG_STATE_QUEUED)
     {
-        check.push_back(all.front());
-        all.pop_front();
-        pProposal = FindNewGroups(check, all);
-        check.pop_back();
-    }
-    return pProposal;
-}
-
-bool LfgMgr::CheckCompatibility(LfgGuidList check, LfgProposal*& pProposal)
-{
-    if (pProposal)                                         // Do not check anything if we already have a proposal
-        return false;
-
-    std::string strGuids = ConcatenateGuids(check);
-
-    if (check.size() > 5 || check.empty())
-    {
-        LOG_DEBUG("(%s): Size wrong - Not compatibles", strGuids.c_str());
+        LOG_DEBUG("%u is not queued but listed as queued!", newGuid);
+        RemoveFromQueue(newGuid);
         return false;
     }
 
-    if (check.size() == 1 && IS_PLAYER_GUID(check.front())) // Player joining dungeon... compatible
-        return true;
-
-    // Previously cached?
-    LfgAnswer answer = GetCompatibles(strGuids);
-    if (answer != LFG_ANSWER_PENDING)
+    LfgGuidList notQueued;
+    const bool matched = m_GroupMatcher.findGroupCandidates(m_QueueInfoMap, newGuid, all, [this](uint64 guid)
     {
-        LOG_DEBUG("(%s) compatibles (cached): %d", strGuids.c_str(), answer);
-        return bool(answer ? true : false);
-    }
+        return GetState(guid) == LFG_STATE_QUEUED;
+    }, check, dungeons, notQueued);
 
-    // Check all but new compatiblitity
-    if (check.size() > 2)
+    for (LfgGuidList::const_iterator it = notQueued.begin(); it != notQueued.end(); ++it)
     {
-        uint64 frontGuid = check.front();
-        check.pop_front();
-
-        // Check all-but-new compatibilities (New, A, B, C, D) --> check(A, B, C, D)
-        if (!CheckCompatibility(check, pProposal))          // Group not compatible
-        {
-            LOG_DEBUG("(%s) not compatibles (%s not compatibles)", strGuids.c_str(), ConcatenateGuids(check).c_str());
-            SetCompatibles(strGuids, false);
-            return false;
-        }
-        check.push_front(frontGuid);
-        // all-but-new compatibles, now check with new
+        LOG_DEBUG("%u is not queued but listed as queued!", (*it));
+        RemoveFromQueue(*it);
     }
 
-    uint8 numPlayers = 0;
-    uint8 numLfgGroups = 0;
-    uint32 groupLowGuid = 0;
-    LfgQueueInfoMap pqInfoMap;
-    for (LfgGuidList::const_iterator it = check.begin(); it != check.end() && numLfgGroups < 2 && numPlayers <= 5; ++it)
+    if (!matched)
     {
-        uint64 guid = (*it);
-        LfgQueueInfoMap::iterator itQueue = m_QueueInfoMap.find(guid);
-        if (itQueue == m_QueueInfoMap.end() || GetState(guid) != LFG_STATE_QUEUED)
-        {
-            LOG_DEBUG("%u is not queued but listed as queued!", (*it));
-            RemoveFromQueue(guid);
-            return false;
-        }
-        pqInfoMap[guid] = itQueue->second;
-        numPlayers += static_cast<uint8>(itQueue->second->roles.size());
-
-        if (IS_GROUP(guid))
-        {
-            uint32 lowGuid = GET_LOWGUID_PART(guid);
-            if (Group* grp = objmgr.GetGroupById(lowGuid))  //MAy Check these
-                if (grp->isLFGGroup())
-                {
-                    if (!numLfgGroups)
-                        groupLowGuid = lowGuid;
-                    ++numLfgGroups;
-                }
-        }
+        if (check.empty())
+            LOG_DEBUG("(%u) not enough players queued for the selected dungeons", newGuid);
+        else
+            LOG_DEBUG("(%s) Compatibles but not match. Queues(%u)", ConcatenateGuids(check).c_str(), uint32(check.size()));
     }
 
-    if (check.size() == 1 && numPlayers != 5)   // Single group with less than MAXGROUPSIZE - Compatibles
-        return true;
+    return matched;
+}
 
-    // Do not match - groups already in a lfgDungeon or too much players
-    if (numLfgGroups > 1 || numPlayers > 5)
-    {
-        SetCompatibles(strGuids, false);
-        if (numLfgGroups > 1)
-            LOG_DEBUG("(%s) More than one Lfggroup (%u)", strGuids.c_str(), numLfgGroups);
-        else
-            LOG_DEBUG("(%s) Too much players (%u)", strGuids.c_str(), numPlayers);
-        return false;
-    }
+LfgProposal* LfgMgr::FindNewGroups(uint64 newGuid, const LfgGuidList& all)
+{
+    LfgGuidList check;
+    LfgDungeonSet dungeons;
+    if (!FindGroupCandidates(newGuid, all, check, dungeons))
+        return NULL;
 
     // ----- Player checks -----
+    uint32 groupLowGuid = 0;
     LfgRolesMap rolesMap;
     uint64 leader = 0;
-    for (LfgQueueInfoMap::const_iterator it = pqInfoMap.begin(); it != pqInfoMap.end(); ++it)
+    for (LfgGuidList::const_iterator it = check.begin(); it != check.end(); ++it)
     {
-        for (LfgRolesMap::const_iterator itRoles = it->second->roles.begin(); itRoles != it->second->roles.end(); ++itRoles)
+        LfgQueueInfo* queue = m_QueueInfoMap[*it];
+        if (queue->lfgGroup)
+            groupLowGuid = GET_LOWGUID_PART(*it);
+
+        for (LfgRolesMap::const_iterator itRoles = queue->roles.begin(); itRoles != queue->roles.end(); ++itRoles)
         {
             // Assign new leader
             if (itRoles->second & ROLE_LEADER && (!leader || RandomUInt(1)))
@@ -795,130 +739,38 @@ bool LfgMgr::CheckCompatibility(LfgGuidList check, LfgProposal*& pProposal)
         }
     }
 
-    if (rolesMap.size() != numPlayers)                     // Player in multiples queues!
-        return false;
-
     PlayerSet players;
     for (LfgRolesMap::const_iterator it = rolesMap.begin(); it != rolesMap.end(); ++it)
     {
         Player* player = objmgr.GetPlayer(GET_LOWGUID_PART(it->first));
         if (!player)
-            LOG_DEBUG("(%s) Warning! %u offline! Marking as not compatibles!", strGuids.c_str(), it->first);
-        else
         {
-            for (PlayerSet::const_iterator itPlayer = players.begin(); itPlayer != players.end() && player; ++itPlayer)
-            {
-                // Do not form a group with ignoring candidates
-            }
-            if (player)
-                players.insert(player);
+            LOG_DEBUG("(%s) Warning! %u offline!", ConcatenateGuids(check).c_str(), it->first);
+            return NULL;
         }
-    }
-
-    // if we dont have the same ammount of players then we have self ignoring candidates or different faction groups
-    // otherwise check if roles are compatible
-    if (players.size() != numPlayers || !CheckGroupRoles(rolesMap))
-    {
-        if (players.size() == numPlayers)
-            LOG_DEBUG("(%s) Roles not compatible", strGuids.c_str());
-        SetCompatibles(strGuids, false);
-        return false;
-    }
-
-    // ----- Selected Dungeon checks -----
-    // Check if there are any compatible dungeon from the selected dungeons
-    LfgDungeonSet compatibleDungeons;
 
-    LfgQueueInfoMap::const_iterator itFirst = pqInfoMap.begin();
-    for (LfgDungeonSet::const_iterator itDungeon = itFirst->second->dungeons.begin(); itDungeon != itFirst->second->dungeons.end(); ++itDungeon)
-    {
-        LfgQueueInfoMap::const_iterator itOther = itFirst;
-        ++itOther;
-        while (itOther != pqInfoMap.end() && itOther->second->dungeons.find(*itDungeon) != itOther->second->dungeons.end())
-            ++itOther;
-
-        if (itOther == pqInfoMap.end())
-            compatibleDungeons.insert(*itDungeon);
-    }
-    LfgLockPartyMap lockMap;
-    GetCompatibleDungeons(compatibleDungeons, players, lockMap);
-
-    if (compatibleDungeons.empty())
-    {
-        SetCompatibles(strGuids, false);
-        return false;
+        players.insert(player);
     }
-    SetCompatibles(strGuids, true);
 
-    // ----- Group is compatible, if we have MAXGROUPSIZE members then match is found
-    if (numPlayers != 5)
-    {
-        LOG_DEBUG("(%s) Compatibles but not match. Players(%u)", strGuids.c_str(), numPlayers);
-        uint8 Tanks_Needed = LFG_TANKS_NEEDED;
-        uint8 Healers_Needed = LFG_HEALERS_NEEDED;
-        uint8 Dps_Needed = LFG_DPS_NEEDED;
-        for (LfgQueueInfoMap::const_iterator itQueue = pqInfoMap.begin(); itQueue != pqInfoMap.end(); ++itQueue)
-        {
-            LfgQueueInfo* queue = itQueue->second;
-            for (LfgRolesMap::const_iterator itPlayer = queue->roles.begin(); itPlayer != queue->roles.end(); ++itPlayer)
-            {
-                uint8 roles = itPlayer->second;
-                if ((roles & ROLE_TANK) && Tanks_Needed > 0)
-                    --Tanks_Needed;
-                else if ((roles & ROLE_HEALER) && Healers_Needed > 0)
-                    --Healers_Needed;
-                else if ((roles & ROLE_DAMAGE) && Dps_Needed > 0)
-                    --Dps_Needed;
-            }
-        }
-        for (PlayerSet::const_iterator itPlayers = players.begin(); itPlayers != players.end(); ++itPlayers)
-        {
-            for (LfgQueueInfoMap::const_iterator itQueue = pqInfoMap.begin(); itQueue != pqInfoMap.end(); ++itQueue)
-            {
-                LfgQueueInfo* queue = itQueue->second;
-                if (!queue)
-                    continue;
+    // Role states guarantee an assignment exists, this picks one
+    if (!CheckGroupRoles(rolesMap))
+        return NULL;
 
-                for (LfgRolesMap::const_iterator itPlayer = queue->roles.begin(); itPlayer != queue->roles.end(); ++itPlayer)
-                {
-                    if (*itPlayers == objmgr.GetPlayer(GET_LOWGUID_PART(itPlayer->first)))
-                    {
-                        queue->tanks = Tanks_Needed;
-                        queue->healers = Healers_Needed;
-                        queue->dps = Dps_Needed;
-                    }
-                }
-            }
-        }
-        return true;
-    }
-    LOG_DEBUG("(%s) MATCH! Group formed", strGuids.c_str());
+    LOG_DEBUG("(%s) MATCH! Group formed", ConcatenateGuids(check).c_str());
 
     // GROUP FORMED!
 
     // Select a random dungeon from the compatible list
     // Create a new proposal
-    pProposal = new LfgProposal(SelectRandomContainerElement(compatibleDungeons));
+    LfgProposal* pProposal = new LfgProposal(SelectRandomContainerElement(dungeons));
     pProposal->cancelTime = time_t(time(NULL)) + LFG_TIME_PROPOSAL;
     pProposal->state = LFG_PROPOSAL_INITIATING;
     pProposal->queues = check;
     pProposal->groupLowGuid = groupLowGuid;
-
-    // Assign new roles to players and assign new leader
-    PlayerSet::const_iterator itPlayers = players.begin();
-    /*
-    if (!leader)
-    {
-    uint8 pos = 1;
-    for (uint8 i = 0; i < pos; ++i)
-    ++itPlayers;
-    leader = (*itPlayers)->GetGUID();
-    }
-    */
     pProposal->leader = leader;
 
     uint8 numAccept = 0;
-    for (itPlayers = players.begin(); itPlayers != players.end(); ++itPlayers)
+    for (PlayerSet::const_iterator itPlayers = players.begin(); itPlayers != players.end(); ++itPlayers)
     {
         uint64 guid = (*itPlayers)->GetGUID();
         LfgProposalPlayer* ppPlayer = new LfgProposalPlayer();
@@ -937,7 +789,35 @@ bool LfgMgr::CheckCompatibility(LfgGuidList check, LfgProposal*& pProposal)
     if (numAccept == 5)
         pProposal->state = LFG_PROPOSAL_SUCCESS;
 
-    return true;
+    return pProposal;
+}
+
+void LfgMgr::PrepareQueueInfo(uint64 guid, LfgQueueInfo* queue)
+{
+    queue->roleStates = LfgGroupMatcher::getRoleStates(queue->roles);
+
+    queue->lfgGroup = false;
+    if (IS_GROUP(guid))
+        if (Group* grp = objmgr.GetGroupById(GET_LOWGUID_PART(guid)))
+            queue->lfgGroup = grp->isLFGGroup();
+
+    // Readded after a failed proposal, already counted
+    if (queue->counted)
+        return;
+
+    // A new queue info, forget what was cached for an older one of this guid
+    m_GroupMatcher.removeFromCompatibles(guid);
+
+    PlayerSet players;
+    for (LfgRolesMap::const_iterator it = queue->roles.begin(); it != queue->roles.end(); ++it)
+        if (Player* player = objmgr.GetPlayer(GET_LOWGUID_PART(it->first)))
+            players.insert(player);
+
+    LfgLockPartyMap lockMap;
+    queue->availableDungeons = queue->dungeons;
+    GetCompatibleDungeons(queue->availableDungeons, players, lockMap);
+
+    m_GroupMatcher.addRoleCounts(queue);
 }
 
 void LfgMgr::UpdateRoleCheck(uint64 gguid, uint64 guid /* = 0 */, uint8 roles /* = ROLE_NONE */)
@@ -1054,36 +934,6 @@ void LfgMgr::UpdateRoleCheck(uint64 gguid, uint64 guid /* = 0 */, uint8 roles /*
     }
 }
 
-void LfgMgr::RemoveFromCompatibles(uint64 guid)
-{
-    std::stringstream out;
-    out << guid;
-    std::string strGuid = out.str();
-
-    LOG_DEBUG("Removing %u", guid);
-    for (LfgCompatibleMap::iterator itNext = m_CompatibleMap.begin(); itNext != m_CompatibleMap.end();)
-    {
-        LfgCompatibleMap::iterator it = itNext++;
-        if (it->first.find(strGuid) != std::string::npos)  // Found, remove it
-            m_CompatibleMap.erase(it);
-    }
-}
-
-void LfgMgr::SetCompatibles(std::string key, bool compatibles)
-{
-    m_CompatibleMap[key] = LfgAnswer(compatibles);
-}
-
-LfgAnswer LfgMgr::GetCompatibles(std::string key)
-{
-    LfgAnswer answer = LFG_ANSWER_PENDING;
-    LfgCompatibleMap::iterator it = m_CompatibleMap.find(key);
-    if (it != m_CompatibleMap.end())
-        answer = it->second;
-
-    return answer;
-}
-
 void LfgMgr::GetCompatibleDungeons(LfgDungeonSet& dungeons, const PlayerSet& players, LfgLockPartyMap& lockMap)
 {
     lockMap.clear();
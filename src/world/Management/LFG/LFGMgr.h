@@ -20,6 +20,7 @@
 #define _LFGMGR_H
 
 #include "LFG.h"
+#include "LFGGroupMatcher.h"
 #include "Server/Definitions.h"
 #include <list>
 #include "../../shared/Singleton.h"
@@ -40,9 +41,6 @@ enum LFGenum
     LFG_TIME_ROLECHECK                           = 2 * MINUTE,
     LFG_TIME_BOOT                                = 2 * MINUTE,
     LFG_TIME_PROPOSAL                            = 2 * MINUTE,
-    LFG_TANKS_NEEDED                             = 1,
-    LFG_HEALERS_NEEDED                           = 1,
-    LFG_DPS_NEEDED                               = 3,
     LFG_QUEUEUPDATE_INTERVAL                     = 15 * IN_MILLISECONDS,
     LFG_SPELL_DUNGEON_COOLDOWN                   = 71328,
     LFG_SPELL_DUNGEON_DESERTER                   = 71041,
@@ -117,36 +115,23 @@ enum LfgRoleCheckState
     LFG_ROLECHECK_NO_ROLE                        = 6       // Someone selected no role
 };
 
-/// Answer state (Also used to check compatibilites)
-enum LfgAnswer
-{
-    LFG_ANSWER_PENDING                           = -1,
-    LFG_ANSWER_DENY                              = 0,
-    LFG_ANSWER_AGREE                             = 1
-};
-
 // Forward declaration (just to have all typedef together)
 struct LfgReward;
 struct LfgLockStatus;
-struct LfgQueueInfo;
 struct LfgRoleCheck;
 struct LfgProposal;
 struct LfgProposalPlayer;
 struct LfgPlayerBoot;
 
 typedef std::set<uint64> LfgGuidSet;
-typedef std::list<uint64> LfgGuidList;
 typedef std::map<uint8, LfgGuidList> LfgGuidListMap;
 typedef std::set<Player*> PlayerSet;
 typedef std::list<Player*> LfgPlayerList;
 typedef std::multimap<uint32, LfgReward const*> LfgRewardMap;
 typedef std::pair<LfgRewardMap::const_iterator, LfgRewardMap::const_iterator> LfgRewardMapBounds;
-typedef std::map<std::string, LfgAnswer> LfgCompatibleMap;
 typedef std::map<uint64, LfgDungeonSet> LfgDungeonMap;
-typedef std::map<uint64, uint8> LfgRolesMap;
 typedef std::map<uint64, LfgAnswer> LfgAnswerMap;
 typedef std::map<uint64, LfgRoleCheck*> LfgRoleCheckMap;
-typedef std::map<uint64, LfgQueueInfo*> LfgQueueInfoMap;
 typedef std::map<uint32, LfgProposal*> LfgProposalMap;
 typedef std::map<uint64, LfgProposalPlayer*> LfgProposalPlayerMap;
 typedef std::map<uint32, LfgPlayerBoot*> LfgPlayerBootMap;
@@ -198,18 +183,6 @@ struct LfgReward
     }
 };
 
-/// Stores player or group queue info
-struct LfgQueueInfo
-{
-    LfgQueueInfo(): joinTime(0), tanks(LFG_TANKS_NEEDED), healers(LFG_HEALERS_NEEDED), dps(LFG_DPS_NEEDED) {};
-    time_t joinTime;                                       ///< Player queue join time (to calculate wait times)
-    uint8 tanks;                                           ///< Tanks needed
-    uint8 healers;                                         ///< Healers needed
-    uint8 dps;                                             ///< Dps needed
-    LfgDungeonSet dungeons;                                ///< Selected Player/Group Dungeon/s
-    LfgRolesMap roles;                                     ///< Selected Player Role/s
-};
-
 /// Stores player data related to proposal to join
 struct LfgProposalPlayer
 {
@@ -317,7 +290,7 @@ class LfgMgr : public Singleton < LfgMgr >, EventableObject
         void SetSelectedDungeons(uint64 guid, const LfgDungeonSet& dungeons);
 
 	private:
-		
+
         uint8 GetRoles(uint64 guid);
         const std::string& GetComment(uint64 gguid);
         void RestoreState(uint64 guid);
@@ -332,13 +305,11 @@ class LfgMgr : public Singleton < LfgMgr >, EventableObject
         void RemoveProposal(LfgProposalMap::iterator itProposal, LfgUpdateType type);
 
         // Group Matching
-        LfgProposal* FindNewGroups(LfgGuidList& check, LfgGuidList& all);
+        LfgProposal* FindNewGroups(uint64 newGuid, const LfgGuidList& all);
+        bool FindGroupCandidates(uint64 newGuid, const LfgGuidList& all, LfgGuidList& check, LfgDungeonSet& dungeons);
         bool CheckGroupRoles(LfgRolesMap &groles, bool removeLeaderFlag = true);
-        bool CheckCompatibility(LfgGuidList check, LfgProposal*& pProposal);
+        void PrepareQueueInfo(uint64 guid, LfgQueueInfo* queue);
         void GetCompatibleDungeons(LfgDungeonSet& dungeons, const PlayerSet& players, LfgLockPartyMap& lockMap);
-        void SetCompatibles(std::string concatenatedGuids, bool compatibles);
-        LfgAnswer GetCompatibles(std::string concatenatedGuids);
-        void RemoveFromCompatibles(uint64 guid);
 
         // Generic
         const LfgDungeonSet& GetDungeonsByRandom(uint32 randomdungeon);
@@ -364,7 +335,7 @@ class LfgMgr : public Singleton < LfgMgr >, EventableObject
         LfgQueueInfoMap m_QueueInfoMap;                    ///< Queued groups
         LfgGuidListMap m_currentQueue;                     ///< Ordered list. Used to find groups
         LfgGuidListMap m_newToQueue;                       ///< New groups to add to queue
-        LfgCompatibleMap m_CompatibleMap;                  ///< Compatible dungeons
+        LfgGroupMatcher m_GroupMatcher;                    ///< Compatibility cache and role counts of the queued players/groups
         LfgGuidList m_teleport;                            ///< Players being teleported
         // Rolecheck - Proposal - Vote Kicks
         LfgRoleCheckMap m_RoleChecks;                      ///< Current Role checks
@@ -29,47 +29,102 @@ extern "C" {
 #include <pcre.h>
 };
 
+#include <algorithm>
+#include <cctype>
+
 #define REPLACE_FILTER 1
 #define SEARCH_FILTER 0
 
 WordFilter* g_characterNameFilter;
 WordFilter* g_chatFilter;
 
-WordFilter::~WordFilter()
+namespace
 {
-    size_t i;
-    WordFilterMatch* p;
+    // shorter required literals are found in too many messages to save a pcre_exec
+    const size_t minRequiredLiteralLength = 3;
 
-    if (!m_filters)
-        return;
+    void FreeExpression(void* pExpression, void* pExtra)
+    {
+        if (pExtra)
+            pcre_free(pExtra);
+        if (pExpression)
+            pcre_free(pExpression);
+    }
 
-    for (i = 0; i < m_filterCount; ++i)
+    // returns > 0 on a match, 0 on no match and < 0 on errors
+    int ExecuteExpression(void* pExpression, void* pExtra, const char* szInput, size_t iLen, int iOffset, int* ovec, int iOvecSize)
     {
-        p = m_filters[i];
-        if (p == NULL)
-            continue;
+        const int n = pcre_exec((const pcre*)pExpression, (const pcre_extra*)pExtra, szInput, (int)iLen, iOffset, 0, ovec, iOvecSize);
+        if (n == PCRE_ERROR_NOMATCH)
+            return 0;
 
-        if (p->szMatch)
+        if (n < 0)
         {
-            free(p->szMatch);
-            pcre_free(p->pCompiledExpression);
-            if (p->pCompiledExpressionOptions)
-                pcre_free(p->pCompiledExpressionOptions);
+            LOG_ERROR("pcre_exec returned %d.", n);
+            return n;
         }
 
-        if (p->szIgnoreMatch)
+        return 1;
+    }
+
+    // returns > 0 if the filter blocks the message, 0 if not and < 0 on errors.
+    // Matches of replace filters are added to lReplace.
+    int CheckExpression(WordFilterMatch* pFilter, const char* szInput, size_t iLen, bool bAllowReplace, std::vector<std::pair<size_t, size_t>>& lReplace)
+    {
+        int ovec[30];
+
+        if (pFilter->iType == REPLACE_FILTER && bAllowReplace)
         {
-            pcre_free(p->pCompiledIgnoreExpression);
-            if (p->pCompiledIgnoreExpressionOptions)
-                pcre_free(p->pCompiledIgnoreExpressionOptions);
+            if (pFilter->pCompiledIgnoreExpression)
+            {
+                const int n = ExecuteExpression(pFilter->pCompiledIgnoreExpression, pFilter->pCompiledIgnoreExpressionOptions, szInput, iLen, 0, ovec, 30);
+                if (n != 0)
+                    return n < 0 ? n : 0;
+            }
 
-            free(p->szIgnoreMatch);
+            for (int iOffset = 0; iOffset <= (int)iLen;)
+            {
+                const int n = ExecuteExpression(pFilter->pCompiledExpression, pFilter->pCompiledExpressionOptions, szInput, iLen, iOffset, ovec, 30);
+                if (n <= 0)
+                    return n;
+
+                lReplace.push_back(std::make_pair(size_t(ovec[0]), size_t(ovec[1])));
+                iOffset = ovec[1] > ovec[0] ? ovec[1] : ovec[1] + 1;
+            }
+
+            return 0;
         }
 
-        delete p;
+        const int n = ExecuteExpression(pFilter->pCompiledExpression, pFilter->pCompiledExpressionOptions, szInput, iLen, 0, ovec, 30);
+        if (n <= 0 || !pFilter->pCompiledIgnoreExpression)
+            return n;
+
+        // our string didn't match any of the excludes, so it is blocked
+        const int m = ExecuteExpression(pFilter->pCompiledIgnoreExpression, pFilter->pCompiledIgnoreExpressionOptions, szInput, iLen, 0, ovec, 30);
+        return m == 0 ? 1 : (m < 0 ? m : 0);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// WordFilterSet
+WordFilterSet::~WordFilterSet()
+{
+    std::vector<WordFilterMatch*> lMatches(literals);
+    lMatches.insert(lMatches.end(), prefiltered.begin(), prefiltered.end());
+    lMatches.insert(lMatches.end(), expressions.begin(), expressions.end());
+
+    for (std::vector<WordFilterMatch*>::iterator itr = lMatches.begin(); itr != lMatches.end(); ++itr)
+    {
+        FreeExpression((*itr)->pCompiledExpression, (*itr)->pCompiledExpressionOptions);
+        FreeExpression((*itr)->pCompiledIgnoreExpression, (*itr)->pCompiledIgnoreExpressionOptions);
+        delete *itr;
     }
+}
 
-    delete[] m_filters;
+//////////////////////////////////////////////////////////////////////////////////////////
+// WordFilter
+WordFilter::~WordFilter()
+{
 }
 
 bool WordFilter::CompileExpression(const char* szExpression, void** pOutput, void** pExtraOutput)
@@ -102,124 +157,178 @@ bool WordFilter::CompileExpression(const char* szExpression, void** pOutput, voi
     return true;
 }
 
-void WordFilter::Load(const char* szTableName)
+bool WordFilter::Load(const char* szTableName)
 {
-    WordFilterMatch* pMatch;
-    size_t i;
-    std::list<WordFilterMatch*> lItems;
-    std::list<WordFilterMatch*>::iterator itr;
-    QueryResult* pResult = WorldDatabase.Query("SELECT * FROM %s", szTableName);
-    if (pResult == NULL)
-        return;
-
-    do
+    bool bQueried;
+    QueryResult* pResult = WorldDatabase.Query(&bQueried, "SELECT * FROM %s", szTableName);
+    if (!bQueried)
     {
-        pMatch = new WordFilterMatch;
-        pMatch->szMatch = (strlen(pResult->Fetch()[0].GetString()) > 1) ? strdup(pResult->Fetch()[0].GetString()) : NULL;
-        if (pMatch->szMatch == NULL)
-        {
-            delete pMatch;
-            continue;
-        }
+        LOG_ERROR("WordFilter : %s could not be queried, the loaded filters stay active.", szTableName);
+        return false;
+    }
 
-        pMatch->szIgnoreMatch = (strlen(pResult->Fetch()[1].GetString()) > 1) ? strdup(pResult->Fetch()[1].GetString()) : NULL;
+    // built aside, chat keeps using the current set until this one is complete
+    std::shared_ptr<WordFilterSet> pSet = std::make_shared<WordFilterSet>();
 
-        // compile the expression
-        if (!CompileExpression(pMatch->szMatch, &pMatch->pCompiledExpression, &pMatch->pCompiledExpressionOptions))
+    uint32_t iFailed = 0;
+    if (pResult != NULL)
+    {
+        do
         {
-            free(pMatch->szMatch);
-            if (pMatch->szIgnoreMatch)
-                free(pMatch->szIgnoreMatch);
-            delete pMatch;
-            continue;
-        }
+            Field* fields = pResult->Fetch();
+            if (strlen(fields[0].GetString()) <= 1)
+                continue;
 
-        if (pMatch->szIgnoreMatch != NULL)
-        {
-            if (!CompileExpression(pMatch->szIgnoreMatch, &pMatch->pCompiledIgnoreExpression, &pMatch->pCompiledIgnoreExpressionOptions))
+            WordFilterMatch* pMatch = new WordFilterMatch;
+            pMatch->szMatch = fields[0].GetString();
+            pMatch->szIgnoreMatch = (strlen(fields[1].GetString()) > 1) ? fields[1].GetString() : "";
+            pMatch->pCompiledExpression = NULL;
+            pMatch->pCompiledExpressionOptions = NULL;
+            pMatch->pCompiledIgnoreExpression = NULL;
+            pMatch->pCompiledIgnoreExpressionOptions = NULL;
+            pMatch->iType = fields[2].GetUInt32();
+
+            // compile the expressions, literals are checked for errors too
+            if (!CompileExpression(pMatch->szMatch.c_str(), &pMatch->pCompiledExpression, &pMatch->pCompiledExpressionOptions))
             {
-                free(pMatch->szMatch);
-                if (pMatch->szIgnoreMatch)
-                    free(pMatch->szIgnoreMatch);
                 delete pMatch;
+                ++iFailed;
                 continue;
             }
-        }
-        else
-        {
-            pMatch->pCompiledIgnoreExpression = NULL;
-            pMatch->pCompiledIgnoreExpressionOptions = NULL;
-        }
 
-        pMatch->iType = pResult->Fetch()[2].GetUInt32();
-        lItems.push_back(pMatch);
+            if (!pMatch->szIgnoreMatch.empty())
+            {
+                if (!CompileExpression(pMatch->szIgnoreMatch.c_str(), &pMatch->pCompiledIgnoreExpression, &pMatch->pCompiledIgnoreExpressionOptions))
+                {
+                    FreeExpression(pMatch->pCompiledExpression, pMatch->pCompiledExpressionOptions);
+                    delete pMatch;
+                    ++iFailed;
+                    continue;
+                }
+            }
+
+            if (WordFilterAutomaton::isLiteralExpression(pMatch->szMatch))
+            {
+                FreeExpression(pMatch->pCompiledExpression, pMatch->pCompiledExpressionOptions);
+                pMatch->pCompiledExpression = NULL;
+                pMatch->pCompiledExpressionOptions = NULL;
+
+                pSet->automaton.addPattern(pMatch->szMatch, static_cast<uint32_t>(pSet->literals.size()));
+                pSet->literals.push_back(pMatch);
+            }
+            else
+            {
+                const std::string sRequired = WordFilterAutomaton::getRequiredLiteral(pMatch->szMatch);
+                if (sRequired.length() >= minRequiredLiteralLength)
+                {
+                    pSet->automaton.addPattern(sRequired, static_cast<uint32_t>(pSet->prefiltered.size()) | WordFilterSet::prefilterId);
+                    pSet->prefiltered.push_back(pMatch);
+                }
+                else
+                {
+                    pSet->expressions.push_back(pMatch);
+                }
+            }
+        }
+        while (pResult->NextRow());
+        delete pResult;
     }
-    while (pResult->NextRow());
-    delete pResult;
 
-    if (lItems.size() == 0)
-        return;
+    pSet->automaton.build();
 
-    m_filters = new WordFilterMatch*[lItems.size()];
-    i = 0;
-    for (itr = lItems.begin(); itr != lItems.end(); ++itr)
-        m_filters[i++] = (*itr);
+    // a reload with broken rows would silently drop them, keep the working set instead.
+    // The first load takes what compiled, as it always did.
+    if (iFailed != 0 && std::atomic_load(&m_set))
+    {
+        LOG_ERROR("WordFilter : %s has %u filters which do not compile, the loaded filters stay active.", szTableName, iFailed);
+        return false;
+    }
 
-    m_filterCount = i;
+    LogDetail("WordFilter : %s: %u literals, %u prefiltered expressions, %u expressions", szTableName,
+        static_cast<uint32_t>(pSet->literals.size()), static_cast<uint32_t>(pSet->prefiltered.size()), static_cast<uint32_t>(pSet->expressions.size()));
+
+    // messages which are parsed right now finish with the old set
+    std::atomic_store(&m_set, pSet);
+    return iFailed == 0;
 }
 
 bool WordFilter::Parse(std::string & sMessage, bool bAllowReplace /* = true */)
 {
 #define N 10
 #define NC (N*3)
-    size_t i;
     int ovec[N * 3];
-    int n;
-    WordFilterMatch* pFilter;
+    const std::shared_ptr<WordFilterSet> pSet = std::atomic_load(&m_set);
+    if (!pSet)
+        return false;
+
     const char* szInput = sMessage.c_str();
     size_t iLen = sMessage.length();
-    //char
 
-    for (i = 0; i < m_filterCount; ++i)
+    // ranges of replace filters, masked once we know the message is not blocked
+    std::vector<std::pair<size_t, size_t>> lReplace;
+    std::vector<uint32_t> lTriggered;
+    bool bBlocked = false;
+    bool bFailed = false;
+
+    pSet->automaton.search(szInput, iLen, [&](uint32_t id, size_t end)
     {
-        pFilter = m_filters[i];
-        if ((n = pcre_exec((const pcre*)pFilter->pCompiledExpression,
-            (const pcre_extra*)pFilter->pCompiledExpressionOptions, szInput, (int)iLen, 0, 0, ovec, NC)) < 0)
+        if (id & WordFilterSet::prefilterId)
         {
-            if (n == PCRE_ERROR_NOMATCH)
-                continue;
-
-            LOG_ERROR("pcre_exec returned %d.", n);
-            return false;
+            lTriggered.push_back(id & ~WordFilterSet::prefilterId);
+            return true;
         }
-        else
+
+        WordFilterMatch* pFilter = pSet->literals[id];
+        if (pFilter->pCompiledIgnoreExpression)
         {
-            // one or more matches found
-            if (pFilter->szIgnoreMatch)
+            // our string passed this filter if it matches the exclude
+            const int n = ExecuteExpression(pFilter->pCompiledIgnoreExpression, pFilter->pCompiledIgnoreExpressionOptions, szInput, iLen, 0, ovec, NC);
+            if (n != 0)
             {
-                // ignore case
-                if ((n = pcre_exec((const pcre*)pFilter->pCompiledIgnoreExpression,
-                    (const pcre_extra*)pFilter->pCompiledIgnoreExpressionOptions, szInput, (int)iLen, 0, 0, ovec, NC)) < 0)
-                {
-                    // our string didn't match any of the excludes, so it passes
-                    if (n == PCRE_ERROR_NOMATCH)
-                        return true;
-
-                    LOG_ERROR("pcre_exec returned %d.", n);
-                    return false;
-                }
-                else
-                {
-                    // our string passed this filter.
-                    continue;
-                }
+                bFailed = n < 0;
+                return !bFailed;
             }
-            else
-                return true;
         }
+
+        if (pFilter->iType == REPLACE_FILTER && bAllowReplace)
+        {
+            lReplace.push_back(std::make_pair(end - pFilter->szMatch.length(), end));
+            return true;
+        }
+
+        bBlocked = true;
+        return false;
+    });
+
+    if (bFailed)
+        return false;
+    if (bBlocked)
+        return true;
+
+    // a required literal can occur several times
+    std::sort(lTriggered.begin(), lTriggered.end());
+    lTriggered.erase(std::unique(lTriggered.begin(), lTriggered.end()), lTriggered.end());
+
+    for (std::vector<uint32_t>::const_iterator itr = lTriggered.begin(); itr != lTriggered.end(); ++itr)
+    {
+        const int n = CheckExpression(pSet->prefiltered[*itr], szInput, iLen, bAllowReplace, lReplace);
+        if (n != 0)
+            return n > 0;
+    }
+
+    for (std::vector<WordFilterMatch*>::const_iterator itr = pSet->expressions.begin(); itr != pSet->expressions.end(); ++itr)
+    {
+        const int n = CheckExpression(*itr, szInput, iLen, bAllowReplace, lReplace);
+        if (n != 0)
+            return n > 0;
     }
 
+    for (std::vector<std::pair<size_t, size_t>>::const_iterator itr = lReplace.begin(); itr != lReplace.end(); ++itr)
+        sMessage.replace(itr->first, itr->second - itr->first, itr->second - itr->first, '*');
+
     return false;
+#undef NC
+#undef N
 }
 
 /*  \todo move this to wiki!
@@ -19,34 +19,61 @@
  */
 #pragma once
 
+#include "WordFilterAutomaton.hpp"
+
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 struct WordFilterMatch
 {
-    char* szMatch;
-    char* szIgnoreMatch;
-    void* pCompiledExpression;
-    void* pCompiledIgnoreExpression;
+    std::string szMatch;
+    std::string szIgnoreMatch;
+    void* pCompiledExpression;              // nullptr for literals, they are matched by the automaton
     void* pCompiledExpressionOptions;
+    void* pCompiledIgnoreExpression;
     void* pCompiledIgnoreExpressionOptions;
     int iType;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Compiled filters of one table. Replaced as a whole on reload, so chat keeps using
+/// the previous set until the new one is ready.
+//////////////////////////////////////////////////////////////////////////////////////////
+struct WordFilterSet
+{
+    /// automaton ids with this bit belong to the required literal of a prefiltered expression
+    static const uint32_t prefilterId = 0x80000000;
+
+    ~WordFilterSet();
+
+    std::vector<WordFilterMatch*> literals;             // indexed by automaton id
+    WordFilterAutomaton automaton;
+
+    /// regex filters with a literal every match contains, only run when the automaton found it
+    std::vector<WordFilterMatch*> prefiltered;          // indexed by automaton id without prefilterId
+
+    /// regex filters which are run on every message
+    std::vector<WordFilterMatch*> expressions;
+};
+
 class WordFilter
 {
-    WordFilterMatch** m_filters;
-    size_t m_filterCount;
+    std::shared_ptr<WordFilterSet> m_set;
 
     bool CompileExpression(const char* szExpression, void** pOutput, void** pExtraOutput);
 
 public:
-    WordFilter() : m_filters(nullptr), m_filterCount(0)
+    WordFilter()
     {
     }
 
     ~WordFilter();
 
-    void Load(const char* szTableName);
+    /// (re)loads the table, Parse may be called meanwhile. On a reload the loaded filters
+    /// are only replaced when the query worked and every filter compiled.
+    bool Load(const char* szTableName);
     bool Parse(std::string& sMessage, bool bAllowReplace = true);
     bool ParseEscapeCodes(char* sMessage, bool bAllowLinks);
 };
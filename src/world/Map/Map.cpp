@@ -27,15 +27,18 @@
 
 // Class Map
 // Holder for all instances of each mapmgr, handles transferring players between, and template holding.
-Map::Map(uint32 mapid, MapInfo const* inf)
+Map::Map(uint32 mapid, MapInfo const* inf, bool loadSpawns)
 {
     memset(spawns, 0, sizeof(CellSpawns*) * _sizeX);
 
     _mapInfo = inf;
     _mapId = mapid;
+    CreatureSpawnCount = 0;
+    GameObjectSpawnCount = 0;
 
     //new stuff Load Spawns
-    LoadSpawns(false);
+    if (loadSpawns)
+        LoadSpawns(false);
 
     // get our name
     if (_mapInfo)
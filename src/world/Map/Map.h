@@ -115,7 +115,8 @@ class SERVER_DECL Map
 {
     public:
 
-        Map(uint32 mapid, MapInfo const* inf);
+        /// loadSpawns = false starts without spawns, e.g. for a fixture of the tick benchmark
+        Map(uint32 mapid, MapInfo const* inf, bool loadSpawns = true);
         ~Map();
 
         std::string GetMapName();
@@ -0,0 +1,389 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "MapBenchmarkSuite.h"
+#include "MapMgr.h"
+#include "MapObjectPool.h"
+#include "SysInfo.hpp"
+#include "Spell/Spell.h"
+#include "Spell/SpellAuras.h"
+#include "Spell/SpellMgr.h"
+#include "Spell/SpellProc.h"
+#include "Spell/Customization/SpellCustomizations.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+const MapBenchmarkSuite::Entry MapBenchmarkSuite::s_benchmarks[] =
+{
+    { "auras", &MapBenchmarkSuite::_benchmarkAuras },
+    { "aoe", &MapBenchmarkSuite::_benchmarkAoe },
+    { "pool", &MapBenchmarkSuite::_benchmarkPool },
+    { nullptr, nullptr }
+};
+
+MapBenchmarkSuite::MapBenchmarkSuite(MapMgr* mapMgr, const std::vector<Player*>& players) : m_mapMgr(mapMgr), m_players(players)
+{
+}
+
+bool MapBenchmarkSuite::run(const std::string& names)
+{
+    std::vector<std::string> selected;
+
+    std::istringstream stream(names);
+    std::string name;
+    while (stream >> name)
+    {
+        if (name == "all")
+        {
+            for (const Entry* entry = s_benchmarks; entry->name != nullptr; ++entry)
+                selected.push_back(entry->name);
+        }
+        else
+        {
+            selected.push_back(name);
+        }
+    }
+
+    bool result = true;
+    for (std::vector<std::string>::const_iterator itr = selected.begin(); itr != selected.end(); ++itr)
+    {
+        const Entry* entry = s_benchmarks;
+        while (entry->name != nullptr && *itr != entry->name)
+            ++entry;
+
+        if (entry->name == nullptr)
+        {
+            LOG_ERROR("TickBenchmark : Unknown suite benchmark '%s'.", itr->c_str());
+            result = false;
+            continue;
+        }
+
+        LogNotice("TickBenchmark : Suite %s", entry->name);
+        if (!(this->*entry->benchmark)())
+            result = false;
+    }
+
+    return result;
+}
+
+bool MapBenchmarkSuite::_report(const char* benchmark, const std::string& name, double referenceTime, double currentTime, bool sameResult)
+{
+    LogNotice("TickBenchmark : %-10s | %-40s | reference %10.1f ns | current %10.1f ns | %6.2fx%s", benchmark, name.c_str(), referenceTime,
+        currentTime, currentTime > 0.0 ? referenceTime / currentTime : 0.0, sameResult ? "" : " | RESULTS DIFFER");
+
+    if (!sameResult)
+        LOG_ERROR("TickBenchmark : %s %s: the current code returns other results than the reference.", benchmark, name.c_str());
+
+    return sameResult;
+}
+
+Unit* MapBenchmarkSuite::_getTestUnit() const
+{
+    if (!m_players.empty())
+        return m_players.front();
+
+    if (!m_mapMgr->activeCreatures.empty())
+        return *m_mapMgr->activeCreatures.begin();
+
+    return nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// auras
+// Lookups on a unit with 120 auras, reference is the slot scan the aura indexes replaced.
+bool MapBenchmarkSuite::_benchmarkAuras()
+{
+    const uint32_t auraCount = 120;
+    const uint32_t iterations = 200000;
+
+    Unit* unit = _getTestUnit();
+    if (unit == nullptr)
+    {
+        LOG_ERROR("TickBenchmark : auras needs a player or an active creature on the map.");
+        return false;
+    }
+
+    // spells with an aura effect, sorted so every run applies the same ones
+    std::vector<SpellInfo*> spells;
+    SpellCustomizations::SpellInfoContainer* store = sSpellCustomizations.GetSpellInfoStore();
+    for (SpellCustomizations::SpellInfoContainer::iterator itr = store->begin(); itr != store->end(); ++itr)
+    {
+        if (itr->second.EffectApplyAuraName[0] != 0 && !unit->HasAura(itr->first))
+            spells.push_back(&itr->second);
+    }
+
+    std::sort(spells.begin(), spells.end(), [](SpellInfo* a, SpellInfo* b) { return a->Id < b->Id; });
+
+    // the auras are put into free slots without being applied, only the lookups are measured
+    std::vector<uint16_t> slots;
+    for (uint16_t slot = MAX_TOTAL_AURAS_START; slot < MAX_TOTAL_AURAS_END && slots.size() < auraCount && slots.size() < spells.size(); ++slot)
+    {
+        if (unit->m_auras[slot] == nullptr)
+        {
+            unit->setAuraInSlot(slot, sSpellFactoryMgr.NewAura(spells[slots.size()], -1, unit, unit));
+            slots.push_back(slot);
+        }
+    }
+
+    // half of the queried spells are on the unit
+    std::vector<SpellInfo*> queries;
+    for (size_t i = 0; i < slots.size() && slots.size() + i < spells.size(); ++i)
+    {
+        queries.push_back(spells[i]);
+        queries.push_back(spells[slots.size() + i]);
+    }
+
+    if (queries.empty())
+    {
+        LOG_ERROR("TickBenchmark : auras found no spells with aura effects.");
+        return false;
+    }
+
+    bool result = true;
+    const size_t queryCount = queries.size();
+    std::stringstream label;
+    label << slots.size() << " auras";
+
+    result &= _compare("auras", "HasAura, " + label.str(), iterations,
+        [unit, &queries, queryCount](uint32_t i) -> uint64_t
+        {
+            const uint32_t spellId = queries[i % queryCount]->Id;
+            for (uint32_t x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; ++x)
+                if (unit->m_auras[x] != nullptr && unit->m_auras[x]->GetSpellId() == spellId)
+                    return 1;
+
+            return 0;
+        },
+        [unit, &queries, queryCount](uint32_t i) -> uint64_t
+        {
+            return unit->HasAura(queries[i % queryCount]->Id) ? 1 : 0;
+        });
+
+    result &= _compare("auras", "FindAuraCountByHash, " + label.str(), iterations,
+        [unit, &queries, queryCount](uint32_t i) -> uint64_t
+        {
+            const uint32_t nameHash = queries[i % queryCount]->custom_NameHash;
+            uint64_t count = 0;
+            for (uint32_t x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; ++x)
+                if (unit->m_auras[x] != nullptr && unit->m_auras[x]->GetSpellInfo()->custom_NameHash == nameHash)
+                    ++count;
+
+            return count;
+        },
+        [unit, &queries, queryCount](uint32_t i) -> uint64_t
+        {
+            return unit->FindAuraCountByHash(queries[i % queryCount]->custom_NameHash, 0);
+        });
+
+    result &= _compare("auras", "getAuraWithAuraEffect, " + label.str(), iterations,
+        [unit](uint32_t i) -> uint64_t
+        {
+            const uint32_t auraEffect = 1 + i % (TOTAL_SPELL_AURAS - 1);
+            for (uint32_t x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; ++x)
+                if (unit->m_auras[x] != nullptr && unit->m_auras[x]->GetSpellInfo()->HasEffectApplyAuraName(auraEffect))
+                    return unit->m_auras[x]->GetSpellId();
+
+            return 0;
+        },
+        [unit](uint32_t i) -> uint64_t
+        {
+            Aura* aura = unit->getAuraWithAuraEffect(1 + i % (TOTAL_SPELL_AURAS - 1));
+            return aura != nullptr ? aura->GetSpellId() : 0;
+        });
+
+    for (std::vector<uint16_t>::const_iterator itr = slots.begin(); itr != slots.end(); ++itr)
+    {
+        Aura* aura = unit->m_auras[*itr];
+        unit->setAuraInSlot(*itr, nullptr);
+        delete aura;
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// aoe
+// Area target queries around every unit of the map, e.g. a fixture with 80 players for a
+// 40 vs 40 fight. Reference is the walk over the inrange set of the caster which
+// FillAllTargetsInArea did before it queried the cell grid.
+bool MapBenchmarkSuite::_benchmarkAoe()
+{
+    const uint32_t iterations = 20000;
+
+    std::vector<Unit*> casters(m_players.begin(), m_players.end());
+    for (CreatureSet::const_iterator itr = m_mapMgr->activeCreatures.begin(); itr != m_mapMgr->activeCreatures.end(); ++itr)
+        casters.push_back(*itr);
+
+    if (casters.empty())
+    {
+        LOG_ERROR("TickBenchmark : aoe needs players or active creatures on the map.");
+        return false;
+    }
+
+    std::stringstream label;
+    label << casters.size() << " units";
+
+    bool result = true;
+    const float radii[] = { 8.0f, 30.0f };
+    for (uint8_t r = 0; r < 2; ++r)
+    {
+        const float radius = radii[r];
+        std::stringstream name;
+        name << "units in " << radius << " yards, " << label.str();
+
+        result &= _compare("aoe", name.str(), iterations,
+            [&casters, radius](uint32_t i) -> uint64_t
+            {
+                Unit* caster = casters[i % casters.size()];
+                uint64_t checksum = 0;
+                for (Object::InRangeSet::iterator itr = caster->GetInRangeSetBegin(); itr != caster->GetInRangeSetEnd(); ++itr)
+                {
+                    if (!(*itr)->IsUnit() || !static_cast<Unit*>(*itr)->isAlive())
+                        continue;
+
+                    if (IsInrange(caster->GetPositionX(), caster->GetPositionY(), caster->GetPositionZ(), *itr, radius * radius))
+                        checksum += (*itr)->GetGUID();
+                }
+
+                return checksum;
+            },
+            [this, &casters, radius](uint32_t i) -> uint64_t
+            {
+                Unit* caster = casters[i % casters.size()];
+                uint64_t checksum = 0;
+                m_mapMgr->ForEachUnitInRadius(caster->GetPositionX(), caster->GetPositionY(), caster->GetPositionZ(), radius, [caster, &checksum](Unit* target) -> bool
+                {
+                    if (target != caster && target->isAlive())
+                        checksum += target->GetGUID();
+
+                    return true;
+                });
+
+                return checksum;
+            });
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// pool
+// Combat soak of the pooled spell system objects: 20000 of them stay alive, every iteration
+// frees a pseudo random one and allocates a Spell, Aura, TimedEvent or SpellProc in its
+// place. Reference is operator new, current MapObjectPool. Besides the time per allocation
+// it prints the RSS growth of both sides and the memory reserved by the pool.
+namespace
+{
+    uint32_t poolSoakHash(uint32_t i)
+    {
+        i ^= i >> 16;
+        i *= 0x7FEB352D;
+        i ^= i >> 15;
+        i *= 0x846CA68B;
+        i ^= i >> 16;
+        return i;
+    }
+
+    struct PoolSoakObject
+    {
+        MapPoolType type;
+        size_t size;
+    };
+
+    // roughly the mix of a fight, every cast comes with auras and events, procs are rarer
+    const PoolSoakObject poolSoakObjects[] =
+    {
+        { MAP_POOL_SPELL, sizeof(Spell) },
+        { MAP_POOL_SPELL, sizeof(Spell) },
+        { MAP_POOL_SPELL, sizeof(Spell) },
+        { MAP_POOL_AURA, sizeof(Aura) },
+        { MAP_POOL_AURA, sizeof(Aura) },
+        { MAP_POOL_AURA, sizeof(Aura) },
+        { MAP_POOL_TIMED_EVENT, sizeof(TimedEvent) },
+        { MAP_POOL_TIMED_EVENT, sizeof(TimedEvent) },
+        { MAP_POOL_TIMED_EVENT, sizeof(TimedEvent) },
+        { MAP_POOL_SPELL_PROC, sizeof(SpellProc) }
+    };
+
+    const uint32_t poolSoakObjectCount = sizeof(poolSoakObjects) / sizeof(poolSoakObjects[0]);
+}
+
+bool MapBenchmarkSuite::_benchmarkPool()
+{
+    const uint32_t liveObjects = 20000;
+    const uint32_t iterations = 2000000;
+
+    // RSS when a side starts and right before it frees its live objects
+    unsigned long long rss[2][2] = { { 0, 0 }, { 0, 0 } };
+
+    std::vector<void*> referenceObjects(liveObjects, nullptr);
+    std::vector<const PoolSoakObject*> referenceKinds(liveObjects, nullptr);
+    std::vector<void*> currentObjects(liveObjects, nullptr);
+
+    const uint64_t reservedBefore = MapObjectPool::getReservedBytes();
+
+    const bool result = _compare("pool", "soak, 20000 live objects", iterations,
+        [&referenceObjects, &referenceKinds, &rss, iterations, liveObjects](uint32_t i) -> uint64_t
+        {
+            if (i == 0)
+                rss[0][0] = Arcemu::SysInfo::GetRAMUsage();
+
+            const uint32_t hash = poolSoakHash(i);
+            const uint32_t slot = hash % liveObjects;
+            const PoolSoakObject& object = poolSoakObjects[(hash >> 20) % poolSoakObjectCount];
+
+            if (referenceObjects[slot] != nullptr)
+                ::operator delete(referenceObjects[slot]);
+
+            // the constructors write the whole object
+            referenceObjects[slot] = ::operator new(object.size);
+            memset(referenceObjects[slot], 0, object.size);
+            referenceKinds[slot] = &object;
+
+            if (i == iterations - 1)
+            {
+                rss[0][1] = Arcemu::SysInfo::GetRAMUsage();
+                for (uint32_t j = 0; j < liveObjects; ++j)
+                    ::operator delete(referenceObjects[j]);
+            }
+
+            return object.size;
+        },
+        [&currentObjects, &rss, iterations, liveObjects](uint32_t i) -> uint64_t
+        {
+            if (i == 0)
+                rss[1][0] = Arcemu::SysInfo::GetRAMUsage();
+
+            const uint32_t hash = poolSoakHash(i);
+            const uint32_t slot = hash % liveObjects;
+            const PoolSoakObject& object = poolSoakObjects[(hash >> 20) % poolSoakObjectCount];
+
+            MapObjectPool::deallocate(currentObjects[slot]);
+
+            currentObjects[slot] = MapObjectPool::allocate(object.size, object.type);
+            memset(currentObjects[slot], 0, object.size);
+
+            if (i == iterations - 1)
+            {
+                rss[1][1] = Arcemu::SysInfo::GetRAMUsage();
+                for (uint32_t j = 0; j < liveObjects; ++j)
+                    MapObjectPool::deallocate(currentObjects[j]);
+            }
+
+            return object.size;
+        });
+
+    // the pool keeps its chunks, freed reference memory may be reused by them
+    LogNotice("TickBenchmark : pool       | RSS growth reference %lld kB, current %lld kB, pool reserved %llu kB more",
+        (static_cast<long long>(rss[0][1]) - static_cast<long long>(rss[0][0])) / 1024,
+        (static_cast<long long>(rss[1][1]) - static_cast<long long>(rss[1][0])) / 1024,
+        static_cast<unsigned long long>((MapObjectPool::getReservedBytes() - reservedBefore) / 1024));
+
+    return result;
+}
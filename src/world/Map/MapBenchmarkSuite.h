@@ -0,0 +1,86 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MapMgr;
+class Player;
+class Unit;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Micro benchmarks of the TickBenchmark, run on the objects of the benchmark map after
+/// the measured ticks and selected with its Suite setting.
+///
+/// A benchmark times the current code against a copy of the code it replaced (the
+/// reference) on the same inputs. Both sides return a checksum of their results, a
+/// benchmark fails if the checksums differ, so a run also shows whether an index or
+/// cache went out of sync with what it replaces.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapBenchmarkSuite
+{
+    public:
+
+        MapBenchmarkSuite(MapMgr* mapMgr, const std::vector<Player*>& players);
+
+        /// runs the space separated benchmarks, "all" runs every benchmark
+        bool run(const std::string& names);
+
+    private:
+
+        typedef bool (MapBenchmarkSuite::*Benchmark)();
+
+        struct Entry
+        {
+            const char* name;
+            Benchmark benchmark;
+        };
+
+        static const Entry s_benchmarks[];
+
+        /// nanoseconds per call of function, which returns a checksum of its result
+        template <typename Function>
+        static double _measure(uint32_t iterations, uint64_t& checksum, Function function)
+        {
+            checksum = 0;
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+                checksum += function(i);
+
+            const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / static_cast<double>(iterations);
+        }
+
+        /// times reference and current over the same iterations and prints both
+        template <typename Reference, typename Current>
+        bool _compare(const char* benchmark, const std::string& name, uint32_t iterations, Reference reference, Current current)
+        {
+            uint64_t referenceChecksum;
+            uint64_t currentChecksum;
+            const double referenceTime = _measure(iterations, referenceChecksum, reference);
+            const double currentTime = _measure(iterations, currentChecksum, current);
+
+            return _report(benchmark, name, referenceTime, currentTime, referenceChecksum == currentChecksum);
+        }
+
+        bool _report(const char* benchmark, const std::string& name, double referenceTime, double currentTime, bool sameResult);
+
+        /// the first player of the fixture, otherwise the first active creature
+        Unit* _getTestUnit() const;
+
+        bool _benchmarkAuras();
+        bool _benchmarkAoe();
+        bool _benchmarkPool();
+
+        MapMgr* m_mapMgr;
+        std::vector<Player*> m_players;
+};
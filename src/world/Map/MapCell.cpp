@@ -53,6 +53,7 @@ void MapCell::Init(uint32 x, uint32 y, MapMgr* mapmgr)
     _y = static_cast<uint16>(y);
     _unloadpending = false;
     _objects.clear();
+    _units.clear();
     objects_iterator = _objects.begin();
 }
 
@@ -67,6 +68,9 @@ void MapCell::AddObject(Object* obj)
             CancelPendingUnload();
     }
 
+    if (obj->IsUnit())
+        _units.push_back(static_cast<Unit*>(obj));
+
     _objects.insert(obj);
 }
 
@@ -80,6 +84,16 @@ void MapCell::RemoveObject(Object* obj)
     if (objects_iterator != _objects.end() && (*objects_iterator) == obj)
         ++objects_iterator;
 
+    if (obj->IsUnit())
+    {
+        std::vector<Unit*>::iterator itr = std::find(_units.begin(), _units.end(), static_cast<Unit*>(obj));
+        if (itr != _units.end())
+        {
+            *itr = _units.back();
+            _units.pop_back();
+        }
+    }
+
     _objects.erase(obj);
 }
 
@@ -111,12 +125,12 @@ void MapCell::SetActivity(bool state)
 
             m_cellloadLock.Acquire();
             if (m_celltilesLoaded[mapId][tileX][tileY] == 0)
-            {
                 mgr->loadMap(vmapPath.c_str(), mapId, tileX, tileY);
-                mmgr->loadMap(mmapPath.c_str(), mapId, tileX, tileY);
-            }
             ++m_celltilesLoaded[mapId][tileX][tileY];
             m_cellloadLock.Release();
+
+            // navmesh tiles are shared by all instances and reference counted by MMapManager itself
+            mmgr->loadMap(mmapPath.c_str(), mapId, tileX, tileY);
         }
     }
     else if (_active && !state)
@@ -137,12 +151,11 @@ void MapCell::SetActivity(bool state)
             MMAP::MMapManager* mmgr = MMAP::MMapFactory::createOrGetMMapManager();
             m_cellloadLock.Acquire();
             if (!(--m_celltilesLoaded[mapId][tileX][tileY]))
-            {
                 mgr->unloadMap(mapId, tileX, tileY);
-                mmgr->unloadMap(mapId, tileX, tileY);
-            }
 
             m_cellloadLock.Release();
+
+            mmgr->unloadMap(mapId, tileX, tileY);
         }
     }
 
@@ -201,6 +214,7 @@ void MapCell::RemoveObjects()
         delete obj;
     }
     _objects.clear();
+    _units.clear();
     _corpses.clear();
     _playerCount = 0;
     _loaded = false;
@@ -24,6 +24,7 @@
 #include "Map/Map.h"
 class Object;
 class Map;
+class Unit;
 
 #define MAP_CELL_DEFAULT_UNLOAD_TIME 300
 #define MAKE_CELL_EVENT(x, y) (((x) * 1000) + 200 + y)
@@ -49,6 +50,7 @@ class SERVER_DECL MapCell
         bool HasObject(Object* obj) { return (_objects.find(obj) != _objects.end()); }
         bool HasPlayers() { return ((_playerCount > 0) ? true : false); }
         inline size_t GetObjectCount() { return _objects.size(); }
+        inline size_t GetUnitCount() { return _units.size(); }
         void RemoveObjects();
         inline ObjectSet::iterator Begin() { return _objects.begin(); }
         inline ObjectSet::iterator End() { return _objects.end(); }
@@ -84,6 +86,10 @@ class SERVER_DECL MapCell
         uint16 _x;
         uint16 _y;
         ObjectSet _objects;
+
+        /// Units of _objects kept contiguous for MapMgr's spatial queries (unordered, swap-removed)
+        std::vector<Unit*> _units;
+
         bool _active;
         bool _loaded;
         bool _unloadpending;
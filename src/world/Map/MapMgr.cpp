@@ -40,6 +40,7 @@
 #include "Storage/MySQLDataStore.hpp"
 #include "MapMgr.h"
 #include "MapScriptInterface.h"
+#include "MapTickBenchmark.h"
 #include "WorldCreatorDefines.hpp"
 #include "WorldCreator.h"
 
@@ -47,13 +48,15 @@
 Arcemu::Utility::TLSObject<MapMgr*> t_currentMapContext;
 
 #define MAP_MGR_UPDATE_PERIOD 100
+#define MAP_MGR_IDLE_UPDATE_PERIOD 500      // _PerformObjectDuties caps its diff at 500ms
 #define MAPMGR_INACTIVE_MOVE_TIME 30
 
 #define Z_SEARCH_RANGE 2
 
 extern bool bServerShutdown;
 
-MapMgr::MapMgr(Map* map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>(map), _mapId(mapId), eventHolder(instanceid), worldstateshandler(mapId)
+MapMgr::MapMgr(Map* map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>(map), _mapId(mapId), eventHolder(instanceid), worldstateshandler(mapId),
+    m_scheduledTickInterval(MAP_MGR_UPDATE_PERIOD), m_phaseProfile(MAP_TICK_PHASE_COUNT), m_opcodeProfile(NUM_MSG_TYPES)
 {
     _terrain = new TerrainHolder(mapId);
     _shutdown = false;
@@ -80,6 +83,8 @@ MapMgr::MapMgr(Map* map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>
     forced_expire = false;
     InactiveMoveTime = 0;
     mLoopCounter = 0;
+    m_fixedTickDiff = 0;
+    m_phaseTimes = nullptr;
     pInstance = nullptr;
     thread_kill_only = false;
     thread_running = false;
@@ -111,6 +116,9 @@ MapMgr::MapMgr(Map* map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>
 
 MapMgr::~MapMgr()
 {
+    if (MapTickScheduler::getSingletonPtr() != nullptr)
+        sMapTickScheduler.removeMap(this);
+
     _shutdown = true;
     sEventMgr.RemoveEvents(this);
     if (ScriptInterface != NULL)
@@ -189,8 +197,6 @@ MapMgr::~MapMgr()
         m_battleground = NULL;
     }
 
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(GetMapId(), m_instanceID);
-
     LogDebugFlag(LF_MAP, "MapMgr : Instance %u shut down. (%s)", m_instanceID, GetBaseMap()->GetMapName().c_str());
 }
 
@@ -840,8 +846,27 @@ float MapMgr::GetUpdateDistance(Object* curObj, Object* obj, Player* plObj)
         return m_UpdateDistance;                  // normal distance
 }
 
+void MapMgr::_UpdateDirtyStats()
+{
+    std::vector<uint64> dirty_units;
+
+    m_updateMutex.Acquire();
+    dirty_units.swap(m_dirtyStatUnits);
+    m_updateMutex.Release();
+
+    // units which left the map in between were recalculated by Unit::RemoveFromWorld
+    for (std::vector<uint64>::iterator itr = dirty_units.begin(); itr != dirty_units.end(); ++itr)
+    {
+        Unit* unit = GetUnit(*itr);
+        if (unit != nullptr)
+            unit->updateDirtyStats();
+    }
+}
+
 void MapMgr::_UpdateObjects()
 {
+    _UpdateDirtyStats();
+
     if (!_updates.size() && !_processQueue.size())
         return;
 
@@ -1132,6 +1157,13 @@ void MapMgr::ObjectUpdated(Object* obj)
     m_updateMutex.Release();
 }
 
+void MapMgr::MarkUnitStatsDirty(Unit* unit)
+{
+    m_updateMutex.Acquire();
+    m_dirtyStatUnits.push_back(unit->GetGUID());
+    m_updateMutex.Release();
+}
+
 void MapMgr::PushToProcessed(Player* plr)
 {
     _processQueue.insert(plr);
@@ -1199,30 +1231,67 @@ void MapMgr::ChangeFarsightLocation(Player* plr, DynamicObject* farsight)
     }
 }
 
-bool MapMgr::run()
+bool MapMgr::Tick()
 {
     bool rv = true;
 
     THREAD_TRY_EXECUTION
-        rv = Do();
+        rv = _Tick();
     THREAD_HANDLE_CRASH
 
         return rv;
 }
 
-bool MapMgr::Do()
+uint32 MapMgr::GetTickInterval()
+{
+    // empty maps only have to keep their events, respawns and forced cells going
+    if (HasPlayers() || m_battleground != nullptr || !m_forcedcells.empty() || GetThreadState() == THREADSTATE_TERMINATE)
+        return MAP_MGR_UPDATE_PERIOD;
+
+    return MAP_MGR_IDLE_UPDATE_PERIOD;
+}
+
+bool MapMgr::_Tick()
 {
 #ifdef WIN32
     threadid = GetCurrentThreadId();
 #endif
 
-    t_currentMapContext.set(this);
+    if (GetThreadState() == THREADSTATE_AWAITING)
+        _StartTicking();
 
-    thread_running = true;
-    ThreadState.SetVal(THREADSTATE_BUSY);
-    SetThreadName("Map mgr - M%u|I%u", this->_mapId, this->m_instanceID);
+    // Check if we have to die :P
+    if ((GetThreadState() == THREADSTATE_TERMINATE) || _shutdown || (InactiveMoveTime && UNIXTIME >= InactiveMoveTime))
+        return _FinishTicking();
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    //first push to world new objects
+    m_objectinsertlock.Acquire();
 
-    uint32 last_exec = getMSTime();
+    if (m_objectinsertpool.size())
+    {
+        for (ObjectSet::iterator i = m_objectinsertpool.begin(); i != m_objectinsertpool.end(); ++i)
+        {
+            Object* o = *i;
+
+            o->PushToWorld(this);
+        }
+
+        m_objectinsertpool.clear();
+    }
+
+    m_objectinsertlock.Release();
+    //////////////////////////////////////////////////////////////////////////////////////////
+
+    //Now update sessions of this map + objects
+    _PerformObjectDuties();
+
+    return true;
+}
+
+void MapMgr::_StartTicking()
+{
+    ThreadState.SetVal(THREADSTATE_BUSY);
 
     // Create Instance script
     LoadInstanceScript();
@@ -1249,50 +1318,10 @@ bool MapMgr::Do()
     objmgr.LoadCorpses(this);
     worldstateshandler.InitWorldStates(objmgr.GetWorldStatesForMap(_mapId));
     worldstateshandler.setObserver(this);
+}
 
-    // always declare local variables outside of the loop!
-    // otherwise there's a lot of sub esp; going on.
-
-    uint32 exec_time, exec_start;
-
-    while ((GetThreadState() != THREADSTATE_TERMINATE) && !_shutdown)
-    {
-        exec_start = getMSTime();
-
-        //////////////////////////////////////////////////////////////////////////////////////////
-        //first push to world new objects
-        m_objectinsertlock.Acquire();
-
-        if (m_objectinsertpool.size())
-        {
-            for (ObjectSet::iterator i = m_objectinsertpool.begin(); i != m_objectinsertpool.end(); ++i)
-            {
-                Object* o = *i;
-
-                o->PushToWorld(this);
-            }
-
-            m_objectinsertpool.clear();
-        }
-
-        m_objectinsertlock.Release();
-        //////////////////////////////////////////////////////////////////////////////////////////
-
-        //Now update sessions of this map + objects
-        _PerformObjectDuties();
-
-        last_exec = getMSTime();
-        exec_time = last_exec - exec_start;
-        if (exec_time < MAP_MGR_UPDATE_PERIOD)
-        {
-            Arcemu::Sleep(MAP_MGR_UPDATE_PERIOD - exec_time);
-        }
-
-        // Check if we have to die :P
-        if (InactiveMoveTime && UNIXTIME >= InactiveMoveTime)
-            break;
-    }
-
+bool MapMgr::_FinishTicking()
+{
     // Teleport any left-over players out.
     TeleportPlayers();
 
@@ -1330,7 +1359,7 @@ bool MapMgr::Do()
     // delete ourselves
     delete this;
 
-    // already deleted, so the threadpool doesn't have to.
+    // already deleted, so the scheduler doesn't have to.
     return false;
 }
 
@@ -1431,7 +1460,9 @@ void MapMgr::_PerformObjectDuties()
 {
     ++mLoopCounter;
 
-    uint32 mstime = getMSTime();
+    MapTickPhaseClock phaseClock(m_phaseTimes, &m_phaseProfile);
+
+    uint32 mstime = m_fixedTickDiff != 0 ? lastUnitUpdate + m_fixedTickDiff : getMSTime();
     uint32 difftime = mstime - lastUnitUpdate;
 
     if (difftime > 500)
@@ -1440,6 +1471,7 @@ void MapMgr::_PerformObjectDuties()
     // Update any events.
     // we make update of events before objects so in case there are 0 timediff events they do not get deleted after update but on next server update loop
     eventHolder.Update(difftime);
+    phaseClock.finish(MAP_TICK_PHASE_EVENTS);
 
     // Update creatures.
     {
@@ -1457,6 +1489,7 @@ void MapMgr::_PerformObjectDuties()
             ptr2->Update(difftime);
         }
     }
+    phaseClock.finish(MAP_TICK_PHASE_CREATURES);
 
     // Update players.
     {
@@ -1469,6 +1502,7 @@ void MapMgr::_PerformObjectDuties()
 
         lastUnitUpdate = mstime;
     }
+    phaseClock.finish(MAP_TICK_PHASE_PLAYERS);
 
     // Dynamic objects
     // We take the pointer, increment, and update in this order because during the update the DynamicObject might get deleted,
@@ -1482,6 +1516,7 @@ void MapMgr::_PerformObjectDuties()
             o->UpdateTargets();
         }
     }
+    phaseClock.finish(MAP_TICK_PHASE_DYNAMIC_OBJECTS);
 
     // Update gameobjects (not on every loop, however)
     if (mLoopCounter % 2)
@@ -1498,6 +1533,7 @@ void MapMgr::_PerformObjectDuties()
 
         lastGameobjectUpdate = mstime;
     }
+    phaseClock.finish(MAP_TICK_PHASE_GAMEOBJECTS);
 
     // Sessions are updated every loop.
     {
@@ -1535,9 +1571,11 @@ void MapMgr::_PerformObjectDuties()
             }
         }
     }
+    phaseClock.finish(MAP_TICK_PHASE_SESSIONS);
 
     // Finally, A9 Building/Distribution
     _UpdateObjects();
+    phaseClock.finish(MAP_TICK_PHASE_UPDATE_OBJECTS);
 }
 
 void MapMgr::EventCorpseDespawn(uint64 guid)
@@ -1973,6 +2011,97 @@ GameObject* MapMgr::FindNearestGoWithType(Object* o, uint32 type)
     return go;
 }
 
+void MapMgr::_GetCellRangeInRadius(float x, float y, float radius, uint32 & startX, uint32 & endX, uint32 & startY, uint32 & endY)
+{
+    // cell indices grow while the coordinates shrink (see CellHandler::GetPosX)
+    startX = GetPosX(std::min(x + radius, _maxX));
+    endX = std::min(GetPosX(std::max(x - radius, _minX)), static_cast<uint32>(_sizeX - 1));
+    startY = GetPosY(std::min(y + radius, _maxY));
+    endY = std::min(GetPosY(std::max(y - radius, _minY)), static_cast<uint32>(_sizeY - 1));
+}
+
+void MapMgr::ForEachUnitInRadius(float x, float y, float z, float radius, const std::function<bool(Unit*)>& filter)
+{
+    if (!(radius >= 0.0f))
+        return;
+
+    uint32 startX, endX, startY, endY;
+    _GetCellRangeInRadius(x, y, radius, startX, endX, startY, endY);
+
+    const float radiusSq = radius * radius;
+
+    for (uint32 posX = startX; posX <= endX; ++posX)
+    {
+        for (uint32 posY = startY; posY <= endY; ++posY)
+        {
+            MapCell* cell = GetCell(posX, posY);
+            if (cell == nullptr)
+                continue;
+
+            // index based, the filter may add or remove units of this cell
+            std::vector<Unit*>& units = cell->_units;
+            for (size_t i = 0; i < units.size();)
+            {
+                Unit* unit = units[i];
+
+                const float dx = unit->GetPositionX() - x;
+                const float dy = unit->GetPositionY() - y;
+                const float dz = unit->GetPositionZ() - z;
+
+                if (dx * dx + dy * dy + dz * dz > radiusSq)
+                {
+                    ++i;
+                    continue;
+                }
+
+                if (!filter(unit))
+                    return;
+
+                // a removed unit is swapped with the last one, which is visited at the same index
+                if (i < units.size() && units[i] == unit)
+                    ++i;
+            }
+        }
+    }
+}
+
+void MapMgr::ForEachObjectInRadius(float x, float y, float z, float radius, const std::function<bool(Object*)>& filter)
+{
+    if (!(radius >= 0.0f))
+        return;
+
+    uint32 startX, endX, startY, endY;
+    _GetCellRangeInRadius(x, y, radius, startX, endX, startY, endY);
+
+    const float radiusSq = radius * radius;
+
+    for (uint32 posX = startX; posX <= endX; ++posX)
+    {
+        for (uint32 posY = startY; posY <= endY; ++posY)
+        {
+            MapCell* cell = GetCell(posX, posY);
+            if (cell == nullptr)
+                continue;
+
+            for (MapCell::ObjectSet::iterator itr = cell->Begin(); itr != cell->End();)
+            {
+                Object* object = *itr;
+                ++itr;
+
+                const float dx = object->GetPositionX() - x;
+                const float dy = object->GetPositionY() - y;
+                const float dz = object->GetPositionZ() - z;
+
+                if (dx * dx + dy * dy + dz * dz > radiusSq)
+                    continue;
+
+                if (!filter(object))
+                    return;
+            }
+        }
+    }
+}
+
 void MapMgr::SendPvPCaptureMessage(int32 ZoneMask, uint32 ZoneId, const char* Message, ...)
 {
     va_list ap;
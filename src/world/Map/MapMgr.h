@@ -31,6 +31,11 @@
 #include "Units/Summons/SummonDefines.hpp"
 #include "Objects/CObjectFactory.h"
 #include "Server/EventableObject.h"
+#include "MapTickScheduler.h"
+#include "MapObjectPool.h"
+#include "TickProfiler.hpp"
+
+#include <functional>
 
 namespace Arcemu
 {
@@ -59,6 +64,7 @@ class InstanceScript;
 class Summon;
 class DynamicObject;
 class Unit;
+class MapTickPhaseTimes;
 
 extern Arcemu::Utility::TLSObject<MapMgr*> t_currentMapContext;
 
@@ -78,6 +84,7 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 {
     friend class MapCell;
     friend class MapScriptInterface;
+    friend class MapTickBenchmark;
 
     public:
 
@@ -160,8 +167,29 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 		Unit* GetUnit(const uint64 & guid);
 		Object* _GetObject(const uint64 & guid);
 
-		bool run();
-		bool Do();
+		/// Runs one update of this map, called by MapTickScheduler. Returns false once the map
+		/// finished (it deleted itself unless thread_kill_only is set).
+		bool Tick();
+
+		/// Delay between two ticks in ms, maps without players back off. Reads the player
+		/// and cell containers, so only the tick of the map itself may call it.
+		uint32 GetTickInterval();
+
+		/// GetTickInterval of the last tick, stored by MapTickScheduler for other threads
+		MapTickInterval m_scheduledTickInterval;
+
+		MapTickHistogram m_tickDuration;
+		MapTickHistogram m_tickLateness;
+
+		/// MapObjectPool allocations done by the ticks of this map
+		MapPoolStats m_poolStats;
+
+		/// create blocks built for the players of this map
+		CreateBlockCacheStats m_createCacheStats;
+
+		/// TickProfiler counters of the MapTickPhase and of the opcodes handled by the sessions of this map
+		ProfileCounterTable m_phaseProfile;
+		ProfileCounterTable m_opcodeProfile;
 
 		MapMgr(Map* map, uint32 mapid, uint32 instanceid);
 		~MapMgr();
@@ -174,6 +202,9 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 
 		/// Mark object as updated
 		void ObjectUpdated(Object* obj);
+
+		/// Recalculate the stats of the unit before the next update blocks are built
+		void MarkUnitStatsDirty(Unit* unit);
 		void UpdateCellActivity(uint32 x, uint32 y, uint32 radius);
 
 		// Terrain Functions
@@ -218,6 +249,12 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 		uint32 mLoopCounter;
 		uint32 lastGameobjectUpdate;
 		uint32 lastUnitUpdate;
+
+		/// Every tick advances the map clock by this many ms instead of the real time passed, 0 uses the real time
+		uint32 m_fixedTickDiff;
+
+		/// Time spent in each phase of _PerformObjectDuties is added here if set (see MapTickBenchmark)
+		MapTickPhaseTimes* m_phaseTimes;
 		void EventCorpseDespawn(uint64 guid);
 
 		time_t InactiveMoveTime;
@@ -250,8 +287,22 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
         //////////////////////////////////////////////////////////////////////////////////////////
         GameObject* FindNearestGoWithType(Object* o, uint32 type);
 
+        //////////////////////////////////////////////////////////////////////////////////////////
+        /// Spatial queries on the cell grid. Only the cells overlapping the bounding box of the
+        /// sphere are visited and every candidate is tested with a squared 3d distance, so the cost
+        /// no longer depends on how crowded the caller's inrange set is.
+        /// \param    float x, y, z - Center of the query
+        /// \param    float radius - Radius of the query (not squared)
+        /// \param    filter - Called for each hit; return false to stop the query
+        //////////////////////////////////////////////////////////////////////////////////////////
+        void ForEachUnitInRadius(float x, float y, float z, float radius, const std::function<bool(Unit*)>& filter);
+        void ForEachObjectInRadius(float x, float y, float z, float radius, const std::function<bool(Object*)>& filter);
+
 	protected:
 
+		/// Recalculate the stats marked by Unit::markStatsDirty
+		void _UpdateDirtyStats();
+
 		/// Collect and send updates to clients
 		void _UpdateObjects();
 
@@ -261,7 +312,12 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 		uint32 _mapId;
 		std::set<Object*> _mapWideStaticObjects;
 
+		bool _Tick();
+		void _StartTicking();
+		bool _FinishTicking();
+
 		bool _CellActive(uint32 x, uint32 y);
+		void _GetCellRangeInRadius(float x, float y, float radius, uint32 & startX, uint32 & endX, uint32 & startY, uint32 & endY);
 		void UpdateInRangeSet(Object* obj, Player* plObj, MapCell* cell, ByteBuffer** buf);
 
         //Zyres: Refactoring 05/04/2016
@@ -279,6 +335,7 @@ class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,
 		Mutex m_updateMutex;
 		UpdateQueue _updates;
 		PUpdateQueue _processQueue;
+		std::vector<uint64> m_dirtyStatUnits;
 
 		// Sessions
 		std::set<WorldSession*> Sessions;
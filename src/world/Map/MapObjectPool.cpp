@@ -0,0 +1,290 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "MapObjectPool.h"
+#include "MapMgr.h"
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace
+{
+    const size_t poolGranularity = 16;
+    const size_t poolMaxBlockSize = 2048;
+    const size_t poolSizeClasses = poolMaxBlockSize / poolGranularity;
+    const size_t poolChunkSize = 64 * 1024;
+    const uint32_t poolUnpooledClass = 0xFFFFFFFF;
+
+    struct PoolCache;
+
+    // in front of every block, stays valid while the block sits in a free list
+    struct alignas(16) BlockHeader
+    {
+        PoolCache* owner;
+        uint32_t sizeClass;
+        uint32_t type;
+    };
+
+    static_assert(sizeof(BlockHeader) == 16, "BlockHeader has to keep the 16 byte alignment of the blocks");
+
+    // free blocks are linked through their (unused) object memory
+    struct FreeBlock
+    {
+        BlockHeader* next;
+    };
+
+    FreeBlock* getFreeBlock(BlockHeader* header)
+    {
+        return reinterpret_cast<FreeBlock*>(header + 1);
+    }
+
+    struct PoolCache
+    {
+        PoolCache() : remoteFrees(nullptr), orphaned(false), chunkCursor(nullptr), chunkRemaining(0)
+        {
+            for (size_t i = 0; i < poolSizeClasses; ++i)
+                freeLists[i] = nullptr;
+        }
+
+        // owner thread only
+        BlockHeader* freeLists[poolSizeClasses];
+        char* chunkCursor;
+        size_t chunkRemaining;
+
+        // pushed by every other thread, taken as a whole by the owner
+        std::atomic<BlockHeader*> remoteFrees;
+        std::atomic<bool> orphaned;
+    };
+
+    std::mutex s_cacheLock;
+    std::vector<PoolCache*> s_caches;
+
+    std::atomic<uint64_t> s_liveCount[MAP_POOL_TYPE_COUNT];
+    std::atomic<uint64_t> s_reservedBytes(0);
+    MapPoolStats s_unmappedStats;
+
+    thread_local PoolCache* t_cache = nullptr;
+
+    struct PoolCacheReleaser
+    {
+        ~PoolCacheReleaser()
+        {
+            // blocks freed by this thread from now on take the remote path
+            PoolCache* cache = t_cache;
+            t_cache = nullptr;
+
+            if (cache != nullptr)
+                cache->orphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local PoolCacheReleaser t_cacheReleaser;
+
+    PoolCache* getThreadCache()
+    {
+        if (t_cache != nullptr)
+            return t_cache;
+
+        // constructs the releaser of this thread
+        (void)&t_cacheReleaser;
+
+        std::lock_guard<std::mutex> guard(s_cacheLock);
+
+        for (std::vector<PoolCache*>::iterator itr = s_caches.begin(); itr != s_caches.end(); ++itr)
+        {
+            bool expected = true;
+            if ((*itr)->orphaned.compare_exchange_strong(expected, false, std::memory_order_acquire))
+            {
+                t_cache = *itr;
+                return t_cache;
+            }
+        }
+
+        t_cache = new PoolCache;
+        s_caches.push_back(t_cache);
+        return t_cache;
+    }
+
+    void drainRemoteFrees(PoolCache* cache)
+    {
+        BlockHeader* header = cache->remoteFrees.exchange(nullptr, std::memory_order_acquire);
+        while (header != nullptr)
+        {
+            BlockHeader* next = getFreeBlock(header)->next;
+
+            getFreeBlock(header)->next = cache->freeLists[header->sizeClass];
+            cache->freeLists[header->sizeClass] = header;
+
+            header = next;
+        }
+    }
+
+    BlockHeader* carveBlock(PoolCache* cache, uint32_t size_class)
+    {
+        const size_t block_size = (size_class + 1) * poolGranularity;
+        if (cache->chunkRemaining < block_size)
+        {
+            // the rest of the old chunk is left unused
+            cache->chunkCursor = static_cast<char*>(::operator new(poolChunkSize));
+            cache->chunkRemaining = poolChunkSize;
+            s_reservedBytes.fetch_add(poolChunkSize, std::memory_order_relaxed);
+        }
+
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(cache->chunkCursor);
+        cache->chunkCursor += block_size;
+        cache->chunkRemaining -= block_size;
+
+        header->owner = cache;
+        header->sizeClass = size_class;
+        return header;
+    }
+
+    MapPoolStats& getCurrentStats()
+    {
+        MapMgr* map_mgr = t_currentMapContext.get();
+        return map_mgr != nullptr ? map_mgr->m_poolStats : s_unmappedStats;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapPoolStats
+MapPoolStats::MapPoolStats()
+{
+    reset();
+}
+
+MapPoolStats& MapPoolStats::operator=(const MapPoolStats& other)
+{
+    for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+    {
+        m_allocations[i].store(other.getAllocations(MapPoolType(i)), std::memory_order_relaxed);
+        m_frees[i].store(other.getFrees(MapPoolType(i)), std::memory_order_relaxed);
+    }
+
+    m_resetTime.store(other.getResetTime(), std::memory_order_relaxed);
+    return *this;
+}
+
+void MapPoolStats::reset()
+{
+    for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+    {
+        m_allocations[i].store(0, std::memory_order_relaxed);
+        m_frees[i].store(0, std::memory_order_relaxed);
+    }
+
+    m_resetTime.store(getMSTime(), std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapObjectPool
+void* MapObjectPool::allocate(size_t size, MapPoolType type)
+{
+    getCurrentStats().addAllocation(type);
+    s_liveCount[type].fetch_add(1, std::memory_order_relaxed);
+
+    const size_t total_size = size + sizeof(BlockHeader);
+    if (total_size > poolMaxBlockSize)
+    {
+        BlockHeader* header = static_cast<BlockHeader*>(::operator new(total_size));
+        header->owner = nullptr;
+        header->sizeClass = poolUnpooledClass;
+        header->type = type;
+        return header + 1;
+    }
+
+    const uint32_t size_class = static_cast<uint32_t>((total_size + poolGranularity - 1) / poolGranularity - 1);
+    PoolCache* cache = getThreadCache();
+
+    BlockHeader* header = cache->freeLists[size_class];
+    if (header == nullptr)
+    {
+        drainRemoteFrees(cache);
+        header = cache->freeLists[size_class];
+    }
+
+    if (header != nullptr)
+        cache->freeLists[size_class] = getFreeBlock(header)->next;
+    else
+        header = carveBlock(cache, size_class);
+
+    header->type = type;
+    return header + 1;
+}
+
+void MapObjectPool::deallocate(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    const MapPoolType type = MapPoolType(header->type);
+
+    getCurrentStats().addFree(type);
+    s_liveCount[type].fetch_sub(1, std::memory_order_relaxed);
+
+    if (header->sizeClass == poolUnpooledClass)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    PoolCache* cache = header->owner;
+    if (cache == t_cache)
+    {
+        getFreeBlock(header)->next = cache->freeLists[header->sizeClass];
+        cache->freeLists[header->sizeClass] = header;
+        return;
+    }
+
+    // allocated by another thread, give it back to its owner
+    BlockHeader* head = cache->remoteFrees.load(std::memory_order_relaxed);
+    do
+    {
+        getFreeBlock(header)->next = head;
+    }
+    while (!cache->remoteFrees.compare_exchange_weak(head, header, std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint64_t MapObjectPool::getLiveCount(MapPoolType type)
+{
+    return s_liveCount[type].load(std::memory_order_relaxed);
+}
+
+uint64_t MapObjectPool::getReservedBytes()
+{
+    return s_reservedBytes.load(std::memory_order_relaxed);
+}
+
+uint32_t MapObjectPool::getCacheCount()
+{
+    std::lock_guard<std::mutex> guard(s_cacheLock);
+    return static_cast<uint32_t>(s_caches.size());
+}
+
+MapPoolStats& MapObjectPool::getUnmappedStats()
+{
+    return s_unmappedStats;
+}
+
+const char* MapObjectPool::getTypeName(MapPoolType type)
+{
+    switch (type)
+    {
+        case MAP_POOL_SPELL:
+            return "Spell";
+        case MAP_POOL_AURA:
+            return "Aura";
+        case MAP_POOL_SPELL_PROC:
+            return "SpellProc";
+        case MAP_POOL_TIMED_EVENT:
+            return "TimedEvent";
+        default:
+            return "Unknown";
+    }
+}
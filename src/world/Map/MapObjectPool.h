@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum MapPoolType
+{
+    MAP_POOL_SPELL          = 0,
+    MAP_POOL_AURA           = 1,
+    MAP_POOL_SPELL_PROC     = 2,
+    MAP_POOL_TIMED_EVENT    = 3,
+    MAP_POOL_TYPE_COUNT     = 4
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Allocations and frees per pool type done while a map was ticking (or outside of maps).
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapPoolStats
+{
+    public:
+
+        MapPoolStats();
+        MapPoolStats& operator=(const MapPoolStats& other);
+
+        void addAllocation(MapPoolType type) { m_allocations[type].fetch_add(1, std::memory_order_relaxed); }
+        void addFree(MapPoolType type) { m_frees[type].fetch_add(1, std::memory_order_relaxed); }
+
+        uint64_t getAllocations(MapPoolType type) const { return m_allocations[type].load(std::memory_order_relaxed); }
+        uint64_t getFrees(MapPoolType type) const { return m_frees[type].load(std::memory_order_relaxed); }
+
+        /// getMSTime of the last reset, used for the per second rates
+        uint32_t getResetTime() const { return m_resetTime.load(std::memory_order_relaxed); }
+
+        void reset();
+
+    private:
+
+        std::atomic<uint64_t> m_allocations[MAP_POOL_TYPE_COUNT];
+        std::atomic<uint64_t> m_frees[MAP_POOL_TYPE_COUNT];
+        std::atomic<uint32_t> m_resetTime;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Size class pool for the short living spell system objects.
+///
+/// Every thread (in practice every map tick worker) owns a cache of free lists carved from
+/// 64k chunks, so allocating and freeing on the owning thread takes no lock. A block freed
+/// by another thread, e.g. an aura of a unit which teleported to a map ticked elsewhere,
+/// is pushed lock-free onto the remote list of its owning cache and reused from there.
+/// Caches of finished threads are handed to the next new thread. Memory is never given
+/// back to the system, blocks above 2k go straight to operator new.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapObjectPool
+{
+    public:
+
+        static void* allocate(size_t size, MapPoolType type);
+        static void deallocate(void* ptr);
+
+        static uint64_t getLiveCount(MapPoolType type);
+        static uint64_t getReservedBytes();
+        static uint32_t getCacheCount();
+
+        /// allocations outside of a map tick
+        static MapPoolStats& getUnmappedStats();
+
+        static const char* getTypeName(MapPoolType type);
+};
+
+/// Routes new/delete of a class (and everything derived from it) through MapObjectPool
+#define MAP_POOLED_OBJECT(pool_type) \
+    static void* operator new(size_t size) { return MapObjectPool::allocate(size, pool_type); } \
+    static void operator delete(void* ptr) { MapObjectPool::deallocate(ptr); }
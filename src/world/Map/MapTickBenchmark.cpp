@@ -0,0 +1,658 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "MapTickBenchmark.h"
+#include "MapBenchmarkSuite.h"
+#include "Map.h"
+#include "MapMgr.h"
+#include "CellHandler.h"
+#include "TLSObject.h"
+#include "WorldCreator.h"
+#include "MersenneTwister.h"
+#include "Server/MainServerDefines.h"
+#include "Storage/MySQLDataStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    uint64_t mixDigest(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    uint32_t floatBits(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    bool parseHexBytes(const std::string& token, std::vector<uint8_t>& bytes)
+    {
+        if (token.size() % 2 != 0)
+            return false;
+
+        for (size_t i = 0; i < token.size(); i += 2)
+        {
+            char* end = nullptr;
+            const std::string byte = token.substr(i, 2);
+            const unsigned long value = strtoul(byte.c_str(), &end, 16);
+            if (end == nullptr || *end != '\0')
+                return false;
+
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+
+        return true;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapTickPhaseTimes
+//////////////////////////////////////////////////////////////////////////////////////////
+void MapTickPhaseTimes::add(MapTickPhase phase, uint64_t nanoseconds)
+{
+    m_total[phase] += nanoseconds;
+    if (nanoseconds > m_max[phase])
+        m_max[phase] = nanoseconds;
+}
+
+void MapTickPhaseTimes::reset()
+{
+    memset(m_total, 0, sizeof(m_total));
+    memset(m_max, 0, sizeof(m_max));
+}
+
+const char* MapTickPhaseTimes::getPhaseName(MapTickPhase phase)
+{
+    static const char* const names[MAP_TICK_PHASE_COUNT] =
+    {
+        "events",
+        "creatures",
+        "players",
+        "dynamic objects",
+        "gameobjects",
+        "sessions",
+        "update objects"
+    };
+
+    return names[phase];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapTickBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+MapTickBenchmark::MapTickBenchmark() : m_mapId(0), m_map(nullptr), m_mapMgr(nullptr), m_databaseSpawns(false)
+{
+}
+
+MapTickBenchmark::~MapTickBenchmark()
+{
+    // the spawns belong to the map once it was created
+    for (std::vector<CreatureSpawn*>::iterator itr = m_creatureSpawns.begin(); itr != m_creatureSpawns.end(); ++itr)
+        delete *itr;
+
+    for (std::vector<GameobjectSpawn*>::iterator itr = m_gameobjectSpawns.begin(); itr != m_gameobjectSpawns.end(); ++itr)
+        delete *itr;
+}
+
+bool MapTickBenchmark::run()
+{
+    const WorldConfig::TickBenchmarkSettings& settings = worldConfig.tickBenchmark;
+
+    m_mapId = settings.mapId;
+    MapInfo const* mapInfo = sMySQLStore.GetWorldMapInfo(m_mapId);
+    if (m_mapId >= NUM_MAPS || mapInfo == nullptr)
+    {
+        LOG_ERROR("TickBenchmark : Map %u has no worldmap_info row.", m_mapId);
+        return false;
+    }
+
+    // without fixture the map is benchmarked with its spawns from the database and no players
+    if (settings.fixture.empty())
+        m_databaseSpawns = true;
+    else if (!_loadFixture(settings.fixture))
+        return false;
+
+    const uint32_t tickDiff = std::max(1u, settings.tickDiff);
+
+    LogNotice("TickBenchmark : Map %u (%s), %u players, %u warmup and %u measured ticks of %ums, seed %u", m_mapId, mapInfo->name.c_str(),
+        static_cast<uint32_t>(m_players.size()), settings.warmupTicks, settings.ticks, tickDiff, settings.seed);
+
+    // from here on every random number only depends on the seed
+    SeedRandomNumberGenerators(settings.seed);
+
+    m_map = new Map(m_mapId, mapInfo, false);
+    if (m_databaseSpawns)
+        m_map->LoadSpawns(false);
+
+    for (std::vector<CreatureSpawn*>::iterator itr = m_creatureSpawns.begin(); itr != m_creatureSpawns.end(); ++itr)
+    {
+        CellSpawns* cellSpawns = m_map->GetSpawnsListAndCreate(CellHandler<MapMgr>::GetPosX((*itr)->x), CellHandler<MapMgr>::GetPosY((*itr)->y));
+        cellSpawns->CreatureSpawns.push_back(*itr);
+        ++m_map->CreatureSpawnCount;
+    }
+
+    for (std::vector<GameobjectSpawn*>::iterator itr = m_gameobjectSpawns.begin(); itr != m_gameobjectSpawns.end(); ++itr)
+    {
+        CellSpawns* cellSpawns = m_map->GetSpawnsListAndCreate(CellHandler<MapMgr>::GetPosX((*itr)->position_x), CellHandler<MapMgr>::GetPosY((*itr)->position_y));
+        cellSpawns->GameobjectSpawns.push_back(*itr);
+        ++m_map->GameObjectSpawnCount;
+    }
+
+    m_creatureSpawns.clear();
+    m_gameobjectSpawns.clear();
+
+    LogDetail("TickBenchmark : %u creature and %u gameobject spawns.", m_map->CreatureSpawnCount, m_map->GameObjectSpawnCount);
+
+    // not added to the MapTickScheduler, all ticks run on this thread
+    m_mapMgr = new MapMgr(m_map, m_mapId, sInstanceMgr.GenerateInstanceID());
+    m_mapMgr->m_fixedTickDiff = tickDiff;
+    m_mapMgr->lastUnitUpdate = 0;
+    m_mapMgr->lastGameobjectUpdate = 0;
+
+    t_currentMapContext.set(m_mapMgr);
+
+    // the first tick loads the static spawns and the instance script
+    _tick();
+
+    for (uint32_t i = 0; i < m_players.size(); ++i)
+    {
+        if (!_spawnPlayer(m_players[i], i))
+        {
+            t_currentMapContext.set(nullptr);
+            return false;
+        }
+    }
+
+    uint32_t tick = 0;
+    for (; tick < settings.warmupTicks; ++tick)
+    {
+        _queueReplayPackets(tick);
+        _tick();
+    }
+
+    MapTickPhaseTimes phaseTimes;
+    std::vector<uint64_t> tickTimes;
+    std::vector<uint64_t> profiledTickTimes;
+    tickTimes.reserve(settings.ticks);
+
+    const bool wasProfilerEnabled = TickProfiler::isEnabled();
+    if (!settings.profilerOverhead)
+        m_mapMgr->m_phaseTimes = &phaseTimes;
+
+    for (uint32_t i = 0; i < settings.ticks; ++i, ++tick)
+    {
+        _queueReplayPackets(tick);
+
+        // off, on, on, off, ... so work which is only done every other tick hits both halves
+        const bool profiled = settings.profilerOverhead && (i + 1) / 2 % 2 == 1;
+        if (settings.profilerOverhead)
+            TickProfiler::setEnabled(profiled);
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        _tick();
+        (profiled ? profiledTickTimes : tickTimes).push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    m_mapMgr->m_phaseTimes = nullptr;
+
+    if (settings.profilerOverhead)
+    {
+        TickProfiler::setEnabled(wasProfilerEnabled);
+        _printProfilerOverhead(tickTimes, profiledTickTimes);
+    }
+
+    _printReport(phaseTimes, tickTimes);
+
+    bool result = true;
+    if (!settings.suite.empty())
+    {
+        std::vector<Player*> players;
+        for (std::vector<FixturePlayer>::const_iterator itr = m_players.begin(); itr != m_players.end(); ++itr)
+            players.push_back(itr->player);
+
+        MapBenchmarkSuite suite(m_mapMgr, players);
+        result = suite.run(settings.suite);
+    }
+
+    t_currentMapContext.set(nullptr);
+    return result;
+}
+
+bool MapTickBenchmark::_loadFixture(const std::string& fileName)
+{
+    std::ifstream file(fileName.c_str());
+    if (!file)
+    {
+        LOG_ERROR("TickBenchmark : Can not open fixture %s.", fileName.c_str());
+        return false;
+    }
+
+    std::string line;
+    uint32_t lineNumber = 0;
+    uint32_t nextSpawnId = 1;
+
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+
+        std::istringstream stream(line);
+        std::string type;
+        if (!(stream >> type) || type[0] == '#')
+            continue;
+
+        if (type == "spawns")
+        {
+            std::string source;
+            stream >> source;
+            if (source != "database")
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: unknown spawn source '%s'.", fileName.c_str(), lineNumber, source.c_str());
+                return false;
+            }
+
+            m_databaseSpawns = true;
+        }
+        else if (type == "creature")
+        {
+            uint32_t entry;
+            float x, y, z, o;
+            if (!(stream >> entry >> x >> y >> z >> o))
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: expected creature <entry> <x> <y> <z> <o> [movetype] [spawn id].", fileName.c_str(), lineNumber);
+                return false;
+            }
+
+            CreatureProperties const* properties = sMySQLStore.GetCreatureProperties(entry);
+            if (properties == nullptr)
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: creature entry %u is not in creature_properties.", fileName.c_str(), lineNumber, entry);
+                return false;
+            }
+
+            uint32_t movetype = 0;
+            uint32_t spawnId = nextSpawnId;
+            stream >> movetype >> spawnId;
+
+            CreatureSpawn* spawn = new CreatureSpawn;
+            memset(spawn, 0, sizeof(CreatureSpawn));
+            spawn->id = spawnId;
+            spawn->entry = entry;
+            spawn->x = x;
+            spawn->y = y;
+            spawn->z = z;
+            spawn->o = o;
+            spawn->movetype = static_cast<uint8>(movetype);
+            spawn->displayid = properties->GetRandomModelId();
+            spawn->factionid = properties->Faction;
+            spawn->phase = 0xFFFFFFFF;
+
+            m_creatureSpawns.push_back(spawn);
+            ++nextSpawnId;
+        }
+        else if (type == "gameobject")
+        {
+            uint32_t entry;
+            float x, y, z, o;
+            if (!(stream >> entry >> x >> y >> z >> o))
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: expected gameobject <entry> <x> <y> <z> <o> [state].", fileName.c_str(), lineNumber);
+                return false;
+            }
+
+            if (sMySQLStore.GetGameObjectProperties(entry) == nullptr)
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: gameobject entry %u is not in gameobject_properties.", fileName.c_str(), lineNumber, entry);
+                return false;
+            }
+
+            uint32_t state = 1;
+            stream >> state;
+
+            GameobjectSpawn* spawn = new GameobjectSpawn;
+            memset(spawn, 0, sizeof(GameobjectSpawn));
+            spawn->id = nextSpawnId;
+            spawn->entry = entry;
+            spawn->map = m_mapId;
+            spawn->position_x = x;
+            spawn->position_y = y;
+            spawn->position_z = z;
+            spawn->orientation = o;
+            spawn->rotation_2 = sinf(o / 2.0f);
+            spawn->rotation_3 = cosf(o / 2.0f);
+            spawn->state = state;
+            spawn->scale = 1.0f;
+            spawn->phase = 0xFFFFFFFF;
+
+            m_gameobjectSpawns.push_back(spawn);
+            ++nextSpawnId;
+        }
+        else if (type == "player")
+        {
+            uint32_t race;
+            uint32_t playerClass;
+            FixturePlayer fixturePlayer;
+            if (!(stream >> race >> playerClass >> fixturePlayer.x >> fixturePlayer.y >> fixturePlayer.z >> fixturePlayer.o))
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: expected player <race> <class> <x> <y> <z> <o> [packet file].", fileName.c_str(), lineNumber);
+                return false;
+            }
+
+            fixturePlayer.race = static_cast<uint8_t>(race);
+            fixturePlayer.playerClass = static_cast<uint8_t>(playerClass);
+            fixturePlayer.player = nullptr;
+            fixturePlayer.session = nullptr;
+            fixturePlayer.nextPacket = 0;
+
+            std::string replayFile;
+            if (stream >> replayFile && !_loadReplay(replayFile, fixturePlayer))
+                return false;
+
+            m_players.push_back(fixturePlayer);
+        }
+        else
+        {
+            LOG_ERROR("TickBenchmark : %s:%u: unknown line type '%s'.", fileName.c_str(), lineNumber, type.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MapTickBenchmark::_loadReplay(const std::string& fileName, FixturePlayer& fixturePlayer)
+{
+    std::ifstream file(fileName.c_str());
+    if (!file)
+    {
+        LOG_ERROR("TickBenchmark : Can not open packet file %s.", fileName.c_str());
+        return false;
+    }
+
+    std::string line;
+    uint32_t lineNumber = 0;
+
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+
+        std::istringstream stream(line);
+        std::string tick;
+        std::string opcode;
+        if (!(stream >> tick) || tick[0] == '#')
+            continue;
+
+        ReplayPacket packet;
+        packet.tick = static_cast<uint32_t>(strtoul(tick.c_str(), nullptr, 10));
+
+        const unsigned long opcodeValue = (stream >> opcode) ? strtoul(opcode.c_str(), nullptr, 0) : NUM_MSG_TYPES;
+        if (opcodeValue >= NUM_MSG_TYPES)
+        {
+            LOG_ERROR("TickBenchmark : %s:%u: expected <tick> <opcode> [payload] with an opcode below %u.", fileName.c_str(), lineNumber, NUM_MSG_TYPES);
+            return false;
+        }
+
+        packet.opcode = static_cast<uint16_t>(opcodeValue);
+
+        std::string token;
+        while (stream >> token)
+        {
+            std::vector<uint8_t> bytes;
+            if (token != "{guid}" && token != "{packguid}" && !parseHexBytes(token, bytes))
+            {
+                LOG_ERROR("TickBenchmark : %s:%u: payload token '%s' is neither hex bytes, {guid} nor {packguid}.", fileName.c_str(), lineNumber, token.c_str());
+                return false;
+            }
+
+            packet.tokens.push_back(token);
+        }
+
+        fixturePlayer.packets.push_back(packet);
+    }
+
+    // the packets are queued in tick order
+    std::stable_sort(fixturePlayer.packets.begin(), fixturePlayer.packets.end(), [](const ReplayPacket& a, const ReplayPacket& b)
+    {
+        return a.tick < b.tick;
+    });
+
+    return true;
+}
+
+bool MapTickBenchmark::_spawnPlayer(FixturePlayer& fixturePlayer, uint32_t index)
+{
+    std::stringstream name;
+    name << "Tickbench" << char('a' + index % 26) << char('a' + index / 26 % 26);
+
+    // without socket the packets sent to the player are dropped
+    WorldSession* session = new WorldSession(index + 1, name.str(), nullptr);
+
+    Player* player = objmgr.CreatePlayer(fixturePlayer.playerClass);
+    player->SetSession(session);
+
+    WorldPacket data(CMSG_CHAR_CREATE, 32);
+    data << name.str();
+    data << fixturePlayer.race;
+    data << fixturePlayer.playerClass;
+    data << uint8(0);       // gender
+    data << uint8(0);       // skin
+    data << uint8(0);       // face
+    data << uint8(0);       // hair style
+    data << uint8(0);       // hair color
+    data << uint8(0);       // facial hair
+    data << uint8(0);       // outfit
+
+    if (!player->Create(data))
+    {
+        LOG_ERROR("TickBenchmark : Can not create a player of race %u and class %u.", fixturePlayer.race, fixturePlayer.playerClass);
+        player->ok_to_remove = true;
+        delete player;
+        delete session;
+        return false;
+    }
+
+    PlayerInfo* info = new PlayerInfo;
+    info->guid = player->GetLowGUID();
+    info->acct = session->GetAccountId();
+    info->name = strdup(player->GetName());
+    info->race = player->getRace();
+    info->gender = player->getGender();
+    info->cl = player->getClass();
+    info->team = player->GetTeam();
+    info->role = 0;
+    info->lastOnline = UNIXTIME;
+    info->lastZone = 0;
+    info->lastLevel = player->getLevel();
+    info->m_Group = nullptr;
+    info->subGroup = 0;
+    info->m_loggedInPlayer = player;
+    info->guild = nullptr;
+    info->guildRank = nullptr;
+    info->guildMember = nullptr;
+    player->m_playerInfo = info;
+
+    session->SetPlayer(player);
+    session->m_MoverWoWGuid.Init(player->GetGUID());
+    session->movement_packet[0] = session->m_MoverWoWGuid.GetNewGuidMask();
+    memcpy(&session->movement_packet[1], session->m_MoverWoWGuid.GetNewGuid(), session->m_MoverWoWGuid.GetNewGuidLen());
+
+    // synthetic players are never saved, neither to the character database nor to the realm
+    player->m_nextSave = 0xFFFFFFFF;
+    player->m_nextRealmSave = 0xFFFFFFFF;
+
+    player->SetMapId(m_mapId);
+    player->SetPosition(fixturePlayer.x, fixturePlayer.y, fixturePlayer.z, fixturePlayer.o, false);
+
+    // pushed by the next tick
+    player->AddToWorld(m_mapMgr);
+
+    fixturePlayer.player = player;
+    fixturePlayer.session = session;
+    return true;
+}
+
+void MapTickBenchmark::_queueReplayPackets(uint32_t tick)
+{
+    for (std::vector<FixturePlayer>::iterator itr = m_players.begin(); itr != m_players.end(); ++itr)
+    {
+        while (itr->nextPacket < itr->packets.size() && itr->packets[itr->nextPacket].tick <= tick)
+        {
+            itr->session->QueuePacket(_buildReplayPacket(itr->packets[itr->nextPacket], itr->player));
+            ++itr->nextPacket;
+        }
+    }
+}
+
+WorldPacket* MapTickBenchmark::_buildReplayPacket(const ReplayPacket& replay, Player* player)
+{
+    WorldPacket* packet = new WorldPacket(replay.opcode, 64);
+
+    for (std::vector<std::string>::const_iterator itr = replay.tokens.begin(); itr != replay.tokens.end(); ++itr)
+    {
+        if (*itr == "{guid}")
+        {
+            *packet << player->GetGUID();
+        }
+        else if (*itr == "{packguid}")
+        {
+            packet->appendPackGUID(player->GetGUID());
+        }
+        else
+        {
+            std::vector<uint8_t> bytes;
+            parseHexBytes(*itr, bytes);
+            packet->append(&bytes[0], bytes.size());
+        }
+    }
+
+    return packet;
+}
+
+void MapTickBenchmark::_tick()
+{
+    m_mapMgr->_Tick();
+
+    // a session without socket logs out after PLAYER_LOGOUT_DELAY
+    for (std::vector<FixturePlayer>::iterator itr = m_players.begin(); itr != m_players.end(); ++itr)
+    {
+        if (itr->session != nullptr)
+            itr->session->SetLogoutTimer(0);
+    }
+}
+
+uint64_t MapTickBenchmark::_getStateDigest() const
+{
+    // sets of pointers have no stable order, the digest adds up the hash of every unit
+    uint64_t digest = 0;
+
+    for (CreatureSet::const_iterator itr = m_mapMgr->activeCreatures.begin(); itr != m_mapMgr->activeCreatures.end(); ++itr)
+    {
+        const Creature* creature = *itr;
+        uint64_t hash = mixDigest(creature->GetGUID());
+        hash = mixDigest(hash ^ floatBits(creature->GetPositionX()));
+        hash = mixDigest(hash ^ floatBits(creature->GetPositionY()));
+        hash = mixDigest(hash ^ floatBits(creature->GetPositionZ()));
+        hash = mixDigest(hash ^ creature->GetUInt32Value(UNIT_FIELD_HEALTH));
+        digest += hash;
+    }
+
+    for (MapMgr::PlayerStorageMap::const_iterator itr = m_mapMgr->m_PlayerStorage.begin(); itr != m_mapMgr->m_PlayerStorage.end(); ++itr)
+    {
+        const Player* player = itr->second;
+        uint64_t hash = mixDigest(player->GetGUID());
+        hash = mixDigest(hash ^ floatBits(player->GetPositionX()));
+        hash = mixDigest(hash ^ floatBits(player->GetPositionY()));
+        hash = mixDigest(hash ^ floatBits(player->GetPositionZ()));
+        hash = mixDigest(hash ^ player->GetUInt32Value(UNIT_FIELD_HEALTH));
+        digest += hash;
+    }
+
+    return digest;
+}
+
+void MapTickBenchmark::_printReport(const MapTickPhaseTimes& phaseTimes, std::vector<uint64_t>& tickTimes) const
+{
+    if (tickTimes.empty())
+    {
+        LogNotice("TickBenchmark : No ticks measured.");
+        return;
+    }
+
+    std::sort(tickTimes.begin(), tickTimes.end());
+
+    uint64_t tickTotal = 0;
+    for (std::vector<uint64_t>::const_iterator itr = tickTimes.begin(); itr != tickTimes.end(); ++itr)
+        tickTotal += *itr;
+
+    uint64_t phaseTotal = 0;
+    for (uint8_t i = 0; i < MAP_TICK_PHASE_COUNT; ++i)
+        phaseTotal += phaseTimes.getTotal(static_cast<MapTickPhase>(i));
+
+    const size_t count = tickTimes.size();
+
+    LogNotice("TickBenchmark : %u active creatures, %u players, %u gameobjects, %u dynamic objects after %u ticks",
+        static_cast<uint32_t>(m_mapMgr->activeCreatures.size()), static_cast<uint32_t>(m_mapMgr->m_PlayerStorage.size()),
+        static_cast<uint32_t>(std::count_if(m_mapMgr->GOStorage.begin(), m_mapMgr->GOStorage.end(), [](GameObject* go) { return go != nullptr; })),
+        static_cast<uint32_t>(m_mapMgr->m_DynamicObjectStorage.size()), static_cast<uint32_t>(count));
+
+    // no phase times while the profiler overhead is measured
+    if (phaseTotal != 0)
+    {
+        LogNotice("TickBenchmark : phase           |  avg us/tick |   max us | share");
+        for (uint8_t i = 0; i < MAP_TICK_PHASE_COUNT; ++i)
+        {
+            const MapTickPhase phase = static_cast<MapTickPhase>(i);
+            LogNotice("TickBenchmark : %-15s | %12.2f | %8.1f | %4.1f%%", MapTickPhaseTimes::getPhaseName(phase),
+                phaseTimes.getTotal(phase) / 1000.0 / count, phaseTimes.getMax(phase) / 1000.0,
+                phaseTimes.getTotal(phase) * 100.0 / phaseTotal);
+        }
+    }
+
+    LogNotice("TickBenchmark : tick avg %.2fus, p50 %.2fus, p99 %.2fus, max %.2fus", tickTotal / 1000.0 / count,
+        tickTimes[count / 2] / 1000.0, tickTimes[std::min(count - 1, count * 99 / 100)] / 1000.0, tickTimes.back() / 1000.0);
+
+    // equal digests of two runs with the same fixture and seed mean the simulation took the same course
+    LogNotice("TickBenchmark : state digest %016llX", static_cast<unsigned long long>(_getStateDigest()));
+}
+
+void MapTickBenchmark::_printProfilerOverhead(std::vector<uint64_t> tickTimes, std::vector<uint64_t> profiledTickTimes) const
+{
+    if (tickTimes.empty() || profiledTickTimes.empty())
+    {
+        LogNotice("TickBenchmark : The profiler overhead needs at least 2 measured ticks.");
+        return;
+    }
+
+    std::sort(tickTimes.begin(), tickTimes.end());
+    std::sort(profiledTickTimes.begin(), profiledTickTimes.end());
+
+    uint64_t total = 0;
+    for (std::vector<uint64_t>::const_iterator itr = tickTimes.begin(); itr != tickTimes.end(); ++itr)
+        total += *itr;
+
+    uint64_t profiledTotal = 0;
+    for (std::vector<uint64_t>::const_iterator itr = profiledTickTimes.begin(); itr != profiledTickTimes.end(); ++itr)
+        profiledTotal += *itr;
+
+    const double average = static_cast<double>(total) / tickTimes.size();
+    const double profiledAverage = static_cast<double>(profiledTotal) / profiledTickTimes.size();
+    const double median = static_cast<double>(tickTimes[tickTimes.size() / 2]);
+    const double profiledMedian = static_cast<double>(profiledTickTimes[profiledTickTimes.size() / 2]);
+
+    LogNotice("TickBenchmark : profiler off %u ticks, avg %.2fus, p50 %.2fus | on %u ticks, avg %.2fus, p50 %.2fus | overhead avg %+.2f%%, p50 %+.2f%%",
+        static_cast<uint32_t>(tickTimes.size()), average / 1000.0, median / 1000.0,
+        static_cast<uint32_t>(profiledTickTimes.size()), profiledAverage / 1000.0, profiledMedian / 1000.0,
+        average > 0.0 ? (profiledAverage - average) * 100.0 / average : 0.0, median > 0.0 ? (profiledMedian - median) * 100.0 / median : 0.0);
+}
@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+#include "TickProfiler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Map;
+class MapMgr;
+struct CreatureSpawn;
+struct GameobjectSpawn;
+class Player;
+class WorldPacket;
+class WorldSession;
+
+enum MapTickPhase
+{
+    MAP_TICK_PHASE_EVENTS,
+    MAP_TICK_PHASE_CREATURES,
+    MAP_TICK_PHASE_PLAYERS,
+    MAP_TICK_PHASE_DYNAMIC_OBJECTS,
+    MAP_TICK_PHASE_GAMEOBJECTS,
+    MAP_TICK_PHASE_SESSIONS,
+    MAP_TICK_PHASE_UPDATE_OBJECTS,
+    MAP_TICK_PHASE_COUNT
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Nanoseconds spent in each phase of MapMgr::_PerformObjectDuties, summed over all
+/// measured ticks. Only written by the thread ticking the map.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapTickPhaseTimes
+{
+    public:
+
+        MapTickPhaseTimes() { reset(); }
+
+        void add(MapTickPhase phase, uint64_t nanoseconds);
+        void reset();
+
+        uint64_t getTotal(MapTickPhase phase) const { return m_total[phase]; }
+        uint64_t getMax(MapTickPhase phase) const { return m_max[phase]; }
+
+        static const char* getPhaseName(MapTickPhase phase);
+
+    private:
+
+        uint64_t m_total[MAP_TICK_PHASE_COUNT];
+        uint64_t m_max[MAP_TICK_PHASE_COUNT];
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Splits one tick into phases, each finish() charges the time since the previous one to
+/// the given phase. The phases also go to the profiler counters of the map while the
+/// profiler is enabled, and to the event ring of the thread while it traces. Does not read the clock at all
+/// without phase times or profiler.
+//////////////////////////////////////////////////////////////////////////////////////////
+class MapTickPhaseClock
+{
+    public:
+
+        MapTickPhaseClock(MapTickPhaseTimes* times, ProfileCounterTable* profile)
+            : m_times(times), m_profile(TickProfiler::isEnabled() ? profile : nullptr), m_last(0)
+        {
+            if (m_times != nullptr || m_profile != nullptr)
+                m_last = TickProfiler::getTime();
+        }
+
+        void finish(MapTickPhase phase)
+        {
+            if (m_times == nullptr && m_profile == nullptr)
+                return;
+
+            const uint64_t now = TickProfiler::getTime();
+            if (m_times != nullptr)
+                m_times->add(phase, now - m_last);
+
+            if (m_profile != nullptr)
+            {
+                m_profile->get(phase).add(now - m_last);
+                if (TickProfiler::isTracing())
+                    TickProfiler::record(MapTickPhaseTimes::getPhaseName(phase), PROFILE_CATEGORY_PHASE, phase, m_last, now);
+            }
+
+            m_last = now;
+        }
+
+    private:
+
+        MapTickPhaseTimes* m_times;
+        ProfileCounterTable* m_profile;
+        uint64_t m_last;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Micro benchmark of the map update, started instead of the world server when the
+/// TickBenchmark section of world.conf is enabled.
+///
+/// One MapMgr is created outside of the MapTickScheduler with the spawns and synthetic
+/// players of a fixture file and ticked on the calling thread. The map clock advances by
+/// a fixed diff per tick and the random number generators are seeded, so two runs of the
+/// same fixture simulate the same and only differ in the time they took. The players
+/// have sessions without a socket, their packet files are queued into the session at the
+/// recorded tick and handled by the sessions phase of the map. The micro benchmarks of the
+/// Suite setting (MapBenchmarkSuite) run on the map after the measured ticks.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapTickBenchmark
+{
+    public:
+
+        MapTickBenchmark();
+        ~MapTickBenchmark();
+
+        /// runs the benchmark configured in world.conf and prints the report
+        bool run();
+
+    private:
+
+        struct ReplayPacket
+        {
+            uint32_t tick;
+            uint16_t opcode;
+            std::vector<std::string> tokens;
+        };
+
+        struct FixturePlayer
+        {
+            uint8_t race;
+            uint8_t playerClass;
+            float x, y, z, o;
+            std::vector<ReplayPacket> packets;
+
+            Player* player;
+            WorldSession* session;
+            size_t nextPacket;
+        };
+
+        bool _loadFixture(const std::string& fileName);
+        bool _loadReplay(const std::string& fileName, FixturePlayer& fixturePlayer);
+        bool _spawnPlayer(FixturePlayer& fixturePlayer, uint32_t index);
+        void _queueReplayPackets(uint32_t tick);
+        WorldPacket* _buildReplayPacket(const ReplayPacket& replay, Player* player);
+
+        void _tick();
+        uint64_t _getStateDigest() const;
+        void _printReport(const MapTickPhaseTimes& phaseTimes, std::vector<uint64_t>& tickTimes) const;
+        void _printProfilerOverhead(std::vector<uint64_t> tickTimes, std::vector<uint64_t> profiledTickTimes) const;
+
+        uint32_t m_mapId;
+        Map* m_map;
+        MapMgr* m_mapMgr;
+
+        /// spawns of the fixture, moved into the map when it is created
+        bool m_databaseSpawns;
+        std::vector<CreatureSpawn*> m_creatureSpawns;
+        std::vector<GameobjectSpawn*> m_gameobjectSpawns;
+        std::vector<FixturePlayer> m_players;
+};
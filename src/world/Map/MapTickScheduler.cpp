@@ -0,0 +1,461 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "MapTickScheduler.h"
+#include "MapMgr.h"
+#include "CThreads.h"
+#include "TLSObject.h"
+
+#include <thread>
+
+initialiseSingleton(MapTickScheduler);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapTickHistogram
+MapTickHistogram::MapTickHistogram()
+{
+    reset();
+}
+
+MapTickHistogram& MapTickHistogram::operator=(const MapTickHistogram& other)
+{
+    for (uint8_t i = 0; i < bucketCount; ++i)
+        m_buckets[i].store(other.getBucket(i), std::memory_order_relaxed);
+
+    m_count.store(other.getCount(), std::memory_order_relaxed);
+    m_total.store(other.getTotal(), std::memory_order_relaxed);
+    m_max.store(other.getMax(), std::memory_order_relaxed);
+    return *this;
+}
+
+void MapTickHistogram::add(uint64_t microseconds)
+{
+    uint8_t bucket = 0;
+    while (bucket < bucketCount - 1 && microseconds >= getBucketLimit(bucket))
+        ++bucket;
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(microseconds, std::memory_order_relaxed);
+
+    uint64_t currentMax = m_max.load(std::memory_order_relaxed);
+    while (microseconds > currentMax && !m_max.compare_exchange_weak(currentMax, microseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MapTickHistogram::reset()
+{
+    for (uint8_t i = 0; i < bucketCount; ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t MapTickHistogram::getPercentile(uint32_t percent) const
+{
+    const uint64_t count = getCount();
+    if (count == 0)
+        return 0;
+
+    const uint64_t wanted = (count * percent + 99) / 100;
+
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < bucketCount - 1; ++i)
+    {
+        seen += getBucket(i);
+        if (seen >= wanted)
+            return getBucketLimit(i);
+    }
+
+    return getMax();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapTickWorker
+class MapTickWorker : public CThread
+{
+    public:
+
+        MapTickWorker(MapTickScheduler* scheduler, uint32_t index) : m_scheduler(scheduler), m_index(index) {}
+
+        bool run() override
+        {
+            return m_scheduler->_runWorker(m_index);
+        }
+
+        void OnShutdown() override
+        {
+            CThread::OnShutdown();
+            m_scheduler->shutdown();
+        }
+
+    private:
+
+        MapTickScheduler* m_scheduler;
+        uint32_t m_index;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MapTickScheduler
+namespace
+{
+    // names of the events recorded without a name in slow tick traces
+    std::string getProfileEventName(uint32_t category, uint32_t arg)
+    {
+        if (category == PROFILE_CATEGORY_OPCODE)
+            return getOpcodeName(arg);
+
+        return std::to_string(arg);
+    }
+}
+
+MapTickScheduler::MapTickScheduler() : m_readyTicks(0), m_scheduledMaps(0), m_runningWorkers(0), m_stopping(false), m_slowTickThreshold(0)
+{
+    TickProfiler::setEventNamer(getProfileEventName);
+}
+
+MapTickScheduler::~MapTickScheduler()
+{
+    shutdown();
+
+    while (m_runningWorkers.load() != 0)
+        Arcemu::Sleep(100);
+
+    for (std::vector<WorkerQueue*>::iterator itr = m_queues.begin(); itr != m_queues.end(); ++itr)
+        delete *itr;
+}
+
+void MapTickScheduler::startup(uint32_t workerCount)
+{
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    LogNotice("MapTickScheduler : Starting %u map update workers", workerCount);
+
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_queues.push_back(new WorkerQueue);
+
+    m_runningWorkers = workerCount;
+    for (uint32_t i = 0; i < workerCount; ++i)
+        ThreadPool.ExecuteTask(new MapTickWorker(this, i));
+}
+
+void MapTickScheduler::shutdown()
+{
+    if (m_stopping.exchange(true))
+        return;
+
+    // same as the ThreadPool did for every map thread before
+    {
+        std::lock_guard<std::mutex> guard(m_registryLock);
+        for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+            (*itr)->SetThreadState(THREADSTATE_TERMINATE);
+    }
+
+    // pull all pending ticks forward so the maps notice the terminate state right away
+    {
+        std::lock_guard<std::mutex> guard(m_timerLock);
+
+        std::vector<ScheduledTick> pending;
+        while (!m_timers.empty())
+        {
+            pending.push_back(m_timers.top());
+            m_timers.pop();
+        }
+
+        const Clock::time_point now = Clock::now();
+        for (std::vector<ScheduledTick>::iterator itr = pending.begin(); itr != pending.end(); ++itr)
+        {
+            itr->deadline = now;
+            m_timers.push(*itr);
+        }
+    }
+
+    m_timerCond.notify_all();
+}
+
+void MapTickScheduler::addMap(MapMgr* mapMgr)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_registryLock);
+        m_maps.insert(mapMgr);
+    }
+
+    // KillThread waits for this until the map finished its last tick
+    mapMgr->thread_running = true;
+
+    if (m_stopping)
+        mapMgr->SetThreadState(THREADSTATE_TERMINATE);
+
+    ++m_scheduledMaps;
+    _schedule(mapMgr, Clock::now());
+}
+
+void MapTickScheduler::removeMap(MapMgr* mapMgr)
+{
+    std::lock_guard<std::mutex> guard(m_registryLock);
+    m_maps.erase(mapMgr);
+}
+
+void MapTickScheduler::resetStats()
+{
+    std::lock_guard<std::mutex> guard(m_registryLock);
+    for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+    {
+        (*itr)->m_tickDuration.reset();
+        (*itr)->m_tickLateness.reset();
+    }
+}
+
+void MapTickScheduler::resetPoolStats()
+{
+    std::lock_guard<std::mutex> guard(m_registryLock);
+    for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+        (*itr)->m_poolStats.reset();
+}
+
+void MapTickScheduler::resetCreateCacheStats()
+{
+    std::lock_guard<std::mutex> guard(m_registryLock);
+    for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+        (*itr)->m_createCacheStats.reset();
+}
+
+void MapTickScheduler::resetProfileStats()
+{
+    std::lock_guard<std::mutex> guard(m_registryLock);
+    for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+    {
+        (*itr)->m_phaseProfile.reset();
+        (*itr)->m_opcodeProfile.reset();
+    }
+}
+
+void MapTickScheduler::setSlowTickTrace(uint32_t thresholdMs, const std::string& filePrefix)
+{
+    std::lock_guard<std::mutex> guard(m_traceLock);
+    m_traceFilePrefix = filePrefix;
+    setSlowTickThreshold(thresholdMs);
+}
+
+void MapTickScheduler::setSlowTickThreshold(uint32_t thresholdMs)
+{
+    m_slowTickThreshold.store(thresholdMs, std::memory_order_relaxed);
+
+    // the profiler only fills the event rings while a trace may be written
+    TickProfiler::setTracing(thresholdMs != 0);
+}
+
+MapTickStats MapTickScheduler::_getStats(MapMgr* mapMgr)
+{
+    MapTickStats stats;
+    stats.mapId = mapMgr->GetMapId();
+    stats.instanceId = mapMgr->GetInstanceID();
+    stats.tickInterval = mapMgr->m_scheduledTickInterval.get();
+    stats.duration = &mapMgr->m_tickDuration;
+    stats.lateness = &mapMgr->m_tickLateness;
+    stats.pools = &mapMgr->m_poolStats;
+    stats.createCache = &mapMgr->m_createCacheStats;
+    stats.phaseProfile = &mapMgr->m_phaseProfile;
+    stats.opcodeProfile = &mapMgr->m_opcodeProfile;
+    return stats;
+}
+
+void MapTickScheduler::_schedule(MapMgr* mapMgr, Clock::time_point deadline)
+{
+    ScheduledTick tick;
+    tick.deadline = deadline;
+    tick.mapMgr = mapMgr;
+
+    {
+        std::lock_guard<std::mutex> guard(m_timerLock);
+        m_timers.push(tick);
+    }
+
+    m_timerCond.notify_one();
+}
+
+bool MapTickScheduler::_popLocal(uint32_t index, ScheduledTick& tick)
+{
+    WorkerQueue* queue = m_queues[index];
+
+    std::lock_guard<std::mutex> guard(queue->lock);
+    if (queue->ticks.empty())
+        return false;
+
+    tick = queue->ticks.back();
+    queue->ticks.pop_back();
+    --m_readyTicks;
+    return true;
+}
+
+bool MapTickScheduler::_steal(uint32_t index, ScheduledTick& tick)
+{
+    const uint32_t workerCount = getWorkerCount();
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        WorkerQueue* victim = m_queues[(index + i) % workerCount];
+
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (victim->ticks.empty())
+            continue;
+
+        // take the oldest tick, the owner works on the newest one
+        tick = victim->ticks.front();
+        victim->ticks.pop_front();
+        --m_readyTicks;
+        return true;
+    }
+
+    return false;
+}
+
+void MapTickScheduler::_runTick(const ScheduledTick& tick)
+{
+    MapMgr* mapMgr = tick.mapMgr;
+
+    const Clock::time_point start = Clock::now();
+    const uint64_t lateness = start > tick.deadline ? std::chrono::duration_cast<std::chrono::microseconds>(start - tick.deadline).count() : 0;
+
+    const bool tracing = TickProfiler::isEnabled() && TickProfiler::isTracing();
+    const uint64_t ringPosition = tracing ? TickProfiler::getRingPosition() : 0;
+
+    t_currentMapContext.set(mapMgr);
+    bool keepRunning;
+    {
+        ProfileScope profile("MapMgr::Tick", PROFILE_CATEGORY_TICK, mapMgr->GetMapId());
+        keepRunning = mapMgr->Tick();
+    }
+    t_currentMapContext.set(nullptr);
+
+    // the map finished (and maybe deleted itself), don't touch it anymore
+    if (!keepRunning)
+    {
+        if (--m_scheduledMaps == 0)
+            m_timerCond.notify_all();
+
+        return;
+    }
+
+    const Clock::time_point end = Clock::now();
+    const uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    mapMgr->m_tickLateness.add(lateness);
+    mapMgr->m_tickDuration.add(duration);
+
+    const uint32_t slowTickThreshold = m_slowTickThreshold.load(std::memory_order_relaxed);
+    if (slowTickThreshold != 0 && duration >= slowTickThreshold * 1000ull && tracing)
+        _writeSlowTickTrace(mapMgr, ringPosition, duration);
+
+    // GetTickInterval reads the map's containers, visitStats runs on other threads
+    const uint32_t tickInterval = mapMgr->GetTickInterval();
+    mapMgr->m_scheduledTickInterval.set(tickInterval);
+
+    // fixed rate, a late tick is not pushed back by its own lateness
+    Clock::time_point next = tick.deadline + std::chrono::milliseconds(tickInterval);
+    if (next < start)
+        next = start + std::chrono::milliseconds(tickInterval);
+
+    _schedule(mapMgr, next);
+}
+
+void MapTickScheduler::_writeSlowTickTrace(MapMgr* mapMgr, uint64_t ringPosition, uint64_t duration)
+{
+    // a map stuck at slow ticks would write a trace every tick otherwise
+    std::string fileName;
+    {
+        std::lock_guard<std::mutex> guard(m_traceLock);
+
+        const Clock::time_point now = Clock::now();
+        if (m_lastTrace != Clock::time_point() && now - m_lastTrace < std::chrono::seconds(10))
+            return;
+
+        m_lastTrace = now;
+
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), "%u_%u_%llu.json", mapMgr->GetMapId(), mapMgr->GetInstanceID(), static_cast<unsigned long long>(UNIXTIME));
+        fileName = m_traceFilePrefix + suffix;
+    }
+
+    std::vector<ProfileEvent> events;
+    const uint64_t overwritten = TickProfiler::copyEvents(ringPosition, events);
+
+    if (!TickProfiler::writeChromeTrace(fileName, events))
+    {
+        LOG_ERROR("MapTickScheduler : Could not write the trace of a %llu ms tick of map %u to %s", static_cast<unsigned long long>(duration / 1000),
+            mapMgr->GetMapId(), fileName.c_str());
+        return;
+    }
+
+    LogNotice("MapTickScheduler : Tick of map %u instance %u took %llu ms, trace of %u events written to %s%s", mapMgr->GetMapId(), mapMgr->GetInstanceID(),
+        static_cast<unsigned long long>(duration / 1000), static_cast<uint32_t>(events.size()), fileName.c_str(), overwritten != 0 ? " (begin of the tick lost)" : "");
+}
+
+bool MapTickScheduler::_runWorker(uint32_t index)
+{
+    SetThreadName("Map tick worker %u", index);
+
+    ScheduledTick tick;
+
+    for (;;)
+    {
+        if (_popLocal(index, tick) || _steal(index, tick))
+        {
+            _runTick(tick);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(m_timerLock);
+
+        // another worker queued ready ticks after our steal attempt
+        if (m_readyTicks.load() != 0)
+            continue;
+
+        if (m_stopping && m_scheduledMaps.load() == 0)
+            break;
+
+        if (m_timers.empty())
+        {
+            m_timerCond.wait_for(guard, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        const Clock::time_point now = Clock::now();
+        if (m_timers.top().deadline > now)
+        {
+            m_timerCond.wait_until(guard, m_timers.top().deadline);
+            continue;
+        }
+
+        // take all due ticks into our own deque, idle workers will steal from it
+        uint32_t released = 0;
+        {
+            WorkerQueue* queue = m_queues[index];
+            std::lock_guard<std::mutex> queueGuard(queue->lock);
+
+            while (!m_timers.empty() && m_timers.top().deadline <= now)
+            {
+                queue->ticks.push_back(m_timers.top());
+                m_timers.pop();
+                ++m_readyTicks;
+                ++released;
+            }
+        }
+
+        guard.unlock();
+
+        if (released > 1)
+            m_timerCond.notify_all();
+    }
+
+    LogDebugFlag(LF_MAP, "MapTickScheduler : Worker %u exited", index);
+    --m_runningWorkers;
+
+    return true;
+}
@@ -0,0 +1,242 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+#include "Singleton.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+class MapMgr;
+class MapPoolStats;
+class ProfileCounterTable;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Power of two histogram of microsecond values, bucket n holds values below 1ms << n.
+/// Written by the map tick workers, read by the console without locking.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapTickHistogram
+{
+    public:
+
+        static const uint8_t bucketCount = 12;
+
+        MapTickHistogram();
+        MapTickHistogram& operator=(const MapTickHistogram& other);
+
+        void add(uint64_t microseconds);
+        void reset();
+
+        uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        uint64_t getTotal() const { return m_total.load(std::memory_order_relaxed); }
+        uint64_t getMax() const { return m_max.load(std::memory_order_relaxed); }
+        uint64_t getBucket(uint8_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+        /// upper bound of a bucket in microseconds, the last bucket is unbounded
+        static uint64_t getBucketLimit(uint8_t bucket) { return uint64_t(1000) << bucket; }
+
+        /// smallest bucket limit covering the given percentile (0-100)
+        uint64_t getPercentile(uint32_t percent) const;
+
+    private:
+
+        std::atomic<uint64_t> m_buckets[bucketCount];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_total;
+        std::atomic<uint64_t> m_max;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Create blocks of the objects of one map which were served from the values cache of the
+/// object, see Object::_BuildCachedCreateValues. Written by the map thread.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL CreateBlockCacheStats
+{
+    public:
+
+        CreateBlockCacheStats() { reset(); }
+
+        CreateBlockCacheStats& operator=(const CreateBlockCacheStats& other)
+        {
+            m_hits.store(other.getHits(), std::memory_order_relaxed);
+            m_misses.store(other.getMisses(), std::memory_order_relaxed);
+            m_reusedBytes.store(other.getReusedBytes(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        void addHit(size_t bytes)
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            m_reusedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void addMiss() { m_misses.fetch_add(1, std::memory_order_relaxed); }
+
+        void reset()
+        {
+            m_hits.store(0, std::memory_order_relaxed);
+            m_misses.store(0, std::memory_order_relaxed);
+            m_reusedBytes.store(0, std::memory_order_relaxed);
+        }
+
+        uint64_t getHits() const { return m_hits.load(std::memory_order_relaxed); }
+        uint64_t getMisses() const { return m_misses.load(std::memory_order_relaxed); }
+        uint64_t getReusedBytes() const { return m_reusedBytes.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<uint64_t> m_hits;
+        std::atomic<uint64_t> m_misses;
+        std::atomic<uint64_t> m_reusedBytes;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Tick interval a map used for its last tick. GetTickInterval reads the containers of the
+/// map, so the map's tick stores the value here for the console and other threads.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapTickInterval
+{
+    public:
+
+        explicit MapTickInterval(uint32_t interval) : m_interval(interval) {}
+
+        MapTickInterval& operator=(const MapTickInterval& other)
+        {
+            set(other.get());
+            return *this;
+        }
+
+        void set(uint32_t interval) { m_interval.store(interval, std::memory_order_relaxed); }
+        uint32_t get() const { return m_interval.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<uint32_t> m_interval;
+};
+
+struct MapTickStats
+{
+    uint32_t mapId;
+    uint32_t instanceId;
+    uint32_t tickInterval;
+    const MapTickHistogram* duration;
+    const MapTickHistogram* lateness;
+    const MapPoolStats* pools;
+    const CreateBlockCacheStats* createCache;
+    const ProfileCounterTable* phaseProfile;
+    const ProfileCounterTable* opcodeProfile;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Runs the ticks of all MapMgr on a fixed set of worker threads.
+///
+/// Every map is scheduled at its next deadline on a shared timer heap. Workers move due
+/// ticks into their own deque and idle workers steal from the others, so a single slow
+/// instance does not hold back the rest. A map is only ever queued once, which keeps all
+/// of its updates on one thread at a time (t_currentMapContext is set for each tick).
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL MapTickScheduler : public Singleton<MapTickScheduler>
+{
+    friend class MapTickWorker;
+
+    public:
+
+        MapTickScheduler();
+        ~MapTickScheduler();
+
+        /// starts the workers, 0 uses one worker per cpu core
+        void startup(uint32_t workerCount);
+
+        /// terminates all maps and lets the workers exit once the last map finished
+        void shutdown();
+
+        /// schedules the first tick of a new map right away
+        void addMap(MapMgr* mapMgr);
+
+        /// called by ~MapMgr
+        void removeMap(MapMgr* mapMgr);
+
+        uint32_t getWorkerCount() const { return static_cast<uint32_t>(m_queues.size()); }
+
+        /// calls func with the stats of every map while the map registry is locked, all
+        /// stats are atomics written by the map ticks, so it may run on any thread
+        template <typename Func>
+        void visitStats(Func func)
+        {
+            std::lock_guard<std::mutex> guard(m_registryLock);
+            for (std::set<MapMgr*>::iterator itr = m_maps.begin(); itr != m_maps.end(); ++itr)
+                func(_getStats(*itr));
+        }
+
+        void resetStats();
+        void resetPoolStats();
+        void resetCreateCacheStats();
+        void resetProfileStats();
+
+        /// ticks taking at least this many ms are written as Chrome trace while the
+        /// TickProfiler is enabled, 0 disables the traces
+        void setSlowTickTrace(uint32_t thresholdMs, const std::string& filePrefix);
+        uint32_t getSlowTickThreshold() const { return m_slowTickThreshold.load(std::memory_order_relaxed); }
+        void setSlowTickThreshold(uint32_t thresholdMs);
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct ScheduledTick
+        {
+            Clock::time_point deadline;
+            MapMgr* mapMgr;
+
+            bool operator<(const ScheduledTick& other) const { return deadline > other.deadline; }
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex lock;
+            std::deque<ScheduledTick> ticks;
+        };
+
+        bool _runWorker(uint32_t index);
+        bool _popLocal(uint32_t index, ScheduledTick& tick);
+        bool _steal(uint32_t index, ScheduledTick& tick);
+        void _runTick(const ScheduledTick& tick);
+        void _schedule(MapMgr* mapMgr, Clock::time_point deadline);
+        void _writeSlowTickTrace(MapMgr* mapMgr, uint64_t ringPosition, uint64_t duration);
+
+        static MapTickStats _getStats(MapMgr* mapMgr);
+
+        std::vector<WorkerQueue*> m_queues;
+
+        // timer heap of not yet due ticks, also guards m_readyTicks increments
+        std::mutex m_timerLock;
+        std::condition_variable m_timerCond;
+        std::priority_queue<ScheduledTick> m_timers;
+
+        std::atomic<uint32_t> m_readyTicks;         // ticks sitting in worker deques
+        std::atomic<uint32_t> m_scheduledMaps;      // maps which did not finish their last tick yet
+        std::atomic<uint32_t> m_runningWorkers;
+        std::atomic<bool> m_stopping;
+
+        std::mutex m_registryLock;
+        std::set<MapMgr*> m_maps;
+
+        std::atomic<uint32_t> m_slowTickThreshold;
+        std::string m_traceFilePrefix;
+        std::mutex m_traceLock;                     // guards m_lastTrace
+        Clock::time_point m_lastTrace;
+};
+
+#define sMapTickScheduler MapTickScheduler::getSingleton()
@@ -43,6 +43,14 @@ void InstanceMgr::Load(TaskList* l)
 {
     new FormationMgr;
 
+    // all maps and instances are updated by the workers of the scheduler
+    new MapTickScheduler;
+    sMapTickScheduler.setSlowTickTrace(worldConfig.profiler.slowTickThreshold, worldConfig.profiler.traceFilePrefix);
+
+    // the tick benchmark runs its own map, the others must not tick next to it
+    if (!worldConfig.tickBenchmark.isEnabled)
+        sMapTickScheduler.startup(worldConfig.server.mapTickThreads);
+
     // Create all non-instance type maps.
     QueryResult* result = CharacterDatabase.Query("SELECT MAX(id) FROM instances");
     if (result)
@@ -157,6 +165,7 @@ void InstanceMgr::Shutdown()
     }
 
     delete FormationMgr::getSingletonPtr();
+    delete MapTickScheduler::getSingletonPtr();
 }
 
 uint32 InstanceMgr::PreTeleport(uint32 mapid, Player* plr, uint32 instanceid)
@@ -649,7 +658,7 @@ MapMgr* InstanceMgr::_CreateInstance(uint32 mapid, uint32 instanceid)
     ARCEMU_ASSERT(newMap != NULL);
 
     // Scheduling the new map for running
-    ThreadPool.ExecuteTask(newMap);
+    sMapTickScheduler.addMap(newMap);
     m_singleMaps[mapid] = newMap;
 
     return newMap;
@@ -669,7 +678,7 @@ MapMgr* InstanceMgr::_CreateInstance(Instance* in)
     in->m_mapMgr->iInstanceMode = in->m_difficulty;
     in->m_mapMgr->InactiveMoveTime = 60 + UNIXTIME;
 
-    ThreadPool.ExecuteTask(in->m_mapMgr);
+    sMapTickScheduler.addMap(in->m_mapMgr);
     return in->m_mapMgr;
 }
 
@@ -1179,7 +1188,7 @@ MapMgr* InstanceMgr::CreateBattlegroundInstance(uint32 mapid)
 
     m_instances[mapid]->insert(std::make_pair(pInstance->m_instanceId, pInstance));
     m_mapLock.Release();
-    ThreadPool.ExecuteTask(ret);
+    sMapTickScheduler.addMap(ret);
     return ret;
 }
 
@@ -1214,7 +1223,7 @@ MapMgr* InstanceMgr::CreateInstance(uint32 instanceType, uint32 mapid)
 
     m_instances[mapid]->insert(std::make_pair(pInstance->m_instanceId, pInstance));
     m_mapLock.Release();
-    ThreadPool.ExecuteTask(ret);
+    sMapTickScheduler.addMap(ret);
     return ret;
 }
 
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "MovementBroadcast.hpp"
+#include "Server/WorldConfig.h"
+
+namespace Movement
+{
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // BroadcastLod
+    BroadcastLod::BroadcastLod() : m_dueTiers(0)
+    {
+        for (uint8_t i = 0; i < BROADCAST_TIER_COUNT; ++i)
+            m_lastSent[i] = 0;
+    }
+
+    void BroadcastLod::beginHeartbeat(uint32_t now)
+    {
+        const uint32_t intervals[BROADCAST_TIER_COUNT] = { 0, worldConfig.movement.lodMidIntervalInMs, worldConfig.movement.lodFarIntervalInMs };
+
+        m_dueTiers = 0;
+        for (uint8_t i = 0; i < BROADCAST_TIER_COUNT; ++i)
+        {
+            if (!worldConfig.movement.isLodEnabled || getMSTimeDiff(m_lastSent[i], now) >= intervals[i])
+            {
+                m_dueTiers |= 1 << i;
+                m_lastSent[i] = now;
+            }
+        }
+    }
+
+    void BroadcastLod::beginStateChange(uint32_t now)
+    {
+        m_dueTiers = (1 << BROADCAST_TIER_COUNT) - 1;
+        for (uint8_t i = 0; i < BROADCAST_TIER_COUNT; ++i)
+            m_lastSent[i] = now;
+    }
+
+    BroadcastTier BroadcastLod::getTier(float distanceSq)
+    {
+        if (distanceSq <= worldConfig.movement.lodNearDistance)
+            return BROADCAST_TIER_NEAR;
+
+        if (distanceSq <= worldConfig.movement.lodMidDistance)
+            return BROADCAST_TIER_MID;
+
+        return BROADCAST_TIER_FAR;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // BroadcastStats
+    std::atomic<uint64_t> BroadcastStats::s_sentPackets(0);
+    std::atomic<uint64_t> BroadcastStats::s_sentBytes(0);
+    std::atomic<uint64_t> BroadcastStats::s_skippedPackets(0);
+    std::atomic<uint64_t> BroadcastStats::s_skippedBytes(0);
+    std::atomic<uint64_t> BroadcastStats::s_coalesced(0);
+    std::atomic<uint32_t> BroadcastStats::s_resetTime(0);
+
+    void BroadcastStats::add(uint32_t sentPackets, uint64_t sentBytes, uint32_t skippedPackets, uint64_t skippedBytes)
+    {
+        if (sentPackets != 0)
+        {
+            s_sentPackets.fetch_add(sentPackets, std::memory_order_relaxed);
+            s_sentBytes.fetch_add(sentBytes, std::memory_order_relaxed);
+        }
+
+        if (skippedPackets != 0)
+        {
+            s_skippedPackets.fetch_add(skippedPackets, std::memory_order_relaxed);
+            s_skippedBytes.fetch_add(skippedBytes, std::memory_order_relaxed);
+        }
+    }
+
+    void BroadcastStats::reset()
+    {
+        s_sentPackets.store(0, std::memory_order_relaxed);
+        s_sentBytes.store(0, std::memory_order_relaxed);
+        s_skippedPackets.store(0, std::memory_order_relaxed);
+        s_skippedBytes.store(0, std::memory_order_relaxed);
+        s_coalesced.store(0, std::memory_order_relaxed);
+        s_resetTime.store(getMSTime(), std::memory_order_relaxed);
+    }
+}
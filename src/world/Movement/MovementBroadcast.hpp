@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "CommonTypes.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Movement
+{
+    enum BroadcastTier : uint8_t
+    {
+        BROADCAST_TIER_NEAR     = 0,    // every movement packet
+        BROADCAST_TIER_MID      = 1,    // heartbeats every Movement.LodMidInterval ms
+        BROADCAST_TIER_FAR      = 2,    // heartbeats every Movement.LodFarInterval ms
+        BROADCAST_TIER_COUNT    = 3
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    /// Heartbeat rate of one mover per observer distance tier.
+    ///
+    /// Only heartbeats are thinned out. State changes (start, stop, jump, facing...) reach
+    /// every observer, so the client side extrapolation of far observers stays correct and
+    /// they only lose the intermediate position corrections.
+    //////////////////////////////////////////////////////////////////////////////////////////
+    class SERVER_DECL BroadcastLod
+    {
+        public:
+
+            BroadcastLod();
+
+            /// decides which tiers receive a heartbeat sent at now
+            void beginHeartbeat(uint32_t now);
+
+            /// every tier receives state changes, their heartbeat intervals start over
+            void beginStateChange(uint32_t now);
+
+            bool isDue(BroadcastTier tier) const { return (m_dueTiers & (1 << tier)) != 0; }
+
+            /// distanceSq between mover and observer
+            static BroadcastTier getTier(float distanceSq);
+
+        private:
+
+            uint32_t m_lastSent[BROADCAST_TIER_COUNT];
+            uint8_t m_dueTiers;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    /// Server wide counters of broadcast player movement, shown by the movementstats command.
+    //////////////////////////////////////////////////////////////////////////////////////////
+    class SERVER_DECL BroadcastStats
+    {
+        public:
+
+            /// counts of one broadcast, bytes include the 4 byte packet header
+            static void add(uint32_t sentPackets, uint64_t sentBytes, uint32_t skippedPackets, uint64_t skippedBytes);
+            static void addCoalesced() { s_coalesced.fetch_add(1, std::memory_order_relaxed); }
+
+            static uint64_t getSentPackets() { return s_sentPackets.load(std::memory_order_relaxed); }
+            static uint64_t getSentBytes() { return s_sentBytes.load(std::memory_order_relaxed); }
+            static uint64_t getSkippedPackets() { return s_skippedPackets.load(std::memory_order_relaxed); }
+            static uint64_t getSkippedBytes() { return s_skippedBytes.load(std::memory_order_relaxed); }
+            static uint64_t getCoalesced() { return s_coalesced.load(std::memory_order_relaxed); }
+
+            /// getMSTime of the last reset
+            static uint32_t getResetTime() { return s_resetTime.load(std::memory_order_relaxed); }
+
+            static void reset();
+
+        private:
+
+            static std::atomic<uint64_t> s_sentPackets;
+            static std::atomic<uint64_t> s_sentBytes;
+            static std::atomic<uint64_t> s_skippedPackets;
+            static std::atomic<uint64_t> s_skippedBytes;
+            static std::atomic<uint64_t> s_coalesced;
+            static std::atomic<uint32_t> s_resetTime;
+    };
+}
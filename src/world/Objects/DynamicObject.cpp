@@ -134,30 +134,25 @@ void DynamicObject::UpdateTargets()
 
     if (m_aliveDuration >= 100)
     {
-        Unit* target;
         Aura* pAura;
 
         float radius = GetFloatValue(DYNAMICOBJECT_RADIUS) * GetFloatValue(DYNAMICOBJECT_RADIUS);
 
-        // Looking for targets in the Object set
-        for (std::set< Object* >::iterator itr = m_objectsInRange.begin(); itr != m_objectsInRange.end(); ++itr)
+        // Looking for targets around us
+        if (IsInWorld())
         {
-            Object* o = *itr;
-
-            if (!o->IsUnit() || !static_cast< Unit* >(o)->isAlive())
-                continue;
-
-            target = static_cast< Unit* >(o);
+            GetMapMgr()->ForEachUnitInRadius(GetPositionX(), GetPositionY(), GetPositionZ(), GetFloatValue(DYNAMICOBJECT_RADIUS), [&](Unit* target) -> bool
+            {
+                if (!target->isAlive())
+                    return true;
 
-            if (!isAttackable(u_caster, target, !(m_spellProto->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                continue;
+                if (!isAttackable(u_caster, target, !(m_spellProto->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
+                    return true;
 
-            // skip units already hit, their range will be tested later
-            if (targets.find(target->GetGUID()) != targets.end())
-                continue;
+                // skip units already hit, their range will be tested later
+                if (targets.find(target->GetGUID()) != targets.end())
+                    return true;
 
-            if (GetDistanceSq(target) <= radius)
-            {
                 pAura = sSpellFactoryMgr.NewAura(m_spellProto, m_aliveDuration, u_caster, target, true);
                 for (uint8 i = 0; i < 3; ++i)
                 {
@@ -176,9 +171,10 @@ void DynamicObject::UpdateTargets()
 
                 // add to target list
                 targets.insert(target->GetGUID());
-            }
-        }
 
+                return true;
+            });
+        }
 
         // loop the targets, check the range of all of them
         DynamicObjectList::iterator jtr = targets.begin();
@@ -187,7 +183,7 @@ void DynamicObject::UpdateTargets()
 
         while (jtr != jend)
         {
-            target = GetMapMgr() ? GetMapMgr()->GetUnit(*jtr) : NULL;
+            Unit* target = GetMapMgr() ? GetMapMgr()->GetUnit(*jtr) : NULL;
             jtr2 = jtr;
             ++jtr;
 
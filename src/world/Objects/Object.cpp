@@ -46,6 +46,8 @@ Object::Object() : m_position(0, 0, 0, 0), m_spawnLocation(0, 0, 0, 0)
     m_uint32Values = 0;
     m_objectUpdated = false;
 
+    m_valuesGeneration = 0;
+
     m_currentSpell = NULL;
     m_valuesCount = 0;
 
@@ -213,12 +215,17 @@ uint32 Object::BuildCreateUpdateBlockForPlayer(ByteBuffer* data, Player* target)
     _BuildMovementUpdate(data, updateflags, target);
 
 
-    // we have dirty data, or are creating for ourself.
+    // items are only created for their owner, every other object is seen by many players with the same values
+    if (target != this && !IsType(TYPE_ITEM))
+    {
+        _BuildCachedCreateValues(data, target);
+        return 1;
+    }
+
     UpdateMask updateMask;
     updateMask.SetCount(m_valuesCount);
     _SetCreateBits(&updateMask, target);
 
-    // this will cache automatically if needed
     _BuildValuesUpdate(data, &updateMask, target);
 
     // update count: 1 ;)
@@ -992,190 +999,190 @@ void Object::_BuildMovementUpdate(ByteBuffer* data, uint16 updateFlags, Player*
 }
 #endif
 
-//////////////////////////////////////////////////////////////////////////////////////////
-/// Creates an update block with the values of this object as determined by the updateMask.
-//////////////////////////////////////////////////////////////////////////////////////////
-void Object::_BuildValuesUpdate(ByteBuffer* data, UpdateMask* updateMask, Player* target)
+uint32 Object::_GetCreateDynamicIndex()
 {
-    bool activate_quest_object = false;
-    bool reset = false;
-    uint32 oldflags = 0;
+    if (IsCreature())
+        return UNIT_DYNAMIC_FLAGS;
 
-    if (updateMask->GetBit(OBJECT_FIELD_GUID) && target)	   // We're creating.
+    if (IsGameObject())
+        return GAMEOBJECT_DYNAMIC;
+
+    return 0;
+}
+
+bool Object::_GetObserverDynamicValue(Player* target, uint32& value)
+{
+    if (IsCreature())
     {
-        if (IsCreature())
+        Creature* pThis = static_cast< Creature* >(this);
+        if (pThis->IsTagged() && (pThis->loot.gold || pThis->loot.items.size()))
         {
-            Creature* pThis = static_cast< Creature* >(this);
-            if (pThis->IsTagged() && (pThis->loot.gold || pThis->loot.items.size()))
-            {
-                // Let's see if we're the tagger or not.
-                oldflags = m_uint32Values[UNIT_DYNAMIC_FLAGS];
-                uint32 Flags = m_uint32Values[UNIT_DYNAMIC_FLAGS];
-                uint32 oldFlags = 0;
+            // Let's see if we're the tagger or not.
+            uint32 Flags = m_uint32Values[UNIT_DYNAMIC_FLAGS];
+            uint32 oldFlags = 0;
 
-                if (pThis->GetTaggerGUID() == target->GetGUID())
-                {
-                    // Our target is our tagger.
-                    oldFlags = U_DYN_FLAG_TAGGED_BY_OTHER;
+            if (pThis->GetTaggerGUID() == target->GetGUID())
+            {
+                // Our target is our tagger.
+                oldFlags = U_DYN_FLAG_TAGGED_BY_OTHER;
 
-                    if (Flags & U_DYN_FLAG_TAGGED_BY_OTHER)
-                        Flags &= ~oldFlags;
+                if (Flags & U_DYN_FLAG_TAGGED_BY_OTHER)
+                    Flags &= ~oldFlags;
 
-                    if (!(Flags & U_DYN_FLAG_LOOTABLE) && pThis->HasLootForPlayer(target))
-                        Flags |= U_DYN_FLAG_LOOTABLE;
-                }
-                else
-                {
-                    // Target is not the tagger.
-                    oldFlags = U_DYN_FLAG_LOOTABLE;
+                if (!(Flags & U_DYN_FLAG_LOOTABLE) && pThis->HasLootForPlayer(target))
+                    Flags |= U_DYN_FLAG_LOOTABLE;
+            }
+            else
+            {
+                // Target is not the tagger.
+                oldFlags = U_DYN_FLAG_LOOTABLE;
 
-                    if (!(Flags & U_DYN_FLAG_TAGGED_BY_OTHER))
-                        Flags |= U_DYN_FLAG_TAGGED_BY_OTHER;
+                if (!(Flags & U_DYN_FLAG_TAGGED_BY_OTHER))
+                    Flags |= U_DYN_FLAG_TAGGED_BY_OTHER;
 
-                    if (Flags & U_DYN_FLAG_LOOTABLE)
-                        Flags &= ~oldFlags;
-                }
+                if (Flags & U_DYN_FLAG_LOOTABLE)
+                    Flags &= ~oldFlags;
+            }
 
-                m_uint32Values[UNIT_DYNAMIC_FLAGS] = Flags;
+            value = Flags;
+            return true;
+        }
+    }
 
-                updateMask->SetBit(UNIT_DYNAMIC_FLAGS);
+    if (IsGameObject())
+    {
+        bool activate_quest_object = false;
 
-                reset = true;
-            }
-        }
+        GameObject* go = static_cast<GameObject*>(this);
+        QuestLogEntry* qle;
+        GameObjectProperties const* gameobject_info;
+        GameObject_QuestGiver* go_quest_giver = nullptr;
+        if (go->GetType() == GAMEOBJECT_TYPE_QUESTGIVER)
+            go_quest_giver = static_cast<GameObject_QuestGiver*>(go);
 
-        if (target && IsGameObject())
+        if (go_quest_giver != nullptr && go_quest_giver->HasQuests())
         {
-            GameObject* go = static_cast<GameObject*>(this);
-            QuestLogEntry* qle;
-            GameObjectProperties const* gameobject_info;
-            GameObject_QuestGiver* go_quest_giver = nullptr;
-            if (go->GetType() == GAMEOBJECT_TYPE_QUESTGIVER)
-                go_quest_giver = static_cast<GameObject_QuestGiver*>(go);
-
-            if (go_quest_giver != nullptr && go_quest_giver->HasQuests())
+            std::list<QuestRelation*>::iterator itr;
+            for (itr = go_quest_giver->QuestsBegin(); itr != go_quest_giver->QuestsEnd(); ++itr)
             {
-                std::list<QuestRelation*>::iterator itr;
-                for (itr = go_quest_giver->QuestsBegin(); itr != go_quest_giver->QuestsEnd(); ++itr)
+                QuestRelation* qr = (*itr);
+                if (qr != NULL)
                 {
-                    QuestRelation* qr = (*itr);
-                    if (qr != NULL)
+                    QuestProperties const* qst = qr->qst;
+                    if (qst != nullptr)
                     {
-                        QuestProperties const* qst = qr->qst;
-                        if (qst != nullptr)
+                        if ((qr->type & QUESTGIVER_QUEST_START && !target->HasQuest(qst->id))
+                            || (qr->type & QUESTGIVER_QUEST_END && target->HasQuest(qst->id))
+                           )
                         {
-                            if ((qr->type & QUESTGIVER_QUEST_START && !target->HasQuest(qst->id))
-                                || (qr->type & QUESTGIVER_QUEST_END && target->HasQuest(qst->id))
-                               )
-                            {
-                                activate_quest_object = true;
-                                break;
-                            }
+                            activate_quest_object = true;
+                            break;
                         }
                     }
                 }
             }
-            else
+        }
+        else
+        {
+            gameobject_info = go->GetGameObjectProperties();
+            if (gameobject_info && (gameobject_info->goMap.size() || gameobject_info->itemMap.size()))
             {
-                gameobject_info = go->GetGameObjectProperties();
-                if (gameobject_info && (gameobject_info->goMap.size() || gameobject_info->itemMap.size()))
+                for (GameObjectGOMap::const_iterator itr = gameobject_info->goMap.begin(); itr != gameobject_info->goMap.end(); ++itr)
                 {
-                    for (GameObjectGOMap::const_iterator itr = gameobject_info->goMap.begin(); itr != gameobject_info->goMap.end(); ++itr)
+                    qle = target->GetQuestLogForEntry(itr->first->id);
+                    if (qle != NULL)
                     {
-                        qle = target->GetQuestLogForEntry(itr->first->id);
-                        if (qle != NULL)
+                        if (qle->GetQuest()->count_required_mob == 0)
+                            continue;
+                        for (uint8 i = 0; i < 4; ++i)
                         {
-                            if (qle->GetQuest()->count_required_mob == 0)
-                                continue;
-                            for (uint8 i = 0; i < 4; ++i)
+                            if (qle->GetQuest()->required_mob_or_go[i] == static_cast<int32>(go->GetEntry()) && qle->GetMobCount(i) < qle->GetQuest()->required_mob_or_go_count[i])
                             {
-                                if (qle->GetQuest()->required_mob_or_go[i] == static_cast<int32>(go->GetEntry()) && qle->GetMobCount(i) < qle->GetQuest()->required_mob_or_go_count[i])
-                                {
-                                    activate_quest_object = true;
-                                    break;
-                                }
-                            }
-                            if (activate_quest_object)
+                                activate_quest_object = true;
                                 break;
+                            }
                         }
+                        if (activate_quest_object)
+                            break;
                     }
+                }
 
-                    if (!activate_quest_object)
+                if (!activate_quest_object)
+                {
+                    for (GameObjectItemMap::const_iterator itr = gameobject_info->itemMap.begin();
+                         itr != go->GetGameObjectProperties()->itemMap.end();
+                         ++itr)
                     {
-                        for (GameObjectItemMap::const_iterator itr = gameobject_info->itemMap.begin();
-                             itr != go->GetGameObjectProperties()->itemMap.end();
-                             ++itr)
+                        for (std::map<uint32, uint32>::const_iterator it2 = itr->second.begin();
+                             it2 != itr->second.end();
+                             ++it2)
                         {
-                            for (std::map<uint32, uint32>::const_iterator it2 = itr->second.begin();
-                                 it2 != itr->second.end();
-                                 ++it2)
+                            if ((qle = target->GetQuestLogForEntry(itr->first->id)) != 0)
                             {
-                                if ((qle = target->GetQuestLogForEntry(itr->first->id)) != 0)
+                                if (target->GetItemInterface()->GetItemCount(it2->first) < it2->second)
                                 {
-                                    if (target->GetItemInterface()->GetItemCount(it2->first) < it2->second)
-                                    {
-                                        activate_quest_object = true;
-                                        break;
-                                    }
+                                    activate_quest_object = true;
+                                    break;
                                 }
                             }
-                            if (activate_quest_object)
-                                break;
                         }
+                        if (activate_quest_object)
+                            break;
                     }
                 }
             }
         }
+
+        if (activate_quest_object)
+        {
+            value = 1 | 8;      // 8 to show sparkles
+            return true;
+        }
     }
 
+    return false;
+}
 
-    if (activate_quest_object)
-    {
-        oldflags = m_uint32Values[GAMEOBJECT_DYNAMIC];
-        if (!updateMask->GetBit(GAMEOBJECT_DYNAMIC))
-            updateMask->SetBit(GAMEOBJECT_DYNAMIC);
-        m_uint32Values[GAMEOBJECT_DYNAMIC] = 1 | 8;     // 8 to show sparkles
-        reset = true;
-    }
+void Object::_BuildCachedCreateValues(ByteBuffer* data, Player* target)
+{
+    const uint32 dynamicIndex = _GetCreateDynamicIndex();
+    const size_t start = data->wpos();
 
-    ARCEMU_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
-    uint32 bc;
-    uint32 values_count;
-    if (m_valuesCount > (2 * 0x20))    //if number of blocks > 2->  unit and player+item container
-    {
-        bc = updateMask->GetUpdateBlockCount();
-        values_count = std::min<uint32>(bc * 32, m_valuesCount);
+    const bool cached = m_createValues.appendCreateValues(data, m_uint32Values, m_valuesCount, m_valuesGeneration, dynamicIndex,
+        [this, target](UpdateMask* updateMask) { _SetCreateBits(updateMask, target); });
 
-    }
-    else
+    if (m_mapMgr != nullptr)
     {
-        bc = updateMask->GetBlockCount();
-        values_count = m_valuesCount;
+        if (cached)
+            m_mapMgr->m_createCacheStats.addHit(m_createValues.getSize());
+        else
+            m_mapMgr->m_createCacheStats.addMiss();
     }
 
-    *data << (uint8)bc;
-    data->append(updateMask->GetMask(), bc * 4);
+    // the cached block holds the stored value, the observer may see another one
+    uint32 value;
+    if (dynamicIndex != 0 && _GetObserverDynamicValue(target, value))
+        m_createValues.patchDynamicValue(data, start, value);
+}
 
-    for (uint32 index = 0; index < values_count; index++)
-    {
-        if (updateMask->GetBit(index))
-        {
-            *data << m_uint32Values[index];
-        }
-    }
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Creates an update block with the values of this object as determined by the updateMask.
+//////////////////////////////////////////////////////////////////////////////////////////
+void Object::_BuildValuesUpdate(ByteBuffer* data, UpdateMask* updateMask, Player* target)
+{
+    uint32 dynamicIndex = 0;
+    uint32 dynamicValue = 0;
 
-    if (reset)
+    if (updateMask->GetBit(OBJECT_FIELD_GUID) && target)	   // We're creating.
     {
-        switch (GetTypeId())
+        if (_GetObserverDynamicValue(target, dynamicValue))
         {
-            case TYPEID_UNIT:
-                m_uint32Values[UNIT_DYNAMIC_FLAGS] = oldflags;
-                break;
-            case TYPEID_GAMEOBJECT:
-                m_uint32Values[GAMEOBJECT_DYNAMIC] = oldflags;
-                break;
+            dynamicIndex = _GetCreateDynamicIndex();
+            updateMask->SetBit(dynamicIndex);
         }
     }
+
+    ObjectCreateValues::writeValues(data, updateMask, m_uint32Values, m_valuesCount, dynamicIndex, dynamicValue);
 }
 
 // This is not called!
@@ -1278,6 +1285,7 @@ void Object::LoadValues(const char* data)
         val = atol(ndata.substr(last_pos, (pos - last_pos)).c_str());
         if (m_uint32Values[index] == 0)
             m_uint32Values[index] = val;
+        ++m_valuesGeneration;
         last_pos = pos + 1;
         ++index;
     }
@@ -1292,10 +1300,8 @@ void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
 
 void Object::_SetCreateBits(UpdateMask* updateMask, Player* target) const
 {
-
-    for (uint32 i = 0; i < m_valuesCount; ++i)
-        if (m_uint32Values[i] != 0)
-            updateMask->SetBit(i);
+    ARCEMU_ASSERT(updateMask->GetCount() == m_valuesCount);
+    updateMask->SetNonZeroBits(m_uint32Values);
 }
 
 void Object::AddToWorld()
@@ -1419,6 +1425,9 @@ void Object::RemoveFromWorld(bool free_guid)
 
     OnRemoveFromWorld();
 
+    // nobody sees the object until it is pushed again
+    m_createValues.clear();
+
     std::set<Spell*>::iterator itr, itr2;
     Spell* sp;
     for (itr = m_pendingSpells.begin(); itr != m_pendingSpells.end();)
@@ -1456,6 +1465,7 @@ void Object::SetUInt32Value(const uint32 index, const uint32 value)
         return;
 
     m_uint32Values[index] = value;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -1527,6 +1537,7 @@ void Object::ModUnsigned32Value(uint32 index, int32 mod)
     m_uint32Values[index] += mod;
     if ((int32)m_uint32Values[index] < 0)
         m_uint32Values[index] = 0;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -1581,6 +1592,8 @@ void Object::ModSignedInt32Value(uint32 index, int32 value)
         return;
 
     m_uint32Values[index] += value;
+    ++m_valuesGeneration;
+
     if (IsInWorld())
     {
         m_updateMask.SetBit(index);
@@ -1597,6 +1610,7 @@ void Object::ModFloatValue(const uint32 index, const float value)
 {
     ARCEMU_ASSERT(index < m_valuesCount);
     m_floatValues[index] += value;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -1617,7 +1631,7 @@ void Object::ModFloatValueByPCT(const uint32 index, int32 byPct)
         m_floatValues[index] *= 1.0f + byPct / 100.0f;
     else
         m_floatValues[index] /= 1.0f - byPct / 100.0f;
-
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -1644,6 +1658,7 @@ void Object::SetUInt64Value(const uint32 index, const uint64 value)
         return;
     else
         *p = value;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -1668,6 +1683,7 @@ void Object::SetFloatValue(const uint32 index, const float value)
         return;
 
     m_floatValues[index] = value;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -2189,7 +2205,7 @@ void Object::SpellNonMeleeDamageLog(Unit* pVictim, uint32 spellID, uint32 damage
         else if (pl->HasAura(44396))
             pctmod = 0.15f;
 
-        uint32 hp = static_cast< uint32 >(0.05f * pl->GetUInt32Value(UNIT_FIELD_MAXHEALTH));
+        uint32 hp = static_cast< uint32 >(0.05f * pl->GetMaxHealth());
         uint32 spellpower = static_cast< uint32 >(pctmod * pl->GetPosDamageDoneMod(SCHOOL_NORMAL));
 
         if (spellpower > hp)
@@ -2519,6 +2535,7 @@ void Object::SetByte(uint32 index, uint32 index1, uint8 value)
         return;
 
     *v = value;
+    ++m_valuesGeneration;
 
     if (IsInWorld())
     {
@@ -2543,6 +2560,7 @@ void Object::SetByteFlag(uint16 index, uint8 offset, uint8 newFlag)
     if (!(uint8(m_uint32Values[index] >> offset) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << offset);
+        ++m_valuesGeneration;
 
         if (IsInWorld())
         {
@@ -2567,6 +2585,7 @@ void Object::RemoveByteFlag(uint16 index, uint8 offset, uint8 oldFlag)
     if (uint8(m_uint32Values[index] >> offset) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << offset);
+        ++m_valuesGeneration;
 
         if (IsInWorld())
         {
@@ -2869,16 +2888,20 @@ bool Object::GetPoint(float angle, float rad, float & outx, float & outy, float
     GetMapMgr()->GetLiquidInfo(outx, outy, GetPositionZ() + 2, waterz, watertype);
     outz = std::max(waterz, outz);
 
+    //if we can path there, go for it
+    //CreatePath reads the navmesh itself, so it has to run before we lock it
+    const bool canCreatePath = IsUnit() && sloppypath && static_cast<Unit*>(this)->GetAIInterface()->CanCreatePath(outx, outy, outz);
+
     MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-    dtNavMesh* nav = const_cast<dtNavMesh*>(mmap->GetNavMesh(GetMapId()));
-    dtNavMeshQuery* nav_query = const_cast<dtNavMeshQuery*>(mmap->GetNavMeshQuery(GetMapId(), GetInstanceID()));
+    MMAP::NavMeshReader navMesh = mmap->GetNavMeshReader(GetMapId());
     //NavMeshData* nav = CollideInterface.GetNavMesh(GetMapId());
 
-    if (nav != nullptr)
+    if (navMesh)
     {
-        //if we can path there, go for it
-        if (!IsUnit() || !sloppypath || !static_cast<Unit*>(this)->GetAIInterface()->CanCreatePath(outx, outy, outz))
+        if (!canCreatePath)
         {
+            dtNavMeshQuery const* nav_query = navMesh.getQuery();
+
             //raycast nav mesh to see if this place is valid
             float start[3] = { GetPositionY(), GetPositionZ() + 0.5f, GetPositionX() };
             float end[3] = { outy, outz + 0.5f, outx };
@@ -25,12 +25,14 @@
 
 #include "Server/UpdateFieldInclude.h"
 #include "Server/UpdateMask.h"
+#include "ObjectCreateValues.hpp"
 #include "CommonTypes.hpp"
 #include "Server/EventableObject.h"
 #include "Server/IUpdatable.h"
 
 #include <set>
 #include <map>
+#include <vector>
 
 #include "WoWGuid.h"
 #include "../shared/LocationVector.h"
@@ -410,8 +412,8 @@ class SERVER_DECL Object : public EventableObject, public IUpdatable
         void SetGUID(uint64 GUID) { SetUInt64Value(OBJECT_FIELD_GUID, GUID); }
         const uint32 GetLowGUID() const { return m_uint32Values[OBJECT_FIELD_GUID]; }
         uint32 GetHighGUID() { return m_uint32Values[OBJECT_FIELD_GUID + 1]; }
-        void SetLowGUID(uint32 val) { m_uint32Values[OBJECT_FIELD_GUID] = val; }
-        void SetHighGUID(uint32 val) { m_uint32Values[OBJECT_FIELD_GUID + 1] = val; }
+        void SetLowGUID(uint32 val) { m_uint32Values[OBJECT_FIELD_GUID] = val; ++m_valuesGeneration; }
+        void SetHighGUID(uint32 val) { m_uint32Values[OBJECT_FIELD_GUID + 1] = val; ++m_valuesGeneration; }
 
         const WoWGuid & GetNewGUID() const { return m_wowGuid; }
         uint32 GetEntry() { return m_uint32Values[OBJECT_FIELD_ENTRY]; }
@@ -882,6 +884,15 @@ class SERVER_DECL Object : public EventableObject, public IUpdatable
         void _BuildMovementUpdate(ByteBuffer* data, uint16 flags, Player* target);
         void _BuildValuesUpdate(ByteBuffer* data, UpdateMask* updateMask, Player* target);
 
+        /// Appends the values part of a create block for a player other than this object. The block is
+        /// cached until the next field change, only the dynamic field is patched per observer.
+        void _BuildCachedCreateValues(ByteBuffer* data, Player* target);
+
+        /// Field holding loot/tag state (creatures) or quest sparkles (gameobjects), 0 if there is none
+        uint32 _GetCreateDynamicIndex();
+        /// False if target sees the stored value of the dynamic field
+        bool _GetObserverDynamicValue(Player* target, uint32& value);
+
         /// WoWGuid class
         WoWGuid m_wowGuid;
 
@@ -926,6 +937,12 @@ class SERVER_DECL Object : public EventableObject, public IUpdatable
         /// True if object was updated
         bool m_objectUpdated;
 
+        /// Increased by every change of a field, direct writes to the fields of an object in world have to increase it too
+        uint32 m_valuesGeneration;
+
+        /// Values part of the last create block built for another player, valid while the generations match
+        ObjectCreateValues m_createValues;
+
         /// Set of Objects in range.
         ///\todo that functionality should be moved into WorldServer.
         std::set<Object*> m_objectsInRange;
@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include "ByteBuffer.h"
+#include "Server/UpdateMask.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// The values part of the update blocks of an object: block count, mask and the masked
+/// fields.
+///
+/// Create blocks for other players are the same for every observer except for the dynamic
+/// field, the loot/tag state of creatures or the quest sparkles of gameobjects. The block
+/// built for one observer is kept together with the field generation of the object and
+/// appended for the next observers while the generation is the same. The dynamic field is
+/// always part of it, so an observer seeing another value gets a 4 byte patch.
+//////////////////////////////////////////////////////////////////////////////////////////
+class ObjectCreateValues
+{
+    public:
+
+        ObjectCreateValues() : m_generation(0), m_dynamicOffset(0) {}
+
+        /// Writes the fields of updateMask. If dynamicIndex is not 0 the field is written with
+        /// dynamicValue instead of its stored value, its bit has to be set in updateMask.
+        static void writeValues(ByteBuffer* data, const UpdateMask* updateMask, uint32_t* values, uint32_t valuesCount, uint32_t dynamicIndex = 0, uint32_t dynamicValue = 0)
+        {
+            ARCEMU_ASSERT(updateMask && updateMask->GetCount() == valuesCount);
+
+            const uint32_t oldValue = values[dynamicIndex];
+            if (dynamicIndex != 0)
+                values[dynamicIndex] = dynamicValue;
+
+            uint32_t bc;
+            if (valuesCount > (2 * 0x20))    //if number of blocks > 2->  unit and player+item container
+                bc = updateMask->GetUpdateBlockCount();
+            else
+                bc = updateMask->GetBlockCount();
+
+            *data << (uint8_t)bc;
+            data->append(updateMask->GetMask(), bc * 4);
+
+            // copy the set fields a few mask words at a time instead of testing every bit
+            uint32_t gathered[8 * 32];
+            for (uint32_t block = 0; block < bc; block += 8)
+            {
+                const uint32_t count = UpdateMaskKernels::gatherValues(updateMask->GetBlocks() + block, std::min<uint32_t>(8, bc - block), values + block * 32, gathered);
+                data->append(reinterpret_cast<const uint8_t*>(gathered), count * 4);
+            }
+
+            if (dynamicIndex != 0)
+                values[dynamicIndex] = oldValue;
+        }
+
+        /// Appends the values of a create block for another player, from the cache if generation
+        /// is the one it was built with. setCreateBits(updateMask) marks the fields of the block.
+        /// Returns true for a cached block.
+        template <typename SetCreateBits>
+        bool appendCreateValues(ByteBuffer* data, uint32_t* values, uint32_t valuesCount, uint32_t generation, uint32_t dynamicIndex, SetCreateBits setCreateBits)
+        {
+            if (!m_block.empty() && m_generation == generation)
+            {
+                data->append(&m_block[0], m_block.size());
+                return true;
+            }
+
+            const size_t start = data->wpos();
+
+            UpdateMask updateMask;
+            updateMask.SetCount(valuesCount);
+            setCreateBits(&updateMask);
+
+            // the dynamic field is always sent, that way every observer only needs its value patched
+            if (dynamicIndex != 0)
+                updateMask.SetBit(dynamicIndex);
+
+            writeValues(data, &updateMask, values, valuesCount);
+
+            m_block.assign(data->contents() + start, data->contents() + data->wpos());
+            m_generation = generation;
+
+            // block count, mask, then one value per set bit
+            m_dynamicOffset = 1 + m_block[0] * 4 + updateMask.GetSetBitCountBelow(dynamicIndex) * 4;
+            return false;
+        }
+
+        /// overwrites the dynamic field of the block appended at start
+        void patchDynamicValue(ByteBuffer* data, size_t start, uint32_t value) const
+        {
+            data->put<uint32_t>(start + m_dynamicOffset, value);
+        }
+
+        size_t getSize() const { return m_block.size(); }
+
+        void clear() { std::vector<uint8_t>().swap(m_block); }
+
+    private:
+
+        std::vector<uint8_t> m_block;
+        uint32_t m_generation;
+        size_t m_dynamicOffset;
+};
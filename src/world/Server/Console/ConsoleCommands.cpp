@@ -29,6 +29,9 @@
 #include "crc32.h"
 #include "Server/World.h"
 #include "Server/World.Legacy.h"
+#include "Map/MapObjectPool.h"
+#include "Map/MapTickScheduler.h"
+#include "Map/MapTickBenchmark.h"
 #include "../../../scripts/Common/Base.h"
 
 bool HandleTimeDateCommand(BaseConsole* console, int argc, const char* argv[])
@@ -400,3 +403,313 @@ bool HandleScriptEngineReloadCommand(BaseConsole*, int, const char*[])
     sScriptMgr.ReloadScriptEngines();
     return true;
 }
+
+bool HandleHookStatsCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1)
+    {
+        if (!stricmp(argv[1], "on"))
+        {
+            sScriptMgr.SetHookProfiling(true);
+            pConsole->Write("Server hook profiling enabled.\r\n");
+        }
+        else if (!stricmp(argv[1], "off"))
+        {
+            sScriptMgr.SetHookProfiling(false);
+            pConsole->Write("Server hook profiling disabled.\r\n");
+        }
+        else if (!stricmp(argv[1], "reset"))
+        {
+            sScriptMgr.ResetHookStats();
+            pConsole->Write("Server hook counters reset.\r\n");
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    pConsole->Write("Server hook profiling is %s.\r\n", sScriptMgr.IsHookProfiling() ? "enabled" : "disabled");
+    for (auto& line : sScriptMgr.DumpHookStats())
+        pConsole->Write("%s\r\n", line.c_str());
+
+    return true;
+}
+
+bool HandleMapTickStatsCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1)
+    {
+        if (stricmp(argv[1], "reset"))
+            return false;
+
+        sMapTickScheduler.resetStats();
+        pConsole->Write("Map tick histograms reset.\r\n");
+        return true;
+    }
+
+    pConsole->Write("%u map update workers. Times in ms, p50/p99 are bucket limits.\r\n", sMapTickScheduler.getWorkerCount());
+    pConsole->Write("  Map | Instance | Interval |    Ticks | Tick avg/p50/p99/max      | Late avg/p50/p99/max\r\n");
+
+    sMapTickScheduler.visitStats([pConsole](const MapTickStats& stats)
+    {
+        const MapTickHistogram& duration = *stats.duration;
+        const MapTickHistogram& lateness = *stats.lateness;
+        const uint64_t ticks = duration.getCount();
+
+        pConsole->Write("%5u | %8u | %8u | %8llu | %5.1f %5.1f %5.1f %6.1f | %5.1f %5.1f %5.1f %6.1f\r\n",
+            stats.mapId, stats.instanceId, stats.tickInterval, static_cast<unsigned long long>(ticks),
+            ticks ? duration.getTotal() / 1000.0f / ticks : 0.0f, duration.getPercentile(50) / 1000.0f, duration.getPercentile(99) / 1000.0f, duration.getMax() / 1000.0f,
+            ticks ? lateness.getTotal() / 1000.0f / ticks : 0.0f, lateness.getPercentile(50) / 1000.0f, lateness.getPercentile(99) / 1000.0f, lateness.getMax() / 1000.0f);
+    });
+
+    return true;
+}
+
+bool HandleMapPoolStatsCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1)
+    {
+        if (stricmp(argv[1], "reset"))
+            return false;
+
+        sMapTickScheduler.resetPoolStats();
+        MapObjectPool::getUnmappedStats().reset();
+        pConsole->Write("Map pool counters reset.\r\n");
+        return true;
+    }
+
+    pConsole->Write("%u pool caches, %llu KB reserved. Live objects:", MapObjectPool::getCacheCount(),
+        static_cast<unsigned long long>(MapObjectPool::getReservedBytes() / 1024));
+    for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+        pConsole->Write(" %s %llu", MapObjectPool::getTypeName(MapPoolType(i)), static_cast<unsigned long long>(MapObjectPool::getLiveCount(MapPoolType(i))));
+
+    pConsole->Write("\r\nAllocations/frees since the last reset, rate in allocations per second.\r\n");
+
+    const auto writeStats = [pConsole](const char* mapName, uint32_t instanceId, const MapPoolStats& pools)
+    {
+        const uint32_t seconds = std::max<uint32_t>(1, getMSTimeDiff(pools.getResetTime(), getMSTime()) / 1000);
+
+        pConsole->Write("%5s | %8u |", mapName, instanceId);
+        for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+        {
+            const MapPoolType type = MapPoolType(i);
+            pConsole->Write(" %s %llu/%llu (%.1f/s)", MapObjectPool::getTypeName(type), static_cast<unsigned long long>(pools.getAllocations(type)),
+                static_cast<unsigned long long>(pools.getFrees(type)), pools.getAllocations(type) / float(seconds));
+        }
+
+        pConsole->Write("\r\n");
+    };
+
+    writeStats("none", 0, MapObjectPool::getUnmappedStats());
+
+    sMapTickScheduler.visitStats([&writeStats](const MapTickStats& stats)
+    {
+        char mapName[16];
+        snprintf(mapName, sizeof(mapName), "%u", stats.mapId);
+        writeStats(mapName, stats.instanceId, *stats.pools);
+    });
+
+    return true;
+}
+
+bool HandleCreateCacheStatsCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1)
+    {
+        if (stricmp(argv[1], "reset"))
+            return false;
+
+        sMapTickScheduler.resetCreateCacheStats();
+        pConsole->Write("Create block cache counters reset.\r\n");
+        return true;
+    }
+
+    pConsole->Write("Create blocks for other players, hits reuse the cached values of the object.\r\n");
+    pConsole->Write("  Map | Instance |     Hits |   Misses | Hit rate | Reused KB\r\n");
+
+    sMapTickScheduler.visitStats([pConsole](const MapTickStats& stats)
+    {
+        const CreateBlockCacheStats& cache = *stats.createCache;
+        const uint64_t total = cache.getHits() + cache.getMisses();
+
+        pConsole->Write("%5u | %8u | %8llu | %8llu | %7.1f%% | %9llu\r\n", stats.mapId, stats.instanceId,
+            static_cast<unsigned long long>(cache.getHits()), static_cast<unsigned long long>(cache.getMisses()),
+            total ? cache.getHits() * 100.0f / total : 0.0f, static_cast<unsigned long long>(cache.getReusedBytes() / 1024));
+    });
+
+    return true;
+}
+
+bool HandleMovementStatsCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1)
+    {
+        if (stricmp(argv[1], "reset"))
+            return false;
+
+        Movement::BroadcastStats::reset();
+        pConsole->Write("Movement broadcast counters reset.\r\n");
+        return true;
+    }
+
+    const float seconds = std::max<uint32_t>(1, GetMSTimeDiffToNow(Movement::BroadcastStats::getResetTime()) / 1000);
+    const uint32_t players = std::max<uint32_t>(1, sWorld.getPlayerCount());
+
+    const uint64_t sentBytes = Movement::BroadcastStats::getSentBytes();
+    const uint64_t skippedBytes = Movement::BroadcastStats::getSkippedBytes();
+
+    pConsole->Write("Movement LOD is %s, heartbeat coalescing is %s.\r\n", worldConfig.movement.isLodEnabled ? "enabled" : "disabled",
+        worldConfig.movement.isHeartbeatCoalescingEnabled ? "enabled" : "disabled");
+    pConsole->Write("Sent:      %llu packets, %llu bytes (%.1f bytes/s, %.1f bytes/s per player)\r\n",
+        static_cast<unsigned long long>(Movement::BroadcastStats::getSentPackets()), static_cast<unsigned long long>(sentBytes),
+        sentBytes / seconds, sentBytes / seconds / players);
+    pConsole->Write("Skipped:   %llu packets, %llu bytes (%.1f%% of all movement bytes)\r\n",
+        static_cast<unsigned long long>(Movement::BroadcastStats::getSkippedPackets()), static_cast<unsigned long long>(skippedBytes),
+        sentBytes + skippedBytes ? skippedBytes * 100.0f / (sentBytes + skippedBytes) : 0.0f);
+    pConsole->Write("Coalesced: %llu heartbeats\r\n", static_cast<unsigned long long>(Movement::BroadcastStats::getCoalesced()));
+
+    return true;
+}
+
+bool HandleProfilerCommand(BaseConsole* pConsole, int argc, const char* argv[])
+{
+    if (argc > 1 && !stricmp(argv[1], "on"))
+    {
+        TickProfiler::setEnabled(true);
+        pConsole->Write("Profiler enabled.\r\n");
+        return true;
+    }
+
+    if (argc > 1 && !stricmp(argv[1], "off"))
+    {
+        TickProfiler::setEnabled(false);
+        pConsole->Write("Profiler disabled.\r\n");
+        return true;
+    }
+
+    if (argc > 1 && !stricmp(argv[1], "reset"))
+    {
+        sMapTickScheduler.resetProfileStats();
+        WorldSession::getUnmappedOpcodeProfile().reset();
+        WorldDatabase.ResetSyncQueryProfile();
+        CharacterDatabase.ResetSyncQueryProfile();
+        pConsole->Write("Profiler counters reset.\r\n");
+        return true;
+    }
+
+    if (argc > 1 && !stricmp(argv[1], "trace"))
+    {
+        if (argc < 3)
+            return false;
+
+        sMapTickScheduler.setSlowTickThreshold(atoi(argv[2]));
+        pConsole->Write("Ticks taking at least %u ms are traced.\r\n", sMapTickScheduler.getSlowTickThreshold());
+        return true;
+    }
+
+    if (argc > 1 && !stricmp(argv[1], "opcodes"))
+    {
+        if (argc < 3 || (stricmp(argv[2], "total") && stricmp(argv[2], "max")))
+            return false;
+
+        const bool byMax = !stricmp(argv[2], "max");
+        const size_t count = argc > 3 ? std::max(1, atoi(argv[3])) : 10;
+        const bool filterMap = argc > 4;
+        const uint32_t filterMapId = filterMap ? atoi(argv[4]) : 0;
+
+        struct OpcodeTime
+        {
+            int64_t mapId;      // -1 outside of maps
+            uint32_t instanceId;
+            uint32_t opcode;
+            uint64_t count;
+            uint64_t total;
+            uint64_t max;
+        };
+
+        std::vector<OpcodeTime> times;
+        const auto addTimes = [&times](int64_t mapId, uint32_t instanceId, const ProfileCounterTable& opcodes)
+        {
+            if (!opcodes.isUsed())
+                return;
+
+            for (uint32_t i = 0; i < opcodes.size(); ++i)
+            {
+                const ProfileCounter counter = opcodes.getSum(i);
+                if (counter.getCount() != 0)
+                    times.push_back({ mapId, instanceId, i, counter.getCount(), counter.getTotal(), counter.getMax() });
+            }
+        };
+
+        if (!filterMap)
+            addTimes(-1, 0, WorldSession::getUnmappedOpcodeProfile());
+
+        sMapTickScheduler.visitStats([&addTimes, filterMap, filterMapId](const MapTickStats& stats)
+        {
+            if (!filterMap || stats.mapId == filterMapId)
+                addTimes(stats.mapId, stats.instanceId, *stats.opcodeProfile);
+        });
+
+        std::sort(times.begin(), times.end(), [byMax](const OpcodeTime& a, const OpcodeTime& b)
+        {
+            return byMax ? a.max > b.max : a.total > b.total;
+        });
+
+        pConsole->Write("Slowest opcode handlers by %s time, times in ms.\r\n", byMax ? "max" : "total");
+        pConsole->Write("  Map | Instance |    Calls |     Total |    Avg |    Max | Opcode\r\n");
+
+        for (size_t i = 0; i < times.size() && i < count; ++i)
+        {
+            const OpcodeTime& time = times[i];
+
+            char mapName[16];
+            if (time.mapId < 0)
+                snprintf(mapName, sizeof(mapName), "none");
+            else
+                snprintf(mapName, sizeof(mapName), "%u", static_cast<uint32_t>(time.mapId));
+
+            pConsole->Write("%5s | %8u | %8llu | %9.1f | %6.3f | %6.1f | %s\r\n", mapName, time.instanceId, static_cast<unsigned long long>(time.count),
+                time.total / 1000000.0f, time.total / 1000000.0f / time.count, time.max / 1000000.0f, getOpcodeName(time.opcode).c_str());
+        }
+
+        return true;
+    }
+
+    if (argc > 1)
+        return false;
+
+    pConsole->Write("Profiler is %s, ticks taking at least %u ms are traced (0 = none).\r\n", TickProfiler::isEnabled() ? "enabled" : "disabled",
+        sMapTickScheduler.getSlowTickThreshold());
+
+    const auto writeQueries = [pConsole](const char* name, const ProfileCounter& queries)
+    {
+        pConsole->Write("%s database: %llu queries waited for, %.1f ms total, %.1f ms max\r\n", name, static_cast<unsigned long long>(queries.getCount()),
+            queries.getTotal() / 1000000.0f, queries.getMax() / 1000000.0f);
+    };
+
+    writeQueries("World", WorldDatabase.GetSyncQueryProfile());
+    writeQueries("Character", CharacterDatabase.GetSyncQueryProfile());
+
+    pConsole->Write("Map update phases, avg/max ms per tick:\r\n");
+
+    sMapTickScheduler.visitStats([pConsole](const MapTickStats& stats)
+    {
+        if (!stats.phaseProfile->isUsed() || stats.phaseProfile->getSum(MAP_TICK_PHASE_EVENTS).getCount() == 0)
+            return;
+
+        pConsole->Write("%5u | %8u |", stats.mapId, stats.instanceId);
+        for (uint8_t i = 0; i < MAP_TICK_PHASE_COUNT; ++i)
+        {
+            const ProfileCounter phase = stats.phaseProfile->getSum(i);
+            pConsole->Write(" %s %.2f/%.1f", MapTickPhaseTimes::getPhaseName(MapTickPhase(i)),
+                phase.getCount() ? phase.getTotal() / 1000000.0f / phase.getCount() : 0.0f, phase.getMax() / 1000000.0f);
+        }
+
+        pConsole->Write("\r\n");
+    });
+
+    return true;
+}
@@ -42,5 +42,11 @@ bool HandleRevivePlayer(BaseConsole* pConsole, int argc, const char* argv[]);
 bool HandleClearConsoleCommand(BaseConsole* pConsole, int argc, const char* argv[]);
 bool HandleScriptEngineReloadCommand(BaseConsole*, int argc, const char* []);
 bool HandleTimeDateCommand(BaseConsole* console, int argc, const char* argv[]);
+bool HandleHookStatsCommand(BaseConsole* pConsole, int argc, const char* argv[]);
+bool HandleMapTickStatsCommand(BaseConsole* pConsole, int argc, const char* argv[]);
+bool HandleMapPoolStatsCommand(BaseConsole* pConsole, int argc, const char* argv[]);
+bool HandleCreateCacheStatsCommand(BaseConsole* pConsole, int argc, const char* argv[]);
+bool HandleMovementStatsCommand(BaseConsole* pConsole, int argc, const char* argv[]);
+bool HandleProfilerCommand(BaseConsole* pConsole, int argc, const char* argv[]);
 
 #endif // _CONSOLECOMMANDS_H
@@ -483,6 +483,36 @@ void HandleConsoleInput(BaseConsole* pConsole, const char* szInput)
             "datetime", "<NULL>",
             "Shows time and date according to localtime()"
         },
+        {
+            &HandleHookStatsCommand,
+            "hookstats", "[on|off|reset]",
+            "Shows calls and time spent per server hook and script library."
+        },
+        {
+            &HandleMapTickStatsCommand,
+            "maptickstats", "[reset]",
+            "Shows tick duration and lateness histograms of all maps and instances."
+        },
+        {
+            &HandleMapPoolStatsCommand,
+            "mappoolstats", "[reset]",
+            "Shows spell, aura, proc and event allocations per map and the pool usage."
+        },
+        {
+            &HandleCreateCacheStatsCommand,
+            "createcachestats", "[reset]",
+            "Shows the hit rate of the cached object create blocks per map."
+        },
+        {
+            &HandleMovementStatsCommand,
+            "movementstats", "[reset]",
+            "Shows bytes sent for player movement and the savings of the movement LOD."
+        },
+        {
+            &HandleProfilerCommand,
+            "profiler", "[on|off|reset|trace <ms>|opcodes <total|max> [count] [map]]",
+            "Shows the map update phases and the slowest opcode handlers timed by the profiler."
+        },
         { 
             NULL, 
             NULL, NULL, 
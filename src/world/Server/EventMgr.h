@@ -25,6 +25,7 @@
 #include "Threading/AtomicCounter.h"
 #include "CallBack.h"
 #include "Singleton.h"
+#include "Map/MapObjectPool.h"
 #include <map>
 
 enum EventTypes
@@ -272,6 +273,8 @@ struct SERVER_DECL TimedEvent
 
     static TimedEvent* Allocate(void* object, CallbackBase* callback, uint32 flags, time_t time, uint32 repeat);
 
+    MAP_POOLED_OBJECT(MAP_POOL_TIMED_EVENT)
+
 
     void DecRef()
     {
@@ -421,6 +424,16 @@ class SERVER_DECL EventMgr : public Singleton < EventMgr >
             holderLock.ReleaseWriteLock();
         }
 
+        /// calls func for every event holder, holders are not removed while it runs
+        template <typename Func>
+        void VisitEventHolders(Func func)
+        {
+            holderLock.AcquireReadLock();
+            for (HolderMap::iterator itr = mHolders.begin(); itr != mHolders.end(); ++itr)
+                func(itr->second);
+            holderLock.ReleaseReadLock();
+        }
+
     protected:
 
         HolderMap mHolders;
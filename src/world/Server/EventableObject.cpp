@@ -418,6 +418,8 @@ void EventableObjectHolder::Update(time_t time_difference)
         }
     }
 
+    m_eventCount.set(m_events.size());
+
     m_lock.Release();
 }
 
@@ -23,6 +23,7 @@
 
 #include "EventMgr.h"
 #include "../shared/Util.hpp"
+#include "Metrics/Metrics.hpp"
 #include <list>
 #include <set>
 
@@ -106,9 +107,13 @@ class EventableObjectHolder
 
         uint32 GetInstanceID() { return mInstanceId; }
 
+        /// events after the last Update, read by the metrics without locking
+        uint32 GetEventCount() const { return static_cast<uint32>(m_eventCount.get()); }
+
     protected:
 
         int32 mInstanceId;
+        MetricGauge m_eventCount;
         Mutex m_lock;
         EventList m_events;
 
@@ -30,6 +30,9 @@
 #include "Storage/DayWatcherThread.h"
 #include "Management/Channel.h"
 #include "Management/ChannelMgr.h"
+#include "Map/MapTickBenchmark.h"
+#include "Server/WorldMetrics.h"
+#include "Metrics/MetricsExporter.hpp"
 
 createFileSingleton(Master);
 std::string LogFileName;
@@ -211,6 +214,12 @@ bool Master::Run(int argc, char** argv)
     AscLog.SetFileLoggingLevel(worldConfig.log.worldFileLogLevel);
     AscLog.SetDebugFlags(worldConfig.log.worldDebugFlags);
 
+    if (worldConfig.log.asyncFileLog)
+    {
+        const LogOverflowPolicy overflowPolicy = worldConfig.log.asyncFileLogDropWhenFull ? LOG_OVERFLOW_DROP : LOG_OVERFLOW_BLOCK;
+        AscLog.StartAsyncFileWriter(overflowPolicy, uint64_t(worldConfig.log.logRotationSizeMb) * 1024 * 1024);
+    }
+
     OpenCheatLogFiles();
 
     if (!_StartDB())
@@ -254,6 +263,9 @@ bool Master::Run(int argc, char** argv)
 
     sWorld.setWorldStartTime((uint32)UNIXTIME);
 
+    if (worldConfig.tickBenchmark.isEnabled)
+        return _RunTickBenchmark();
+
     WorldRunnable* wr = new WorldRunnable();
     ThreadPool.ExecuteTask(wr);
 
@@ -278,6 +290,10 @@ bool Master::Run(int argc, char** argv)
 
     StartRemoteConsole();
 
+    new MetricsExporter;
+    registerWorldMetrics();
+    sMetricsExporter.startup(Config.MainConfig, "Metrics");
+
     WritePidFile();
 
     if (!ChannelMgr::getSingletonPtr())
@@ -348,6 +364,7 @@ bool Master::Run(int argc, char** argv)
     cs = NULL;
 
     CloseConsoleListener();
+    sMetricsExporter.shutdown();
     sWorld.saveAllPlayersToDb();
 
     LogNotice("Network : Shutting down network subsystem.");
@@ -362,6 +379,7 @@ bool Master::Run(int argc, char** argv)
     sWorld.logoutAllPlayers();
 
     delete LogonCommHandler::getSingletonPtr();
+    delete MetricsExporter::getSingletonPtr();
 
     LogNotice("AddonMgr : ~AddonMgr()");
     sAddonMgr.SaveToDB();
@@ -541,6 +559,29 @@ bool Master::_StartDB()
     return true;
 }
 
+bool Master::_RunTickBenchmark()
+{
+    // creature AI and instance scripts of the benchmarked map
+    sScriptMgr.LoadScripts();
+
+    MapTickBenchmark benchmark;
+    const bool result = benchmark.run();
+
+    // the synthetic players are never saved or logged out, only the pending queries are finished
+    CharacterDatabase.EndThreads();
+    WorldDatabase.EndThreads();
+
+    dw->terminate();
+    dw = NULL;
+    cs->terminate();
+    cs = NULL;
+
+    LogDetail("Shutdown : Tick benchmark finished.");
+    AscLog.~AscEmuLog();
+
+    return result;
+}
+
 void Master::_StopDB()
 {
     if (Database_World != NULL)
@@ -56,6 +56,9 @@ class Master : public Singleton<Master>
         void _StopDB();
         bool _CheckDBVersion();
 
+        /// runs the map tick benchmark of world.conf instead of the world server
+        bool _RunTickBenchmark();
+
         void _HookSignals();
         void _UnhookSignals();
 
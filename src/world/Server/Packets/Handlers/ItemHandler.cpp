@@ -2283,6 +2283,7 @@ void WorldSession::HandleWrapItemOpcode(WorldPacket& recv_data)
     // change the dest item's entry
     dst->wrapped_item_id = dst->GetEntry();
     dst->SetEntry(itemid);
+    _player->GetItemInterface()->invalidateItemIndex();
 
     // set the giftwrapper fields
     dst->SetGiftCreatorGUID(_player->GetGUID());
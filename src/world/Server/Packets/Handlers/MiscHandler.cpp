@@ -2577,6 +2577,7 @@ void WorldSession::HandleOpenItemOpcode(WorldPacket& recv_data)
         pItem->SetEntry(pItem->wrapped_item_id);
         pItem->wrapped_item_id = 0;
         pItem->SetItemProperties(it);
+        _player->GetItemInterface()->invalidateItemIndex();
 
         if (it->Bonding == ITEM_BIND_ON_PICKUP)
             pItem->SoulBind();
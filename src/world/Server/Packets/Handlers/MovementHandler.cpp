@@ -512,6 +512,7 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
     /* Calculate the timestamp of the packet we have to send out            */
     /************************************************************************/
     size_t pos = (size_t)m_MoverWoWGuid.GetNewGuidLen() + 1;
+    const size_t packet_size = recv_data.size() + pos;
     uint32 mstime = mTimeStamp();
     int32 move_time;
     if (m_clientTimeDelay == 0)
@@ -523,21 +524,44 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
     if (_player->m_inRangePlayers.size())
     {
         move_time = (movement_info.time - (mstime - m_clientTimeDelay)) + MOVEMENT_PACKET_TIME_DELAY + mstime;
-        memcpy(&movement_packet[0], recv_data.contents(), recv_data.size());
-        movement_packet[pos + 6] = 0;
 
-        /************************************************************************/
-        /* Distribute to all inrange players.                                   */
-        /************************************************************************/
-        for (std::set<Object*>::iterator itr = _player->m_inRangePlayers.begin(); itr != _player->m_inRangePlayers.end(); ++itr)
+        if (recv_data.GetOpcode() == MSG_MOVE_HEARTBEAT && worldConfig.movement.isHeartbeatCoalescingEnabled && packet_size <= sizeof(m_pendingHeartbeat.packet))
         {
+            /************************************************************************/
+            /* Only the last heartbeat of this update is sent, see Update.          */
+            /************************************************************************/
+            if (m_pendingHeartbeat.size != 0)
+                Movement::BroadcastStats::addCoalesced();
+
+            memcpy(&m_pendingHeartbeat.packet[0], recv_data.contents(), recv_data.size());
+            m_pendingHeartbeat.packet[pos + 6] = 0;
+            m_pendingHeartbeat.size = uint16(packet_size);
+            m_pendingHeartbeat.timeOffset = uint16(pos + 6);
+            m_pendingHeartbeat.moveTime = move_time;
+            m_pendingHeartbeat.moverGuid = mover->GetGUID();
+            m_pendingHeartbeat.position = movement_info.position;
+        }
+        else
+        {
+            // this packet carries a newer position than a queued heartbeat
+            if (m_pendingHeartbeat.size != 0)
+            {
+                Movement::BroadcastStats::addCoalesced();
+                m_pendingHeartbeat.size = 0;
+            }
 
-            Player* p = static_cast< Player* >((*itr));
-
-            *(uint32*)&movement_packet[pos + 6] = uint32(move_time + p->GetSession()->m_moveDelayTime);
-
-            p->GetSession()->OutPacket(recv_data.GetOpcode(), uint16(recv_data.size() + pos), movement_packet);
-
+            // the packet sent out is read from the buffer up to packet_size
+            if (packet_size <= sizeof(movement_packet))
+            {
+                memcpy(&movement_packet[0], recv_data.contents(), recv_data.size());
+                movement_packet[pos + 6] = 0;
+
+                /************************************************************************/
+                /* Distribute to all inrange players.                                   */
+                /************************************************************************/
+                _BroadcastMovement(recv_data.GetOpcode(), movement_packet, uint16(packet_size), pos + 6, move_time,
+                    movement_info.position.x, movement_info.position.y, recv_data.GetOpcode() == MSG_MOVE_HEARTBEAT);
+            }
         }
     }
 
@@ -749,6 +773,56 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
 }
 #endif
 
+void WorldSession::_BroadcastMovement(uint16 opcode, uint8* packet, uint16 size, size_t timeOffset, int32 moveTime, float x, float y, bool heartbeat)
+{
+    if (heartbeat)
+        m_movementLod.beginHeartbeat(m_currMsTime);
+    else
+        m_movementLod.beginStateChange(m_currMsTime);
+
+    // 2 byte size + 2 byte opcode
+    const uint64 packetBytes = size + 4;
+
+    uint32 sentPackets = 0;
+    uint32 skippedPackets = 0;
+    for (std::set<Object*>::iterator itr = _player->m_inRangePlayers.begin(); itr != _player->m_inRangePlayers.end(); ++itr)
+    {
+        Player* p = static_cast<Player*>(*itr);
+
+        if (heartbeat && !m_movementLod.isDue(Movement::BroadcastLod::getTier(p->GetPositionNC().Distance2DSq(x, y))))
+        {
+            ++skippedPackets;
+            continue;
+        }
+
+        *(uint32*)&packet[timeOffset] = uint32(moveTime + p->GetSession()->m_moveDelayTime);
+
+        p->GetSession()->OutPacket(opcode, size, packet);
+        ++sentPackets;
+    }
+
+    Movement::BroadcastStats::add(sentPackets, sentPackets * packetBytes, skippedPackets, skippedPackets * packetBytes);
+}
+
+void WorldSession::_FlushPendingHeartbeat()
+{
+    if (m_pendingHeartbeat.size == 0)
+        return;
+
+    m_pendingHeartbeat.size = 0;
+
+    if (_player == nullptr || !_player->IsInWorld() || _player->m_inRangePlayers.empty())
+        return;
+
+    // a teleport after the heartbeat made it outdated, transports move their passengers a bit
+    Unit* mover = _player->GetMapMgr()->GetUnit(m_pendingHeartbeat.moverGuid);
+    if (mover == nullptr || mover->GetPositionNC().Distance2DSq(m_pendingHeartbeat.position.x, m_pendingHeartbeat.position.y) > 100.0f)
+        return;
+
+    _BroadcastMovement(MSG_MOVE_HEARTBEAT, m_pendingHeartbeat.packet, m_pendingHeartbeat.size, m_pendingHeartbeat.timeOffset,
+        m_pendingHeartbeat.moveTime, m_pendingHeartbeat.position.x, m_pendingHeartbeat.position.y, true);
+}
+
 void WorldSession::HandleMoveTimeSkippedOpcode(WorldPacket& recv_data)
 {}
 
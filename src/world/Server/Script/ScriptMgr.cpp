@@ -36,11 +36,54 @@
 initialiseSingleton(ScriptMgr);
 initialiseSingleton(HookInterface);
 
-ScriptMgr::ScriptMgr()
-{}
+ScriptMgr::ScriptMgr() : m_hookTablesPublished(false), m_hookProfiling(false)
+{
+    for (uint8 i = 0; i < NUM_SERVER_HOOKS; ++i)
+        _hookTables[i].store(nullptr, std::memory_order_relaxed);
+}
 
 ScriptMgr::~ScriptMgr()
-{}
+{
+    for (uint8 i = 0; i < NUM_SERVER_HOOKS; ++i)
+        delete _hookTables[i].exchange(nullptr);
+
+    for (auto table : _retiredHookTables)
+        delete table;
+}
+
+ServerHookTable::ServerHookTable(const ServerHookTable* previous, const HookList& added)
+{
+    const size_t previousCount = previous != nullptr ? previous->size() : 0;
+    m_count = previousCount + added.size();
+    m_entries.reset(new Entry[m_count]);
+
+    for (size_t i = 0; i < previousCount; ++i)
+    {
+        const Entry& old = (*previous)[i];
+        m_entries[i].function = old.function;
+        m_entries[i].library = old.library;
+        m_entries[i].calls.store(old.calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_entries[i].timeUs.store(old.timeUs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < added.size(); ++i)
+    {
+        Entry& entry = m_entries[previousCount + i];
+        entry.function = added[i].first;
+        entry.library = added[i].second;
+        entry.calls.store(0, std::memory_order_relaxed);
+        entry.timeUs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ServerHookTable::resetCounters() const
+{
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        m_entries[i].calls.store(0, std::memory_order_relaxed);
+        m_entries[i].timeUs.store(0, std::memory_order_relaxed);
+    }
+}
 
 struct ScriptingEngine_dl
 {
@@ -61,6 +104,12 @@ void ScriptMgr::LoadScripts()
     if (HookInterface::getSingletonPtr() == NULL)
         new HookInterface;
 
+    // collect the hooks of all libraries and build every table once at the end
+    {
+        std::lock_guard<std::mutex> guard(m_hooksMutex);
+        m_hookTablesPublished = false;
+    }
+
     LogNotice("ScriptMgr : Loading External Script Libraries...");
 
     std::string Path;
@@ -158,7 +207,9 @@ void ScriptMgr::LoadScripts()
                     }
                     else
                     {
+                        m_loadingLibrary = dl->GetName();
                         rcall(this);
+                        m_loadingLibrary.clear();
                         dynamiclibs.push_back(dl);
 
                         loadmessage << "loaded";
@@ -181,12 +232,20 @@ void ScriptMgr::LoadScripts()
 
         for (std::vector< ScriptingEngine_dl >::iterator itr = Engines.begin(); itr != Engines.end(); ++itr)
         {
+            m_loadingLibrary = itr->dl->GetName();
             itr->InitializeCall(this);
+            m_loadingLibrary.clear();
             dynamiclibs.push_back(itr->dl);
         }
 
         LogDetail("ScriptMgr : Done loading scripting engine(s)...");
     }
+
+    std::lock_guard<std::mutex> guard(m_hooksMutex);
+    for (uint32 i = 0; i < NUM_SERVER_HOOKS; ++i)
+        _publishHookTable(i);
+
+    m_hookTablesPublished = true;
 }
 
 void ScriptMgr::UnloadScripts()
@@ -630,7 +689,116 @@ void InstanceScript::RemoveUpdateEvent()
 void ScriptMgr::register_hook(ServerHookEvents event, void* function_pointer)
 {
     ARCEMU_ASSERT(event < NUM_SERVER_HOOKS);
-    _hooks[event].insert(function_pointer);
+
+    std::lock_guard<std::mutex> guard(m_hooksMutex);
+    if (!_hooks[event].insert(function_pointer).second)
+        return;
+
+    _pendingHooks[event].push_back(std::make_pair(function_pointer, m_loadingLibrary.empty() ? std::string("core") : m_loadingLibrary));
+
+    // registered after loading, the table is replaced right away
+    if (m_hookTablesPublished)
+        _publishHookTable(event);
+}
+
+void ScriptMgr::_publishHookTable(uint32 event)
+{
+    if (_pendingHooks[event].empty())
+        return;
+
+    const ServerHookTable* previous = _hookTables[event].load(std::memory_order_relaxed);
+    const ServerHookTable* table = new ServerHookTable(previous, _pendingHooks[event]);
+    _hookTables[event].store(table, std::memory_order_release);
+    _pendingHooks[event].clear();
+
+    if (previous != nullptr)
+        _retiredHookTables.push_back(previous);
+}
+
+static const char* ServerHookEventNames[NUM_SERVER_HOOKS] =
+{
+    "",
+    "OnNewCharacter",
+    "OnKillPlayer",
+    "OnFirstEnterWorld",
+    "OnEnterWorld",
+    "OnGuildJoin",
+    "OnDeath",
+    "OnRepop",
+    "OnEmote",
+    "OnEnterCombat",
+    "OnCastSpell",
+    "OnTick",
+    "OnLogoutRequest",
+    "OnLogout",
+    "OnQuestAccept",
+    "OnZone",
+    "OnChat",
+    "OnLoot",
+    "OnGuildCreate",
+    "OnFullLogin",
+    "OnCharacterCreate",
+    "OnQuestCancelled",
+    "OnQuestFinished",
+    "OnHonorableKill",
+    "OnArenaFinish",
+    "OnObjectLoot",
+    "OnAreaTrigger",
+    "OnPostLevelUp",
+    "OnPreUnitDie",
+    "OnAdvanceSkillLine",
+    "OnDuelFinished",
+    "OnAuraRemove",
+    "OnResurrect"
+};
+
+void ScriptMgr::ResetHookStats()
+{
+    for (uint8 i = 0; i < NUM_SERVER_HOOKS; ++i)
+    {
+        const ServerHookTable* table = _hookTables[i].load(std::memory_order_acquire);
+        if (table != nullptr)
+            table->resetCounters();
+    }
+}
+
+std::vector<std::string> ScriptMgr::DumpHookStats() const
+{
+    struct HookStat
+    {
+        const char* event;
+        const ServerHookTable::Entry* entry;
+    };
+
+    std::vector<HookStat> stats;
+    for (uint8 i = 0; i < NUM_SERVER_HOOKS; ++i)
+    {
+        const ServerHookTable* table = _hookTables[i].load(std::memory_order_acquire);
+        if (table == nullptr)
+            continue;
+
+        for (size_t j = 0; j < table->size(); ++j)
+            stats.push_back({ ServerHookEventNames[i], &(*table)[j] });
+    }
+
+    // most expensive hooks first
+    std::sort(stats.begin(), stats.end(), [](const HookStat& a, const HookStat& b)
+    {
+        return a.entry->timeUs.load(std::memory_order_relaxed) > b.entry->timeUs.load(std::memory_order_relaxed);
+    });
+
+    std::vector<std::string> lines;
+    for (auto& stat : stats)
+    {
+        const uint64 calls = stat.entry->calls.load(std::memory_order_relaxed);
+        const uint64 timeUs = stat.entry->timeUs.load(std::memory_order_relaxed);
+
+        std::stringstream ss;
+        ss << stat.event << " [" << stat.entry->library << "] calls: " << calls << " total: " << timeUs << "us avg: " << (calls ? timeUs / calls : 0) << "us";
+        lines.push_back(ss.str());
+    }
+
+    return lines;
 }
 
 bool ScriptMgr::has_creature_script(uint32 entry) const
@@ -665,6 +833,7 @@ bool ScriptMgr::has_instance_script(uint32 id) const
 
 bool ScriptMgr::has_hook(ServerHookEvents evt, void* ptr) const
 {
+    std::lock_guard<std::mutex> guard(m_hooksMutex);
     return (_hooks[evt].size() != 0 && _hooks[evt].find(ptr) != _hooks[evt].end());
 }
 
@@ -812,262 +981,219 @@ void GossipScript::OnEnd(Object* pObject, Player* Plr)
 }
 
 /* Hook Implementations */
-bool HookInterface::OnNewCharacter(uint32 Race, uint32 Class, WorldSession* Session, const char* Name)
+namespace
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_NEW_CHARACTER];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
+    template <typename HookFunction>
+    struct HookCall
+    {
+        template <typename... Args>
+        static auto invoke(const ServerHookTable::Entry& entry, bool profile, Args... args) -> decltype(((HookFunction)nullptr)(args...))
+        {
+            if (!profile)
+                return ((HookFunction)entry.function)(args...);
+
+            struct ScopedHookTimer
+            {
+                const ServerHookTable::Entry& entry;
+                std::chrono::steady_clock::time_point start;
+
+                ~ScopedHookTimer()
+                {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                    entry.calls.fetch_add(1, std::memory_order_relaxed);
+                    entry.timeUs.fetch_add(static_cast<uint64>(elapsed.count()), std::memory_order_relaxed);
+                }
+            } timer{ entry, std::chrono::steady_clock::now() };
+
+            return ((HookFunction)entry.function)(args...);
+        }
+    };
+
+    template <typename HookFunction, typename... Args>
+    void callHooks(ServerHookEvents evt, Args... args)
+    {
+        const ServerHookTable* table = sScriptMgr.get_hook_table(evt);
+        if (table == nullptr)
+            return;
+
+        ProfileScope tickProfile(ServerHookEventNames[evt], PROFILE_CATEGORY_HOOK, evt);
+        const bool profile = sScriptMgr.IsHookProfiling();
+        for (size_t i = 0; i < table->size(); ++i)
+            HookCall<HookFunction>::invoke((*table)[i], profile, args...);
+    }
+
+    // every hook is called, the result is false once any of them returned false
+    template <typename HookFunction, typename... Args>
+    bool callHooksWithResult(ServerHookEvents evt, Args... args)
     {
-        bool rv = ((tOnNewCharacter)* itr)(Race, Class, Session, Name);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
+        const ServerHookTable* table = sScriptMgr.get_hook_table(evt);
+        if (table == nullptr)
+            return true;
+
+        ProfileScope tickProfile(ServerHookEventNames[evt], PROFILE_CATEGORY_HOOK, evt);
+        const bool profile = sScriptMgr.IsHookProfiling();
+        bool ret_val = true;
+        for (size_t i = 0; i < table->size(); ++i)
+        {
+            if (!HookCall<HookFunction>::invoke((*table)[i], profile, args...))
+                ret_val = false;
+        }
+        return ret_val;
     }
-    return ret_val;
+}
+
+bool HookInterface::OnNewCharacter(uint32 Race, uint32 Class, WorldSession* Session, const char* Name)
+{
+    return callHooksWithResult<tOnNewCharacter>(SERVER_HOOK_EVENT_ON_NEW_CHARACTER, Race, Class, Session, Name);
 }
 
 void HookInterface::OnKillPlayer(Player* pPlayer, Player* pVictim)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_KILL_PLAYER];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnKillPlayer)*itr)(pPlayer, pVictim);
+    callHooks<tOnKillPlayer>(SERVER_HOOK_EVENT_ON_KILL_PLAYER, pPlayer, pVictim);
 }
 
 void HookInterface::OnFirstEnterWorld(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_FIRST_ENTER_WORLD];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnFirstEnterWorld)*itr)(pPlayer);
+    callHooks<tOnFirstEnterWorld>(SERVER_HOOK_EVENT_ON_FIRST_ENTER_WORLD, pPlayer);
 }
 
 void HookInterface::OnCharacterCreate(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_CHARACTER_CREATE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOCharacterCreate)*itr)(pPlayer);
+    callHooks<tOCharacterCreate>(SERVER_HOOK_EVENT_ON_CHARACTER_CREATE, pPlayer);
 }
 
 void HookInterface::OnEnterWorld(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_ENTER_WORLD];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnEnterWorld)*itr)(pPlayer);
+    callHooks<tOnEnterWorld>(SERVER_HOOK_EVENT_ON_ENTER_WORLD, pPlayer);
 }
 
 void HookInterface::OnGuildCreate(Player* pLeader, Guild* pGuild)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_GUILD_CREATE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnGuildCreate)*itr)(pLeader, pGuild);
+    callHooks<tOnGuildCreate>(SERVER_HOOK_EVENT_ON_GUILD_CREATE, pLeader, pGuild);
 }
 
 void HookInterface::OnGuildJoin(Player* pPlayer, Guild* pGuild)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_GUILD_JOIN];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnGuildJoin)*itr)(pPlayer, pGuild);
+    callHooks<tOnGuildJoin>(SERVER_HOOK_EVENT_ON_GUILD_JOIN, pPlayer, pGuild);
 }
 
 void HookInterface::OnDeath(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_DEATH];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnDeath)*itr)(pPlayer);
+    callHooks<tOnDeath>(SERVER_HOOK_EVENT_ON_DEATH, pPlayer);
 }
 
 bool HookInterface::OnRepop(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_REPOP];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnRepop)* itr)(pPlayer);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnRepop>(SERVER_HOOK_EVENT_ON_REPOP, pPlayer);
 }
 
 void HookInterface::OnEmote(Player* pPlayer, uint32 Emote, Unit* pUnit)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_EMOTE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnEmote)*itr)(pPlayer, Emote, pUnit);
+    callHooks<tOnEmote>(SERVER_HOOK_EVENT_ON_EMOTE, pPlayer, Emote, pUnit);
 }
 
 void HookInterface::OnEnterCombat(Player* pPlayer, Unit* pTarget)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_ENTER_COMBAT];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnEnterCombat)*itr)(pPlayer, pTarget);
+    callHooks<tOnEnterCombat>(SERVER_HOOK_EVENT_ON_ENTER_COMBAT, pPlayer, pTarget);
 }
 
 bool HookInterface::OnCastSpell(Player* pPlayer, SpellInfo* pSpell, Spell* spell)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_CAST_SPELL];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnCastSpell)* itr)(pPlayer, pSpell, spell);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnCastSpell>(SERVER_HOOK_EVENT_ON_CAST_SPELL, pPlayer, pSpell, spell);
 }
 
 bool HookInterface::OnLogoutRequest(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_LOGOUT_REQUEST];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnLogoutRequest)* itr)(pPlayer);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnLogoutRequest>(SERVER_HOOK_EVENT_ON_LOGOUT_REQUEST, pPlayer);
 }
 
 void HookInterface::OnLogout(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_LOGOUT];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnLogout)*itr)(pPlayer);
+    callHooks<tOnLogout>(SERVER_HOOK_EVENT_ON_LOGOUT, pPlayer);
 }
 
 void HookInterface::OnQuestAccept(Player* pPlayer, QuestProperties const* pQuest, Object* pQuestGiver)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_QUEST_ACCEPT];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnQuestAccept)*itr)(pPlayer, pQuest, pQuestGiver);
+    callHooks<tOnQuestAccept>(SERVER_HOOK_EVENT_ON_QUEST_ACCEPT, pPlayer, pQuest, pQuestGiver);
 }
 
 void HookInterface::OnZone(Player* pPlayer, uint32 zone, uint32 oldZone)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_ZONE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnZone)*itr)(pPlayer, zone, oldZone);
+    callHooks<tOnZone>(SERVER_HOOK_EVENT_ON_ZONE, pPlayer, zone, oldZone);
 }
 
 bool HookInterface::OnChat(Player* pPlayer, uint32 type, uint32 lang, const char* message, const char* misc)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_CHAT];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnChat)* itr)(pPlayer, type, lang, message, misc);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnChat>(SERVER_HOOK_EVENT_ON_CHAT, pPlayer, type, lang, message, misc);
 }
 
 void HookInterface::OnLoot(Player* pPlayer, Unit* pTarget, uint32 money, uint32 itemId)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_LOOT];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnLoot)*itr)(pPlayer, pTarget, money, itemId);
+    callHooks<tOnLoot>(SERVER_HOOK_EVENT_ON_LOOT, pPlayer, pTarget, money, itemId);
 }
 
 void HookInterface::OnObjectLoot(Player* pPlayer, Object* pTarget, uint32 money, uint32 itemId)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_OBJECTLOOT];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnObjectLoot)*itr)(pPlayer, pTarget, money, itemId);
+    callHooks<tOnObjectLoot>(SERVER_HOOK_EVENT_ON_OBJECTLOOT, pPlayer, pTarget, money, itemId);
 }
 
 void HookInterface::OnFullLogin(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_FULL_LOGIN];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnEnterWorld)*itr)(pPlayer);
+    callHooks<tOnEnterWorld>(SERVER_HOOK_EVENT_ON_FULL_LOGIN, pPlayer);
 }
 
 void HookInterface::OnQuestCancelled(Player* pPlayer, QuestProperties const* pQuest)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_QUEST_CANCELLED];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnQuestCancel)*itr)(pPlayer, pQuest);
+    callHooks<tOnQuestCancel>(SERVER_HOOK_EVENT_ON_QUEST_CANCELLED, pPlayer, pQuest);
 }
 
 void HookInterface::OnQuestFinished(Player* pPlayer, QuestProperties const* pQuest, Object* pQuestGiver)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_QUEST_FINISHED];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnQuestFinished)*itr)(pPlayer, pQuest, pQuestGiver);
+    callHooks<tOnQuestFinished>(SERVER_HOOK_EVENT_ON_QUEST_FINISHED, pPlayer, pQuest, pQuestGiver);
 }
 
 void HookInterface::OnHonorableKill(Player* pPlayer, Player* pKilled)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_HONORABLE_KILL];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnHonorableKill)*itr)(pPlayer, pKilled);
+    callHooks<tOnHonorableKill>(SERVER_HOOK_EVENT_ON_HONORABLE_KILL, pPlayer, pKilled);
 }
 
 void HookInterface::OnArenaFinish(Player* pPlayer, ArenaTeam* pTeam, bool victory, bool rated)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_ARENA_FINISH];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnArenaFinish)*itr)(pPlayer, pTeam, victory, rated);
+    callHooks<tOnArenaFinish>(SERVER_HOOK_EVENT_ON_ARENA_FINISH, pPlayer, pTeam, victory, rated);
 }
 
 void HookInterface::OnAreaTrigger(Player* pPlayer, uint32 areaTrigger)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_AREATRIGGER];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnAreaTrigger)*itr)(pPlayer, areaTrigger);
+    callHooks<tOnAreaTrigger>(SERVER_HOOK_EVENT_ON_AREATRIGGER, pPlayer, areaTrigger);
 }
 
 void HookInterface::OnPostLevelUp(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_POST_LEVELUP];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnPostLevelUp)*itr)(pPlayer);
+    callHooks<tOnPostLevelUp>(SERVER_HOOK_EVENT_ON_POST_LEVELUP, pPlayer);
 }
 
 bool HookInterface::OnPreUnitDie(Unit* killer, Unit* victim)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_PRE_DIE];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnPreUnitDie)* itr)(killer, victim);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnPreUnitDie>(SERVER_HOOK_EVENT_ON_PRE_DIE, killer, victim);
 }
 
 
 void HookInterface::OnAdvanceSkillLine(Player* pPlayer, uint32 skillLine, uint32 current)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_ADVANCE_SKILLLINE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnAdvanceSkillLine)*itr)(pPlayer, skillLine, current);
+    callHooks<tOnAdvanceSkillLine>(SERVER_HOOK_EVENT_ON_ADVANCE_SKILLLINE, pPlayer, skillLine, current);
 }
 
 void HookInterface::OnDuelFinished(Player* Winner, Player* Looser)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_DUEL_FINISHED];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnDuelFinished)*itr)(Winner, Looser);
+    callHooks<tOnDuelFinished>(SERVER_HOOK_EVENT_ON_DUEL_FINISHED, Winner, Looser);
 }
 
 void HookInterface::OnAuraRemove(Aura* aura)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_AURA_REMOVE];
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-        ((tOnAuraRemove)*itr)(aura);
+    callHooks<tOnAuraRemove>(SERVER_HOOK_EVENT_ON_AURA_REMOVE, aura);
 }
 
 bool HookInterface::OnResurrect(Player* pPlayer)
 {
-    ServerHookList hookList = sScriptMgr._hooks[SERVER_HOOK_EVENT_ON_RESURRECT];
-    bool ret_val = true;
-    for (ServerHookList::iterator itr = hookList.begin(); itr != hookList.end(); ++itr)
-    {
-        bool rv = ((tOnResurrect)* itr)(pPlayer);
-        if (rv == false)  // never set ret_val back to true, once it's false
-            ret_val = false;
-    }
-    return ret_val;
+    return callHooksWithResult<tOnResurrect>(SERVER_HOOK_EVENT_ON_RESURRECT, pPlayer);
 }
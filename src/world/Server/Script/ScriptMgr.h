@@ -23,6 +23,7 @@
 #define SCRIPTMGR_H
 
 #include <mutex>
+#include <atomic>
 
 #include "Management/Gossip/Gossip.h"
 #include "Management/GameEventMgr.h"
@@ -158,6 +159,42 @@ typedef std::set<QuestScript*> QuestScripts;
 typedef std::set<void*> ServerHookList;
 typedef std::list< Arcemu::DynLib* > DynamicLibraryMap;
 
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Immutable, contiguous dispatch table for one ServerHookEvents value.
+/// The hooks registered while LoadScripts runs are collected and each table is built once
+/// when loading ends; it is published with an atomic pointer swap, so HookInterface
+/// iterates it without copying or locking. A hook registered later (e.g. by a LuaEngine
+/// reload) replaces the table of its event. Replaced tables stay alive until ~ScriptMgr
+/// because a dispatch on another thread may still be walking them.
+//////////////////////////////////////////////////////////////////////////////////////////
+class SERVER_DECL ServerHookTable
+{
+    public:
+
+        struct Entry
+        {
+            void* function;
+            std::string library;                // script library that registered the hook
+            mutable std::atomic<uint64> calls;
+            mutable std::atomic<uint64> timeUs; // cumulative time spent in the hook (microseconds)
+        };
+
+        typedef std::vector<std::pair<void*, std::string>> HookList;
+
+        /// the entries and counters of previous (may be NULL) followed by the added hooks
+        ServerHookTable(const ServerHookTable* previous, const HookList& added);
+
+        size_t size() const { return m_count; }
+        const Entry& operator[](size_t i) const { return m_entries[i]; }
+
+        void resetCounters() const;
+
+    private:
+
+        std::unique_ptr<Entry[]> m_entries;
+        size_t m_count;
+};
+
 #define VISIBLE_RANGE (26.46f)
 #define MAX_SCRIPTS 1000
 #define MAX_INSTANCE_SCRIPTS 1000
@@ -201,6 +238,7 @@ class SERVER_DECL ScriptMgr : public Singleton<ScriptMgr>
         void register_gossip_script(uint32 entry, GossipScript* gs);
         void register_go_gossip_script(uint32 entry, GossipScript* gs);
         void register_hook(ServerHookEvents event, void* function_pointer);
+        const ServerHookTable* get_hook_table(ServerHookEvents event) const { return _hookTables[event].load(std::memory_order_acquire); }
         void register_item_gossip_script(uint32 entry, GossipScript* gs);
         void register_quest_script(uint32 entry, QuestScript* qs);
         void register_event_script(uint32 entry, EventScript* es);
@@ -263,6 +301,18 @@ class SERVER_DECL ScriptMgr : public Singleton<ScriptMgr>
         //////////////////////////////////////////////////////////////////////////////////////////
         bool has_hook(ServerHookEvents, void*) const;
 
+        //////////////////////////////////////////////////////////////////////////////////////////
+        // Purpose: Enables/disables per-hook call and time counters used by DumpHookStats.
+        //////////////////////////////////////////////////////////////////////////////////////////
+        void SetHookProfiling(bool enabled) { m_hookProfiling.store(enabled, std::memory_order_relaxed); }
+        bool IsHookProfiling() const { return m_hookProfiling.load(std::memory_order_relaxed); }
+        void ResetHookStats();
+
+        //////////////////////////////////////////////////////////////////////////////////////////
+        // Purpose: Returns one line per registered hook with its library, calls and cumulative time.
+        //////////////////////////////////////////////////////////////////////////////////////////
+        std::vector<std::string> DumpHookStats() const;
+
         //////////////////////////////////////////////////////////////////////////////////////////
         // Purpose: Returns true if ScriptMgr has already registered the specified quest id.
         // Parameter: uint32 - the quest id to search for
@@ -295,6 +345,9 @@ class SERVER_DECL ScriptMgr : public Singleton<ScriptMgr>
 
     protected:
 
+        // builds the table of the event from its pending hooks, m_hooksMutex must be held
+        void _publishHookTable(uint32 event);
+
         InstanceCreateMap mInstances;
         CreatureCreateMap _creatures;
 		Mutex m_creaturesMutex;
@@ -304,6 +357,13 @@ class SERVER_DECL ScriptMgr : public Singleton<ScriptMgr>
         HandleScriptEffectMap SpellScriptEffects;
         DynamicLibraryMap dynamiclibs;
         ServerHookList _hooks[NUM_SERVER_HOOKS];
+        std::atomic<const ServerHookTable*> _hookTables[NUM_SERVER_HOOKS];
+        ServerHookTable::HookList _pendingHooks[NUM_SERVER_HOOKS];
+        std::vector<const ServerHookTable*> _retiredHookTables;
+        bool m_hookTablesPublished;
+        mutable std::mutex m_hooksMutex;
+        std::atomic<bool> m_hookProfiling;
+        std::string m_loadingLibrary;
         CustomGossipScripts _customgossipscripts;
         EventScripts _eventscripts;
         QuestScripts _questscripts;
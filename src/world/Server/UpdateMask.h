@@ -22,6 +22,7 @@
 #define __UPDATEMASK_H
 
 #include "WUtil.h"
+#include "UpdateMaskKernels.hpp"
 #include <cstring>
 
 class UpdateMask
@@ -71,9 +72,38 @@ class UpdateMask
         }
         inline uint32 GetBlockCount() const {return mBlocks;}
 
+        /// number of set bits in the first blocks words
+        uint32 GetSetBitCount(uint32 blocks) const
+        {
+            ARCEMU_ASSERT(blocks <= mBlocks);
+            return UpdateMaskKernels::countBits(mUpdateMask, blocks);
+        }
+
+        /// number of set bits below index
+        uint32 GetSetBitCountBelow(const uint32 index) const
+        {
+            ARCEMU_ASSERT(index < mCount);
+            const uint32 lowBits = mUpdateMask[index >> 5] & ((1u << (index & 31)) - 1);
+            return UpdateMaskKernels::countBits(mUpdateMask, index >> 5) + UpdateMaskKernels::countBits(&lowBits, 1);
+        }
+
+        /// sets the bit of every non zero value, values has to hold GetCount() fields
+        void SetNonZeroBits(const uint32* values)
+        {
+            UpdateMaskKernels::setNonZeroBits(values, mCount, nullptr, mUpdateMask);
+        }
+
+        /// same, but only for the fields that are set in filter
+        void SetNonZeroBits(const uint32* values, const UpdateMask & filter)
+        {
+            ARCEMU_ASSERT(filter.mCount >= mCount);
+            UpdateMaskKernels::setNonZeroBits(values, mCount, filter.mUpdateMask, mUpdateMask);
+        }
+
         inline uint32 GetLength() const { return (mBlocks * sizeof(uint32)); }
         inline uint32 GetCount() const { return mCount; }
         inline const uint8* GetMask() const { return (uint8*)mUpdateMask; }
+        inline const uint32* GetBlocks() const { return mUpdateMask; }
 
         void SetCount(uint32 valuesCount)
         {
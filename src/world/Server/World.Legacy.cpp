@@ -45,6 +45,7 @@
 #include "Storage/DayWatcherThread.h"
 #include "CommonScheduleThread.h"
 #include "World.Legacy.h"
+#include <thread>
 
 
 bool BasicTaskExecutor::run()
@@ -129,34 +130,14 @@ void TaskList::spawn()
     running = true;
     thread_count.SetVal(0);
 
-    uint32 threadcount;
+    uint32 threadcount = 1;
     if (worldConfig.startup.enableMultithreadedLoading)
     {
-        // get processor count
-#ifndef WIN32
-#if UNIX_FLAVOUR == UNIX_FLAVOUR_LINUX
-#if defined(__x86_64__) || defined(__x86_64) || defined(__amd64__)
-        threadcount = 2;
-#else
-        long affmask;
-        sched_getaffinity(0, 4, (cpu_set_t*)&affmask);
-        threadcount = (BitCount8(affmask)) * 2;
-        if (threadcount > 8) threadcount = 8;
-        else if (threadcount <= 0) threadcount = 1;
-#endif
-#else
-        threadcount = 2;
-#endif
-#else
-        SYSTEM_INFO s;
-        GetSystemInfo(&s);
-        threadcount = s.dwNumberOfProcessors * 2;
-        if (threadcount > 8)
-            threadcount = 8;
-#endif
+        // one thread per core, hardware_concurrency returns 0 when it can't tell
+        threadcount = std::thread::hardware_concurrency();
+        if (threadcount == 0)
+            threadcount = 2;
     }
-    else
-        threadcount = 1;
 
     LogNotice("World : Beginning %s server startup with %u threads.", (threadcount == 1) ? "progressive" : "parallel", threadcount);
 
@@ -29,6 +29,8 @@ This file is released under the MIT license. See README-MIT for more information
 #include "Storage/DayWatcherThread.h"
 #include "CommonScheduleThread.h"
 #include "World.Legacy.h"
+#include "StartupLoader.hpp"
+#include "UpdateMaskKernels.hpp"
 
 initialiseSingleton(World);
 
@@ -138,8 +140,13 @@ void World::loadWorldConfigValues(bool reload /*false*/)
 {
     settings.loadWorldConfigValues(reload);
 
+    TickProfiler::setEnabled(settings.profiler.isEnabled);
+
     if (reload)
+    {
         Channel::LoadConfSettings();
+        sMapTickScheduler.setSlowTickTrace(settings.profiler.slowTickThreshold, settings.profiler.traceFilePrefix);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -722,26 +729,29 @@ bool World::setInitialWorldSettings()
 
     resetCharacterLoginBannState();
 
-    if (!loadDbcDb2Stores())
-        return false;
-
-    new TaxiMgr; 
-    new ChatHandler;
-    new SpellProcMgr;
-
     new WorldLog;
     sWorldLog.InitWorldLog(worldConfig.log.enableWorldPacketLog);
 
-    new SpellCustomizations;
-    sSpellCustomizations.StartSpellCustomization();
+    new MySQLDataStore;
+    new ObjectMgr;
+    new QuestMgr;
+    new SpellFactoryMgr;
+    new WeatherMgr;
+    new AddonMgr;
+    new GameEventMgr;
+    new CalendarMgr;
+
+    // every loader only waits for the stores it reads, everything else runs side by side
+    StartupLoader loader;
+    addDbcStartupTasks(loader);
+    addMySQLStoreTasks(loader);
+    addObjectMgrTasks(loader);
 
-    ApplyNormalFixes();
+    if (!loader.run(worldConfig.startup.enableMultithreadedLoading ? 0 : 1))
+        return false;
 
-    LogNotice("GameObjectModel : Loading GameObject models...");
-    std::string vmapPath = worldConfig.server.dataDir + "vmaps";
-    LoadGameObjectModelList(vmapPath);
+    loader.logReport();
 
-    loadMySQLStores();
     loadMySQLTablesByTask(start_time);
     logEntitySize();
 
@@ -811,124 +821,147 @@ bool World::loadDbcDb2Stores()
     return true;
 }
 
-void World::loadMySQLStores()
+void World::addDbcStartupTasks(StartupLoader& loader)
 {
-    new MySQLDataStore;
+    loader.addCheckedTask("DBCStores", {}, [this] { return loadDbcDb2Stores(); });
 
-    sMySQLStore.LoadAdditionalTableConfig();
-
-    sMySQLStore.LoadItemPagesTable();
-    sMySQLStore.LoadItemPropertiesTable();
-    sMySQLStore.LoadCreaturePropertiesTable();
-    sMySQLStore.LoadGameObjectPropertiesTable();
-    sMySQLStore.LoadQuestPropertiesTable();
-    sMySQLStore.LoadGameObjectQuestItemBindingTable();
-    sMySQLStore.LoadGameObjectQuestPickupBindingTable();
-
-    sMySQLStore.LoadCreatureDifficultyTable();
-    sMySQLStore.LoadDisplayBoundingBoxesTable();
-    sMySQLStore.LoadVendorRestrictionsTable();
-    sMySQLStore.LoadAreaTriggersTable();
-    sMySQLStore.LoadNpcTextTable();
-    sMySQLStore.LoadNpcScriptTextTable();
-    sMySQLStore.LoadGossipMenuOptionTable();
-    sMySQLStore.LoadGraveyardsTable();
-    sMySQLStore.LoadTeleportCoordsTable();
-    sMySQLStore.LoadFishingTable();
-    sMySQLStore.LoadWorldMapInfoTable();
-    sMySQLStore.LoadZoneGuardsTable();
-    sMySQLStore.LoadBattleMastersTable();
-    sMySQLStore.LoadTotemDisplayIdsTable();
-    sMySQLStore.LoadSpellClickSpellsTable();
-
-    sMySQLStore.LoadWorldStringsTable();
-    sMySQLStore.LoadWorldBroadcastTable();
-    sMySQLStore.LoadPointOfInterestTable();
-    sMySQLStore.LoadItemSetLinkedSetBonusTable();
-    sMySQLStore.LoadCreatureInitialEquipmentTable();
-
-    sMySQLStore.LoadPlayerCreateInfoTable();
-    sMySQLStore.LoadPlayerCreateInfoSkillsTable();
-    sMySQLStore.LoadPlayerCreateInfoSpellsTable();
-    sMySQLStore.LoadPlayerCreateInfoItemsTable();
-    sMySQLStore.LoadPlayerXpToLevelTable();
-
-    sMySQLStore.LoadSpellOverrideTable();
-
-    sMySQLStore.LoadNpcGossipTextIdTable();
-    sMySQLStore.LoadPetLevelAbilitiesTable();
-}
+    loader.addTask("TaxiMgr", { "DBCStores" }, [] { new TaxiMgr; });
+    loader.addTask("ChatHandler", { "DBCStores" }, [] { new ChatHandler; });
 
-void World::loadMySQLTablesByTask(uint32_t start_time)
-{
-    new ObjectMgr;
-    new QuestMgr;
-    new SpellFactoryMgr;
-    new WeatherMgr;
-    new AddonMgr;
-    new GameEventMgr;
-    new CalendarMgr;
+    loader.addTask("SpellInfo", { "DBCStores" }, []
+    {
+        new SpellProcMgr;
+        new SpellCustomizations;
 
-#define MAKE_TASK(sp, ptr) tl.AddTask(new Task(new CallbackP0<sp>(sp::getSingletonPtr(), &sp::ptr)))
-    // Fill the task list with jobs to do.
-    TaskList tl;
+        const std::string spellInfoCache = worldConfig.server.dataDir + "spellinfo.cache";
+        if (!worldConfig.server.useSpellInfoCache || !sSpellCustomizations.LoadSpellInfoCache(spellInfoCache))
+        {
+            sSpellCustomizations.StartSpellCustomization();
 
-    // spawn worker threads (2 * number of cpus)
-    tl.spawn();
+            ApplyNormalFixes();
 
-    // storage stuff has to be loaded first
-    tl.wait();
+            if (worldConfig.server.useSpellInfoCache)
+                sSpellCustomizations.SaveSpellInfoCache(spellInfoCache);
+        }
+    });
 
-    MAKE_TASK(ObjectMgr, GenerateLevelUpInfo);
-    MAKE_TASK(ObjectMgr, LoadPlayersInfo);
-    tl.wait();
+    loader.addTask("GameObjectModels", {}, []
+    {
+        LogNotice("GameObjectModel : Loading GameObject models...");
+        std::string vmapPath = worldConfig.server.dataDir + "vmaps";
+        LoadGameObjectModelList(vmapPath);
+    });
+}
 
-    MAKE_TASK(ObjectMgr, LoadInstanceBossInfos);
-    MAKE_TASK(ObjectMgr, LoadCreatureWaypoints);
-    MAKE_TASK(ObjectMgr, LoadCreatureTimedEmotes);
-    MAKE_TASK(ObjectMgr, LoadTrainers);
-    MAKE_TASK(ObjectMgr, LoadSpellSkills);
-    MAKE_TASK(ObjectMgr, LoadVendors);
-    MAKE_TASK(ObjectMgr, LoadAIThreatToSpellId);
-    MAKE_TASK(ObjectMgr, LoadSpellEffectsOverride);
-    MAKE_TASK(ObjectMgr, LoadSpellTargetConstraints);
+void World::addMySQLStoreTasks(StartupLoader& loader)
+{
+    // the additional tables are read by the loaders of the properties tables
+    loader.addTask("LoadAdditionalTableConfig", {}, [] { sMySQLStore.LoadAdditionalTableConfig(); });
+
+    loader.addTask("LoadItemPagesTable", {}, [] { sMySQLStore.LoadItemPagesTable(); });
+    loader.addTask("LoadItemPropertiesTable", { "LoadAdditionalTableConfig" }, [] { sMySQLStore.LoadItemPropertiesTable(); });
+    loader.addTask("LoadCreaturePropertiesTable", { "LoadAdditionalTableConfig", "SpellInfo" }, [] { sMySQLStore.LoadCreaturePropertiesTable(); });
+    loader.addTask("LoadGameObjectPropertiesTable", { "LoadAdditionalTableConfig", "LoadItemPropertiesTable" }, [] { sMySQLStore.LoadGameObjectPropertiesTable(); });
+    loader.addTask("LoadQuestPropertiesTable", { "LoadAdditionalTableConfig", "LoadCreaturePropertiesTable", "LoadGameObjectPropertiesTable" }, [] { sMySQLStore.LoadQuestPropertiesTable(); });
+
+    // both bindings are stored in the gameobject properties
+    loader.addTask("LoadGameObjectQuestItemBindingTable", { "LoadQuestPropertiesTable" }, [] { sMySQLStore.LoadGameObjectQuestItemBindingTable(); });
+    loader.addTask("LoadGameObjectQuestPickupBindingTable", { "LoadGameObjectQuestItemBindingTable" }, [] { sMySQLStore.LoadGameObjectQuestPickupBindingTable(); });
+
+    loader.addTask("LoadCreatureDifficultyTable", {}, [] { sMySQLStore.LoadCreatureDifficultyTable(); });
+    loader.addTask("LoadDisplayBoundingBoxesTable", {}, [] { sMySQLStore.LoadDisplayBoundingBoxesTable(); });
+    loader.addTask("LoadVendorRestrictionsTable", {}, [] { sMySQLStore.LoadVendorRestrictionsTable(); });
+    loader.addTask("LoadAreaTriggersTable", {}, [] { sMySQLStore.LoadAreaTriggersTable(); });
+    loader.addTask("LoadNpcTextTable", {}, [] { sMySQLStore.LoadNpcTextTable(); });
+    loader.addTask("LoadNpcScriptTextTable", {}, [] { sMySQLStore.LoadNpcScriptTextTable(); });
+    loader.addTask("LoadGossipMenuOptionTable", {}, [] { sMySQLStore.LoadGossipMenuOptionTable(); });
+    loader.addTask("LoadGraveyardsTable", {}, [] { sMySQLStore.LoadGraveyardsTable(); });
+    loader.addTask("LoadTeleportCoordsTable", {}, [] { sMySQLStore.LoadTeleportCoordsTable(); });
+    loader.addTask("LoadFishingTable", {}, [] { sMySQLStore.LoadFishingTable(); });
+    loader.addTask("LoadWorldMapInfoTable", {}, [] { sMySQLStore.LoadWorldMapInfoTable(); });
+    loader.addTask("LoadZoneGuardsTable", {}, [] { sMySQLStore.LoadZoneGuardsTable(); });
+    loader.addTask("LoadBattleMastersTable", {}, [] { sMySQLStore.LoadBattleMastersTable(); });
+    loader.addTask("LoadTotemDisplayIdsTable", {}, [] { sMySQLStore.LoadTotemDisplayIdsTable(); });
+    loader.addTask("LoadSpellClickSpellsTable", {}, [] { sMySQLStore.LoadSpellClickSpellsTable(); });
+
+    loader.addTask("LoadWorldStringsTable", {}, [] { sMySQLStore.LoadWorldStringsTable(); });
+    loader.addTask("LoadWorldBroadcastTable", {}, [] { sMySQLStore.LoadWorldBroadcastTable(); });
+    loader.addTask("LoadPointOfInterestTable", {}, [] { sMySQLStore.LoadPointOfInterestTable(); });
+    loader.addTask("LoadItemSetLinkedSetBonusTable", {}, [] { sMySQLStore.LoadItemSetLinkedSetBonusTable(); });
+    loader.addTask("LoadCreatureInitialEquipmentTable", { "LoadCreaturePropertiesTable" }, [] { sMySQLStore.LoadCreatureInitialEquipmentTable(); });
+
+    // all playercreateinfo tables fill the same store
+    loader.addTask("LoadPlayerCreateInfoTable", {}, [] { sMySQLStore.LoadPlayerCreateInfoTable(); });
+    loader.addTask("LoadPlayerCreateInfoSkillsTable", { "LoadPlayerCreateInfoTable", "DBCStores" }, [] { sMySQLStore.LoadPlayerCreateInfoSkillsTable(); });
+    loader.addTask("LoadPlayerCreateInfoSpellsTable", { "LoadPlayerCreateInfoSkillsTable" }, [] { sMySQLStore.LoadPlayerCreateInfoSpellsTable(); });
+    loader.addTask("LoadPlayerCreateInfoItemsTable", { "LoadPlayerCreateInfoSpellsTable", "LoadItemPropertiesTable" }, [] { sMySQLStore.LoadPlayerCreateInfoItemsTable(); });
+    loader.addTask("LoadPlayerXpToLevelTable", {}, [] { sMySQLStore.LoadPlayerXpToLevelTable(); });
+
+    loader.addTask("LoadSpellOverrideTable", { "SpellInfo" }, [] { sMySQLStore.LoadSpellOverrideTable(); });
+
+    loader.addTask("LoadNpcGossipTextIdTable", { "LoadCreaturePropertiesTable" }, [] { sMySQLStore.LoadNpcGossipTextIdTable(); });
+    loader.addTask("LoadPetLevelAbilitiesTable", {}, [] { sMySQLStore.LoadPetLevelAbilitiesTable(); });
+}
+
+void World::addObjectMgrTasks(StartupLoader& loader)
+{
+#define OBJMGR_TASK(sp, ptr, ...) loader.addTask(#sp "::" #ptr, __VA_ARGS__, [] { sp::getSingleton().ptr(); })
+
+    OBJMGR_TASK(ObjectMgr, GenerateLevelUpInfo, { "LoadPlayerCreateInfoItemsTable" });
+    OBJMGR_TASK(ObjectMgr, LoadPlayersInfo, {});
+
+    OBJMGR_TASK(ObjectMgr, LoadInstanceBossInfos, { "LoadWorldMapInfoTable" });
+    OBJMGR_TASK(ObjectMgr, LoadCreatureWaypoints, {});
+    OBJMGR_TASK(ObjectMgr, LoadCreatureTimedEmotes, {});
+    OBJMGR_TASK(ObjectMgr, LoadTrainers, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadSpellSkills, { "DBCStores" });
+    OBJMGR_TASK(ObjectMgr, LoadVendors, { "DBCStores", "LoadItemPropertiesTable" });
+    OBJMGR_TASK(ObjectMgr, LoadAIThreatToSpellId, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadSpellEffectsOverride, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadSpellTargetConstraints, {});
 #if VERSION_STRING == Cata
-    MAKE_TASK(ObjectMgr, LoadSpellRequired);
-    MAKE_TASK(ObjectMgr, LoadSkillLineAbilityMap);
+    OBJMGR_TASK(ObjectMgr, LoadSpellRequired, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadSkillLineAbilityMap, { "SpellInfo" });
 #endif
-    MAKE_TASK(ObjectMgr, LoadDefaultPetSpells);
-    MAKE_TASK(ObjectMgr, LoadPetSpellCooldowns);
-    MAKE_TASK(ObjectMgr, LoadGuildCharters);
-    MAKE_TASK(ObjectMgr, LoadGMTickets);
-    MAKE_TASK(ObjectMgr, SetHighestGuids);
-    MAKE_TASK(ObjectMgr, LoadReputationModifiers);
-    MAKE_TASK(ObjectMgr, LoadMonsterSay);
-    MAKE_TASK(ObjectMgr, LoadGroups);
-    MAKE_TASK(ObjectMgr, LoadCreatureAIAgents);
-    MAKE_TASK(ObjectMgr, LoadArenaTeams);
-    MAKE_TASK(ObjectMgr, LoadProfessionDiscoveries);
-    MAKE_TASK(ObjectMgr, StoreBroadCastGroupKey);
-    MAKE_TASK(ObjectMgr, LoadVehicleAccessories);
-    MAKE_TASK(ObjectMgr, LoadWorldStateTemplates);
-    MAKE_TASK(ObjectMgr, LoadAreaTrigger);
+    OBJMGR_TASK(ObjectMgr, LoadDefaultPetSpells, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadPetSpellCooldowns, { "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadGuildCharters, { "ObjectMgr::LoadPlayersInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadGMTickets, { "ObjectMgr::LoadPlayersInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadReputationModifiers, {});
+    OBJMGR_TASK(ObjectMgr, LoadMonsterSay, { "LoadCreaturePropertiesTable" });
+    OBJMGR_TASK(ObjectMgr, LoadGroups, { "ObjectMgr::LoadPlayersInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadCreatureAIAgents, { "LoadCreaturePropertiesTable", "SpellInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadArenaTeams, { "ObjectMgr::LoadPlayersInfo" });
+    OBJMGR_TASK(ObjectMgr, LoadProfessionDiscoveries, {});
+    OBJMGR_TASK(ObjectMgr, StoreBroadCastGroupKey, {});
+    OBJMGR_TASK(ObjectMgr, LoadVehicleAccessories, {});
+    OBJMGR_TASK(ObjectMgr, LoadWorldStateTemplates, {});
+    OBJMGR_TASK(ObjectMgr, LoadAreaTrigger, { "DBCStores" });
 
 #if VERSION_STRING > TBC
-    MAKE_TASK(ObjectMgr, LoadAchievementRewards);
+    OBJMGR_TASK(ObjectMgr, LoadAchievementRewards, { "DBCStores", "LoadCreaturePropertiesTable" });
 #endif
 
-    tl.wait();
+    // the highest guids overwrite the counters set while loading charters, tickets, groups and arena teams
+    OBJMGR_TASK(ObjectMgr, SetHighestGuids, { "ObjectMgr::LoadGuildCharters", "ObjectMgr::LoadGMTickets", "ObjectMgr::LoadGroups", "ObjectMgr::LoadArenaTeams" });
+
+    OBJMGR_TASK(QuestMgr, LoadExtraQuestStuff, { "LoadGameObjectQuestPickupBindingTable" });
+    OBJMGR_TASK(SpellFactoryMgr, LoadSpellAreas, { "SpellInfo", "LoadQuestPropertiesTable" });
+    OBJMGR_TASK(ObjectMgr, LoadEventScripts, {});
+    OBJMGR_TASK(WeatherMgr, LoadFromDB, {});
+    OBJMGR_TASK(AddonMgr, LoadFromDB, {});
+    OBJMGR_TASK(GameEventMgr, LoadFromDB, { "LoadCreaturePropertiesTable", "LoadGameObjectPropertiesTable" });
+    OBJMGR_TASK(CalendarMgr, LoadFromDB, {});
 
-    MAKE_TASK(QuestMgr, LoadExtraQuestStuff);
-    MAKE_TASK(SpellFactoryMgr, LoadSpellAreas);
-    MAKE_TASK(ObjectMgr, LoadEventScripts);
-    MAKE_TASK(WeatherMgr, LoadFromDB);
-    MAKE_TASK(AddonMgr, LoadFromDB);
-    MAKE_TASK(GameEventMgr, LoadFromDB);
-    MAKE_TASK(CalendarMgr, LoadFromDB);
+#undef OBJMGR_TASK
+}
 
-#undef MAKE_TASK
+void World::loadMySQLTablesByTask(uint32_t start_time)
+{
+    TaskList tl;
 
-    tl.wait();
+    // spawn worker threads for the map creation
+    tl.spawn();
 
     sLocalizationMgr.Reload(false);
 
@@ -960,6 +993,7 @@ void World::logEntitySize()
     LogNotice("World : Creature size: %u bytes", sizeof(Creature) + sizeof(AIInterface));
     LogNotice("World : Player size: %u bytes", sizeof(Player) + sizeof(ItemInterface) + 50000 + 30000 + 1000 + sizeof(AIInterface));
     LogNotice("World : GameObject size: %u bytes", sizeof(GameObject));
+    LogNotice("World : Using %s update mask kernels", UpdateMaskKernels::getKernelSetName());
 }
 
 void World::Update(unsigned long time_passed)
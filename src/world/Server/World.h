@@ -18,6 +18,8 @@ This file is released under the MIT license. See README-MIT for more information
 #include <string>
 #include <vector>
 
+class StartupLoader;
+
 class SERVER_DECL World : public Singleton<World>, public EventableObject, public IUpdatable
 {
     public:
@@ -189,7 +191,9 @@ class SERVER_DECL World : public Singleton<World>, public EventableObject, publi
         void resetCharacterLoginBannState();
         bool loadDbcDb2Stores();
 
-        void loadMySQLStores();
+        void addDbcStartupTasks(StartupLoader& loader);
+        void addMySQLStoreTasks(StartupLoader& loader);
+        void addObjectMgrTasks(StartupLoader& loader);
         void loadMySQLTablesByTask(uint32_t start_time);
         void logEntitySize();
 
@@ -38,6 +38,9 @@ WorldConfig::WorldConfig()
     log.enablePlayerLog = false;
     log.enableTimeStamp = false;
     log.enableSqlBanLog = false;
+    log.asyncFileLog = true;
+    log.asyncFileLogDropWhenFull = false;
+    log.logRotationSizeMb = 0;
 
     // world.conf - LogonServer Settings
     logonServer.address = "127.0.0.1";
@@ -70,6 +73,8 @@ WorldConfig::WorldConfig()
     server.disableFearMovement = 0;
     server.saveExtendedCharData = false;
     server.dataDir = "./";
+    server.useSpellInfoCache = true;
+    server.mapTickThreads = 0;
 
     // world.conf - Player Settings
     player.playerStartingLevel = 1;
@@ -164,6 +169,12 @@ WorldConfig::WorldConfig()
     movement.compressRate = 1;                          // not used by core
     movement.compressThresholdCreatures = 15.0f;        // not used by core
     movement.compressThresholdPlayers = 25.0f;          // not used by core
+    movement.isLodEnabled = true;
+    movement.lodNearDistance = 40.0f * 40.0f;
+    movement.lodMidDistance = 80.0f * 80.0f;
+    movement.lodMidIntervalInMs = 500;
+    movement.lodFarIntervalInMs = 1500;
+    movement.isHeartbeatCoalescingEnabled = true;
 
     // world.conf - Localization Setup
     // world.conf - Dungeon / Instance Setup
@@ -201,6 +212,8 @@ WorldConfig::WorldConfig()
     arena.minPlayerCount3V3 = 3;
     arena.maxPlayerCount5V5 = 5;
     arena.minPlayerCount5V5 = 5;
+    arena.queueDiffStep = 50;
+    arena.queueDiffMax = 500;
 
     // world.conf - Limits settings
     limit.isLimitSystemEnabled = true;
@@ -220,6 +233,22 @@ WorldConfig::WorldConfig()
     corpseDecay.rareEliteTimeInSeconds = 300000;
     corpseDecay.worldbossTimeInSeconds = 3600000;
 
+    // world.conf - Tick Benchmark
+    tickBenchmark.isEnabled = false;
+    tickBenchmark.mapId = 0;
+    tickBenchmark.fixture = "";
+    tickBenchmark.warmupTicks = 50;
+    tickBenchmark.ticks = 1000;
+    tickBenchmark.tickDiff = 100;
+    tickBenchmark.seed = 1;
+    tickBenchmark.suite = "";
+    tickBenchmark.profilerOverhead = false;
+
+    // world.conf - Profiler
+    profiler.isEnabled = false;
+    profiler.slowTickThreshold = 0;
+    profiler.traceFilePrefix = "slowtick_";
+
 }
 
 WorldConfig::~WorldConfig() {}
@@ -276,6 +305,9 @@ void WorldConfig::loadWorldConfigValues(bool reload /*false*/)
     log.enablePlayerLog = Config.MainConfig.getBoolDefault("Log", "EnablePlayerLog", false);
     log.enableTimeStamp = Config.MainConfig.getBoolDefault("Log", "EnableTimeStamp", false);
     log.enableSqlBanLog = Config.MainConfig.getBoolDefault("Log", "EnableSqlBanLog", false);
+    log.asyncFileLog = Config.MainConfig.getBoolDefault("Log", "AsyncFileLog", true);
+    log.asyncFileLogDropWhenFull = Config.MainConfig.getBoolDefault("Log", "AsyncFileLogDropWhenFull", false);
+    log.logRotationSizeMb = Config.MainConfig.getIntDefault("Log", "RotationSizeMB", 0);
 
     // world.conf - LogonServer Settings
     logonServer.address = Config.MainConfig.getStringDefault("LogonServer", "Address", "127.0.0.1");
@@ -341,6 +373,8 @@ void WorldConfig::loadWorldConfigValues(bool reload /*false*/)
     server.dataDir = Config.MainConfig.getStringDefault("Server", "DataDir", "./");
     if (server.dataDir.compare("./") != 0)
         server.dataDir = "./" + server.dataDir + "/";
+    server.useSpellInfoCache = Config.MainConfig.getBoolDefault("Server", "SpellInfoCache", true);
+    server.mapTickThreads = Config.MainConfig.getIntDefault("Server", "MapTickThreads", 0);
 
     // world.conf - Player Settings
     player.playerStartingLevel = Config.MainConfig.getIntDefault("Player", "StartingLevel", 1);
@@ -503,6 +537,18 @@ void WorldConfig::loadWorldConfigValues(bool reload /*false*/)
     movement.compressThresholdPlayers = Config.MainConfig.getFloatDefault("Movement", "CompressThreshold", 25.0f);
     movement.compressThresholdPlayers *= movement.compressThresholdPlayers;
 
+    movement.isLodEnabled = Config.MainConfig.getBoolDefault("Movement", "LodEnabled", true);
+
+    movement.lodNearDistance = Config.MainConfig.getFloatDefault("Movement", "LodNearDistance", 40.0f);
+    movement.lodNearDistance *= movement.lodNearDistance;
+
+    movement.lodMidDistance = Config.MainConfig.getFloatDefault("Movement", "LodMidDistance", 80.0f);
+    movement.lodMidDistance *= movement.lodMidDistance;
+
+    movement.lodMidIntervalInMs = Config.MainConfig.getIntDefault("Movement", "LodMidInterval", 500);
+    movement.lodFarIntervalInMs = Config.MainConfig.getIntDefault("Movement", "LodFarInterval", 1500);
+    movement.isHeartbeatCoalescingEnabled = Config.MainConfig.getBoolDefault("Movement", "CoalesceHeartbeats", true);
+
     // world.conf - Localization Setup
     localization.localizedBindings = Config.MainConfig.getStringDefault("Localization", "LocaleBindings", "");
 
@@ -546,6 +592,8 @@ void WorldConfig::loadWorldConfigValues(bool reload /*false*/)
     arena.maxPlayerCount3V3 = Config.MainConfig.getIntDefault("Arena", "3V3_MAX", 3);
     arena.minPlayerCount5V5 = Config.MainConfig.getIntDefault("Arena", "5V5_MIN", 5);
     arena.maxPlayerCount5V5 = Config.MainConfig.getIntDefault("Arena", "5V5_MAX", 5);
+    arena.queueDiffStep = Config.MainConfig.getIntDefault("Arena", "QueueDiffStep", 50);
+    arena.queueDiffMax = Config.MainConfig.getIntDefault("Arena", "QueueDiffMax", 500);
 
     // world.conf - Limits settings
     limit.isLimitSystemEnabled = Config.MainConfig.getBoolDefault("Limits", "Enable", true);
@@ -564,6 +612,22 @@ void WorldConfig::loadWorldConfigValues(bool reload /*false*/)
     corpseDecay.eliteTimeInSeconds = (1000 * (Config.MainConfig.getIntDefault("CorpseDecaySettings", "DecayElite", 300)));
     corpseDecay.rareEliteTimeInSeconds = (1000 * (Config.MainConfig.getIntDefault("CorpseDecaySettings", "DecayRareElite", 300)));
     corpseDecay.worldbossTimeInSeconds = (1000 * (Config.MainConfig.getIntDefault("CorpseDecaySettings", "DecayWorldboss", 3600)));
+
+    // world.conf - Tick Benchmark
+    tickBenchmark.isEnabled = Config.MainConfig.getBoolDefault("TickBenchmark", "Enabled", false);
+    tickBenchmark.mapId = Config.MainConfig.getIntDefault("TickBenchmark", "Map", 0);
+    tickBenchmark.fixture = Config.MainConfig.getStringDefault("TickBenchmark", "Fixture", "");
+    tickBenchmark.warmupTicks = Config.MainConfig.getIntDefault("TickBenchmark", "WarmupTicks", 50);
+    tickBenchmark.ticks = Config.MainConfig.getIntDefault("TickBenchmark", "Ticks", 1000);
+    tickBenchmark.tickDiff = Config.MainConfig.getIntDefault("TickBenchmark", "TickDiff", 100);
+    tickBenchmark.seed = Config.MainConfig.getIntDefault("TickBenchmark", "Seed", 1);
+    tickBenchmark.suite = Config.MainConfig.getStringDefault("TickBenchmark", "Suite", "");
+    tickBenchmark.profilerOverhead = Config.MainConfig.getBoolDefault("TickBenchmark", "ProfilerOverhead", false);
+
+    // world.conf - Profiler
+    profiler.isEnabled = Config.MainConfig.getBoolDefault("Profiler", "Enabled", false);
+    profiler.slowTickThreshold = Config.MainConfig.getIntDefault("Profiler", "SlowTickMs", 0);
+    profiler.traceFilePrefix = Config.MainConfig.getStringDefault("Profiler", "TracePrefix", "slowtick_");
 }
 
 
@@ -108,6 +108,9 @@ class SERVER_DECL WorldConfig
             bool enablePlayerLog;
             bool enableTimeStamp;
             bool enableSqlBanLog;
+            bool asyncFileLog;
+            bool asyncFileLogDropWhenFull;
+            uint32_t logRotationSizeMb;
         } log;
 
         // world.conf - LogonServer Settings
@@ -147,6 +150,8 @@ class SERVER_DECL WorldConfig
             bool disableFearMovement;
             bool saveExtendedCharData;
             std::string dataDir;
+            bool useSpellInfoCache;
+            uint32_t mapTickThreads;
         } server;
 
         uint32_t getPlayerLimit();
@@ -310,6 +315,13 @@ class SERVER_DECL WorldConfig
             uint32_t compressRate;
             float compressThresholdPlayers;
             float compressThresholdCreatures;
+
+            bool isLodEnabled;
+            float lodNearDistance;              // squared
+            float lodMidDistance;               // squared
+            uint32_t lodMidIntervalInMs;
+            uint32_t lodFarIntervalInMs;
+            bool isHeartbeatCoalescingEnabled;
         } movement;
 
         // world.conf - Localization Setup
@@ -361,6 +373,8 @@ class SERVER_DECL WorldConfig
             uint32_t maxPlayerCount3V3;
             uint32_t minPlayerCount5V5;
             uint32_t maxPlayerCount5V5;
+            uint32_t queueDiffStep;
+            uint32_t queueDiffMax;
         } arena;
 
         // world.conf - Limits settings
@@ -387,4 +401,26 @@ class SERVER_DECL WorldConfig
             uint32_t worldbossTimeInSeconds;
         } corpseDecay;
 
+        // world.conf - Tick Benchmark
+        struct TickBenchmarkSettings
+        {
+            bool isEnabled;
+            uint32_t mapId;
+            std::string fixture;
+            uint32_t warmupTicks;
+            uint32_t ticks;
+            uint32_t tickDiff;
+            uint32_t seed;
+            std::string suite;
+            bool profilerOverhead;
+        } tickBenchmark;
+
+        // world.conf - Profiler
+        struct ProfilerSettings
+        {
+            bool isEnabled;
+            uint32_t slowTickThreshold;
+            std::string traceFilePrefix;
+        } profiler;
+
 };
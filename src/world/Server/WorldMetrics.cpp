@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#include "StdAfx.h"
+
+#include "WorldMetrics.h"
+#include "Server/World.h"
+#include "Server/MainServerDefines.h"
+#include "Map/MapObjectPool.h"
+#include "Map/MapTickScheduler.h"
+#include "Metrics/MetricsExporter.hpp"
+
+#include <list>
+
+namespace
+{
+    // copy of the MapTickStats, whose pointers are only valid inside visitStats
+    struct MapMetrics
+    {
+        uint32_t mapId;
+        uint32_t instanceId;
+        uint32_t tickInterval;
+        MapTickHistogram duration;
+        MapTickHistogram lateness;
+        MapPoolStats pools;
+        CreateBlockCacheStats createCache;
+    };
+
+    std::string getMapLabels(const MapMetrics& metrics)
+    {
+        return MetricsWriter::label("map", metrics.mapId) + "," + MetricsWriter::label("instance", metrics.instanceId);
+    }
+
+    void writeTickHistogram(MetricsWriter& writer, const char* name, const std::string& labels, const MapTickHistogram& histogram)
+    {
+        uint64_t bounds[MapTickHistogram::bucketCount - 1];
+        uint64_t buckets[MapTickHistogram::bucketCount];
+        for (uint8_t i = 0; i < MapTickHistogram::bucketCount; ++i)
+        {
+            if (i < MapTickHistogram::bucketCount - 1)
+                bounds[i] = MapTickHistogram::getBucketLimit(i);
+
+            buckets[i] = histogram.getBucket(i);
+        }
+
+        writer.histogram(name, labels, MapTickHistogram::bucketCount - 1, bounds, buckets, histogram.getTotal(), 1000000.0);
+    }
+
+    void writeSessionMetrics(MetricsWriter& writer)
+    {
+        writer.family("ascemu_world_sessions", "gauge", "Active sessions of the world server.");
+        writer.sample("ascemu_world_sessions", "", static_cast<double>(sWorld.getSessionCount()));
+
+        writer.family("ascemu_world_players", "gauge", "Players in the world.");
+        writer.sample("ascemu_world_players", "", sWorld.getPlayerCount());
+    }
+
+    void writeMapMetrics(MetricsWriter& writer)
+    {
+        std::list<MapMetrics> maps;
+        sMapTickScheduler.visitStats([&maps](const MapTickStats& stats)
+        {
+            maps.emplace_back();
+            MapMetrics& metrics = maps.back();
+            metrics.mapId = stats.mapId;
+            metrics.instanceId = stats.instanceId;
+            metrics.tickInterval = stats.tickInterval;
+            metrics.duration = *stats.duration;
+            metrics.lateness = *stats.lateness;
+            metrics.pools = *stats.pools;
+            metrics.createCache = *stats.createCache;
+        });
+
+        writer.family("ascemu_map_tick_seconds", "histogram", "Duration of the map ticks since the last mapstats reset.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            writeTickHistogram(writer, "ascemu_map_tick_seconds", getMapLabels(*itr), itr->duration);
+
+        writer.family("ascemu_map_tick_lateness_seconds", "histogram", "Delay of the map ticks behind their deadline since the last mapstats reset.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            writeTickHistogram(writer, "ascemu_map_tick_lateness_seconds", getMapLabels(*itr), itr->lateness);
+
+        writer.family("ascemu_map_tick_interval_seconds", "gauge", "Configured tick interval of the map.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            writer.sample("ascemu_map_tick_interval_seconds", getMapLabels(*itr), itr->tickInterval / 1000.0);
+
+        writer.family("ascemu_map_pool_allocations_total", "counter", "Pool allocations while the map was ticking since the last mappools reset.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+        {
+            for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+                writer.sample("ascemu_map_pool_allocations_total", getMapLabels(*itr) + "," + MetricsWriter::label("pool", MapObjectPool::getTypeName(MapPoolType(i))),
+                    static_cast<double>(itr->pools.getAllocations(MapPoolType(i))));
+        }
+
+        writer.family("ascemu_map_create_cache_hits_total", "counter", "Create blocks served from the values cache since the last createcache reset.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            writer.sample("ascemu_map_create_cache_hits_total", getMapLabels(*itr), static_cast<double>(itr->createCache.getHits()));
+
+        writer.family("ascemu_map_create_cache_misses_total", "counter", "Create blocks built without the values cache since the last createcache reset.");
+        for (std::list<MapMetrics>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            writer.sample("ascemu_map_create_cache_misses_total", getMapLabels(*itr), static_cast<double>(itr->createCache.getMisses()));
+    }
+
+    void writeEventMetrics(MetricsWriter& writer)
+    {
+        writer.family("ascemu_event_holder_events", "gauge", "Timed events of the event holder after its last update.");
+        sEventMgr.VisitEventHolders([&writer](EventableObjectHolder* holder)
+        {
+            writer.sample("ascemu_event_holder_events", MetricsWriter::label("instance", std::to_string(static_cast<int32>(holder->GetInstanceID()))),
+                holder->GetEventCount());
+        });
+    }
+
+    void writePoolMetrics(MetricsWriter& writer)
+    {
+        writer.family("ascemu_pool_live_objects", "gauge", "Objects currently allocated from the map object pool.");
+        for (uint8_t i = 0; i < MAP_POOL_TYPE_COUNT; ++i)
+            writer.sample("ascemu_pool_live_objects", MetricsWriter::label("pool", MapObjectPool::getTypeName(MapPoolType(i))),
+                static_cast<double>(MapObjectPool::getLiveCount(MapPoolType(i))));
+
+        writer.family("ascemu_pool_reserved_bytes", "gauge", "Bytes reserved by the map object pool.");
+        writer.sample("ascemu_pool_reserved_bytes", "", static_cast<double>(MapObjectPool::getReservedBytes()));
+
+        writer.family("ascemu_pool_caches", "gauge", "Thread caches of the map object pool.");
+        writer.sample("ascemu_pool_caches", "", MapObjectPool::getCacheCount());
+    }
+}
+
+void registerWorldMetrics()
+{
+    sMetricsExporter.addDatabase("world", Database_World);
+    sMetricsExporter.addDatabase("character", Database_Character);
+
+    sMetricsExporter.addCollector(&writeSessionMetrics);
+    sMetricsExporter.addCollector(&writeMapMetrics);
+    sMetricsExporter.addCollector(&writeEventMetrics);
+    sMetricsExporter.addCollector(&writePoolMetrics);
+}
@@ -0,0 +1,10 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+/// adds the collectors of the world server (sessions, map ticks, event holders, pools)
+/// and its databases to sMetricsExporter
+void registerWorldMetrics();
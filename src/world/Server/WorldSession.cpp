@@ -34,6 +34,12 @@
 
 OpcodeHandler WorldPacketHandlers[NUM_MSG_TYPES];
 
+ProfileCounterTable& WorldSession::getUnmappedOpcodeProfile()
+{
+    static ProfileCounterTable unmappedOpcodeProfile(NUM_MSG_TYPES);
+    return unmappedOpcodeProfile;
+}
+
 WorldSession::WorldSession(uint32 id, std::string Name, WorldSocket* sock) :
     m_loggingInPlayer(NULL),
     m_currMsTime(getMSTime()),
@@ -67,6 +73,7 @@ WorldSession::WorldSession(uint32 id, std::string Name, WorldSocket* sock) :
     m_muted(0)
 {
     memset(movement_packet, 0, sizeof(movement_packet));
+    m_pendingHeartbeat.size = 0;
 
 #if VERSION_STRING != Cata
     movement_info.redirectVelocity = 0;
@@ -168,6 +175,14 @@ uint8 WorldSession::Update(uint32 InstanceID)
                 }
                 else
                 {
+                    ProfileScope profile(nullptr, PROFILE_CATEGORY_OPCODE, packet->GetOpcode());
+                    if (profile.isActive())
+                    {
+                        MapMgr* mapMgr = t_currentMapContext.get();
+                        ProfileCounterTable& opcodeProfile = mapMgr != nullptr ? mapMgr->m_opcodeProfile : getUnmappedOpcodeProfile();
+                        profile.setCounter(&opcodeProfile.get(packet->GetOpcode()));
+                    }
+
                     (this->*Handler->handler)(*packet);
                 }
             }
@@ -193,6 +208,8 @@ uint8 WorldSession::Update(uint32 InstanceID)
         return 2;
     }
 
+    _FlushPendingHeartbeat();
+
     if (_logoutTime && (m_currMsTime >= _logoutTime) && instanceId == InstanceID)
     {
         // Check if the player is in the process of being moved. We can't
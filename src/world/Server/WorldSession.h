@@ -26,8 +26,10 @@
 #include "Server/Packets/Opcode.h"
 #include "Management/Quest.h"
 #include "FastQueue.h"
+#include "TickProfiler.hpp"
 #include "Units/Unit.h"
 #include "AuthCodes.h"
+#include "Movement/MovementBroadcast.hpp"
 #if VERSION_STRING == Cata
     #include "Management/AddonMgr.h"
     #include "Units/Players/PlayerDefines.hpp"
@@ -243,6 +245,7 @@ extern LoginErrorCode VerifyName(const char* name, size_t nlen);
 class SERVER_DECL WorldSession
 {
     friend class WorldSocket;
+    friend class MapTickBenchmark;
 
     public:
 
@@ -949,6 +952,25 @@ class SERVER_DECL WorldSession
         MovementInfo movement_info;
         uint8 movement_packet[90];
 
+        /// Sends a movement packet of our mover to all players in range, packet holds the
+        /// client time at timeOffset which is adjusted for each observer
+        void _BroadcastMovement(uint16 opcode, uint8* packet, uint16 size, size_t timeOffset, int32 moveTime, float x, float y, bool heartbeat);
+
+        /// Broadcasts the last heartbeat received during this update, called at the end of Update
+        void _FlushPendingHeartbeat();
+
+        struct PendingHeartbeat
+        {
+            uint8 packet[90];
+            uint16 size;            // 0 when nothing is queued
+            uint16 timeOffset;
+            int32 moveTime;
+            uint64 moverGuid;
+            LocationVector position;
+        } m_pendingHeartbeat;
+
+        Movement::BroadcastLod m_movementLod;
+
         uint32 _accountId;
         uint32 _accountFlags;
         std::string _accountName;
@@ -990,6 +1012,10 @@ class SERVER_DECL WorldSession
         static void InitPacketHandlerTable();
         static void loadSpecificHandlers();
 
+        /// TickProfiler counters of the opcodes handled outside of a map tick, the map
+        /// ticks count theirs in MapMgr::m_opcodeProfile
+        static ProfileCounterTable& getUnmappedOpcodeProfile();
+
         uint32 floodLines;
         time_t floodTime;
 
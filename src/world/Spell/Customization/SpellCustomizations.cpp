@@ -21,11 +21,17 @@
 #include "SpellCustomizations.hpp"
 #include "Server/MainServerDefines.h"
 #include "Spell/SpellAuras.h"
+#include "Server/World.h"
 #include "Singleton.h"
+#include "Util.hpp"
+#include "crc32.h"
+#include <git_version.h>
 #include <unordered_map>
 
 initialiseSingleton(SpellCustomizations);
 
+extern void CreateDummySpell(uint32 id);
+
 ///\brief: This file includes all setted custom values and/or spell.dbc values (overwrite)
 /// Set the values you want based on spell Id (Do not set your values based on some text!)
 
@@ -840,3 +846,250 @@ void SpellCustomizations::SetAlwaysApply(SpellInfo* spell_entry)
             break;
     }
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SpellInfo cache
+//
+// File layout: SpellInfoCacheHeader, then spellCount records of
+// { uint32 id, uint8 has_aura_factory, SpellInfo bytes before Name, SpellInfo bytes between
+// BuffDescription and SpellFactoryFunc }, then dummySpellCount uint32 ids.
+// Strings and function pointers are never written, they are restored from the DBC and code.
+
+namespace
+{
+    const uint32 SPELL_INFO_CACHE_MAGIC = 0x43495341;   // "ASIC"
+    const uint32 SPELL_INFO_CACHE_VERSION = 1;
+
+    struct SpellInfoCacheHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 spellInfoSize;
+        uint32 checksum;
+        uint32 spellCount;
+        uint32 dummySpellCount;
+    };
+
+    struct SpellInfoCacheLayout
+    {
+        size_t headSize;        // bytes in front of Name
+        size_t tailOffset;      // first byte behind BuffDescription
+        size_t tailSize;        // bytes up to SpellFactoryFunc
+
+        SpellInfoCacheLayout()
+        {
+            SpellInfo sample;
+            const char* base = reinterpret_cast<const char*>(&sample);
+
+            headSize = reinterpret_cast<const char*>(&sample.Name) - base;
+            tailOffset = reinterpret_cast<const char*>(&sample.BuffDescription) - base + sizeof(std::string);
+            tailSize = reinterpret_cast<const char*>(&sample.SpellFactoryFunc) - base - tailOffset;
+        }
+
+        size_t recordSize() const { return sizeof(uint32) + sizeof(uint8) + headSize + tailSize; }
+    };
+
+    const char* SpellInfoCacheDBCFiles[] =
+    {
+        "Spell.dbc",
+        "SpellCastTimes.dbc",
+        "SpellDuration.dbc",
+        "SpellRadius.dbc",
+        "SpellRange.dbc",
+#if VERSION_STRING == Cata
+        "SpellAuraOptions.dbc",
+        "SpellAuraRestrictions.dbc",
+        "SpellCastingRequirements.dbc",
+        "SpellCategories.dbc",
+        "SpellClassOptions.dbc",
+        "SpellCooldowns.dbc",
+        "SpellEffect.dbc",
+        "SpellEquippedItems.dbc",
+        "SpellInterrupts.dbc",
+        "SpellLevels.dbc",
+        "SpellPower.dbc",
+        "SpellReagents.dbc",
+        "SpellScaling.dbc",
+        "SpellShapeshift.dbc",
+        "SpellTargetRestrictions.dbc",
+        "SpellTotems.dbc",
+#endif
+        nullptr
+    };
+
+    uint32 fileChecksum(std::string const& fileName)
+    {
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (file == nullptr)
+            return 0;
+
+        std::vector<unsigned char> data;
+        unsigned char buffer[65536];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            data.insert(data.end(), buffer, buffer + read);
+
+        fclose(file);
+        return static_cast<uint32>(crc32(data.data(), static_cast<unsigned int>(data.size())));
+    }
+}
+
+uint32 SpellCustomizations::GetSpellInfoCacheChecksum()
+{
+    std::stringstream key;
+    key << BUILD_HASH_STR << ';';
+
+    const std::string dbcPath = sWorld.settings.server.dataDir + "dbc/";
+    for (uint8 i = 0; SpellInfoCacheDBCFiles[i] != nullptr; ++i)
+        key << fileChecksum(dbcPath + SpellInfoCacheDBCFiles[i]) << ';';
+
+    // every table read by StartSpellCustomization and ApplyNormalFixes
+    if (QueryResult* result = WorldDatabase.Query("CHECKSUM TABLE spell_ranks, spell_custom_assign, spell_coef_flags, spell_proc, spell_coef_override"))
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            key << (fields[0].GetString() ? fields[0].GetString() : "") << '=' << (fields[1].GetString() ? fields[1].GetString() : "") << ';';
+        } while (result->NextRow());
+        delete result;
+    }
+
+    const std::string keyString = key.str();
+    return static_cast<uint32>(crc32(reinterpret_cast<const unsigned char*>(keyString.c_str()), static_cast<unsigned int>(keyString.length())));
+}
+
+bool SpellCustomizations::LoadSpellInfoCache(std::string const& fileName)
+{
+    auto startTime = Util::TimeNow();
+
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr)
+    {
+        LogNotice("SpellCustomizations : No spell cache found at %s, it will be created.", fileName.c_str());
+        return false;
+    }
+
+    SpellInfoCacheHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != SPELL_INFO_CACHE_MAGIC || header.version != SPELL_INFO_CACHE_VERSION || header.spellInfoSize != sizeof(SpellInfo))
+    {
+        LogNotice("SpellCustomizations : Spell cache %s has an unknown format, it will be rebuilt.", fileName.c_str());
+        fclose(file);
+        return false;
+    }
+
+    if (header.checksum != GetSpellInfoCacheChecksum())
+    {
+        LogNotice("SpellCustomizations : Spell cache %s is outdated (dbc, database or build changed), it will be rebuilt.", fileName.c_str());
+        fclose(file);
+        return false;
+    }
+
+    const SpellInfoCacheLayout layout;
+    const size_t dataSize = header.spellCount * layout.recordSize() + header.dummySpellCount * sizeof(uint32);
+
+    std::vector<char> data(dataSize);
+    const bool complete = dataSize == 0 || fread(data.data(), dataSize, 1, file) == 1;
+    fclose(file);
+
+    if (!complete)
+    {
+        LOG_ERROR("Spell cache %s is truncated, it will be rebuilt.", fileName.c_str());
+        return false;
+    }
+
+    // base values and strings still come from the dbc
+    LoadSpellInfoData();
+
+    if (_spellInfoContainerStore.size() != header.spellCount)
+    {
+        LOG_ERROR("Spell cache %s does not match the loaded dbc, it will be rebuilt.", fileName.c_str());
+        _spellInfoContainerStore.clear();
+        return false;
+    }
+
+    const char* record = data.data();
+    for (uint32 i = 0; i < header.spellCount; ++i, record += layout.recordSize())
+    {
+        uint32 spell_id;
+        memcpy(&spell_id, record, sizeof(uint32));
+
+        SpellInfo* spell_entry = GetSpellInfo(spell_id);
+        if (spell_entry == nullptr)
+        {
+            LOG_ERROR("Spell cache %s contains unknown spell %u, it will be rebuilt.", fileName.c_str(), spell_id);
+            _spellInfoContainerStore.clear();
+            return false;
+        }
+
+        const bool has_aura_factory = record[sizeof(uint32)] != 0;
+        const char* values = record + sizeof(uint32) + sizeof(uint8);
+
+        memcpy(reinterpret_cast<char*>(spell_entry), values, layout.headSize);
+        memcpy(reinterpret_cast<char*>(spell_entry) + layout.tailOffset, values + layout.headSize, layout.tailSize);
+
+        spell_entry->AuraFactoryFunc = has_aura_factory ? (void * (*)) &AbsorbAura::Create : nullptr;
+    }
+
+    for (uint32 i = 0; i < header.dummySpellCount; ++i, record += sizeof(uint32))
+    {
+        uint32 spell_id;
+        memcpy(&spell_id, record, sizeof(uint32));
+        CreateDummySpell(spell_id);
+    }
+
+    LogNotice("SpellCustomizations : Loaded %u spells from cache %s in %u ms", header.spellCount, fileName.c_str(), static_cast<uint32>(Util::GetTimeDifferenceToNow(startTime)));
+    return true;
+}
+
+void SpellCustomizations::SaveSpellInfoCache(std::string const& fileName)
+{
+    const SpellInfoCacheLayout layout;
+
+    SpellInfoCacheHeader header;
+    header.magic = SPELL_INFO_CACHE_MAGIC;
+    header.version = SPELL_INFO_CACHE_VERSION;
+    header.spellInfoSize = sizeof(SpellInfo);
+    header.checksum = GetSpellInfoCacheChecksum();
+    header.spellCount = static_cast<uint32>(_spellInfoContainerStore.size());
+    header.dummySpellCount = static_cast<uint32>(sWorld.dummySpellList.size());
+
+    std::vector<char> data;
+    data.reserve(sizeof(header) + header.spellCount * layout.recordSize() + header.dummySpellCount * sizeof(uint32));
+    data.insert(data.end(), reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+
+    for (auto it = _spellInfoContainerStore.begin(); it != _spellInfoContainerStore.end(); ++it)
+    {
+        const char* spell_entry = reinterpret_cast<const char*>(&it->second);
+        const uint8 has_aura_factory = it->second.AuraFactoryFunc != nullptr ? 1 : 0;
+
+        data.insert(data.end(), reinterpret_cast<const char*>(&it->first), reinterpret_cast<const char*>(&it->first) + sizeof(uint32));
+        data.push_back(static_cast<char>(has_aura_factory));
+        data.insert(data.end(), spell_entry, spell_entry + layout.headSize);
+        data.insert(data.end(), spell_entry + layout.tailOffset, spell_entry + layout.tailOffset + layout.tailSize);
+    }
+
+    for (auto dummy : sWorld.dummySpellList)
+        data.insert(data.end(), reinterpret_cast<const char*>(&dummy->Id), reinterpret_cast<const char*>(&dummy->Id) + sizeof(uint32));
+
+    // write to a temporary file first so an interrupted boot never leaves a half written cache behind
+    const std::string tempFileName = fileName + ".tmp";
+    FILE* file = fopen(tempFileName.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOG_ERROR("Could not create spell cache %s", tempFileName.c_str());
+        return;
+    }
+
+    const bool written = fwrite(data.data(), data.size(), 1, file) == 1;
+    fclose(file);
+
+    remove(fileName.c_str());
+    if (!written || rename(tempFileName.c_str(), fileName.c_str()) != 0)
+    {
+        LOG_ERROR("Could not write spell cache %s", fileName.c_str());
+        remove(tempFileName.c_str());
+        return;
+    }
+
+    LogDetail("SpellCustomizations : Saved %u spells to cache %s (%u bytes)", header.spellCount, fileName.c_str(), static_cast<uint32>(data.size()));
+}
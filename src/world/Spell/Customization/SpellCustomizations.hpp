@@ -52,7 +52,17 @@ public:
     void SetOnShapeshiftChange(SpellInfo* spell_entry);
     void SetAlwaysApply(SpellInfo* spell_entry);
 
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // Binary cache of the fully customized spell table (after StartSpellCustomization and
+    // ApplyNormalFixes). It is keyed by the build hash, the spell related DBC files and the
+    // customization tables, so a changed input simply falls back to the normal load path.
+    bool LoadSpellInfoCache(std::string const& fileName);
+    void SaveSpellInfoCache(std::string const& fileName);
+
     SpellInfoContainer _spellInfoContainerStore;
+
+private:
+    uint32 GetSpellInfoCacheChecksum();
 };
 
 #define sSpellCustomizations SpellCustomizations::getSingleton()
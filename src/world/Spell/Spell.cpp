@@ -425,60 +425,61 @@ void Spell::FillSpecifiedTargetsInArea(float srcx, float srcy, float srcz, uint3
 // for the moment we do invisible targets
 void Spell::FillSpecifiedTargetsInArea(uint32 i, float srcx, float srcy, float srcz, float range, uint32 specification)
 {
+    if (!m_caster->IsInWorld())
+        return;
+
     TargetsList* tmpMap = &m_targetUnits[i];
     //IsStealth()
-    float r = range * range;
     uint8 did_hit_result;
 
-    for (std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); ++itr)
+    m_caster->GetMapMgr()->ForEachUnitInRadius(srcx, srcy, srcz, range, [&](Unit* target) -> bool
     {
-        // don't add objects that are not units and that are dead
-        if (!((*itr)->IsUnit()) || !static_cast<Unit*>(*itr)->isAlive())
-            continue;
+        // don't add ourself and units that are dead
+        if (target == m_caster || !target->isAlive())
+            return true;
 
         if (GetSpellInfo()->TargetCreatureType)
         {
-            if (!(*itr)->IsCreature())
-                continue;
-            CreatureProperties const* inf = static_cast<Creature*>(*itr)->GetCreatureProperties();
+            if (!target->IsCreature())
+                return true;
+            CreatureProperties const* inf = static_cast<Creature*>(target)->GetCreatureProperties();
             if (!(1 << (inf->Type - 1) & GetSpellInfo()->TargetCreatureType))
-                continue;
+                return true;
         }
 
-        if (IsInrange(srcx, srcy, srcz, (*itr), r))
+        if (u_caster != NULL)
         {
-            if (u_caster != NULL)
+            if (isAttackable(u_caster, target, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
             {
-                if (isAttackable(u_caster, *itr, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                {
-                    did_hit_result = DidHit(i, static_cast<Unit*>(*itr));
-                    if (did_hit_result != SPELL_DID_HIT_SUCCESS)
-                        ModeratedTargets.push_back(SpellTargetMod((*itr)->GetGUID(), did_hit_result));
-                    else
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                }
-
+                did_hit_result = DidHit(i, target);
+                if (did_hit_result != SPELL_DID_HIT_SUCCESS)
+                    ModeratedTargets.push_back(SpellTargetMod(target->GetGUID(), did_hit_result));
+                else
+                    SafeAddTarget(tmpMap, target->GetGUID());
             }
-            else //cast from GO
+
+        }
+        else //cast from GO
+        {
+            if (g_caster && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner)
             {
-                if (g_caster && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner)
-                {
-                    //trap, check not to attack owner and friendly
-                    if (isAttackable(g_caster->m_summoner, *itr, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                }
-                else
-                    SafeAddTarget(tmpMap, (*itr)->GetGUID());
+                //trap, check not to attack owner and friendly
+                if (isAttackable(g_caster->m_summoner, target, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
+                    SafeAddTarget(tmpMap, target->GetGUID());
             }
-            if (GetSpellInfo()->MaxTargets)
+            else
+                SafeAddTarget(tmpMap, target->GetGUID());
+        }
+        if (GetSpellInfo()->MaxTargets)
+        {
+            if (GetSpellInfo()->MaxTargets >= tmpMap->size())
             {
-                if (GetSpellInfo()->MaxTargets >= tmpMap->size())
-                {
-                    return;
-                }
+                return false;
             }
         }
-    }
+
+        return true;
+    });
 }
 void Spell::FillAllTargetsInArea(LocationVector & location, uint32 ind)
 {
@@ -493,139 +494,135 @@ void Spell::FillAllTargetsInArea(float srcx, float srcy, float srcz, uint32 ind)
 /// We fill all the targets in the area, including the stealth ed one's
 void Spell::FillAllTargetsInArea(uint32 i, float srcx, float srcy, float srcz, float range)
 {
+    if (!m_caster->IsInWorld())
+        return;
+
     TargetsList* tmpMap = &m_targetUnits[i];
-    float r = range * range;
     uint8 did_hit_result;
-    std::set<Object*>::iterator itr, itr2;
 
-    for (itr2 = m_caster->GetInRangeSetBegin(); itr2 != m_caster->GetInRangeSetEnd();)
+    m_caster->GetMapMgr()->ForEachUnitInRadius(srcx, srcy, srcz, range, [&](Unit* target) -> bool
     {
-        itr = itr2;
-        //maybe scripts can change list. Should use lock instead of this to prevent multiple changes. This protects to 1 deletion only
-        ++itr2;
-        if (!((*itr)->IsUnit()) || !static_cast<Unit*>(*itr)->isAlive())      //|| (TO< Creature* >(*itr)->IsTotem() && !TO< Unit* >(*itr)->IsPlayer())) why shouldn't we fill totems?
-            continue;
+        if (target == m_caster || !target->isAlive())      //|| (TO< Creature* >(*itr)->IsTotem() && !TO< Unit* >(*itr)->IsPlayer())) why shouldn't we fill totems?
+            return true;
 
-        if (p_caster && (*itr)->IsPlayer() && p_caster->GetGroup() && static_cast<Player*>(*itr)->GetGroup() && static_cast<Player*>(*itr)->GetGroup() == p_caster->GetGroup())      //Don't attack party members!!
+        if (p_caster && target->IsPlayer() && p_caster->GetGroup() && static_cast<Player*>(target)->GetGroup() && static_cast<Player*>(target)->GetGroup() == p_caster->GetGroup())      //Don't attack party members!!
         {
             //Dueling - AoE's should still hit the target party member if you're dueling with him
-            if (!p_caster->DuelingWith || p_caster->DuelingWith != static_cast<Player*>(*itr))
-                continue;
+            if (!p_caster->DuelingWith || p_caster->DuelingWith != static_cast<Player*>(target))
+                return true;
         }
         if (GetSpellInfo()->TargetCreatureType)
         {
-            if (!(*itr)->IsCreature())
-                continue;
-            CreatureProperties const* inf = static_cast<Creature*>(*itr)->GetCreatureProperties();
+            if (!target->IsCreature())
+                return true;
+            CreatureProperties const* inf = static_cast<Creature*>(target)->GetCreatureProperties();
             if (!(1 << (inf->Type - 1) & GetSpellInfo()->TargetCreatureType))
-                continue;
+                return true;
         }
-        if (IsInrange(srcx, srcy, srcz, (*itr), r))
+
+        if (worldConfig.terrainCollision.isCollisionEnabled)
         {
-            if (worldConfig.terrainCollision.isCollisionEnabled)
-            {
-                VMAP::IVMapManager* mgr = VMAP::VMapFactory::createOrGetVMapManager();
-                bool isInLOS = mgr->isInLineOfSight(m_caster->GetMapId(), m_caster->GetPositionX(), m_caster->GetPositionY(), m_caster->GetPositionZ(), (*itr)->GetPositionX(), (*itr)->GetPositionY(), (*itr)->GetPositionZ());
+            VMAP::IVMapManager* mgr = VMAP::VMapFactory::createOrGetVMapManager();
+            bool isInLOS = mgr->isInLineOfSight(m_caster->GetMapId(), m_caster->GetPositionX(), m_caster->GetPositionY(), m_caster->GetPositionZ(), target->GetPositionX(), target->GetPositionY(), target->GetPositionZ());
 
-                if (m_caster->GetMapId() == (*itr)->GetMapId() && !isInLOS)
-                    continue;
-            }
+            if (!isInLOS)
+                return true;
+        }
 
-            if (u_caster != NULL)
+        if (u_caster != NULL)
+        {
+            if (isAttackable(u_caster, target, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
             {
-                if (isAttackable(u_caster, *itr, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                {
-                    did_hit_result = DidHit(i, static_cast<Unit*>(*itr));
-                    if (did_hit_result == SPELL_DID_HIT_SUCCESS)
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                    else
-                        ModeratedTargets.push_back(SpellTargetMod((*itr)->GetGUID(), did_hit_result));
-                }
+                did_hit_result = DidHit(i, target);
+                if (did_hit_result == SPELL_DID_HIT_SUCCESS)
+                    SafeAddTarget(tmpMap, target->GetGUID());
+                else
+                    ModeratedTargets.push_back(SpellTargetMod(target->GetGUID(), did_hit_result));
             }
-            else //cast from GO
+        }
+        else //cast from GO
+        {
+            if (g_caster != NULL && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner != NULL)
             {
-                if (g_caster != NULL && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner != NULL)
-                {
-                    //trap, check not to attack owner and friendly
-                    if (isAttackable(g_caster->m_summoner, *itr, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                }
-                else
-                    SafeAddTarget(tmpMap, (*itr)->GetGUID());
+                //trap, check not to attack owner and friendly
+                if (isAttackable(g_caster->m_summoner, target, !(GetSpellInfo()->custom_c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
+                    SafeAddTarget(tmpMap, target->GetGUID());
             }
-            if (GetSpellInfo()->MaxTargets)
-                if (GetSpellInfo()->MaxTargets == tmpMap->size())
-                {
-                    return;
-                }
+            else
+                SafeAddTarget(tmpMap, target->GetGUID());
         }
-    }
+        if (GetSpellInfo()->MaxTargets)
+            if (GetSpellInfo()->MaxTargets == tmpMap->size())
+            {
+                return false;
+            }
+
+        return true;
+    });
 }
 
 // We fill all the targets in the area, including the stealthed ones
 void Spell::FillAllFriendlyInArea(uint32 i, float srcx, float srcy, float srcz, float range)
 {
+    if (!m_caster->IsInWorld())
+        return;
+
     TargetsList* tmpMap = &m_targetUnits[i];
-    float r = range * range;
     uint8 did_hit_result;
-    std::set<Object*>::iterator itr, itr2;
 
-    for (itr2 = m_caster->GetInRangeSetBegin(); itr2 != m_caster->GetInRangeSetEnd();)
+    m_caster->GetMapMgr()->ForEachUnitInRadius(srcx, srcy, srcz, range, [&](Unit* target) -> bool
     {
-        itr = itr2;
-        ++itr2; //maybe scripts can change list. Should use lock instead of this to prevent multiple changes. This protects to 1 deletion only
-        if (!((*itr)->IsUnit()) || !static_cast<Unit*>(*itr)->isAlive())
-            continue;
+        if (target == m_caster || !target->isAlive())
+            return true;
 
         if (GetSpellInfo()->TargetCreatureType)
         {
-            if (!(*itr)->IsCreature())
-                continue;
-            CreatureProperties const* inf = static_cast<Creature*>(*itr)->GetCreatureProperties();
+            if (!target->IsCreature())
+                return true;
+            CreatureProperties const* inf = static_cast<Creature*>(target)->GetCreatureProperties();
             if (!(1 << (inf->Type - 1) & GetSpellInfo()->TargetCreatureType))
-                continue;
+                return true;
         }
 
-        if (IsInrange(srcx, srcy, srcz, (*itr), r))
+        if (worldConfig.terrainCollision.isCollisionEnabled)
         {
-            if (worldConfig.terrainCollision.isCollisionEnabled)
-            {
-                VMAP::IVMapManager* mgr = VMAP::VMapFactory::createOrGetVMapManager();
-                bool isInLOS = mgr->isInLineOfSight(m_caster->GetMapId(), m_caster->GetPositionX(), m_caster->GetPositionY(), m_caster->GetPositionZ(), (*itr)->GetPositionX(), (*itr)->GetPositionY(), (*itr)->GetPositionZ());
+            VMAP::IVMapManager* mgr = VMAP::VMapFactory::createOrGetVMapManager();
+            bool isInLOS = mgr->isInLineOfSight(m_caster->GetMapId(), m_caster->GetPositionX(), m_caster->GetPositionY(), m_caster->GetPositionZ(), target->GetPositionX(), target->GetPositionY(), target->GetPositionZ());
 
-                if (m_caster->GetMapId() == (*itr)->GetMapId() && !isInLOS)
-                    continue;
-            }
+            if (!isInLOS)
+                return true;
+        }
 
-            if (u_caster != NULL)
+        if (u_caster != NULL)
+        {
+            if (isFriendly(u_caster, target))
             {
-                if (isFriendly(u_caster, static_cast<Unit*>(*itr)))
-                {
-                    did_hit_result = DidHit(i, static_cast<Unit*>(*itr));
-                    if (did_hit_result == SPELL_DID_HIT_SUCCESS)
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                    else
-                        ModeratedTargets.push_back(SpellTargetMod((*itr)->GetGUID(), did_hit_result));
-                }
+                did_hit_result = DidHit(i, target);
+                if (did_hit_result == SPELL_DID_HIT_SUCCESS)
+                    SafeAddTarget(tmpMap, target->GetGUID());
+                else
+                    ModeratedTargets.push_back(SpellTargetMod(target->GetGUID(), did_hit_result));
             }
-            else //cast from GO
+        }
+        else //cast from GO
+        {
+            if (g_caster != NULL && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner != NULL)
             {
-                if (g_caster != NULL && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner != NULL)
-                {
-                    //trap, check not to attack owner and friendly
-                    if (isFriendly(g_caster->m_summoner, static_cast<Unit*>(*itr)))
-                        SafeAddTarget(tmpMap, (*itr)->GetGUID());
-                }
-                else
-                    SafeAddTarget(tmpMap, (*itr)->GetGUID());
+                //trap, check not to attack owner and friendly
+                if (isFriendly(g_caster->m_summoner, target))
+                    SafeAddTarget(tmpMap, target->GetGUID());
             }
-            if (GetSpellInfo()->MaxTargets)
-                if (GetSpellInfo()->MaxTargets == tmpMap->size())
-                {
-                    return;
-                }
+            else
+                SafeAddTarget(tmpMap, target->GetGUID());
         }
-    }
+        if (GetSpellInfo()->MaxTargets)
+            if (GetSpellInfo()->MaxTargets == tmpMap->size())
+            {
+                return false;
+            }
+
+        return true;
+    });
 }
 
 uint64 Spell::GetSinglePossibleEnemy(uint32 i, float prange)
@@ -5402,7 +5399,7 @@ void Spell::Heal(int32 amount, bool ForceCrit)
 
     uint32 overheal = 0;
     uint32 curHealth = unitTarget->GetUInt32Value(UNIT_FIELD_HEALTH);
-    uint32 maxHealth = unitTarget->GetUInt32Value(UNIT_FIELD_MAXHEALTH);
+    uint32 maxHealth = unitTarget->GetMaxHealth();
     if ((curHealth + amount) >= maxHealth)
     {
         unitTarget->SetHealth(maxHealth);
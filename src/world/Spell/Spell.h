@@ -25,6 +25,7 @@
 #include "Spell/Customization/SpellCustomizations.hpp"
 #include "SpellTarget.h"
 #include "SpellFailure.h"
+#include "Map/MapObjectPool.h"
 #include "Units/Creatures/AIInterface.h"
 #include "Units/Creatures/Creature.h"
 #include "Units/Players/Player.h"
@@ -1553,6 +1554,8 @@ class SERVER_DECL Spell : public EventableObject
 {
     public:
 
+        MAP_POOLED_OBJECT(MAP_POOL_SPELL)
+
         friend class DummySpellHandler;
         Spell(Object* Caster, SpellInfo* info, bool triggered, Aura* aur);
         ~Spell();
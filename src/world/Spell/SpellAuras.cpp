@@ -881,7 +881,7 @@ void Aura::Remove()
 
     // maybe we are removing it without even assigning it. Example when we are refreshing an aura
     if (m_auraSlot != 0xFFFF)
-        m_target->m_auras[m_auraSlot] = NULL;
+        m_target->setAuraInSlot(m_auraSlot, nullptr);
 
     // reset diminishing return timer if needed
     ::UnapplyDiminishingReturnTimer(m_target, m_spellInfo);
@@ -941,13 +941,17 @@ void Aura::Remove()
     if (flag != 0)
         m_target->RemoveFlag(UNIT_FIELD_AURASTATE, flag);
 
+    // the battleground queue skips deserters, match the queue of the player again
+    if (m_spellInfo->Id == BG_DESERTER && m_target->IsPlayer())
+        BattlegroundManager.OnQueuedPlayerChanged(static_cast<Player*>(m_target));
+
     // We will delete this on the next update, eluding some spell crashes :|
     m_target->AddGarbageAura(this);
     m_target->UpdateAuraForGroup(static_cast<uint8>(m_auraSlot));
 
     // maybe we are removing it without even assigning it. Example when we are refreshing an aura
     if (m_auraSlot != 0xFFFF)
-        m_target->m_auras[m_auraSlot] = NULL;
+        m_target->setAuraInSlot(m_auraSlot, nullptr);
 
     // only remove channel stuff if caster == target, then it's not removed twice, for example, arcane missiles applies a dummy aura to target
     if (caster != NULL && caster == m_target && m_spellInfo->ChannelInterruptFlags != 0)
@@ -1619,13 +1623,13 @@ void Aura::SpellAuraModBaseResistancePerc(bool apply)
                 {
                     static_cast< Player* >(m_target)->BaseResistanceModPctNeg[x] -= amt;
                 }
-                static_cast< Player* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
 
             }
             else if (m_target->IsCreature())
             {
                 static_cast< Creature* >(m_target)->BaseResistanceModPct[x] += amt;
-                static_cast< Creature* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
         }
     }
@@ -2391,12 +2395,13 @@ void Aura::SpellAuraModAttackSpeed(bool apply)
         {
             static_cast< Player* >(m_target)->ModAttackSpeed(-mod->m_amount, MOD_MELEE);
         }
-        static_cast< Player* >(m_target)->UpdateStats();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
     else
     {
         if (apply)
         {
+            m_target->flushDirtyStats();
             mod->fixed_amount[0] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME, mod->m_amount);
             mod->fixed_amount[1] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1, mod->m_amount);
             mod->fixed_amount[2] = m_target->GetModPUInt32Value(UNIT_FIELD_RANGEDATTACKTIME, mod->m_amount);
@@ -2663,7 +2668,7 @@ void Aura::SpellAuraModDamageDone(bool apply)
     }
 
     if (mod->m_miscValue & 1)
-        m_target->CalcDamage();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModDamageTaken(bool apply)
@@ -3040,7 +3045,7 @@ void Aura::SpellAuraModResistance(bool apply)
                     static_cast< Player* >(m_target)->FlatResistanceModifierPos[x] += amt;
                 else
                     static_cast< Player* >(m_target)->FlatResistanceModifierNeg[x] -= amt;
-                static_cast< Player* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
         }
     }
@@ -3051,7 +3056,7 @@ void Aura::SpellAuraModResistance(bool apply)
             if (Flag & (((uint32)1) << x))
             {
                 static_cast< Creature* >(m_target)->FlatResistanceMod[x] += amt;
-                static_cast< Creature* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
         }
     }
@@ -3348,8 +3353,7 @@ void Aura::SpellAuraModStat(bool apply)
                 static_cast< Player* >(m_target)->CalcStat(x);
             }
 
-            static_cast< Player* >(m_target)->UpdateStats();
-            static_cast< Player* >(m_target)->UpdateChances();
+            m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else if (m_target->IsCreature())
         {
@@ -3372,8 +3376,7 @@ void Aura::SpellAuraModStat(bool apply)
 
             static_cast< Player* >(m_target)->CalcStat(mod->m_miscValue);
 
-            static_cast< Player* >(m_target)->UpdateStats();
-            static_cast< Player* >(m_target)->UpdateChances();
+            m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else if (m_target->IsCreature())
         {
@@ -3395,7 +3398,7 @@ void Aura::SpellAuraModSkill(bool apply)
         else
             static_cast< Player* >(m_target)->_ModifySkillBonus(mod->m_miscValue, -mod->m_amount);
 
-        static_cast< Player* >(m_target)->UpdateStats();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -3455,7 +3458,7 @@ void Aura::SpellAuraModCreatureRangedAttackPower(bool apply)
             }
         }
     }
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModDecreaseSpeed(bool apply)
@@ -3558,6 +3561,7 @@ void Aura::SpellAuraModIncreaseHealth(bool apply)
     {
         //maybe we should not adjust hitpoints too but only maximum health
         static_cast< Player* >(m_target)->SetHealthFromSpell(static_cast< Player* >(m_target)->GetHealthFromSpell() + amt);
+        // stays eager, the health change below has to see the new maximum
         static_cast< Player* >(m_target)->UpdateStats();
         if (apply)
             m_target->ModHealth(amt);
@@ -3946,8 +3950,7 @@ void Aura::SpellAuraModShapeshift(bool apply)
 
     if (p_target != NULL)
     {
-        p_target->UpdateStats();
-        p_target->UpdateAttackSpeed();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_ATTACK_SPEED);
     }
 }
 
@@ -4200,7 +4203,7 @@ void Aura::SpellAuraModParryPerc(bool apply)
         m_target->SetParryFromSpell(m_target->GetParryFromSpell() + amt);
         if (p_target != NULL)
         {
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
         }
     }
 }
@@ -4224,7 +4227,7 @@ void Aura::SpellAuraModDodgePerc(bool apply)
         m_target->SetDodgeFromSpell(m_target->GetDodgeFromSpell() + amt);
         if (p_target != NULL)
         {
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
         }
     }
 }
@@ -4248,7 +4251,7 @@ void Aura::SpellAuraModBlockPerc(bool apply)
         m_target->SetBlockFromSpell(m_target->GetBlockFromSpell() + amt);
         if (p_target != NULL)
         {
-            p_target->UpdateStats();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
         }
     }
 }
@@ -4279,7 +4282,7 @@ void Aura::SpellAuraModCritPerc(bool apply)
             }*/
             p_target->tocritchance.erase(GetSpellId());
         }
-        p_target->UpdateChances();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
     }
 }
 
@@ -5420,7 +5423,7 @@ void Aura::SpellAuraModDamagePercDone(bool apply)
             }
         }
     }
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModPercStat(bool apply)
@@ -5451,8 +5454,7 @@ void Aura::SpellAuraModPercStat(bool apply)
                 p_target->CalcStat(x);
             }
 
-            p_target->UpdateStats();
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else
         {
@@ -5475,8 +5477,7 @@ void Aura::SpellAuraModPercStat(bool apply)
 
             p_target->CalcStat(mod->m_miscValue);
 
-            p_target->UpdateStats();
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else if (m_target->IsCreature())
         {
@@ -5631,7 +5632,7 @@ void Aura::SpellAuraModPowerRegen(bool apply)
     {
         int32 val = (apply) ? mod->m_amount : -mod->m_amount;
         p_target->m_ModInterrMRegen += val;
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -5890,7 +5891,7 @@ void Aura::SpellAuraSkillTalent(bool apply)
         else
             p_target->_ModifySkillBonus(mod->m_miscValue, -mod->m_amount);
 
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -5901,7 +5902,7 @@ void Aura::SpellAuraModAttackPower(bool apply)
     else
         SetPositive();
     m_target->ModAttackPowerMods(apply ? mod->m_amount : -mod->m_amount);
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraVisible(bool apply)
@@ -5940,13 +5941,13 @@ void Aura::SpellAuraModResistancePCT(bool apply)
                 {
                     p_target->ResistanceModPctNeg[x] -= amt;
                 }
-                p_target->CalcResistance(x);
+                p_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
 
             }
             else if (m_target->IsCreature())
             {
                 static_cast< Creature* >(m_target)->ResistanceModPct[x] += amt;
-                static_cast< Creature* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
         }
     }
@@ -5975,7 +5976,7 @@ void Aura::SpellAuraModCreatureAttackPower(bool apply)
             }
         }
     }
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModTotalThreat(bool apply)
@@ -6323,7 +6324,7 @@ void Aura::SpellAuraModPowerRegPerc(bool apply)
     else
         m_target->PctPowerRegenModifier[mod->m_miscValue] -= ((float)(mod->m_amount)) / 100.0f;
     if (p_target != NULL)
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Aura::SpellAuraOverrideClassScripts(bool apply)
@@ -6574,7 +6575,7 @@ void Aura::SpellAuraModRangedAttackPower(bool apply)
     }
     else
         m_target->ModRangedAttackPowerMods(-mod->m_amount);
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModMeleeDamageTaken(bool apply)
@@ -6634,6 +6635,7 @@ void Aura::SpellAuraModIncreaseEnergyPerc(bool apply)
 
     if (apply)
     {
+        m_target->flushDirtyStats();
         mod->fixed_amount[mod->i] = m_target->GetModPUInt32Value(UNIT_FIELD_MAXPOWER1 + mod->m_miscValue, mod->m_amount);
         m_target->ModMaxPower(mod->m_miscValue, mod->fixed_amount[mod->i]);
         if (p_target != NULL && mod->m_miscValue == POWER_TYPE_MANA)
@@ -6652,6 +6654,7 @@ void Aura::SpellAuraModIncreaseHealthPerc(bool apply)
     SetPositive();
     if (apply)
     {
+        m_target->flushDirtyStats();
         mod->fixed_amount[mod->i] = m_target->GetModPUInt32Value(UNIT_FIELD_MAXHEALTH, mod->m_amount);
         m_target->ModMaxHealth(mod->fixed_amount[mod->i]);
         if (p_target != NULL)
@@ -6662,8 +6665,8 @@ void Aura::SpellAuraModIncreaseHealthPerc(bool apply)
     else
     {
         m_target->ModMaxHealth(-mod->fixed_amount[mod->i]);
-        if (m_target->GetUInt32Value(UNIT_FIELD_HEALTH) > m_target->GetUInt32Value(UNIT_FIELD_MAXHEALTH))
-            m_target->SetHealth(m_target->GetUInt32Value(UNIT_FIELD_MAXHEALTH));
+        if (m_target->GetHealth() > m_target->GetMaxHealth())
+            m_target->SetHealth(m_target->GetMaxHealth());
         if (p_target != NULL)
             p_target->SetHealthFromSpell(static_cast<Player*>(m_target)->GetHealthFromSpell() - mod->fixed_amount[mod->i]);
         //		else if (m_target->IsPet())
@@ -6680,7 +6683,7 @@ void Aura::SpellAuraModManaRegInterrupt(bool apply)
         else
             p_target->m_ModInterrMRegenPCT -= mod->m_amount;
 
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -6707,8 +6710,7 @@ void Aura::SpellAuraModTotalStatPerc(bool apply)
                 p_target->CalcStat(x);
             }
 
-            p_target->UpdateStats();
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else if (m_target->IsCreature())
         {
@@ -6744,8 +6746,7 @@ void Aura::SpellAuraModTotalStatPerc(bool apply)
                 p_target->TotalStatModPctNeg[mod->m_miscValue] -= val;
 
             p_target->CalcStat(mod->m_miscValue);
-            p_target->UpdateStats();
-            p_target->UpdateChances();
+            p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
         }
         else if (m_target->IsCreature())
         {
@@ -6782,19 +6783,20 @@ void Aura::SpellAuraModHaste(bool apply)
             p_target->ModAttackSpeed(-mod->m_amount, MOD_MELEE);
         }
 
-        p_target->UpdateAttackSpeed();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_ATTACK_SPEED);
     }
     else
     {
         if (apply)
         {
+            m_target->flushDirtyStats();
             mod->fixed_amount[mod->i] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME, mod->m_amount);
             mod->fixed_amount[mod->i * 2] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1, mod->m_amount);
 
-            if ((int32)m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME) <= mod->fixed_amount[mod->i])
-                mod->fixed_amount[mod->i] = m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME);    //watch it, a negative timer might be bad ;)
-            if ((int32)m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1) <= mod->fixed_amount[mod->i * 2])
-                mod->fixed_amount[mod->i * 2] = m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1); //watch it, a negative timer might be bad ;)
+            if ((int32)m_target->GetBaseAttackTime(MELEE) <= mod->fixed_amount[mod->i])
+                mod->fixed_amount[mod->i] = m_target->GetBaseAttackTime(MELEE);    //watch it, a negative timer might be bad ;)
+            if ((int32)m_target->GetBaseAttackTime(OFFHAND) <= mod->fixed_amount[mod->i * 2])
+                mod->fixed_amount[mod->i * 2] = m_target->GetBaseAttackTime(OFFHAND); //watch it, a negative timer might be bad ;)
 
             m_target->ModBaseAttackTime(MELEE, -mod->fixed_amount[mod->i]);
             m_target->ModBaseAttackTime(OFFHAND, -mod->fixed_amount[mod->i * 2]);
@@ -6863,7 +6865,7 @@ void Aura::SpellAuraModRangedHaste(bool apply)
         else
             p_target->ModAttackSpeed(-mod->m_amount, MOD_RANGED);
 
-        p_target->UpdateAttackSpeed();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_ATTACK_SPEED);
     }
     else
     {
@@ -6887,7 +6889,7 @@ void Aura::SpellAuraModRangedAmmoHaste(bool apply)
     else
         p_target->ModAttackSpeed(-mod->m_amount, MOD_RANGED);
 
-    p_target->UpdateAttackSpeed();
+    p_target->markStatsDirty(UNIT_STAT_DIRTY_ATTACK_SPEED);
 }
 
 void Aura::SpellAuraModResistanceExclusive(bool apply)
@@ -6953,7 +6955,7 @@ void Aura::SpellAuraModShieldBlockPCT(bool apply)
         {
             p_target->m_modblockabsorbvalue -= (uint32)mod->m_amount;
         }
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -7171,7 +7173,7 @@ void Aura::SpellAuraModPAttackPower(bool apply)
         }
         else
             p_target->ModAttackPowerMultiplier(-(float)mod->m_amount / 100.0f);
-        p_target->CalcDamage();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
     }
 }
 
@@ -7180,7 +7182,7 @@ void Aura::SpellAuraModRangedAttackPowerPct(bool apply)
     if (m_target->IsPlayer())
     {
         m_target->ModRangedAttackPowerMultiplier(((apply) ? 1 : -1) * (float)mod->m_amount / 100);
-        m_target->CalcDamage();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
     }
 }
 
@@ -7651,7 +7653,7 @@ void Aura::SpellAuraModOffhandDamagePCT(bool apply)
         else
             p_target->offhand_dmg_mod /= (100 + mod->m_amount) / 100.0f;
 
-        p_target->CalcDamage();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
     }
 }
 
@@ -7738,12 +7740,12 @@ void Aura::SpellAuraIncreaseArmorByPctInt(bool apply)
             if (p_target != NULL)
             {
                 p_target->FlatResistanceModifierPos[x] += amt;
-                p_target->CalcResistance(x);
+                p_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
             else if (m_target->IsCreature())
             {
                 static_cast< Creature* >(m_target)->FlatResistanceMod[x] += amt;
-                static_cast< Creature* >(m_target)->CalcResistance(x);
+                m_target->markStatsDirty(Unit::getResistanceDirtyFlag(x));
             }
         }
     }
@@ -7843,19 +7845,20 @@ void Aura::SpellAuraMeleeHaste(bool apply)
         else
             static_cast< Player* >(m_target)->ModAttackSpeed(-mod->m_amount, MOD_MELEE);
 
-        static_cast< Player* >(m_target)->UpdateAttackSpeed();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_ATTACK_SPEED);
     }
     else
     {
         if (apply)
         {
+            m_target->flushDirtyStats();
             mod->fixed_amount[0] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME, mod->m_amount);
             mod->fixed_amount[1] = m_target->GetModPUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1, mod->m_amount);
 
-            if ((int32)m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME) <= mod->fixed_amount[0])
-                mod->fixed_amount[0] = m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME);
-            if ((int32)m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1) <= mod->fixed_amount[1])
-                mod->fixed_amount[1] = m_target->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1);
+            if ((int32)m_target->GetBaseAttackTime(MELEE) <= mod->fixed_amount[0])
+                mod->fixed_amount[0] = m_target->GetBaseAttackTime(MELEE);
+            if ((int32)m_target->GetBaseAttackTime(OFFHAND) <= mod->fixed_amount[1])
+                mod->fixed_amount[1] = m_target->GetBaseAttackTime(OFFHAND);
 
             m_target->ModBaseAttackTime(MELEE, -mod->fixed_amount[0]);
             m_target->ModBaseAttackTime(OFFHAND, -mod->fixed_amount[1]);
@@ -7968,7 +7971,7 @@ void Aura::SpellAuraIncreaseAllWeaponSkill(bool apply)
             static_cast< Player* >(m_target)->_ModifySkillBonus(SKILL_POLEARMS, -mod->m_amount);
         }
 
-        static_cast< Player* >(m_target)->UpdateStats();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -7978,7 +7981,7 @@ void Aura::SpellAuraIncreaseHitRate(bool apply)
         return;
 
     static_cast< Player* >(m_target)->ModifyBonuses(SPELL_HIT_RATING, mod->m_amount, apply);
-    static_cast< Player* >(m_target)->UpdateStats();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Aura::SpellAuraIncreaseRageFromDamageDealtPCT(bool apply)
@@ -8130,7 +8133,7 @@ void Aura::SpellAuraIncreaseRating(bool apply)
             }
     }
 
-    plr->UpdateStats();
+    plr->markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Aura::EventPeriodicRegenManaStatPct(uint32 perc, uint32 stat)
@@ -8171,7 +8174,7 @@ void Aura::SpellAuraSpellHealingStatPCT(bool apply)
         mod->realamount = ((m_target->GetUInt32Value(UNIT_FIELD_STAT4) * mod->m_amount) / 100);
 
         static_cast<Player*>(m_target)->ModifyBonuses(CRITICAL_STRIKE_RATING, mod->realamount, true);
-        static_cast<Player*>(m_target)->UpdateChances();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
     }
     else
     {
@@ -8179,7 +8182,7 @@ void Aura::SpellAuraSpellHealingStatPCT(bool apply)
             m_target->HealDoneMod[x] -= mod->realamount;*/
 
         static_cast<Player*>(m_target)->ModifyBonuses(CRITICAL_STRIKE_RATING, mod->realamount, false);
-        static_cast<Player*>(m_target)->UpdateChances();
+        m_target->markStatsDirty(UNIT_STAT_DIRTY_CHANCES);
     }
 }
 
@@ -8242,7 +8245,7 @@ void Aura::SpellAuraIncreaseMaxHealth(bool apply)
         amount = -mod->m_amount;
 
     static_cast< Player* >(m_target)->SetHealthFromSpell(static_cast< Player* >(m_target)->GetHealthFromSpell() + amount);
-    static_cast< Player* >(m_target)->UpdateStats();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Aura::SpellAuraSpiritOfRedemption(bool apply)
@@ -8316,7 +8319,7 @@ void Aura::SpellAuraIncreaseRAPbyStatPct(bool apply)
     else
         m_target->ModRangedAttackPowerMods(-mod->fixed_amount[mod->i]);
 
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 /* not used
@@ -8346,7 +8349,7 @@ void Aura::SpellAuraModBlockValue(bool apply)
             amt = -mod->m_amount;
         }
         p_target->m_modblockvaluefromspells += amt;
-        p_target->UpdateStats();
+        p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -8526,7 +8529,7 @@ void Aura::SpellAuraAddHealth(bool apply)
     else
     {
         m_target->ModMaxHealth(-mod->m_amount);
-        uint32 maxHealth = m_target->GetUInt32Value(UNIT_FIELD_MAXHEALTH);
+        uint32 maxHealth = m_target->GetMaxHealth();
         if (m_target->GetUInt32Value(UNIT_FIELD_HEALTH) > maxHealth)
             m_target->SetUInt32Value(UNIT_FIELD_MAXHEALTH, maxHealth);
     }
@@ -8637,7 +8640,7 @@ void Aura::SpellAuraIncreaseAPbyStatPct(bool apply)
     else
         m_target->ModAttackPowerMods(-mod->fixed_amount[mod->i]);
 
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraModSpellDamageDOTPct(bool apply)
@@ -8736,7 +8739,7 @@ void Aura::SpellAuraModBaseHealth(bool apply)
         amt *= -1;
 
     p_target->SetHealthFromSpell(p_target->GetHealthFromSpell() + amt);
-    p_target->UpdateStats();
+    p_target->markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Aura::SpellAuraModAttackPowerOfArmor(bool apply)
@@ -8764,7 +8767,7 @@ void Aura::SpellAuraModAttackPowerOfArmor(bool apply)
     else
         m_target->ModAttackPowerMods(-mod->fixed_amount[mod->i]);
 
-    m_target->CalcDamage();
+    m_target->markStatsDirty(UNIT_STAT_DIRTY_DAMAGE);
 }
 
 void Aura::SpellAuraDeflectSpells(bool apply)
@@ -417,6 +417,8 @@ class SERVER_DECL Aura : public EventableObject
 {
     public:
 
+        MAP_POOLED_OBJECT(MAP_POOL_AURA)
+
         Aura(SpellInfo* proto, int32 duration, Object* caster, Unit* target, bool temporary = false, Item* i_caster = NULL);
         ~Aura();
 
@@ -987,15 +987,15 @@ void Spell::SpellEffectSchoolDMG(uint32 i) // dmg school
             case 25742:
             {
                 if (p_caster != nullptr)
-                    dmg = static_cast<uint32>(std::round(p_caster->GetUInt32Value(UNIT_FIELD_BASEATTACKTIME) / 1000 * ((0.022 * (p_caster->GetAP()) + (0.044 * (p_caster->GetDamageDoneMod(1))))) + m_spellInfo->EffectBasePoints[i]));
+                    dmg = static_cast<uint32>(std::round(p_caster->GetBaseAttackTime(MELEE) / 1000 * ((0.022 * (p_caster->GetAP()) + (0.044 * (p_caster->GetDamageDoneMod(1))))) + m_spellInfo->EffectBasePoints[i]));
             }break;
             case 9799:
             case 25988:
             {
                 if (p_caster != nullptr)
                 {
-                    if (dmg > (p_caster->GetUInt32Value(UNIT_FIELD_MAXHEALTH) / 2))
-                        dmg = (p_caster->GetUInt32Value(UNIT_FIELD_MAXHEALTH) / 2);
+                    if (dmg > (p_caster->GetMaxHealth() / 2))
+                        dmg = (p_caster->GetMaxHealth() / 2);
                 }
             }break;
             case 3044:
@@ -1565,7 +1565,7 @@ void Spell::SpellEffectHealthLeech(uint32 i) // Health Leech
     if (!u_caster)
         return;
     uint32 playerCurHealth = u_caster->GetUInt32Value(UNIT_FIELD_HEALTH);
-    uint32 playerMaxHealth = u_caster->GetUInt32Value(UNIT_FIELD_MAXHEALTH);
+    uint32 playerMaxHealth = u_caster->GetMaxHealth();
 
     if (playerCurHealth + amt > playerMaxHealth)
     {
@@ -1668,7 +1668,7 @@ void Spell::SpellEffectHeal(uint32 i) // Heal
                     mPlayer->GetShapeShift() != FORM_BEAR &&
                     mPlayer->GetShapeShift() != FORM_DIREBEAR))
                     break;
-                uint32 max = mPlayer->GetUInt32Value(UNIT_FIELD_MAXHEALTH);
+                uint32 max = mPlayer->GetMaxHealth();
                 uint32 val = float2int32(((mPlayer->getAuraWithId(34300)) ? 0.04f : 0.02f) * max);
                 if (val)
                     mPlayer->Heal(mPlayer, 34299, (uint32)(val));
@@ -1687,7 +1687,7 @@ void Spell::SpellEffectHeal(uint32 i) // Heal
                 uint32 val = mPlayer->GetPower(POWER_TYPE_RAGE);
                 if (val > 100)
                     val = 100;
-                uint32 HpPerPoint = float2int32((mPlayer->GetUInt32Value(UNIT_FIELD_MAXHEALTH) * 0.003f));   //0.3% of hp per point of rage
+                uint32 HpPerPoint = float2int32((mPlayer->GetMaxHealth() * 0.003f));   //0.3% of hp per point of rage
                 uint32 heal = HpPerPoint * (val / 10); //1 point of rage = 0.3% of max hp
                 mPlayer->ModPower(POWER_TYPE_RAGE, -1 * val);
 
@@ -2746,11 +2746,10 @@ void Spell::SpellEffectLeap(uint32 i) // Leap
     unitTarget->RemoveAurasByInterruptFlag(AURA_INTERRUPT_ON_ANY_DAMAGE_TAKEN);
 
     MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-    dtNavMesh* nav = const_cast<dtNavMesh*>(mmap->GetNavMesh(m_caster->GetMapId()));
-    dtNavMeshQuery* nav_query = const_cast<dtNavMeshQuery*>(mmap->GetNavMeshQuery(m_caster->GetMapId(), m_caster->GetInstanceID()));
     //NavMeshData* nav = CollideInterface.GetNavMesh(m_caster->GetMapId());
 
-    if (nav != nullptr)
+    // only checks for a navmesh, the teleport below may load navmesh tiles
+    if (mmap->HasNavMesh(m_caster->GetMapId()))
     {
         float destx, desty, destz;
         unitTarget->GetPoint(unitTarget->GetOrientation(), radius, destx, desty, destz);
@@ -4081,7 +4080,7 @@ void Spell::SpellEffectHealMaxHealth(uint32 i)   // Heal Max Health
     if (!unitTarget || !unitTarget->isAlive())
         return;
 
-    uint32 dif = unitTarget->GetUInt32Value(UNIT_FIELD_MAXHEALTH) - unitTarget->GetUInt32Value(UNIT_FIELD_HEALTH);
+    uint32 dif = unitTarget->GetMaxHealth() - unitTarget->GetHealth();
     if (!dif)
     {
         SendCastResult(SPELL_FAILED_ALREADY_AT_FULL_HEALTH);
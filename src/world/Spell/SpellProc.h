@@ -24,6 +24,7 @@
 class SpellProc;
 class Object;
 #include "SpellInfo.hpp"
+#include "Map/MapObjectPool.h"
 
 class Unit;
 
@@ -39,6 +40,8 @@ class SpellProc
 {
     public:
 
+        MAP_POOLED_OBJECT(MAP_POOL_SPELL_PROC)
+
         ~SpellProc()
         {
         }
@@ -0,0 +1,135 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SpellProc;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// Proc trigger spells of a unit, indexed by proc flag bit.
+///
+/// HandleProc only looks at procs sharing at least one bit with the event flags, which is
+/// what the default SpellProc::CheckProcFlags accepts. Proc::mProcFlags must not change
+/// once a proc was added. Removing a proc never deletes it, the owner does.
+///
+/// Header only and templated on the proc, so the tests can index a model of SpellProc.
+//////////////////////////////////////////////////////////////////////////////////////////
+template <class Proc>
+class BasicSpellProcTable
+{
+    public:
+
+        typedef typename std::vector<Proc*>::iterator iterator;
+        typedef typename std::vector<Proc*>::const_iterator const_iterator;
+
+        BasicSpellProcTable() {}
+
+        void add(Proc* proc)
+        {
+            m_procs.push_back(proc);
+            m_procFlags.push_back(proc->mProcFlags);
+
+            for (uint8_t bit = 0; bit < procFlagBits; ++bit)
+            {
+                if (proc->mProcFlags & (uint32_t(1) << bit))
+                    m_buckets[bit].push_back(proc);
+            }
+        }
+
+        void remove(Proc* proc)
+        {
+            iterator itr = std::find(m_procs.begin(), m_procs.end(), proc);
+            if (itr == m_procs.end())
+                return;
+
+            m_procFlags.erase(m_procFlags.begin() + (itr - m_procs.begin()));
+            m_procs.erase(itr);
+
+            for (uint8_t bit = 0; bit < procFlagBits; ++bit)
+            {
+                if (!(proc->mProcFlags & (uint32_t(1) << bit)))
+                    continue;
+
+                std::vector<Proc*>& bucket = m_buckets[bit];
+                bucket.erase(std::find(bucket.begin(), bucket.end(), proc));
+            }
+        }
+
+        void clear()
+        {
+            m_procs.clear();
+            m_procFlags.clear();
+
+            for (uint8_t bit = 0; bit < procFlagBits; ++bit)
+                m_buckets[bit].clear();
+        }
+
+        /// fills candidates with every proc matching one of the flag bits, in the order they were added
+        void getCandidates(uint32_t proc_flags, std::vector<Proc*>& candidates) const
+        {
+            candidates.clear();
+
+            const std::vector<Proc*>* single_bucket = nullptr;
+            uint8_t bucket_count = 0;
+            size_t bucket_size = 0;
+
+            for (uint8_t bit = 0; bit < procFlagBits; ++bit)
+            {
+                if ((proc_flags & (uint32_t(1) << bit)) && !m_buckets[bit].empty())
+                {
+                    single_bucket = &m_buckets[bit];
+                    bucket_size += single_bucket->size();
+                    ++bucket_count;
+                }
+            }
+
+            if (bucket_count == 0)
+                return;
+
+            // the usual case, one event bit has registered procs
+            if (bucket_count == 1)
+            {
+                candidates.assign(single_bucket->begin(), single_bucket->end());
+                return;
+            }
+
+            // a proc listening to several of the event bits is in several buckets, testing the flags
+            // of every proc in order keeps it once and is cheaper than merging the buckets
+            candidates.reserve(std::min(bucket_size, m_procs.size()));
+            for (size_t i = 0; i < m_procFlags.size(); ++i)
+            {
+                if (m_procFlags[i] & proc_flags)
+                    candidates.push_back(m_procs[i]);
+            }
+        }
+
+        iterator begin() { return m_procs.begin(); }
+        iterator end() { return m_procs.end(); }
+        const_iterator begin() const { return m_procs.begin(); }
+        const_iterator end() const { return m_procs.end(); }
+
+        size_t size() const { return m_procs.size(); }
+        bool empty() const { return m_procs.empty(); }
+
+    private:
+
+        static const uint8_t procFlagBits = 32;
+
+        // all procs in the order they were added
+        std::vector<Proc*> m_procs;
+
+        // proc flags of m_procs, same order
+        std::vector<uint32_t> m_procFlags;
+
+        // procs per flag bit, in the order they were added
+        std::vector<Proc*> m_buckets[procFlagBits];
+};
+
+typedef BasicSpellProcTable<SpellProc> SpellProcTable;
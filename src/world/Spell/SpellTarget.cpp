@@ -262,29 +262,24 @@ void Spell::AddChainTargets(uint32 i, uint32 TargetType, float r, uint32 maxtarg
     if (jumps <= 1 || list->size() == 0) //1 because we've added the first target, 0 size if spell is resisted
         return;
 
-    ObjectSet::iterator itr;
-    for (itr = firstTarget->GetInRangeSetBegin(); itr != firstTarget->GetInRangeSetEnd(); ++itr)
+    firstTarget->GetMapMgr()->ForEachUnitInRadius(firstTarget->GetPositionX(), firstTarget->GetPositionY(), firstTarget->GetPositionZ(), sqrtf(range), [&](Unit* target) -> bool
     {
-        if (!(*itr)->IsUnit() || !static_cast<Unit*>((*itr))->isAlive())
-            continue;
+        if (target == firstTarget || !target->isAlive())
+            return true;
 
-        if (RaidOnly && !pfirstTargetFrom->InRaid(static_cast<Unit*>(*itr)))
-            continue;
+        if (RaidOnly && !pfirstTargetFrom->InRaid(target))
+            return true;
 
         //healing spell, full health target = NONO
-        if (IsHealingSpell(m_spellInfo) && static_cast<Unit*>(*itr)->GetHealthPct() == 100)
-            continue;
+        if (IsHealingSpell(m_spellInfo) && target->GetHealthPct() == 100)
+            return true;
 
-        size_t oldsize;
+        size_t oldsize = list->size();
+        AddTarget(i, TargetType, target);
 
-        if (IsInrange(firstTarget->GetPositionX(), firstTarget->GetPositionY(), firstTarget->GetPositionZ(), (*itr), range))
-        {
-            oldsize = list->size();
-            AddTarget(i, TargetType, (*itr));
-            if (list->size() == oldsize || list->size() >= jumps) //either out of jumps or a resist
-                return;
-        }
-    }
+        //either out of jumps or a resist
+        return !(list->size() == oldsize || list->size() >= jumps);
+    });
 }
 
 void Spell::AddPartyTargets(uint32 i, uint32 TargetType, float r, uint32 maxtargets)
@@ -379,15 +374,16 @@ void Spell::AddAOETargets(uint32 i, uint32 TargetType, float r, uint32 maxtarget
 
     TargetsList* t = &m_targetUnits[i];
 
-    for (ObjectSet::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); ++itr)
+    m_caster->GetMapMgr()->ForEachObjectInRadius(source.x, source.y, source.z, r, [&](Object* obj) -> bool
     {
         if (maxtargets != 0 && t->size() >= maxtargets)
-            break;
+            return false;
 
-        float dist = (*itr)->CalcDistance(source);
-        if (dist <= r)
-            AddTarget(i, TargetType, (*itr));
-    }
+        if (obj != m_caster)
+            AddTarget(i, TargetType, obj);
+
+        return true;
+    });
 }
 
 bool Spell::AddTarget(uint32 i, uint32 TargetType, Object* obj)
@@ -1480,29 +1480,23 @@ bool AIInterface::FindFriends(float dist)
     bool result = false;
     TargetMap::iterator it;
 
-    std::set<Object*>::iterator itr;
-    Unit* pUnit;
-
-    for (itr = m_Unit->GetInRangeSetBegin(); itr != m_Unit->GetInRangeSetEnd(); ++itr)
+    // dist is squared, the spatial query wants the plain radius
+    m_Unit->GetMapMgr()->ForEachUnitInRadius(m_Unit->GetPositionX(), m_Unit->GetPositionY(), m_Unit->GetPositionZ(), sqrtf(dist), [&](Unit* pUnit) -> bool
     {
-        if (!(*itr)->IsUnit())
-            continue;
-
-        pUnit = static_cast< Unit* >(*itr);
-        if (!pUnit->isAlive())
-            continue;
+        if (pUnit == m_Unit || !pUnit->isAlive())
+            return true;
 
         if (pUnit->HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_NOT_SELECTABLE))
         {
-            continue;
+            return true;
         }
         if (pUnit->HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_NOT_ATTACKABLE_9))
         {
-            continue;
+            return true;
         }
 
         if (!(pUnit->m_phase & m_Unit->m_phase))   //We can't help a friendly unit if it is not in our phase
-            continue;
+            return true;
 
         if (isCombatSupport(m_Unit, pUnit) && (pUnit->GetAIInterface()->getAIState() == STATE_IDLE || pUnit->GetAIInterface()->getAIState() == STATE_SCRIPTIDLE))      //Not sure
         {
@@ -1526,7 +1520,9 @@ bool AIInterface::FindFriends(float dist)
                 LockAITargets(false);
             }
         }
-    }
+
+        return true;
+    });
 
     uint32 family = static_cast<Creature*>(m_Unit)->GetCreatureProperties()->Type;
 
@@ -3764,13 +3760,15 @@ bool AIInterface::CreatePath(float x, float y, float z, bool onlytest /*= false*
 {
     //make sure current spline is updated
     MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-    dtNavMesh* nav = const_cast<dtNavMesh*>(mmap->GetNavMesh(m_Unit->GetMapId()));
-    dtNavMeshQuery* nav_query = const_cast<dtNavMeshQuery*>(mmap->GetNavMeshQuery(m_Unit->GetMapId(), m_Unit->GetInstanceID()));
+    MMAP::NavMeshReader navMesh = mmap->GetNavMeshReader(m_Unit->GetMapId());
     //NavMeshData* nav = CollideInterface.GetNavMesh(m_Unit->GetMapId());
     
-    if (nav == NULL)
+    if (!navMesh)
         return false;
 
+    dtNavMesh* nav = const_cast<dtNavMesh*>(navMesh.getNavMesh());
+    dtNavMeshQuery* nav_query = const_cast<dtNavMeshQuery*>(navMesh.getQuery());
+
     float start[VERTEX_SIZE] = { m_Unit->GetPositionY(), m_Unit->GetPositionZ(), m_Unit->GetPositionX() };
     float end[VERTEX_SIZE] = { y, z, x };
     float extents[VERTEX_SIZE] = { 3.0f, 5.0f, 3.0f };
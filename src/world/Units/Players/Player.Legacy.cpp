@@ -1145,7 +1145,7 @@ void Player::Update(unsigned long time_passed)
             // check last damage dealt timestamp, and if enough time has elapsed deal damage
             if (mstime >= m_UnderwaterLastDmg)
             {
-                uint32 damage = m_uint32Values[UNIT_FIELD_MAXHEALTH] / 10;
+                uint32 damage = GetMaxHealth() / 10;
 
                 SendEnvironmentalDamageLog(GetGUID(), uint8(DAMAGE_DROWNING), damage);
                 DealDamage(this, damage, 0, 0, 0);
@@ -1175,7 +1175,7 @@ void Player::Update(unsigned long time_passed)
         // check last damage dealt timestamp, and if enough time has elapsed deal damage
         if (mstime >= m_UnderwaterLastDmg)
         {
-            uint32 damage = m_uint32Values[UNIT_FIELD_MAXHEALTH] / 5;
+            uint32 damage = GetMaxHealth() / 5;
 
             SendEnvironmentalDamageLog(GetGUID(), uint8(DAMAGE_LAVA), damage);
             DealDamage(this, damage, 0, 0, 0);
@@ -2376,11 +2376,7 @@ void Player::_SetCreateBits(UpdateMask* updateMask, Player* target) const
     }
     else
     {
-        for (uint32 index = 0; index < m_valuesCount; index++)
-        {
-            if (m_uint32Values[index] != 0 && Player::m_visibleUpdateMask.GetBit(index))
-                updateMask->SetBit(index);
-        }
+        updateMask->SetNonZeroBits(m_uint32Values, Player::m_visibleUpdateMask);
     }
 }
 
@@ -4324,7 +4320,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             FlatResistanceModifierPos[2] += proto->FireRes;
         else
             FlatResistanceModifierPos[2] -= proto->FireRes;
-        CalcResistance(2);
+        markStatsDirty(getResistanceDirtyFlag(2));
     }
 
     if (proto->NatureRes)
@@ -4333,7 +4329,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             FlatResistanceModifierPos[3] += proto->NatureRes;
         else
             FlatResistanceModifierPos[3] -= proto->NatureRes;
-        CalcResistance(3);
+        markStatsDirty(getResistanceDirtyFlag(3));
     }
 
     if (proto->FrostRes)
@@ -4342,7 +4338,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             FlatResistanceModifierPos[4] += proto->FrostRes;
         else
             FlatResistanceModifierPos[4] -= proto->FrostRes;
-        CalcResistance(4);
+        markStatsDirty(getResistanceDirtyFlag(4));
     }
 
     if (proto->ShadowRes)
@@ -4351,7 +4347,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             FlatResistanceModifierPos[5] += proto->ShadowRes;
         else
             FlatResistanceModifierPos[5] -= proto->ShadowRes;
-        CalcResistance(5);
+        markStatsDirty(getResistanceDirtyFlag(5));
     }
 
     if (proto->ArcaneRes)
@@ -4360,7 +4356,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             FlatResistanceModifierPos[6] += proto->ArcaneRes;
         else
             FlatResistanceModifierPos[6] -= proto->ArcaneRes;
-        CalcResistance(6);
+        markStatsDirty(getResistanceDirtyFlag(6));
     }
     /* Heirloom scaling items */
     if (proto->ScalingStatsEntry != 0)
@@ -4426,7 +4422,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
             uint32 scaledarmorval = ssvrow->multiplier[col];
             if (apply)BaseResistance[0] += scaledarmorval;
             else  BaseResistance[0] -= scaledarmorval;
-            CalcResistance(0);
+            markStatsDirty(getResistanceDirtyFlag(0));
         }
 
         /* Calculating the damages correct for our level and applying it */
@@ -4483,7 +4479,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
         {
             if (apply)BaseResistance[0] += proto->Armor;
             else  BaseResistance[0] -= proto->Armor;
-            CalcResistance(0);
+            markStatsDirty(getResistanceDirtyFlag(0));
         }
 
         // Damage
@@ -4589,7 +4585,7 @@ void Player::_ApplyItemMods(Item* item, int16 slot, bool apply, bool justdrokedo
     }
 
     if (!skip_stat_apply)
-        UpdateStats();
+        markStatsDirty(UNIT_STAT_DIRTY_STATS);
 }
 
 void Player::BuildPlayerRepop()
@@ -4754,7 +4750,7 @@ void Player::ResurrectPlayer()
 
     sEventMgr.RemoveEvents(this, EVENT_PLAYER_FORCED_RESURRECT); // In case somebody resurrected us before this event happened
     if (m_resurrectHealth)
-        SetHealth((uint32)std::min(m_resurrectHealth, m_uint32Values[UNIT_FIELD_MAXHEALTH]));
+        SetHealth((uint32)std::min(m_resurrectHealth, GetMaxHealth()));
     if (m_resurrectMana)
         SetPower(POWER_TYPE_MANA, m_resurrectMana);
 
@@ -7249,6 +7245,7 @@ void Player::RegenerateEnergy()
     else // let player's own client handle normal regen rates.
     {
         m_uint32Values[UNIT_FIELD_POWER4] = (cur >= mh) ? mh : cur;
+        ++m_valuesGeneration;
         SendPowerUpdate(false); // send update to other in-range players
     }
 }
@@ -9696,8 +9693,7 @@ void Player::SetShapeShift(uint8 ss)
         }
     }
 
-    UpdateStats();
-    UpdateChances();
+    markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
 }
 
 void Player::CalcDamage()
@@ -10685,15 +10681,14 @@ void Player::EventTalentHearthOfWildChange(bool apply)
     {
         TotalStatModPctPos[STAT_STAMINA] += tval;
         CalcStat(STAT_STAMINA);
-        UpdateStats();
-        UpdateChances();
+        markStatsDirty(UNIT_STAT_DIRTY_STATS | UNIT_STAT_DIRTY_CHANCES);
     }
     //increase attackpower if :
     else if (SS == FORM_CAT)
     {
         SetAttackPowerMultiplier(GetFloatValue(UNIT_FIELD_ATTACK_POWER_MULTIPLIER) + tval / 200.0f);
         SetRangedAttackPowerMultiplier(GetRangedAttackPowerMultiplier() + tval / 200.0f);
-        UpdateStats();
+        markStatsDirty(UNIT_STAT_DIRTY_STATS);
     }
 }
 
@@ -14142,7 +14137,7 @@ void Player::RemoteRevive()
     setSpeedForType(TYPE_RUN, getSpeedForType(TYPE_RUN, true));
     setSpeedForType(TYPE_SWIM, getSpeedForType(TYPE_SWIM, true));
     setMoveLandWalk();
-    SetHealth(GetUInt32Value(UNIT_FIELD_MAXHEALTH));
+    SetHealth(GetMaxHealth());
 }
 
 void Player::SetMover(Unit* target)
@@ -438,6 +438,7 @@ private:
 
     friend class WorldSession;
     friend class Pet;
+    friend class MapTickBenchmark;
 
     public:
         
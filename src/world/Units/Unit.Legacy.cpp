@@ -979,7 +979,7 @@ Unit::~Unit()
         delete i->second;
     tmpAura.clear();
 
-    for (std::list<SpellProc*>::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
+    for (SpellProcTable::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
         delete *itr;
     m_procSpells.clear();
 
@@ -1255,20 +1255,20 @@ uint32 Unit::HandleProc(uint32 flag, Unit* victim, SpellInfo* CastingSpell, bool
         return 0;
     }
 
-    std::list<SpellProc*>::iterator itr, itr2;
-    for (itr = m_procSpells.begin(); itr != m_procSpells.end();)    // Proc Trigger Spells for Victim
-    {
-        itr2 = itr;
-        ++itr;
+    // only procs listening to one of the event flags, procs added by nested procs wait for the next event
+    std::vector<SpellProc*> proc_candidates;
+    m_procSpells.getCandidates(flag, proc_candidates);
 
-        SpellProc* spell_proc = *itr2;
+    for (std::vector<SpellProc*>::iterator itr = proc_candidates.begin(); itr != proc_candidates.end(); ++itr)    // Proc Trigger Spells for Victim
+    {
+        SpellProc* spell_proc = *itr;
 
         // Check if list item was deleted elsewhere, so here it's removed and freed
         if (spell_proc->mDeleted)
         {
             if (can_delete)
             {
-                m_procSpells.erase(itr2);
+                m_procSpells.remove(spell_proc);
                 delete spell_proc;
             }
             continue;
@@ -3107,6 +3107,7 @@ uint32 Unit::GetSpellDidHitResult(Unit* pVictim, uint32 weapon_damage_type, Spel
         vskill = static_cast<Player*>(pVictim)->_GetSkillLineCurrent(SKILL_DEFENSE);
         if (weapon_damage_type != RANGED && !backAttack)                // block chance
         {
+            pVictim->flushDirtyStats();
             block = pVictim->GetFloatValue(PLAYER_BLOCK_PERCENTAGE);    //shield check already done in Update chances
 
             if (pVictim->m_stunned <= 0)                                // dodge chance
@@ -3494,6 +3495,7 @@ void Unit::Strike(Unit* pVictim, uint32 weapon_damage_type, SpellInfo* ability,
         }
 
         self_skill += pr->_GetSkillLineCurrent(SubClassSkill);
+        flushDirtyStats();
         crit = GetFloatValue(PLAYER_CRIT_PERCENTAGE);
     }
     else
@@ -4334,7 +4336,7 @@ void Unit::Strike(Unit* pVictim, uint32 weapon_damage_type, SpellInfo* ability,
         if (weapon == nullptr)
         {
             if (weapon_damage_type == OFFHAND)
-                s = GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + 1) / 1000.0f;
+                s = GetBaseAttackTime(OFFHAND) / 1000.0f;
             else
                 s = GetBaseAttackTime(MELEE) / 1000.0f;
         }
@@ -4869,11 +4871,11 @@ void Unit::AddAura(Aura* aur)
 
     // Zack : No idea how a new aura can already have a slot. Leaving it for compatibility
     if (aur->m_auraSlot != 0xffff)
-        m_auras[aur->m_auraSlot] = NULL;
+        setAuraInSlot(aur->m_auraSlot, nullptr);
 
     aur->m_auraSlot = AuraSlot;
 
-    m_auras[AuraSlot] = aur;
+    setAuraInSlot(AuraSlot, aur);
     UpdateAuraForGroup(visualslot);
     ModVisualAuraStackCount(aur, 1);
 
@@ -4947,6 +4949,9 @@ bool Unit::RemoveAura(Aura* aur)
 
 bool Unit::RemoveAura(uint32 spellId)
 {
+    if (getAuraCountForSpellId(spellId) == 0)
+        return false;
+
     //this can be speed up, if we know passive \pos neg
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
         if (m_auras[x] && m_auras[x]->GetSpellId() == spellId)
@@ -5004,7 +5009,7 @@ bool Unit::RemoveAurasByHeal()
                 case 38801:
                 case 43093:
                 {
-                    if (GetUInt32Value(UNIT_FIELD_HEALTH) == GetUInt32Value(UNIT_FIELD_MAXHEALTH))
+                    if (GetHealth() == GetMaxHealth())
                     {
                         m_auras[x]->Remove();
                         res = true;
@@ -5015,7 +5020,7 @@ bool Unit::RemoveAurasByHeal()
                 case 38772:
                 {
                     uint32 p = m_auras[x]->GetSpellInfo()->EffectBasePoints[1];
-                    if (GetUInt32Value(UNIT_FIELD_MAXHEALTH) * p <= GetUInt32Value(UNIT_FIELD_HEALTH) * 100)
+                    if (GetMaxHealth() * p <= GetHealth() * 100)
                     {
                         m_auras[x]->Remove();
                         res = true;
@@ -5085,6 +5090,9 @@ void Unit::RemoveAllAreaAuraByOther()
 
 bool Unit::RemoveAura(uint32 spellId, uint64 guid)
 {
+    if (getAuraCountForSpellId(spellId) == 0)
+        return false;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
         if (m_auras[x])
@@ -5101,6 +5109,9 @@ bool Unit::RemoveAura(uint32 spellId, uint64 guid)
 
 bool Unit::RemoveAuraByItemGUID(uint32 spellId, uint64 guid)
 {
+    if (getAuraCountForSpellId(spellId) == 0)
+        return false;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
         if (m_auras[x])
@@ -5117,6 +5128,9 @@ bool Unit::RemoveAuraByItemGUID(uint32 spellId, uint64 guid)
 
 bool Unit::RemoveAuraByNameHash(uint32 namehash)
 {
+    if (getAuraCountForNameHash(namehash) == 0)
+        return false;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
         if (m_auras[x])
@@ -5133,6 +5147,9 @@ bool Unit::RemoveAuraByNameHash(uint32 namehash)
 
 bool Unit::RemoveAllAuras(uint32 spellId, uint64 guid)
 {
+    if (getAuraCountForSpellId(spellId) == 0)
+        return false;
+
     bool res = false;
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
@@ -5153,6 +5170,9 @@ bool Unit::RemoveAllAuras(uint32 spellId, uint64 guid)
 
 uint32 Unit::RemoveAllAuraByNameHash(uint32 namehash)
 {
+    if (getAuraCountForNameHash(namehash) == 0)
+        return 0;
+
     uint32 res = 0;
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
@@ -5170,6 +5190,9 @@ uint32 Unit::RemoveAllAuraByNameHash(uint32 namehash)
 
 uint32 Unit::RemoveAllAuraById(uint32 Id)
 {
+    if (getAuraCountForSpellId(Id) == 0)
+        return 0;
+
     uint32 res = 0;
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
@@ -5221,6 +5244,9 @@ void Unit::RemoveAllNonPersistentAuras()
 //ex:to remove morph spells
 void Unit::RemoveAllAuraType(uint32 auratype)
 {
+    if (getAuraCountForAuraEffect(auratype) == 0)
+        return;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
         if (m_auras[x] && m_auras[x]->HasModType(auratype))
             m_auras[x]->Remove();//remove all morph auras containing to this spell (like wolf morph also gives speed)
@@ -5281,6 +5307,9 @@ bool Unit::SetAurDuration(uint32 spellId, uint32 duration)
 
 Aura* Unit::FindAuraByNameHash(uint32 namehash, uint64 guid)
 {
+    if (getAuraCountForNameHash(namehash) == 0)
+        return NULL;
+
     Aura* aura;
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
@@ -5293,6 +5322,9 @@ Aura* Unit::FindAuraByNameHash(uint32 namehash, uint64 guid)
 
 Aura* Unit::FindAuraByNameHash(uint32 namehash)
 {
+    if (getAuraCountForNameHash(namehash) == 0)
+        return NULL;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
         if (m_auras[x] && m_auras[x]->GetSpellInfo()->custom_NameHash == namehash)
             return m_auras[x];
@@ -5301,6 +5333,13 @@ Aura* Unit::FindAuraByNameHash(uint32 namehash)
 
 Aura* Unit::FindAura(uint32* spellId)
 {
+    bool applied = false;
+    for (uint8 j = 0; spellId[j] != 0 && !applied; ++j)
+        applied = getAuraCountForSpellId(spellId[j]) != 0;
+
+    if (!applied)
+        return NULL;
+
     Aura* aura;
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
     {
@@ -5749,7 +5788,7 @@ void Unit::RemoveAurasByInterruptFlag(uint32 flag)
         if ((a->m_spellInfo->AuraInterruptFlags & flag) && !(a->m_spellInfo->procFlags & PROC_REMOVEONUSE))
         {
             a->Remove();
-            m_auras[x] = NULL;
+            setAuraInSlot(static_cast<uint16>(x), nullptr);
         }
     }
 }
@@ -5765,13 +5804,7 @@ bool Unit::HasAuraVisual(uint32 visualid)
 
 bool Unit::HasAura(uint32 spellid)
 {
-    for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
-        if (m_auras[x] && m_auras[x]->GetSpellId() == spellid)
-        {
-            return true;
-        }
-
-    return false;
+    return getAuraCountForSpellId(spellid) != 0;
 }
 
 Aura* Unit::GetAuraWithSlot(uint32 slot)
@@ -5787,11 +5820,7 @@ Aura* Unit::GetAuraWithSlot(uint32 slot)
 
 uint16 Unit::GetAuraStackCount(uint32 spellid)
 {
-    uint16 count = 0;
-    for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; x++)
-        if (m_auras[x] && m_auras[x]->GetSpellId() == spellid)
-            count++;
-    return count;
+    return static_cast<uint16>(getAuraCountForSpellId(spellid));
 }
 
 void Unit::DropAurasOnDeath()
@@ -5846,6 +5875,9 @@ void Unit::UpdateSpeed()
 
 bool Unit::HasBuff(uint32 spellid) // cebernic:it does not check passive auras & must be visible auras
 {
+    if (getAuraCountForSpellId(spellid) == 0)
+        return false;
+
     for (uint32 x = MAX_POSITIVE_AURAS_EXTEDED_START; x < MAX_POSITIVE_AURAS_EXTEDED_END; x++)
         if (m_auras[x] && m_auras[x]->GetSpellId() == spellid)
             return true;
@@ -5855,6 +5887,9 @@ bool Unit::HasBuff(uint32 spellid) // cebernic:it does not check passive auras &
 
 bool Unit::HasBuff(uint32 spellid, uint64 guid)
 {
+    if (getAuraCountForSpellId(spellid) == 0)
+        return false;
+
     for (uint32 x = MAX_POSITIVE_AURAS_EXTEDED_START; x < MAX_POSITIVE_AURAS_EXTEDED_END; x++)
         if (m_auras[x] && m_auras[x]->GetSpellId() == spellid && m_auras[x]->m_casterGuid == guid)
             return true;
@@ -5864,6 +5899,9 @@ bool Unit::HasBuff(uint32 spellid, uint64 guid)
 
 bool Unit::HasVisialPosAurasOfNameHashWithCaster(uint32 namehash, Unit* caster)
 {
+    if (getAuraCountForNameHash(namehash) == 0)
+        return false;
+
     for (uint32 i = MAX_POSITIVE_AURAS_EXTEDED_START; i < MAX_POSITIVE_AURAS_EXTEDED_END; ++i)
         if (m_auras[i] && m_auras[i]->GetSpellInfo()->custom_NameHash == namehash && m_auras[i]->GetCasterGUID() == caster->GetGUID())
             return true;
@@ -6015,17 +6053,9 @@ bool Unit::HasAurasOfBuffType(uint32 buff_type, const uint64 & guid, uint32 skip
 
 uint32 Unit::FindAuraCountByHash(uint32 HashName, uint32 maxcount)
 {
-    uint32 count = 0;
-
-    for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; ++x)
-    {
-        if (m_auras[x] && (m_auras[x]->GetSpellInfo()->custom_NameHash == HashName))
-        {
-            count++;
-            if (count == maxcount)
-                break;
-        }
-    }
+    uint32 count = getAuraCountForNameHash(HashName);
+    if (maxcount != 0 && count > maxcount)
+        count = maxcount;
 
     return count;
 }
@@ -6129,11 +6159,18 @@ void Unit::OnPushToWorld()
         GetVehicleComponent()->InstallAccessories();
 
     z_axisposition = 0.0f;
+
+    // stats marked while we were removed from a map are handed to the new one
+    if (hasDirtyStats())
+        m_mapMgr->MarkUnitStatsDirty(this);
 }
 
 //! Remove Unit from world
 void Unit::RemoveFromWorld(bool free_guid)
 {
+    // the map won't see us anymore, pending stats have to be written now
+    updateDirtyStats();
+
     if (GetCurrentVehicle() != NULL)
         GetCurrentVehicle()->EjectPassenger(this);
 
@@ -6181,7 +6218,7 @@ void Unit::RemoveFromWorld(bool free_guid)
         {
             if (m_auras[x]->m_deleted)
             {
-                m_auras[x] = NULL;
+                setAuraInSlot(static_cast<uint16>(x), nullptr);
                 continue;
             }
             m_auras[x]->RelocateEvents();
@@ -6278,6 +6315,9 @@ void Unit::RemoveAurasByInterruptFlagButSkip(uint32 flag, uint32 skip)
 
 int Unit::HasAurasWithNameHash(uint32 name_hash)
 {
+    if (getAuraCountForNameHash(name_hash) == 0)
+        return 0;
+
     for (uint32 x = MAX_TOTAL_AURAS_START; x < MAX_TOTAL_AURAS_END; ++x)
     {
         if (m_auras[x] && m_auras[x]->GetSpellInfo()->custom_NameHash == name_hash)
@@ -6289,27 +6329,12 @@ int Unit::HasAurasWithNameHash(uint32 name_hash)
 
 bool Unit::HasAuraWithName(uint32 name)
 {
-
-    for (uint32 i = MAX_TOTAL_AURAS_START; i < MAX_TOTAL_AURAS_END; ++i)
-    {
-        if (m_auras[i] != NULL && m_auras[i]->GetSpellInfo()->AppliesAreaAura(name))
-            return true;
-    }
-
-    return false;
+    return getAuraCountForAreaAuraEffect(name) != 0;
 }
 
 uint32 Unit::GetAuraCountWithName(uint32 name)
 {
-    uint32 count = 0;
-
-    for (uint32 i = MAX_TOTAL_AURAS_START; i < MAX_TOTAL_AURAS_END; ++i)
-    {
-        if (m_auras[i] != NULL && m_auras[i]->GetSpellInfo()->AppliesAreaAura(name))
-            ++count;
-    }
-
-    return count;
+    return getAuraCountForAreaAuraEffect(name);
 }
 
 bool Unit::HasAuraWithMechanics(uint32 mechanic)
@@ -7551,6 +7576,8 @@ void Unit::RemoveAllMovementImpairing()
 
 void Unit::setAttackTimer(int32 time, bool offhand)
 {
+    flushDirtyStats();
+
     if (!time)
         time = offhand ? m_uint32Values[UNIT_FIELD_BASEATTACKTIME + 1] : m_uint32Values[UNIT_FIELD_BASEATTACKTIME];
 
@@ -7862,7 +7889,7 @@ void Unit::RemoveReflect(uint32 spellid, bool apply)
 
 void Unit::SetPower(uint32 type, int32 value)
 {
-    uint32 maxpower = GetUInt32Value(UNIT_FIELD_MAXPOWER1 + type);
+    uint32 maxpower = GetMaxPower(type);
 
     if (value < 0)
         value = 0;
@@ -7967,6 +7994,7 @@ void Unit::Tag(uint64 TaggerGUID)
     Tagged = true;
     this->TaggerGuid = TaggerGUID;
     m_uint32Values[UNIT_DYNAMIC_FLAGS] |= U_DYN_FLAG_TAGGED_BY_OTHER;
+    ++m_valuesGeneration;
 }
 
 void Unit::UnTag()
@@ -7974,6 +8002,7 @@ void Unit::UnTag()
     Tagged = false;
     TaggerGuid = 0;
     m_uint32Values[UNIT_DYNAMIC_FLAGS] &= ~U_DYN_FLAG_TAGGED_BY_OTHER;
+    ++m_valuesGeneration;
 }
 
 bool Unit::IsTagged()
@@ -8010,6 +8039,10 @@ bool Unit::isLootable()
 
 SpellProc* Unit::AddProcTriggerSpell(SpellInfo* spell, SpellInfo* orig_spell, uint64 caster, uint32 procChance, uint32 procFlags, uint32 procCharges, uint32* groupRelation, uint32* procClassMask, Object* obj)
 {
+    // procs deleted while their flags never came up are only freed here
+    if (!bProcInUse)
+        RemoveDeletedProcTriggerSpells();
+
     SpellProc* sp = NULL;
     if (spell != NULL)
         sp = GetProcTriggerSpell(spell->Id, caster);
@@ -8025,7 +8058,7 @@ SpellProc* Unit::AddProcTriggerSpell(SpellInfo* spell, SpellInfo* orig_spell, ui
             LOG_ERROR("Something tried to add a non-existent spell to Unit %p as SpellProc", this);
         return NULL;
     }
-    m_procSpells.push_back(sp);
+    m_procSpells.add(sp);
 
     return sp;
 }
@@ -8042,7 +8075,7 @@ SpellProc* Unit::AddProcTriggerSpell(SpellInfo* sp, uint64 caster, uint32* group
 
 SpellProc* Unit::GetProcTriggerSpell(uint32 spellId, uint64 casterGuid)
 {
-    for (std::list<SpellProc*>::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
+    for (SpellProcTable::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
     {
         SpellProc* sp = *itr;
         if (sp->mSpell->Id == spellId && (casterGuid == 0 || sp->mCaster == casterGuid))
@@ -8054,7 +8087,7 @@ SpellProc* Unit::GetProcTriggerSpell(uint32 spellId, uint64 casterGuid)
 
 void Unit::RemoveProcTriggerSpell(uint32 spellId, uint64 casterGuid, uint64 misc)
 {
-    for (std::list<SpellProc*>::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
+    for (SpellProcTable::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
     {
         SpellProc* sp = *itr;
         if (sp->CanDelete(spellId, casterGuid, misc))
@@ -8065,6 +8098,22 @@ void Unit::RemoveProcTriggerSpell(uint32 spellId, uint64 casterGuid, uint64 misc
     }
 }
 
+void Unit::RemoveDeletedProcTriggerSpells()
+{
+    std::vector<SpellProc*> deleted_procs;
+    for (SpellProcTable::iterator itr = m_procSpells.begin(); itr != m_procSpells.end(); ++itr)
+    {
+        if ((*itr)->mDeleted)
+            deleted_procs.push_back(*itr);
+    }
+
+    for (std::vector<SpellProc*>::iterator itr = deleted_procs.begin(); itr != deleted_procs.end(); ++itr)
+    {
+        m_procSpells.remove(*itr);
+        delete *itr;
+    }
+}
+
 void Unit::TakeDamage(Unit* pAttacker, uint32 damage, uint32 spellid, bool no_remove_auras)
 {}
 
@@ -8219,6 +8268,8 @@ bool Unit::IsCriticalDamageForSpell(Object* victim, SpellInfo* spell)
     float CritChance = 0.0f;
     PlayerCombatRating resilience_type = PCR_RANGED_SKILL;
 
+    flushDirtyStats();
+
     if (spell->custom_is_ranged_spell)
     {
         if (IsPlayer())
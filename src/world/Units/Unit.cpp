@@ -7,6 +7,8 @@ This file is released under the MIT license. See README-MIT for more information
 #include "Server/Packets/Opcode.h"
 #include "Server/WorldSession.h"
 #include "Players/Player.h"
+#include "Creatures/Creature.h"
+#include "Map/MapMgr.h"
 #include "Spell/SpellAuras.h"
 
 
@@ -657,6 +659,9 @@ void Unit::playSpellVisual(uint64_t guid, uint32_t spell_id)
 
 Aura* Unit::getAuraWithId(uint32_t spell_id)
 {
+    if (getAuraCountForSpellId(spell_id) == 0)
+        return nullptr;
+
     for (uint32_t i = MAX_TOTAL_AURAS_START; i < MAX_TOTAL_AURAS_END; ++i)
     {
         Aura* aura = m_auras[i];
@@ -672,12 +677,15 @@ Aura* Unit::getAuraWithId(uint32_t spell_id)
 
 Aura* Unit::getAuraWithIdForGuid(uint32_t spell_id, uint64_t target_guid)
 {
+    if (getAuraCountForSpellId(spell_id) == 0)
+        return nullptr;
+
     for (uint32_t i = MAX_TOTAL_AURAS_START; i < MAX_TOTAL_AURAS_END; ++i)
     {
         Aura* aura = m_auras[i];
         if (aura != nullptr)
         {
-            if (getAuraWithId(spell_id) && aura->m_casterGuid == target_guid)
+            if (aura->GetSpellId() == spell_id && aura->m_casterGuid == target_guid)
                 return aura;
         }
     }
@@ -687,6 +695,9 @@ Aura* Unit::getAuraWithIdForGuid(uint32_t spell_id, uint64_t target_guid)
 
 Aura* Unit::getAuraWithAuraEffect(uint32_t aura_effect)
 {
+    if (getAuraCountForAuraEffect(aura_effect) == 0)
+        return nullptr;
+
     for (uint32_t i = MAX_TOTAL_AURAS_START; i < MAX_TOTAL_AURAS_END; ++i)
     {
         Aura* aura = m_auras[i];
@@ -696,3 +707,126 @@ Aura* Unit::getAuraWithAuraEffect(uint32_t aura_effect)
 
     return nullptr;
 }
+
+void Unit::setAuraInSlot(uint16_t slot, Aura* aura)
+{
+    if (m_auras[slot] == aura)
+        return;
+
+    if (m_auras[slot] != nullptr)
+        updateAuraIndexes(m_auras[slot], false);
+
+    m_auras[slot] = aura;
+
+    if (aura != nullptr)
+        updateAuraIndexes(aura, true);
+}
+
+void Unit::updateAuraIndexes(Aura* aura, bool add)
+{
+    auto modify = [add](AuraIndex& index, uint32_t key)
+    {
+        if (add)
+        {
+            ++index[key];
+            return;
+        }
+
+        auto itr = index.find(key);
+        if (itr != index.end() && --itr->second == 0)
+            index.erase(itr);
+    };
+
+    SpellInfo* spell_info = aura->GetSpellInfo();
+
+    modify(m_auraCountBySpellId, spell_info->Id);
+    modify(m_auraCountByNameHash, spell_info->custom_NameHash);
+
+    // every aura effect / area aura effect is counted once per aura
+    for (uint8_t i = 0; i < MAX_SPELL_EFFECTS; ++i)
+    {
+        const uint32_t aura_effect = spell_info->EffectApplyAuraName[i];
+
+        bool counted = false;
+        for (uint8_t j = 0; j < i; ++j)
+            counted |= spell_info->EffectApplyAuraName[j] == aura_effect;
+
+        if (!counted)
+        {
+            modify(m_auraCountByAuraEffect, aura_effect);
+
+            if (spell_info->AppliesAreaAura(aura_effect))
+                modify(m_auraCountByAreaAuraEffect, aura_effect);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Stats
+namespace
+{
+    // the stat calculations UnitDirtyStats runs for a unit
+    class UnitStatCalculator
+    {
+        public:
+
+            UnitStatCalculator(Unit* unit) : m_unit(unit) {}
+
+            bool hasPlayerStats() const { return m_unit->IsPlayer(); }
+
+            void calcResistance(uint32_t school)
+            {
+                if (m_unit->IsPlayer())
+                    static_cast<Player*>(m_unit)->CalcResistance(school);
+                else if (m_unit->IsCreature())
+                    static_cast<Creature*>(m_unit)->CalcResistance(school);
+            }
+
+            void updateStats() { static_cast<Player*>(m_unit)->UpdateStats(); }
+            void updateAttackSpeed() { static_cast<Player*>(m_unit)->UpdateAttackSpeed(); }
+            void updateChances() { static_cast<Player*>(m_unit)->UpdateChances(); }
+
+            void calcDamage()
+            {
+                if (m_unit->IsPlayer())
+                    static_cast<Player*>(m_unit)->CalcDamage();
+                else
+                    m_unit->CalcDamage();
+            }
+
+        private:
+
+            Unit* m_unit;
+    };
+}
+
+void Unit::markStatsDirty(uint32_t dirty_flags)
+{
+    // changes made while recalculating (aura modifiers refreshed by UpdateStats) are applied directly
+    if (m_dirtyStats.isRecalculating() || !IsInWorld() || m_mapMgr == nullptr)
+    {
+        UnitStatCalculator calculator(this);
+        m_dirtyStats.recalculate(calculator, dirty_flags);
+        return;
+    }
+
+    if (m_dirtyStats.mark(dirty_flags))
+        m_mapMgr->MarkUnitStatsDirty(this);
+}
+
+void Unit::updateDirtyStats()
+{
+    UnitStatCalculator calculator(this);
+    m_dirtyStats.flush(calculator);
+}
+
+void Unit::flushDirtyStatsOnOwnMap() const
+{
+    // the other maps tick their units on other threads, a recalculation from here would race
+    // with their tick. Their getters return the values of the last tick instead.
+    if (m_mapMgr == nullptr || t_currentMapContext.get() != m_mapMgr)
+        return;
+
+    // the getters are const, the recalculation writes the derived fields
+    const_cast<Unit*>(this)->updateDirtyStats();
+}
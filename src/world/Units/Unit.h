@@ -24,8 +24,10 @@
 #include "Spell/SpellDefines.hpp"
 
 #include "UnitDefines.hpp"
+#include "UnitDirtyStats.hpp"
 #include "Management/LootMgr.h"
 #include "Spell/SpellProc.h"
+#include "Spell/SpellProcTable.h"
 #include "Objects/Object.h"
 #include "Units/Summons/SummonHandler.h"
 #include "Movement/UnitMovementManager.hpp"
@@ -302,6 +304,61 @@ public:
     Aura* getAuraWithIdForGuid(uint32_t spell_id, uint64_t target_guid);
     Aura* getAuraWithAuraEffect(uint32_t aura_effect);
 
+    // Every write to m_auras has to go through setAuraInSlot to keep the aura indexes in sync
+    void setAuraInSlot(uint16_t slot, Aura* aura);
+
+    uint32_t getAuraCountForSpellId(uint32_t spell_id) const { return getAuraIndexCount(m_auraCountBySpellId, spell_id); }
+    uint32_t getAuraCountForNameHash(uint32_t name_hash) const { return getAuraIndexCount(m_auraCountByNameHash, name_hash); }
+    uint32_t getAuraCountForAuraEffect(uint32_t aura_effect) const { return getAuraIndexCount(m_auraCountByAuraEffect, aura_effect); }
+    uint32_t getAuraCountForAreaAuraEffect(uint32_t aura_effect) const { return getAuraIndexCount(m_auraCountByAreaAuraEffect, aura_effect); }
+
+private:
+
+    typedef std::unordered_map<uint32_t, uint16_t> AuraIndex;
+
+    static uint32_t getAuraIndexCount(AuraIndex const& index, uint32_t key)
+    {
+        auto itr = index.find(key);
+        return itr != index.end() ? itr->second : 0;
+    }
+
+    void updateAuraIndexes(Aura* aura, bool add);
+
+    // number of auras in m_auras per spell id, name hash, aura effect and area aura effect
+    AuraIndex m_auraCountBySpellId;
+    AuraIndex m_auraCountByNameHash;
+    AuraIndex m_auraCountByAuraEffect;
+    AuraIndex m_auraCountByAreaAuraEffect;
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // Stats
+public:
+
+    // Aura and item changes only mark the derived stats, the MapMgr recalculates them once per
+    // tick before the update blocks are built. Units outside of a map recalculate right away.
+    void markStatsDirty(uint32_t dirty_flags);
+    void updateDirtyStats();
+    bool hasDirtyStats() const { return m_dirtyStats.isDirty(); }
+
+    // called by the getters of derived stats. A read during the tick of the unit's own map sees
+    // the recalculated value, a read from another map (ticked by another thread) the value of
+    // the unit's last tick.
+    void flushDirtyStats() const
+    {
+        if (m_dirtyStats.isDirty())
+            flushDirtyStatsOnOwnMap();
+    }
+
+    static uint32_t getResistanceDirtyFlag(uint32_t school) { return UnitDirtyStats::getResistanceFlag(school); }
+
+private:
+
+    void flushDirtyStatsOnOwnMap() const;
+
+    UnitDirtyStats m_dirtyStats;
+
+public:
+
 
     // Do not alter anything below this line
     // -------------------------------------
@@ -510,12 +567,13 @@ public:
     void RemoveCurrentUnitForSingleTargetAura(uint32 name_hash);
 
     // ProcTrigger
-    std::list<SpellProc*> m_procSpells;
+    SpellProcTable m_procSpells;
     SpellProc* AddProcTriggerSpell(uint32 spell_id, uint32 orig_spell_id, uint64 caster, uint32 procChance, uint32 procFlags, uint32 procCharges, uint32* groupRelation, uint32* procClassMask = NULL, Object* obj = NULL);
     SpellProc* AddProcTriggerSpell(SpellInfo* spell, SpellInfo* orig_spell, uint64 caster, uint32 procChance, uint32 procFlags, uint32 procCharges, uint32* groupRelation, uint32* procClassMask = NULL, Object* obj = NULL);
     SpellProc* AddProcTriggerSpell(SpellInfo* sp, uint64 caster, uint32* groupRelation, uint32* procClassMask = NULL, Object* obj = NULL);
     SpellProc* GetProcTriggerSpell(uint32 spellId, uint64 casterGuid = 0);
     void RemoveProcTriggerSpell(uint32 spellId, uint64 casterGuid = 0, uint64 misc = 0);
+    void RemoveDeletedProcTriggerSpells();
 
     bool IsPoisoned();
 
@@ -787,6 +845,8 @@ public:
 
     int GetHealthPct()
     {
+        flushDirtyStats();
+
         //shitty db? pet/guardian bug?
         if (GetUInt32Value(UNIT_FIELD_HEALTH) == 0 || GetUInt32Value(UNIT_FIELD_MAXHEALTH) == 0)
             return 0;
@@ -794,7 +854,7 @@ public:
         return (int)(GetUInt32Value(UNIT_FIELD_HEALTH) * 100 / GetUInt32Value(UNIT_FIELD_MAXHEALTH));
     };
 
-    void SetHealthPct(uint32 val) { if (val > 0) SetHealth(float2int32(val * 0.01f * GetUInt32Value(UNIT_FIELD_MAXHEALTH))); };
+    void SetHealthPct(uint32 val) { if (val > 0) SetHealth(float2int32(val * 0.01f * GetMaxHealth())); };
 
     int GetManaPct()
     {
@@ -1045,7 +1105,7 @@ public:
     uint32 GetEquippedItem(uint8 slot) { return GetUInt32Value(UNIT_VIRTUAL_ITEM_SLOT_ID + slot); }
 
     void SetBaseAttackTime(uint8 slot, uint32 time) { SetUInt32Value(UNIT_FIELD_BASEATTACKTIME + slot, time); }
-    uint32 GetBaseAttackTime(uint8 slot) { return GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + slot); }
+    uint32 GetBaseAttackTime(uint8 slot) { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_BASEATTACKTIME + slot); }
     void ModBaseAttackTime(uint8 slot, int32 mod) { ModUnsigned32Value(UNIT_FIELD_BASEATTACKTIME + slot, mod); }
 
     void SetBoundingRadius(float rad) { SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, rad); }
@@ -1063,22 +1123,22 @@ public:
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     void SetMinDamage(float amt) { SetFloatValue(UNIT_FIELD_MINDAMAGE, amt); }
-    float GetMinDamage() { return GetFloatValue(UNIT_FIELD_MINDAMAGE); }
+    float GetMinDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MINDAMAGE); }
 
     void SetMaxDamage(float amt) { SetFloatValue(UNIT_FIELD_MAXDAMAGE, amt); }
-    float GetMaxDamage() { return GetFloatValue(UNIT_FIELD_MAXDAMAGE); }
+    float GetMaxDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MAXDAMAGE); }
 
     void SetMinOffhandDamage(float amt) { SetFloatValue(UNIT_FIELD_MINOFFHANDDAMAGE, amt); }
-    float GetMinOffhandDamage() { return GetFloatValue(UNIT_FIELD_MINOFFHANDDAMAGE); }
+    float GetMinOffhandDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MINOFFHANDDAMAGE); }
 
     void SetMaxOffhandDamage(float amt) { SetFloatValue(UNIT_FIELD_MAXOFFHANDDAMAGE, amt); }
-    float GetMaxOffhandDamage() { return GetFloatValue(UNIT_FIELD_MAXOFFHANDDAMAGE); }
+    float GetMaxOffhandDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MAXOFFHANDDAMAGE); }
 
     void SetMinRangedDamage(float amt) { SetFloatValue(UNIT_FIELD_MINRANGEDDAMAGE, amt); }
-    float GetMinRangedDamage() { return GetFloatValue(UNIT_FIELD_MINRANGEDDAMAGE); }
+    float GetMinRangedDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MINRANGEDDAMAGE); }
 
     void SetMaxRangedDamage(float amt) { SetFloatValue(UNIT_FIELD_MAXRANGEDDAMAGE, amt); }
-    float GetMaxRangedDamage() { return GetFloatValue(UNIT_FIELD_MAXRANGEDDAMAGE); }
+    float GetMaxRangedDamage() { flushDirtyStats(); return GetFloatValue(UNIT_FIELD_MAXRANGEDDAMAGE); }
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -1086,7 +1146,7 @@ public:
     uint32 GetMount() { return GetUInt32Value(UNIT_FIELD_MOUNTDISPLAYID); }
 
     void SetCastSpeedMod(float amt) { SetFloatValue(UNIT_MOD_CAST_SPEED, amt); }
-    float GetCastSpeedMod() { return GetFloatValue(UNIT_MOD_CAST_SPEED); }
+    float GetCastSpeedMod() { flushDirtyStats(); return GetFloatValue(UNIT_MOD_CAST_SPEED); }
     void ModCastSpeedMod(float mod) { ModFloatValue(UNIT_MOD_CAST_SPEED, mod); }
 
     void SetCreatedBySpell(uint32 id) { SetUInt32Value(UNIT_CREATED_BY_SPELL, id); }
@@ -1096,10 +1156,10 @@ public:
     uint32 GetEmoteState() { return GetUInt32Value(UNIT_NPC_EMOTESTATE); }
 
     void SetStat(uint32 stat, uint32 amt) { SetUInt32Value(UNIT_FIELD_STAT0 + stat, amt); }
-    uint32 GetStat(uint32 stat) { return GetUInt32Value(UNIT_FIELD_STAT0 + stat); }
+    uint32 GetStat(uint32 stat) { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_STAT0 + stat); }
 
     void SetResistance(uint32 type, uint32 amt) { SetUInt32Value(UNIT_FIELD_RESISTANCES + type, amt); }
-    uint32 GetResistance(uint32 type) { return GetUInt32Value(UNIT_FIELD_RESISTANCES + type); }
+    uint32 GetResistance(uint32 type) { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_RESISTANCES + type); }
 
     void SetBaseMana(uint32 amt) { SetUInt32Value(UNIT_FIELD_BASE_MANA, amt); }
     uint32 GetBaseMana() { return GetUInt32Value(UNIT_FIELD_BASE_MANA); }
@@ -1114,7 +1174,7 @@ public:
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     void SetAttackPower(uint32 amt) { SetUInt32Value(UNIT_FIELD_ATTACK_POWER, amt); }
-    uint32 GetAttackPower() { return GetUInt32Value(UNIT_FIELD_ATTACK_POWER); }
+    uint32 GetAttackPower() { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_ATTACK_POWER); }
 
     //\todo fix this
     void SetAttackPowerMods(uint32 amt)
@@ -1145,7 +1205,7 @@ public:
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     void SetRangedAttackPower(uint32 amt) { SetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER, amt); }
-    uint32 GetRangedAttackPower() { return GetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER); }
+    uint32 GetRangedAttackPower() { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER); }
 
     //\todo fix this
     void SetRangedAttackPowerMods(uint32 amt)
@@ -1192,8 +1252,8 @@ public:
     void SetHealth(uint32 val) { SetUInt32Value(UNIT_FIELD_HEALTH, val); }
     void SetMaxHealth(uint32 val) { SetUInt32Value(UNIT_FIELD_MAXHEALTH, val); }
 
-    uint32 GetHealth()    const { return GetUInt32Value(UNIT_FIELD_HEALTH); }
-    uint32 GetMaxHealth() const { return GetUInt32Value(UNIT_FIELD_MAXHEALTH); }
+    uint32 GetHealth()    const { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_HEALTH); }
+    uint32 GetMaxHealth() const { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_MAXHEALTH); }
 
     void ModHealth(int32 val) { ModUnsigned32Value(UNIT_FIELD_HEALTH, val); }
     void ModMaxHealth(int32 val) { ModUnsigned32Value(UNIT_FIELD_MAXHEALTH, val); }
@@ -1202,6 +1262,8 @@ public:
 
     void ModPower(uint32 index, int32 value)
     {
+        flushDirtyStats();
+
         int32 power = static_cast<int32>(m_uint32Values[UNIT_FIELD_POWER1 + index]);
         int32 maxpower = static_cast<int32>(m_uint32Values[UNIT_FIELD_MAXPOWER1 + index]);
 
@@ -1216,13 +1278,13 @@ public:
             SetUInt32Value(UNIT_FIELD_POWER1 + index, power + value);
     }
 
-    uint32 GetPower(uint32 index) { return GetUInt32Value(UNIT_FIELD_POWER1 + index); }
+    uint32 GetPower(uint32 index) { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_POWER1 + index); }
 
     void SetMaxPower(uint32 index, uint32 value) { SetUInt32Value(UNIT_FIELD_MAXPOWER1 + index, value); }
 
     void ModMaxPower(uint32 index, int32 value) { ModUnsigned32Value(UNIT_FIELD_MAXPOWER1 + index, value); }
 
-    uint32 GetMaxPower(uint32 index) { return GetUInt32Value(UNIT_FIELD_MAXPOWER1 + index); }
+    uint32 GetMaxPower(uint32 index) { flushDirtyStats(); return GetUInt32Value(UNIT_FIELD_MAXPOWER1 + index); }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2014-2017 AscEmu Team <http://www.ascemu.org/>
+This file is released under the MIT license. See README-MIT for more information.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/// Derived stats which have to be recalculated, see Unit::markStatsDirty
+enum UnitStatDirtyFlags
+{
+    UNIT_STAT_DIRTY_NONE                = 0x000,
+    UNIT_STAT_DIRTY_STATS               = 0x001,    // Player::UpdateStats, includes attack speed, chances and damage
+    UNIT_STAT_DIRTY_CHANCES             = 0x002,    // Player::UpdateChances
+    UNIT_STAT_DIRTY_DAMAGE              = 0x004,    // Unit::CalcDamage
+    UNIT_STAT_DIRTY_ATTACK_SPEED        = 0x008,    // Player::UpdateAttackSpeed
+    UNIT_STAT_DIRTY_RESISTANCE_NORMAL   = 0x010,    // CalcResistance, one bit per school starting here
+    UNIT_STAT_DIRTY_RESISTANCE_ALL      = 0x7F0
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/// The derived stats of a unit which wait for their recalculation.
+///
+/// mark only collects the flags, flush runs the calculations of all collected flags once.
+/// The calculations are called on a Calculator with hasPlayerStats(), calcResistance(school),
+/// updateStats(), updateAttackSpeed(), updateChances() and calcDamage(), the Unit passes
+/// itself, the tests a model of a player.
+//////////////////////////////////////////////////////////////////////////////////////////
+class UnitDirtyStats
+{
+    public:
+
+        UnitDirtyStats() : m_flags(UNIT_STAT_DIRTY_NONE), m_recalculating(false) {}
+
+        bool isDirty() const { return m_flags != UNIT_STAT_DIRTY_NONE; }
+        uint32_t getFlags() const { return m_flags; }
+
+        /// marks raised by a calculation (aura modifiers refreshed by UpdateStats) have to be applied directly
+        bool isRecalculating() const { return m_recalculating; }
+
+        /// returns true for the first mark after a flush, the unit has to be queued then
+        bool mark(uint32_t dirty_flags)
+        {
+            const bool first = m_flags == UNIT_STAT_DIRTY_NONE;
+            m_flags |= dirty_flags;
+            return first;
+        }
+
+        template <class Calculator>
+        void flush(Calculator& calculator)
+        {
+            const uint32_t dirty_flags = m_flags;
+            if (dirty_flags == UNIT_STAT_DIRTY_NONE)
+                return;
+
+            m_flags = UNIT_STAT_DIRTY_NONE;
+            recalculate(calculator, dirty_flags);
+        }
+
+        /// runs the calculations of dirty_flags right away
+        template <class Calculator>
+        void recalculate(Calculator& calculator, uint32_t dirty_flags)
+        {
+            const bool was_recalculating = m_recalculating;
+            m_recalculating = true;
+
+            const uint32_t schools = (dirty_flags & UNIT_STAT_DIRTY_RESISTANCE_ALL) / UNIT_STAT_DIRTY_RESISTANCE_NORMAL;
+            for (uint32_t school = 0; (schools >> school) != 0; ++school)
+            {
+                if ((schools >> school) & 1)
+                    calculator.calcResistance(school);
+            }
+
+            if (calculator.hasPlayerStats())
+            {
+                // UpdateStats ends with UpdateAttackSpeed, UpdateChances and CalcDamage
+                if (dirty_flags & UNIT_STAT_DIRTY_STATS)
+                {
+                    calculator.updateStats();
+                }
+                else
+                {
+                    if (dirty_flags & UNIT_STAT_DIRTY_ATTACK_SPEED)
+                        calculator.updateAttackSpeed();
+
+                    if (dirty_flags & UNIT_STAT_DIRTY_CHANCES)
+                        calculator.updateChances();
+
+                    if (dirty_flags & UNIT_STAT_DIRTY_DAMAGE)
+                        calculator.calcDamage();
+                }
+            }
+            else if (dirty_flags & UNIT_STAT_DIRTY_DAMAGE)
+            {
+                calculator.calcDamage();
+            }
+
+            m_recalculating = was_recalculating;
+        }
+
+        static uint32_t getResistanceFlag(uint32_t school) { return UNIT_STAT_DIRTY_RESISTANCE_NORMAL << school; }
+
+    private:
+
+        uint32_t m_flags;
+        bool m_recalculating;
+};